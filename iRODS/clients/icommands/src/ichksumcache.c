@@ -0,0 +1,88 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/*
+ * ichksumcache - show, prune and verify the local checksum cache
+*/
+
+#include "rodsClient.h"
+#include "parseCommandLine.h"
+#include "chksumCache.h"
+void usage ();
+
+int
+main(int argc, char **argv) {
+    int status;
+    rodsArguments_t myRodsArgs;
+    char *optStr;
+
+    optStr = "hKrvVZ";
+
+    status = parseCmdLineOpt (argc, argv, optStr, 1, &myRodsArgs);
+    if (status < 0) {
+        printf("Use -h for help.\n");
+        exit (1);
+    }
+    if (myRodsArgs.help==True) {
+       usage();
+       exit(0);
+    }
+
+    if (myRodsArgs.verifyChecksum == True) {
+        if (argc - optind <= 0) {
+            rodsLog (LOG_ERROR, "ichksumcache: no input path for -K");
+            printf("Use -h for help.\n");
+            exit (2);
+        }
+        status = verifyChksumCacheUtil (&myRodsArgs, argc - optind,
+          &argv[optind]);
+    } else if (myRodsArgs.age == True) {
+        status = pruneChksumCache (myRodsArgs.agevalue);
+        if (status >= 0) {
+            printf ("pruned %d entries\n", status);
+            status = 0;
+        }
+    } else {
+        status = printChksumCacheStat ();
+    }
+
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status, "ichksumcache error. ");
+        exit (3);
+    } else {
+        exit(0);
+    }
+}
+
+void
+usage () {
+   char *msgs[]={
+"Usage : ichksumcache [-h]",
+"Usage : ichksumcache --age minutes",
+"Usage : ichksumcache -K [-rv] localFile|localDir ...",
+"Show, prune or verify the local checksum cache.",
+" ",
+"The cache keeps the checksum of each local file hashed by irsync, iput -K",
+"and the other icommands, together with the device, inode, size, mtime",
+"and ctime of the file. A file which has not changed since it was hashed",
+"is not read again. The cache is only used if the environment variable",
+"irodsChksumCache is set: 1 - use the file ~/.irods/.irodsChksumCache,",
+"any other value is taken as the path of the cache file. Verification",
+"(iget -K, ifsck -K) always reads the file.",
+" ",
+"With no option, the usage of the cache is shown.",
+"Options are:",
+" --age minutes - drop the entries not used in the last 'minutes' minutes",
+"     and shrink the cache file. 0 only shrinks the file.",
+" -K  hash the given local files again and compare the result with their",
+"     cached checksums. Wrong entries are reported and replaced.",
+" -r  recursive - verify the files under the given directories.",
+" -v  verbose - also list the files with a good cached checksum.",
+" -h  this help",
+""};
+   int i;
+   for (i=0;;i++) {
+      if (strlen(msgs[i])==0) break;
+      printf("%s\n",msgs[i]);
+   }
+   printReleaseInfo("ichksumcache");
+}
@@ -19,7 +19,7 @@ main(int argc, char **argv) {
     rodsPathInp_t rodsPathInp;
     
 
-    optStr = "hrK";
+    optStr = "hrKaR:N:";
    
     status = parseCmdLineOpt (argc, argv, optStr, 0, &myRodsArgs);
 
@@ -82,7 +82,7 @@ main(int argc, char **argv) {
 void
 usage () {
    char *msgs[]={
-"Usage : ifsck [-rhK] srcPhysicalFile|srcPhysicalDirectory ... ",
+"Usage : ifsck [-rhKa] [-R resource] [-N numThreads] srcPhysicalFile|srcPhysicalDirectory ... ",
 "Check if a local data object or a local collection content is",
 "consistent in size (or optionally its checksum) with its",
 "registered size (and optionally its checksum) in iRODS.",
@@ -93,6 +93,13 @@ usage () {
 " -K  verify the checksum of the local file wrt the one registered in iRODS.",
 "     Only relevant if the checksum has been computed for the iRODS objects.",
 " -r  recursive - scan local subdirectories",
+" -a  audit a local directory in one pass. All the replicas under it are",
+"     listed from iRODS ordered by path and merged with a sorted walk of",
+"     the directory. Reports the orphan files, the missing files and the",
+"     size (and with -K checksum) mismatches, with a summary at the end.",
+" -R  resource - with -a, only audit the replicas of this resource.",
+" -N  numThreads - the number of threads doing the lstat and checksum of",
+"     the files with -a. The default is 4.",
 " -h  this help",
 ""};
    int i;
@@ -8,7 +8,8 @@
 #include "parseCommandLine.h"
 
 char *icmds[]={
-  "iadmin", "ibun", "icd", "ichksum", "ichmod", "icp", "idbo", "idbug", "ienv",
+  "iadmin", "ibun", "icd", "ichksum", "ichksumcache", "ichmod", "icp", "idbo",
+  "idbug", "ienv",
   "ierror", "iexecmd", "iexit", 
   "ifind",
   "ifsck", "iget", "igetwild.sh", "igroupadmin",
@@ -35,6 +36,7 @@ printMainHelp()
 "ibun     - upload/download structured (tar) files.",
 "icd      - change the current working directory (collection).",
 "ichksum  - checksum one or more data-objects or collections.",
+"ichksumcache - show, prune or verify the local checksum cache.",
 "ichmod   - change access permissions to collections or data-objects.",
 "icp      - copy a data-object (file) or collection (directory) to another.",
 "idbo     - execute Database Objects on Database Resources, etc." ,
@@ -161,6 +161,13 @@ usage ()
 "checksum value) is used for determining whether synchronization is needed.",
 "This  mode  is  gives  a  faster operation but the result is less accurate.",
 " ",
+"When a local file of 8 MB or more differs from an existing iRODS file with",
+"a registered checksum, only the blocks which changed are uploaded (rsync",
+"algorithm). The size limit can be changed with the environment variable",
+"irodsDeltaMinSize (in bytes). A negative value always uploads the whole",
+"file. The whole file is also uploaded if the server does not support this",
+"mode or if more than half of the file changed.",
+" ",
 "The command accepts  multiple  sourceFiles|sourceDirectories and a single",
 "targetFile|targetDirectory. It pretty much follows the syntax of the UNIX",
 "cp command with one exception- irsync of a single source  directory to a ",
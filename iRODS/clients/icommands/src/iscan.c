@@ -19,7 +19,7 @@ main(int argc, char **argv) {
     objType_t srcType;
     rodsPathInp_t rodsPathInp;
 
-    optStr = "hr";
+    optStr = "hraN:";
    
     status = parseCmdLineOpt (argc, argv, optStr, 0, &myRodsArgs);
 
@@ -93,7 +93,7 @@ main(int argc, char **argv) {
 void
 usage () {
    char *msgs[]={
-"Usage : iscan [-rh] srcPhysicalFile|srcPhysicalDirectory|srcDataObj|srcCollection",
+"Usage : iscan [-rah] [-N numThreads] srcPhysicalFile|srcPhysicalDirectory|srcDataObj|srcCollection",
 "If the input is a local data file or a local directory, it checks if the content is registered in irods.",
 "It allows to detect orphan files, srcPhysicalFile or srcPhysicalDirectory must be a full path name.",
 "If the input is an iRODS file or an iRODS collection, it checks if the physical files corresponding ",
@@ -101,6 +101,11 @@ usage () {
 "For srcDataObj and srcCollection (iRODS objects), it must be prepended with 'i:'.",
 "Options are:",
 " -r  recursive - scan local subdirectories or subcollections",
+" -a  audit a local directory in one pass. The registered files are listed",
+"     from iRODS ordered by path and merged with a sorted walk of the",
+"     directory instead of querying iRODS for each file.",
+" -N  numThreads - the number of threads doing the lstat of the files",
+"     with -a. The default is 4.",
 " -h  this help",
 ""};
    int i;
@@ -48,6 +48,9 @@ LIB_API_OBJS += $(libApiObjDir)/rcFileStage.o
 SVR_API_OBJS += $(svrApiObjDir)/rsFileGetFsFreeSpace.o
 LIB_API_OBJS += $(libApiObjDir)/rcFileGetFsFreeSpace.o
 
+SVR_API_OBJS += $(svrApiObjDir)/rsFileGetLoad.o
+LIB_API_OBJS += $(libApiObjDir)/rcFileGetLoad.o
+
 SVR_API_OBJS += $(svrApiObjDir)/rsFileOpendir.o
 LIB_API_OBJS += $(libApiObjDir)/rcFileOpendir.o
 
@@ -183,6 +186,9 @@ LIB_API_OBJS += $(libApiObjDir)/rcDataObjRsync.o
 SVR_API_OBJS += $(svrApiObjDir)/rsDataObjChksum.o
 LIB_API_OBJS += $(libApiObjDir)/rcDataObjChksum.o
 
+SVR_API_OBJS += $(svrApiObjDir)/rsDataObjDelta.o
+LIB_API_OBJS += $(libApiObjDir)/rcDataObjDelta.o
+
 SVR_API_OBJS += $(svrApiObjDir)/rsPhyPathReg.o
 LIB_API_OBJS += $(libApiObjDir)/rcPhyPathReg.o
 
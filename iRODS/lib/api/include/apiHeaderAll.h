@@ -22,6 +22,7 @@
 #include "fileFsync.h"
 #include "fileStage.h"
 #include "fileGetFsFreeSpace.h"
+#include "fileGetLoad.h"
 #include "fileOpendir.h"
 #include "fileClosedir.h"
 #include "fileReaddir.h"
@@ -67,6 +68,7 @@
 #include "dataObjRename.h"
 #include "dataObjRsync.h"
 #include "dataObjChksum.h"
+#include "dataObjDelta.h"
 #include "phyPathReg.h"
 #include "dataObjPhymv.h"
 #include "dataObjTrim.h"
@@ -36,8 +36,10 @@
 #define FILE_TRUNCATE_AN 		523
 #define FILE_STAGE_TO_CACHE_AN		524
 #define FILE_SYNC_TO_ARCH_AN 		525
+#define FILE_GET_LOAD_AN 		526
 
 /* 600 - 699 - Object File I/O API calls */
+#define DATA_OBJ_DELTA_AN 		600
 #define DATA_OBJ_CREATE_AN 		601
 #define DATA_OBJ_OPEN_AN 		602
 #define DATA_OBJ_PUT_AN 		606
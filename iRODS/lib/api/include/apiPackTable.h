@@ -46,6 +46,8 @@ packInstructArray_t ApiPackTable[] = {
         {"fileFsyncInp_PI", fileFsyncInp_PI},
         {"fileGetFsFreeSpaceInp_PI", fileGetFsFreeSpaceInp_PI},
         {"fileGetFsFreeSpaceOut_PI", fileGetFsFreeSpaceOut_PI},
+        {"fileGetLoadInp_PI", fileGetLoadInp_PI},
+        {"fileGetLoadOut_PI", fileGetLoadOut_PI},
         {"fileMkdirInp_PI", fileMkdirInp_PI},
         {"fileOpendirInp_PI", fileOpendirInp_PI},
         {"fileReaddirInp_PI", fileReaddirInp_PI},
@@ -60,6 +60,8 @@ apidef_t RcApiTable[] = {
        "fileStageInp_PI", 0, NULL, 0, (funcPtr) RS_FILE_STAGE},
     {FILE_GET_FS_FREE_SPACE_AN, RODS_API_VERSION, REMOTE_USER_AUTH, REMOTE_PRIV_USER_AUTH, 
        "fileGetFsFreeSpaceInp_PI", 0, "fileGetFsFreeSpaceOut_PI", 0, (funcPtr) RS_FILE_GET_FS_FREE_SPACE},
+    {FILE_GET_LOAD_AN, RODS_API_VERSION, REMOTE_USER_AUTH, REMOTE_PRIV_USER_AUTH, 
+       "fileGetLoadInp_PI", 0, "fileGetLoadOut_PI", 0, (funcPtr) RS_FILE_GET_LOAD},
     {FILE_OPENDIR_AN, RODS_API_VERSION, REMOTE_USER_AUTH, REMOTE_PRIV_USER_AUTH, 
        "fileOpendirInp_PI", 0, NULL, 0, (funcPtr) RS_FILE_OPENDIR},
     {FILE_CLOSEDIR_AN, RODS_API_VERSION, REMOTE_USER_AUTH, REMOTE_PRIV_USER_AUTH, 
@@ -239,6 +241,8 @@ apidef_t RcApiTable[] = {
       "DataObjInp_PI", 0, "MsParamArray_PI", 0, (funcPtr) RS_DATA_OBJ_RSYNC},
     {DATA_OBJ_CHKSUM_AN, RODS_API_VERSION, REMOTE_USER_AUTH, REMOTE_USER_AUTH, 
      "DataObjInp_PI", 0, "STR_PI", 0, (funcPtr) RS_DATA_OBJ_CHKSUM},
+    {DATA_OBJ_DELTA_AN, RODS_API_VERSION, REMOTE_USER_AUTH, REMOTE_USER_AUTH, 
+      "DataObjInp_PI", 1, NULL, 1, (funcPtr) RS_DATA_OBJ_DELTA},
     {PHY_PATH_REG_AN, RODS_API_VERSION, REMOTE_USER_AUTH, REMOTE_USER_AUTH, 
       "DataObjInp_PI", 0, NULL, 0, (funcPtr) RS_PHY_PATH_REG},
     {DATA_OBJ_PHYMV250_AN, RODS_API_VERSION, REMOTE_USER_AUTH, REMOTE_USER_AUTH, 
@@ -17,9 +17,18 @@
 #include "dataObjClose.h"
 #endif
 #include "genQuery.h"
+#ifdef PARA_OPR
+#include <pthread.h>
+#endif
 
 #define TMP_PHY_BUN_DIR		"tmpPhyBunDir"
 
+/* env variable read by the agents. Can be set in server.env */
+#define BULK_PUT_NUM_THREADS	"bulkPutNumThreads" /* threads writing and
+						     * checksumming subfiles */
+#define DEF_BULK_PUT_NUM_THREADS	4
+#define MAX_BULK_PUT_NUM_THREADS	16
+
 typedef struct {
     char objPath[MAX_NAME_LEN];
     genQueryOut_t attriArray;   /* arrays of attrib - chksum */
@@ -36,6 +45,29 @@ typedef struct RenamedPhyFiles {
 #define BulkOprInp_PI "str objPath[MAX_NAME_LEN]; struct GenQueryOut_PI; struct KeyValPair_PI;"
 
 #if defined(RODS_SERVER)
+/* a subfile of the bulk buffer to be written to the vault */
+typedef struct BulkPutTask {
+    char *buf;		/* the content in the bulk buffer */
+    int size;
+    char objPath[MAX_NAME_LEN];
+    char filePath[MAX_NAME_LEN];	/* the vault path */
+    int dataMode;
+    int modFlag;
+    int replNum;
+    char *chksum;	/* the input chksum in attriArray. may be NULL */
+    int verifyFlag;
+    int status;
+} bulkPutTask_t;
+
+typedef struct BulkPutTaskQue {
+    bulkPutTask_t *tasks;
+    int numTasks;
+    int nextInx;	/* next task to be picked up by a worker */
+#ifdef PARA_OPR
+    pthread_mutex_t lock;
+#endif
+} bulkPutTaskQue_t;
+
 #define RS_BULK_DATA_OBJ_PUT rsBulkDataObjPut
 /* prototype for the server handler */
 int
@@ -68,6 +100,18 @@ bulkRegSubfile (rsComm_t *rsComm, char *rescName, char *rescGroupName,
 char *subObjPath, char *subfilePath, rodsLong_t dataSize, int dataMode,
 int modFlag, int replNum, char *chksum, genQueryOut_t *bulkDataObjRegInp,
 renamedPhyFiles_t *renamedPhyFiles);
+int
+getBulkSubfilePath (rsComm_t *rsComm, rescInfo_t *rescInfo, char *subObjPath,
+rodsLong_t dataSize, int flags, renamedPhyFiles_t *renamedPhyFiles,
+dataObjInfo_t *dataObjInfo, int *outModFlag);
+int
+bulkProcAndRegBuf (rsComm_t *rsComm, rescInfo_t *rescInfo,
+char *rescGroupName, bulkOprInp_t *bulkOprInp, bytesBuf_t *bulkBBuf,
+int flags);
+int
+writeBulkPutTasks (bulkPutTask_t *tasks, int numTasks);
+int
+writeBulkPutTask (bulkPutTask_t *task);
 #else
 #define RS_BULK_DATA_OBJ_PUT NULL
 #endif
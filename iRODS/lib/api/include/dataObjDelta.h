@@ -0,0 +1,94 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* dataObjDelta.h
+ */
+
+#ifndef DATA_OBJ_DELTA_H
+#define DATA_OBJ_DELTA_H
+
+/* This is a Object File I/O API call */
+
+#include "rods.h"
+#include "rcMisc.h"
+#include "procApiRequest.h"
+#include "apiNumber.h"
+#include "initServer.h"
+#include "dataObjInpOut.h"
+
+/* The signature buffer returned by DELTA_SIG_OPR is a header of
+ * DELTA_SIG_HEADER_LEN bytes (blockSize, numBlocks, replNum, size high
+ * and low word) followed by numBlocks entries of a 4 byte weak checksum
+ * and a DELTA_STRONG_LEN byte md5 digest. The delta sent with
+ * DELTA_APPLY_OPR is a sequence of DELTA_COPY_REC (op, blockInx, count)
+ * and DELTA_DATA_REC (op, len, len bytes of data) records. All integers
+ * are 4 bytes in network byte order. */
+#define DEF_DELTA_BLOCK_SIZE	(64 * 1024)
+#define MAX_DELTA_BLOCKS	(256 * 1024)
+#define DELTA_CHUNK_SIZE	(4 * 1024 * 1024)  /* max delta per call */
+#define DELTA_STRONG_LEN	16
+#define DELTA_SIG_HEADER_LEN	20
+#define DELTA_SIG_ENT_LEN	(4 + DELTA_STRONG_LEN)
+#define DELTA_COPY_REC		1
+#define DELTA_DATA_REC		2
+#define DELTA_COPY_REC_LEN	12
+#define DELTA_DATA_REC_LEN	8	/* not including the data */
+
+/* the new content is assembled in filePath + DELTA_TMP_FILE_SUFFIX and
+ * renamed over the replica by DELTA_COMMIT_OPR */
+#define DELTA_TMP_FILE_SUFFIX	".irodsDelta"
+
+#if defined(RODS_SERVER)
+#define RS_DATA_OBJ_DELTA rsDataObjDelta
+/* prototype for the server handler */
+int
+rsDataObjDelta (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
+bytesBuf_t *deltaBBuf, bytesBuf_t *sigBBuf);
+int
+_rsDataObjDelta (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
+bytesBuf_t *deltaBBuf, bytesBuf_t *sigBBuf);
+#else
+#define RS_DATA_OBJ_DELTA NULL
+#endif
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+/* prototype for the client call */
+int
+rcDataObjDelta (rcComm_t *conn, dataObjInp_t *dataObjInp,
+bytesBuf_t *deltaBBuf, bytesBuf_t *sigBBuf);
+
+/* rcDataObjDelta - Update a replica of an existing iRODS data object
+ * with a block level delta.
+ * Input -
+ *   rcComm_t *conn - The client connection handle.
+ *   dataObjInp_t *dataObjInp - generic dataObj input. Relevant items are:
+ *      objPath - the path of the data object.
+ *      oprType - DELTA_SIG_OPR - return the block signatures of the
+ *                  replica to be updated in sigBBuf.
+ *                DELTA_APPLY_OPR - append the content described by the
+ *                  delta records in deltaBBuf to the new content.
+ *                DELTA_COMMIT_OPR - replace the replica with the new
+ *                  content.
+ *                DELTA_ABORT_OPR - discard the new content.
+ *      offset - DELTA_APPLY_OPR - the offset of the new content where
+ *        this delta starts. 0 starts a new content.
+ *      dataSize - DELTA_COMMIT_OPR - the size of the new content.
+ *      condInput - REPL_NUM_KW - the replica number given in the
+ *                    signature header. Needed except for DELTA_SIG_OPR.
+ *                  DELTA_BLOCK_SIZE_KW - the blockSize given in the
+ *                    signature header. Needed for DELTA_APPLY_OPR.
+ *                  CHKSUM_KW - the checksum of the new content. Needed
+ *                    for DELTA_COMMIT_OPR.
+ *   bytesBuf_t *deltaBBuf - the delta records for DELTA_APPLY_OPR.
+ * OutPut -
+ *   bytesBuf_t *sigBBuf - the signatures for DELTA_SIG_OPR.
+ *   return value - The status of the operation.
+ */
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif	/* DATA_OBJ_DELTA_H */
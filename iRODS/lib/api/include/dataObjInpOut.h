@@ -205,6 +205,10 @@ typedef struct CollInp201 {
 #define RENAME_UNKNOWN_TYPE     22
 #define REMOTE_ZONE_OPR         24
 #define UNREG_OPR         	26
+#define DELTA_SIG_OPR         	27	/* rcDataObjDelta operations */
+#define DELTA_APPLY_OPR        	28
+#define DELTA_COMMIT_OPR       	29
+#define DELTA_ABORT_OPR        	30
 #if 0
 #define CREATE_OPR     		23
 #define OPEN_OPR         	25
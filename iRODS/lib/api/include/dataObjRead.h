@@ -36,6 +36,11 @@ bytesBuf_t *dataObjReadOutBBuf);
 int
 _l3Read (rsComm_t *rsComm, int rescTypeInx, int l3descInx,
 void *buf, int len);
+int
+_l3Pread (rsComm_t *rsComm, int rescTypeInx, int l3descInx,
+void *buf, int len, rodsLong_t offset);
+int
+l3HasPio (int rescTypeInx, int l3descInx);
 #else
 #define RS_DATA_OBJ_READ NULL
 #endif
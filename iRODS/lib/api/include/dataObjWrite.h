@@ -35,6 +35,9 @@ bytesBuf_t *dataObjWriteInpBBuf);
 int
 _l3Write (rsComm_t *rsComm, int destRescTypeInx, int l3descInx,
 void *buf, int len);
+int
+_l3Pwrite (rsComm_t *rsComm, int destRescTypeInx, int l3descInx,
+void *buf, int len, rodsLong_t offset);
 #else
 #define RS_DATA_OBJ_WRITE NULL
 #endif
@@ -0,0 +1,62 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* fileGetLoad.h - This file may be generated by a program or script
+ */
+
+#ifndef FILE_GET_LOAD_H
+#define FILE_GET_LOAD_H
+
+/* This is a low level file type API call */
+
+#include "rods.h"
+#include "rcMisc.h"
+#include "procApiRequest.h"
+#include "apiNumber.h"
+#include "initServer.h"
+
+#include "fileDriver.h"
+
+/* fileName is the vault path of the resource */
+typedef struct {
+    fileDriverType_t fileType;
+    rodsHostAddr_t addr;
+    char fileName[MAX_NAME_LEN];
+    int flag;
+} fileGetLoadInp_t;
+
+/* the live load of the server of a resource. -1 means unknown */
+typedef struct {
+    int activeXfers;		/* files open by the agents of the server */
+    int queueDepth;		/* I/Os in flight on the vault's disk */
+    int diskBusy;		/* % of time the vault's disk was busy */
+    int sampleTime;		/* when the load was sampled */
+    rodsLong_t outstandingBytes;  /* size of the files being transferred */
+    rodsLong_t freeSpace;	/* free space in the vault */
+} fileGetLoadOut_t;
+
+#define fileGetLoadInp_PI "int fileType; struct RHostAddr_PI; str fileName[MAX_NAME_LEN]; int flag;"
+
+#define fileGetLoadOut_PI "int activeXfers; int queueDepth; int diskBusy; int sampleTime; double outstandingBytes; double freeSpace;"
+
+#if defined(RODS_SERVER)
+#define RS_FILE_GET_LOAD rsFileGetLoad
+/* prototype for the server handler */
+int
+rsFileGetLoad (rsComm_t *rsComm, fileGetLoadInp_t *fileGetLoadInp,
+fileGetLoadOut_t **fileGetLoadOut);
+int
+_rsFileGetLoad (rsComm_t *rsComm, fileGetLoadInp_t *fileGetLoadInp,
+fileGetLoadOut_t **fileGetLoadOut);
+int
+remoteFileGetLoad (rsComm_t *rsComm, fileGetLoadInp_t *fileGetLoadInp,
+fileGetLoadOut_t **fileGetLoadOut, rodsServerHost_t *rodsServerHost);
+#else
+#define RS_FILE_GET_LOAD NULL
+#endif
+
+/* prototype for the client call */
+int
+rcFileGetLoad (rcComm_t *conn, fileGetLoadInp_t *fileGetLoadInp,
+fileGetLoadOut_t **fileGetLoadOut);
+
+#endif	/* FILE_GET_LOAD_H */
@@ -38,12 +38,16 @@ typedef struct {
 #define NcAggInfo_PI "int numFiles; int flags; str  ncObjectName[MAX_NAME_LEN]; struct *NcAggElement_PI(numFiles);"
 
 typedef struct {
-    int aggElemetInx;	/* index into the ncAggElement of objNcid */
     int objNcid0;	/* the opened object L1desc for element 0 */
-    int objNcid;        /* the opened object L1desc */
     ncAggInfo_t *ncAggInfo;
     ncInqOut_t *ncInqOut0;	/* ncInqOut for objNcid0 */
-    ncInqOut_t *ncInqOut;	/* ncInqOut for objNcid */
+    /* the cache of the other elements. numFiles long, indexed by the
+     * element. Element 0 stays in objNcid0 and ncInqOut0 */
+    int *eleNcid;		/* the opened object L1desc or -1 */
+    int *eleLastUse;		/* useCnt of the last use of eleNcid */
+    ncInqOut_t **eleInqOut;	/* kept after the element is closed */
+    int numOpenedEle;		/* no. of eleNcid opened */
+    int useCnt;
 } openedAggInfo_t;
 
 #if defined(RODS_SERVER) && defined(NETCDF_API)
@@ -55,6 +59,11 @@ ncAggInfo_t **ncAggInfo);
 int
 readAggInfo (rsComm_t *rsComm, char *aggColl, keyValPair_t *condInput,
 ncAggInfo_t **ncAggInfo);
+int
+inqAggrFile (rsComm_t *rsComm, int l1descInx, int aggElemetInx,
+ncInqOut_t **ncInqOut);
+int
+freeAggrCache (openedAggInfo_t *openedAggInfo);
 #else
 #define RS_NC_GET_AGG_INFO NULL
 #endif
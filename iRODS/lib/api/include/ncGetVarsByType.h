@@ -91,6 +91,8 @@ ncGetVarOut_t **ncGetVarOut);
 int
 rsNcGetVarsByTypeForObj (rsComm_t *rsComm, ncGetVarInp_t *ncGetVarInp,
 ncGetVarOut_t **ncGetVarOut);
+int
+getNcAggNumThreads ();
 #else
 #define RS_NC_GET_VARS_BY_TYPE NULL
 #endif
@@ -30,6 +30,17 @@ typedef struct {
 
 #define NcOpenInp_PI "str objPath[MAX_NAME_LEN]; int mode; int rootNcid; double intialsz; double bufrsizehint; struct KeyValPair_PI;"
 
+/* env variables read by the agents. They can be set in server.env */
+/* the max no. of element files of an opened aggregate kept open at the
+ * same time. The least recently used one is closed when more are needed */
+#define NC_AGG_OPEN_MAX_ENV	"ncAggOpenMax"
+#define DEF_NC_AGG_OPEN_MAX	16
+/* the max no. of threads reading the elements of an aggregate in parallel.
+ * One thread per server holding elements */
+#define NC_AGG_NUM_THREADS_ENV	"ncAggNumThreads"
+#define DEF_NC_AGG_NUM_THREADS	4
+#define MAX_NC_AGG_NUM_THREADS	16
+
 #if defined(RODS_SERVER) && defined(NETCDF_API)
 #define RS_NC_OPEN rsNcOpen
 /* prototype for the server handler */
@@ -41,6 +52,8 @@ int
 rsNcOpenColl (rsComm_t *rsComm, ncOpenInp_t *ncOpenInp, int **ncid);
 int
 openAggrFile (rsComm_t *rsComm, int l1descInx, int aggElemetInx);
+int
+getNcAggOpenMax ();
 #else
 #define RS_NC_OPEN NULL
 #endif
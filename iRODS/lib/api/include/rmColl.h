@@ -33,6 +33,9 @@ collOprStat_t **collOprStat);
 int
 _rsPhyRmColl (rsComm_t *rsComm, collInp_t *rmCollInp,
 dataObjInfo_t *dataObjInfo, collOprStat_t **collOprStat);
+int
+_rsRmCollTree (rsComm_t *rsComm, collInp_t *rmCollInp,
+collOprStat_t **collOprStat);
 #else
 #define RS_RM_COLL NULL
 #endif
@@ -81,6 +81,8 @@ int
 addRenamedPhyFile (char *subObjPath, char *oldFileName, char *newFileName, 
 renamedPhyFiles_t *renamedPhyFiles);
 int
+restoreRenamedPhyFile (char *objPath, renamedPhyFiles_t *renamedPhyFiles);
+int
 postProcRenamedPhyFiles (renamedPhyFiles_t *renamedPhyFiles, int regStatus);
 int
 cleanupBulkRegFiles (rsComm_t *rsComm, genQueryOut_t *bulkDataObjRegInp);
@@ -39,6 +39,8 @@ _rsSyncMountedColl (rsComm_t *rsComm, specColl_t *specColl, int oprType);
 #define ADD_TO_TAR_OPR          0x10	/* add to a tar file */
 #define PRESERVE_COLL_PATH      0x20	/* preserver the last entry of coll */
 #define PRESERVE_DIR_CONT	0x40	/* preserve the content of cachrdir */
+#define CHKSUM_SUB_FILES_OPR	0x80	/* checksum the sub files while
+					 * bundling. For the tar driver */
 
 
 
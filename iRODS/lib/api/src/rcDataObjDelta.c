@@ -0,0 +1,80 @@
+/**
+ * @file  rcDataObjDelta.c
+ *
+ */
+
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* This is script-generated code.  */
+/* See dataObjDelta.h for a description of this API call.*/
+
+#include "dataObjDelta.h"
+
+/**
+ * \fn rcDataObjDelta (rcComm_t *conn, dataObjInp_t *dataObjInp,
+ *       bytesBuf_t *deltaBBuf, bytesBuf_t *sigBBuf)
+ *
+ * \brief Update a replica of an existing data object with a block level
+ *      delta (rsync algorithm). Used by irsync to upload only the
+ *      modified parts of a large local file.
+ *
+ * \user client
+ *
+ * \category data object operations
+ *
+ * \since 3.3.1
+ *
+ * \remark none
+ *
+ * \note The replica is only replaced by DELTA_COMMIT_OPR, after the
+ *      checksum of the new content is verified. Other replicas are
+ *      marked stale.
+ *
+ * \usage
+ * Get the signatures of the replica of /myZone/home/john/myfile.
+ * \n dataObjInp_t dataObjInp;
+ * \n bytesBuf_t sigBBuf;
+ * \n bzero (&dataObjInp, sizeof (dataObjInp));
+ * \n bzero (&sigBBuf, sizeof (sigBBuf));
+ * \n rstrcpy (dataObjInp.objPath, "/myZone/home/john/myfile", MAX_NAME_LEN);
+ * \n dataObjInp.oprType = DELTA_SIG_OPR;
+ * \n status = rcDataObjDelta (conn, &dataObjInp, NULL, &sigBBuf);
+ * \n if (status < 0) {
+ * \n .... handle the error
+ * \n }
+ *
+ * \param[in] conn - A rcComm_t connection handle to the server.
+ * \param[in] dataObjInp - Elements of dataObjInp_t used :
+ *    \li char \b objPath[MAX_NAME_LEN] - full path of the data object.
+ *    \li int \b oprType - DELTA_SIG_OPR, DELTA_APPLY_OPR, DELTA_COMMIT_OPR
+ *            or DELTA_ABORT_OPR.
+ *    \li rodsLong_t \b offset - DELTA_APPLY_OPR only. The offset of the
+ *            new content where the delta starts.
+ *    \li rodsLong_t \b dataSize - DELTA_COMMIT_OPR only. The size of the
+ *            new content.
+ *    \li keyValPair_t \b condInput - keyword/value pair input. Valid keywords:
+ *    \n REPL_NUM_KW - the replica number returned by DELTA_SIG_OPR.
+ *    \n DELTA_BLOCK_SIZE_KW - the block size returned by DELTA_SIG_OPR.
+ *    \n CHKSUM_KW - the checksum of the new content (DELTA_COMMIT_OPR).
+ * \param[in] deltaBBuf - the delta records (DELTA_APPLY_OPR).
+ * \param[out] sigBBuf - the block signatures (DELTA_SIG_OPR).
+ *
+ * \return integer
+ * \retval 0 on success
+ * \sideeffect none
+ * \pre none
+ * \post none
+ * \sa none
+ * \bug  no known bugs
+**/
+
+int
+rcDataObjDelta (rcComm_t *conn, dataObjInp_t *dataObjInp,
+bytesBuf_t *deltaBBuf, bytesBuf_t *sigBBuf)
+{
+    int status;
+    status = procApiRequest (conn, DATA_OBJ_DELTA_AN, dataObjInp, deltaBBuf,
+        (void **) NULL, sigBBuf);
+
+    return (status);
+}
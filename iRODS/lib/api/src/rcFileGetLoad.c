@@ -0,0 +1,17 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* This is script-generated code.  */
+/* See fileGetLoad.h for a description of this API call.*/
+
+#include "fileGetLoad.h"
+
+int
+rcFileGetLoad (rcComm_t *conn, fileGetLoadInp_t *fileGetLoadInp,
+fileGetLoadOut_t **fileGetLoadOut)
+{
+    int status;
+    status = procApiRequest (conn, FILE_GET_LOAD_AN,
+      fileGetLoadInp, NULL, (void **) fileGetLoadOut, NULL);
+
+    return (status);
+}
@@ -0,0 +1,71 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* chksumCache.h - header file for chksumCache.c, the cache of the
+ * checksums of local files kept by the clients.
+ */
+
+#ifndef CHKSUM_CACHE_H
+#define CHKSUM_CACHE_H
+
+#include "rods.h"
+#include "parseCommandLine.h"
+
+/* The cache is off unless irodsChksumCache is set in the environment.
+ * "1" uses CHKSUM_CACHE_FILE under HOME, any other value is the path
+ * of the cache file. */
+#define CHKSUM_CACHE_ENV	"irodsChksumCache"
+#define CHKSUM_CACHE_FILE	"/.irods/.irodsChksumCache"
+#define CHKSUM_CACHE_MAGIC	0x69726373	/* "ircs" */
+#define CHKSUM_CACHE_VERSION	1
+#define DEF_CHKSUM_CACHE_SLOTS	(64 * 1024)	/* power of 2 */
+#define MAX_CHKSUM_CACHE_SLOTS	(16 * 1024 * 1024)
+
+/* definition for hashType */
+#define CHKSUM_CACHE_EMPTY	0
+#define CHKSUM_CACHE_MD5	1
+#define CHKSUM_CACHE_SHA256	2
+
+typedef struct ChksumCacheHeader {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int numSlots;
+    unsigned int numUsed;
+    rodsLong_t hits;
+    rodsLong_t misses;
+} chksumCacheHeader_t;
+
+/* a file is identified by dev, ino and hashType. size, mtime and ctime
+ * must also match for the chksum to be used */
+typedef struct ChksumCacheEnt {
+    rodsLong_t dev;
+    rodsLong_t ino;
+    rodsLong_t size;
+    rodsLong_t mtime;		/* in nanoseconds */
+    rodsLong_t ctime;		/* in nanoseconds */
+    unsigned int lastUsed;	/* time of the last lookup or update */
+    int hashType;
+    char chksum[CHKSUM_LEN];
+} chksumCacheEnt_t;
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+int
+getChksumCache (char *fileName, int use_sha256, chksumCacheEnt_t *cacheKey,
+char *chksumStr);
+int
+putChksumCache (char *fileName, chksumCacheEnt_t *cacheKey, char *chksumStr);
+int
+pruneChksumCache (int ageInMin);
+int
+printChksumCacheStat ();
+int
+verifyChksumCacheUtil (rodsArguments_t *myRodsArgs, int numPath,
+char **pathArray);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif	/* CHKSUM_CACHE_H */
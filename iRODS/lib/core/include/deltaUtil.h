@@ -0,0 +1,46 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* deltaUtil.h - header file for deltaUtil.c, the block level delta
+ * (rsync algorithm) used by irsync to update large data objects.
+ */
+
+#ifndef DELTA_UTIL_H
+#define DELTA_UTIL_H
+
+#include "rodsClient.h"
+#include "dataObjDelta.h"
+
+/* The delta upload is tried for local files of at least
+ * DELTA_MIN_SIZE_ENV bytes (default DEF_DELTA_MIN_SIZE) whose target
+ * exists with a different checksum. A negative value turns it off. */
+#define DELTA_MIN_SIZE_ENV	"irodsDeltaMinSize"
+#define DEF_DELTA_MIN_SIZE	(8 * 1024 * 1024)
+/* give up (and do a normal put) when the new data exceeds this percent
+ * of the file */
+#define DELTA_MAX_DATA_PERCENT	50
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+int
+getDeltaBlockSize (rodsLong_t fileSize);
+unsigned int
+deltaWeakSum (unsigned char *buf, int len);
+void
+deltaStrongSum (unsigned char *buf, int len, unsigned char *digest);
+void
+putDeltaInt (unsigned char *ptr, unsigned int val);
+unsigned int
+getDeltaInt (unsigned char *ptr);
+rodsLong_t
+getDeltaMinSize ();
+int
+deltaPutUtil (rcComm_t *conn, char *locFilePath, dataObjInp_t *dataObjInp,
+char *chksum);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif	/* DELTA_UTIL_H */
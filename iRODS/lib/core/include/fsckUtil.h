@@ -9,6 +9,95 @@
 #include "parseCommandLine.h"
 #include "rodsPath.h"
 #include "scanUtil.h"
+#ifdef PARA_OPR
+#include <pthread.h>
+#endif
+
+/* definition for the auditFlags of auditObjDir */
+#define AUDIT_ORPHAN_ONLY	0x1	/* iscan - only report unregistered
+					 * files */
+#define AUDIT_VERIFY_CHKSUM	0x2	/* also verify the checksums */
+
+#define DEF_AUDIT_NUM_THREADS	4	/* threads for stat and checksum */
+#define MAX_AUDIT_NUM_THREADS	32
+#define AUDIT_STAT_CHUNK	64	/* files lstat'ed per task */
+#define MAX_AUDIT_CHKSUM_QUE	256	/* max queued checksum tasks */
+
+/* definition for the type of auditTask_t */
+#define AUDIT_STAT_TASK		0
+#define AUDIT_CHKSUM_TASK	1
+
+typedef struct auditEntry {
+    char *name;			/* dirs have a trailing '/' so that the
+				 * walk is in the same order as the paths */
+    int objType;		/* LOCAL_FILE_T, LOCAL_DIR_T or
+				 * UNKNOWN_FILE_T (skipped) */
+    rodsLong_t size;
+} auditEntry_t;
+
+typedef struct auditDir {
+    char path[MAX_NAME_LEN];
+    int numEntries;
+    int inx;			/* next entry to visit */
+    auditEntry_t *entries;	/* sorted by name */
+} auditDir_t;
+
+typedef struct auditCatRow {
+    char dataPath[MAX_NAME_LEN];
+    char dataName[MAX_NAME_LEN];
+    char collName[MAX_NAME_LEN];
+    char chksum[NAME_LEN];
+    rodsLong_t dataSize;
+} auditCatRow_t;
+
+typedef struct auditCatCursor {
+    rcComm_t *conn;
+    genQueryInp_t genQueryInp;
+    genQueryOut_t *genQueryOut;
+    int rowInx;
+    char prevPath[MAX_NAME_LEN];	/* to check the catalog order */
+    int outOfOrderCnt;
+} auditCatCursor_t;
+
+typedef struct auditTask {
+    int type;
+    auditDir_t *auditDir;	/* AUDIT_STAT_TASK - lstat the entries */
+    int startInx;		/* startInx to endInx - 1 */
+    int endInx;
+    char *filePath;		/* AUDIT_CHKSUM_TASK */
+    char *objPath;
+    char *chksum;
+    struct auditTask *next;
+} auditTask_t;
+
+typedef struct auditState {
+    rcComm_t *conn;
+    int auditFlags;
+    int recursive;
+    int numThreads;
+    /* the walk of the vault. The stack of dirs being visited */
+    int depth;
+    auditDir_t *dirStack[MAX_NAME_LEN / 2];
+    char curFilePath[MAX_NAME_LEN];
+    rodsLong_t curFileSize;
+    /* the counts for the summary */
+    rodsLong_t numFiles;
+    rodsLong_t numOrphans;
+    rodsLong_t numMissing;
+    rodsLong_t numSizeErr;
+    rodsLong_t numChksumErr;
+#ifdef PARA_OPR
+    pthread_t threads[MAX_AUDIT_NUM_THREADS];
+    pthread_mutex_t lock;
+    pthread_cond_t taskCond;	/* a task was queued */
+    pthread_cond_t doneCond;	/* a task was done */
+    auditTask_t *taskHead;
+    auditTask_t *taskTail;
+    int numStatPending;
+    int numChksumQueued;
+    int shutdown;
+#endif
+} auditState_t;
 
 #ifdef  __cplusplus
 extern "C" {
@@ -20,6 +109,34 @@ int
 fsckObjDir (rcComm_t *conn, rodsArguments_t *myRodsArgs, char *inpPath, char *hostname);
 int
 chkObjConsistency (rcComm_t *conn, rodsArguments_t *myRodsArgs, char *inpPath, char *hostname);
+int
+auditObjDir (rcComm_t *conn, rodsArguments_t *myRodsArgs, char *inpPath,
+char *hostname, int auditFlags);
+int
+openAuditCatCursor (rcComm_t *conn, rodsArguments_t *myRodsArgs, 
+char *inpPath, char *hostname, auditCatCursor_t *cursor);
+int
+nextAuditCatRow (auditCatCursor_t *cursor, auditCatRow_t *catRow);
+int
+closeAuditCatCursor (auditCatCursor_t *cursor);
+int
+listAuditDir (auditState_t *auditState, char *dirPath, 
+auditDir_t **outAuditDir);
+int
+nextAuditVaultFile (auditState_t *auditState);
+int
+freeAuditDir (auditDir_t *auditDir);
+int
+auditMatchedFile (auditState_t *auditState, auditCatRow_t *catRow,
+char *filePath, rodsLong_t fileSize);
+int
+queAuditTask (auditState_t *auditState, auditTask_t *auditTask);
+void
+runAuditTask (auditState_t *auditState, auditTask_t *auditTask);
+#ifdef PARA_OPR
+void *
+auditWorker (void *arg);
+#endif
 
 #ifdef  __cplusplus
 }
@@ -9,6 +9,18 @@
 #include "parseCommandLine.h"
 #include "rodsPath.h"
 
+/* the ACLs of the data objects of a collection, fetched by
+ * getDataAclInColl with one paged query instead of one per object */
+typedef struct dataAcl {
+    rodsLong_t dataId;
+    char *aclStr;		/* "user#zone:access   " for each ACL */
+} dataAcl_t;
+
+typedef struct dataAclList {
+    int len;
+    dataAcl_t *dataAcl;		/* sorted by dataId */
+} dataAclList_t;
+
 #ifdef  __cplusplus
 extern "C" {
 #endif
@@ -42,6 +54,13 @@ printDataAcl (rcComm_t *conn, char *dataId);
 int
 printCollAcl (rcComm_t *conn, char *collId);
 int
+getDataAclInColl (rcComm_t *conn, char *collName,
+dataAclList_t *dataAclList);
+int
+printDataAclInList (dataAclList_t *dataAclList, char *dataId);
+int
+clearDataAclList (dataAclList_t *dataAclList);
+int
 printCollInheritance (rcComm_t *conn, char *collName);
 int
 lsSpecDataObjUtilLong (rcComm_t *conn, rodsPath_t *srcPath, 
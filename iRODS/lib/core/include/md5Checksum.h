@@ -21,6 +21,8 @@ int verifyChksumLocFile(char *fileName, char *myChksum, char *chksumStr);
 int
 chksumLocFile (char *fileName, char *chksumStr, int use_sha256);
 int
+_chksumLocFile (char *fileName, char *chksumStr, int use_sha256);
+int
 md5ToStr (unsigned char *digest, char *chksumStr);
 int
 hashToStr (unsigned char *digest, char *digestStr);
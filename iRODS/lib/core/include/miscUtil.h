@@ -218,6 +218,9 @@ int
 queryDataObjAcl (rcComm_t *conn, char *dataId, char *zoneHint,
                  genQueryOut_t **genQueryOut);
 int
+queryDataObjAclInColl (rcComm_t *conn, char *collName, char *zoneHint,
+genQueryInp_t *genQueryInp, genQueryOut_t **genQueryOut);
+int
 queryCollAcl (rcComm_t *conn, char *collName, char *zoneHint,
               genQueryOut_t **genQueryOut);
 int
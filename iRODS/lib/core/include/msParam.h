@@ -149,6 +149,7 @@ typedef struct ValidKeyWd {
 #define BULK_OPR_FLAG 			0x4000000
 #define UNREG_FLAG 				0x8000000
 #define RESC_GROUP_NAME_FLAG	0x10000000
+#define STAGE_SHARD_FLAG	0x20000000
 
 int
 resetMsParam (msParam_t *msParam);
@@ -175,6 +176,9 @@ char *type, void *inOutStruct, bytesBuf_t *inpOutBuf);
 msParam_t *
 getMsParamByLabel (msParamArray_t *msParamArray, char *label);
 msParam_t *
+getMsParamByLabelIndexed (strIndex_t *strIndex, msParamArray_t *msParamArray,
+char *label);
+msParam_t *
 getMsParamByType (msParamArray_t *msParamArray, char *type);
 int
 rmMsParamByLabel (msParamArray_t *msParamArray, char *label, int freeStruct);
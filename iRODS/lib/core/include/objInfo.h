@@ -180,6 +180,22 @@ typedef struct KeyValPair {
     char **value;       /* pointer to an array of values */
 } keyValPair_t;
 
+/* strIndex_t - an optional hash index over the keyWords of a keyValPair_t
+ * or the labels of a msParamArray_t. It is kept by the caller next to
+ * the indexed struct (never packed), built lazily on the first indexed
+ * lookup and extended as entries are appended. Removals and in place
+ * changes of keys go through routines that invalidate all indexes. */
+#define STR_INDEX_MIN_LEN	16	/* shorter arrays are scanned linearly */
+#define STR_INDEX_INIT_SIZE	64	/* initial number of slots. Power of 2 */
+
+typedef struct StrIndex {
+    void *owner;		/* the indexed keyValPair_t or msParamArray_t */
+    int len;			/* number of entries of owner indexed */
+    int gen;			/* the index generation when built */
+    int size;			/* number of slots */
+    int *slot;			/* hash of key -> entry inx + 1. 0 - empty */
+} strIndex_t;
+
 /* definition for flags in dataObjInfo_t */
 #define NO_COMMIT_FLAG	0x1  /* used in chlModDataObjMeta and chlRegDataObj */
 
@@ -24,6 +24,9 @@ int
 sendApiRequest (rcComm_t *conn, int apiInx, void *inputStruct,
 bytesBuf_t *inputBsBBuf);
 int
+unpackWireOutStruct (rcComm_t *conn, int apiInx, bytesBuf_t *outStructBBuf,
+void **outStruct);
+int
 procApiReply (rcComm_t *conn, int apiInx, void **outStruct,
 bytesBuf_t *outBsBBuf,
 msgHeader_t *myHeader, bytesBuf_t *outStructBBuf, bytesBuf_t *myOutBsBBuf,
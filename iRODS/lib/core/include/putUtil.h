@@ -20,6 +20,23 @@ extern "C" {
 
 #define DEF_PHY_BUN_ROOT_DIR	"/tmp"
 
+/* a bulk put bundle being sent in the background while the next one
+ * is being read */
+typedef struct BulkPutInFlight {
+    rcComm_t *conn;
+    rodsArguments_t *rodsArgs;
+    bulkOprInp_t bulkOprInp;	/* own copy of condInput and attriArray */
+    bytesBuf_t bytesBuf;
+    int count;
+    int size;
+    char cachedTargPath[MAX_NAME_LEN];
+    int status;
+#ifdef PARA_OPR
+    pthread_t tid;
+#endif
+    int threadStarted;
+} bulkPutInFlight_t;
+
 typedef struct {
     int flags;
     int count;
@@ -31,6 +48,8 @@ typedef struct {
     char cachedSubPhyBunDir[MAX_NAME_LEN];
     char phyBunPath[MAX_NUM_BULK_OPR_FILES][MAX_NAME_LEN];
     bytesBuf_t bytesBuf;
+    int asyncFlag;		/* send the bundles in the background */
+    bulkPutInFlight_t *inFlight;
 } bulkOprInfo_t;
 
 int
@@ -66,6 +85,11 @@ int
 sendBulkPut (rcComm_t *conn, bulkOprInp_t *bulkOprInp,
 bulkOprInfo_t *bulkOprInfo, rodsArguments_t *rodsArgs);
 int
+sendBulkPutAsync (rcComm_t *conn, bulkOprInp_t *bulkOprInp,
+bulkOprInfo_t *bulkOprInfo, rodsArguments_t *rodsArgs);
+int
+waitBulkPut (bulkOprInfo_t *bulkOprInfo);
+int
 clearBulkOprInfo (bulkOprInfo_t *bulkOprInfo);
 int
 setForceFlagForRestart (bulkOprInp_t *bulkOprInp, bulkOprInfo_t *bulkOprInfo);
@@ -132,6 +132,7 @@ typedef struct {
     procState_t reconnThrState;
     operProgress_t operProgress;
     fileRestart_t fileRestart;
+    int wireOpt;	/* WIRE_OPT_ flags requested in the startupPack */
 #ifdef USE_SSL
     int ssl_on;
     SSL_CTX *ssl_ctx;
@@ -161,6 +162,7 @@ typedef struct {
     rodsEnv myEnv;	/* the local user */
     version_t cliVersion;      /* the client's version */
     char option[NAME_LEN];
+    int wireOpt;	/* WIRE_OPT_ flags agreed with the client */
     procLogFlag_t procLogFlag;
     rError_t rError;
     portalOpr_t *portalOpr;
@@ -219,6 +219,8 @@ validKeyWd_t CollInpKeyWd[] = {
         {COLL_NAME_FLAG,         COLL_NAME_KW},
         {IRODS_RMTRASH_FLAG,    IRODS_RMTRASH_KW},
         {IRODS_ADMIN_RMTRASH_FLAG,      IRODS_ADMIN_RMTRASH_KW},
+        {NUM_THREADS_FLAG,      NUM_THREADS_KW},
+        {STAGE_SHARD_FLAG,      STAGE_SHARD_KW},
 };
 
 int NumCollInpKeyWd = sizeof (CollInpKeyWd) / sizeof (validKeyWd_t);
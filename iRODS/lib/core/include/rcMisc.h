@@ -66,6 +66,16 @@ freeAllDataObjInfoDouble (dataObjInfo_t *dataObjInfoHead1,
                           dataObjInfo_t *dataObjInfoHead2);
 char *
 getValByKey (keyValPair_t *condInput, char *keyWord);
+char *
+getValByKeyIndexed (strIndex_t *strIndex, keyValPair_t *condInput,
+char *keyWord);
+int
+lookupStrIndex (strIndex_t *strIndex, void *owner, int len,
+char *(*getKeyFunc) (void *owner, int inx), char *key);
+void
+invalidStrIndexes ();
+int
+clearStrIndex (strIndex_t *strIndex);
 int
 getIvalByInx (inxIvalPair_t *inxIvalPair, int inx, int *outValue);
 char *
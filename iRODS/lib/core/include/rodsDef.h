@@ -256,6 +256,9 @@ typedef struct msgHeader {
 #define RODS_RECONNECT_T    "RODS_RECONNECT"
 #define RODS_REAUTH_T     "RODS_REAUTH"
 #define RODS_API_REPLY_T    "RODS_API_REPLY"
+#define RODS_API_CREPLY_T   "RODS_API_CREPLY" /* API reply with a wire encoded
+					       * outStruct. Only sent to
+					       * clients which asked for it */
 
 /* The strct sent with RODS_CONNECT type by client */
 typedef struct startupPack {
@@ -292,6 +295,22 @@ typedef struct startupPack {
 #define SP_LOG_LEVEL	"spLogLevel"
 #define SERVER_BOOT_TIME "serverBootTime"
 
+/* wire options. Requested by the client by appending WIRE_OPT_KW and the
+ * flags to the option of the startupPack. Old servers just see an odd
+ * option string and keep using the plain reply */
+#define IRODS_WIRE_OPT	"irodsWireOpt"	/* env variable - the wire options
+					 * requested (client) or allowed
+					 * (server) */
+#define WIRE_OPT_KW	";wireOpt="
+#define WIRE_OPT_ZLIB		0x1	/* zlib compressed outStruct */
+#ifdef ZLIB_COMPRESS
+#define WIRE_OPT_SUPPORTED	WIRE_OPT_ZLIB
+#else
+#define WIRE_OPT_SUPPORTED	0
+#endif
+#define WIRE_HEADER_LEN		8	/* flags and raw length of the body */
+#define WIRE_COMPRESS_MIN_LEN	4096	/* don't compress smaller msg */
+
 /* Definition for resource status. If it is empty (strlen == 0), it is
  * assumed to be up */
 #define RESC_DOWN	"down"
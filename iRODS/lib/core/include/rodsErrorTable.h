@@ -240,6 +240,7 @@
 #define UNIX_FILE_RENAME_ERR		-528000 
 #define UNIX_FILE_TRUNCATE_ERR		-529000 
 #define UNIX_FILE_LINK_ERR		-530000 
+#define UNIX_FILE_AIO_ERR		-531000 
 #define UNIX_FILE_OPR_TIMEOUT_ERR	-540000 
 
 /* universal MSS driver error */
@@ -54,6 +54,7 @@
 #define RSYNC_MODE_KW    "rsyncMode"
 #define RSYNC_DEST_PATH_KW    "rsyncDestPath"
 #define RSYNC_CHKSUM_KW    "rsyncChksum"
+#define DELTA_BLOCK_SIZE_KW    "deltaBlockSize"
 #define CHKSUM_ALL_KW    "ChksumAll"
 #define FORCE_CHKSUM_KW    "forceChksum"
 #define COLLECTION_KW    "collection"
@@ -118,6 +119,12 @@
 #define MAX_SUB_FILE_KW "maxSubFile" /* max number of files for tar file bundles */
 #define MAX_BUNDLE_SIZE_KW "maxBunSize" /* max size of a tar bundle in Gbs */
 #define NO_STAGING_KW			"noStaging"
+#define STAGE_PREFETCH_KW	"stagePrefetch"	/* stage the siblings of a
+						 * staged object */
+#define STAGE_SHARD_KW		"stageShard" /* a msKeyValStr keyword.
+					      * index/count of the shard */
+#define NO_PHY_PATH_SYNC_KW	"noPhyPathSync" /* a collection rename keeps
+						 * the vault paths */
 #define NEW_NETCDF_ARCH_KW			"newNetcdfArch"
 /* OBJ_PATH_KW already defined */ 
 /* COLL_NAME_KW already defined */ 
@@ -0,0 +1,67 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* rodsLogBuf.h - header file for rodsLogBuf.c, the asynchronous buffered
+ * and structured backend of rodsLog for server processes.
+ */
+
+#ifndef RODS_LOG_BUF_H
+#define RODS_LOG_BUF_H
+
+#include "rodsDef.h"
+
+/* env variables read by the server processes. They can be set in
+ * server.env or irodsctl */
+#define SP_LOG_BUFFERED		"spLogBuffered"	  /* 1 - async ring buffer */
+#define SP_LOG_FORMAT		"spLogFormat"	  /* text, kv or json */
+#define SP_LOG_RATE_LIMIT	"spLogRateLimit"  /* max repeats per sec */
+
+/* definition for LogBufFormat */
+#define LOG_FORMAT_TEXT		0	/* the traditional rodsLog format */
+#define LOG_FORMAT_KV		1	/* key=value pairs */
+#define LOG_FORMAT_JSON		2	/* one JSON object per line */
+
+#define LOG_BUF_SLOT_CNT	1024	/* must be a power of 2 */
+#define LOG_BUF_SLOT_MASK	(LOG_BUF_SLOT_CNT - 1)
+#define LOG_BUF_REC_LEN		(2 * (MAX_NAME_LEN + 300) + 256)
+#define LOG_BUF_IOV_CNT		64	/* max records per writev */
+#define LOG_BUF_IDLE_USEC	5000	/* writer sleep time when idle */
+#define LOG_BUF_FULL_USEC	1000	/* producer sleep time when full */
+#define LOG_BUF_DRAIN_WAIT_CNT	200	/* max idle periods to wait in drain */
+
+#define LOG_RATE_TABLE_SZ	128	/* must be a power of 2 */
+#define LOG_RATE_WINDOW		1	/* rate limit window in sec */
+
+typedef struct {
+    volatile unsigned int seq;	/* Vyukov style sequence number */
+    int len;
+    char rec[LOG_BUF_REC_LEN];
+} logBufSlot_t;
+
+typedef struct {
+    char *formatStr;	/* call site key. rodsLog format strings are
+			 * literals so the pointer identifies the site */
+    time_t windowStart;
+    int cnt;
+    int suppressed;
+} logRateEnt_t;
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+int
+rodsLogBufWrite (int level, char *prefix, char *msg);
+int
+rodsLogRateLimited (int level, char *formatStr);
+void
+rodsLogBufFlush ();
+int
+getLogBufStat (unsigned int *queuedCnt, unsigned int *syncCnt,
+unsigned int *suppressedCnt);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif	/* RODS_LOG_BUF_H */
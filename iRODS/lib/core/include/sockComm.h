@@ -39,6 +39,27 @@
 						 * RECONN_TIMEOUT if this
 						 * env is set */
 
+/* the pool of receive buffers of readMsgBodyToPool. Buffers larger than
+ * RECV_BUF_POOL_MAX_LEN are not kept */
+#define RECV_BUF_POOL_SIZE	6
+#define RECV_BUF_MIN_SIZE	(4*1024)
+#define RECV_BUF_POOL_MAX_LEN	(4*1024*1024)
+
+/* definition for the poolFlags of readMsgBodyToPool */
+#define RECV_POOL_MSG	0x1	/* the msg and error buffers */
+#define RECV_POOL_BS	0x2	/* the byte stream buffer if not given */
+
+/* counters of the msg framing. Not locked, so they are approximate in
+ * multi-threaded clients */
+typedef struct sockCommStat {
+    rodsLong_t numMsgSent;
+    rodsLong_t numMsgRecv;
+    rodsLong_t numWriteCalls;	/* write/writev system calls */
+    rodsLong_t numReadCalls;	/* read/readv system calls */
+    rodsLong_t numBufAlloc;	/* receive buffers malloc'ed */
+    rodsLong_t numBufReuse;	/* receive buffers taken from the pool */
+} sockCommStat_t;
+
 /* definition for socket close function */
 #define READING_FROM_CLI	0
 #define PROCESSING_API		1
@@ -75,6 +96,14 @@ int sendRodsMsg (int sock, char *msgType, bytesBuf_t *msgBBuf,
 bytesBuf_t *byteStreamBBuf, bytesBuf_t *errorBBuf, int intInfo,
 irodsProt_t irodsProt);
 int
+getWireOpt ();
+int
+parseWireOpt (char *option);
+int
+encodeWireMsg (bytesBuf_t *inBBuf, int wireOpt, bytesBuf_t *outBBuf);
+int
+decodeWireMsg (bytesBuf_t *inBBuf, int *outWireOpt, bytesBuf_t *outBBuf);
+int
 sendVersion (int sock, int versionStatus, int reconnPort, 
 char *reconnAddr, int cookie);
 int
@@ -82,6 +111,16 @@ readMsgBody (int sock, msgHeader_t *myHeader, bytesBuf_t *inputStructBBuf,
 bytesBuf_t *bsBBuf, bytesBuf_t *errorBBuf, irodsProt_t irodsProt,
 struct timeval *tv);
 int
+readMsgBodyToPool (int sock, msgHeader_t *myHeader,
+bytesBuf_t *inputStructBBuf, bytesBuf_t *bsBBuf, bytesBuf_t *errorBBuf,
+irodsProt_t irodsProt, struct timeval *tv, int poolFlags);
+int
+clearRecvBBuf (bytesBuf_t *myBBuf);
+int
+getSockCommStat (sockCommStat_t *outStat);
+int
+logSockCommStat (char *caller);
+int
 connectToRhostPortal (char *rodsHost, int rodsPort, int cookie,
 int windowSize);
 int
@@ -0,0 +1,618 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* chksumCache.c - a persistent cache of the checksums of local files.
+ * irsync and iput -K hash every local file whose target already exists.
+ * With the cache, a file which has not changed since it was last hashed
+ * (same dev, inode, size, mtime and ctime) is not read again.
+ * The cache is an open addressing hash table in a file under ~/.irods,
+ * memory mapped by each client and shared between them with flock. The
+ * file is replaced (by rename) when it grows or is pruned. A client which
+ * still maps the old file notices it when it takes the lock.
+ */
+
+#include "chksumCache.h"
+#include "md5Checksum.h"
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+
+#ifndef windows_platform
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <dirent.h>
+#include <pthread.h>
+
+static pthread_mutex_t chksumCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static int chksumCacheInited = 0;
+static char chksumCachePath[MAX_NAME_LEN];	/* empty - not in use */
+static int chksumCacheFd = -1;
+static chksumCacheHeader_t *chksumCacheMap = NULL;
+static size_t chksumCacheMapLen = 0;
+
+#define CHKSUM_CACHE_SLOTS(header) ((chksumCacheEnt_t *) ((header) + 1))
+
+static size_t
+chksumCacheFileLen (unsigned int numSlots)
+{
+    return (sizeof (chksumCacheHeader_t) +
+      (size_t) numSlots * sizeof (chksumCacheEnt_t));
+}
+
+/* initChksumCachePath - read CHKSUM_CACHE_ENV once. Called with
+ * chksumCacheMutex locked */
+static void
+initChksumCachePath ()
+{
+    char *tmpStr, *homeDir;
+
+    if (chksumCacheInited) return;
+    chksumCacheInited = 1;
+    chksumCachePath[0] = '\0';
+
+    tmpStr = getenv (CHKSUM_CACHE_ENV);
+    if (tmpStr == NULL || *tmpStr == '\0' || strcmp (tmpStr, "0") == 0)
+	return;
+
+    if (strcmp (tmpStr, "1") == 0) {
+	if ((homeDir = getenv ("HOME")) == NULL) return;
+	snprintf (chksumCachePath, MAX_NAME_LEN, "%s%s", homeDir,
+	  CHKSUM_CACHE_FILE);
+    } else {
+	rstrcpy (chksumCachePath, tmpStr, MAX_NAME_LEN);
+    }
+}
+
+static int
+initChksumCacheFile (int fd, unsigned int numSlots)
+{
+    chksumCacheHeader_t header;
+
+    if (ftruncate (fd, 0) < 0 ||
+      ftruncate (fd, chksumCacheFileLen (numSlots)) < 0) {
+	return (UNIX_FILE_TRUNCATE_ERR - errno);
+    }
+    memset (&header, 0, sizeof (header));
+    header.magic = CHKSUM_CACHE_MAGIC;
+    header.version = CHKSUM_CACHE_VERSION;
+    header.numSlots = numSlots;
+    if (pwrite (fd, &header, sizeof (header), 0) != sizeof (header)) {
+	return (UNIX_FILE_WRITE_ERR - errno);
+    }
+    return (0);
+}
+
+static void
+unmapChksumCache ()
+{
+    if (chksumCacheMap != NULL) {
+	munmap ((void *) chksumCacheMap, chksumCacheMapLen);
+	chksumCacheMap = NULL;
+    }
+    if (chksumCacheFd >= 0) {
+	close (chksumCacheFd);
+	chksumCacheFd = -1;
+    }
+}
+
+/* mapChksumCache - open and map the cache file, creating or
+ * reinitializing it if it is not a valid cache */
+static int
+mapChksumCache ()
+{
+    chksumCacheHeader_t header;
+    struct stat statbuf;
+    void *myMap;
+    int status;
+
+    chksumCacheFd = open (chksumCachePath, O_RDWR | O_CREAT, 0600);
+    if (chksumCacheFd < 0) {
+	return (UNIX_FILE_OPEN_ERR - errno);
+    }
+    flock (chksumCacheFd, LOCK_EX);
+    if (fstat (chksumCacheFd, &statbuf) < 0) {
+	status = UNIX_FILE_STAT_ERR - errno;
+    } else if (pread (chksumCacheFd, &header, sizeof (header), 0) !=
+      sizeof (header) || header.magic != CHKSUM_CACHE_MAGIC ||
+      header.version != CHKSUM_CACHE_VERSION || header.numSlots == 0 ||
+      (header.numSlots & (header.numSlots - 1)) != 0 ||
+      header.numSlots > MAX_CHKSUM_CACHE_SLOTS ||
+      (size_t) statbuf.st_size != chksumCacheFileLen (header.numSlots)) {
+	/* new or bad file */
+	header.numSlots = DEF_CHKSUM_CACHE_SLOTS;
+	status = initChksumCacheFile (chksumCacheFd, header.numSlots);
+    } else {
+	status = 0;
+    }
+    if (status >= 0) {
+	chksumCacheMapLen = chksumCacheFileLen (header.numSlots);
+	myMap = mmap (NULL, chksumCacheMapLen, PROT_READ | PROT_WRITE,
+	  MAP_SHARED, chksumCacheFd, 0);
+	if (myMap == MAP_FAILED) {
+	    status = SYS_MALLOC_ERR - errno;
+	} else {
+	    chksumCacheMap = (chksumCacheHeader_t *) myMap;
+	}
+    }
+    flock (chksumCacheFd, LOCK_UN);
+    if (status < 0) unmapChksumCache ();
+    return (status);
+}
+
+/* lockChksumCache - lock the cache for this thread and for the other
+ * clients. Returns a negative value if the cache is not in use. */
+static int
+lockChksumCache ()
+{
+    struct stat pathStat, fdStat;
+    int status, i;
+
+    pthread_mutex_lock (&chksumCacheMutex);
+    initChksumCachePath ();
+    if (chksumCachePath[0] == '\0') {
+	pthread_mutex_unlock (&chksumCacheMutex);
+	return (SYS_NOT_SUPPORTED);
+    }
+
+    for (i = 0; i < 3; i++) {
+	if (chksumCacheFd < 0 && (status = mapChksumCache ()) < 0) {
+	    rodsLogError (LOG_NOTICE, status,
+	      "lockChksumCache: cannot use the checksum cache %s",
+	      chksumCachePath);
+	    /* don't try again in this process */
+	    chksumCachePath[0] = '\0';
+	    pthread_mutex_unlock (&chksumCacheMutex);
+	    return (status);
+	}
+	flock (chksumCacheFd, LOCK_EX);
+	/* make sure the file has not been replaced by another client */
+	if (stat (chksumCachePath, &pathStat) == 0 &&
+	  fstat (chksumCacheFd, &fdStat) == 0 &&
+	  pathStat.st_dev == fdStat.st_dev &&
+	  pathStat.st_ino == fdStat.st_ino) {
+	    return (0);
+	}
+	flock (chksumCacheFd, LOCK_UN);
+	unmapChksumCache ();
+    }
+    pthread_mutex_unlock (&chksumCacheMutex);
+    return (SYS_NOT_SUPPORTED);
+}
+
+static void
+unlockChksumCache ()
+{
+    flock (chksumCacheFd, LOCK_UN);
+    pthread_mutex_unlock (&chksumCacheMutex);
+}
+
+static int
+statChksumCacheKey (char *fileName, int hashType, chksumCacheEnt_t *cacheKey)
+{
+    struct stat statbuf;
+
+    if (stat (fileName, &statbuf) < 0) {
+	return (UNIX_FILE_STAT_ERR - errno);
+    }
+    memset (cacheKey, 0, sizeof (chksumCacheEnt_t));
+    cacheKey->dev = statbuf.st_dev;
+    cacheKey->ino = statbuf.st_ino;
+    cacheKey->size = statbuf.st_size;
+    cacheKey->mtime = (rodsLong_t) statbuf.st_mtime * 1000000000;
+    cacheKey->ctime = (rodsLong_t) statbuf.st_ctime * 1000000000;
+#if defined(linux_platform)
+    cacheKey->mtime += statbuf.st_mtim.tv_nsec;
+    cacheKey->ctime += statbuf.st_ctim.tv_nsec;
+#elif defined(osx_platform)
+    cacheKey->mtime += statbuf.st_mtimespec.tv_nsec;
+    cacheKey->ctime += statbuf.st_ctimespec.tv_nsec;
+#endif
+    cacheKey->hashType = hashType;
+    return (0);
+}
+
+static int
+matchChksumCacheKey (chksumCacheEnt_t *cacheEnt, chksumCacheEnt_t *cacheKey)
+{
+    return (cacheEnt->hashType == cacheKey->hashType &&
+      cacheEnt->dev == cacheKey->dev && cacheEnt->ino == cacheKey->ino &&
+      cacheEnt->size == cacheKey->size &&
+      cacheEnt->mtime == cacheKey->mtime &&
+      cacheEnt->ctime == cacheKey->ctime);
+}
+
+static unsigned int
+hashChksumCacheKey (chksumCacheHeader_t *header, chksumCacheEnt_t *cacheKey)
+{
+    rodsULong_t hash;
+
+    hash = (rodsULong_t) cacheKey->ino * 0x9E3779B97F4A7C15ULL ^
+      (rodsULong_t) cacheKey->dev * 0xC2B2AE3D27D4EB4FULL ^
+      (rodsULong_t) cacheKey->hashType;
+    hash ^= hash >> 29;
+    return ((unsigned int) hash & (header->numSlots - 1));
+}
+
+/* findChksumCacheEnt - return the slot of the file of cacheKey, or the
+ * empty slot to put it in, or NULL if the table is full */
+static chksumCacheEnt_t *
+findChksumCacheEnt (chksumCacheHeader_t *header, chksumCacheEnt_t *cacheKey)
+{
+    chksumCacheEnt_t *slots = CHKSUM_CACHE_SLOTS (header);
+    unsigned int mask = header->numSlots - 1;
+    unsigned int inx, i;
+
+    inx = hashChksumCacheKey (header, cacheKey);
+
+    for (i = 0; i < header->numSlots; i++) {
+	chksumCacheEnt_t *cacheEnt = &slots[inx];
+	if (cacheEnt->hashType == CHKSUM_CACHE_EMPTY ||
+	  (cacheEnt->hashType == cacheKey->hashType &&
+	  cacheEnt->dev == cacheKey->dev && cacheEnt->ino == cacheKey->ino))
+	    return (cacheEnt);
+	inx = (inx + 1) & mask;
+    }
+    return (NULL);
+}
+
+/* rebuildChksumCache - replace the cache file by one with numSlots slots
+ * and the entries used since minLastUsed. Called with the cache locked.
+ * Returns the number of entries dropped. */
+static int
+rebuildChksumCache (unsigned int numSlots, unsigned int minLastUsed)
+{
+    char tmpPath[MAX_NAME_LEN + 8];	/* the cache path plus .XXXXXX */
+    chksumCacheHeader_t *newMap;
+    chksumCacheEnt_t *slots, *cacheEnt;
+    size_t newMapLen;
+    void *myMap;
+    unsigned int i;
+    int newFd, status;
+    int dropCnt = 0;
+
+    snprintf (tmpPath, sizeof (tmpPath), "%s.XXXXXX", chksumCachePath);
+    if ((newFd = mkstemp (tmpPath)) < 0) {
+	return (UNIX_FILE_CREATE_ERR - errno);
+    }
+    flock (newFd, LOCK_EX);
+    if ((status = initChksumCacheFile (newFd, numSlots)) < 0) {
+	close (newFd);
+	unlink (tmpPath);
+	return (status);
+    }
+    newMapLen = chksumCacheFileLen (numSlots);
+    myMap = mmap (NULL, newMapLen, PROT_READ | PROT_WRITE, MAP_SHARED,
+      newFd, 0);
+    if (myMap == MAP_FAILED) {
+	status = SYS_MALLOC_ERR - errno;
+	close (newFd);
+	unlink (tmpPath);
+	return (status);
+    }
+    newMap = (chksumCacheHeader_t *) myMap;
+    newMap->hits = chksumCacheMap->hits;
+    newMap->misses = chksumCacheMap->misses;
+
+    slots = CHKSUM_CACHE_SLOTS (chksumCacheMap);
+    for (i = 0; i < chksumCacheMap->numSlots; i++) {
+	if (slots[i].hashType == CHKSUM_CACHE_EMPTY) continue;
+	if (slots[i].lastUsed < minLastUsed ||
+	  (cacheEnt = findChksumCacheEnt (newMap, &slots[i])) == NULL) {
+	    dropCnt++;
+	    continue;
+	}
+	*cacheEnt = slots[i];
+	newMap->numUsed++;
+    }
+
+    if (rename (tmpPath, chksumCachePath) < 0) {
+	status = UNIX_FILE_RENAME_ERR - errno;
+	munmap (myMap, newMapLen);
+	close (newFd);
+	unlink (tmpPath);
+	return (status);
+    }
+
+    /* the new file is already locked */
+    flock (chksumCacheFd, LOCK_UN);
+    unmapChksumCache ();
+    chksumCacheFd = newFd;
+    chksumCacheMap = newMap;
+    chksumCacheMapLen = newMapLen;
+
+    return (dropCnt);
+}
+
+/* getChksumCache - look up the chksum of the local file fileName in the
+ * cache. cacheKey is filled with the current state of the file for
+ * putChksumCache.
+ * Returns 1 and the chksum in chksumStr if the file has not changed
+ * since it was cached, 0 if it has to be hashed and a negative value if
+ * the cache is not in use.
+ */
+int
+getChksumCache (char *fileName, int use_sha256, chksumCacheEnt_t *cacheKey,
+char *chksumStr)
+{
+    chksumCacheEnt_t *cacheEnt;
+    int status;
+
+    status = statChksumCacheKey (fileName,
+      use_sha256 ? CHKSUM_CACHE_SHA256 : CHKSUM_CACHE_MD5, cacheKey);
+    if (status < 0) return (status);
+
+    if ((status = lockChksumCache ()) < 0) return (status);
+
+    cacheEnt = findChksumCacheEnt (chksumCacheMap, cacheKey);
+    if (cacheEnt != NULL && matchChksumCacheKey (cacheEnt, cacheKey)) {
+	rstrcpy (chksumStr, cacheEnt->chksum, CHKSUM_LEN);
+	cacheEnt->lastUsed = time (NULL);
+	chksumCacheMap->hits++;
+	status = 1;
+    } else {
+	chksumCacheMap->misses++;
+	status = 0;
+    }
+    unlockChksumCache ();
+    return (status);
+}
+
+/* putChksumCache - cache the chksum of fileName. cacheKey is the state of
+ * the file from getChksumCache before it was hashed. Nothing is cached
+ * if the file changed while it was hashed. */
+int
+putChksumCache (char *fileName, chksumCacheEnt_t *cacheKey, char *chksumStr)
+{
+    chksumCacheEnt_t myKey;
+    chksumCacheEnt_t *cacheEnt;
+    int status;
+
+    status = statChksumCacheKey (fileName, cacheKey->hashType, &myKey);
+    if (status < 0) return (status);
+    if (!matchChksumCacheKey (&myKey, cacheKey)) return (0);
+
+    if ((status = lockChksumCache ()) < 0) return (status);
+
+    if ((chksumCacheMap->numUsed + 1) * 4 > chksumCacheMap->numSlots * 3 &&
+      chksumCacheMap->numSlots < MAX_CHKSUM_CACHE_SLOTS) {
+	status = rebuildChksumCache (chksumCacheMap->numSlots * 2, 0);
+	if (status < 0) {
+	    rodsLogError (LOG_NOTICE, status,
+	      "putChksumCache: cannot grow the checksum cache %s",
+	      chksumCachePath);
+	}
+    }
+    if ((cacheEnt = findChksumCacheEnt (chksumCacheMap, &myKey)) == NULL) {
+	/* full. Overwrite the first slot of the key */
+	cacheEnt = CHKSUM_CACHE_SLOTS (chksumCacheMap) +
+	  hashChksumCacheKey (chksumCacheMap, &myKey);
+    }
+    if (cacheEnt->hashType == CHKSUM_CACHE_EMPTY) chksumCacheMap->numUsed++;
+    *cacheEnt = myKey;
+    rstrcpy (cacheEnt->chksum, chksumStr, CHKSUM_LEN);
+    cacheEnt->lastUsed = time (NULL);
+    unlockChksumCache ();
+    return (0);
+}
+
+/* pruneChksumCache - drop the entries not used in the last ageInMin
+ * minutes and shrink the cache file to fit. Returns the number of
+ * entries dropped. */
+int
+pruneChksumCache (int ageInMin)
+{
+    chksumCacheEnt_t *slots;
+    unsigned int minLastUsed, numSlots, keepCnt = 0;
+    unsigned int i;
+    int status;
+
+    if ((status = lockChksumCache ()) < 0) return (status);
+
+    if (ageInMin > 0) {
+	minLastUsed = time (NULL) - ageInMin * 60;
+    } else {
+	minLastUsed = 0;
+    }
+    slots = CHKSUM_CACHE_SLOTS (chksumCacheMap);
+    for (i = 0; i < chksumCacheMap->numSlots; i++) {
+	if (slots[i].hashType != CHKSUM_CACHE_EMPTY &&
+	  slots[i].lastUsed >= minLastUsed) keepCnt++;
+    }
+    numSlots = DEF_CHKSUM_CACHE_SLOTS;
+    while (keepCnt * 2 > numSlots && numSlots < MAX_CHKSUM_CACHE_SLOTS)
+	numSlots *= 2;
+
+    status = rebuildChksumCache (numSlots, minLastUsed);
+    unlockChksumCache ();
+    return (status);
+}
+
+int
+printChksumCacheStat ()
+{
+    chksumCacheEnt_t *slots;
+    unsigned int i, oldest = 0;
+    int md5Cnt = 0, sha256Cnt = 0;
+    int status;
+
+    if ((status = lockChksumCache ()) < 0) {
+	if (status == SYS_NOT_SUPPORTED) {
+	    printf ("The checksum cache is not in use. Set %s to use it.\n",
+	      CHKSUM_CACHE_ENV);
+	    return (0);
+	}
+	return (status);
+    }
+
+    slots = CHKSUM_CACHE_SLOTS (chksumCacheMap);
+    for (i = 0; i < chksumCacheMap->numSlots; i++) {
+	if (slots[i].hashType == CHKSUM_CACHE_EMPTY) continue;
+	if (slots[i].hashType == CHKSUM_CACHE_SHA256) {
+	    sha256Cnt++;
+	} else {
+	    md5Cnt++;
+	}
+	if (oldest == 0 || slots[i].lastUsed < oldest)
+	    oldest = slots[i].lastUsed;
+    }
+    printf ("cache file:    %s\n", chksumCachePath);
+    printf ("file size:     %lld\n", (rodsLong_t) chksumCacheMapLen);
+    printf ("slots:         %u\n", chksumCacheMap->numSlots);
+    printf ("entries:       %u (md5 %d, sha2 %d)\n", chksumCacheMap->numUsed,
+      md5Cnt, sha256Cnt);
+    printf ("hits:          %lld\n", chksumCacheMap->hits);
+    printf ("misses:        %lld\n", chksumCacheMap->misses);
+    if (oldest > 0) {
+	time_t myTime = oldest;
+	printf ("oldest use:    %s", ctime (&myTime));
+    }
+    unlockChksumCache ();
+    return (0);
+}
+
+/* verifyChksumCacheFile - hash fileName again and compare the result with
+ * its cached chksums. A wrong entry is replaced. */
+static int
+verifyChksumCacheFile (rodsArguments_t *myRodsArgs, char *fileName,
+int *fileCnt, int *mismatchCnt)
+{
+    chksumCacheEnt_t cacheKey;
+    char cachedChksum[CHKSUM_LEN], chksumStr[CHKSUM_LEN];
+    int use_sha256;
+    int status;
+
+    for (use_sha256 = 0; use_sha256 <= 1; use_sha256++) {
+	status = getChksumCache (fileName, use_sha256, &cacheKey,
+	  cachedChksum);
+	if (status <= 0) continue;
+	status = _chksumLocFile (fileName, chksumStr, use_sha256);
+	if (status < 0) {
+	    rodsLogError (LOG_ERROR, status,
+	      "verifyChksumCacheFile: _chksumLocFile error for %s", fileName);
+	    return (status);
+	}
+	(*fileCnt)++;
+	if (strcmp (cachedChksum, chksumStr) != 0) {
+	    (*mismatchCnt)++;
+	    printf ("%s: cached chksum %s does not match %s\n", fileName,
+	      cachedChksum, chksumStr);
+	    putChksumCache (fileName, &cacheKey, chksumStr);
+	} else if (myRodsArgs->verbose == True) {
+	    printf ("%s    %s\n", fileName, chksumStr);
+	}
+    }
+    return (0);
+}
+
+static int
+verifyChksumCacheDir (rodsArguments_t *myRodsArgs, char *dirPath,
+int *fileCnt, int *mismatchCnt)
+{
+    DIR *dirPtr;
+    struct dirent *myDirent;
+    struct stat statbuf;
+    char childPath[MAX_NAME_LEN];
+    int status;
+    int savedStatus = 0;
+
+    if ((dirPtr = opendir (dirPath)) == NULL) {
+	status = USER_INPUT_PATH_ERR - errno;
+	rodsLogError (LOG_ERROR, status,
+	  "verifyChksumCacheDir: opendir error for %s", dirPath);
+	return (status);
+    }
+    while ((myDirent = readdir (dirPtr)) != NULL) {
+	if (strcmp (myDirent->d_name, ".") == 0 ||
+	  strcmp (myDirent->d_name, "..") == 0) continue;
+	snprintf (childPath, MAX_NAME_LEN, "%s/%s", dirPath,
+	  myDirent->d_name);
+	if (lstat (childPath, &statbuf) < 0) continue;
+	if (S_ISREG (statbuf.st_mode)) {
+	    status = verifyChksumCacheFile (myRodsArgs, childPath, fileCnt,
+	      mismatchCnt);
+	} else if (S_ISDIR (statbuf.st_mode)) {
+	    status = verifyChksumCacheDir (myRodsArgs, childPath, fileCnt,
+	      mismatchCnt);
+	} else {
+	    status = 0;
+	}
+	if (status < 0) savedStatus = status;
+    }
+    closedir (dirPtr);
+    return (savedStatus);
+}
+
+/* verifyChksumCacheUtil - verify the cached chksums of the local files
+ * in pathArray (and under the directories with -r) by hashing the files
+ * again. Returns USER_CHKSUM_MISMATCH if a cached chksum was wrong. */
+int
+verifyChksumCacheUtil (rodsArguments_t *myRodsArgs, int numPath,
+char **pathArray)
+{
+    struct stat statbuf;
+    int fileCnt = 0, mismatchCnt = 0;
+    int status, i;
+    int savedStatus = 0;
+
+    for (i = 0; i < numPath; i++) {
+	if (stat (pathArray[i], &statbuf) < 0) {
+	    status = USER_INPUT_PATH_ERR - errno;
+	    rodsLogError (LOG_ERROR, status,
+	      "verifyChksumCacheUtil: stat error for %s", pathArray[i]);
+	} else if (S_ISDIR (statbuf.st_mode)) {
+	    if (myRodsArgs->recursive != True) {
+		rodsLog (LOG_ERROR,
+		  "verifyChksumCacheUtil: -r option must be used for dir %s",
+		  pathArray[i]);
+		status = USER_INPUT_OPTION_ERR;
+	    } else {
+		status = verifyChksumCacheDir (myRodsArgs, pathArray[i],
+		  &fileCnt, &mismatchCnt);
+	    }
+	} else {
+	    status = verifyChksumCacheFile (myRodsArgs, pathArray[i],
+	      &fileCnt, &mismatchCnt);
+	}
+	if (status < 0) savedStatus = status;
+    }
+    printf ("verified %d cached chksums, %d mismatches\n", fileCnt,
+      mismatchCnt);
+
+    if (savedStatus < 0) return (savedStatus);
+    if (mismatchCnt > 0) return (USER_CHKSUM_MISMATCH);
+    return (0);
+}
+
+#else	/* windows_platform */
+
+int
+getChksumCache (char *fileName, int use_sha256, chksumCacheEnt_t *cacheKey,
+char *chksumStr)
+{
+    return (SYS_NOT_SUPPORTED);
+}
+
+int
+putChksumCache (char *fileName, chksumCacheEnt_t *cacheKey, char *chksumStr)
+{
+    return (SYS_NOT_SUPPORTED);
+}
+
+int
+pruneChksumCache (int ageInMin)
+{
+    return (SYS_NOT_SUPPORTED);
+}
+
+int
+printChksumCacheStat ()
+{
+    return (SYS_NOT_SUPPORTED);
+}
+
+int
+verifyChksumCacheUtil (rodsArguments_t *myRodsArgs, int numPath,
+char **pathArray)
+{
+    return (SYS_NOT_SUPPORTED);
+}
+
+#endif	/* windows_platform */
@@ -0,0 +1,507 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* deltaUtil.c - block level delta upload of a modified local file
+ * (the rsync algorithm). The server returns a weak rolling checksum and
+ * an md5 digest for each block of the replica (DELTA_SIG_OPR). The client
+ * rolls the weak checksum over the local file one byte at a time. A window
+ * whose weak and strong sums match a block is sent as a copy of that
+ * block and everything else is sent as data (DELTA_APPLY_OPR). The server
+ * writes the new content next to the replica and renames it over the
+ * replica once its checksum is verified (DELTA_COMMIT_OPR).
+ */
+
+#include "deltaUtil.h"
+#include "md5Checksum.h"
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+
+/* rsync's weak checksum. s1 is the sum of the bytes of the window and
+ * s2 the sum of the running s1 */
+#define DELTA_WEAK(s1, s2)	(((s1) & 0xffff) | ((s2) << 16))
+
+typedef struct DeltaGen {
+    rcComm_t *conn;
+    dataObjInp_t *dataObjInp;
+    unsigned char *sig;		/* the signature buffer from the server */
+    int blockSize;
+    int numBlocks;
+    rodsLong_t targSize;	/* size of the replica */
+    int *hashHead;
+    int *hashNext;
+    int hashShift;
+    unsigned char *outBuf;	/* the delta records not sent yet */
+    int outLen;
+    rodsLong_t chunkOffset;	/* offset of the new content at outBuf */
+    rodsLong_t outOffset;	/* offset of the new content at outLen */
+    int copyInx;		/* pending run of copied blocks */
+    int copyCnt;
+    int applyCnt;		/* number of DELTA_APPLY_OPR calls */
+    rodsLong_t dataBytes;
+    rodsLong_t maxDataBytes;
+} deltaGen_t;
+
+#define DELTA_HASH(gen, weak)	(((weak) * 2654435761U) >> (gen)->hashShift)
+#define DELTA_SIG_ENT(gen, inx) \
+    ((gen)->sig + DELTA_SIG_HEADER_LEN + (inx) * DELTA_SIG_ENT_LEN)
+
+int
+getDeltaBlockSize (rodsLong_t fileSize)
+{
+    rodsLong_t blockSize = DEF_DELTA_BLOCK_SIZE;
+
+    while ((fileSize + blockSize - 1) / blockSize > MAX_DELTA_BLOCKS) {
+	blockSize *= 2;
+    }
+    return ((int) blockSize);
+}
+
+unsigned int
+deltaWeakSum (unsigned char *buf, int len)
+{
+    unsigned int s1 = 0;
+    unsigned int s2 = 0;
+    int i;
+
+    for (i = 0; i < len; i++) {
+	s1 += buf[i];
+	s2 += s1;
+    }
+    return (DELTA_WEAK (s1, s2));
+}
+
+void
+deltaStrongSum (unsigned char *buf, int len, unsigned char *digest)
+{
+    MD5_CTX context;
+
+    MD5Init (&context);
+    MD5Update (&context, buf, len);
+    MD5Final (digest, &context);
+}
+
+void
+putDeltaInt (unsigned char *ptr, unsigned int val)
+{
+    ptr[0] = (val >> 24) & 0xff;
+    ptr[1] = (val >> 16) & 0xff;
+    ptr[2] = (val >> 8) & 0xff;
+    ptr[3] = val & 0xff;
+}
+
+unsigned int
+getDeltaInt (unsigned char *ptr)
+{
+    return (((unsigned int) ptr[0] << 24) | ((unsigned int) ptr[1] << 16) |
+      ((unsigned int) ptr[2] << 8) | (unsigned int) ptr[3]);
+}
+
+rodsLong_t
+getDeltaMinSize ()
+{
+    static int deltaMinSizeInited = 0;
+    static rodsLong_t deltaMinSize = DEF_DELTA_MIN_SIZE;
+    char *tmpStr;
+
+    if (deltaMinSizeInited == 0) {
+	deltaMinSizeInited = 1;
+	if ((tmpStr = getenv (DELTA_MIN_SIZE_ENV)) != NULL &&
+	  strlen (tmpStr) > 0) {
+	    deltaMinSize = strtoll (tmpStr, 0, 0);
+	}
+    }
+    return (deltaMinSize);
+}
+
+static int
+flushDeltaChunk (deltaGen_t *gen)
+{
+    bytesBuf_t deltaBBuf, outBBuf;
+    int status;
+
+    if (gen->outLen <= 0) return (0);
+
+    deltaBBuf.buf = gen->outBuf;
+    deltaBBuf.len = gen->outLen;
+    bzero (&outBBuf, sizeof (outBBuf));
+    gen->dataObjInp->oprType = DELTA_APPLY_OPR;
+    gen->dataObjInp->offset = gen->chunkOffset;
+    gen->applyCnt++;
+    status = rcDataObjDelta (gen->conn, gen->dataObjInp, &deltaBBuf,
+      &outBBuf);
+    if (outBBuf.buf != NULL) free (outBBuf.buf);
+    if (status < 0) return (status);
+
+    gen->chunkOffset = gen->outOffset;
+    gen->outLen = 0;
+    return (0);
+}
+
+static int
+flushDeltaCopy (deltaGen_t *gen)
+{
+    unsigned char *ptr;
+    rodsLong_t offset, len;
+    int status;
+
+    if (gen->copyCnt <= 0) return (0);
+
+    if (gen->outLen + DELTA_COPY_REC_LEN > DELTA_CHUNK_SIZE) {
+	if ((status = flushDeltaChunk (gen)) < 0) return (status);
+    }
+    ptr = gen->outBuf + gen->outLen;
+    putDeltaInt (ptr, DELTA_COPY_REC);
+    putDeltaInt (ptr + 4, gen->copyInx);
+    putDeltaInt (ptr + 8, gen->copyCnt);
+    gen->outLen += DELTA_COPY_REC_LEN;
+
+    /* the last block of the replica may be short */
+    offset = (rodsLong_t) gen->copyInx * gen->blockSize;
+    len = (rodsLong_t) gen->copyCnt * gen->blockSize;
+    if (offset + len > gen->targSize) len = gen->targSize - offset;
+    gen->outOffset += len;
+    gen->copyCnt = 0;
+    return (0);
+}
+
+static int
+addDeltaCopy (deltaGen_t *gen, int inx)
+{
+    int status;
+
+    if (gen->copyCnt > 0 && inx == gen->copyInx + gen->copyCnt) {
+	gen->copyCnt++;
+	return (0);
+    }
+    if ((status = flushDeltaCopy (gen)) < 0) return (status);
+    gen->copyInx = inx;
+    gen->copyCnt = 1;
+    return (0);
+}
+
+static int
+addDeltaData (deltaGen_t *gen, unsigned char *buf, int len)
+{
+    unsigned char *ptr;
+    int space, n;
+    int status;
+
+    if ((status = flushDeltaCopy (gen)) < 0) return (status);
+
+    while (len > 0) {
+	space = DELTA_CHUNK_SIZE - gen->outLen - DELTA_DATA_REC_LEN;
+	if (space <= 0) {
+	    if ((status = flushDeltaChunk (gen)) < 0) return (status);
+	    continue;
+	}
+	n = len < space ? len : space;
+	ptr = gen->outBuf + gen->outLen;
+	putDeltaInt (ptr, DELTA_DATA_REC);
+	putDeltaInt (ptr + 4, n);
+	memcpy (ptr + DELTA_DATA_REC_LEN, buf, n);
+	gen->outLen += DELTA_DATA_REC_LEN + n;
+	gen->outOffset += n;
+	gen->dataBytes += n;
+	buf += n;
+	len -= n;
+    }
+    return (0);
+}
+
+/* matchDeltaBlock - return the full block of the replica with the same
+ * weak and strong sums as buf, preferring the block which extends the
+ * pending copy. -1 if there is none. */
+static int
+matchDeltaBlock (deltaGen_t *gen, unsigned int weak, unsigned char *buf)
+{
+    unsigned char digest[DELTA_STRONG_LEN];
+    unsigned char *ent;
+    int haveDigest = 0;
+    int next = gen->copyCnt > 0 ? gen->copyInx + gen->copyCnt : -1;
+    int inx;
+    int match = -1;
+
+    for (inx = gen->hashHead[DELTA_HASH (gen, weak)]; inx >= 0;
+      inx = gen->hashNext[inx]) {
+	ent = DELTA_SIG_ENT (gen, inx);
+	if (getDeltaInt (ent) != weak) continue;
+	if (haveDigest == 0) {
+	    deltaStrongSum (buf, gen->blockSize, digest);
+	    haveDigest = 1;
+	}
+	if (memcmp (ent + 4, digest, DELTA_STRONG_LEN) != 0) continue;
+	if (match < 0) match = inx;
+	if (next < 0 || inx == next) {
+	    match = inx;
+	    break;
+	}
+    }
+    return (match);
+}
+
+static int
+initDeltaGen (deltaGen_t *gen, bytesBuf_t *sigBBuf)
+{
+    int numFull;
+    int hashBits, hashSize;
+    int i;
+
+    if (sigBBuf->buf == NULL || sigBBuf->len < DELTA_SIG_HEADER_LEN)
+	return (SYS_INVALID_INPUT_PARAM);
+    gen->sig = (unsigned char *) sigBBuf->buf;
+    gen->blockSize = getDeltaInt (gen->sig);
+    gen->numBlocks = getDeltaInt (gen->sig + 4);
+    gen->targSize = ((rodsLong_t) getDeltaInt (gen->sig + 12) << 32) |
+      getDeltaInt (gen->sig + 16);
+    if (gen->blockSize <= 0 || gen->numBlocks <= 0 ||
+      gen->numBlocks > MAX_DELTA_BLOCKS ||
+      sigBBuf->len != DELTA_SIG_HEADER_LEN +
+      gen->numBlocks * DELTA_SIG_ENT_LEN ||
+      (gen->targSize + gen->blockSize - 1) / gen->blockSize !=
+      gen->numBlocks) {
+	return (SYS_INVALID_INPUT_PARAM);
+    }
+
+    /* hash the full blocks. A short last block can only match the end
+     * of the file and is checked there */
+    numFull = (int) (gen->targSize / gen->blockSize);
+    hashBits = 10;
+    while ((1 << hashBits) < 2 * numFull) hashBits++;
+    hashSize = 1 << hashBits;
+    gen->hashShift = 32 - hashBits;
+    gen->hashHead = (int *) malloc (hashSize * sizeof (int));
+    gen->hashNext = (int *) malloc ((numFull + 1) * sizeof (int));
+    gen->outBuf = (unsigned char *) malloc (DELTA_CHUNK_SIZE);
+    if (gen->hashHead == NULL || gen->hashNext == NULL ||
+      gen->outBuf == NULL) {
+	return (SYS_MALLOC_ERR);
+    }
+    for (i = 0; i < hashSize; i++) {
+	gen->hashHead[i] = -1;
+    }
+    /* insert backward so that each chain is in block order */
+    for (i = numFull - 1; i >= 0; i--) {
+	unsigned int h = DELTA_HASH (gen, getDeltaInt (DELTA_SIG_ENT (gen, i)));
+	gen->hashNext[i] = gen->hashHead[h];
+	gen->hashHead[h] = i;
+    }
+    return (0);
+}
+
+/* genDeltaFile - scan the local file and send the delta records. */
+static int
+genDeltaFile (deltaGen_t *gen, int fd)
+{
+    unsigned char *readBuf;
+    int bufSize;
+    int blockSize = gen->blockSize;
+    int lastLen = (int) (gen->targSize % blockSize);
+    int dataLen = 0, pos = 0, litStart = 0;
+    int eof = 0;
+    int weakValid = 0;
+    unsigned int s1 = 0, s2 = 0;
+    int inx;
+    int status = 0;
+
+    bufSize = DELTA_CHUNK_SIZE + blockSize;
+    if ((readBuf = (unsigned char *) malloc (bufSize)) == NULL)
+	return (SYS_MALLOC_ERR);
+
+    while (1) {
+	int avail;
+
+	if (eof == 0 && dataLen - pos < blockSize) {
+	    /* send the pending data and read more */
+	    if (pos > litStart) {
+		status = addDeltaData (gen, readBuf + litStart, pos - litStart);
+		if (status < 0) break;
+	    }
+	    memmove (readBuf, readBuf + pos, dataLen - pos);
+	    dataLen -= pos;
+	    pos = litStart = 0;
+	    while (dataLen < bufSize) {
+		int n = read (fd, readBuf + dataLen, bufSize - dataLen);
+		if (n < 0) {
+		    status = UNIX_FILE_READ_ERR - errno;
+		    break;
+		} else if (n == 0) {
+		    eof = 1;
+		    break;
+		}
+		dataLen += n;
+	    }
+	    if (status < 0) break;
+	    weakValid = 0;
+	}
+
+	avail = dataLen - pos;
+	if (avail <= 0) break;
+	if (avail < blockSize) {
+	    /* end of file. Only the short last block can match here */
+	    unsigned char digest[DELTA_STRONG_LEN];
+	    unsigned char *ent = DELTA_SIG_ENT (gen, gen->numBlocks - 1);
+	    if (lastLen > 0 && avail == lastLen &&
+	      getDeltaInt (ent) == deltaWeakSum (readBuf + pos, avail)) {
+		deltaStrongSum (readBuf + pos, avail, digest);
+		if (memcmp (ent + 4, digest, DELTA_STRONG_LEN) == 0) {
+		    if (pos > litStart) {
+			status = addDeltaData (gen, readBuf + litStart,
+			  pos - litStart);
+			if (status < 0) break;
+		    }
+		    status = addDeltaCopy (gen, gen->numBlocks - 1);
+		    litStart = dataLen;
+		}
+	    }
+	    break;
+	}
+
+	if (weakValid == 0) {
+	    int i;
+	    s1 = s2 = 0;
+	    for (i = 0; i < blockSize; i++) {
+		s1 += readBuf[pos + i];
+		s2 += s1;
+	    }
+	    weakValid = 1;
+	}
+	inx = matchDeltaBlock (gen, DELTA_WEAK (s1, s2), readBuf + pos);
+	if (inx >= 0) {
+	    if (pos > litStart) {
+		status = addDeltaData (gen, readBuf + litStart, pos - litStart);
+		if (status < 0) break;
+	    }
+	    if ((status = addDeltaCopy (gen, inx)) < 0) break;
+	    pos += blockSize;
+	    litStart = pos;
+	    weakValid = 0;
+	    continue;
+	}
+
+	/* roll the window one byte */
+	if (pos + blockSize < dataLen) {
+	    unsigned int out = readBuf[pos];
+	    s1 += readBuf[pos + blockSize] - out;
+	    s2 += s1 - blockSize * out;
+	} else {
+	    weakValid = 0;
+	}
+	pos++;
+	if (gen->dataBytes + pos - litStart > gen->maxDataBytes) {
+	    rodsLog (LOG_DEBUG,
+	      "genDeltaFile: too much new data for %s, use a normal put",
+	      gen->dataObjInp->objPath);
+	    status = SYS_NOT_SUPPORTED;
+	    break;
+	}
+    }
+
+    if (status >= 0 && dataLen > litStart) {
+	status = addDeltaData (gen, readBuf + litStart, dataLen - litStart);
+    }
+    if (status >= 0) status = flushDeltaCopy (gen);
+    if (status >= 0) status = flushDeltaChunk (gen);
+    free (readBuf);
+    return (status);
+}
+
+/* deltaPutUtil - update the existing data object dataObjInp->objPath with
+ * the content of locFilePath by sending only the blocks which changed.
+ * chksum is the checksum of the local file. On a negative return the
+ * caller should fall back to a normal put. */
+int
+deltaPutUtil (rcComm_t *conn, char *locFilePath, dataObjInp_t *dataObjInp,
+char *chksum)
+{
+    dataObjInp_t deltaInp;
+    bytesBuf_t sigBBuf, outBBuf;
+    deltaGen_t gen;
+    struct stat statbuf;
+    char tmpStr[NAME_LEN];
+    char *rescName;
+    int fd;
+    int status;
+
+    if (chksum == NULL || strlen (chksum) == 0) return (USER__NULL_INPUT_ERR);
+
+    bzero (&deltaInp, sizeof (deltaInp));
+    bzero (&sigBBuf, sizeof (sigBBuf));
+    bzero (&gen, sizeof (gen));
+    rstrcpy (deltaInp.objPath, dataObjInp->objPath, MAX_NAME_LEN);
+    deltaInp.oprType = DELTA_SIG_OPR;
+    /* update the replica a put would overwrite */
+    if ((rescName = getValByKey (&dataObjInp->condInput, DEST_RESC_NAME_KW))
+      != NULL) {
+	addKeyVal (&deltaInp.condInput, RESC_NAME_KW, rescName);
+    }
+    status = rcDataObjDelta (conn, &deltaInp, NULL, &sigBBuf);
+    if (status < 0) {
+	/* older servers return SYS_UNMATCHED_API_NUM */
+	rodsLogError (LOG_DEBUG, status,
+	  "deltaPutUtil: DELTA_SIG_OPR of %s failed, ", deltaInp.objPath);
+	if (sigBBuf.buf != NULL) free (sigBBuf.buf);
+	clearKeyVal (&deltaInp.condInput);
+	return (status);
+    }
+    gen.conn = conn;
+    gen.dataObjInp = &deltaInp;
+    status = initDeltaGen (&gen, &sigBBuf);
+    if (status < 0) {
+	rodsLogError (LOG_ERROR, status,
+	  "deltaPutUtil: bad signatures for %s, ", deltaInp.objPath);
+	goto done;
+    }
+
+    fd = open (locFilePath, O_RDONLY, 0);
+    if (fd < 0) {
+	status = UNIX_FILE_OPEN_ERR - errno;
+	goto done;
+    }
+    if (fstat (fd, &statbuf) < 0) {
+	status = UNIX_FILE_STAT_ERR - errno;
+	close (fd);
+	goto done;
+    }
+    gen.maxDataBytes = statbuf.st_size / 100 * DELTA_MAX_DATA_PERCENT;
+
+    snprintf (tmpStr, NAME_LEN, "%d", (int) getDeltaInt (gen.sig + 8));
+    addKeyVal (&deltaInp.condInput, REPL_NUM_KW, tmpStr);
+    snprintf (tmpStr, NAME_LEN, "%d", gen.blockSize);
+    addKeyVal (&deltaInp.condInput, DELTA_BLOCK_SIZE_KW, tmpStr);
+
+    status = genDeltaFile (&gen, fd);
+    close (fd);
+
+    if (status >= 0) {
+	deltaInp.oprType = DELTA_COMMIT_OPR;
+	deltaInp.dataSize = gen.outOffset;
+	addKeyVal (&deltaInp.condInput, CHKSUM_KW, chksum);
+	bzero (&outBBuf, sizeof (outBBuf));
+	status = rcDataObjDelta (conn, &deltaInp, NULL, &outBBuf);
+	if (outBBuf.buf != NULL) free (outBBuf.buf);
+	if (status >= 0) {
+	    rodsLog (LOG_DEBUG,
+	      "deltaPutUtil: %s updated, %lld bytes sent as data out of %lld",
+	      deltaInp.objPath, gen.dataBytes, gen.outOffset);
+	}
+    }
+    if (status < 0 && gen.applyCnt > 0) {
+	/* remove the partial content */
+	int status1;
+	deltaInp.oprType = DELTA_ABORT_OPR;
+	bzero (&outBBuf, sizeof (outBBuf));
+	status1 = rcDataObjDelta (conn, &deltaInp, NULL, &outBBuf);
+	if (outBBuf.buf != NULL) free (outBBuf.buf);
+	if (status1 < 0) {
+	    rodsLogError (LOG_NOTICE, status1,
+	      "deltaPutUtil: DELTA_ABORT_OPR of %s failed, ", deltaInp.objPath);
+	}
+    }
+
+done:
+    clearKeyVal (&deltaInp.condInput);
+    if (gen.hashHead != NULL) free (gen.hashHead);
+    if (gen.hashNext != NULL) free (gen.hashNext);
+    if (gen.outBuf != NULL) free (gen.outBuf);
+    free (sigBBuf.buf);
+    return (status);
+}
@@ -52,7 +52,13 @@ fsckObj (rcComm_t *conn, rodsArguments_t *myRodsArgs, rodsPathInp_t *rodsPathInp
 					return (status);
 				}
 			}
-			status = fsckObjDir(conn, myRodsArgs, inpPath, hostname);
+			if ( myRodsArgs->all == True ) {
+				status = auditObjDir(conn, myRodsArgs, inpPath, hostname,
+				  myRodsArgs->verifyChecksum == True ? AUDIT_VERIFY_CHKSUM : 0);
+			}
+			else {
+				status = fsckObjDir(conn, myRodsArgs, inpPath, hostname);
+			}
 		}
 		else {
 			status = USER_INPUT_PATH_ERR;
@@ -207,3 +213,573 @@ possible with local file %s .\n", objPath, objName, inpPath);
 	return (status);
 	
 }
+
+/* auditObjDir - audit the vault directory inpPath against the catalog in
+ * one pass. All the replicas with a data path under inpPath are streamed
+ * from the catalog ordered by data path, and the directory is walked in
+ * the same order, so the two can be merge joined instead of doing a
+ * query per file. Reports the orphan files, the missing files, the size
+ * mismatches and, with AUDIT_VERIFY_CHKSUM, the checksum mismatches.
+ * The lstat of the files and the checksums are done by a pool of threads.
+ * The catalog may not sort the paths the same way strcmp does (it depends
+ * on the collation of the database), so an orphan or a missing file found
+ * by the merge is confirmed one by one before it is reported.
+ */
+
+int
+auditObjDir (rcComm_t *conn, rodsArguments_t *myRodsArgs, char *inpPath,
+char *hostname, int auditFlags)
+{
+    auditState_t auditState;
+    auditCatCursor_t cursor;
+    auditCatRow_t catRow;
+    auditDir_t *auditDir = NULL;
+    int cursorOpened = 0;
+    int vaultStatus, catStatus, cmp;
+    int status = 0;
+    int i;
+
+    memset (&auditState, 0, sizeof (auditState));
+    auditState.conn = conn;
+    auditState.auditFlags = auditFlags;
+    auditState.recursive = myRodsArgs->recursive;
+#ifdef PARA_OPR
+    if (myRodsArgs->number == True) {
+	auditState.numThreads = myRodsArgs->numberValue;
+    } else {
+	auditState.numThreads = DEF_AUDIT_NUM_THREADS;
+    }
+    if (auditState.numThreads > MAX_AUDIT_NUM_THREADS) {
+	auditState.numThreads = MAX_AUDIT_NUM_THREADS;
+    } else if (auditState.numThreads < 0) {
+	auditState.numThreads = 0;
+    }
+    pthread_mutex_init (&auditState.lock, NULL);
+    pthread_cond_init (&auditState.taskCond, NULL);
+    pthread_cond_init (&auditState.doneCond, NULL);
+    for (i = 0; i < auditState.numThreads; i++) {
+	if (pthread_create (&auditState.threads[i], NULL, auditWorker,
+	  (void *) &auditState) != 0) {
+	    rodsLog (LOG_NOTICE, 
+	      "auditObjDir: pthread_create error. Using %d threads", i);
+	    auditState.numThreads = i;
+	    break;
+	}
+    }
+#endif
+
+    status = listAuditDir (&auditState, inpPath, &auditDir);
+    if (status < 0) {
+	rodsLogError (LOG_ERROR, status,
+	  "auditObjDir: unable to list %s", inpPath);
+    } else {
+	auditState.dirStack[0] = auditDir;
+	auditState.depth = 1;
+	status = openAuditCatCursor (conn, myRodsArgs, inpPath, hostname, 
+	  &cursor);
+	cursorOpened = 1;
+    }
+    if (status < 0) {
+	catStatus = vaultStatus = status;
+    } else {
+        vaultStatus = nextAuditVaultFile (&auditState);
+        catStatus = nextAuditCatRow (&cursor, &catRow);
+    }
+
+    /* vaultStatus is 0 and catStatus is CAT_NO_ROWS_FOUND at the end */
+    while ((vaultStatus > 0 || catStatus == 0) && vaultStatus >= 0 &&
+      (catStatus == 0 || catStatus == CAT_NO_ROWS_FOUND)) {
+	if (vaultStatus == 0) {
+	    cmp = 1;
+	} else if (catStatus != 0) {
+	    cmp = -1;
+	} else {
+	    cmp = strcmp (auditState.curFilePath, catRow.dataPath);
+	}
+	if (cmp == 0) {
+	    if ((auditFlags & AUDIT_ORPHAN_ONLY) == 0) {
+	        auditMatchedFile (&auditState, &catRow, 
+		  auditState.curFilePath, auditState.curFileSize);
+	    }
+	    vaultStatus = nextAuditVaultFile (&auditState);
+	    catStatus = nextAuditCatRow (&cursor, &catRow);
+	} else if (cmp < 0) {
+	    /* not in the catalog so far. Make sure it is not registered */
+	    if (chkObjExist (conn, auditState.curFilePath, hostname) == 
+	      CAT_NO_ROWS_FOUND) {
+		auditState.numOrphans++;
+	    }
+	    vaultStatus = nextAuditVaultFile (&auditState);
+	} else {
+	    /* not in the vault so far. Make sure it does not exist */
+	    if ((auditFlags & AUDIT_ORPHAN_ONLY) == 0) {
+		struct stat statbuf;
+
+		if (lstat (catRow.dataPath, &statbuf) == 0) {
+		    auditMatchedFile (&auditState, &catRow, catRow.dataPath,
+		      statbuf.st_size);
+		} else if (errno == ENOENT) {
+		    printf ("MISSING: local file %s of iRODS object %s/%s \
+does not exist.\n", catRow.dataPath, catRow.collName, catRow.dataName);
+		    auditState.numMissing++;
+		}
+	    }
+	    catStatus = nextAuditCatRow (&cursor, &catRow);
+	}
+    }
+    if (vaultStatus < 0) {
+	status = vaultStatus;
+    } else if (catStatus < 0 && catStatus != CAT_NO_ROWS_FOUND) {
+	status = catStatus;
+    }
+
+#ifdef PARA_OPR
+    /* wait for the checksums and shutdown the pool */
+    pthread_mutex_lock (&auditState.lock);
+    auditState.shutdown = 1;
+    pthread_cond_broadcast (&auditState.taskCond);
+    pthread_mutex_unlock (&auditState.lock);
+    for (i = 0; i < auditState.numThreads; i++) {
+	pthread_join (auditState.threads[i], NULL);
+    }
+    pthread_mutex_destroy (&auditState.lock);
+    pthread_cond_destroy (&auditState.taskCond);
+    pthread_cond_destroy (&auditState.doneCond);
+#endif
+    for (i = 0; i < auditState.depth; i++) {
+	freeAuditDir (auditState.dirStack[i]);
+    }
+    if (cursorOpened) {
+	if (cursor.outOfOrderCnt > 0) {
+	    rodsLog (LOG_NOTICE,
+	      "auditObjDir: %d catalog entries were out of strcmp order and \
+checked one by one", cursor.outOfOrderCnt);
+	}
+	closeAuditCatCursor (&cursor);
+    }
+
+    printf ("Audit of %s: %lld files, %lld orphans, %lld missing, \
+%lld size mismatches, %lld checksum mismatches\n", inpPath, 
+      auditState.numFiles, auditState.numOrphans, auditState.numMissing,
+      auditState.numSizeErr, auditState.numChksumErr);
+
+    return (status);
+}
+
+/* openAuditCatCursor - start the query of the replicas under inpPath on
+ * this host ordered by data path.
+ */
+
+int
+openAuditCatCursor (rcComm_t *conn, rodsArguments_t *myRodsArgs, 
+char *inpPath, char *hostname, auditCatCursor_t *cursor)
+{
+    char condStr[MAX_NAME_LEN * 2];
+
+    memset (cursor, 0, sizeof (auditCatCursor_t));
+    cursor->conn = conn;
+    addInxIval (&cursor->genQueryInp.selectInp, COL_D_DATA_PATH, ORDER_BY);
+    addInxIval (&cursor->genQueryInp.selectInp, COL_DATA_NAME, 1);
+    addInxIval (&cursor->genQueryInp.selectInp, COL_COLL_NAME, 1);
+    addInxIval (&cursor->genQueryInp.selectInp, COL_DATA_SIZE, 1);
+    addInxIval (&cursor->genQueryInp.selectInp, COL_D_DATA_CHECKSUM, 1);
+    cursor->genQueryInp.maxRows = MAX_SQL_ROWS;
+
+    if (myRodsArgs->recursive == True) {
+	snprintf (condStr, MAX_NAME_LEN * 2, "like '%s/%%'", inpPath);
+    } else {
+	snprintf (condStr, MAX_NAME_LEN * 2, 
+	  "like '%s/%%' && not like '%s/%%/%%'", inpPath, inpPath);
+    }
+    addInxVal (&cursor->genQueryInp.sqlCondInp, COL_D_DATA_PATH, condStr);
+    snprintf (condStr, MAX_NAME_LEN, "like '%s%s' || ='%s'", hostname, "%", 
+      hostname);
+    addInxVal (&cursor->genQueryInp.sqlCondInp, COL_R_LOC, condStr);
+    if (myRodsArgs->resource == True) {
+	snprintf (condStr, MAX_NAME_LEN, "='%s'", myRodsArgs->resourceString);
+	addInxVal (&cursor->genQueryInp.sqlCondInp, COL_D_RESC_NAME, condStr);
+    }
+
+    return (0);
+}
+
+/* nextAuditCatRow - get the next replica from the catalog. Returns
+ * CAT_NO_ROWS_FOUND when there is no more.
+ */
+
+int
+nextAuditCatRow (auditCatCursor_t *cursor, auditCatRow_t *catRow)
+{
+    genQueryOut_t *genQueryOut = cursor->genQueryOut;
+    int status, i;
+    char *value[5];
+
+    if (genQueryOut == NULL || cursor->rowInx >= genQueryOut->rowCnt) {
+	if (genQueryOut != NULL) {
+	    if (genQueryOut->continueInx <= 0) return CAT_NO_ROWS_FOUND;
+	    cursor->genQueryInp.continueInx = genQueryOut->continueInx;
+	    freeGenQueryOut (&cursor->genQueryOut);
+	} else if (cursor->genQueryInp.continueInx < 0) {
+	    return CAT_NO_ROWS_FOUND;
+	}
+        status = rcGenQuery (cursor->conn, &cursor->genQueryInp, 
+	  &cursor->genQueryOut);
+	if (status < 0) {
+	    /* don't query again */
+	    cursor->genQueryInp.continueInx = -1;
+	    if (status != CAT_NO_ROWS_FOUND) {
+	        rodsLogError (LOG_ERROR, status,
+	          "nextAuditCatRow: rcGenQuery error");
+	    }
+	    return status;
+	}
+	genQueryOut = cursor->genQueryOut;
+	cursor->rowInx = 0;
+	if (genQueryOut->rowCnt <= 0) return CAT_NO_ROWS_FOUND;
+    }
+
+    for (i = 0; i < 5; i++) {
+	value[i] = genQueryOut->sqlResult[i].value + 
+	  cursor->rowInx * genQueryOut->sqlResult[i].len;
+    }
+    rstrcpy (catRow->dataPath, value[0], MAX_NAME_LEN);
+    rstrcpy (catRow->dataName, value[1], MAX_NAME_LEN);
+    rstrcpy (catRow->collName, value[2], MAX_NAME_LEN);
+    catRow->dataSize = strtoll (value[3], 0, 0);
+    rstrcpy (catRow->chksum, value[4], NAME_LEN);
+    cursor->rowInx++;
+
+    if (strcmp (cursor->prevPath, catRow->dataPath) > 0) 
+	cursor->outOfOrderCnt++;
+    rstrcpy (cursor->prevPath, catRow->dataPath, MAX_NAME_LEN);
+
+    return (0);
+}
+
+int
+closeAuditCatCursor (auditCatCursor_t *cursor)
+{
+    if (cursor->genQueryOut != NULL) {
+	if (cursor->genQueryOut->continueInx > 0) {
+	    /* close the statement on the server */
+	    cursor->genQueryInp.continueInx = cursor->genQueryOut->continueInx;
+	    cursor->genQueryInp.maxRows = 0;
+	    freeGenQueryOut (&cursor->genQueryOut);
+	    rcGenQuery (cursor->conn, &cursor->genQueryInp, 
+	      &cursor->genQueryOut);
+	}
+	freeGenQueryOut (&cursor->genQueryOut);
+    }
+    clearGenQueryInp (&cursor->genQueryInp);
+    return (0);
+}
+
+static int
+cmpAuditEntry (const void *a, const void *b)
+{
+    return strcmp (((auditEntry_t *) a)->name, ((auditEntry_t *) b)->name);
+}
+
+/* listAuditDir - list dirPath sorted for the walk. The entries are
+ * lstat'ed by the pool.
+ */
+
+int
+listAuditDir (auditState_t *auditState, char *dirPath, 
+auditDir_t **outAuditDir)
+{
+    DIR *dirPtr;
+    struct dirent *myDirent;
+    auditDir_t *auditDir;
+    int allocCnt = 0;
+    int i, j;
+
+    if ((dirPtr = opendir (dirPath)) == NULL) {
+	return (UNIX_FILE_OPENDIR_ERR - errno);
+    }
+    auditDir = (auditDir_t *) calloc (1, sizeof (auditDir_t));
+    rstrcpy (auditDir->path, dirPath, MAX_NAME_LEN);
+    while ((myDirent = readdir (dirPtr)) != NULL) {
+        if (strcmp (myDirent->d_name, ".") == 0 || 
+	  strcmp (myDirent->d_name, "..") == 0) {
+	    continue;
+	}
+	if (auditDir->numEntries >= allocCnt) {
+	    allocCnt += 256;
+	    auditDir->entries = (auditEntry_t *) realloc (auditDir->entries,
+	      allocCnt * sizeof (auditEntry_t));
+	}
+	/* room for the trailing '/' of a dir */
+	auditDir->entries[auditDir->numEntries].name = (char *) 
+	  malloc (strlen (myDirent->d_name) + 2);
+	strcpy (auditDir->entries[auditDir->numEntries].name, 
+	  myDirent->d_name);
+	auditDir->entries[auditDir->numEntries].objType = UNKNOWN_FILE_T;
+	auditDir->numEntries++;
+    }
+    closedir (dirPtr);
+
+    /* lstat them, in chunks by the pool */
+    for (i = 0; i < auditDir->numEntries; i += AUDIT_STAT_CHUNK) {
+	auditTask_t *auditTask = (auditTask_t *) 
+	  calloc (1, sizeof (auditTask_t));
+	auditTask->type = AUDIT_STAT_TASK;
+	auditTask->auditDir = auditDir;
+	auditTask->startInx = i;
+	auditTask->endInx = i + AUDIT_STAT_CHUNK;
+	if (auditTask->endInx > auditDir->numEntries) 
+	    auditTask->endInx = auditDir->numEntries;
+	queAuditTask (auditState, auditTask);
+    }
+#ifdef PARA_OPR
+    pthread_mutex_lock (&auditState->lock);
+    while (auditState->numStatPending > 0) {
+	pthread_cond_wait (&auditState->doneCond, &auditState->lock);
+    }
+    pthread_mutex_unlock (&auditState->lock);
+#endif
+
+    /* drop what is not visited and sort. Dirs sort as "name/" so that the
+     * walk gives the paths in strcmp order */
+    for (i = j = 0; i < auditDir->numEntries; i++) {
+	auditEntry_t *entry = &auditDir->entries[i];
+	if (entry->objType == LOCAL_FILE_T || (entry->objType == LOCAL_DIR_T &&
+	  auditState->recursive == True)) {
+	    if (entry->objType == LOCAL_DIR_T) strcat (entry->name, "/");
+	    auditDir->entries[j++] = *entry;
+	} else {
+	    free (entry->name);
+	}
+    }
+    auditDir->numEntries = j;
+    qsort (auditDir->entries, auditDir->numEntries, sizeof (auditEntry_t),
+      cmpAuditEntry);
+
+    *outAuditDir = auditDir;
+    return (0);
+}
+
+/* nextAuditVaultFile - advance the walk of the vault to the next file.
+ * Returns 1 with the file in curFilePath and curFileSize, 0 at the end.
+ */
+
+int
+nextAuditVaultFile (auditState_t *auditState)
+{
+    auditDir_t *auditDir, *subDir;
+    auditEntry_t *entry;
+    char subPath[MAX_NAME_LEN];
+    int status;
+
+    while (auditState->depth > 0) {
+	auditDir = auditState->dirStack[auditState->depth - 1];
+	if (auditDir->inx >= auditDir->numEntries) {
+	    freeAuditDir (auditDir);
+	    auditState->depth--;
+	    continue;
+	}
+	entry = &auditDir->entries[auditDir->inx];
+	auditDir->inx++;
+	if (entry->objType == LOCAL_FILE_T) {
+	    if (snprintf (auditState->curFilePath, MAX_NAME_LEN, "%s/%s",
+	      auditDir->path, entry->name) >= MAX_NAME_LEN) {
+		rodsLog (LOG_ERROR,
+		  "nextAuditVaultFile: path of %s in %s too long, skipped",
+		  entry->name, auditDir->path);
+		continue;
+	    }
+	    auditState->curFileSize = entry->size;
+	    auditState->numFiles++;
+	    return 1;
+	}
+	/* a dir. Strip the trailing '/' */
+	if (snprintf (subPath, MAX_NAME_LEN, "%s/%s", auditDir->path,
+	  entry->name) >= MAX_NAME_LEN) {
+	    rodsLog (LOG_ERROR,
+	      "nextAuditVaultFile: path of %s in %s too long, skipped",
+	      entry->name, auditDir->path);
+	    continue;
+	}
+	subPath[strlen (subPath) - 1] = '\0';
+	if (auditState->depth >= MAX_NAME_LEN / 2) continue;
+	status = listAuditDir (auditState, subPath, &subDir);
+	if (status < 0) {
+	    rodsLogError (LOG_ERROR, status,
+	      "nextAuditVaultFile: unable to list %s", subPath);
+	    continue;
+	}
+	auditState->dirStack[auditState->depth] = subDir;
+	auditState->depth++;
+    }
+    return 0;
+}
+
+int
+freeAuditDir (auditDir_t *auditDir)
+{
+    int i;
+
+    if (auditDir == NULL) return 0;
+    for (i = 0; i < auditDir->numEntries; i++) {
+	free (auditDir->entries[i].name);
+    }
+    if (auditDir->entries != NULL) free (auditDir->entries);
+    free (auditDir);
+    return 0;
+}
+
+/* auditMatchedFile - check the size of a file registered in the catalog
+ * and queue its checksum verification.
+ */
+
+int
+auditMatchedFile (auditState_t *auditState, auditCatRow_t *catRow,
+char *filePath, rodsLong_t fileSize)
+{
+    char objPath[MAX_NAME_LEN];
+    auditTask_t *auditTask;
+
+    if (snprintf (objPath, MAX_NAME_LEN, "%s/%s", catRow->collName, 
+      catRow->dataName) >= MAX_NAME_LEN) {
+	return USER_STRLEN_TOOLONG;
+    }
+    if (fileSize != catRow->dataSize) {
+	printf ("CORRUPTION: local file %s size not consistent with iRODS \
+object %s size.\n", filePath, objPath);
+	auditState->numSizeErr++;
+	return SYS_COPY_LEN_ERR;
+    }
+    if ((auditState->auditFlags & AUDIT_VERIFY_CHKSUM) == 0) return 0;
+
+    if (strlen (catRow->chksum) == 0) {
+	printf ("WARNING: checksum not available for iRODS object %s, no \
+checksum comparison possible with local file %s .\n", objPath, filePath);
+	return 0;
+    }
+    auditTask = (auditTask_t *) calloc (1, sizeof (auditTask_t));
+    auditTask->type = AUDIT_CHKSUM_TASK;
+    auditTask->filePath = strdup (filePath);
+    auditTask->objPath = strdup (objPath);
+    auditTask->chksum = strdup (catRow->chksum);
+    return queAuditTask (auditState, auditTask);
+}
+
+/* queAuditTask - give a task to the pool. Run it right away if there is
+ * no pool. The checksum queue is bounded so that the walk does not get
+ * too far ahead.
+ */
+
+int
+queAuditTask (auditState_t *auditState, auditTask_t *auditTask)
+{
+#ifdef PARA_OPR
+    if (auditState->numThreads > 0) {
+	pthread_mutex_lock (&auditState->lock);
+	if (auditTask->type == AUDIT_CHKSUM_TASK) {
+	    while (auditState->numChksumQueued >= MAX_AUDIT_CHKSUM_QUE) {
+		pthread_cond_wait (&auditState->doneCond, &auditState->lock);
+	    }
+	    auditState->numChksumQueued++;
+	} else {
+	    auditState->numStatPending++;
+	}
+	/* stat tasks go first. The walk is waiting for them */
+	if (auditTask->type == AUDIT_STAT_TASK || auditState->taskHead == NULL) {
+	    auditTask->next = auditState->taskHead;
+	    auditState->taskHead = auditTask;
+	    if (auditState->taskTail == NULL) auditState->taskTail = auditTask;
+	} else {
+	    auditState->taskTail->next = auditTask;
+	    auditState->taskTail = auditTask;
+	}
+	pthread_cond_signal (&auditState->taskCond);
+	pthread_mutex_unlock (&auditState->lock);
+	return 0;
+    }
+#endif
+    runAuditTask (auditState, auditTask);
+    return 0;
+}
+
+void
+runAuditTask (auditState_t *auditState, auditTask_t *auditTask)
+{
+    int i, status;
+
+    if (auditTask->type == AUDIT_STAT_TASK) {
+	auditDir_t *auditDir = auditTask->auditDir;
+	char filePath[MAX_NAME_LEN];
+	struct stat statbuf;
+
+	for (i = auditTask->startInx; i < auditTask->endInx; i++) {
+	    auditEntry_t *entry = &auditDir->entries[i];
+	    if (snprintf (filePath, MAX_NAME_LEN, "%s/%s", auditDir->path, 
+	      entry->name) >= MAX_NAME_LEN) continue;
+	    /* symlinks are skipped as in fsckObjDir */
+	    if (lstat (filePath, &statbuf) != 0) continue;
+	    if (S_ISREG (statbuf.st_mode)) {
+		entry->objType = LOCAL_FILE_T;
+		entry->size = statbuf.st_size;
+	    } else if (S_ISDIR (statbuf.st_mode)) {
+		entry->objType = LOCAL_DIR_T;
+	    }
+	}
+    } else {
+	status = verifyChksumLocFile (auditTask->filePath, auditTask->chksum,
+	  NULL);
+#ifdef PARA_OPR
+	pthread_mutex_lock (&auditState->lock);
+#endif
+	if (status == USER_CHKSUM_MISMATCH) {
+	    printf ("CORRUPTION: local file %s checksum not consistent with \
+iRODS object %s checksum.\n", auditTask->filePath, auditTask->objPath);
+	    auditState->numChksumErr++;
+	} else if (status < 0) {
+	    printf ("ERROR: unable to compute checksum for local file %s.\n",
+	      auditTask->filePath);
+	}
+#ifdef PARA_OPR
+	pthread_mutex_unlock (&auditState->lock);
+#endif
+	free (auditTask->filePath);
+	free (auditTask->objPath);
+	free (auditTask->chksum);
+    }
+    free (auditTask);
+}
+
+#ifdef PARA_OPR
+void *
+auditWorker (void *arg)
+{
+    auditState_t *auditState = (auditState_t *) arg;
+    auditTask_t *auditTask;
+    int type;
+
+    pthread_mutex_lock (&auditState->lock);
+    while (1) {
+	if (auditState->taskHead == NULL) {
+	    if (auditState->shutdown) break;
+	    pthread_cond_wait (&auditState->taskCond, &auditState->lock);
+	    continue;
+	}
+	auditTask = auditState->taskHead;
+	auditState->taskHead = auditTask->next;
+	if (auditState->taskHead == NULL) auditState->taskTail = NULL;
+	type = auditTask->type;
+	pthread_mutex_unlock (&auditState->lock);
+
+	runAuditTask (auditState, auditTask);
+
+	pthread_mutex_lock (&auditState->lock);
+	if (type == AUDIT_STAT_TASK) {
+	    auditState->numStatPending--;
+	} else {
+	    auditState->numChksumQueued--;
+	}
+	pthread_cond_broadcast (&auditState->doneCond);
+    }
+    pthread_mutex_unlock (&auditState->lock);
+    return NULL;
+}
+#endif
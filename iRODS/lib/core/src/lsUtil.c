@@ -393,6 +393,8 @@ rodsArguments_t *rodsArgs)
     int queryFlags;
     collHandle_t collHandle;
     collEnt_t collEnt;
+    dataAclList_t dataAclList;
+    int aclStatus = -1;
 
     if (srcPath == NULL) {
        rodsLog (LOG_ERROR,
@@ -405,9 +407,12 @@ rodsArguments_t *rodsArgs)
     /* print this collection */
     printf ("%s:\n", srcColl);
 
+    memset (&dataAclList, 0, sizeof (dataAclList));
     if (rodsArgs->accessControl == True) {
        printCollAcl (conn, srcColl);
        printCollInheritance (conn, srcColl);
+       /* the ACLs of all the data objects at once */
+       aclStatus = getDataAclInColl (conn, srcColl, &dataAclList);
     }
 
     queryFlags = DATA_QUERY_FIRST_FG;
@@ -438,7 +443,11 @@ rodsArguments_t *rodsArgs)
 	    } else {
 	        printDataCollEnt (&collEnt, queryFlags);
 	        if (rodsArgs->accessControl == True) {
-		    printDataAcl (conn, collEnt.dataId);
+		    if (aclStatus >= 0) {
+		        printDataAclInList (&dataAclList, collEnt.dataId);
+		    } else {
+		        printDataAcl (conn, collEnt.dataId);
+		    }
 	        }
 	    }
 	} else {
@@ -455,6 +464,7 @@ rodsArguments_t *rodsArgs)
 	}
     }
     rclCloseCollection (&collHandle);
+    clearDataAclList (&dataAclList);
     if (savedStatus < 0 && savedStatus != CAT_NO_ROWS_FOUND) {
         return (savedStatus);
     } else {
@@ -619,6 +629,165 @@ printDataAcl (rcComm_t *conn, char *dataId)
     return (status);
 }
 
+/* a row of the ACL query, and its position to keep the order of the
+ * ACLs of an object after sorting */
+typedef struct dataAclRow {
+    rodsLong_t dataId;
+    int rowInx;
+    char *aclStr;
+} dataAclRow_t;
+
+static int
+compDataAclRow (const void *a, const void *b)
+{
+    const dataAclRow_t *rowA = (const dataAclRow_t *) a;
+    const dataAclRow_t *rowB = (const dataAclRow_t *) b;
+
+    if (rowA->dataId != rowB->dataId)
+	return (rowA->dataId < rowB->dataId ? -1 : 1);
+    return (rowA->rowInx - rowB->rowInx);
+}
+
+/* getDataAclInColl - get the ACLs of all the data objects in collName
+ * into dataAclList, with one paged query instead of one query for each
+ * object as printDataAcl does. A collection without data objects gives
+ * an empty list.
+ */
+int
+getDataAclInColl (rcComm_t *conn, char *collName, dataAclList_t *dataAclList)
+{
+    genQueryInp_t genQueryInp;
+    genQueryOut_t *genQueryOut = NULL;
+    sqlResult_t *dataId, *userName, *userZone, *dataAccess;
+    dataAclRow_t *rows = NULL;
+    int numRows = 0, allocRows = 0;
+    int status, i, j;
+    char aclStr[MAX_NAME_LEN];
+
+    if (dataAclList == NULL) return (USER__NULL_INPUT_ERR);
+    memset (dataAclList, 0, sizeof (dataAclList_t));
+    memset (&genQueryInp, 0, sizeof (genQueryInp));
+
+    status = queryDataObjAclInColl (conn, collName, zoneHint, &genQueryInp,
+      &genQueryOut);
+
+    while (status >= 0) {
+	if ((dataId = getSqlResultByInx (genQueryOut, COL_D_DATA_ID)) ==
+	  NULL ||
+	  (userName = getSqlResultByInx (genQueryOut, COL_USER_NAME)) ==
+	  NULL ||
+	  (userZone = getSqlResultByInx (genQueryOut, COL_USER_ZONE)) ==
+	  NULL ||
+	  (dataAccess = getSqlResultByInx (genQueryOut,
+	  COL_DATA_ACCESS_NAME)) == NULL) {
+	    rodsLog (LOG_ERROR,
+	      "getDataAclInColl: getSqlResultByInx for %s failed", collName);
+	    status = UNMATCHED_KEY_OR_INDEX;
+	    break;
+	}
+	if (numRows + genQueryOut->rowCnt > allocRows) {
+	    dataAclRow_t *newRows;
+	    allocRows = numRows + genQueryOut->rowCnt + MAX_SQL_ROWS;
+	    newRows = (dataAclRow_t *) realloc (rows,
+	      allocRows * sizeof (dataAclRow_t));
+	    if (newRows == NULL) {
+		status = SYS_MALLOC_ERR;
+		break;
+	    }
+	    rows = newRows;
+	}
+	for (i = 0; i < genQueryOut->rowCnt; i++) {
+	    snprintf (aclStr, MAX_NAME_LEN, "%s#%s:%s   ",
+	      &userName->value[userName->len * i],
+	      &userZone->value[userZone->len * i],
+	      &dataAccess->value[dataAccess->len * i]);
+	    rows[numRows].dataId =
+	      strtoll (&dataId->value[dataId->len * i], 0, 0);
+	    rows[numRows].rowInx = numRows;
+	    rows[numRows].aclStr = strdup (aclStr);
+	    numRows++;
+	}
+	if (genQueryOut->continueInx <= 0) break;
+	genQueryInp.continueInx = genQueryOut->continueInx;
+	freeGenQueryOut (&genQueryOut);
+	status = rcGenQuery (conn, &genQueryInp, &genQueryOut);
+    }
+    freeGenQueryOut (&genQueryOut);
+    clearGenQueryInp (&genQueryInp);
+
+    if (status == CAT_NO_ROWS_FOUND) status = 0;
+
+    if (status >= 0 && numRows > 0) {
+	/* merge the rows of each object into one string */
+	qsort (rows, numRows, sizeof (dataAclRow_t), compDataAclRow);
+	dataAclList->dataAcl = (dataAcl_t *) calloc (numRows,
+	  sizeof (dataAcl_t));
+	for (i = 0; i < numRows; i = j) {
+	    int len = 0;
+	    for (j = i; j < numRows && rows[j].dataId == rows[i].dataId; j++)
+		len += strlen (rows[j].aclStr);
+	    dataAclList->dataAcl[dataAclList->len].dataId = rows[i].dataId;
+	    dataAclList->dataAcl[dataAclList->len].aclStr =
+	      (char *) malloc (len + 1);
+	    dataAclList->dataAcl[dataAclList->len].aclStr[0] = '\0';
+	    for (j = i; j < numRows && rows[j].dataId == rows[i].dataId; j++)
+		strcat (dataAclList->dataAcl[dataAclList->len].aclStr,
+		  rows[j].aclStr);
+	    dataAclList->len++;
+	}
+    }
+
+    for (i = 0; i < numRows; i++) free (rows[i].aclStr);
+    if (rows != NULL) free (rows);
+
+    if (status < 0) clearDataAclList (dataAclList);
+    return (status);
+}
+
+/* printDataAclInList - print the ACL of dataId as printDataAcl does,
+ * from the list of getDataAclInColl */
+int
+printDataAclInList (dataAclList_t *dataAclList, char *dataId)
+{
+    rodsLong_t myDataId;
+    int low, high, mid;
+
+    myDataId = strtoll (dataId, 0, 0);
+    printf ("        ACL - ");
+
+    low = 0;
+    high = dataAclList->len - 1;
+    while (low <= high) {
+	mid = (low + high) / 2;
+	if (dataAclList->dataAcl[mid].dataId == myDataId) {
+	    printf ("%s", dataAclList->dataAcl[mid].aclStr);
+	    break;
+	} else if (dataAclList->dataAcl[mid].dataId < myDataId) {
+	    low = mid + 1;
+	} else {
+	    high = mid - 1;
+	}
+    }
+
+    printf ("\n");
+    return (0);
+}
+
+int
+clearDataAclList (dataAclList_t *dataAclList)
+{
+    int i;
+
+    if (dataAclList == NULL) return (0);
+
+    for (i = 0; i < dataAclList->len; i++) {
+	free (dataAclList->dataAcl[i].aclStr);
+    }
+    if (dataAclList->dataAcl != NULL) free (dataAclList->dataAcl);
+    memset (dataAclList, 0, sizeof (dataAclList_t));
+    return (0);
+}
+
 int
 printCollAcl (rcComm_t *conn, char *collName)
 {
@@ -675,6 +675,47 @@ queryDataObjAcl (rcComm_t *conn, char *dataId, char *zoneHint,
 
 }
 
+/* queryDataObjAclInColl - query the ACLs of all the data objects in
+ * collName with one paged query. genQueryInp is set up here and can be
+ * used with continueInx to get the rest of the rows.
+ */
+int
+queryDataObjAclInColl (rcComm_t *conn, char *collName, char *zoneHint,
+genQueryInp_t *genQueryInp, genQueryOut_t **genQueryOut)
+{
+    int status;
+    char tmpStr[MAX_NAME_LEN];
+
+    if (collName == NULL || genQueryInp == NULL || genQueryOut == NULL) {
+        return (USER__NULL_INPUT_ERR);
+    }
+
+    memset (genQueryInp, 0, sizeof (genQueryInp_t));
+
+    if (zoneHint != NULL) {
+       addKeyVal (&genQueryInp->condInput, ZONE_KW, zoneHint);
+    }
+
+    addInxIval (&genQueryInp->selectInp, COL_D_DATA_ID, 1);
+    addInxIval (&genQueryInp->selectInp, COL_USER_NAME, 1);
+    addInxIval (&genQueryInp->selectInp, COL_USER_ZONE, 1);
+    addInxIval (&genQueryInp->selectInp, COL_DATA_ACCESS_NAME, 1);
+
+    snprintf (tmpStr, MAX_NAME_LEN, " = '%s'", collName);
+    addInxVal (&genQueryInp->sqlCondInp, COL_COLL_NAME, tmpStr);
+
+    snprintf (tmpStr, MAX_NAME_LEN, "='%s'", "access_type");
+
+    /* Currently necessary since other namespaces exist in the token table */
+    addInxVal (&genQueryInp->sqlCondInp, COL_DATA_TOKEN_NAMESPACE, tmpStr);
+
+    genQueryInp->maxRows = MAX_SQL_ROWS;
+
+    status =  rcGenQuery (conn, genQueryInp, genQueryOut);
+
+    return (status);
+}
+
 int 
 queryCollAclSpecific(rcComm_t *conn, char *collName, char *zoneHint,
               genQueryOut_t **genQueryOut)
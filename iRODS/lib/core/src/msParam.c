@@ -94,13 +94,9 @@ char *type, void *inOutStruct, bytesBuf_t *inpOutBuf, int replFlag)
 
     if ((msParamArray->len % PTR_ARRAY_MALLOC_LEN) == 0) {
         newLen = msParamArray->len + PTR_ARRAY_MALLOC_LEN;
-        newParam = (msParam_t **) malloc (newLen * sizeof (newParam));
-        memset (newParam, 0, newLen * sizeof (newParam));
-        for (i = 0; i < len; i++) {
-	    newParam[i] = msParamArray->msParam[i];
-        }
-        if (msParamArray->msParam != NULL)
-            free (msParamArray->msParam);
+        newParam = (msParam_t **) realloc (msParamArray->msParam,
+	  newLen * sizeof (newParam));
+        memset (&newParam[len], 0, PTR_ARRAY_MALLOC_LEN * sizeof (newParam));
         msParamArray->msParam = newParam;
     }
 
@@ -467,13 +463,47 @@ getMsParamByLabel (msParamArray_t *msParamArray, char *label)
     }
 
     for (i = 0; i < msParamArray->len; i++) {
-        if (strcmp (msParamArray->msParam[i]->label, label) == 0) {
+        if (msParamArray->msParam[i]->label[0] == label[0] &&
+	  strcmp (msParamArray->msParam[i]->label, label) == 0) {
             return (msParamArray->msParam[i]);
         }
     }
     return (NULL);
 }
 
+static char *
+getMsParamLabelByInx (void *owner, int inx)
+{
+    return (((msParamArray_t *) owner)->msParam[inx]->label);
+}
+
+/* getMsParamByLabelIndexed - same as getMsParamByLabel, but a
+ * msParamArray with many params is looked up through strIndex. The
+ * strIndex should be zeroed before first use and freed with clearStrIndex.
+ */
+msParam_t *
+getMsParamByLabelIndexed (strIndex_t *strIndex, msParamArray_t *msParamArray,
+char *label)
+{
+    int inx;
+
+    if (msParamArray == NULL || msParamArray->msParam == NULL ||label == NULL) {
+	return NULL;
+    }
+
+    if (strIndex == NULL || msParamArray->len < STR_INDEX_MIN_LEN) {
+	return (getMsParamByLabel (msParamArray, label));
+    }
+
+    inx = lookupStrIndex (strIndex, msParamArray, msParamArray->len,
+      getMsParamLabelByInx, label);
+    if (inx < 0) {
+	return (NULL);
+    } else {
+	return (msParamArray->msParam[inx]);
+    }
+}
+
 msParam_t *
 getMsParamByType (msParamArray_t *msParamArray, char *type)
 {
@@ -521,6 +551,7 @@ rmMsParamByLabel (msParamArray_t *msParamArray, char *label, int freeStruct)
         if (strcmp (msParamArray->msParam[i]->label, label) == 0) {
 	    clearMsParam (msParamArray->msParam[i], freeStruct);
 	    free (msParamArray->msParam[i]);
+	    invalidStrIndexes ();
 	    /* move the rest up */
 	    for (j = i + 1; j < msParamArray->len; j++) {
 		msParamArray->msParam[j - 1] = msParamArray->msParam[j];
@@ -545,6 +576,7 @@ clearMsParamArray (msParamArray_t *msParamArray, int freeStruct)
         clearMsParam (msParamArray->msParam[i], freeStruct);
         free (msParamArray->msParam[i]);
     }
+    invalidStrIndexes ();
 
     if (msParamArray->len > 0 && msParamArray->msParam != NULL) {
 	free (msParamArray->msParam);
@@ -656,6 +688,7 @@ trimMsParamArray (msParamArray_t *msParamArray, char *outParamDesc)
             if (nullType != 1)
 	      clearMsParam (msParamArray->msParam[i], 1);
 	    free (msParamArray->msParam[i]);
+	    invalidStrIndexes ();
             /* move the rest up */
             for (j = i + 1; j < msParamArray->len; j++) {
                 msParamArray->msParam[j - 1] = msParamArray->msParam[j];
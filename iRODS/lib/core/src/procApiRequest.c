@@ -299,8 +299,9 @@ bytesBuf_t *outBsBBuf)
                               &errorBBuf, conn->irodsProt, NULL, conn->ssl);
     else
 #endif
-        status = readMsgBody (conn->sock, &myHeader, &outStructBBuf, outBsBBuf,
-                              &errorBBuf, conn->irodsProt, NULL);
+        status = readMsgBodyToPool (conn->sock, &myHeader, &outStructBBuf,
+                              outBsBBuf, &errorBBuf, conn->irodsProt, NULL,
+                              RECV_POOL_MSG);
     if (status < 0) {
         rodsLogError (LOG_ERROR, status,
           "readAndProcApiReply: readMsgBody error. status = %d", status);
@@ -314,18 +315,43 @@ bytesBuf_t *outBsBBuf)
     cliChkReconnAtReadEnd (conn);
 #endif
 
-    if (strcmp (myHeader.type, RODS_API_REPLY_T) == 0) {
+    if (strcmp (myHeader.type, RODS_API_REPLY_T) == 0 ||
+      strcmp (myHeader.type, RODS_API_CREPLY_T) == 0) {
 	status = procApiReply (conn, apiInx, outStruct, outBsBBuf,
 	 &myHeader, &outStructBBuf, NULL, &errorBBuf); 
     }
 
-    clearBBuf (&outStructBBuf);
+    clearRecvBBuf (&outStructBBuf);
     /* clearBBuf (&myOutBsBBuf); */
-    clearBBuf (&errorBBuf);
+    clearRecvBBuf (&errorBBuf);
 
     return (status);
 }
 
+/* unpackWireOutStruct - unpack the outStruct of a RODS_API_CREPLY_T reply.
+ * The server only sends it if conn->wireOpt was requested in the
+ * startupPack, so the callers see no difference.
+ */
+
+int
+unpackWireOutStruct (rcComm_t *conn, int apiInx, bytesBuf_t *outStructBBuf,
+void **outStruct)
+{
+    bytesBuf_t rawBBuf;
+    int wireOpt = 0;
+    int status;
+
+    memset (&rawBBuf, 0, sizeof (rawBBuf));
+    status = decodeWireMsg (outStructBBuf, &wireOpt, &rawBBuf);
+    if (status < 0) return status;
+
+    status = unpackStruct (rawBBuf.buf, outStruct,
+      RcApiTable[apiInx].outPackInstruct, RodsPackTable, conn->irodsProt);
+    clearBBuf (&rawBBuf);
+
+    return status;
+}
+
 int
 procApiReply (rcComm_t *conn, int apiInx, void **outStruct,
 bytesBuf_t *outBsBBuf,
@@ -374,9 +400,14 @@ bytesBuf_t *errorBBuf)
     /* handle outStruct */
     if (outStructBBuf->len > 0) {
 	if (outStruct != NULL) {
-            status = unpackStruct (outStructBBuf->buf, (void **) outStruct,
-              RcApiTable[apiInx].outPackInstruct, RodsPackTable, 
-	      conn->irodsProt);
+	    if (strcmp (myHeader->type, RODS_API_CREPLY_T) == 0) {
+		status = unpackWireOutStruct (conn, apiInx, outStructBBuf,
+		  outStruct);
+	    } else {
+                status = unpackStruct (outStructBBuf->buf, 
+		  (void **) outStruct, RcApiTable[apiInx].outPackInstruct, 
+		  RodsPackTable, conn->irodsProt);
+	    }
             if (status < 0) {
                 rodsLogError (LOG_ERROR, status,
                  "readAndProcApiReply:unpackStruct error. status = %d",
@@ -2,6 +2,9 @@
  *** For more information please refer to files in the COPYRIGHT directory ***/
 #ifndef windows_platform
 #include <sys/time.h>
+#ifdef PARA_OPR
+#include <pthread.h>
+#endif
 #endif
 #include "rodsPath.h"
 #include "rodsErrorTable.h"
@@ -711,11 +714,16 @@ bulkOprInfo_t *bulkOprInfo)
 		}
 	    }
         } else {      /* a directory */
+	    if (bulkFlag == BULK_OPR_SMALL_FILES && bulkOprInfo->asyncFlag > 0) {
+		/* made in the large files pass. conn may be busy sending */
+		status = 0;
+	    } else {
 #ifdef FILESYSTEM_META
-            status = mkCollWithDirMeta (conn, targChildPath, srcChildPath);
+                status = mkCollWithDirMeta (conn, targChildPath, srcChildPath);
 #else
-	    status = mkColl (conn, targChildPath);
+	        status = mkColl (conn, targChildPath);
 #endif
+	    }
 	    if (status < 0) {
                 rodsLogError (LOG_ERROR, status,
                   "putDirUtil: mkColl error for %s", targChildPath);
@@ -799,6 +807,10 @@ bulkOprInp_t *bulkOprInp, rodsRestart_t *rodsRestart)
 #else
     bulkOprInfo.bytesBuf.len = 0;
     bulkOprInfo.bytesBuf.buf = malloc (BULK_OPR_BUF_SIZE);
+#ifdef PARA_OPR
+    /* the restart file needs the count of each bundle as it is done */
+    if (rodsRestart->fd <= 0) bulkOprInfo.asyncFlag = 1;
+#endif
 #endif
 
     status = putDirUtil (myConn, srcDir, targColl, myRodsEnv, rodsArgs, 
@@ -807,9 +819,20 @@ bulkOprInp_t *bulkOprInp, rodsRestart_t *rodsRestart)
     if (status < 0) {
         rodsLogError (LOG_ERROR, status,
           "bulkPutDirUtil: Small files bulkPut error for %s", srcDir);
+        waitBulkPut (&bulkOprInfo);
+        if (bulkOprInfo.bytesBuf.buf != NULL) free (bulkOprInfo.bytesBuf.buf);
 	return status;
     }
 
+    /* the last one is sent in this thread */
+    bulkOprInfo.asyncFlag = 0;
+    if ((status = waitBulkPut (&bulkOprInfo)) < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "bulkPutDirUtil: bulkPut error for %s", srcDir);
+        if (bulkOprInfo.bytesBuf.buf != NULL) free (bulkOprInfo.bytesBuf.buf);
+        return status;
+    }
+
     if (bulkOprInfo.count > 0) {
 #ifdef BULK_OPR_WITH_TAR
         status = tarAndBulkPut (*myConn, bulkOprInp, &bulkOprInfo);
@@ -1029,6 +1052,12 @@ bulkOprInfo_t *bulkOprInfo, rodsArguments_t *rodsArgs)
         (void) gettimeofday(&startTime, (struct timezone *)0);
     }
 
+#ifdef PARA_OPR
+    if (bulkOprInfo->asyncFlag > 0) {
+        return sendBulkPutAsync (conn, bulkOprInp, bulkOprInfo, rodsArgs);
+    }
+#endif
+
     /* send it */
     if (bulkOprInfo->bytesBuf.buf != NULL) {
         status = rcBulkDataObjPut (conn, bulkOprInp, &bulkOprInfo->bytesBuf);
@@ -1059,6 +1088,113 @@ bulkOprInfo_t *bulkOprInfo, rodsArguments_t *rodsArgs)
     return (status);
 }
 
+#ifdef PARA_OPR
+static void *
+sendBulkPutInFlight (void *arg)
+{
+    bulkPutInFlight_t *inFlight = (bulkPutInFlight_t *) arg;
+    struct timeval startTime, endTime;
+
+    if (inFlight->rodsArgs->verbose == True) {
+        (void) gettimeofday(&startTime, (struct timezone *)0);
+    }
+    inFlight->status = rcBulkDataObjPut (inFlight->conn, 
+      &inFlight->bulkOprInp, &inFlight->bytesBuf);
+    if (inFlight->status >= 0 && inFlight->rodsArgs->verbose == True) {
+        printf ("Bulk upload %d files.\n", inFlight->count);
+        (void) gettimeofday(&endTime, (struct timezone *)0);
+        printTiming (inFlight->conn, inFlight->cachedTargPath,
+          inFlight->size, inFlight->cachedTargPath, &startTime, &endTime);
+    }
+    return NULL;
+}
+#endif
+
+/* sendBulkPutAsync - hand the current bundle over to a thread which
+ * sends it while the caller fills the next one. Only one bundle is
+ * on the wire at a time since they share conn. Returns the status of
+ * the previous bundle.
+ */
+int
+sendBulkPutAsync (rcComm_t *conn, bulkOprInp_t *bulkOprInp,
+bulkOprInfo_t *bulkOprInfo, rodsArguments_t *rodsArgs)
+{
+#ifdef PARA_OPR
+    bulkPutInFlight_t *inFlight;
+    int status;
+
+    /* the previous one must be done before conn can be used again */
+    status = waitBulkPut (bulkOprInfo);
+
+    inFlight = (bulkPutInFlight_t *) calloc (1, sizeof (bulkPutInFlight_t));
+    inFlight->conn = conn;
+    inFlight->rodsArgs = rodsArgs;
+    rstrcpy (inFlight->bulkOprInp.objPath, bulkOprInp->objPath, MAX_NAME_LEN);
+    replKeyVal (&bulkOprInp->condInput, &inFlight->bulkOprInp.condInput);
+    /* take over the filled attriArray and buffer */
+    inFlight->bulkOprInp.attriArray = bulkOprInp->attriArray;
+    bzero (&bulkOprInp->attriArray, sizeof (genQueryOut_t));
+    initAttriArrayOfBulkOprInp (bulkOprInp);
+    inFlight->bytesBuf = bulkOprInfo->bytesBuf;
+    bulkOprInfo->bytesBuf.len = 0;
+    bulkOprInfo->bytesBuf.buf = malloc (BULK_OPR_BUF_SIZE);
+    inFlight->count = bulkOprInfo->count;
+    inFlight->size = bulkOprInfo->size;
+    rstrcpy (inFlight->cachedTargPath, bulkOprInfo->cachedTargPath,
+      MAX_NAME_LEN);
+    if (bulkOprInfo->forceFlagAdded == 1) {
+        rmKeyVal (&bulkOprInp->condInput, FORCE_FLAG_KW);
+        bulkOprInfo->forceFlagAdded = 0;
+    }
+
+    bulkOprInfo->inFlight = inFlight;
+    if (pthread_create (&inFlight->tid, NULL, sendBulkPutInFlight,
+      (void *) inFlight) == 0) {
+        inFlight->threadStarted = 1;
+    } else {
+        /* do it here */
+        sendBulkPutInFlight ((void *) inFlight);
+    }
+    return status;
+#else
+    return SYS_PARA_OPR_NO_SUPPORT;
+#endif
+}
+
+/* waitBulkPut - wait for the bundle being sent in the background and
+ * return its status */
+int
+waitBulkPut (bulkOprInfo_t *bulkOprInfo)
+{
+    int status = 0;
+#ifdef PARA_OPR
+    bulkPutInFlight_t *inFlight;
+
+    if (bulkOprInfo == NULL || bulkOprInfo->inFlight == NULL) return 0;
+
+    inFlight = bulkOprInfo->inFlight;
+    if (inFlight->threadStarted > 0) pthread_join (inFlight->tid, NULL);
+    status = inFlight->status;
+    if (status >= 0 && gGuiProgressCB != NULL) {
+        rstrcpy (inFlight->conn->operProgress.curFileName,
+          inFlight->cachedTargPath, MAX_NAME_LEN);
+        inFlight->conn->operProgress.totalNumFilesDone += inFlight->count;
+        inFlight->conn->operProgress.totalFileSizeDone += inFlight->size;
+        gGuiProgressCB (&inFlight->conn->operProgress);
+    }
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "waitBulkPut: rcBulkDataObjPut error for bundle ending with %s",
+          inFlight->cachedTargPath);
+    }
+    clearBulkOprInp (&inFlight->bulkOprInp);
+    if (inFlight->bytesBuf.buf != NULL) free (inFlight->bytesBuf.buf);
+    free (inFlight);
+    bulkOprInfo->inFlight = NULL;
+#endif
+    return status;
+}
+
 int
 clearBulkOprInfo (bulkOprInfo_t *bulkOprInfo)
 {
@@ -271,6 +271,7 @@ rcDisconnect (rcComm_t *conn)
     /* send disconnect msg to agent */
     status = sendRodsMsg (conn->sock, RODS_DISCONNECT_T, NULL, NULL, NULL, 0,
       conn->irodsProt);
+    logSockCommStat ("rcDisconnect");
 
     /* need to call asio close if USE_BOOST_ASIO */
     close (conn->sock);
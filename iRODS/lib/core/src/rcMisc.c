@@ -769,7 +769,9 @@ getValByKey (keyValPair_t *condInput, char *keyWord)
     }
 
     for (i = 0; i < condInput->len; i++) {
-	if (strcmp (condInput->keyWord[i], keyWord) == 0) {
+	/* check the first char before paying for the strcmp call */
+	if (condInput->keyWord[i][0] == keyWord[0] &&
+	  strcmp (condInput->keyWord[i], keyWord) == 0) {
 	    return (condInput->value[i]);
         }
     }
@@ -777,6 +779,141 @@ getValByKey (keyValPair_t *condInput, char *keyWord)
     return (NULL); 
 }
 
+/* StrIndexGen - the generation of all strIndex_t. Bumped by
+ * invalidStrIndexes() whenever keys are removed or changed in place,
+ * which makes every index rebuild itself on its next lookup.
+ */
+static int StrIndexGen = 0;
+
+void
+invalidStrIndexes ()
+{
+    StrIndexGen++;
+}
+
+static unsigned int
+hashStrIndexKey (char *key)
+{
+    unsigned int hash = 2166136261U;	/* FNV-1a */
+
+    while (*key != '\0') {
+	hash = (hash ^ (unsigned char) *key) * 16777619U;
+	key++;
+    }
+    return (hash);
+}
+
+static void
+addToStrIndex (strIndex_t *strIndex, void *owner, int inx,
+char *(*getKeyFunc) (void *owner, int inx))
+{
+    char *key, *myKey;
+    int j;
+
+    if ((key = getKeyFunc (owner, inx)) == NULL) return;
+
+    j = hashStrIndexKey (key) & (strIndex->size - 1);
+    while (strIndex->slot[j] > 0) {
+	/* a duplicate key. Keep the first one like the linear scan does */
+	myKey = getKeyFunc (owner, strIndex->slot[j] - 1);
+	if (myKey != NULL && strcmp (myKey, key) == 0) return;
+	j = (j + 1) & (strIndex->size - 1);
+    }
+    strIndex->slot[j] = inx + 1;
+}
+
+/* lookupStrIndex - look up key among the len keys of owner given by
+ * getKeyFunc, using and maintaining strIndex. The index is (re)built
+ * if it is for another owner, if it has been invalidated or if owner
+ * has shrunk. Keys appended to owner since the last lookup are added
+ * incrementally.
+ * Return the inx of the matching entry or -1 if there is none.
+ */
+int
+lookupStrIndex (strIndex_t *strIndex, void *owner, int len,
+char *(*getKeyFunc) (void *owner, int inx), char *key)
+{
+    char *myKey;
+    int i, j, newSize;
+
+    if (strIndex->owner != owner || strIndex->gen != StrIndexGen ||
+      len < strIndex->len) {
+	strIndex->owner = owner;
+	strIndex->gen = StrIndexGen;
+	strIndex->len = 0;
+	if (strIndex->slot != NULL) {
+	    memset (strIndex->slot, 0, strIndex->size * sizeof (int));
+	}
+    }
+
+    if (len * 2 > strIndex->size) {
+	/* keep the load factor under 1/2 */
+	newSize = strIndex->size > 0 ? strIndex->size : STR_INDEX_INIT_SIZE;
+	while (len * 2 > newSize) newSize *= 2;
+	if (strIndex->slot != NULL) free (strIndex->slot);
+	strIndex->slot = (int *) calloc (newSize, sizeof (int));
+	strIndex->size = newSize;
+	strIndex->len = 0;
+    }
+
+    for (i = strIndex->len; i < len; i++) {
+	addToStrIndex (strIndex, owner, i, getKeyFunc);
+    }
+    strIndex->len = len;
+
+    j = hashStrIndexKey (key) & (strIndex->size - 1);
+    while (strIndex->slot[j] > 0) {
+	myKey = getKeyFunc (owner, strIndex->slot[j] - 1);
+	if (myKey != NULL && strcmp (myKey, key) == 0)
+	    return (strIndex->slot[j] - 1);
+	j = (j + 1) & (strIndex->size - 1);
+    }
+    return (-1);
+}
+
+int
+clearStrIndex (strIndex_t *strIndex)
+{
+    if (strIndex == NULL) return (0);
+
+    if (strIndex->slot != NULL) free (strIndex->slot);
+    memset (strIndex, 0, sizeof (strIndex_t));
+    return (0);
+}
+
+static char *
+getKeyWordByInx (void *owner, int inx)
+{
+    return (((keyValPair_t *) owner)->keyWord[inx]);
+}
+
+/* getValByKeyIndexed - same as getValByKey, but a condInput with many
+ * keywords is looked up through strIndex. The strIndex should be zeroed
+ * before first use and freed with clearStrIndex.
+ */
+char *
+getValByKeyIndexed (strIndex_t *strIndex, keyValPair_t *condInput,
+char *keyWord)
+{
+    int inx;
+
+    if (condInput == NULL) {
+        return (NULL);
+    }
+
+    if (strIndex == NULL || condInput->len < STR_INDEX_MIN_LEN) {
+	return (getValByKey (condInput, keyWord));
+    }
+
+    inx = lookupStrIndex (strIndex, condInput, condInput->len,
+      getKeyWordByInx, keyWord);
+    if (inx < 0) {
+	return (NULL);
+    } else {
+	return (condInput->value[inx]);
+    }
+}
+
 /* 
  YYYY - getValByInx - this routine is currently not used
  */
@@ -831,6 +968,7 @@ rmKeyVal (keyValPair_t *condInput, char *keyWord)
           strcmp (condInput->keyWord[i], keyWord) == 0) {
             free (condInput->keyWord[i]);
             free (condInput->value[i]);
+	    invalidStrIndexes ();
 	    condInput->len--;
             for (j = i; j < condInput->len; j++) {
                 condInput->keyWord[j] = condInput->keyWord[j + 1];
@@ -852,6 +990,7 @@ replKeyVal (keyValPair_t *srcCondInput, keyValPair_t *destCondInput)
 {
     int i;
     memset (destCondInput, 0, sizeof (keyValPair_t));
+    invalidStrIndexes ();
 
     for (i = 0; i < srcCondInput->len; i++) {
         addKeyVal (destCondInput, srcCondInput->keyWord[i], 
@@ -896,11 +1035,12 @@ addKeyVal (keyValPair_t *condInput, char *keyWord, char *value)
     /* check if the keyword exists */
 
     for (i = 0; i < condInput->len; i++) {
-	if (strcmp (keyWord, condInput->keyWord[i]) == 0) {
+	if (condInput->keyWord[i][0] == keyWord[0] &&
+	  strcmp (keyWord, condInput->keyWord[i]) == 0) {
 	    free ( condInput->value[i]);
             condInput->value[i] = strdup (value);
 	    return (0);
-	} else if (strlen (condInput->keyWord[i]) == 0) {
+	} else if (condInput->keyWord[i][0] == '\0') {
 	    emptyInx = i;
 	}
     }
@@ -910,23 +1050,22 @@ addKeyVal (keyValPair_t *condInput, char *keyWord, char *value)
 	free (condInput->value[emptyInx]);
         condInput->keyWord[emptyInx] = strdup (keyWord);
         condInput->value[emptyInx] = strdup (value);
+	invalidStrIndexes ();
 	return (0);
     }
     
+    /* arrays unpacked by packStruct are allocated at PTR_ARRAY_MALLOC_LEN
+     * boundaries too, so the growth has to stay at these boundaries. */
     if ((condInput->len % PTR_ARRAY_MALLOC_LEN) == 0) {
 	newLen = condInput->len + PTR_ARRAY_MALLOC_LEN;
-	newKeyWord = (char **) malloc (newLen * sizeof (newKeyWord)); 
-	newValue = (char **) malloc (newLen * sizeof (newValue)); 
-	memset (newKeyWord, 0, newLen * sizeof (newKeyWord));
-	memset (newValue, 0, newLen * sizeof (newValue));
-	for (i = 0; i < condInput->len; i++) {
-	    newKeyWord[i] = condInput->keyWord[i];
-	    newValue[i] = condInput->value[i];
-	} 
-	if (condInput->keyWord != NULL)
-	    free (condInput->keyWord);
-	if (condInput->value != NULL)
-	    free (condInput->value);
+	newKeyWord = (char **) realloc (condInput->keyWord,
+	  newLen * sizeof (newKeyWord)); 
+	newValue = (char **) realloc (condInput->value,
+	  newLen * sizeof (newValue)); 
+	memset (&newKeyWord[condInput->len], 0,
+	  PTR_ARRAY_MALLOC_LEN * sizeof (newKeyWord));
+	memset (&newValue[condInput->len], 0,
+	  PTR_ARRAY_MALLOC_LEN * sizeof (newValue));
 	condInput->keyWord = newKeyWord;
 	condInput->value = newValue;
     }
@@ -1197,6 +1336,7 @@ clearKeyVal (keyValPair_t *condInput)
     free (condInput->keyWord);
     free (condInput->value);
     memset (condInput, 0, sizeof (keyValPair_t));
+    invalidStrIndexes ();
     return(0);
 }
 
@@ -1396,6 +1536,7 @@ moveKeyVal (keyValPair_t *destKeyVal, keyValPair_t *srcKeyVal)
 
     *destKeyVal = *srcKeyVal;
     memset (srcKeyVal, 0, sizeof (keyValPair_t));
+    invalidStrIndexes ();
     return (0);
 }
 
@@ -10,6 +10,7 @@
 #endif
 
 #include "rodsLog.h"
+#include "rodsLogBuf.h"
 #include "rcGlobalExtern.h"
 #include "rcMisc.h"
 #include <time.h>
@@ -239,6 +240,7 @@
     UNIX_FILE_RENAME_ERR, 
     UNIX_FILE_TRUNCATE_ERR, 
     UNIX_FILE_LINK_ERR, 
+    UNIX_FILE_AIO_ERR, 
     UNIX_FILE_OPR_TIMEOUT_ERR, 
     UNIV_MSS_SYNCTOARCH_ERR, 
     UNIV_MSS_STAGETOCACHE_ERR, 
@@ -867,6 +869,7 @@
     "UNIX_FILE_RENAME_ERR", 
     "UNIX_FILE_TRUNCATE_ERR", 
     "UNIX_FILE_LINK_ERR", 
+    "UNIX_FILE_AIO_ERR", 
     "UNIX_FILE_OPR_TIMEOUT_ERR", 
     "UNIV_MSS_SYNCTOARCH_ERR", 
     "UNIV_MSS_STAGETOCACHE_ERR", 
@@ -1333,6 +1336,12 @@ rodsLog(int level, char *formatStr, ...) {
 
    if (!okToLog) return;
 
+#if !defined(windows_platform) && !defined(IRODS_SYSLOG)
+   if ((ProcessType == SERVER_PT || ProcessType == AGENT_PT ||
+     ProcessType == RE_SERVER_PT) && rodsLogRateLimited (level, formatStr))
+      return;
+#endif
+
    va_start(ap, formatStr);
    i = vsnprintf(bigString, BIG_STRING_LEN-1, formatStr, ap);
    va_end(ap);
@@ -1374,6 +1383,14 @@ rodsLog(int level, char *formatStr, ...) {
    if (level == LOG_DEBUG1) prefix="DEBUG1";
    if (level == LOG_DEBUG2) prefix="DEBUG2";
    if (level == LOG_DEBUG3) prefix="DEBUG3";
+#ifndef windows_platform
+   if ((ProcessType == SERVER_PT || ProcessType == AGENT_PT ||
+     ProcessType == RE_SERVER_PT) && 
+     rodsLogBufWrite (level, prefix, bigString) >= 0) {
+      /* queued or written in the structured format */
+      return;
+   }
+#endif
    if (bigString[strlen(bigString)-1]=='\n')
 #endif
    {
@@ -1455,6 +1472,22 @@ char *formatStr, ...) {
    if (level == LOG_ERROR) prefix="ERROR";
    if (level == LOG_NOTICE) prefix="NOTICE";
    if (level <= LOG_DEBUG) prefix="DEBUG";
+#if !defined(windows_platform) && !defined(IRODS_SYSLOG)
+   /* a rate limited record still goes to myError. Only the log line is
+    * dropped */
+   if ((ProcessType == SERVER_PT || ProcessType == AGENT_PT ||
+     ProcessType == RE_SERVER_PT) && 
+     (rodsLogRateLimited (level, formatStr) ||
+     rodsLogBufWrite (level, prefix, bigString) >= 0)) {
+      if (myError != NULL) {
+         /* as much of bigString as fits after the prefix */
+         snprintf (errMsg, ERR_MSG_LEN, "%s: %.*s", prefix,
+           (int) (ERR_MSG_LEN - strlen (prefix) - 3), bigString);
+         addRErrorMsg (myError, status, errMsg);
+      }
+      return;
+   }
+#endif
    if (bigString[strlen(bigString)-1]=='\n') 
    {
 #ifndef windows_platform
@@ -0,0 +1,461 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* rodsLogBuf.c - asynchronous, buffered and structured backend of rodsLog
+ * for the server processes (irodsServer, irodsAgent and irodsReServer).
+ *
+ * With spLogBuffered=1 in the server env, each record is formatted into
+ * a slot of a per-process lock-free ring (a bounded MPSC queue: producers
+ * claim slots with a CAS on LogBufHead, each slot carries a sequence
+ * number telling whether it is free or filled). A background writer
+ * thread, started on the first buffered record, drains the ring to
+ * stdout with writev. stdout is the log file the server dup'ed
+ * in serverize and chkLogfileName, so log rotation keeps working.
+ * When the ring is full the producer waits for the writer to free a
+ * slot, so no record is lost or written ahead of the queued ones. The
+ * ring is flushed at exit and before any LOG_SYS_FATAL record.
+ *
+ * spLogFormat=kv or json gives structured records (with or without
+ * buffering). spLogRateLimit=n suppresses more than n records per
+ * second from the same rodsLog call site.
+ */
+
+#include "rodsLog.h"
+#include "rodsLogBuf.h"
+#include "rcGlobalExtern.h"
+#include <time.h>
+#include <sys/time.h>
+
+#ifndef windows_platform
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/uio.h>
+#endif
+
+#if defined(__GNUC__) && !defined(windows_platform)
+#define LOG_BUF_ATOMIC	1
+#endif
+
+#ifdef LOG_BUF_ATOMIC
+static pthread_once_t LogBufOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t LogBufStartMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t LogRateMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t LogBufWriterThr;
+#endif
+
+static int LogBufOn = 0;
+static int LogBufFormat = LOG_FORMAT_TEXT;
+static int LogRateLimit = 0;
+static logBufSlot_t *LogBufSlots = NULL;
+static volatile unsigned int LogBufHead = 0;	/* next slot to claim */
+static volatile unsigned int LogBufTail = 0;	/* next slot to drain */
+static volatile int LogBufStop = 0;
+static int LogBufClosed = 0;
+static pid_t LogBufPid = 0;
+static pid_t LogBufWriterPid = 0;	/* pid which owns the writer thr */
+static logRateEnt_t LogRateTable[LOG_RATE_TABLE_SZ];
+
+static unsigned int LogBufQueuedCnt = 0;
+static unsigned int LogBufSyncCnt = 0;
+static unsigned int LogRateSuppressedCnt = 0;
+
+#ifdef LOG_BUF_ATOMIC
+#define LOG_BUF_INC(cnt)	__sync_fetch_and_add (&(cnt), 1)
+#else
+#define LOG_BUF_INC(cnt)	((cnt)++)
+#endif
+
+static int
+escLogStr (char *inStr, char *outStr, int maxLen)
+{
+    int len = 0;
+    unsigned char c;
+
+    while ((c = (unsigned char) *inStr++) != '\0' && len < maxLen - 7) {
+        if (c == '"' || c == '\\') {
+            outStr[len++] = '\\';
+            outStr[len++] = c;
+        } else if (c == '\n') {
+            outStr[len++] = '\\';
+            outStr[len++] = 'n';
+        } else if (c == '\t') {
+            outStr[len++] = '\\';
+            outStr[len++] = 't';
+        } else if (c < 0x20) {
+            len += snprintf (&outStr[len], maxLen - len, "\\u%04x", c);
+        } else {
+            outStr[len++] = c;
+        }
+    }
+    outStr[len] = '\0';
+    return (len);
+}
+
+/* fmtLogRec - format one newline terminated record into outRec.
+ * Returns the record length.
+ */
+static int
+fmtLogRec (int level, char *prefix, char *msg, char *outRec, int maxLen)
+{
+    char myMsg[LOG_BUF_REC_LEN];
+    char timeBuf[TIME_LEN];
+    int len, msgLen;
+
+    rstrcpy (myMsg, msg, LOG_BUF_REC_LEN);
+    msgLen = strlen (myMsg);
+    if (msgLen > 0 && myMsg[msgLen - 1] == '\n')
+        myMsg[msgLen - 1] = '\0';
+
+    if (LogBufFormat == LOG_FORMAT_TEXT) {
+        time_t myTime = time (0);
+        struct tm mytm;
+
+        localtime_r (&myTime, &mytm);
+        strftime (timeBuf, TIME_LEN, "%b %e %H:%M:%S", &mytm);
+        len = snprintf (outRec, maxLen, "%s pid:%d %s: %s\n",
+          timeBuf, LogBufPid, prefix, myMsg);
+    } else {
+        char escMsg[LOG_BUF_REC_LEN];
+
+        escLogStr (myMsg, escMsg, LOG_BUF_REC_LEN);
+        generateLogTimestamp (timeBuf, TIME_LEN);
+        if (LogBufFormat == LOG_FORMAT_JSON) {
+            len = snprintf (outRec, maxLen,
+              "{\"time\":\"%s\",\"pid\":%d,\"level\":\"%s\",\"msg\":\"%s\"}\n",
+              timeBuf, LogBufPid, prefix, escMsg);
+        } else {
+            len = snprintf (outRec, maxLen,
+              "time=%s pid=%d level=%s msg=\"%s\"\n",
+              timeBuf, LogBufPid, prefix, escMsg);
+        }
+    }
+    if (len >= maxLen) {
+        /* truncated. keep the record newline terminated */
+        len = maxLen - 1;
+        outRec[len - 1] = '\n';
+    }
+    return (len);
+}
+
+static int
+writeLogRec (char *rec, int len)
+{
+    int nbytes;
+
+    while (len > 0) {
+        nbytes = write (STDOUT_FILENO, rec, len);
+        if (nbytes < 0) {
+            if (errno == EINTR) continue;
+            return (-1);
+        }
+        rec += nbytes;
+        len -= nbytes;
+    }
+    return (0);
+}
+
+#ifdef LOG_BUF_ATOMIC
+static int
+writeLogRecv (struct iovec *iov, int iovCnt)
+{
+    int nbytes;
+
+    while (iovCnt > 0) {
+        nbytes = writev (STDOUT_FILENO, iov, iovCnt);
+        if (nbytes < 0) {
+            if (errno == EINTR) continue;
+            return (-1);
+        }
+        while (iovCnt > 0 && nbytes >= (int) iov->iov_len) {
+            nbytes -= iov->iov_len;
+            iov++;
+            iovCnt--;
+        }
+        if (iovCnt > 0) {
+            /* partial write */
+            iov->iov_base = (char *) iov->iov_base + nbytes;
+            iov->iov_len -= nbytes;
+        }
+    }
+    return (0);
+}
+
+static void *
+logBufWriter (void *arg)
+{
+    struct iovec iov[LOG_BUF_IOV_CNT];
+    logBufSlot_t *slot;
+    unsigned int tail;
+    int i, cnt;
+
+    for (;;) {
+        tail = LogBufTail;
+        for (cnt = 0; cnt < LOG_BUF_IOV_CNT; cnt++) {
+            slot = &LogBufSlots[(tail + cnt) & LOG_BUF_SLOT_MASK];
+            if (slot->seq != tail + cnt + 1) break;	/* not filled yet */
+            iov[cnt].iov_base = slot->rec;
+            iov[cnt].iov_len = slot->len;
+        }
+        if (cnt == 0) {
+            if (LogBufStop) break;
+            usleep (LOG_BUF_IDLE_USEC);
+            continue;
+        }
+        __sync_synchronize ();
+        writeLogRecv (iov, cnt);
+        /* hand the slots back to the producers */
+        for (i = 0; i < cnt; i++) {
+            slot = &LogBufSlots[(tail + i) & LOG_BUF_SLOT_MASK];
+            __sync_synchronize ();
+            slot->seq = tail + i + LOG_BUF_SLOT_CNT;
+        }
+        LogBufTail = tail + cnt;
+    }
+    return (NULL);
+}
+
+static void
+logBufAtforkChild ()
+{
+    int i;
+
+    /* the records still in the ring belong to the parent. The writer
+     * thread is not inherited and will be restarted on demand */
+    LogBufPid = getpid ();
+    LogBufWriterPid = 0;
+    LogBufStop = 0;
+    LogBufHead = LogBufTail = 0;
+    if (LogBufSlots != NULL) {
+        for (i = 0; i < LOG_BUF_SLOT_CNT; i++) {
+            LogBufSlots[i].seq = i;
+        }
+    }
+    pthread_mutex_init (&LogBufStartMutex, NULL);
+    pthread_mutex_init (&LogRateMutex, NULL);
+}
+
+/* startLogBufWriter - start the writer thread of this process. If that
+ * fails, LogBufWriterPid stays unset and records are written
+ * synchronously.
+ */
+static void
+startLogBufWriter ()
+{
+    pthread_mutex_lock (&LogBufStartMutex);
+    if (LogBufWriterPid != LogBufPid &&
+      pthread_create (&LogBufWriterThr, NULL, logBufWriter, NULL) == 0) {
+        LogBufWriterPid = LogBufPid;
+    }
+    pthread_mutex_unlock (&LogBufStartMutex);
+}
+
+static void
+drainLogBuf ()
+{
+    int i;
+
+    if (LogBufWriterPid != LogBufPid) return;
+    for (i = 0; i < LOG_BUF_DRAIN_WAIT_CNT && LogBufTail != LogBufHead; i++) {
+        usleep (LOG_BUF_IDLE_USEC);
+    }
+}
+
+/* queueLogRec - claim a slot and format the record into it. If the
+ * ring is full, wait for the writer to free a slot. A record written
+ * synchronously instead would overtake the queued ones.
+ * Returns 0 if queued, -1 if the writer is stopping.
+ */
+static int
+queueLogRec (int level, char *prefix, char *msg)
+{
+    logBufSlot_t *slot;
+    unsigned int head;
+    int diff;
+
+    for (;;) {
+        head = LogBufHead;
+        slot = &LogBufSlots[head & LOG_BUF_SLOT_MASK];
+        diff = (int) (slot->seq - head);
+        if (diff == 0) {
+            if (__sync_bool_compare_and_swap (&LogBufHead, head, head + 1))
+                break;
+        } else if (diff < 0) {
+            /* full */
+            if (LogBufStop) return (-1);
+            usleep (LOG_BUF_FULL_USEC);
+        }
+        /* else another producer took it. try the next one */
+    }
+    slot->len = fmtLogRec (level, prefix, msg, slot->rec, LOG_BUF_REC_LEN);
+    __sync_synchronize ();
+    slot->seq = head + 1;
+    LOG_BUF_INC (LogBufQueuedCnt);
+    return (0);
+}
+#endif	/* LOG_BUF_ATOMIC */
+
+static void
+initLogBuf ()
+{
+    char *tmpStr;
+
+    LogBufPid = getpid ();
+    if ((tmpStr = getenv (SP_LOG_FORMAT)) != NULL) {
+        if (strcmp (tmpStr, "json") == 0) {
+            LogBufFormat = LOG_FORMAT_JSON;
+        } else if (strcmp (tmpStr, "kv") == 0) {
+            LogBufFormat = LOG_FORMAT_KV;
+        }
+    }
+    if ((tmpStr = getenv (SP_LOG_RATE_LIMIT)) != NULL) {
+        LogRateLimit = atoi (tmpStr);
+    }
+#ifdef LOG_BUF_ATOMIC
+    if ((tmpStr = getenv (SP_LOG_BUFFERED)) != NULL && atoi (tmpStr) > 0) {
+        int i;
+
+        LogBufSlots = (logBufSlot_t *)
+          malloc (LOG_BUF_SLOT_CNT * sizeof (logBufSlot_t));
+        if (LogBufSlots == NULL) return;
+        for (i = 0; i < LOG_BUF_SLOT_CNT; i++) {
+            LogBufSlots[i].seq = i;
+        }
+        atexit (rodsLogBufFlush);
+        LogBufOn = 1;
+    }
+    pthread_atfork (NULL, NULL, logBufAtforkChild);
+#endif
+}
+
+static void
+chkInitLogBuf ()
+{
+#ifdef LOG_BUF_ATOMIC
+    pthread_once (&LogBufOnce, initLogBuf);
+#else
+    if (LogBufPid == 0) initLogBuf ();
+#endif
+}
+
+/* putLogRec - queue the record if buffering is on, otherwise (or if the
+ * writer is stopping) write it synchronously after the queued records.
+ */
+static int
+putLogRec (int level, char *prefix, char *msg)
+{
+    char rec[LOG_BUF_REC_LEN];
+    int len;
+
+#ifdef LOG_BUF_ATOMIC
+    if (LogBufOn && !LogBufClosed) {
+        if (level <= LOG_SYS_FATAL) {
+            drainLogBuf ();
+        } else {
+            if (LogBufWriterPid != LogBufPid) startLogBufWriter ();
+            if (LogBufWriterPid == LogBufPid) {
+                if (queueLogRec (level, prefix, msg) >= 0) return (0);
+                drainLogBuf ();
+            }
+        }
+    }
+#endif
+    len = fmtLogRec (level, prefix, msg, rec, LOG_BUF_REC_LEN);
+    LOG_BUF_INC (LogBufSyncCnt);
+    return (writeLogRec (rec, len));
+}
+
+/* rodsLogBufWrite - called by rodsLog for server processes.
+ * Returns -1 if neither buffering nor a structured format is
+ * configured and the caller should log the traditional way.
+ */
+int
+rodsLogBufWrite (int level, char *prefix, char *msg)
+{
+    chkInitLogBuf ();
+    if (LogBufOn == 0 && LogBufFormat == LOG_FORMAT_TEXT) return (-1);
+
+    fflush (stdout);	/* keep order with anything already in stdio */
+    putLogRec (level, prefix, msg);
+    return (0);
+}
+
+/* rodsLogRateLimited - returns 1 if the record from the call site
+ * identified by formatStr should be dropped. A count of the dropped
+ * records is logged once the call site logs again in a new window.
+ */
+int
+rodsLogRateLimited (int level, char *formatStr)
+{
+    logRateEnt_t *ent;
+    time_t now;
+    char *oldFormatStr = NULL;
+    int suppressed = 0;
+    int limited = 0;
+
+    chkInitLogBuf ();
+    if (LogRateLimit <= 0 || level <= LOG_SYS_FATAL || formatStr == NULL)
+        return (0);
+
+    ent = &LogRateTable[((unsigned long) formatStr >> 3) &
+      (LOG_RATE_TABLE_SZ - 1)];
+    now = time (0);
+#ifdef LOG_BUF_ATOMIC
+    pthread_mutex_lock (&LogRateMutex);
+#endif
+    if (ent->formatStr != formatStr ||
+      now >= ent->windowStart + LOG_RATE_WINDOW) {
+        oldFormatStr = ent->formatStr;
+        suppressed = ent->suppressed;
+        ent->formatStr = formatStr;
+        ent->windowStart = now;
+        ent->cnt = 1;
+        ent->suppressed = 0;
+    } else if (ent->cnt >= LogRateLimit) {
+        ent->suppressed++;
+        limited = 1;
+    } else {
+        ent->cnt++;
+    }
+#ifdef LOG_BUF_ATOMIC
+    pthread_mutex_unlock (&LogRateMutex);
+#endif
+
+    if (limited) {
+        LOG_BUF_INC (LogRateSuppressedCnt);
+    } else if (suppressed > 0) {
+        char msg[LOG_BUF_REC_LEN];
+
+        snprintf (msg, LOG_BUF_REC_LEN,
+          "rodsLog: suppressed %d messages of the form \"%s\"",
+          suppressed, oldFormatStr);
+        fflush (stdout);
+        putLogRec (LOG_NOTICE, "NOTICE", msg);
+    }
+    return (limited);
+}
+
+/* rodsLogBufFlush - stop the writer thread after it has drained the
+ * ring. Registered with atexit. Records logged afterward are written
+ * synchronously.
+ */
+void
+rodsLogBufFlush ()
+{
+#ifdef LOG_BUF_ATOMIC
+    if (LogBufWriterPid == 0 || LogBufWriterPid != getpid ()) return;
+    LogBufClosed = 1;
+    LogBufStop = 1;
+    pthread_join (LogBufWriterThr, NULL);
+    LogBufWriterPid = 0;
+#endif
+}
+
+int
+getLogBufStat (unsigned int *queuedCnt, unsigned int *syncCnt,
+unsigned int *suppressedCnt)
+{
+    if (queuedCnt != NULL) *queuedCnt = LogBufQueuedCnt;
+    if (syncCnt != NULL) *syncCnt = LogBufSyncCnt;
+    if (suppressedCnt != NULL) *suppressedCnt = LogRateSuppressedCnt;
+    return (LogBufOn);
+}
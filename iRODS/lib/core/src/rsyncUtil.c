@@ -8,6 +8,7 @@
 #include "rodsLog.h"
 #include "rsyncUtil.h"
 #include "miscUtil.h"
+#include "deltaUtil.h"
 static int CurrentTime = 0;
 int
 ageExceeded (int ageLimit, int myTime, int verbose, char *objPath, 
@@ -261,6 +262,7 @@ dataObjInp_t *dataObjOprInp)
     struct timeval startTime, endTime;
     int putFlag = 0;
     int syncFlag = 0;
+    int deltaFlag = 0;
     char *chksum;
  
     if (srcPath == NULL || targPath == NULL) {
@@ -316,6 +318,11 @@ dataObjInp_t *dataObjOprInp)
                       chksum);
                 }
 		putFlag = 1;
+		/* a modified large file. Try to send only the changes */
+		if (getDeltaMinSize () >= 0 && targPath->size > 0 &&
+		  srcPath->size >= getDeltaMinSize ()) {
+		    deltaFlag = 1;
+		}
 	    }
 	}
     } else { 
@@ -345,7 +352,14 @@ dataObjInp_t *dataObjOprInp)
     if (putFlag == 1) {
 	/* only do the sync if no -l option specified */
 	if ( myRodsArgs->longOption != True ) { 
-            status = rcDataObjPut (conn, dataObjOprInp, srcPath->outPath);
+	    status = -1;
+	    if (deltaFlag == 1) {
+		status = deltaPutUtil (conn, srcPath->outPath, dataObjOprInp,
+		  getValByKey (&dataObjOprInp->condInput, RSYNC_CHKSUM_KW));
+	    }
+	    if (status < 0) {
+                status = rcDataObjPut (conn, dataObjOprInp, srcPath->outPath);
+	    }
 	} else {
 	    status = 0;
             printf ("%s   %lld   N\n", srcPath->outPath, srcPath->size);
@@ -6,6 +6,7 @@
 #include "rodsErrorTable.h"
 #include "rodsLog.h"
 #include "scanUtil.h"
+#include "fsckUtil.h"
 #include "miscUtil.h"
 
 int
@@ -50,7 +51,13 @@ used for a mounted collection: abort!\n", inpPath);
 						return (status);
 					}
 				}
-				status = scanObjDir(conn, myRodsArgs, inpPath, hostname);
+				if ( myRodsArgs->all == True ) {
+					status = auditObjDir(conn, myRodsArgs, inpPath, hostname, 
+					  AUDIT_ORPHAN_ONLY);
+				}
+				else {
+					status = scanObjDir(conn, myRodsArgs, inpPath, hostname);
+				}
 			}
 			else {
 				status = USER_INPUT_PATH_ERR;
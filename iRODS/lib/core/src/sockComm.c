@@ -16,6 +16,32 @@
 #ifdef windows_platform
 #include "irodsntutil.h"
 #endif
+#ifdef ZLIB_COMPRESS
+#include <zlib.h>
+#endif
+#ifndef _WIN32
+#include <sys/uio.h>
+#else
+struct iovec {
+    void *iov_base;
+    size_t iov_len;
+};
+#endif
+
+static sockCommStat_t SockCommStat;
+
+/* the pool of receive buffers handed out by readMsgBodyToPool and
+ * given back by clearRecvBBuf */
+typedef struct recvBuf {
+    void *buf;
+    int size;
+    int inUse;
+} recvBuf_t;
+
+static recvBuf_t RecvBufPool[RECV_BUF_POOL_SIZE];
+#ifndef windows_platform
+static pthread_mutex_t RecvBufPoolLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 #ifdef _WIN32
 #include <mmsystem.h>
@@ -468,6 +494,7 @@ int *bytesRead, struct timeval *tv)
         }
         nbytes = read (sock, (void *) tmpPtr, toRead);
 #endif
+	SockCommStat.numReadCalls++;
         if (nbytes <= 0) {
             if (errno == EINTR) {
                 /* interrupted */
@@ -510,6 +537,7 @@ int *bytesWritten)
 #else
         nbytes = write (sock, (void *) tmpPtr, toWrite);
 #endif
+	SockCommStat.numWriteCalls++;
         if (nbytes <= 0) {
 	    if (errno == EINTR) {
 		/* interrupted */
@@ -1083,6 +1111,19 @@ sendStartupPack (rcComm_t *conn, int connectCnt, int reconnFlag)
         startupPack.option[0] = '\0';
     }
 
+    conn->wireOpt = getWireOpt ();
+    if (conn->wireOpt != 0) {
+	char wireOptStr[NAME_LEN];
+	int optLen;
+
+	/* make room for the wire options at the end of the option */
+	snprintf (wireOptStr, NAME_LEN, "%s%d", WIRE_OPT_KW, conn->wireOpt);
+	optLen = NAME_LEN - 1 - strlen (wireOptStr);
+	if ((int) strlen (startupPack.option) > optLen)
+	    startupPack.option[optLen] = '\0';
+	strcat (startupPack.option, wireOptStr);
+    }
+
     /* always use XML_PROT for the startupPack */
     status = packStruct ((void *) &startupPack, &startupPackBBuf,
       "StartupPack_PI", RodsPackTable, 0, XML_PROT);
@@ -1153,14 +1194,71 @@ char *reconnAddr, int cookie)
 }
 
 
+/* myWritev - write the iovec array to sock. iov is modified. Returns the
+ * number of bytes written, which is less than the total on error.
+ */
+static int
+myWritev (int sock, struct iovec *iov, int iovcnt)
+{
+    int nbytes;
+    int totalWritten = 0;
+
+    while (iovcnt > 0) {
+	if (iov->iov_len == 0) {
+	    iov++;
+	    iovcnt--;
+	    continue;
+	}
+#ifdef _WIN32
+	nbytes = myWrite (sock, iov->iov_base, iov->iov_len, SOCK_TYPE, NULL);
+	if (nbytes != (int) iov->iov_len) {
+	    if (nbytes > 0) totalWritten += nbytes;
+	    break;
+	}
+#else
+	nbytes = writev (sock, iov, iovcnt);
+	SockCommStat.numWriteCalls++;
+	if (nbytes <= 0) {
+	    if (errno == EINTR) {
+		/* interrupted */
+		errno = 0;
+		continue;
+	    } else {
+		break;
+	    }
+	}
+#endif
+	totalWritten += nbytes;
+	/* skip what was written */
+	while (nbytes > 0) {
+	    if (nbytes >= (int) iov->iov_len) {
+		nbytes -= iov->iov_len;
+		iov++;
+		iovcnt--;
+	    } else {
+		iov->iov_base = (char *) iov->iov_base + nbytes;
+		iov->iov_len -= nbytes;
+		nbytes = 0;
+	    }
+	}
+    }
+    return (totalWritten);
+}
+
+/* sendRodsMsg - send a msg. The header, the msg, the error and the byte
+ * stream are written with a single writev in the normal case.
+ */
 int
-sendRodsMsg (int sock, char *msgType, bytesBuf_t *msgBBuf, 
-bytesBuf_t *byteStreamBBuf, bytesBuf_t *errorBBuf, int intInfo, 
+sendRodsMsg (int sock, char *msgType, bytesBuf_t *msgBBuf,
+bytesBuf_t *byteStreamBBuf, bytesBuf_t *errorBBuf, int intInfo,
 irodsProt_t irodsProt)
 {
     int status;
     msgHeader_t msgHeader;
-    int bytesWritten;
+    bytesBuf_t *headerBBuf = NULL;
+    struct iovec iov[5];
+    int iovcnt = 0;
+    int myLen, totalLen, nbytes;
 
     memset (&msgHeader, 0, sizeof (msgHeader));
 
@@ -1177,50 +1275,222 @@ irodsProt_t irodsProt)
     } else {
         msgHeader.bsLen = byteStreamBBuf->len;
     }
- 
+
     if (errorBBuf == NULL) {
         msgHeader.errorLen = 0;
-    } else { 
+    } else {
         msgHeader.errorLen = errorBBuf->len;
     }
 
     msgHeader.intInfo = intInfo;
 
-    status = writeMsgHeader (sock, &msgHeader);
+    /* always use XML_PROT for the Header */
+    status = packStruct ((void *) &msgHeader, &headerBBuf,
+      "MsgHeader_PI", RodsPackTable, 0, XML_PROT);
 
-    if (status < 0)
-	return (status);
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+         "sendRodsMsg: packStruct error, status = %d", status);
+        return status;
+    }
 
-    /* send the rest */
+    if (getRodsLogLevel () >= LOG_DEBUG3) {
+        printf ("sending header: len = %d\n%s\n", headerBBuf->len,
+	  (char *) headerBBuf->buf);
+    }
+
+    myLen = htonl (headerBBuf->len);
+    iov[iovcnt].iov_base = (void *) &myLen;
+    iov[iovcnt++].iov_len = sizeof (myLen);
+    iov[iovcnt].iov_base = headerBBuf->buf;
+    iov[iovcnt++].iov_len = headerBBuf->len;
+    totalLen = sizeof (myLen) + headerBBuf->len;
 
     if (msgHeader.msgLen > 0) {
         if (irodsProt == XML_PROT && getRodsLogLevel () >= LOG_DEBUG3) {
             printf ("sending msg: \n%s\n", (char *) msgBBuf->buf);
         }
-        status = myWrite (sock, msgBBuf->buf, msgBBuf->len, SOCK_TYPE, NULL);
-        if (status < 0) 
-            return (status);
+	iov[iovcnt].iov_base = msgBBuf->buf;
+	iov[iovcnt++].iov_len = msgBBuf->len;
+	totalLen += msgBBuf->len;
     }
 
     if (msgHeader.errorLen > 0) {
         if (irodsProt == XML_PROT && getRodsLogLevel () >= LOG_DEBUG3) {
             printf ("sending error msg: \n%s\n", (char *) errorBBuf->buf);
         }
-        status = myWrite (sock, errorBBuf->buf, errorBBuf->len, SOCK_TYPE, 
-	  NULL);
-        if (status < 0)
-            return (status);
+	iov[iovcnt].iov_base = errorBBuf->buf;
+	iov[iovcnt++].iov_len = errorBBuf->len;
+	totalLen += errorBBuf->len;
     }
     if (msgHeader.bsLen > 0) {
-        status = myWrite (sock, byteStreamBBuf->buf,
-          byteStreamBBuf->len, SOCK_TYPE, &bytesWritten);
-        if (status < 0)
-            return (status);
+	iov[iovcnt].iov_base = byteStreamBBuf->buf;
+	iov[iovcnt++].iov_len = byteStreamBBuf->len;
+	totalLen += byteStreamBBuf->len;
     }
 
+    nbytes = myWritev (sock, iov, iovcnt);
+    freeBBuf (headerBBuf);
+
+    if (nbytes != totalLen) {
+        rodsLog (LOG_ERROR,
+         "sendRodsMsg: wrote %d bytes, expect %d, status = %d",
+         nbytes, totalLen, SYS_HEADER_WRITE_LEN_ERR - errno);
+        return (SYS_HEADER_WRITE_LEN_ERR - errno);
+    }
+    SockCommStat.numMsgSent++;
+
     return (0);
 }
 
+/* getWireOpt - get the WIRE_OPT_ flags this process requests as a client.
+ * Given by the irodsWireOpt env variable. Default to all the supported
+ * ones.
+ */
+
+int
+getWireOpt ()
+{
+    char *tmpStr;
+
+    if ((tmpStr = getenv (IRODS_WIRE_OPT)) != NULL) {
+	return atoi (tmpStr) & WIRE_OPT_SUPPORTED;
+    } else {
+	return WIRE_OPT_SUPPORTED;
+    }
+}
+
+/* parseWireOpt - server side. Strip the wire options appended by
+ * sendStartupPack from option and return the flags the server agrees to
+ * use. The irodsWireOpt env variable restricts what the server allows.
+ */
+
+int
+parseWireOpt (char *option)
+{
+    char *wireOptStr, *tmpStr;
+    int wireOpt;
+
+    if (option == NULL ||
+      (wireOptStr = strstr (option, WIRE_OPT_KW)) == NULL) {
+	return 0;
+    }
+    wireOpt = atoi (wireOptStr + strlen (WIRE_OPT_KW));
+    *wireOptStr = '\0';
+
+    if ((tmpStr = getenv (IRODS_WIRE_OPT)) != NULL) {
+	wireOpt &= atoi (tmpStr);
+    }
+    return wireOpt & WIRE_OPT_SUPPORTED;
+}
+
+/* encodeWireMsg - encode the packed msg in inBBuf for a wire encoded
+ * (RODS_API_CREPLY_T) msg. The output starts with a WIRE_HEADER_LEN
+ * header giving the WIRE_OPT_ flags actually applied and the length of
+ * the raw msg. inBBuf is compressed if WIRE_OPT_ZLIB is set in wireOpt
+ * and the msg is not too small to gain from it.
+ */
+
+int
+encodeWireMsg (bytesBuf_t *inBBuf, int wireOpt, bytesBuf_t *outBBuf)
+{
+    unsigned int header[2];
+    int outLen = 0;
+
+    wireOpt &= WIRE_OPT_SUPPORTED;
+    if (inBBuf->len < WIRE_COMPRESS_MIN_LEN)
+	wireOpt &= ~WIRE_OPT_ZLIB;
+
+#ifdef ZLIB_COMPRESS
+    if ((wireOpt & WIRE_OPT_ZLIB) != 0) {
+	uLongf destLen = compressBound (inBBuf->len);
+	int status;
+
+	outBBuf->buf = malloc (WIRE_HEADER_LEN + destLen);
+	status = compress2 ((Bytef *) outBBuf->buf + WIRE_HEADER_LEN,
+	  &destLen, (Bytef *) inBBuf->buf, inBBuf->len, Z_BEST_SPEED);
+	if (status == Z_OK && (int) destLen < inBBuf->len) {
+	    outLen = destLen;
+	} else {
+	    /* incompressible. send it raw */
+	    free (outBBuf->buf);
+	    wireOpt &= ~WIRE_OPT_ZLIB;
+	}
+    }
+#endif
+    if ((wireOpt & WIRE_OPT_ZLIB) == 0) {
+	outBBuf->buf = malloc (WIRE_HEADER_LEN + inBBuf->len);
+	memcpy ((char *) outBBuf->buf + WIRE_HEADER_LEN, inBBuf->buf,
+	  inBBuf->len);
+	outLen = inBBuf->len;
+    }
+    header[0] = htonl (wireOpt);
+    header[1] = htonl (inBBuf->len);
+    memcpy (outBBuf->buf, header, WIRE_HEADER_LEN);
+    outBBuf->len = WIRE_HEADER_LEN + outLen;
+
+    return wireOpt;
+}
+
+/* decodeWireMsg - the reverse of encodeWireMsg. The raw msg is returned
+ * in outBBuf and the flags applied by the sender in outWireOpt.
+ */
+
+int
+decodeWireMsg (bytesBuf_t *inBBuf, int *outWireOpt, bytesBuf_t *outBBuf)
+{
+    unsigned int header[2];
+    int wireOpt, rawLen, inLen;
+
+    if (inBBuf->len < WIRE_HEADER_LEN) {
+	rodsLog (LOG_ERROR, "decodeWireMsg: msg length %d too short",
+	  inBBuf->len);
+	return SYS_READ_MSG_BODY_LEN_ERR;
+    }
+    memcpy (header, inBBuf->buf, WIRE_HEADER_LEN);
+    wireOpt = ntohl (header[0]);
+    rawLen = ntohl (header[1]);
+    inLen = inBBuf->len - WIRE_HEADER_LEN;
+
+    if ((wireOpt & ~WIRE_OPT_SUPPORTED) != 0) {
+	rodsLog (LOG_ERROR, "decodeWireMsg: unsupported wire option 0x%x",
+	  wireOpt);
+	return SYS_INVALID_PROTOCOL_TYPE;
+    }
+    /* 1032 is the max compression ratio of zlib */
+    if (rawLen < 0 || ((wireOpt & WIRE_OPT_ZLIB) == 0 && rawLen != inLen) ||
+      (double) rawLen > (double) inLen * 1032) {
+	rodsLog (LOG_ERROR, 
+	  "decodeWireMsg: bad raw length %d for msg length %d",
+	  rawLen, inLen);
+	return SYS_READ_MSG_BODY_LEN_ERR;
+    }
+
+    outBBuf->buf = malloc (rawLen + 1);
+    if (outBBuf->buf == NULL) return SYS_MALLOC_ERR;
+#ifdef ZLIB_COMPRESS
+    if ((wireOpt & WIRE_OPT_ZLIB) != 0) {
+	uLongf destLen = rawLen;
+	int status;
+
+	status = uncompress ((Bytef *) outBBuf->buf, &destLen,
+	  (Bytef *) inBBuf->buf + WIRE_HEADER_LEN, inLen);
+	if (status != Z_OK || (int) destLen != rawLen) {
+	    rodsLog (LOG_ERROR, 
+	      "decodeWireMsg: uncompress error, status = %d", status);
+	    free (outBBuf->buf);
+	    outBBuf->buf = NULL;
+	    return SYS_READ_MSG_BODY_LEN_ERR;
+	}
+    } else
+#endif
+    memcpy (outBBuf->buf, (char *) inBBuf->buf + WIRE_HEADER_LEN, rawLen);
+    outBBuf->len = rawLen;
+    *outWireOpt = wireOpt;
+
+    return 0;
+}
+
 int
 rodsSleep (int sec, int microSec)
 {
@@ -1234,13 +1504,162 @@ rodsSleep (int sec, int microSec)
     return 0;
 }
 
+/* myReadv - read the iovec array from sock. iov is modified. Returns the
+ * number of bytes read, which is less than the total on error or EOF.
+ * With a timeout, each part is read with myRead instead.
+ */
+static int
+myReadv (int sock, struct iovec *iov, int iovcnt, struct timeval *tv)
+{
+    int nbytes;
+    int totalRead = 0;
+
+    while (iovcnt > 0) {
+	if (iov->iov_len == 0) {
+	    iov++;
+	    iovcnt--;
+	    continue;
+	}
+#ifndef _WIN32
+	if (tv == NULL) {
+	    nbytes = readv (sock, iov, iovcnt);
+	    SockCommStat.numReadCalls++;
+	    if (nbytes < 0 && errno == EINTR) {
+		/* interrupted */
+		errno = 0;
+		continue;
+	    }
+	    if (nbytes <= 0) break;
+	} else
+#endif
+	{
+	    nbytes = myRead (sock, iov->iov_base, iov->iov_len, SOCK_TYPE,
+	      NULL, tv);
+	    if (nbytes != (int) iov->iov_len) {
+		if (nbytes > 0) totalRead += nbytes;
+		break;
+	    }
+	}
+	totalRead += nbytes;
+	/* skip what was read */
+	while (nbytes > 0) {
+	    if (nbytes >= (int) iov->iov_len) {
+		nbytes -= iov->iov_len;
+		iov++;
+		iovcnt--;
+	    } else {
+		iov->iov_base = (char *) iov->iov_base + nbytes;
+		iov->iov_len -= nbytes;
+		nbytes = 0;
+	    }
+	}
+    }
+    return (totalRead);
+}
+
+/* allocRecvBuf - get a buffer of at least len bytes from the receive
+ * buffer pool. Falls back to malloc when the pool is busy or len is too
+ * large. The buffer must be given back with freeRecvBuf.
+ */
+static void *
+allocRecvBuf (int len)
+{
+    int i;
+    int freeInx = -1;
+    int fitInx = -1;
+    int size;
+    void *buf = NULL;
+
+    if (len <= RECV_BUF_POOL_MAX_LEN) {
+#ifndef windows_platform
+	pthread_mutex_lock (&RecvBufPoolLock);
+#endif
+	for (i = 0; i < RECV_BUF_POOL_SIZE; i++) {
+	    if (RecvBufPool[i].inUse != 0) continue;
+	    if (RecvBufPool[i].size >= len) {
+		/* the smallest one that fits */
+		if (fitInx < 0 || RecvBufPool[i].size < RecvBufPool[fitInx].size)
+		    fitInx = i;
+	    } else if (freeInx < 0 || RecvBufPool[i].buf == NULL) {
+		freeInx = i;
+	    }
+	}
+	if (fitInx >= 0) {
+	    RecvBufPool[fitInx].inUse = 1;
+	    buf = RecvBufPool[fitInx].buf;
+	    SockCommStat.numBufReuse++;
+	} else if (freeInx >= 0) {
+	    /* grow it in power of 2 so that it can be reused */
+	    for (size = RECV_BUF_MIN_SIZE; size < len; size *= 2);
+	    if (RecvBufPool[freeInx].buf != NULL)
+		free (RecvBufPool[freeInx].buf);
+	    RecvBufPool[freeInx].buf = buf = malloc (size);
+	    if (buf != NULL) {
+		RecvBufPool[freeInx].size = size;
+		RecvBufPool[freeInx].inUse = 1;
+	    } else {
+		RecvBufPool[freeInx].size = 0;
+	    }
+	    SockCommStat.numBufAlloc++;
+	}
+#ifndef windows_platform
+	pthread_mutex_unlock (&RecvBufPoolLock);
+#endif
+	if (fitInx >= 0 || freeInx >= 0) return (buf);
+    }
+    SockCommStat.numBufAlloc++;
+    return (malloc (len));
+}
+
+static void
+freeRecvBuf (void *buf)
+{
+    int i;
+
+    if (buf == NULL) return;
+
+#ifndef windows_platform
+    pthread_mutex_lock (&RecvBufPoolLock);
+#endif
+    for (i = 0; i < RECV_BUF_POOL_SIZE; i++) {
+	if (RecvBufPool[i].buf == buf && RecvBufPool[i].inUse != 0) {
+	    RecvBufPool[i].inUse = 0;
+	    buf = NULL;
+	    break;
+	}
+    }
+#ifndef windows_platform
+    pthread_mutex_unlock (&RecvBufPoolLock);
+#endif
+    /* not from the pool */
+    if (buf != NULL) free (buf);
+}
+
+/* clearRecvBBuf - the clearBBuf of the buffers of readMsgBodyToPool */
 int
-readMsgBody (int sock, msgHeader_t *myHeader, bytesBuf_t *inputStructBBuf, 
+clearRecvBBuf (bytesBuf_t *myBBuf)
+{
+    if (myBBuf == NULL) return (0);
+
+    freeRecvBuf (myBBuf->buf);
+    memset (myBBuf, 0, sizeof (bytesBuf_t));
+    return (0);
+}
+
+/* _readMsgBody - read the msg, error and byte stream parts of a msg with
+ * a single readv in the normal case. poolFlags tells which buffers come
+ * from the receive buffer pool. The byte stream is read directly into
+ * bsBBuf->buf if the caller gave a large enough one.
+ */
+static int
+_readMsgBody (int sock, msgHeader_t *myHeader, bytesBuf_t *inputStructBBuf,
 bytesBuf_t *bsBBuf, bytesBuf_t *errorBBuf, irodsProt_t irodsProt,
-struct timeval *tv)
+struct timeval *tv, int poolFlags)
 {
-    int nbytes;
-    int bytesRead;
+    struct iovec iov[3];
+    int iovcnt = 0;
+    int nbytes, totalLen = 0;
+    int status;
 
     if (myHeader == NULL) {
 	return (SYS_READ_MSG_BODY_INPUT_ERR);
@@ -1256,6 +1675,14 @@ struct timeval *tv)
       return SYS_INVALID_PROTOCOL_TYPE;
     }
 
+    if (myHeader->msgLen < 0 || myHeader->errorLen < 0 ||
+      myHeader->bsLen < 0) {
+	rodsLog (LOG_NOTICE,
+	  "readMsgBody: bad length msgLen %d errorLen %d bsLen %d",
+	  myHeader->msgLen, myHeader->errorLen, myHeader->bsLen);
+	return (SYS_READ_MSG_BODY_LEN_ERR);
+    }
+
     if (inputStructBBuf != NULL)
 	memset (inputStructBBuf, 0, sizeof (bytesBuf_t));
 
@@ -1264,79 +1691,161 @@ struct timeval *tv)
     if (errorBBuf != NULL)
         memset (errorBBuf, 0, sizeof (bytesBuf_t));
 
+    if ((myHeader->msgLen > 0 && inputStructBBuf == NULL) ||
+      (myHeader->errorLen > 0 && errorBBuf == NULL) ||
+      (myHeader->bsLen > 0 && bsBBuf == NULL)) {
+	return (SYS_READ_MSG_BODY_INPUT_ERR);
+    }
+
     if (myHeader->msgLen > 0) {
-        if (inputStructBBuf == NULL) {
-            return (SYS_READ_MSG_BODY_INPUT_ERR);
+	if ((poolFlags & RECV_POOL_MSG) != 0) {
+	    inputStructBBuf->buf = allocRecvBuf (myHeader->msgLen);
+	} else {
+	    inputStructBBuf->buf = malloc (myHeader->msgLen);
+	    SockCommStat.numBufAlloc++;
+	}
+	iov[iovcnt].iov_base = inputStructBBuf->buf;
+	iov[iovcnt++].iov_len = myHeader->msgLen;
+	totalLen += myHeader->msgLen;
+    }
+
+    if (myHeader->errorLen > 0) {
+	if ((poolFlags & RECV_POOL_MSG) != 0) {
+	    errorBBuf->buf = allocRecvBuf (myHeader->errorLen);
+	} else {
+	    errorBBuf->buf = malloc (myHeader->errorLen);
+	    SockCommStat.numBufAlloc++;
+	}
+	iov[iovcnt].iov_base = errorBBuf->buf;
+	iov[iovcnt++].iov_len = myHeader->errorLen;
+	totalLen += myHeader->errorLen;
+    }
+
+    if (myHeader->bsLen > 0) {
+	if (bsBBuf->buf == NULL) {
+	    if ((poolFlags & RECV_POOL_BS) != 0) {
+		bsBBuf->buf = allocRecvBuf (myHeader->bsLen);
+	    } else {
+		bsBBuf->buf = malloc (myHeader->bsLen);
+		SockCommStat.numBufAlloc++;
+	    }
+	} else if (myHeader->bsLen > bsBBuf->len) {
+	    free (bsBBuf->buf);
+            bsBBuf->buf = malloc (myHeader->bsLen);
+	    SockCommStat.numBufAlloc++;
         }
+	iov[iovcnt].iov_base = bsBBuf->buf;
+	iov[iovcnt++].iov_len = myHeader->bsLen;
+	totalLen += myHeader->bsLen;
+    }
+
+    if (totalLen == 0) return (0);
 
-        inputStructBBuf->buf = malloc (myHeader->msgLen);
+    nbytes = myReadv (sock, iov, iovcnt, tv);
 
-        nbytes = myRead (sock, inputStructBBuf->buf, myHeader->msgLen, 
-	  SOCK_TYPE, NULL, tv);
+    if (nbytes != totalLen) {
+	status = SYS_READ_MSG_BODY_LEN_ERR - errno;
+	rodsLog (LOG_NOTICE,
+	  "readMsgBody: read %d bytes, expect %d (msg %d, error %d, bs %d), errno = %d",
+	  nbytes, totalLen, myHeader->msgLen, myHeader->errorLen,
+	  myHeader->bsLen, errno);
+	if (inputStructBBuf != NULL && inputStructBBuf->buf != NULL) {
+	    if ((poolFlags & RECV_POOL_MSG) != 0) {
+		freeRecvBuf (inputStructBBuf->buf);
+	    } else {
+		free (inputStructBBuf->buf);
+	    }
+	    inputStructBBuf->buf = NULL;
+	}
+	if (errorBBuf != NULL && errorBBuf->buf != NULL) {
+	    if ((poolFlags & RECV_POOL_MSG) != 0) {
+		freeRecvBuf (errorBBuf->buf);
+	    } else {
+		free (errorBBuf->buf);
+	    }
+	    errorBBuf->buf = NULL;
+	}
+	if (myHeader->bsLen > 0) {
+	    if ((poolFlags & RECV_POOL_BS) != 0) {
+		freeRecvBuf (bsBBuf->buf);
+	    } else {
+		free (bsBBuf->buf);
+	    }
+	    bsBBuf->buf = NULL;
+	    bsBBuf->len = 0;
+	}
+	return (status);
+    }
 
+    if (myHeader->msgLen > 0) {
+	inputStructBBuf->len = myHeader->msgLen;
         if (irodsProt == XML_PROT && getRodsLogLevel () >= LOG_DEBUG3) {
             printf ("received msg: \n%s\n", (char *) inputStructBBuf->buf);
         }
-
-        if (nbytes != myHeader->msgLen) {
-            rodsLog (LOG_NOTICE, 
-	      "readMsgBody: inputStruct read error, read %d bytes, expect %d",
-               nbytes, myHeader->msgLen);
-            free (inputStructBBuf->buf);
-            return (SYS_HEADER_READ_LEN_ERR);
-	}
-	inputStructBBuf->len = myHeader->msgLen;
     }
- 
     if (myHeader->errorLen > 0) {
-        if (errorBBuf == NULL) {
-            return (SYS_READ_MSG_BODY_INPUT_ERR);
-        }
-
-        errorBBuf->buf = malloc (myHeader->errorLen);
-
-        nbytes = myRead (sock, errorBBuf->buf, myHeader->errorLen,
-	  SOCK_TYPE, NULL, tv);
-
+        errorBBuf->len = myHeader->errorLen;
         if (irodsProt == XML_PROT && getRodsLogLevel () >= LOG_DEBUG3) {
             printf ("received error msg: \n%s\n", (char *) errorBBuf->buf);
         }
-
-        if (nbytes != myHeader->errorLen) {
-            rodsLog (LOG_NOTICE,
-              "readMsgBody: errorBbuf read error, read %d bytes, expect %d, errno = %d",
-             nbytes, myHeader->msgLen, errno);
-            free (errorBBuf->buf);
-            return (SYS_READ_MSG_BODY_LEN_ERR - errno);
-        }
-        errorBBuf->len = myHeader->errorLen;
     }
-
     if (myHeader->bsLen > 0) {
-        if (bsBBuf == NULL) {
-            return (SYS_READ_MSG_BODY_INPUT_ERR);
-        }
+	bsBBuf->len = myHeader->bsLen;
+    }
+    SockCommStat.numMsgRecv++;
 
-	if (bsBBuf->buf == NULL) {
-            bsBBuf->buf = malloc (myHeader->bsLen);
-	} else if (myHeader->bsLen > bsBBuf->len) {
-	    free (bsBBuf->buf);
-            bsBBuf->buf = malloc (myHeader->bsLen);
-        }
+    return (0);
+}
 
-        nbytes = myRead (sock, bsBBuf->buf, myHeader->bsLen, SOCK_TYPE,
-	  &bytesRead, tv);
+int
+readMsgBody (int sock, msgHeader_t *myHeader, bytesBuf_t *inputStructBBuf,
+bytesBuf_t *bsBBuf, bytesBuf_t *errorBBuf, irodsProt_t irodsProt,
+struct timeval *tv)
+{
+    return (_readMsgBody (sock, myHeader, inputStructBBuf, bsBBuf, errorBBuf,
+      irodsProt, tv, 0));
+}
 
-        if (nbytes != myHeader->bsLen) {
-            rodsLog (LOG_NOTICE, 
-	      "readMsgBody: bsBBuf read error, read %d bytes, expect %d, errno = %d",
-             nbytes, myHeader->bsLen, errno);
-            free (bsBBuf->buf);
-            return (SYS_READ_MSG_BODY_INPUT_ERR - errno);
-        }
-	bsBBuf->len = myHeader->bsLen;
-    }
+/* readMsgBodyToPool - same as readMsgBody, but the buffers given by
+ * poolFlags (RECV_POOL_MSG for the msg and error, RECV_POOL_BS for a
+ * byte stream buffer allocated here) come from a pool of receive buffers.
+ * They must be freed with clearRecvBBuf instead of clearBBuf. Used by the
+ * request/reply loops of the client and the agent.
+ */
+int
+readMsgBodyToPool (int sock, msgHeader_t *myHeader,
+bytesBuf_t *inputStructBBuf, bytesBuf_t *bsBBuf, bytesBuf_t *errorBBuf,
+irodsProt_t irodsProt, struct timeval *tv, int poolFlags)
+{
+    return (_readMsgBody (sock, myHeader, inputStructBBuf, bsBBuf, errorBBuf,
+      irodsProt, tv, poolFlags));
+}
+
+int
+getSockCommStat (sockCommStat_t *outStat)
+{
+    if (outStat == NULL) return (USER__NULL_INPUT_ERR);
 
+    *outStat = SockCommStat;
+    return (0);
+}
+
+/* logSockCommStat - log the syscalls and buffer allocations per msg */
+int
+logSockCommStat (char *caller)
+{
+    sockCommStat_t *st = &SockCommStat;
+
+    if (st->numMsgSent <= 0 && st->numMsgRecv <= 0) return (0);
+
+    rodsLog (LOG_DEBUG,
+      "%s: %lld msgs sent with %.2f write calls/msg, %lld received with %.2f read calls/msg, %.2f buffer allocs/msg, %lld pooled buffers reused",
+      caller, st->numMsgSent,
+      st->numMsgSent > 0 ? (double) st->numWriteCalls / st->numMsgSent : 0.0,
+      st->numMsgRecv,
+      st->numMsgRecv > 0 ? (double) st->numReadCalls / st->numMsgRecv : 0.0,
+      st->numMsgRecv > 0 ? (double) st->numBufAlloc / st->numMsgRecv : 0.0,
+      st->numBufReuse);
     return (0);
 }
 
@@ -13,6 +13,15 @@
 #define fflush(A) irodsfflush(A)
 #define fputc(A, B) irodsfputc(A,B)
 #define fgetc(A) irodsfgetc(A)
+#define ftell(A) irodsftell(A)
+#define fseeko(A,B,C) irodsfseeko(A,B,C)
+#define ftello(A) irodsftello(A)
 #include <stdio.h>
+#include <sys/types.h>
+
+/* like pread(2) on a stream: read count bytes at offset without
+   moving the position of the stream */
+ssize_t irodspread(FILE *fi_stream, void *buffer, size_t count,
+		   off_t offset);
 
 #endif /* IRODS_IO_H */
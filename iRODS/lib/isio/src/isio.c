@@ -12,6 +12,21 @@
    Like the fopen family, this library does some caching to avoid
    small I/O (network) calls, greatly improving performance.
 
+   Offsets are 64 bits (irodsfseeko, irodsftello) so files larger
+   than 2 GB can be positioned in.  Seeks are lazy: the position is
+   kept here and sent to the server with the next read or write
+   that needs it.  Full write buffers are sent by a background
+   thread of the stream (write-behind) while the application fills
+   the next one; an error of a background write is returned by the
+   next fflush, fclose or write of the stream.  Once a read-only
+   stream is read sequentially, ISIO_DEF_READ_THREADS threads with
+   their own connections (opened one at a time by the reading thread)
+   fetch the next ISIO_READ_AHEAD_SIZE ranges in parallel
+   (read-ahead).  The number of threads can be set with
+   the isioReadThreads environment variable (0 turns read-ahead
+   off) and isioWriteBehind=0 turns write-behind off.
+   irodspread reads at an offset without moving the stream position.
+
    The user callable functions are defined in the isio.h and are of
    the form irodsNAME, such as irodsfopen.  Internal function names
    begin with 'isio'.
@@ -28,9 +43,10 @@
 #include <stdio.h>
 #include "rodsClient.h"
 #include "dataObjRead.h"
+#include <pthread.h>
 
 #define IRODS_PREFIX "irods:"
-#define ISIO_MAX_OPEN_FILES 20
+#define ISIO_MAX_OPEN_FILES 256
 #define ISIO_MIN_OPEN_FD 5
 
 /* The following two numberic values are also used by the
@@ -38,10 +54,66 @@
 #define ISIO_INITIAL_BUF_SIZE  65536
 #define ISIO_MAX_BUF_SIZE    2097152
 
+/* read-ahead of read-only streams */
+#define ISIO_READ_THREADS_ENV	"isioReadThreads"
+#define ISIO_DEF_READ_THREADS	2
+#define ISIO_MAX_READ_THREADS	16
+#define ISIO_READ_AHEAD_SIZE	(4*1024*1024)	/* size of one fetch */
+#define ISIO_SEQ_READS_FOR_AHEAD 2	/* sequential fills to start it */
+#define ISIO_WRITE_BEHIND_ENV	"isioWriteBehind"
+
+/* state of a read-ahead slot */
+#define ISIO_SLOT_FREE	0
+#define ISIO_SLOT_BUSY	1	/* being fetched */
+#define ISIO_SLOT_FULL	2
+
+typedef struct isioSlot {
+   rodsLong_t offset;
+   int len;		/* bytes in buf or the error of the fetch */
+   int state;
+   char *buf;
+} isioSlot_t;
+
+/* the connection of a read-ahead thread, opened by the caller */
+typedef struct isioAheadConn {
+   struct isioAhead *ahead;
+   rcComm_t *conn;
+   int l1descInx;
+} isioAheadConn_t;
+
+typedef struct isioAhead {
+   pthread_mutex_t lock;
+   pthread_cond_t cond;
+   int numThreads;
+   int numAlive;	/* threads still fetching */
+   pthread_t *threads;
+   isioAheadConn_t *conns;	/* one per thread */
+   int numSlots;
+   isioSlot_t *slots;
+   rodsLong_t fileSize;
+   rodsLong_t readPos;	/* where the application reads */
+   rodsLong_t nextFetch;	/* the next range to fetch */
+   int stop;
+   char objPath[MAX_NAME_LEN];
+} isioAhead_t;
+
+typedef struct isioBehind {
+   pthread_t thread;
+   pthread_mutex_t lock;
+   pthread_cond_t cond;
+   int fileIndex;
+   char *buf;		/* being written, or done and free for reuse */
+   int bufSize;
+   int len;
+   rodsLong_t offset;
+   int busy;
+   int status;		/* error of a write, kept until reported */
+   int stop;
+} isioBehind_t;
+
 int debug=0;
 
-long openFiles[ISIO_MAX_OPEN_FILES]={0,0,0,0,0,0,0,0,0,0,
-				     0,0,0,0,0,0,0,0,0,0};
+long openFiles[ISIO_MAX_OPEN_FILES];
 
 struct {
    FILE *fd;
@@ -51,15 +123,51 @@ struct {
    int count;
    char usingUsersBuffer; /* y or n when active */
    int written; /* contains count of bytes written */
+   rodsLong_t pos;	/* offset of the next fill or flush */
+   rodsLong_t srvOffset;	/* offset of the descriptor in the server */
+   rodsLong_t lastFillEnd;	/* to detect sequential reads */
+   int seqReads;
+   int openFlags;
+   char objPath[MAX_NAME_LEN];
+   isioAhead_t *ahead;
+   int aheadFailed;
+   isioBehind_t *behind;
 } cacheInfo[ISIO_MAX_OPEN_FILES];
 
 
 
-static setupFlag=0;
+static int setupFlag=0;
 char localZone[100]="";
 rcComm_t *Comm;
 rodsEnv myRodsEnv;
 
+/* serializes the use of Comm by the application and the write-behind
+ * threads */
+static pthread_mutex_t CommLock = PTHREAD_MUTEX_INITIALIZER;
+
+int isioFlush(int fileIndex);
+int isioFileSeek(int fileIndex, rodsLong_t offset, int whence);
+
+/* isioIndex - the index in openFiles of an isio stream, or -1 for a
+   regular FILE */
+static int
+isioIndex(FILE *fi_stream) {
+   long i;
+   i = (long)fi_stream;
+   if (i<ISIO_MAX_OPEN_FILES && i>=ISIO_MIN_OPEN_FD && openFiles[i]>0) {
+      return((int)i);
+   }
+   return(-1);
+}
+
+static int
+isioGetEnvInt(char *name, int defValue) {
+   char *value;
+   value = getenv(name);
+   if (value==NULL || *value=='\0') return(defValue);
+   return(atoi(value));
+}
+
 int
 isioSetup() {
    int status;
@@ -73,7 +181,7 @@ isioSetup() {
    if (status < 0) {
       rodsLogError(LOG_ERROR, status, "isioSetup: getRodsEnv error.");
    }
-   Comm = rcConnect (myRodsEnv.rodsHost, myRodsEnv.rodsPort, 
+   Comm = rcConnect (myRodsEnv.rodsHost, myRodsEnv.rodsPort,
 		     myRodsEnv.rodsUserName,
                      myRodsEnv.rodsZone, 0, &errMsg);
 
@@ -135,12 +243,14 @@ FILE *isioFileOpen(char *filename, char *modes) {
       dataObjInp.openFlags = O_RDWR;
    }
 
+   pthread_mutex_lock(&CommLock);
    status = rcDataObjOpen (Comm, &dataObjInp);
 
    if (status==CAT_NO_ROWS_FOUND &&
        dataObjInp.openFlags == O_WRONLY) {
       status = rcDataObjCreate(Comm, &dataObjInp);
    }
+   pthread_mutex_unlock(&CommLock);
    if (status < 0) {
       rodsLogError (LOG_ERROR, status, "isioFileOpen");
       return(NULL);
@@ -156,7 +266,16 @@ FILE *isioFileOpen(char *filename, char *modes) {
    cacheInfo[i].count = 0;
    cacheInfo[i].usingUsersBuffer = 'n';
    cacheInfo[i].written = 0;
-   return((FILE *)i);
+   cacheInfo[i].pos = 0;
+   cacheInfo[i].srvOffset = 0;
+   cacheInfo[i].lastFillEnd = -1;
+   cacheInfo[i].seqReads = 0;
+   cacheInfo[i].openFlags = dataObjInp.openFlags;
+   rstrcpy(cacheInfo[i].objPath, dataObjInp.objPath, MAX_NAME_LEN);
+   cacheInfo[i].ahead = NULL;
+   cacheInfo[i].aheadFailed = 0;
+   cacheInfo[i].behind = NULL;
+   return((FILE *)(long)i);
 }
 
 FILE *irodsfopen(char *filename, char *modes) {
@@ -174,29 +293,626 @@ FILE *irodsfopen(char *filename, char *modes) {
    }
 }
 
+/* isioSeekSrv - move the descriptor of the stream in the server to
+   offset if a lazy seek or a positional read left it elsewhere.
+   CommLock must be held. */
+static int
+isioSeekSrv(int fileIndex, rodsLong_t offset) {
+   openedDataObjInp_t seekParam;
+   fileLseekOut_t* seekResult = NULL;
+   int status;
+
+   if (cacheInfo[fileIndex].srvOffset == offset) return(0);
+
+   memset( &seekParam,  0, sizeof(openedDataObjInp_t) );
+   seekParam.l1descInx = openFiles[fileIndex];
+   seekParam.offset  = offset;
+   seekParam.whence  = SEEK_SET;
+   status = rcDataObjLseek(Comm, &seekParam, &seekResult );
+   if (seekResult != NULL) free(seekResult);
+   if ( status < 0 ) {
+      rodsLogError (LOG_ERROR, status, "isioSeekSrv");
+      cacheInfo[fileIndex].srvOffset = -1;
+      return(status);
+   }
+   cacheInfo[fileIndex].srvOffset = offset;
+   return(0);
+}
+
+/* isioRemoteRead - read len bytes at offset with the stream's
+   descriptor */
+static int
+isioRemoteRead(int fileIndex, char *buf, int len, rodsLong_t offset) {
+   int status;
+   openedDataObjInp_t dataObjReadInp;
+   bytesBuf_t dataObjReadOutBBuf;
+
+   dataObjReadOutBBuf.buf = buf;
+   dataObjReadOutBBuf.len = len;
+
+   memset(&dataObjReadInp, 0, sizeof (dataObjReadInp));
+
+   dataObjReadInp.l1descInx = openFiles[fileIndex];
+   dataObjReadInp.len = len;
+
+   pthread_mutex_lock(&CommLock);
+   status = isioSeekSrv(fileIndex, offset);
+   if (status >= 0) {
+      status = rcDataObjRead (Comm, &dataObjReadInp,
+			      &dataObjReadOutBBuf);
+      if (status >= 0) {
+	 cacheInfo[fileIndex].srvOffset = offset + status;
+      }
+      else {
+	 cacheInfo[fileIndex].srvOffset = -1;
+      }
+   }
+   pthread_mutex_unlock(&CommLock);
+   return(status);
+}
+
+/* isioRemoteWrite - write len bytes at offset with the stream's
+   descriptor.  Also called by the write-behind thread. */
+static int
+isioRemoteWrite(int fileIndex, char *buf, int len, rodsLong_t offset) {
+   int status;
+   openedDataObjInp_t dataObjWriteInp;
+   bytesBuf_t dataObjWriteOutBBuf;
+
+   dataObjWriteOutBBuf.buf = buf;
+   dataObjWriteOutBBuf.len = len;
+
+   memset(&dataObjWriteInp, 0, sizeof (dataObjWriteInp));
+
+   dataObjWriteInp.l1descInx = openFiles[fileIndex];
+   dataObjWriteInp.len = len;
+
+   pthread_mutex_lock(&CommLock);
+   status = isioSeekSrv(fileIndex, offset);
+   if (status >= 0) {
+      status = rcDataObjWrite (Comm, &dataObjWriteInp,
+			       &dataObjWriteOutBBuf);
+      if (status >= 0) {
+	 cacheInfo[fileIndex].srvOffset = offset + status;
+	 if (status != len) status = SYS_COPY_LEN_ERR;
+      }
+      else {
+	 cacheInfo[fileIndex].srvOffset = -1;
+      }
+   }
+   pthread_mutex_unlock(&CommLock);
+   return(status);
+}
+
+/* Write-behind */
+
+static void *
+isioBehindWorker(void *arg) {
+   isioBehind_t *behind;
+   int status;
+
+   behind = (isioBehind_t *)arg;
+   pthread_mutex_lock(&behind->lock);
+   while (1) {
+      while (behind->busy==0 && behind->stop==0) {
+	 pthread_cond_wait(&behind->cond, &behind->lock);
+      }
+      if (behind->busy==0) break;
+      pthread_mutex_unlock(&behind->lock);
+
+      if (debug) printf("isioBehindWorker: writing %d\n", behind->len);
+      status = isioRemoteWrite(behind->fileIndex, behind->buf, behind->len,
+			       behind->offset);
+
+      pthread_mutex_lock(&behind->lock);
+      if (status < 0 && behind->status >= 0) behind->status = status;
+      behind->busy = 0;
+      pthread_cond_broadcast(&behind->cond);
+   }
+   pthread_mutex_unlock(&behind->lock);
+   return(NULL);
+}
+
+/* isioBehindStart - start the write-behind thread of a stream opened
+   for writing.  Returns NULL if write-behind is off or fails. */
+static isioBehind_t *
+isioBehindStart(int fileIndex) {
+   isioBehind_t *behind;
+
+   if (cacheInfo[fileIndex].openFlags == O_RDONLY) return(NULL);
+   if (isioGetEnvInt(ISIO_WRITE_BEHIND_ENV, 1) == 0) return(NULL);
+
+   behind = (isioBehind_t *)calloc(1, sizeof(isioBehind_t));
+   if (behind==NULL) return(NULL);
+   behind->fileIndex = fileIndex;
+   pthread_mutex_init(&behind->lock, NULL);
+   pthread_cond_init(&behind->cond, NULL);
+   if (pthread_create(&behind->thread, NULL, isioBehindWorker,
+		      (void *)behind) != 0) {
+      rodsLog(LOG_NOTICE, "isioBehindStart: pthread_create failed, errno=%d",
+	      errno);
+      pthread_mutex_destroy(&behind->lock);
+      pthread_cond_destroy(&behind->cond);
+      free(behind);
+      return(NULL);
+   }
+   return(behind);
+}
+
+/* isioBehindWait - wait for the pending write of the stream and return
+   the error of a background write not reported yet */
+static int
+isioBehindWait(int fileIndex) {
+   isioBehind_t *behind;
+   int status;
+
+   behind = cacheInfo[fileIndex].behind;
+   if (behind==NULL) return(0);
+   pthread_mutex_lock(&behind->lock);
+   while (behind->busy) {
+      pthread_cond_wait(&behind->cond, &behind->lock);
+   }
+   status = behind->status;
+   behind->status = 0;
+   pthread_mutex_unlock(&behind->lock);
+   return(status);
+}
+
+static int
+isioBehindStop(int fileIndex) {
+   isioBehind_t *behind;
+   int status;
+
+   behind = cacheInfo[fileIndex].behind;
+   if (behind==NULL) return(0);
+   status = isioBehindWait(fileIndex);
+   pthread_mutex_lock(&behind->lock);
+   behind->stop = 1;
+   pthread_cond_broadcast(&behind->cond);
+   pthread_mutex_unlock(&behind->lock);
+   pthread_join(behind->thread, NULL);
+   pthread_mutex_destroy(&behind->lock);
+   pthread_cond_destroy(&behind->cond);
+   if (behind->buf != NULL) free(behind->buf);
+   free(behind);
+   cacheInfo[fileIndex].behind = NULL;
+   return(status);
+}
+
+/* isioBehindWrite - hand the written part of the stream's buffer to
+   the write-behind thread and take its previous buffer for the next
+   writes */
+static int
+isioBehindWrite(int fileIndex) {
+   isioBehind_t *behind;
+   char *newBase;
+   int status;
+   int i;
+
+   i = fileIndex;
+   behind = cacheInfo[i].behind;
+   status = isioBehindWait(i);
+   if (status < 0) return(status);
+
+   newBase = behind->buf;
+   if (newBase==NULL || behind->bufSize < cacheInfo[i].bufferSize) {
+      if (newBase != NULL) free(newBase);
+      newBase = (char *)malloc(cacheInfo[i].bufferSize);
+      if (newBase==NULL) {
+	 behind->buf = NULL;
+	 fprintf(stderr,"Memory Allocation error\n");
+	 return(SYS_MALLOC_ERR);
+      }
+   }
+
+   pthread_mutex_lock(&behind->lock);
+   behind->buf = cacheInfo[i].base;
+   behind->bufSize = cacheInfo[i].bufferSize;
+   behind->len = cacheInfo[i].written;
+   behind->offset = cacheInfo[i].pos;
+   behind->busy = 1;
+   pthread_cond_broadcast(&behind->cond);
+   pthread_mutex_unlock(&behind->lock);
+
+   cacheInfo[i].base = newBase;
+   return(0);
+}
+
+/* Read-ahead */
+
+/* isioAheadConnect - connect, login and open the object for one
+   read-ahead thread.  Called on the caller's thread, one connection at
+   a time, since rcConnect and clientLogin are not safe to run
+   concurrently. */
+static int
+isioAheadConnect(isioAhead_t *ahead, isioAheadConn_t *aheadConn) {
+   rErrMsg_t errMsg;
+   dataObjInp_t dataObjInp;
+   int status;
+
+   aheadConn->ahead = ahead;
+   aheadConn->l1descInx = -1;
+   memset (&errMsg, 0, sizeof (errMsg));
+   aheadConn->conn = rcConnect (myRodsEnv.rodsHost, myRodsEnv.rodsPort,
+				myRodsEnv.rodsUserName,
+				myRodsEnv.rodsZone, 0, &errMsg);
+   if (aheadConn->conn == NULL) {
+      return(errMsg.status < 0 ? errMsg.status : USER_SOCK_CONNECT_ERR);
+   }
+
+   status = clientLogin(aheadConn->conn);
+   if (status == 0) {
+      memset (&dataObjInp, 0, sizeof (dataObjInp));
+      rstrcpy(dataObjInp.objPath, ahead->objPath, MAX_NAME_LEN);
+      dataObjInp.openFlags = O_RDONLY;
+      status = rcDataObjOpen (aheadConn->conn, &dataObjInp);
+   }
+   if (status < 0) {
+      rcDisconnect(aheadConn->conn);
+      aheadConn->conn = NULL;
+      return(status);
+   }
+   aheadConn->l1descInx = status;
+   return(0);
+}
+
+static void
+isioAheadDisconnect(isioAheadConn_t *aheadConn) {
+   openedDataObjInp_t dataObjCloseInp;
+
+   if (aheadConn->conn == NULL) return;
+   memset (&dataObjCloseInp, 0, sizeof (dataObjCloseInp));
+   dataObjCloseInp.l1descInx = aheadConn->l1descInx;
+   rcDataObjClose(aheadConn->conn, &dataObjCloseInp);
+   rcDisconnect(aheadConn->conn);
+   aheadConn->conn = NULL;
+}
+
+static void *
+isioAheadWorker(void *arg) {
+   isioAheadConn_t *aheadConn;
+   isioAhead_t *ahead;
+   rcComm_t *conn;
+   openedDataObjInp_t dataObjReadInp;
+   openedDataObjInp_t seekParam;
+   fileLseekOut_t* seekResult;
+   bytesBuf_t dataObjReadOutBBuf;
+   isioSlot_t *slot;
+   rodsLong_t descOffset = 0;
+   int l1descInx;
+   int status, i;
+
+   aheadConn = (isioAheadConn_t *)arg;
+   ahead = aheadConn->ahead;
+   conn = aheadConn->conn;
+   l1descInx = aheadConn->l1descInx;
+
+   pthread_mutex_lock(&ahead->lock);
+   while (ahead->stop==0) {
+      /* take a free slot, or a full one out of the window of the
+	 application, for the next range */
+      slot = NULL;
+      if (ahead->nextFetch < ahead->fileSize) {
+	 for (i=0;i<ahead->numSlots;i++) {
+	    if (ahead->slots[i].state == ISIO_SLOT_FREE ||
+		(ahead->slots[i].state == ISIO_SLOT_FULL &&
+		 (ahead->slots[i].offset >= ahead->nextFetch ||
+		  ahead->slots[i].offset + ahead->slots[i].len <=
+		  ahead->readPos))) {
+	       slot = &ahead->slots[i];
+	       break;
+	    }
+	 }
+      }
+      if (slot==NULL) {
+	 pthread_cond_wait(&ahead->cond, &ahead->lock);
+	 continue;
+      }
+      slot->state = ISIO_SLOT_BUSY;
+      slot->offset = ahead->nextFetch;
+      slot->len = ISIO_READ_AHEAD_SIZE;
+      if (ahead->fileSize - slot->offset < slot->len) {
+	 slot->len = ahead->fileSize - slot->offset;
+      }
+      ahead->nextFetch += slot->len;
+      pthread_mutex_unlock(&ahead->lock);
+
+      status = 0;
+      if (descOffset != slot->offset) {
+	 memset( &seekParam,  0, sizeof(openedDataObjInp_t) );
+	 seekParam.l1descInx = l1descInx;
+	 seekParam.offset  = slot->offset;
+	 seekParam.whence  = SEEK_SET;
+	 seekResult = NULL;
+	 status = rcDataObjLseek(conn, &seekParam, &seekResult );
+	 if (seekResult != NULL) free(seekResult);
+      }
+      if (status >= 0) {
+	 dataObjReadOutBBuf.buf = slot->buf;
+	 dataObjReadOutBBuf.len = slot->len;
+	 memset(&dataObjReadInp, 0, sizeof (dataObjReadInp));
+	 dataObjReadInp.l1descInx = l1descInx;
+	 dataObjReadInp.len = slot->len;
+	 status = rcDataObjRead (conn, &dataObjReadInp,
+				 &dataObjReadOutBBuf);
+      }
+      if (debug) printf("isioAheadWorker: fetched %lld stat: %d\n",
+			slot->offset, status);
+      if (status >= 0) {
+	 descOffset = slot->offset + status;
+      }
+      else {
+	 descOffset = -1;
+      }
+
+      pthread_mutex_lock(&ahead->lock);
+      slot->len = status;
+      slot->state = ISIO_SLOT_FULL;
+      pthread_cond_broadcast(&ahead->cond);
+   }
+   ahead->numAlive--;
+   pthread_cond_broadcast(&ahead->cond);
+   pthread_mutex_unlock(&ahead->lock);
+
+   isioAheadDisconnect(aheadConn);
+   return(NULL);
+}
+
+static int
+isioAheadStop(int fileIndex) {
+   isioAhead_t *ahead;
+   int i;
+
+   ahead = cacheInfo[fileIndex].ahead;
+   if (ahead==NULL) return(0);
+
+   pthread_mutex_lock(&ahead->lock);
+   ahead->stop = 1;
+   pthread_cond_broadcast(&ahead->cond);
+   pthread_mutex_unlock(&ahead->lock);
+   for (i=0;i<ahead->numThreads;i++) {
+      pthread_join(ahead->threads[i], NULL);
+   }
+   for (i=0;i<ahead->numSlots;i++) {
+      if (ahead->slots[i].buf != NULL) free(ahead->slots[i].buf);
+   }
+   pthread_mutex_destroy(&ahead->lock);
+   pthread_cond_destroy(&ahead->cond);
+   free(ahead->slots);
+   free(ahead->threads);
+   free(ahead->conns);
+   free(ahead);
+   cacheInfo[fileIndex].ahead = NULL;
+   return(0);
+}
+
+/* isioAheadStart - start the read-ahead threads of a read-only stream.
+   The ranges are fetched up to the size of the object at this time. */
+static int
+isioAheadStart(int fileIndex) {
+   isioAhead_t *ahead;
+   dataObjInp_t dataObjInp;
+   rodsObjStat_t *rodsObjStatOut = NULL;
+   int numThreads, numConns;
+   int status, i;
+
+   numThreads = isioGetEnvInt(ISIO_READ_THREADS_ENV, ISIO_DEF_READ_THREADS);
+   if (numThreads <= 0) return(SYS_INVALID_INPUT_PARAM);
+   if (numThreads > ISIO_MAX_READ_THREADS) numThreads = ISIO_MAX_READ_THREADS;
+
+   memset (&dataObjInp, 0, sizeof (dataObjInp));
+   rstrcpy(dataObjInp.objPath, cacheInfo[fileIndex].objPath, MAX_NAME_LEN);
+   pthread_mutex_lock(&CommLock);
+   status = rcObjStat(Comm, &dataObjInp, &rodsObjStatOut);
+   pthread_mutex_unlock(&CommLock);
+   if (status < 0) return(status);
+
+   ahead = (isioAhead_t *)calloc(1, sizeof(isioAhead_t));
+   if (ahead==NULL) {
+      freeRodsObjStat(rodsObjStatOut);
+      return(SYS_MALLOC_ERR);
+   }
+   ahead->fileSize = rodsObjStatOut->objSize;
+   freeRodsObjStat(rodsObjStatOut);
+   rstrcpy(ahead->objPath, cacheInfo[fileIndex].objPath, MAX_NAME_LEN);
+   ahead->readPos = cacheInfo[fileIndex].pos;
+   ahead->nextFetch = cacheInfo[fileIndex].pos;
+   ahead->numSlots = 2 * numThreads;
+   ahead->slots = (isioSlot_t *)calloc(ahead->numSlots, sizeof(isioSlot_t));
+   ahead->threads = (pthread_t *)calloc(numThreads, sizeof(pthread_t));
+   ahead->conns = (isioAheadConn_t *)calloc(numThreads,
+					    sizeof(isioAheadConn_t));
+   if (ahead->slots==NULL || ahead->threads==NULL || ahead->conns==NULL) {
+      if (ahead->slots != NULL) free(ahead->slots);
+      if (ahead->threads != NULL) free(ahead->threads);
+      if (ahead->conns != NULL) free(ahead->conns);
+      free(ahead);
+      return(SYS_MALLOC_ERR);
+   }
+   for (i=0;i<ahead->numSlots;i++) {
+      ahead->slots[i].buf = (char *)malloc(ISIO_READ_AHEAD_SIZE);
+      if (ahead->slots[i].buf==NULL) {
+	 /* fewer slots */
+	 ahead->numSlots = i;
+	 break;
+      }
+   }
+   pthread_mutex_init(&ahead->lock, NULL);
+   pthread_cond_init(&ahead->cond, NULL);
+   cacheInfo[fileIndex].ahead = ahead;
+
+   if (ahead->numSlots < 2) {
+      isioAheadStop(fileIndex);
+      return(SYS_MALLOC_ERR);
+   }
+
+   /* the connections are made here one at a time, not by the threads */
+   for (numConns=0;numConns<numThreads;numConns++) {
+      status = isioAheadConnect(ahead, &ahead->conns[numConns]);
+      if (status < 0) {
+	 rodsLog(LOG_NOTICE, "isioAheadStart: cannot open %s, status=%d",
+		 ahead->objPath, status);
+	 break;
+      }
+   }
+
+   pthread_mutex_lock(&ahead->lock);
+   for (i=0;i<numConns;i++) {
+      if (pthread_create(&ahead->threads[i], NULL, isioAheadWorker,
+			 (void *)&ahead->conns[i]) != 0) {
+	 rodsLog(LOG_NOTICE,
+		 "isioAheadStart: pthread_create failed, errno=%d", errno);
+	 break;
+      }
+      ahead->numThreads++;
+      ahead->numAlive++;
+   }
+   pthread_mutex_unlock(&ahead->lock);
+   for (;i<numConns;i++) {
+      isioAheadDisconnect(&ahead->conns[i]);
+   }
+   if (ahead->numThreads == 0) {
+      isioAheadStop(fileIndex);
+      return(SYS_NOT_SUPPORTED);
+   }
+   if (debug) printf("isioAheadStart: %d threads, size %lld\n",
+		     ahead->numThreads, ahead->fileSize);
+   return(0);
+}
+
+/* isioAheadRead - copy up to len bytes at offset from the read-ahead
+   slots, waiting for the fetch of the range if needed.  Returns 0 at
+   the end of the object and SYS_NOT_SUPPORTED if no thread is
+   left to fetch. */
+static int
+isioAheadRead(isioAhead_t *ahead, char *buf, int len, rodsLong_t offset) {
+   isioSlot_t *slot;
+   int toMove;
+   int status, i;
+
+   pthread_mutex_lock(&ahead->lock);
+   while (1) {
+      slot = NULL;
+      for (i=0;i<ahead->numSlots;i++) {
+	 if (ahead->slots[i].state == ISIO_SLOT_BUSY &&
+	     offset >= ahead->slots[i].offset &&
+	     offset < ahead->slots[i].offset + ahead->slots[i].len) {
+	    slot = &ahead->slots[i];
+	    break;
+	 }
+	 /* a failed or empty fetch matches its whole range */
+	 if (ahead->slots[i].state == ISIO_SLOT_FULL &&
+	     offset >= ahead->slots[i].offset &&
+	     (offset < ahead->slots[i].offset + ahead->slots[i].len ||
+	      (ahead->slots[i].len <= 0 &&
+	       offset < ahead->slots[i].offset + ISIO_READ_AHEAD_SIZE))) {
+	    slot = &ahead->slots[i];
+	    break;
+	 }
+      }
+      if (slot==NULL) {
+	 if (offset >= ahead->fileSize) {
+	    status = 0;
+	    break;
+	 }
+	 if (ahead->numAlive <= 0) {
+	    status = SYS_NOT_SUPPORTED;
+	    break;
+	 }
+	 /* a seek or a short fetch: restart the window here */
+	 ahead->readPos = offset;
+	 ahead->nextFetch = offset;
+	 pthread_cond_broadcast(&ahead->cond);
+	 pthread_cond_wait(&ahead->cond, &ahead->lock);
+	 continue;
+      }
+      if (slot->state == ISIO_SLOT_BUSY) {
+	 pthread_cond_wait(&ahead->cond, &ahead->lock);
+	 continue;
+      }
+      if (slot->len <= 0) {
+	 /* report the end or the failed fetch once and refetch on the
+	    next call */
+	 status = slot->len;
+	 slot->state = ISIO_SLOT_FREE;
+	 if (ahead->nextFetch > slot->offset) ahead->nextFetch = slot->offset;
+	 pthread_cond_broadcast(&ahead->cond);
+	 break;
+      }
+      toMove = slot->offset + slot->len - offset;
+      if (toMove > len) toMove = len;
+      memcpy(buf, slot->buf + (offset - slot->offset), toMove);
+      ahead->readPos = offset + toMove;
+      if (ahead->readPos >= slot->offset + slot->len) {
+	 slot->state = ISIO_SLOT_FREE;
+	 pthread_cond_broadcast(&ahead->cond);
+      }
+      status = toMove;
+      break;
+   }
+   pthread_mutex_unlock(&ahead->lock);
+   return(status);
+}
+
+/* isioReadAt - read len bytes at offset, from the read-ahead when the
+   stream has one.  Like fread, returns less than len only at the end
+   of the object. */
+static int
+isioReadAt(int fileIndex, char *buf, int len, rodsLong_t offset) {
+   int status;
+   int total = 0;
+
+   if (cacheInfo[fileIndex].ahead == NULL) {
+      return(isioRemoteRead(fileIndex, buf, len, offset));
+   }
+   while (total < len) {
+      status = isioAheadRead(cacheInfo[fileIndex].ahead, buf + total,
+			     len - total, offset + total);
+      if (status == SYS_NOT_SUPPORTED) {
+	 /* the read-ahead connections are gone, read it directly */
+	 isioAheadStop(fileIndex);
+	 cacheInfo[fileIndex].aheadFailed = 1;
+	 status = isioRemoteRead(fileIndex, buf + total, len - total,
+				 offset + total);
+	 if (status < 0) return(status);
+	 return(total + status);
+      }
+      if (status < 0) return(status);
+      if (status == 0) break;
+      total += status;
+   }
+   return(total);
+}
+
 int
 isioFillBuffer(int fileIndex) {
    int status, i;
-   openedDataObjInp_t dataObjReadInp;
-   bytesBuf_t dataObjReadOutBBuf;
 
    if (debug) printf("isioFillBuffer: %d\n", fileIndex);
 
    i = fileIndex;
-   dataObjReadOutBBuf.buf = cacheInfo[i].base;
-   dataObjReadOutBBuf.len = cacheInfo[i].bufferSize;
-
-   memset(&dataObjReadInp, 0, sizeof (dataObjReadInp));
 
-   dataObjReadInp.l1descInx = openFiles[fileIndex];
-   dataObjReadInp.len = cacheInfo[i].bufferSize;
+   /* start the read-ahead once the stream is read sequentially */
+   if (cacheInfo[i].lastFillEnd == cacheInfo[i].pos) {
+      cacheInfo[i].seqReads++;
+   }
+   else {
+      cacheInfo[i].seqReads = 0;
+   }
+   if (cacheInfo[i].ahead == NULL && cacheInfo[i].aheadFailed == 0 &&
+       cacheInfo[i].openFlags == O_RDONLY &&
+       cacheInfo[i].seqReads >= ISIO_SEQ_READS_FOR_AHEAD) {
+      if (isioAheadStart(i) < 0) cacheInfo[i].aheadFailed = 1;
+   }
 
-   status = rcDataObjRead (Comm, &dataObjReadInp,
-			   &dataObjReadOutBBuf);
+   status = isioReadAt(i, cacheInfo[i].base, cacheInfo[i].bufferSize,
+		       cacheInfo[i].pos);
 
-   if (debug) printf("isioFillBuffer rcDataObjRead stat: %d\n", status);
+   if (debug) printf("isioFillBuffer read stat: %d\n", status);
    if (status < 0) return(status);
 
+   cacheInfo[i].pos += status;
+   cacheInfo[i].lastFillEnd = cacheInfo[i].pos;
    cacheInfo[i].ptr = cacheInfo[i].base;
    cacheInfo[i].count = status;
 
@@ -208,8 +924,6 @@ isioFileRead(int fileIndex, void *buffer, int maxToRead) {
    int status, i;
    int reqSize;
    char *myPtr;
-   openedDataObjInp_t dataObjReadInp;
-   bytesBuf_t dataObjReadOutBBuf;
    int count;
    int toMove;
    int newBufSize;
@@ -219,6 +933,9 @@ isioFileRead(int fileIndex, void *buffer, int maxToRead) {
    /* If the buffer had been used for writing, flush it */
    status = isioFlush(fileIndex);
    if (status<0) return(status);
+   /* and let the write-behind finish so the read sees it */
+   status = isioBehindWait(fileIndex);
+   if (status<0) return(status);
 
    reqSize = maxToRead;
    myPtr = buffer;
@@ -263,9 +980,12 @@ isioFileRead(int fileIndex, void *buffer, int maxToRead) {
 	 cacheInfo[i].usingUsersBuffer = 'n';
       }
       else {
-         /* Use user's buffer */
-	 cacheInfo[i].base=buffer;
-	 cacheInfo[i].bufferSize = maxToRead;
+         /* Use the rest of the user's buffer */
+	 if (cacheInfo[i].usingUsersBuffer=='n') {
+	    free(cacheInfo[i].base);
+	 }
+	 cacheInfo[i].base=myPtr;
+	 cacheInfo[i].bufferSize = reqSize;
 	 cacheInfo[i].usingUsersBuffer = 'y';
       }
       cacheInfo[i].ptr=cacheInfo[i].base;
@@ -276,7 +996,7 @@ isioFileRead(int fileIndex, void *buffer, int maxToRead) {
    if (status<0) return(status);
 
    if (cacheInfo[i].usingUsersBuffer=='y') {
-      count = cacheInfo[fileIndex].count;
+      count = (myPtr - (char *)buffer) + cacheInfo[fileIndex].count;
       cacheInfo[fileIndex].count = 0;
       if (debug) printf("isioFileRead return1: %d\n", count);
       return(count);
@@ -292,32 +1012,18 @@ isioFileRead(int fileIndex, void *buffer, int maxToRead) {
       myPtr += toMove;
       reqSize -= toMove;
    }
-   count = (void *)myPtr-buffer;
+   count = myPtr - (char *)buffer;
    if (debug) printf("isioFileRead return2: %d\n", count);
    return(count);
-
-#if 0
-   /* equivalent without caching */
-   dataObjReadOutBBuf.buf = buffer;
-   dataObjReadOutBBuf.len = maxToRead;
-
-   memset(&dataObjReadInp, 0, sizeof (dataObjReadInp));
-
-   dataObjReadInp.l1descInx = openFiles[fileIndex];
-   dataObjReadInp.len = maxToRead;
-
-   return(rcDataObjRead (Comm, &dataObjReadInp,
-			 &dataObjReadOutBBuf));
-#endif
 }
 
 size_t irodsfread(void *buffer, size_t itemsize, int nitems, FILE *fi_stream) {
    int i;
-   i = (int)fi_stream;
+   i = isioIndex(fi_stream);
 
    if (debug) printf("isiofread: %d\n", i);
 
-   if (i<ISIO_MAX_OPEN_FILES && i>=ISIO_MIN_OPEN_FD && openFiles[i]>0) {
+   if (i>=0) {
       return(isioFileRead(i, buffer, itemsize*nitems));
    }
    else {
@@ -331,16 +1037,13 @@ isioFileWrite(int fileIndex, void *buffer, int countToWrite) {
    int spaceInBuffer;
    int newBufSize;
 
-   openedDataObjInp_t dataObjWriteInp;
-   bytesBuf_t dataObjWriteOutBBuf;
-
    if (debug) printf("isioFileWrite: %d\n", fileIndex);
 
    if (cacheInfo[fileIndex].count > 0) {
       /* buffer has read data in it, so seek to where the
          the app thinks the pointer is and disgard the buffered
          read data */
-      long offset;
+      rodsLong_t offset;
       offset = - cacheInfo[fileIndex].count;
       status = isioFileSeek(fileIndex, offset, SEEK_CUR);
       if (status) return(status);
@@ -350,12 +1053,12 @@ isioFileWrite(int fileIndex, void *buffer, int countToWrite) {
 
    spaceInBuffer = cacheInfo[fileIndex].bufferSize -
                    cacheInfo[fileIndex].written;
-                   
+
    if (debug) printf("isioFileWrite: spaceInBuffer %d\n", spaceInBuffer);
    if (countToWrite < spaceInBuffer) {
       /* Fits in the buffer, just cache it */
-      if (debug) printf("isioFileWrite: caching 1 %x %d\n", 
-			(int) cacheInfo[fileIndex].ptr, countToWrite);
+      if (debug) printf("isioFileWrite: caching 1 %p %d\n",
+			cacheInfo[fileIndex].ptr, countToWrite);
       memcpy(cacheInfo[fileIndex].ptr, buffer, countToWrite);
       cacheInfo[fileIndex].ptr += countToWrite;
       cacheInfo[fileIndex].written += countToWrite;
@@ -367,20 +1070,13 @@ isioFileWrite(int fileIndex, void *buffer, int countToWrite) {
 
    if (countToWrite > ISIO_MAX_BUF_SIZE) {
       /* Too big to cache, just send it */
-      dataObjWriteOutBBuf.buf = buffer;
-      dataObjWriteOutBBuf.len = countToWrite;
-
-      memset(&dataObjWriteInp, 0, sizeof (dataObjWriteInp));
-
-      dataObjWriteInp.l1descInx = openFiles[fileIndex];
-      dataObjWriteInp.len = countToWrite;
-
-      status = rcDataObjWrite (Comm, &dataObjWriteInp,
-				&dataObjWriteOutBBuf);
+      status = isioRemoteWrite(fileIndex, buffer, countToWrite,
+			       cacheInfo[fileIndex].pos);
       if (debug) printf("isioFileWrite: rcDataWrite 2 %d\n", status);
       if (status < 0) return(status);
 
-      return(status);  /* total bytes written */
+      cacheInfo[fileIndex].pos += countToWrite;
+      return(countToWrite);  /* total bytes written */
    }
 
    newBufSize=(2*countToWrite)+8;  /* Possible next size */
@@ -408,35 +1104,20 @@ isioFileWrite(int fileIndex, void *buffer, int countToWrite) {
    }
 
    /* Now it fits in the buffer, so cache it */
-   if (debug) printf("isioFileWrite: caching 2 %x %d\n", 
-		     (int) cacheInfo[fileIndex].ptr, countToWrite);
+   if (debug) printf("isioFileWrite: caching 2 %p %d\n",
+		     cacheInfo[fileIndex].ptr, countToWrite);
    memcpy(cacheInfo[fileIndex].ptr, buffer, countToWrite);
    cacheInfo[fileIndex].ptr += countToWrite;
-   cacheInfo[fileIndex].count -= countToWrite; //??
    cacheInfo[fileIndex].written += countToWrite;
    return(countToWrite);
-
-#if 0
-/* non-caching version */
-   dataObjWriteOutBBuf.buf = buffer;
-   dataObjWriteOutBBuf.len = countToWrite;
-
-   memset(&dataObjWriteInp, 0, sizeof (dataObjWriteInp));
-
-   dataObjWriteInp.l1descInx = openFiles[fileIndex];
-   dataObjWriteInp.len = countToWrite;
-
-   return(rcDataObjWrite (Comm, &dataObjWriteInp,
-			 &dataObjWriteOutBBuf));
-#endif
 }
 
-size_t 
+size_t
 irodsfwrite(void *buffer, size_t itemsize, int nitems, FILE *fi_stream) {
    int i;
-   i = (int)fi_stream;
+   i = isioIndex(fi_stream);
    if (debug) printf("irodsfwrite: %d\n", i);
-   if (i<ISIO_MAX_OPEN_FILES && i>=ISIO_MIN_OPEN_FD && openFiles[i]>0) {
+   if (i>=0) {
       return(isioFileWrite(i, buffer, itemsize*nitems));
    }
    else {
@@ -447,18 +1128,24 @@ irodsfwrite(void *buffer, size_t itemsize, int nitems, FILE *fi_stream) {
 int
 isioFileClose(int fileIndex) {
    openedDataObjInp_t dataObjCloseInp;
-   int i, status;
+   int i, status, status1;
 
    if (debug) printf("isioFileClose: %d\n", fileIndex);
 
    /* If the buffer had been used for writing, flush it */
    status = isioFlush(fileIndex);
    if (status<0) return(status);
-
+   status = isioBehindStop(fileIndex);
+   if (status<0) return(status);
+   isioAheadStop(fileIndex);
 
    memset (&dataObjCloseInp, 0, sizeof (dataObjCloseInp));
    dataObjCloseInp.l1descInx = openFiles[fileIndex];
 
+   pthread_mutex_lock(&CommLock);
+   status1 = rcDataObjClose(Comm, &dataObjCloseInp);
+   pthread_mutex_unlock(&CommLock);
+
    openFiles[fileIndex]=0;
 
    i = fileIndex;
@@ -469,14 +1156,14 @@ isioFileClose(int fileIndex) {
 
    cacheInfo[i].usingUsersBuffer = ' ';
 
-   return(rcDataObjClose(Comm, &dataObjCloseInp));
+   return(status1);
 }
 
 size_t irodsfclose(FILE *fi_stream) {
    int i;
-   i = (int)fi_stream;
+   i = isioIndex(fi_stream);
    if (debug) printf("isiofclose: %d\n", i);
-   if (i<ISIO_MAX_OPEN_FILES && i>=ISIO_MIN_OPEN_FD && openFiles[i]>0) {
+   if (i>=0) {
       return(isioFileClose(i));
    }
    else {
@@ -485,60 +1172,135 @@ size_t irodsfclose(FILE *fi_stream) {
 }
 
 
+/* isioFileSeek - set the position of the next fill or flush.  Only
+   SEEK_END needs the server; the other seeks are sent with the next
+   read or write. */
 int
-isioFileSeek(int fileIndex, long offset, int whence) {
+isioFileSeek(int fileIndex, rodsLong_t offset, int whence) {
    openedDataObjInp_t seekParam;
    fileLseekOut_t* seekResult = NULL;
+   rodsLong_t newPos;
    int status;
    if (debug) printf("isioFileSeek: %d\n", fileIndex);
-   memset( &seekParam,  0, sizeof(openedDataObjInp_t) );
-   seekParam.l1descInx = openFiles[fileIndex];
-   seekParam.offset  = offset;
-   seekParam.whence  = whence;
-   status = rcDataObjLseek(Comm, &seekParam, &seekResult );
-   if ( status < 0 ) {
-      rodsLogError (LOG_ERROR, status, "isioFileSeek");
+
+   if (whence == SEEK_END) {
+      /* a pending write may extend the object */
+      status = isioBehindWait(fileIndex);
+      if (status < 0) return(status);
+      memset( &seekParam,  0, sizeof(openedDataObjInp_t) );
+      seekParam.l1descInx = openFiles[fileIndex];
+      seekParam.offset  = offset;
+      seekParam.whence  = whence;
+      pthread_mutex_lock(&CommLock);
+      status = rcDataObjLseek(Comm, &seekParam, &seekResult );
+      if ( status < 0 ) {
+	 cacheInfo[fileIndex].srvOffset = -1;
+	 pthread_mutex_unlock(&CommLock);
+	 rodsLogError (LOG_ERROR, status, "isioFileSeek");
+	 return(status);
+      }
+      cacheInfo[fileIndex].srvOffset = seekResult->offset;
+      pthread_mutex_unlock(&CommLock);
+      cacheInfo[fileIndex].pos = seekResult->offset;
+      free(seekResult);
+      return(0);
    }
-   return(status);
+
+   if (whence == SEEK_CUR) {
+      newPos = cacheInfo[fileIndex].pos + offset;
+   }
+   else {
+      newPos = offset;
+   }
+   if (newPos < 0) {
+      rodsLogError (LOG_ERROR, SYS_INVALID_INPUT_PARAM, "isioFileSeek");
+      return(SYS_INVALID_INPUT_PARAM);
+   }
+   cacheInfo[fileIndex].pos = newPos;
+   return(0);
 }
 
 int
-irodsfseek(FILE *fi_stream, long offset, int whence) {
+irodsfseeko(FILE *fi_stream, off_t offset, int whence) {
    int i;
-   i = (int)fi_stream;
-   if (debug) printf("isiofseek: %d\n", i);
-   if (i<ISIO_MAX_OPEN_FILES && i>=ISIO_MIN_OPEN_FD && openFiles[i]>0) {
+   int status;
+   i = isioIndex(fi_stream);
+   if (debug) printf("isiofseeko: %d\n", i);
+   if (i>=0) {
+      status = isioFlush(i);
+      if (status<0) return(status);
+      /* drop the buffered read data; the app is count bytes behind */
+      if (whence == SEEK_CUR) offset -= cacheInfo[i].count;
+      cacheInfo[i].ptr=cacheInfo[i].base;
+      cacheInfo[i].count = 0;
       return(isioFileSeek(i,offset,whence));
    }
+   else {
+      return(fseeko(fi_stream, offset, whence));
+   }
+}
+
+int
+irodsfseek(FILE *fi_stream, long offset, int whence) {
+   if (isioIndex(fi_stream)>=0) {
+      return(irodsfseeko(fi_stream, offset, whence));
+   }
    else {
       return(fseek(fi_stream, offset, whence));
    }
 }
 
+off_t
+irodsftello(FILE *fi_stream) {
+   int i;
+   i = isioIndex(fi_stream);
+   if (debug) printf("isioftello: %d\n", i);
+   if (i>=0) {
+      return(cacheInfo[i].pos - cacheInfo[i].count +
+	     cacheInfo[i].written);
+   }
+   else {
+      return(ftello(fi_stream));
+   }
+}
+
+long
+irodsftell(FILE *fi_stream) {
+   if (isioIndex(fi_stream)>=0) {
+      return(irodsftello(fi_stream));
+   }
+   else {
+      return(ftell(fi_stream));
+   }
+}
+
 int
 isioFlush(int fileIndex) {
    int i;
    int status;
-   openedDataObjInp_t dataObjWriteInp;
-   bytesBuf_t dataObjWriteOutBBuf;
 
    i = fileIndex;
    if (debug) printf("isioFlush: %d\n", i);
    if (cacheInfo[i].written > 0) {
 
-      dataObjWriteOutBBuf.buf = cacheInfo[i].base;
-      dataObjWriteOutBBuf.len = cacheInfo[i].written;
-
-      memset(&dataObjWriteInp, 0, sizeof (dataObjWriteInp));
-
-      dataObjWriteInp.l1descInx = openFiles[fileIndex];
-      dataObjWriteInp.len = cacheInfo[i].written;
-
-      if (debug) printf("isioFlush: writing %d\n", 
+      if (debug) printf("isioFlush: writing %d\n",
 			cacheInfo[i].written);
-      status = rcDataObjWrite (Comm, &dataObjWriteInp,
-			       &dataObjWriteOutBBuf);
+      if (cacheInfo[i].behind==NULL) {
+	 cacheInfo[i].behind = isioBehindStart(i);
+      }
+      if (cacheInfo[i].behind != NULL &&
+	  cacheInfo[i].usingUsersBuffer == 'n') {
+	 status = isioBehindWrite(i);
+      }
+      else {
+	 status = isioBehindWait(i);
+	 if (status >= 0) {
+	    status = isioRemoteWrite(i, cacheInfo[i].base,
+				     cacheInfo[i].written, cacheInfo[i].pos);
+	 }
+      }
       if (status >=0) {
+	 cacheInfo[i].pos += cacheInfo[i].written;
 	 cacheInfo[i].ptr = cacheInfo[i].base;
 	 cacheInfo[i].written = 0;
       }
@@ -552,16 +1314,49 @@ isioFlush(int fileIndex) {
 int
 irodsfflush(FILE *fi_stream) {
    int i;
-   i = (int)fi_stream;
+   int status;
+   i = isioIndex(fi_stream);
    if (debug) printf("isiofflush: %d\n", i);
-   if (i<ISIO_MAX_OPEN_FILES && i>=ISIO_MIN_OPEN_FD && openFiles[i]>0) {
-      return(isioFlush(i));
+   if (i>=0) {
+      status = isioFlush(i);
+      if (status<0) return(status);
+      return(isioBehindWait(i));
    }
    else {
       return(fflush(fi_stream));
    }
 }
 
+/* isioFilePread - read count bytes at offset without moving the
+   position of the stream */
+int
+isioFilePread(int fileIndex, void *buffer, int count, rodsLong_t offset) {
+   int status;
+
+   if (debug) printf("isioFilePread: %d\n", fileIndex);
+
+   /* the read must see what was written before */
+   status = isioFlush(fileIndex);
+   if (status<0) return(status);
+   status = isioBehindWait(fileIndex);
+   if (status<0) return(status);
+
+   return(isioReadAt(fileIndex, buffer, count, offset));
+}
+
+ssize_t
+irodspread(FILE *fi_stream, void *buffer, size_t count, off_t offset) {
+   int i;
+   i = isioIndex(fi_stream);
+   if (debug) printf("irodspread: %d\n", i);
+   if (i>=0) {
+      return(isioFilePread(i, buffer, count, offset));
+   }
+   else {
+      return(pread(fileno(fi_stream), buffer, count, offset));
+   }
+}
+
 int
 isioFilePutc(int inchar, int fileIndex) {
    int mychar;
@@ -572,9 +1367,9 @@ isioFilePutc(int inchar, int fileIndex) {
 int
 irodsfputc(int inchar, FILE *fi_stream) {
    int i;
-   i = (int)fi_stream;
+   i = isioIndex(fi_stream);
    if (debug) printf("isiofputc: %d\n", i);
-   if (i<ISIO_MAX_OPEN_FILES && i>=ISIO_MIN_OPEN_FD && openFiles[i]>0) {
+   if (i>=0) {
       return(isioFilePutc(inchar, i));
    }
    else {
@@ -595,9 +1390,9 @@ isioFileGetc(int fileIndex) {
 int
 irodsfgetc(FILE *fi_stream) {
    int i;
-   i = (int)fi_stream;
+   i = isioIndex(fi_stream);
    if (debug) printf("isiofgetc: %d\n", i);
-   if (i<ISIO_MAX_OPEN_FILES && i>=ISIO_MIN_OPEN_FD && openFiles[i]>0) {
+   if (i>=0) {
       return(isioFileGetc(i));
    }
    else {
@@ -609,8 +1404,13 @@ irodsfgetc(FILE *fi_stream) {
 int
 irodsexit(int exitValue) {
    int status;
+   int i;
    if (debug) printf("irodsexit: %d\n", exitValue);
    if (setupFlag>0) {
+      /* flush what is buffered and stop the threads */
+      for (i=ISIO_MIN_OPEN_FD;i<ISIO_MAX_OPEN_FILES;i++) {
+	 if (openFiles[i]>0) isioFileClose(i);
+      }
       status = rcDisconnect(Comm);
    }
    exit(exitValue);
@@ -4,6 +4,7 @@
 #include "md5Checksum.h"
 #include "rcMisc.h"
 #include "base64.h"
+#include "chksumCache.h"
 
 #ifdef SHA256_FILE_HASH
 #include "sha.h"
@@ -116,6 +117,8 @@ int verifyChksumLocFile(char *fileName, char *myChksum, char *chksumStr) {
     int status;
     char chksumBuf[CHKSUM_LEN];
     int use_sha256;
+    chksumCacheEnt_t cacheKey;
+    int cacheStatus;
     
     if(chksumStr == NULL) chksumStr = chksumBuf;
     
@@ -126,19 +129,44 @@ int verifyChksumLocFile(char *fileName, char *myChksum, char *chksumStr) {
     
     use_sha256 = status; 
     
-    /* verify the chksum */
-	status = chksumLocFile (fileName, chksumStr, use_sha256);
+    /* verify the chksum. Always read the file, but keep the result in the
+     * local chksum cache for the next chksumLocFile */
+	cacheStatus = getChksumCache (fileName, use_sha256, &cacheKey,
+	  chksumStr);
+	status = _chksumLocFile (fileName, chksumStr, use_sha256);
 	if (status < 0) {
 	    return (status);
 	}
+	if (cacheStatus >= 0) putChksumCache (fileName, &cacheKey, chksumStr);
 	if (strcmp (myChksum, chksumStr) != 0) {
 	    return (USER_CHKSUM_MISMATCH);
 	}
     return 0;
 }
 
+/* chksumLocFile - chksum a local file. If the local chksum cache is in
+ * use (see chksumCache.h), the chksum of a file which has not changed
+ * since it was last hashed comes from the cache.
+ */
 int
 chksumLocFile (char *fileName, char *chksumStr, int use_sha256)
+{
+    chksumCacheEnt_t cacheKey;
+    int cacheStatus;
+    int status;
+
+    cacheStatus = getChksumCache (fileName, use_sha256, &cacheKey, chksumStr);
+    if (cacheStatus > 0) return (0);
+
+    status = _chksumLocFile (fileName, chksumStr, use_sha256);
+    if (status >= 0 && cacheStatus == 0) 
+	putChksumCache (fileName, &cacheKey, chksumStr);
+
+    return (status);
+}
+
+int
+_chksumLocFile (char *fileName, char *chksumStr, int use_sha256)
 {
     FILE *file;
     MD5_CTX context;
@@ -0,0 +1,163 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* kvbench.c - microbenchmark of the keyValPair_t and msParamArray_t
+ * lookups. It times the linear getValByKey against the indexed
+ * getValByKeyIndexed on a condInput like the one of a rsDataObjPut,
+ * and on larger arrays where the index pays off. No server is needed.
+ */
+
+#include "rodsClient.h"
+#include <sys/time.h>
+
+#define DEF_NUM_LOOP	1000000
+
+/* the keywords a client put sends */
+static char *PutKeyWd[] = {DATA_TYPE_KW, DEST_RESC_NAME_KW, FORCE_FLAG_KW,
+  DATA_INCLUDED_KW, REG_CHKSUM_KW, DATA_SIZE_KW};
+
+/* the keywords the server checks on the way. Most are not there */
+static char *CheckKeyWd[] = {RESC_NAME_KW, REPL_NUM_KW, LOCAL_PATH_KW,
+  DEST_RESC_NAME_KW, BACKUP_RESC_NAME_KW, DEF_RESC_NAME_KW, FORCE_FLAG_KW,
+  VERIFY_CHKSUM_KW, REG_CHKSUM_KW, NO_OPEN_FLAG_KW, DATA_INCLUDED_KW,
+  UPDATE_REPL_KW, RBUDP_TRANSFER_KW, IRODS_ADMIN_KW, ALL_KW, DATA_TYPE_KW};
+
+#define NUM_PUT_KEYWD	(sizeof (PutKeyWd) / sizeof (char *))
+#define NUM_CHECK_KEYWD	(sizeof (CheckKeyWd) / sizeof (char *))
+
+static double
+elapsedNs (struct timeval *start, int numOpr)
+{
+    struct timeval end;
+
+    gettimeofday (&end, NULL);
+    return (((end.tv_sec - start->tv_sec) * 1e9 +
+      (end.tv_usec - start->tv_usec) * 1e3) / numOpr);
+}
+
+/* fill condInput with the put keywords plus numExtra other ones */
+static void
+fillCondInput (keyValPair_t *condInput, int numExtra)
+{
+    char myKeyWd[NAME_LEN];
+    int i;
+
+    memset (condInput, 0, sizeof (keyValPair_t));
+    for (i = 0; i < numExtra; i++) {
+	snprintf (myKeyWd, NAME_LEN, "extraKeyWd%d", i);
+	addKeyVal (condInput, myKeyWd, "extra");
+    }
+    for (i = 0; i < (int) NUM_PUT_KEYWD; i++) {
+	addKeyVal (condInput, PutKeyWd[i], "1");
+    }
+}
+
+static void
+benchKeyVal (keyValPair_t *condInput, int numLoop)
+{
+    strIndex_t strIndex;
+    struct timeval start;
+    int i, j, found = 0;
+    double linearNs, indexedNs;
+
+    gettimeofday (&start, NULL);
+    for (i = 0; i < numLoop; i++) {
+	for (j = 0; j < (int) NUM_CHECK_KEYWD; j++) {
+	    if (getValByKey (condInput, CheckKeyWd[j]) != NULL) found++;
+	}
+    }
+    linearNs = elapsedNs (&start, numLoop * NUM_CHECK_KEYWD);
+
+    memset (&strIndex, 0, sizeof (strIndex));
+    gettimeofday (&start, NULL);
+    for (i = 0; i < numLoop; i++) {
+	for (j = 0; j < (int) NUM_CHECK_KEYWD; j++) {
+	    if (getValByKeyIndexed (&strIndex, condInput, CheckKeyWd[j]) !=
+	      NULL) found--;
+	}
+    }
+    indexedNs = elapsedNs (&start, numLoop * NUM_CHECK_KEYWD);
+    clearStrIndex (&strIndex);
+
+    printf ("keyValPair len %3d: getValByKey %6.1f ns, indexed %6.1f ns%s\n",
+      condInput->len, linearNs, indexedNs, found != 0 ? " MISMATCH" : "");
+}
+
+static void
+benchMsParam (int numParam, int numLoop)
+{
+    msParamArray_t msParamArray;
+    strIndex_t strIndex;
+    char *label;
+    struct timeval start;
+    int i, j, found = 0;
+    double linearNs, indexedNs;
+
+    /* the last label is not in the array */
+    label = (char *) malloc ((numParam + 1) * NAME_LEN);
+    memset (&msParamArray, 0, sizeof (msParamArray));
+    for (i = 0; i <= numParam; i++) {
+	snprintf (&label[i * NAME_LEN], NAME_LEN, "*Param%d", i);
+	if (i < numParam) {
+	    addMsParamToArray (&msParamArray, &label[i * NAME_LEN], STR_MS_T,
+	      strdup (&label[i * NAME_LEN]), NULL, 0);
+	}
+    }
+
+    /* look up every label once and a missing one, as carryOverMsParam
+     * does when it merges two arrays */
+    numLoop = numLoop / (numParam + 1) + 1;
+    gettimeofday (&start, NULL);
+    for (i = 0; i < numLoop; i++) {
+	for (j = 0; j <= numParam; j++) {
+	    if (getMsParamByLabel (&msParamArray, &label[j * NAME_LEN]) !=
+	      NULL) found++;
+	}
+    }
+    linearNs = elapsedNs (&start, numLoop * (numParam + 1));
+
+    memset (&strIndex, 0, sizeof (strIndex));
+    gettimeofday (&start, NULL);
+    for (i = 0; i < numLoop; i++) {
+	for (j = 0; j <= numParam; j++) {
+	    if (getMsParamByLabelIndexed (&strIndex, &msParamArray,
+	      &label[j * NAME_LEN]) != NULL) found--;
+	}
+    }
+    indexedNs = elapsedNs (&start, numLoop * (numParam + 1));
+    clearStrIndex (&strIndex);
+
+    printf ("msParamArray len %3d: getMsParamByLabel %6.1f ns, indexed %6.1f ns%s\n",
+      numParam, linearNs, indexedNs, found != 0 ? " MISMATCH" : "");
+
+    clearMsParamArray (&msParamArray, 0);
+    free (label);
+}
+
+int
+main(int argc, char **argv)
+{
+    keyValPair_t condInput;
+    int numLoop = DEF_NUM_LOOP;
+    int numExtra[] = {0, 10, 30, 100};
+    int i;
+
+    if (argc > 1) {
+	numLoop = atoi (argv[1]);
+	if (numLoop <= 0) {
+	    fprintf (stderr, "Usage: %s [numLoop]\n", argv[0]);
+	    exit (1);
+	}
+    }
+
+    for (i = 0; i < (int) (sizeof (numExtra) / sizeof (int)); i++) {
+	fillCondInput (&condInput, numExtra[i]);
+	benchKeyVal (&condInput, numLoop);
+	clearKeyVal (&condInput);
+    }
+
+    benchMsParam (8, numLoop);
+    benchMsParam (40, numLoop);
+    benchMsParam (200, numLoop);
+
+    exit (0);
+}
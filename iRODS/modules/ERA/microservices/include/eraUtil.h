@@ -7,21 +7,46 @@
 #ifndef ERAUTIL_H
 #define ERAUTIL_H
 #define TIMESTAMP_LEN 18
+#define ERA_STREAM_BUF_SIZE (1024*1024)	/* chunk size of the metadata
+					 * export and import streams */
 
 #include "apiHeaderAll.h"
 #include "objMetaOpr.h"
 #include "miscUtil.h"
 
 
+typedef struct eraStream {
+	rsComm_t *rsComm;
+	int l1descInx;		/* the data object written to. If < 0, all
+				 * the output is kept in buf */
+	char *buf;
+	int bufLen;		/* bytes in buf */
+	int bufSize;		/* allocated size of buf */
+	rodsLong_t totalLen;	/* bytes written to the stream so far */
+} eraStream_t;
+
+/* a string being built in a bytesBuf_t. len is the length of the string
+ * so far, so that appending to it does not need a strlen() of the buffer */
+typedef struct eraStrBuf {
+	bytesBuf_t *bBuf;
+	size_t len;
+} eraStrBuf_t;
 
 int appendStrToBBuf(bytesBuf_t *dest, char *str);
 int appendFormattedStrToBBuf(bytesBuf_t *dest, size_t size, const char *format, ...);
+void initEraStrBuf(eraStrBuf_t *strBuf, bytesBuf_t *bBuf);
+int appendStrToStrBuf(eraStrBuf_t *dest, char *str);
+int appendFormattedStrToStrBuf(eraStrBuf_t *dest, size_t size, const char *format, ...);
 char *unescape(char *myStr);
 int parseMetadataModLine(char *inpLine, rsComm_t *rsComm);
 int copyAVUMetadata(char *destPath, char *srcPath, rsComm_t *rsComm);
 int recursiveCollCopy(collInp_t *destCollInp, collInp_t *srcCollInp, rsComm_t *rsComm);
 int getDataObjPSmeta(char *objPath, bytesBuf_t *mybuf, rsComm_t *rsComm);
 int getCollectionPSmeta(char *objPath, bytesBuf_t *mybuf, rsComm_t *rsComm);
+int writeEraStream(eraStream_t *stream, char *str, int len);
+int flushEraStream(eraStream_t *stream);
+int writePSRowToStream(genQueryOut_t *genQueryOut, int row, int nameCnt, eraStream_t *stream);
+int exportCollMetaToStream(char *collPath, eraStream_t *stream);
 int getDataObjACL(dataObjInp_t *myDataObjInp, bytesBuf_t *mybuf, rsComm_t *rsComm);
 int getCollectionACL(collInp_t *myCollInp, char *label, bytesBuf_t *mybuf, rsComm_t *rsComm);
 int loadMetadataFromDataObj(dataObjInp_t *dataObjInp, rsComm_t *rsComm);
@@ -222,14 +222,9 @@ int
 msiExportRecursiveCollMeta(msParam_t *inpParam, msParam_t *outParam, ruleExecInfo_t *rei)
 {
 	collInp_t collInpCache, *outCollInp;
-	genQueryInp_t genQueryInp;
-	genQueryOut_t *genQueryOut;
-	char collQCond[MAX_NAME_LEN];
-	char objPath[MAX_NAME_LEN];
+	eraStream_t stream;
 	rsComm_t *rsComm;
 	bytesBuf_t *mybuf;
-	char *tResult;	
-	int i, j;	
 
 
 
@@ -257,119 +252,153 @@ msiExportRecursiveCollMeta(msParam_t *inpParam, msParam_t *outParam, ruleExecInf
 	}	
 	
 	
+	/* Get the AVUs of all collections and files (recursively) under
+	 * our input collection, keeping all the output in memory */
+	memset (&stream, 0, sizeof (stream));
+	stream.rsComm = rsComm;
+	stream.l1descInx = -1;
+
+	rei->status = exportCollMetaToStream(outCollInp->collName, &stream);
+
 	/* buffer init */
 	mybuf = (bytesBuf_t *)malloc(sizeof(bytesBuf_t));
 	memset (mybuf, 0, sizeof (bytesBuf_t));
-	
-	
-	/* Get all collections (recursively) under our input collection */
-	/* Prepare query */
-	memset (&genQueryInp, 0, sizeof (genQueryInp_t));
-	genAllInCollQCond (outCollInp->collName, collQCond);
-	
-	addInxVal (&genQueryInp.sqlCondInp, COL_COLL_NAME, collQCond);
-	addInxIval (&genQueryInp.selectInp, COL_COLL_NAME, 1);
-	
-	genQueryInp.maxRows = MAX_SQL_ROWS;
-	
-	/* ICAT query for subcollections */
-	rei->status =  rsGenQuery (rsComm, &genQueryInp, &genQueryOut);	
+	mybuf->buf = stream.buf;
+	mybuf->len = stream.bufSize;
 
-	if (rei->status != CAT_NO_ROWS_FOUND) {
-		
-		for (i=0;i<genQueryOut->rowCnt;i++) {
-			
-			for (j=0;j<genQueryOut->attriCnt;j++) {
-				tResult = genQueryOut->sqlResult[j].value;
-				tResult += i*genQueryOut->sqlResult[j].len;
-				
-				/* get metadata for this collection */
-				getCollectionPSmeta(tResult, mybuf, rsComm);
-			}
-		}
 
-		while (rei->status==0 && genQueryOut->continueInx > 0) {
-			genQueryInp.continueInx=genQueryOut->continueInx;
-			rei->status = rsGenQuery(rsComm, &genQueryInp, &genQueryOut);
-
-			for (i=0;i<genQueryOut->rowCnt;i++) {
-			
-				for (j=0;j<genQueryOut->attriCnt;j++) {
-					tResult = genQueryOut->sqlResult[j].value;
-					tResult += i*genQueryOut->sqlResult[j].len;
-					
-					/* get metadata for this collection */
-					getCollectionPSmeta(tResult, mybuf, rsComm);
-				}
-			}
-		}
+	/* did we get any results? */
+	if (!mybuf->buf || !strlen((char*)mybuf->buf)) {
+		appendStrToBBuf(mybuf, "");
 	}
 
+	/* send results out to outParam */
+	fillBufLenInMsParam (outParam, stream.bufLen, mybuf);
+
+	return 0;
+}
+
+
+
+/**
+ * \fn msiExportRecursiveCollMetaToObj(msParam_t *inpParam1, msParam_t *inpParam2, msParam_t *outParam, ruleExecInfo_t *rei)
+ *
+ * \brief Exports metadata AVU triplets for a collection and its contents to a data object
+ *
+ * \module ERA
+ *
+ * \since 3.3
+ *
+ * \note This microservice writes the same pipe separated output as
+ *    msiExportRecursiveCollMeta, but streams it to a data object as it is
+ *    produced instead of keeping it all in memory. The AVUs of the whole
+ *    tree are fetched with paged bulk queries, so large collections can be
+ *    exported with a bounded amount of memory. The target data object is
+ *    overwritten if it exists.
+ *
+ * \usage See clients/icommands/test/rules3.0/
+ *
+ * \param[in] inpParam1 - A CollInp_MS_T or a STR_MS_T with the irods path of the target collection.
+ * \param[in] inpParam2 - A DataObjInp_MS_T or a STR_MS_T with the irods path of the output data object.
+ * \param[out] outParam - A DOUBLE_MS_T containing the number of bytes written.
+ * \param[in,out] rei - The RuleExecInfo structure that is automatically
+ *    handled by the rule engine. The user does not include rei as a
+ *    parameter in the rule invocation.
+ *
+ * \DolVarDependence None
+ * \DolVarModified None
+ * \iCatAttrDependence None
+ * \iCatAttrModified None
+ * \sideeffect Creates or overwrites the output data object.
+ *
+ * \return integer
+ * \retval 0 on success
+ * \pre None
+ * \post None
+ * \sa msiExportRecursiveCollMeta, msiLoadMetadataFromDataObj
+**/
+int
+msiExportRecursiveCollMetaToObj(msParam_t *inpParam1, msParam_t *inpParam2, msParam_t *outParam, ruleExecInfo_t *rei)
+{
+	collInp_t collInpCache, *outCollInp;
+	dataObjInp_t dataObjInpCache, *outDataObjInp;
+	openedDataObjInp_t dataObjCloseInp;
+	eraStream_t stream;
+	rsComm_t *rsComm;
+	int status;
+
+
+
+	/* For testing mode when used with irule --test */
+	RE_TEST_MACRO ("    Calling msiExportRecursiveCollMetaToObj")
 	
-	/* Same thing now for all files (recursively) under our input collection */
-	/* Prepare query */
-	memset (&genQueryInp, 0, sizeof (genQueryInp_t));
-	genAllInCollQCond (outCollInp->collName, collQCond);
+	rsComm = rei->rsComm;
+
+	
+	/* parse inpParam1 */
+	rei->status = parseMspForCollInp (inpParam1, &collInpCache, &outCollInp, 0);
+	
+	if (rei->status < 0) {
+		rodsLogAndErrorMsg (LOG_ERROR, &rsComm->rError, rei->status,
+				    "msiExportRecursiveCollMetaToObj: input inpParam1 error. status = %d", rei->status);
+		return (rei->status);
+	}
+
+	/* parse inpParam2 */
+	rei->status = parseMspForDataObjInp (inpParam2, &dataObjInpCache, &outDataObjInp, 0);
 	
-	addInxVal (&genQueryInp.sqlCondInp, COL_COLL_NAME, collQCond);
-	addInxIval (&genQueryInp.selectInp, COL_COLL_NAME, 1);
-	addInxIval (&genQueryInp.selectInp, COL_DATA_NAME, 1);
+	if (rei->status < 0) {
+		rodsLogAndErrorMsg (LOG_ERROR, &rsComm->rError, rei->status,
+				    "msiExportRecursiveCollMetaToObj: input inpParam2 error. status = %d", rei->status);
+		return (rei->status);
+	}
 	
-	genQueryInp.maxRows = MAX_SQL_ROWS;	
 	
-	/* ICAT query for data objects */
-	rei->status =  rsGenQuery (rsComm, &genQueryInp, &genQueryOut);	
+	/* Make sure input is a collection */
+	status = isColl(rei->rsComm, outCollInp->collName, NULL);
+	if (status < 0) {
+		rei->status = status;
+		rodsLogAndErrorMsg (LOG_ERROR, &rsComm->rError, rei->status,
+				    "msiExportRecursiveCollMetaToObj: Invalid input in inpParam1: %s. No such collection.", outCollInp->collName);
+		return (rei->status);
+	}	
 
-	if (rei->status != CAT_NO_ROWS_FOUND) {
-		
-		for (i=0;i<genQueryOut->rowCnt;i++) {
-
-			/* First attribute is parent collection */
-			tResult = genQueryOut->sqlResult[0].value;
-			tResult += i*genQueryOut->sqlResult[0].len;
-			snprintf(objPath, MAX_NAME_LEN, "%s/", tResult);
-			
-			/* Second attribute is the filename */
-			tResult = genQueryOut->sqlResult[1].value;
-			tResult += i*genQueryOut->sqlResult[1].len;
-			strcat(objPath, tResult);
-			
-			/* Get metadata for this file */
-			getDataObjPSmeta(objPath, mybuf, rsComm);
-		}
 
-		while (rei->status==0 && genQueryOut->continueInx > 0) {
-			genQueryInp.continueInx=genQueryOut->continueInx;
-			rei->status = rsGenQuery(rsComm, &genQueryInp, &genQueryOut);
-
-			for (i=0;i<genQueryOut->rowCnt;i++) {
-			
-				/* First attribute is parent collection */
-				tResult = genQueryOut->sqlResult[0].value;
-				tResult += i*genQueryOut->sqlResult[0].len;
-				snprintf(objPath, MAX_NAME_LEN, "%s/", tResult);
-			
-				/* Second attribute is the filename */
-				tResult = genQueryOut->sqlResult[1].value;
-				tResult += i*genQueryOut->sqlResult[1].len;
-				strcat(objPath, tResult);
-			
-				/* Get metadata for this file */
-				getDataObjPSmeta(objPath, mybuf, rsComm);
-			}
-		}
+	/* create the output object */
+	addKeyVal (&outDataObjInp->condInput, FORCE_FLAG_KW, "");
+	outDataObjInp->openFlags = O_WRONLY;
+
+	memset (&stream, 0, sizeof (stream));
+	stream.rsComm = rsComm;
+	stream.l1descInx = rsDataObjCreate (rsComm, outDataObjInp);
+	if (stream.l1descInx < 0) {
+		rei->status = stream.l1descInx;
+		rodsLogAndErrorMsg (LOG_ERROR, &rsComm->rError, rei->status,
+				    "msiExportRecursiveCollMetaToObj: cannot create %s. status = %d", outDataObjInp->objPath, rei->status);
+		return (rei->status);
 	}
 
+	rei->status = exportCollMetaToStream(outCollInp->collName, &stream);
 
-	/* did we get any results? */
-	if (!mybuf->buf || !strlen((char*)mybuf->buf)) {
-		appendStrToBBuf(mybuf, "");
+	memset (&dataObjCloseInp, 0, sizeof (dataObjCloseInp));
+	dataObjCloseInp.l1descInx = stream.l1descInx;
+	status = rsDataObjClose (rsComm, &dataObjCloseInp);
+	if (rei->status >= 0) {
+		rei->status = status;
+	}
+	if (stream.buf != NULL) {
+		free (stream.buf);
 	}
 
-	/* send results out to outParam */
-	fillBufLenInMsParam (outParam, strlen((char*)mybuf->buf), mybuf);
+	if (rei->status < 0) {
+		rodsLogAndErrorMsg (LOG_ERROR, &rsComm->rError, rei->status,
+				    "msiExportRecursiveCollMetaToObj: export to %s failed. status = %d", outDataObjInp->objPath, rei->status);
+		return (rei->status);
+	}
 
-	return 0;
+	fillDoubleInMsParam (outParam, stream.totalLen);
+
+	return (rei->status);
 }
 
 
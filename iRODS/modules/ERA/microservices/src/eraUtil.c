@@ -32,44 +32,136 @@ appendStrToBBuf(bytesBuf_t *dest, char *str)
 
 
 /*
- * appendFormattedStrToBBuf() - Appends a formatted string to a bytesBuf_t buffer.
+ * initEraStrBuf() - Starts appending to the string in bBuf. The length of
+ * the string is kept in strBuf so that the appends that follow do not
+ * have to look for its end with strlen() each time.
+ */
+void
+initEraStrBuf(eraStrBuf_t *strBuf, bytesBuf_t *bBuf)
+{
+	strBuf->bBuf = bBuf;
+	if (bBuf->buf == NULL) {
+		strBuf->len = 0;
+	}
+	else {
+		strBuf->len = strlen((char *)bBuf->buf);
+	}
+}
+
+
+
+/*
+ * vAppendFormattedStrToStrBuf() - Appends a formatted string to the end
+ * of the string in dest and updates its length.
  * No more than size characters will be appended.
  * Allocates memory (or more memory) if the buffer is NULL or not large enough.
- * The buffer is treated as a string buffer.
  * Returns number of bytes written or a negative value upon failure.
- *
  */
-int
-appendFormattedStrToBBuf(bytesBuf_t *dest, size_t size, const char *format, ...)
+static int
+vAppendFormattedStrToStrBuf(eraStrBuf_t *dest, size_t size, const char *format, va_list ap)
 {
-	va_list ap;
+	bytesBuf_t *bBuf = dest->bBuf;
 	int written;
-	size_t index=0;
+	size_t oldLen;
 	char *tmpPtr;
 
 	/* Initial memory check */
-	if (dest->buf==NULL) {
-		dest->len=size+1;
-		dest->buf=(char *)malloc(dest->len);
-		memset(dest->buf, '\0', dest->len);
+	if (bBuf->buf==NULL) {
+		bBuf->len=size+1;
+		bBuf->buf=(char *)malloc(bBuf->len);
+		if (bBuf->buf == NULL) {
+			bBuf->len = 0;
+			return (SYS_MALLOC_ERR);
+		}
+		memset(bBuf->buf, '\0', bBuf->len);
+		dest->len = 0;
 	}
 
-	/* How much has already been written? */
-	index = strlen((char *)dest->buf);
-	
 	/* Increase buffer size if needed */
-	if (index+size >= (size_t)dest->len) {
-		dest->len=2*(index+size);
-		tmpPtr=(char *)malloc(dest->len);
-		memset(tmpPtr, '\0', dest->len);
-		strncpy(tmpPtr, (char*)dest->buf, dest->len);
-		free(dest->buf);
-		dest->buf=tmpPtr;
+	if (dest->len+size >= (size_t)bBuf->len) {
+		oldLen = bBuf->len;
+		bBuf->len=2*(dest->len+size);
+		tmpPtr=(char *)realloc(bBuf->buf, bBuf->len);
+		if (tmpPtr == NULL) {
+			bBuf->len = oldLen;
+			return (SYS_MALLOC_ERR);
+		}
+		memset(tmpPtr + oldLen, '\0', bBuf->len - oldLen);
+		bBuf->buf=tmpPtr;
 	}
 
 	/* Append new string to previously written characters */
+	written=vsnprintf(((char *)bBuf->buf)+dest->len, size, format, ap);
+
+	if (written < 0) {
+		((char *)bBuf->buf)[dest->len] = '\0';
+	} else if ((size_t)written >= size) {
+		/* truncated */
+		dest->len += (size > 0 ? size - 1 : 0);
+	} else {
+		dest->len += written;
+	}
+
+	return (written);
+}
+
+
+
+/*
+ * appendFormattedStrToStrBuf() - Appends a formatted string to the end
+ * of the string in dest. See vAppendFormattedStrToStrBuf().
+ */
+int
+appendFormattedStrToStrBuf(eraStrBuf_t *dest, size_t size, const char *format, ...)
+{
+	va_list ap;
+	int written;
+
+	va_start(ap, format);
+	written = vAppendFormattedStrToStrBuf(dest, size, format, ap);
+	va_end(ap);
+
+	return (written);
+}
+
+
+
+/*
+ * appendStrToStrBuf() - Appends a string to the end of the string in dest.
+ * Returns number of bytes written or a negative value upon failure.
+ */
+int
+appendStrToStrBuf(eraStrBuf_t *dest, char *str)
+{
+	if (str==NULL) {
+		return (-1);
+	}
+
+	return (appendFormattedStrToStrBuf(dest, strlen(str)+1, "%s", str));
+}
+
+
+
+/*
+ * appendFormattedStrToBBuf() - Appends a formatted string to a bytesBuf_t buffer.
+ * No more than size characters will be appended.
+ * Allocates memory (or more memory) if the buffer is NULL or not large enough.
+ * The buffer is treated as a string buffer.
+ * Returns number of bytes written or a negative value upon failure.
+ * The end of the string is found with strlen(). Callers appending many
+ * strings to the same buffer should use an eraStrBuf_t instead.
+ *
+ */
+int
+appendFormattedStrToBBuf(bytesBuf_t *dest, size_t size, const char *format, ...)
+{
+	eraStrBuf_t strBuf;
+	va_list ap;
+	int written;
+
+	initEraStrBuf(&strBuf, dest);
 	va_start(ap, format);
-	written=vsnprintf(((char *)dest->buf)+index, size, format, ap);
+	written = vAppendFormattedStrToStrBuf(&strBuf, size, format, ap);
 	va_end(ap);
 
 	return (written);
@@ -545,6 +637,223 @@ getCollectionPSmeta(char *objPath, bytesBuf_t *mybuf, rsComm_t *rsComm)
 
 
 
+/*
+ * writeEraStream() - Appends len bytes of str to an export stream.
+ * If the stream has a data object, the buffer is written out to it
+ * each time it fills up. Otherwise the buffer grows and keeps all the
+ * output as a null terminated string.
+ */
+int
+writeEraStream(eraStream_t *stream, char *str, int len)
+{
+	char *tmpPtr;
+	int newSize, toCopy;
+	int status;
+
+	if (stream->l1descInx < 0) {
+		if (stream->bufLen + len >= stream->bufSize) {
+			newSize = stream->bufSize > 0 ? stream->bufSize : ERA_STREAM_BUF_SIZE;
+			while (stream->bufLen + len >= newSize) {
+				newSize *= 2;
+			}
+			tmpPtr = (char *)realloc(stream->buf, newSize);
+			if (tmpPtr == NULL) {
+				return (SYS_MALLOC_ERR);
+			}
+			stream->buf = tmpPtr;
+			stream->bufSize = newSize;
+		}
+		memcpy(stream->buf + stream->bufLen, str, len);
+		stream->bufLen += len;
+		stream->buf[stream->bufLen] = '\0';
+		stream->totalLen += len;
+		return (len);
+	}
+
+	if (stream->buf == NULL) {
+		stream->buf = (char *)malloc(ERA_STREAM_BUF_SIZE);
+		stream->bufSize = ERA_STREAM_BUF_SIZE;
+		stream->bufLen = 0;
+	}
+
+	toCopy = len;
+	while (toCopy > 0) {
+		int chunk = stream->bufSize - stream->bufLen;
+
+		if (chunk > toCopy) {
+			chunk = toCopy;
+		}
+		memcpy(stream->buf + stream->bufLen, str, chunk);
+		stream->bufLen += chunk;
+		str += chunk;
+		toCopy -= chunk;
+		if (stream->bufLen >= stream->bufSize) {
+			if ((status = flushEraStream(stream)) < 0) {
+				return (status);
+			}
+		}
+	}
+	stream->totalLen += len;
+
+	return (len);
+}
+
+
+
+/*
+ * flushEraStream() - Writes the buffered bytes of an export stream
+ * to its data object.
+ */
+int
+flushEraStream(eraStream_t *stream)
+{
+	openedDataObjInp_t dataObjWriteInp;
+	bytesBuf_t writeBuf;
+	int status;
+
+	if (stream->l1descInx < 0 || stream->bufLen <= 0) {
+		return (0);
+	}
+
+	memset (&dataObjWriteInp, 0, sizeof (dataObjWriteInp));
+	dataObjWriteInp.l1descInx = stream->l1descInx;
+	dataObjWriteInp.len = stream->bufLen;
+	writeBuf.buf = stream->buf;
+	writeBuf.len = stream->bufLen;
+
+	status = rsDataObjWrite(stream->rsComm, &dataObjWriteInp, &writeBuf);
+	if (status < 0) {
+		rodsLog (LOG_ERROR,
+		  "flushEraStream: rsDataObjWrite error. status = %d", status);
+		return (status);
+	} else if (status != stream->bufLen) {
+		rodsLog (LOG_ERROR,
+		  "flushEraStream: wrote %d bytes, %d expected", status,
+		  stream->bufLen);
+		return (SYS_COPY_LEN_ERR);
+	}
+	stream->bufLen = 0;
+
+	return (0);
+}
+
+
+
+/*
+ * writePSRowToStream() - Writes a row of an AVU query to an export stream
+ * in the format of extractPSQueryResults(). The first nameCnt columns
+ * make up the object path, the next 3 are the attribute name, value
+ * and units.
+ */
+int
+writePSRowToStream(genQueryOut_t *genQueryOut, int row, int nameCnt, eraStream_t *stream)
+{
+	char *tResult;
+	int j;
+	int status;
+
+	for (j=0;j<genQueryOut->attriCnt;j++) {
+		tResult = genQueryOut->sqlResult[j].value;
+		tResult += row*genQueryOut->sqlResult[j].len;
+
+		if (j > 0 && j < nameCnt) {
+			status = writeEraStream(stream, "/", 1);
+		} else if (j >= nameCnt && (j < nameCnt + 2 || *tResult != '\0')) {
+			/* skip final | if no units were defined */
+			status = writeEraStream(stream, "|", 1);
+		} else if (j >= nameCnt) {
+			continue;
+		} else {
+			status = 0;
+		}
+		if (status < 0) {
+			return (status);
+		}
+		if ((status = writeEraStream(stream, tResult, strlen(tResult))) < 0) {
+			return (status);
+		}
+	}
+
+	return (writeEraStream(stream, "\n", 1));
+}
+
+
+
+/*
+ * exportCollMetaToStream() - Exports the metadata AVUs of a collection
+ * and of all collections and data objects under it to a stream, in the
+ * format of getCollectionPSmeta() and getDataObjPSmeta().
+ * The AVUs are fetched with two paged queries over the whole tree
+ * instead of a query per object.
+ */
+int
+exportCollMetaToStream(char *collPath, eraStream_t *stream)
+{
+	genQueryInp_t genQueryInp;
+	genQueryOut_t *genQueryOut = NULL;
+	char collQCond[MAX_NAME_LEN];
+	int pass, nameCnt;
+	int i, status;
+
+	for (pass = 0; pass < 2; pass++) {
+		memset (&genQueryInp, 0, sizeof (genQueryInp_t));
+		genAllInCollQCond (collPath, collQCond);
+		addInxVal (&genQueryInp.sqlCondInp, COL_COLL_NAME, collQCond);
+		addInxIval (&genQueryInp.selectInp, COL_COLL_NAME, 1);
+		if (pass == 0) {
+			/* collections first */
+			nameCnt = 1;
+			addInxIval (&genQueryInp.selectInp, COL_META_COLL_ATTR_NAME, 1);
+			addInxIval (&genQueryInp.selectInp, COL_META_COLL_ATTR_VALUE, 1);
+			addInxIval (&genQueryInp.selectInp, COL_META_COLL_ATTR_UNITS, 1);
+		} else {
+			nameCnt = 2;
+			addInxIval (&genQueryInp.selectInp, COL_DATA_NAME, 1);
+			addInxIval (&genQueryInp.selectInp, COL_META_DATA_ATTR_NAME, 1);
+			addInxIval (&genQueryInp.selectInp, COL_META_DATA_ATTR_VALUE, 1);
+			addInxIval (&genQueryInp.selectInp, COL_META_DATA_ATTR_UNITS, 1);
+		}
+		genQueryInp.maxRows = MAX_SQL_ROWS;
+
+		status = rsGenQuery (stream->rsComm, &genQueryInp, &genQueryOut);
+		while (status >= 0) {
+			for (i=0;i<genQueryOut->rowCnt;i++) {
+				if ((status = writePSRowToStream(genQueryOut, i, nameCnt,
+				  stream)) < 0) {
+					break;
+				}
+			}
+			if (status < 0 || genQueryOut->continueInx <= 0) {
+				break;
+			}
+			genQueryInp.continueInx = genQueryOut->continueInx;
+			freeGenQueryOut (&genQueryOut);
+			status = rsGenQuery (stream->rsComm, &genQueryInp, &genQueryOut);
+		}
+
+		if (genQueryOut != NULL && genQueryOut->continueInx > 0) {
+			/* close the query */
+			genQueryInp.continueInx = genQueryOut->continueInx;
+			genQueryInp.maxRows = 0;
+			freeGenQueryOut (&genQueryOut);
+			rsGenQuery (stream->rsComm, &genQueryInp, &genQueryOut);
+		}
+		freeGenQueryOut (&genQueryOut);
+		clearGenQueryInp (&genQueryInp);
+
+		if (status < 0 && status != CAT_NO_ROWS_FOUND) {
+			rodsLog (LOG_ERROR,
+			  "exportCollMetaToStream: export of %s failed. status = %d",
+			  collPath, status);
+			return (status);
+		}
+	}
+
+	return (flushEraStream(stream));
+}
+
+
+
 /*
  * Gets pipe separated ACL tokens for a data object.
  * 
@@ -800,20 +1109,21 @@ getCollectionACL(collInp_t *myCollInp, char *label, bytesBuf_t *mybuf, rsComm_t
 
 /*
  * loadMetadataFromDataObj()
- *
+ * The metadata file is streamed in ERA_STREAM_BUF_SIZE chunks. A line cut
+ * at the end of a chunk is moved to the front of the buffer and completed
+ * by the next read, so each byte is read and scanned only once.
  */
 int
 loadMetadataFromDataObj(dataObjInp_t *dataObjInp, rsComm_t *rsComm)
 {
 	openedDataObjInp_t dataObjReadInp;
 	openedDataObjInp_t dataObjCloseInp;
-	openedDataObjInp_t dataObjLseekInp;
-	fileLseekOut_t *dataObjLseekOut;
-	bytesBuf_t *readBuf;
+	bytesBuf_t readBuf;
 	int status;
 	int objID;
-	char *lineStart, *lineEnd;
+	char *buf, *lineStart, *lineEnd;
 	int bytesRead;
+	int carryLen = 0;
 
 	
 	/* check for valid connection */
@@ -834,33 +1144,27 @@ loadMetadataFromDataObj(dataObjInp_t *dataObjInp, rsComm_t *rsComm)
 		return (objID);
 	}
 
-	/* read buffer init */
-	readBuf = (bytesBuf_t *)malloc(sizeof(bytesBuf_t));
-	readBuf->len = 5*1024*1024;	/* no more than 5MB at a time */
-	readBuf->buf = (char *)malloc(readBuf->len);
-	memset (readBuf->buf, '\0', readBuf->len);
+	/* read buffer init. One more byte to null terminate the chunk */
+	buf = (char *)malloc(ERA_STREAM_BUF_SIZE + 1);
 	
 	
 	/* read and parse metadata file */
 	memset (&dataObjReadInp, 0, sizeof (dataObjReadInp));
 	dataObjReadInp.l1descInx = objID;
-	dataObjReadInp.len = readBuf->len;/* 200; */
 
-	/* init offset */
-	dataObjLseekInp.l1descInx = objID;
-	dataObjLseekInp.offset = 0;
-	
-
-	
-	while ((bytesRead = rsDataObjRead (rsComm, &dataObjReadInp, readBuf)) > 0) {
-		
-		/* in case buffer is not null terminated */
-		appendStrToBBuf(readBuf, "");
+	while (1) {
+		readBuf.buf = buf + carryLen;
+		readBuf.len = ERA_STREAM_BUF_SIZE - carryLen;
+		dataObjReadInp.len = readBuf.len;
 
+		if ((bytesRead = rsDataObjRead (rsComm, &dataObjReadInp, &readBuf)) <= 0) {
+			break;
+		}
+		buf[carryLen + bytesRead] = '\0';
 		
-		lineStart = (char*)readBuf->buf;
+		lineStart = buf;
 
-		while ( (lineEnd=strstr(lineStart, "\n")) ) {
+		while ( (lineEnd=strchr(lineStart, '\n')) ) {
 			lineEnd[0]='\0';
 			
 			status = parseMetadataModLine(lineStart, rsComm);
@@ -868,25 +1172,24 @@ loadMetadataFromDataObj(dataObjInp_t *dataObjInp, rsComm_t *rsComm)
 			lineStart=lineEnd+1;
 		}
 		
-		/* must read again any final line that got cut before '\n' */
-		dataObjLseekInp.offset = dataObjLseekInp.offset + bytesRead - strlen(lineStart);
-		dataObjLseekInp.whence = SEEK_SET;
-		
+		/* keep any final line that got cut before '\n' for the next read */
+		carryLen = strlen(lineStart);
 		
-		/* make sure not to get stuck, for example if the file doesn't end with a new line */
-		if (strlen(lineStart) >= (size_t)bytesRead) {
+		/* make sure not to get stuck if a line doesn't fit in the buffer */
+		if (carryLen >= ERA_STREAM_BUF_SIZE) {
 			parseMetadataModLine(lineStart, rsComm);
-			break;
+			carryLen = 0;
+		} else if (carryLen > 0 && lineStart != buf) {
+			memmove(buf, lineStart, carryLen);
 		}
-		
-		status = rsDataObjLseek (rsComm, &dataObjLseekInp, &dataObjLseekOut);
-
-		
-		memset(readBuf->buf, 0, readBuf->len);
-
-	
 	}
 
+	/* the file may not end with a new line */
+	if (carryLen > 0) {
+		buf[carryLen] = '\0';
+		parseMetadataModLine(buf, rsComm);
+	}
+	free (buf);
 
 	
 	/* close metadata file */
@@ -1031,6 +1334,7 @@ parseMetadataModLine(char *inpLine, rsComm_t *rsComm)
 int
 genQueryOutToXML(genQueryOut_t *genQueryOut, bytesBuf_t *mybuf, char **tags)
 {
+	eraStrBuf_t strBuf;
 	int printCount;
 	int i, j;
 	size_t size;
@@ -1040,11 +1344,12 @@ genQueryOutToXML(genQueryOut_t *genQueryOut, bytesBuf_t *mybuf, char **tags)
 		return 0;
 	}
 
+	initEraStrBuf(&strBuf, mybuf);
 	printCount=0;
 	for (i=0;i<genQueryOut->rowCnt;i++) {
 		
 		if ( (tags[0] != NULL) && strlen(tags[0]) ) {
-			appendFormattedStrToBBuf(mybuf, strlen(tags[0])+4, "<%s>\n", tags[0]);
+			appendFormattedStrToStrBuf(&strBuf, strlen(tags[0])+4, "<%s>\n", tags[0]);
 		}
 		
 		for (j=0;j<genQueryOut->attriCnt;j++) {
@@ -1054,17 +1359,17 @@ genQueryOutToXML(genQueryOut_t *genQueryOut, bytesBuf_t *mybuf, char **tags)
 			
 			if ( (tags[j+1] != NULL) && strlen(tags[j+1]) ) {
 				size = genQueryOut->sqlResult[j].len + 2*strlen(tags[j+1]) + 10;
-				appendFormattedStrToBBuf(mybuf, size, "<%s>%s</%s>\n", tags[j+1], tResult, tags[j+1]);
+				appendFormattedStrToStrBuf(&strBuf, size, "<%s>%s</%s>\n", tags[j+1], tResult, tags[j+1]);
 			}
 			else {
 				size = genQueryOut->sqlResult[j].len + 1;
-				appendFormattedStrToBBuf(mybuf, size, "%s\n",tResult);
+				appendFormattedStrToStrBuf(&strBuf, size, "%s\n",tResult);
 			}
 			printCount++;
 		}
 		
 		if ( (tags[0] != NULL) && strlen(tags[0]) ) {
-			appendFormattedStrToBBuf(mybuf, strlen(tags[0])+5, "</%s>\n", tags[0]);
+			appendFormattedStrToStrBuf(&strBuf, strlen(tags[0])+5, "</%s>\n", tags[0]);
 		}
 	
 	}
@@ -1084,6 +1389,7 @@ genQueryOutToXML(genQueryOut_t *genQueryOut, bytesBuf_t *mybuf, char **tags)
 int
 extractPSQueryResults(int status, genQueryOut_t *genQueryOut, bytesBuf_t *mybuf, char *fullName)
 {
+   eraStrBuf_t strBuf;
    int printCount;
    int i, j;
    size_t size;
@@ -1097,9 +1403,10 @@ extractPSQueryResults(int status, genQueryOut_t *genQueryOut, bytesBuf_t *mybuf,
    }
    else {
       if (status !=CAT_NO_ROWS_FOUND) {
+	 initEraStrBuf(&strBuf, mybuf);
 	 for (i=0;i<genQueryOut->rowCnt;i++) {
 	 
-	    appendFormattedStrToBBuf(mybuf, strlen(fullName)+1, fullName);
+	    appendFormattedStrToStrBuf(&strBuf, strlen(fullName)+1, fullName);
 
 	    for (j=0;j<genQueryOut->attriCnt;j++) {
 		char *tResult;
@@ -1109,13 +1416,13 @@ extractPSQueryResults(int status, genQueryOut_t *genQueryOut, bytesBuf_t *mybuf,
 		/* skip final | if no units were defined */
 		if (j<2 || strlen(tResult)) {
 			size = genQueryOut->sqlResult[j].len + 2;
-			appendFormattedStrToBBuf(mybuf, size, "|%s",tResult);
+			appendFormattedStrToStrBuf(&strBuf, size, "|%s",tResult);
 		}
 		
 		printCount++;
 	    }
 
-	    appendStrToBBuf(mybuf, "\n");
+	    appendStrToStrBuf(&strBuf, "\n");
 
 	 }
       }
@@ -1132,13 +1439,15 @@ extractPSQueryResults(int status, genQueryOut_t *genQueryOut, bytesBuf_t *mybuf,
 int
 extractGenQueryResults(genQueryOut_t *genQueryOut, bytesBuf_t *mybuf, char *header, char **descriptions)
 {
+	eraStrBuf_t strBuf;
 	int i, j;
 	char localTime[20];
 
+	initEraStrBuf(&strBuf, mybuf);
 	for (i=0;i<genQueryOut->rowCnt;i++) {
 
 		if ((header != NULL) && strlen(header)) {
-			appendFormattedStrToBBuf(mybuf, strlen(header)+2, "%s|", header);
+			appendFormattedStrToStrBuf(&strBuf, strlen(header)+2, "%s|", header);
 		}
 
 		for (j=0;j<genQueryOut->attriCnt;j++) {
@@ -1147,21 +1456,21 @@ extractGenQueryResults(genQueryOut_t *genQueryOut, bytesBuf_t *mybuf, char *head
 			tResult += i*genQueryOut->sqlResult[j].len;
 
 			if (j) {
-				appendStrToBBuf(mybuf, "|");
+				appendStrToStrBuf(&strBuf, "|");
 			}
 
 			/* write dates in human readable format */
 			if ((descriptions != NULL) && (descriptions[j] != NULL) && (strstr(descriptions[j],"time")!=0)) {
 				getLocalTimeFromRodsTime(tResult, localTime);
-				appendStrToBBuf(mybuf, localTime);
+				appendStrToStrBuf(&strBuf, localTime);
 			}
 			else {
-				appendStrToBBuf(mybuf, tResult);
+				appendStrToStrBuf(&strBuf, tResult);
 			}
 
 		}
 
-	appendStrToBBuf(mybuf, "\n");
+	appendStrToStrBuf(&strBuf, "\n");
 	}
 
 	return (i);
@@ -1175,8 +1484,10 @@ extractGenQueryResults(genQueryOut_t *genQueryOut, bytesBuf_t *mybuf, char *head
 int
 extractACLQueryResults(genQueryOut_t *genQueryOut, bytesBuf_t *mybuf, int coll_flag)
 {
+	eraStrBuf_t strBuf;
 	int i, j;
 
+	initEraStrBuf(&strBuf, mybuf);
 	for (i=0;i<genQueryOut->rowCnt;i++) {
 
 		for (j=0;j<genQueryOut->attriCnt;j++) {
@@ -1187,17 +1498,17 @@ extractACLQueryResults(genQueryOut_t *genQueryOut, bytesBuf_t *mybuf, int coll_f
 			if (j) {
 				if (j==1 && !coll_flag) {
 					/* attach collection and fileName into one path */
-					appendStrToBBuf(mybuf, "/");
+					appendStrToStrBuf(&strBuf, "/");
 				}
 				else {
-					appendStrToBBuf(mybuf, "|");
+					appendStrToStrBuf(&strBuf, "|");
 				}
 			}
 
-			appendStrToBBuf(mybuf, tResult);
+			appendStrToStrBuf(&strBuf, tResult);
 		}
 
-		appendStrToBBuf(mybuf, "\n");
+		appendStrToStrBuf(&strBuf, "\n");
 	}
 
 	return (i);
@@ -2020,10 +2331,12 @@ parseACLModLine(char *inpLine, rsComm_t *rsComm)
 int
 getSqlRowsByInx(genQueryOut_t *genQueryOut, intArray_t *indexes, bytesBuf_t *mybuf)
 {
+	eraStrBuf_t strBuf;
 	char *resultStringToken;
 	sqlResult_t *sqlResult;
 	int i, j;
 
+	initEraStrBuf(&strBuf, mybuf);
 
 	for (i=0;i<genQueryOut->rowCnt;i++) {
 
@@ -2032,12 +2345,12 @@ getSqlRowsByInx(genQueryOut_t *genQueryOut, intArray_t *indexes, bytesBuf_t *myb
 
 			resultStringToken = sqlResult->value + i*sqlResult->len;
 
-			appendStrToBBuf(mybuf, resultStringToken);
-			appendStrToBBuf(mybuf, "|");
+			appendStrToStrBuf(&strBuf, resultStringToken);
+			appendStrToStrBuf(&strBuf, "|");
 		}
 
 
-		appendStrToBBuf(mybuf, "\n");
+		appendStrToStrBuf(&strBuf, "\n");
 	}
 
 	return (i);
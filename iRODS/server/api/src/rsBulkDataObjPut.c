@@ -13,6 +13,9 @@
 #include "miscServerFunct.h"
 #include "rcGlobalExtern.h"
 #include "reGlobalsExtern.h"
+#ifdef PARA_OPR
+#include <pthread.h>
+#endif
 
 int
 rsBulkDataObjPut (rsComm_t *rsComm, bulkOprInp_t *bulkOprInp,
@@ -115,6 +118,34 @@ bytesBuf_t *bulkOprInpBBuf)
 	return status;
     }
 
+    if (getValByKey (&bulkOprInp->condInput, FORCE_FLAG_KW) != NULL) {
+        flags = flags | FORCE_FLAG_FLAG;
+    }
+
+    if (getValByKey (&bulkOprInp->condInput, VERIFY_CHKSUM_KW) != NULL) {
+        flags = flags | VERIFY_CHKSUM_FLAG;
+    }
+
+#ifndef BULK_OPR_WITH_TAR
+    if (myRodsObjStat->specColl == NULL) {
+        /* no need to unbundle to a tmp dir first */
+        freeRodsObjStat (myRodsObjStat);
+        if (strlen (myRescGrpInfo->rescGroupName) > 0)
+            inpRescGrpName = myRescGrpInfo->rescGroupName;
+        status = bulkProcAndRegBuf (rsComm, rescInfo, inpRescGrpName,
+          bulkOprInp, bulkOprInpBBuf, flags);
+        if (status == CAT_NO_ROWS_FOUND) {
+            status = 0;
+        } else if (status < 0) {
+            rodsLog (LOG_ERROR,
+              "_rsBulkDataObjPut: bulkProcAndRegBuf for %s. stat = %d",
+              bulkOprInp->objPath, status);
+        }
+        freeAllRescGrpInfo (myRescGrpInfo);
+        return status;
+    }
+#endif
+
     status = createBunDirForBulkPut (rsComm, &dataObjInp, rescInfo, 
       myRodsObjStat->specColl, phyBunDir);
 
@@ -150,14 +181,6 @@ bytesBuf_t *bulkOprInpBBuf)
     if (strlen (myRescGrpInfo->rescGroupName) > 0) 
         inpRescGrpName = myRescGrpInfo->rescGroupName;
 
-    if (getValByKey (&bulkOprInp->condInput, FORCE_FLAG_KW) != NULL) {
-        flags = flags | FORCE_FLAG_FLAG;
-    }
-
-    if (getValByKey (&bulkOprInp->condInput, VERIFY_CHKSUM_KW) != NULL) {
-        flags = flags | VERIFY_CHKSUM_FLAG;
-    }
-
 #if 0	/* not sure why regUnbunSubfiles was used instead of
          * bulkRegUnbunSubfiles. change it */
     status = regUnbunSubfiles (rsComm, rescInfo, inpRescGrpName,
@@ -400,75 +423,76 @@ genQueryOut_t *attriArray)
     return savedStatus;
 }
 
+/* getBulkSubfilePath - get the vault path of subObjPath for bulk put.
+ * A physical file already at the path is moved to the orphan dir, and
+ * *outModFlag is set if it belongs to subObjPath which is being
+ * overwritten (FORCE_FLAG_FLAG).
+ */
 int
-bulkProcAndRegSubfile (rsComm_t *rsComm, rescInfo_t *rescInfo,
-char *rescGroupName, char *subObjPath, char *subfilePath, rodsLong_t dataSize,
-int dataMode, int flags, genQueryOut_t *bulkDataObjRegInp,
-renamedPhyFiles_t *renamedPhyFiles, genQueryOut_t *attriArray)
+getBulkSubfilePath (rsComm_t *rsComm, rescInfo_t *rescInfo, char *subObjPath,
+rodsLong_t dataSize, int flags, renamedPhyFiles_t *renamedPhyFiles,
+dataObjInfo_t *dataObjInfo, int *outModFlag)
 {
-    dataObjInfo_t dataObjInfo;
     dataObjInp_t dataObjInp;
 #ifndef USE_BOOST_FS
     struct stat statbuf;
 #endif
     int status;
     int modFlag = 0;
-    char *myChksum = NULL;
-    int myDataMode = dataMode;
 
     bzero (&dataObjInp, sizeof (dataObjInp));
-    bzero (&dataObjInfo, sizeof (dataObjInfo));
+    bzero (dataObjInfo, sizeof (dataObjInfo_t));
     rstrcpy (dataObjInp.objPath, subObjPath, MAX_NAME_LEN);
-    rstrcpy (dataObjInfo.objPath, subObjPath, MAX_NAME_LEN);
-    rstrcpy (dataObjInfo.rescName, rescInfo->rescName, NAME_LEN);
-    rstrcpy (dataObjInfo.dataType, "generic", NAME_LEN);
-    dataObjInfo.rescInfo = rescInfo;
-    dataObjInfo.dataSize = dataSize;
+    rstrcpy (dataObjInfo->objPath, subObjPath, MAX_NAME_LEN);
+    rstrcpy (dataObjInfo->rescName, rescInfo->rescName, NAME_LEN);
+    rstrcpy (dataObjInfo->dataType, "generic", NAME_LEN);
+    dataObjInfo->rescInfo = rescInfo;
+    dataObjInfo->dataSize = dataSize;
 
-    status = getFilePathName (rsComm, &dataObjInfo, &dataObjInp);
+    status = getFilePathName (rsComm, dataObjInfo, &dataObjInp);
     if (status < 0) {
         rodsLog (LOG_ERROR,
-          "regSubFile: getFilePathName err for %s. status = %d",
+          "getBulkSubfilePath: getFilePathName err for %s. status = %d",
           dataObjInp.objPath, status);
         return (status);
     }
 
 #ifdef USE_BOOST_FS
-    path p (dataObjInfo.filePath);
+    path p (dataObjInfo->filePath);
     if (exists (p)) {
 	if (is_directory (p)) {
 #else
-    status = stat (dataObjInfo.filePath, &statbuf);
+    status = stat (dataObjInfo->filePath, &statbuf);
     if (status == 0 || errno != ENOENT) {
         if ((statbuf.st_mode & S_IFDIR) != 0) {
 #endif
             return SYS_PATH_IS_NOT_A_FILE;
         }
-        if (chkOrphanFile (rsComm, dataObjInfo.filePath, rescInfo->rescName,
-          &dataObjInfo) <= 0) {
+        if (chkOrphanFile (rsComm, dataObjInfo->filePath, rescInfo->rescName,
+          dataObjInfo) <= 0) {
             /* not an orphan file */
-            if ((flags & FORCE_FLAG_FLAG) != 0 && dataObjInfo.dataId > 0 &&
-              strcmp (dataObjInfo.objPath, subObjPath) == 0) {
+            if ((flags & FORCE_FLAG_FLAG) != 0 && dataObjInfo->dataId > 0 &&
+              strcmp (dataObjInfo->objPath, subObjPath) == 0) {
                 /* overwrite the current file */
                 modFlag = 1;
             } else {
                 status = SYS_COPY_ALREADY_IN_RESC;
                 rodsLog (LOG_ERROR,
-                  "bulkProcAndRegSubfile: phypath %s is already in use. status = %d",
-                  dataObjInfo.filePath, status);
+                  "getBulkSubfilePath: phypath %s is already in use. status = %d",
+                  dataObjInfo->filePath, status);
                 return (status);
             }
         }
         /* rename it to the orphan dir */
         fileRenameInp_t fileRenameInp;
         bzero (&fileRenameInp, sizeof (fileRenameInp));
-        rstrcpy (fileRenameInp.oldFileName, dataObjInfo.filePath,
+        rstrcpy (fileRenameInp.oldFileName, dataObjInfo->filePath,
           MAX_NAME_LEN);
         status = renameFilePathToNewDir (rsComm, ORPHAN_DIR,
           &fileRenameInp, rescInfo, 1);
         if (status < 0) {
             rodsLog (LOG_ERROR,
-              "bulkProcAndRegSubfile: renameFilePathToNewDir err for %s. status = %d",
+              "getBulkSubfilePath: renameFilePathToNewDir err for %s. status = %d",
               fileRenameInp.oldFileName, status);
             return (status);
         }
@@ -479,9 +503,29 @@ renamedPhyFiles_t *renamedPhyFiles, genQueryOut_t *attriArray)
         }
     } else {
         /* make the necessary dir */
-        mkDirForFilePath (UNIX_FILE_TYPE, rsComm, "/", dataObjInfo.filePath,
+        mkDirForFilePath (UNIX_FILE_TYPE, rsComm, "/", dataObjInfo->filePath,
           getDefDirMode ());
     }
+    *outModFlag = modFlag;
+    return 0;
+}
+
+int
+bulkProcAndRegSubfile (rsComm_t *rsComm, rescInfo_t *rescInfo,
+char *rescGroupName, char *subObjPath, char *subfilePath, rodsLong_t dataSize,
+int dataMode, int flags, genQueryOut_t *bulkDataObjRegInp,
+renamedPhyFiles_t *renamedPhyFiles, genQueryOut_t *attriArray)
+{
+    dataObjInfo_t dataObjInfo;
+    int status;
+    int modFlag = 0;
+    char *myChksum = NULL;
+    int myDataMode = dataMode;
+
+    status = getBulkSubfilePath (rsComm, rescInfo, subObjPath, dataSize, 
+      flags, renamedPhyFiles, &dataObjInfo, &modFlag);
+    if (status < 0) return status;
+
     /* add a link */
 #ifndef windows_platform
     status = link (subfilePath, dataObjInfo.filePath);
@@ -564,6 +608,267 @@ renamedPhyFiles_t *renamedPhyFiles)
     return status;
 }
 
+/* bulkProcAndRegBuf - write the subfiles in the bulk buffer straight to
+ * their vault paths and register them. The vault paths are resolved
+ * and the collections made in this thread since they go through the
+ * rule engine and the icat. The writing and the chksum verification
+ * are done by bulkPutNumThreads threads. The registration is batched.
+ */
+int
+bulkProcAndRegBuf (rsComm_t *rsComm, rescInfo_t *rescInfo,
+char *rescGroupName, bulkOprInp_t *bulkOprInp, bytesBuf_t *bulkBBuf,
+int flags)
+{
+    genQueryOut_t *attriArray = &bulkOprInp->attriArray;
+    genQueryOut_t bulkDataObjRegInp;
+    renamedPhyFiles_t renamedPhyFiles;
+    sqlResult_t *objPath, *offset, *dataMode, *chksum;
+    bulkPutTask_t *tasks;
+    dataObjInfo_t dataObjInfo;
+    char lastColl[MAX_NAME_LEN], myColl[MAX_NAME_LEN], myData[MAX_NAME_LEN];
+    int collLen = strlen (bulkOprInp->objPath);
+    int prevOffset = 0;
+    int numTasks = 0;
+    int status = 0;
+    int savedStatus = 0;
+    int i;
+
+    if ((objPath = getSqlResultByInx (attriArray, COL_DATA_NAME)) == NULL ||
+      (offset = getSqlResultByInx (attriArray, OFFSET_INX)) == NULL ||
+      (dataMode = getSqlResultByInx (attriArray, COL_DATA_MODE)) == NULL) {
+        rodsLog (LOG_NOTICE,
+          "bulkProcAndRegBuf: getSqlResultByInx for attriArray failed");
+        return (UNMATCHED_KEY_OR_INDEX);
+    }
+    chksum = getSqlResultByInx (attriArray, COL_D_DATA_CHECKSUM);
+    if (attriArray->rowCnt > MAX_NUM_BULK_OPR_FILES) {
+        rodsLog (LOG_NOTICE,
+          "bulkProcAndRegBuf: rowCnt %d too large", attriArray->rowCnt);
+        return (SYS_REQUESTED_BUF_TOO_LARGE);
+    }
+    if (attriArray->rowCnt <= 0) return 0;
+
+    tasks = (bulkPutTask_t *) calloc (attriArray->rowCnt,
+      sizeof (bulkPutTask_t));
+    bzero (&renamedPhyFiles, sizeof (renamedPhyFiles));
+    *lastColl = '\0';
+
+    for (i = 0; i < attriArray->rowCnt; i++) {
+        bulkPutTask_t *task = &tasks[numTasks];
+        char *subObjPath = &objPath->value[objPath->len * i];
+        int myOffset = atoi (&offset->value[offset->len * i]);
+        int modFlag = 0;
+
+        if (myOffset < prevOffset || myOffset > bulkBBuf->len) {
+            rodsLog (LOG_ERROR,
+              "bulkProcAndRegBuf: bad offset %d for %s", myOffset, subObjPath);
+            savedStatus = SYS_COPY_LEN_ERR;
+            break;
+        }
+        task->buf = (char *) bulkBBuf->buf + prevOffset;
+        task->size = myOffset - prevOffset;
+        prevOffset = myOffset;
+
+        /* same check as getPhyBunPath. No way out of the collection */
+        if (strncmp (subObjPath, bulkOprInp->objPath, collLen) != 0 ||
+          subObjPath[collLen] != '/' || strstr (subObjPath, "/../") != NULL) {
+            rodsLog (LOG_ERROR,
+              "bulkProcAndRegBuf: inconsistent collection %s and objPath %s",
+              bulkOprInp->objPath, subObjPath);
+            savedStatus = USER_INPUT_PATH_ERR;
+            continue;
+        }
+        splitPathByKey (subObjPath, myColl, myData, '/');
+        if (strcmp (myColl, lastColl) != 0) {
+            if (strcmp (myColl, bulkOprInp->objPath) != 0) {
+                status = rsMkCollR (rsComm, bulkOprInp->objPath, myColl);
+                if (status < 0) {
+                    rodsLog (LOG_ERROR,
+                      "bulkProcAndRegBuf: rsMkCollR of %s error. status = %d",
+                      myColl, status);
+                    savedStatus = status;
+                    continue;
+                }
+            }
+            rstrcpy (lastColl, myColl, MAX_NAME_LEN);
+        }
+
+        status = getBulkSubfilePath (rsComm, rescInfo, subObjPath,
+          task->size, flags, &renamedPhyFiles, &dataObjInfo, &modFlag);
+        if (status < 0) {
+            rodsLog (LOG_ERROR,
+             "bulkProcAndRegBuf: getBulkSubfilePath of %s err. stat = %d",
+              subObjPath, status);
+            savedStatus = status;
+            continue;
+        }
+        rstrcpy (task->objPath, subObjPath, MAX_NAME_LEN);
+        rstrcpy (task->filePath, dataObjInfo.filePath, MAX_NAME_LEN);
+        task->dataMode = atoi (&dataMode->value[dataMode->len * i]);
+        task->modFlag = modFlag;
+        task->replNum = dataObjInfo.replNum;
+        if (chksum != NULL && strlen (&chksum->value[chksum->len * i]) > 0)
+            task->chksum = &chksum->value[chksum->len * i];
+        task->verifyFlag = (flags & VERIFY_CHKSUM_FLAG) != 0 &&
+          task->chksum != NULL;
+        numTasks++;
+    }
+
+    writeBulkPutTasks (tasks, numTasks);
+
+    initBulkDataObjRegInp (&bulkDataObjRegInp);
+    for (i = 0; i < numTasks; i++) {
+        if (tasks[i].status < 0) {
+            savedStatus = tasks[i].status;
+            if (tasks[i].modFlag > 0) {
+                /* put the current copy back */
+                restoreRenamedPhyFile (tasks[i].objPath, &renamedPhyFiles);
+            }
+            continue;
+        }
+        status = bulkRegSubfile (rsComm, rescInfo->rescName, rescGroupName,
+          tasks[i].objPath, tasks[i].filePath, tasks[i].size,
+          tasks[i].dataMode, tasks[i].modFlag, tasks[i].replNum,
+          tasks[i].chksum, &bulkDataObjRegInp, &renamedPhyFiles);
+        if (status < 0) savedStatus = status;
+    }
+    status = 0;
+    if (bulkDataObjRegInp.rowCnt > 0) {
+        genQueryOut_t *bulkDataObjRegOut = NULL;
+        status = rsBulkDataObjReg (rsComm, &bulkDataObjRegInp,
+          &bulkDataObjRegOut);
+        if (status < 0) {
+            rodsLog (LOG_ERROR,
+              "bulkProcAndRegBuf: rsBulkDataObjReg error for %s. stat = %d",
+              bulkOprInp->objPath, status);
+            cleanupBulkRegFiles (rsComm, &bulkDataObjRegInp);
+        }
+        postProcRenamedPhyFiles (&renamedPhyFiles, status);
+        postProcBulkPut (rsComm, &bulkDataObjRegInp, bulkDataObjRegOut);
+        freeGenQueryOut (&bulkDataObjRegOut);
+    }
+    clearGenQueryOut (&bulkDataObjRegInp);
+    free (tasks);
+
+    if (status >= 0 && savedStatus < 0) {
+        return savedStatus;
+    } else {
+        return status;
+    }
+}
+
+/* writeBulkPutTask - write a subfile to its vault path and verify the
+ * input chksum. Runs in the worker threads. No rsComm in here.
+ */
+int
+writeBulkPutTask (bulkPutTask_t *task)
+{
+    int out_fd;
+    int status;
+
+    out_fd = open (task->filePath, O_WRONLY | O_CREAT | O_TRUNC,
+      getDefFileMode ());
+    if (out_fd < 0) {
+        task->status = UNIX_FILE_OPEN_ERR - errno;
+        rodsLogError (LOG_ERROR, task->status,
+          "writeBulkPutTask: open error for %s", task->filePath);
+        return task->status;
+    }
+    status = myWrite (out_fd, task->buf, task->size, FILE_DESC_TYPE, NULL);
+    close (out_fd);
+    if (status != task->size) {
+        if (status >= 0) status = SYS_COPY_LEN_ERR - errno;
+        rodsLog (LOG_ERROR,
+          "writeBulkPutTask: Bytes written %d does not match size %d for %s",
+          status, task->size, task->filePath);
+        unlink (task->filePath);
+        task->status = status;
+        return status;
+    }
+
+    if (task->verifyFlag > 0) {
+        char chksumStr[CHKSUM_LEN];
+        status = verifyChksumLocFile (task->filePath, task->chksum, chksumStr);
+        if (status < 0) {
+            if (status == USER_CHKSUM_MISMATCH) {
+                rodsLog (LOG_ERROR,
+                  "writeBulkPutTask: chksum of %s %s != input %s",
+                  task->filePath, chksumStr, task->chksum);
+            } else {
+                rodsLog (LOG_ERROR,
+                  "writeBulkPutTask: chksumLocFile error for %s ",
+                  task->filePath);
+            }
+            unlink (task->filePath);
+            task->status = status;
+            return status;
+        }
+    }
+    task->status = 0;
+    return 0;
+}
+
+#ifdef PARA_OPR
+static void *
+bulkPutWorker (void *arg)
+{
+    bulkPutTaskQue_t *taskQue = (bulkPutTaskQue_t *) arg;
+    int inx;
+
+    while (1) {
+        pthread_mutex_lock (&taskQue->lock);
+        inx = taskQue->nextInx++;
+        pthread_mutex_unlock (&taskQue->lock);
+        if (inx >= taskQue->numTasks) break;
+        writeBulkPutTask (&taskQue->tasks[inx]);
+    }
+    return NULL;
+}
+#endif
+
+int
+writeBulkPutTasks (bulkPutTask_t *tasks, int numTasks)
+{
+    int numThreads = DEF_BULK_PUT_NUM_THREADS;
+    char *tmpStr;
+    int i;
+
+    if ((tmpStr = getenv (BULK_PUT_NUM_THREADS)) != NULL) {
+        numThreads = atoi (tmpStr);
+    }
+    if (numThreads > MAX_BULK_PUT_NUM_THREADS)
+        numThreads = MAX_BULK_PUT_NUM_THREADS;
+    if (numThreads > numTasks) numThreads = numTasks;
+
+#ifdef PARA_OPR
+    if (numThreads > 1) {
+        bulkPutTaskQue_t taskQue;
+        pthread_t tid[MAX_BULK_PUT_NUM_THREADS];
+        int numStarted = 0;
+
+        bzero (&taskQue, sizeof (taskQue));
+        taskQue.tasks = tasks;
+        taskQue.numTasks = numTasks;
+        pthread_mutex_init (&taskQue.lock, NULL);
+        for (i = 0; i < numThreads - 1; i++) {
+            if (pthread_create (&tid[numStarted], NULL, bulkPutWorker,
+              (void *) &taskQue) == 0) numStarted++;
+        }
+        /* this thread helps out. It also covers a failed pthread_create */
+        bulkPutWorker ((void *) &taskQue);
+        for (i = 0; i < numStarted; i++) {
+            pthread_join (tid[i], NULL);
+        }
+        pthread_mutex_destroy (&taskQue.lock);
+        return 0;
+    }
+#endif
+    for (i = 0; i < numTasks; i++) {
+        writeBulkPutTask (&tasks[i]);
+    }
+    return 0;
+}
+
 int
 addRenamedPhyFile (char *subObjPath, char *oldFileName, char *newFileName,
 renamedPhyFiles_t *renamedPhyFiles)
@@ -587,6 +892,39 @@ renamedPhyFiles_t *renamedPhyFiles)
     return 0;
 }
 
+/* restoreRenamedPhyFile - move the file of objPath renamed to the orphan
+ * dir back and take it out of renamedPhyFiles */
+int
+restoreRenamedPhyFile (char *objPath, renamedPhyFiles_t *renamedPhyFiles)
+{
+    int i, last;
+    int status = 0;
+
+    for (i = 0; i < renamedPhyFiles->count; i++) {
+        if (strcmp (&renamedPhyFiles->objPath[i][0], objPath) != 0) continue;
+        if (rename (&renamedPhyFiles->newFilePath[i][0],
+          &renamedPhyFiles->origFilePath[i][0]) < 0) {
+            status = UNIX_FILE_RENAME_ERR - errno;
+            rodsLog (LOG_ERROR,
+              "restoreRenamedPhyFile: rename error from %s to %s, status=%d",
+              &renamedPhyFiles->newFilePath[i][0],
+              &renamedPhyFiles->origFilePath[i][0], status);
+        }
+        last = renamedPhyFiles->count - 1;
+        if (i < last) {
+            rstrcpy (&renamedPhyFiles->objPath[i][0],
+              &renamedPhyFiles->objPath[last][0], MAX_NAME_LEN);
+            rstrcpy (&renamedPhyFiles->origFilePath[i][0],
+              &renamedPhyFiles->origFilePath[last][0], MAX_NAME_LEN);
+            rstrcpy (&renamedPhyFiles->newFilePath[i][0],
+              &renamedPhyFiles->newFilePath[last][0], MAX_NAME_LEN);
+        }
+        renamedPhyFiles->count--;
+        break;
+    }
+    return status;
+}
+
 int
 postProcRenamedPhyFiles (renamedPhyFiles_t *renamedPhyFiles, int regStatus)
 {
@@ -34,8 +34,12 @@ collOprStat_t **collOprStat)
     collEnt_t *collEnt;
     int handleInx;
     transferStat_t myTransStat;
-    int totalFileCnt;
+    int totalFileCnt = 0;
     int fileCntPerStatOut;
+    char *objPathArray[MAX_DATA_OBJ_INFO_BATCH];
+    int numPath, i;
+    int doneFlag = 0;
+    char *accessPerm;
     int savedStatus = 0;
     int remoteFlag;
     rodsServerHost_t *rodsServerHost;
@@ -81,14 +85,39 @@ collOprStat_t **collOprStat)
         return (0);
     }
 
-    while ((status = rsReadCollection (rsComm, &handleInx, &collEnt)) >= 0) {
-        if (collEnt->objType == DATA_OBJ_T) {
-	    if (totalFileCnt == 0) totalFileCnt = 
-		CollHandle[handleInx].dataObjSqlResult.totalRowCount;
+    if (getValByKey (&collReplInp->condInput, SU_CLIENT_USER_KW) != NULL ||
+      getValByKey (&collReplInp->condInput, IRODS_ADMIN_KW) != NULL) {
+        accessPerm = NULL;
+    } else {
+        accessPerm = ACCESS_READ_OBJECT;
+    }
+
+    while (doneFlag == 0) {
+	/* read a batch of data objects and get their dataObjInfo with one
+	 * query, for the getDataObjInfo of _rsDataObjRepl */
+	numPath = 0;
+        while (numPath < MAX_DATA_OBJ_INFO_BATCH &&
+	  (status = rsReadCollection (rsComm, &handleInx, &collEnt)) >= 0) {
+            if (collEnt->objType == DATA_OBJ_T) {
+	        if (totalFileCnt == 0) totalFileCnt = 
+		    CollHandle[handleInx].dataObjSqlResult.totalRowCount;
+		objPathArray[numPath] = (char *) malloc (MAX_NAME_LEN);
+                snprintf (objPathArray[numPath], MAX_NAME_LEN, "%s/%s",
+                  collEnt->collName, collEnt->dataName);
+		numPath++;
+	    }
+	    free (collEnt);	    /* just free collEnt but not content */
+	}
+	if (numPath == 0) break;
+
+	bzero (&dataObjInp, sizeof (dataObjInp));
+	dataObjInp.condInput = collReplInp->condInput;
+	getDataObjInfoBatch (rsComm, &dataObjInp, accessPerm, 1, numPath,
+	  objPathArray);
 
+	for (i = 0; i < numPath && doneFlag == 0; i++) {
 	    bzero (&dataObjInp, sizeof (dataObjInp));
-            snprintf (dataObjInp.objPath, MAX_NAME_LEN, "%s/%s",
-              collEnt->collName, collEnt->dataName);
+            rstrcpy (dataObjInp.objPath, objPathArray[i], MAX_NAME_LEN);
 	    dataObjInp.condInput = collReplInp->condInput;
 
     	    memset (&myTransStat, 0, sizeof (myTransStat));
@@ -105,7 +134,8 @@ collOprStat_t **collOprStat)
                   "rsCollRepl: rsDataObjRepl failed for %s. status = %d",
                   dataObjInp.objPath, status);
 		savedStatus = status;
-                break;
+                doneFlag = 1;
+		break;
             } else {
 		if (collOprStat != NULL) {
 		    (*collOprStat)->bytesWritten += myTransStat.bytesWritten;
@@ -124,13 +154,14 @@ collOprStat_t **collOprStat)
                       dataObjInp.objPath, status);
 		    *collOprStat = NULL;
 	            savedStatus = status;
+                    doneFlag = 1;
 	            break;
 	        }
                  *collOprStat = (collOprStat_t*)malloc (sizeof (collOprStat_t));
                  memset (*collOprStat, 0, sizeof (collOprStat_t));
 	    }
         }
-	free (collEnt);	    /* just free collEnt but not content */
+	for (i = 0; i < numPath; i++) free (objPathArray[i]);
     }
     rsCloseCollection (rsComm, &handleInx);
 
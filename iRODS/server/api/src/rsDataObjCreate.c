@@ -423,6 +423,7 @@ dataObjInfo_t *dataObjInfo)
 	  NAME_LEN);
 	rstrcpy (fileCreateInp.fileName, dataObjInfo->filePath, MAX_NAME_LEN);
 	fileCreateInp.mode = getFileMode (dataObjInp);
+	fileCreateInp.dataSize = dataObjInp->dataSize;
         chkType = getchkPathPerm (rsComm, dataObjInp, dataObjInfo);
 #ifdef FILESYSTEM_META
         copyFilesystemMetadata(&dataObjInfo->condInput,
@@ -462,6 +463,8 @@ dataObjInfo_t *dataObjInfo)
  * rescGrpInfo_t of the resource after applying the acSetRescSchemeForCreate
  * rule. 
  * Return 1 of the "random" sorting scheme is used. Otherwise return 0
+ * The order given by the "byLiveLoad" and "byLeastBytes" schemes is kept
+ * too since floating the local resources to the top would undo it.
  * or an error code.
  */
 
@@ -504,12 +507,15 @@ rescGrpInfo_t **myRescGrpInfo)
       dataObjInp->dataSize);
     if (status == SYS_RESC_QUOTA_EXCEEDED) return SYS_RESC_QUOTA_EXCEEDED;
 
-    if (strstr (rei.statusStr, "random") == NULL) {
+    if (strstr (rei.statusStr, "random") != NULL) {
+	return 1;
+    } else if (strstr (rei.statusStr, "byLiveLoad") != NULL ||
+      strstr (rei.statusStr, "byLeastBytes") != NULL) {
+	return 0;
+    } else {
 	/* not a random scheme */
 	sortRescByLocation (myRescGrpInfo);
 	return 0;
-    } else {
-	return 1;
     }
 }
 
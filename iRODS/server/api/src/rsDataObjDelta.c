@@ -0,0 +1,441 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* rsDataObjDelta.c - update a replica with a block level delta. See
+ * deltaUtil.c for the client side.
+ *
+ * An update is an open for write of the replica as far as the rules go:
+ * acPreprocForDataObjOpen is applied to the first DELTA_APPLY_OPR call
+ * (offset 0) and to the DELTA_COMMIT_OPR call, and acPostProcForPut is
+ * applied after a successful commit.
+ */
+
+#include "dataObjDelta.h"
+#include "dataObjOpen.h"
+#include "dataObjRead.h"
+#include "dataObjWrite.h"
+#include "dataObjLseek.h"
+#include "dataObjClose.h"
+#include "dataObjRename.h"
+#include "dataObjUnlink.h"
+#include "modDataObjMeta.h"
+#include "objMetaOpr.h"
+#include "dataObjOpr.h"
+#include "physPath.h"
+#include "resource.h"
+#include "specColl.h"
+#include "getRemoteZoneResc.h"
+#include "deltaUtil.h"
+#include "rsGlobalExtern.h"
+#include "reGlobalsExtern.h"
+
+int
+rsDataObjDelta (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
+bytesBuf_t *deltaBBuf, bytesBuf_t *sigBBuf)
+{
+    int status;
+    int remoteFlag;
+    rodsServerHost_t *rodsServerHost;
+    specCollCache_t *specCollCache = NULL;
+
+    resolveLinkedPath (rsComm, dataObjInp->objPath, &specCollCache,
+      &dataObjInp->condInput);
+    remoteFlag = getAndConnRemoteZone (rsComm, dataObjInp, &rodsServerHost,
+      REMOTE_OPEN);
+
+    if (remoteFlag < 0) {
+        return (remoteFlag);
+    } else if (remoteFlag == REMOTE_HOST) {
+        status = rcDataObjDelta (rodsServerHost->conn, dataObjInp, deltaBBuf,
+          sigBBuf);
+        return status;
+    }
+
+    status = _rsDataObjDelta (rsComm, dataObjInp, deltaBBuf, sigBBuf);
+
+    return (status);
+}
+
+/* deltaReadFull - read len bytes unless the end of file is reached */
+static int
+deltaReadFull (rsComm_t *rsComm, int rescTypeInx, int l3descInx,
+unsigned char *buf, int len)
+{
+    int total = 0;
+    int n;
+
+    while (total < len) {
+        n = _l3Read (rsComm, rescTypeInx, l3descInx, buf + total, len - total);
+        if (n < 0) return (n);
+        if (n == 0) break;
+        total += n;
+    }
+    return (total);
+}
+
+static int
+deltaSig (rsComm_t *rsComm, dataObjInfo_t *dataObjInfo, bytesBuf_t *sigBBuf)
+{
+    int rescTypeInx = dataObjInfo->rescInfo->rescTypeInx;
+    rodsLong_t dataSize = dataObjInfo->dataSize;
+    int blockSize, numBlocks, bufSize;
+    unsigned char *sig, *ent, *buf;
+    rodsLong_t total = 0;
+    int l3descInx;
+    int inx = 0;
+    int status = 0;
+
+    blockSize = getDeltaBlockSize (dataSize);
+    numBlocks = (int) ((dataSize + blockSize - 1) / blockSize);
+    if (numBlocks <= 0) return (SYS_NOT_SUPPORTED);
+
+    l3descInx = _l3Open (rsComm, dataObjInfo, 0, O_RDONLY);
+    if (l3descInx < 0) {
+        rodsLogError (LOG_ERROR, l3descInx,
+          "deltaSig: _l3Open of %s failed, ", dataObjInfo->filePath);
+        return (l3descInx);
+    }
+
+    sigBBuf->len = DELTA_SIG_HEADER_LEN + numBlocks * DELTA_SIG_ENT_LEN;
+    sigBBuf->buf = sig = (unsigned char *) malloc (sigBBuf->len);
+    putDeltaInt (sig, blockSize);
+    putDeltaInt (sig + 4, numBlocks);
+    putDeltaInt (sig + 8, dataObjInfo->replNum);
+    putDeltaInt (sig + 12, (unsigned int) (dataSize >> 32));
+    putDeltaInt (sig + 16, (unsigned int) (dataSize & 0xffffffff));
+
+    bufSize = DELTA_CHUNK_SIZE / blockSize * blockSize;
+    if (bufSize < blockSize) bufSize = blockSize;
+    buf = (unsigned char *) malloc (bufSize);
+    ent = sig + DELTA_SIG_HEADER_LEN;
+    while (inx < numBlocks) {
+        int n, i;
+        n = deltaReadFull (rsComm, rescTypeInx, l3descInx, buf, bufSize);
+        if (n <= 0) {
+            status = n < 0 ? n : SYS_COPY_LEN_ERR;
+            break;
+        }
+        total += n;
+        for (i = 0; i < n && inx < numBlocks; i += blockSize) {
+            int len = n - i < blockSize ? n - i : blockSize;
+            putDeltaInt (ent, deltaWeakSum (buf + i, len));
+            deltaStrongSum (buf + i, len, ent + 4);
+            ent += DELTA_SIG_ENT_LEN;
+            inx++;
+        }
+        if (n < bufSize) break;
+    }
+    free (buf);
+    _l3Close (rsComm, rescTypeInx, l3descInx);
+
+    if (status >= 0 && (inx != numBlocks || total != dataSize)) {
+        rodsLog (LOG_ERROR,
+          "deltaSig: size of %s is %lld, not %lld",
+          dataObjInfo->filePath, total, dataSize);
+        status = SYS_COPY_LEN_ERR;
+    }
+    if (status < 0) {
+        free (sigBBuf->buf);
+        sigBBuf->buf = NULL;
+        sigBBuf->len = 0;
+    }
+    return (status);
+}
+
+/* deltaApply - write the content given by the delta records in deltaBBuf
+ * to the tmp file at dataObjInp->offset. Copies are read from the
+ * replica. */
+static int
+deltaApply (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
+dataObjInfo_t *dataObjInfo, dataObjInfo_t *tmpDataObjInfo,
+bytesBuf_t *deltaBBuf)
+{
+    int rescTypeInx = dataObjInfo->rescInfo->rescTypeInx;
+    rodsLong_t dataSize = dataObjInfo->dataSize;
+    unsigned char *ptr, *endPtr;
+    unsigned char *buf = NULL;
+    rodsLong_t srcOffset = -1;
+    int srcL3descInx, destL3descInx;
+    int blockSize, numBlocks;
+    char *tmpStr;
+    int status = 0;
+
+    if ((tmpStr = getValByKey (&dataObjInp->condInput, DELTA_BLOCK_SIZE_KW))
+      == NULL || (blockSize = atoi (tmpStr)) <= 0) {
+        return (SYS_INVALID_INPUT_PARAM);
+    }
+    numBlocks = (int) ((dataSize + blockSize - 1) / blockSize);
+
+    if (dataObjInp->offset == 0) {
+        destL3descInx = _l3Open (rsComm, tmpDataObjInfo,
+          getFileMode (dataObjInp), O_WRONLY | O_CREAT | O_TRUNC);
+    } else {
+        destL3descInx = _l3Open (rsComm, tmpDataObjInfo, 0, O_WRONLY);
+    }
+    if (destL3descInx < 0) {
+        rodsLogError (LOG_ERROR, destL3descInx,
+          "deltaApply: _l3Open of %s failed, ", tmpDataObjInfo->filePath);
+        return (destL3descInx);
+    }
+    if (dataObjInp->offset > 0) {
+        /* the earlier calls must have written exactly up to offset */
+        rodsLong_t curSize = _l3Lseek (rsComm, rescTypeInx, destL3descInx,
+          0, SEEK_END);
+        if (curSize != dataObjInp->offset) {
+            rodsLog (LOG_ERROR,
+              "deltaApply: %s has %lld bytes, not %lld",
+              tmpDataObjInfo->filePath, curSize, dataObjInp->offset);
+            _l3Close (rsComm, rescTypeInx, destL3descInx);
+            return (curSize < 0 ? (int) curSize : SYS_COPY_LEN_ERR);
+        }
+    }
+    srcL3descInx = _l3Open (rsComm, dataObjInfo, 0, O_RDONLY);
+    if (srcL3descInx < 0) {
+        rodsLogError (LOG_ERROR, srcL3descInx,
+          "deltaApply: _l3Open of %s failed, ", dataObjInfo->filePath);
+        _l3Close (rsComm, rescTypeInx, destL3descInx);
+        return (srcL3descInx);
+    }
+
+    ptr = (unsigned char *) deltaBBuf->buf;
+    endPtr = ptr + deltaBBuf->len;
+    while (status >= 0 && ptr < endPtr) {
+        int op, len;
+        if (endPtr - ptr < DELTA_DATA_REC_LEN) {
+            status = SYS_INVALID_INPUT_PARAM;
+            break;
+        }
+        op = getDeltaInt (ptr);
+        if (op == DELTA_DATA_REC) {
+            len = getDeltaInt (ptr + 4);
+            ptr += DELTA_DATA_REC_LEN;
+            if (len < 0 || len > endPtr - ptr) {
+                status = SYS_INVALID_INPUT_PARAM;
+                break;
+            }
+            status = _l3Write (rsComm, rescTypeInx, destL3descInx, ptr, len);
+            if (status >= 0 && status != len) status = SYS_COPY_LEN_ERR;
+            ptr += len;
+        } else if (op == DELTA_COPY_REC &&
+          endPtr - ptr >= DELTA_COPY_REC_LEN) {
+            int blockInx = getDeltaInt (ptr + 4);
+            int count = getDeltaInt (ptr + 8);
+            rodsLong_t offset, toCopy;
+            ptr += DELTA_COPY_REC_LEN;
+            if (blockInx < 0 || count <= 0 || blockInx > numBlocks - count) {
+                status = SYS_INVALID_INPUT_PARAM;
+                break;
+            }
+            offset = (rodsLong_t) blockInx * blockSize;
+            toCopy = (rodsLong_t) count * blockSize;
+            if (offset + toCopy > dataSize) toCopy = dataSize - offset;
+            if (offset != srcOffset) {
+                srcOffset = _l3Lseek (rsComm, rescTypeInx, srcL3descInx,
+                  offset, SEEK_SET);
+                if (srcOffset != offset) {
+                    status = srcOffset < 0 ? (int) srcOffset :
+                      SYS_COPY_LEN_ERR;
+                    break;
+                }
+            }
+            if (buf == NULL) buf = (unsigned char *) malloc (DELTA_CHUNK_SIZE);
+            while (toCopy > 0) {
+                int n = toCopy < DELTA_CHUNK_SIZE ?
+                  (int) toCopy : DELTA_CHUNK_SIZE;
+                len = deltaReadFull (rsComm, rescTypeInx, srcL3descInx,
+                  buf, n);
+                if (len != n) {
+                    status = len < 0 ? len : SYS_COPY_LEN_ERR;
+                    break;
+                }
+                status = _l3Write (rsComm, rescTypeInx, destL3descInx, buf, n);
+                if (status < 0) break;
+                if (status != n) {
+                    status = SYS_COPY_LEN_ERR;
+                    break;
+                }
+                srcOffset += n;
+                toCopy -= n;
+            }
+        } else {
+            status = SYS_INVALID_INPUT_PARAM;
+        }
+    }
+    if (buf != NULL) free (buf);
+    _l3Close (rsComm, rescTypeInx, srcL3descInx);
+    _l3Close (rsComm, rescTypeInx, destL3descInx);
+
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "deltaApply: apply to %s at %lld failed, ", dataObjInfo->objPath,
+          dataObjInp->offset);
+        return (status);
+    }
+    return (0);
+}
+
+/* deltaCommit - check the size and checksum of the tmp file, rename it
+ * over the replica and register the new size and checksum. The other
+ * replicas become stale. */
+static int
+deltaCommit (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
+dataObjInfo_t *dataObjInfo, dataObjInfo_t *tmpDataObjInfo)
+{
+    rodsStat_t *myStat = NULL;
+    char *inpChksum, *chksumStr;
+    modDataObjMeta_t modDataObjMetaInp;
+    keyValPair_t regParam;
+    char tmpStr[MAX_NAME_LEN];
+    int status;
+
+    if ((inpChksum = getValByKey (&dataObjInp->condInput, CHKSUM_KW)) == NULL)
+        return (SYS_INVALID_INPUT_PARAM);
+
+    status = l3Stat (rsComm, tmpDataObjInfo, &myStat);
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "deltaCommit: l3Stat of %s failed, ", tmpDataObjInfo->filePath);
+        return (status);
+    }
+    if (myStat->st_size != dataObjInp->dataSize) {
+        rodsLog (LOG_ERROR,
+          "deltaCommit: %s has %lld bytes, not %lld",
+          tmpDataObjInfo->filePath, myStat->st_size, dataObjInp->dataSize);
+        free (myStat);
+        return (SYS_COPY_LEN_ERR);
+    }
+    free (myStat);
+
+    /* the input chksum selects the hash scheme */
+    chksumStr = inpChksum;
+    status = _dataObjChksum (rsComm, tmpDataObjInfo, &chksumStr);
+    if (status < 0 || chksumStr == inpChksum) {
+        rodsLogError (LOG_ERROR, status,
+          "deltaCommit: _dataObjChksum of %s failed, ",
+          tmpDataObjInfo->filePath);
+        return (status < 0 ? status : SYS_INTERNAL_NULL_INPUT_ERR);
+    }
+    if (strcmp (chksumStr, inpChksum) != 0) {
+        rodsLog (LOG_ERROR,
+          "deltaCommit: chksum %s of %s != input chksum %s",
+          chksumStr, dataObjInfo->objPath, inpChksum);
+        free (chksumStr);
+        return (USER_CHKSUM_MISMATCH);
+    }
+
+    status = l3Rename (rsComm, tmpDataObjInfo, dataObjInfo->filePath);
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "deltaCommit: l3Rename of %s failed, ", tmpDataObjInfo->filePath);
+        free (chksumStr);
+        return (status);
+    }
+
+    memset (&regParam, 0, sizeof (regParam));
+    snprintf (tmpStr, MAX_NAME_LEN, "%lld", dataObjInp->dataSize);
+    addKeyVal (&regParam, DATA_SIZE_KW, tmpStr);
+    addKeyVal (&regParam, CHKSUM_KW, chksumStr);
+    addKeyVal (&regParam, ALL_REPL_STATUS_KW, tmpStr);
+    snprintf (tmpStr, MAX_NAME_LEN, "%d", (int) time (NULL));
+    addKeyVal (&regParam, DATA_MODIFY_KW, tmpStr);
+    modDataObjMetaInp.dataObjInfo = dataObjInfo;
+    modDataObjMetaInp.regParam = &regParam;
+    status = rsModDataObjMeta (rsComm, &modDataObjMetaInp);
+    clearKeyVal (&regParam);
+
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "deltaCommit: rsModDataObjMeta of %s failed, ",
+          dataObjInfo->objPath);
+    } else {
+        /* for the post processing rule */
+        dataObjInfo->dataSize = dataObjInp->dataSize;
+        rstrcpy (dataObjInfo->chksum, chksumStr, CHKSUM_LEN);
+    }
+    free (chksumStr);
+    return (status);
+}
+
+int
+_rsDataObjDelta (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
+bytesBuf_t *deltaBBuf, bytesBuf_t *sigBBuf)
+{
+    dataObjInfo_t *dataObjInfoHead = NULL;
+    dataObjInfo_t *dataObjInfo;
+    dataObjInfo_t tmpDataObjInfo;
+    ruleExecInfo_t rei;
+    int status;
+
+    if (dataObjInp->oprType != DELTA_SIG_OPR &&
+      getValByKey (&dataObjInp->condInput, REPL_NUM_KW) == NULL) {
+        return (SYS_INVALID_INPUT_PARAM);
+    }
+
+    /* the replica is updated. Check the write permission */
+    dataObjInp->openFlags = O_WRONLY;
+    status = getDataObjInfoIncSpecColl (rsComm, dataObjInp, &dataObjInfoHead);
+    if (status < 0) return (status);
+
+    status = sortObjInfoForOpen (rsComm, &dataObjInfoHead,
+      &dataObjInp->condInput, 1);
+    if (status < 0) {
+        freeAllDataObjInfo (dataObjInfoHead);
+        return (status);
+    }
+
+    if ((dataObjInp->oprType == DELTA_APPLY_OPR && dataObjInp->offset == 0) ||
+      dataObjInp->oprType == DELTA_COMMIT_OPR) {
+        status = applyPreprocRuleForOpen (rsComm, dataObjInp,
+          &dataObjInfoHead);
+        if (status < 0) {
+            freeAllDataObjInfo (dataObjInfoHead);
+            return (status);
+        }
+    }
+
+    /* only the plain file replica of a cache class resource */
+    dataObjInfo = dataObjInfoHead;
+    tmpDataObjInfo = *dataObjInfo;
+    tmpDataObjInfo.next = NULL;
+    if (dataObjInfo->specColl != NULL ||
+      getRescClass (dataObjInfo->rescInfo) != CACHE_CL ||
+      RescTypeDef[dataObjInfo->rescInfo->rescTypeInx].rescCat != FILE_CAT ||
+      snprintf (tmpDataObjInfo.filePath, MAX_NAME_LEN, "%s%s",
+      dataObjInfo->filePath, DELTA_TMP_FILE_SUFFIX) >= MAX_NAME_LEN) {
+        freeAllDataObjInfo (dataObjInfoHead);
+        return (SYS_NOT_SUPPORTED);
+    }
+
+    switch (dataObjInp->oprType) {
+      case DELTA_SIG_OPR:
+        status = deltaSig (rsComm, dataObjInfo, sigBBuf);
+        break;
+      case DELTA_APPLY_OPR:
+        status = deltaApply (rsComm, dataObjInp, dataObjInfo,
+          &tmpDataObjInfo, deltaBBuf);
+        break;
+      case DELTA_COMMIT_OPR:
+        status = deltaCommit (rsComm, dataObjInp, dataObjInfo,
+          &tmpDataObjInfo);
+        if (status < 0) {
+            if (status != SYS_INVALID_INPUT_PARAM)
+                l3Unlink (rsComm, &tmpDataObjInfo);
+            break;
+        }
+        initReiWithDataObjInp (&rei, rsComm, dataObjInp);
+        rei.doi = dataObjInfo;
+        rei.status = status;
+        rei.status = applyRule ("acPostProcForPut", NULL, &rei,
+          NO_SAVE_REI);
+        /* doi might have changed */
+        dataObjInfoHead = rei.doi;
+        break;
+      case DELTA_ABORT_OPR:
+        status = l3Unlink (rsComm, &tmpDataObjInfo);
+        break;
+      default:
+        status = SYS_INVALID_INPUT_PARAM;
+        break;
+    }
+    freeAllDataObjInfo (dataObjInfoHead);
+    return (status);
+}
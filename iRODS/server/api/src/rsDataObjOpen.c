@@ -25,6 +25,7 @@
 #include "regDataObj.h"
 #include "dataObjClose.h"
 #include "dataObjRepl.h"
+#include "stageQue.h"
 
 int
 rsDataObjOpen (rsComm_t *rsComm, dataObjInp_t *dataObjInp)
@@ -229,6 +230,9 @@ _rsDataObjOpen (rsComm_t *rsComm, dataObjInp_t *dataObjInp)
             return status;
         }
 	cacheDataObjInfo = dataObjInfoHead;
+	/* the siblings are likely to be read next */
+	queStagePrefetch (rsComm, dataObjInfoHead->objPath,
+	  &dataObjInp->condInput);
     } else if (getValByKey (&dataObjInp->condInput, PURGE_CACHE_KW) != NULL &&
       strlen (dataObjInfoHead->rescGroupName) > 0) {
         if (getRescInGrpByClass (rsComm, dataObjInfoHead->rescGroupName,
@@ -448,6 +452,7 @@ _l3Open (rsComm_t *rsComm, dataObjInfo_t *dataObjInfo, int mode, int flags)
         rstrcpy (fileOpenInp.fileName, dataObjInfo->filePath, MAX_NAME_LEN);
         fileOpenInp.mode = mode;
         fileOpenInp.flags = flags;
+        fileOpenInp.dataSize = dataObjInfo->dataSize;
         l3descInx = rsFileOpen (rsComm, &fileOpenInp);
         break;
       default:
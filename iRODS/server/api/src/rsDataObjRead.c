@@ -10,6 +10,9 @@
 #include "rcGlobalExtern.h"
 #include "subStructFileRead.h"  /* XXXXX can be taken out when structFile api done */
 #include "reGlobalsExtern.h"
+#include "dataObjLseek.h"
+#include "fileOpr.h"
+#include "fileDriver.h"
 
 int
 applyRuleForPostProcForRead(rsComm_t *rsComm, bytesBuf_t *dataObjReadOutBBuf, char *objPath)
@@ -172,6 +175,49 @@ void *buf, int len)
     return (bytesRead);
 }
 
+/* _l3Pread - read len bytes at offset of the l3 file. A local fd with a
+ * driver doing positional reads is read without touching its offset.
+ * Otherwise this is _l3Lseek + _l3Read.
+ */
+int
+_l3Pread (rsComm_t *rsComm, int rescTypeInx, int l3descInx,
+void *buf, int len, rodsLong_t offset)
+{
+    rodsLong_t lStatus;
+    int bytesRead;
+
+    if (l3HasPio (rescTypeInx, l3descInx) > 0) {
+        bytesRead = filePread (FileDesc[l3descInx].fileType, rsComm,
+          FileDesc[l3descInx].fd, buf, len, offset);
+        return (bytesRead);
+    }
+
+    lStatus = _l3Lseek (rsComm, rescTypeInx, l3descInx, offset, SEEK_SET);
+    if (lStatus < 0) {
+        return ((int) lStatus);
+    }
+    bytesRead = _l3Read (rsComm, rescTypeInx, l3descInx, buf, len);
+    return (bytesRead);
+}
+
+/* l3HasPio - return 1 if l3descInx is a local file whose driver does
+ * positional I/O, i.e. several threads may share it through _l3Pread
+ * and _l3Pwrite.
+ */
+int
+l3HasPio (int rescTypeInx, int l3descInx)
+{
+    rodsServerHost_t *rodsServerHost;
+
+    if (rescTypeInx < 0 || RescTypeDef[rescTypeInx].rescCat != FILE_CAT) {
+        return (0);
+    }
+    if (getServerHostByFileInx (l3descInx, &rodsServerHost) != LOCAL_HOST) {
+        return (0);
+    }
+    return (fileHasPio (FileDesc[l3descInx].fileType));
+}
+
 #ifdef COMPAT_201
 int
 rsDataObjRead201 (rsComm_t *rsComm, dataObjReadInp_t *dataObjReadInp,
@@ -33,6 +33,16 @@ rsDataObjRename (rsComm_t *rsComm, dataObjCopyInp_t *dataObjRenameInp)
     srcDataObjInp = &dataObjRenameInp->srcDataObjInp;
     destDataObjInp = &dataObjRenameInp->destDataObjInp;
 
+    if (getValByKey (&srcDataObjInp->condInput, NO_PHY_PATH_SYNC_KW) != NULL &&
+      RsApiTable[rsComm->apiInx].apiNumber == DATA_OBJ_RENAME_AN &&
+      rsComm->proxyUser.authInfo.authFlag < LOCAL_PRIV_USER_AUTH) {
+	/* only set by rsMvCollToTrash, not by a client */
+	rmKeyVal (&srcDataObjInp->condInput, NO_PHY_PATH_SYNC_KW);
+    }
+
+    /* a coll rename changes the path of everything under it */
+    invalidateDataObjInfoCache (NULL);
+
     /* don't translate the link pt. treat it as a normal collection */
     addKeyVal (&srcDataObjInp->condInput, NO_TRANSLATE_LINKPT_KW, "");
     resolveLinkedPath (rsComm, srcDataObjInp->objPath, &specCollCache,
@@ -155,6 +165,7 @@ _rsDataObjRename (rsComm_t *rsComm, dataObjCopyInp_t *dataObjRenameInp)
     int multiCopyFlag;
     int renameFlag = 0;
     int acPreProcFromRenameFlag = 0;
+    int lazySyncFlag = 0;
 
     char *args[MAX_NUM_OF_ARGS_IN_ACTION];
     int i, argc;
@@ -325,6 +336,14 @@ _rsDataObjRename (rsComm_t *rsComm, dataObjCopyInp_t *dataObjRenameInp)
 	        status = syncDataObjPhyPath (rsComm, destDataObjInp,
 		  dataObjInfoHead, NULL);
 		freeAllDataObjInfo (dataObjInfoHead);
+	    } else if (getValByKey (&srcDataObjInp->condInput,
+	      NO_PHY_PATH_SYNC_KW) != NULL) {
+		/* e.g. moved to trash. The vault files stay where they are
+		 * until they are deleted */
+	    } else if (isLazyCollPhyPath () > 0) {
+		/* only the catalog is renamed now. The vault files are
+		 * moved by the irodsReServer after the commit */
+		lazySyncFlag = 1;
 	    } else {
                 status = syncCollPhyPath (rsComm, destDataObjInp->objPath);
 	    }
@@ -333,6 +352,10 @@ _rsDataObjRename (rsComm_t *rsComm, dataObjCopyInp_t *dataObjRenameInp)
             } else {
                 chlRollback (rsComm);
             }
+	    if (status >= 0 && lazySyncFlag > 0) {
+		/* the files stay readable at their old path if this fails */
+		queSyncCollPhyPath (rsComm, destDataObjInp->objPath);
+	    }
 	}
 	if (status >= 0) {
             args[0] = srcDataObjInp->objPath;
@@ -26,6 +26,8 @@
 #include "dataObjTrim.h"
 #include "dataObjLock.h"
 #include "miscServerFunct.h"
+#include "stageQue.h"
+#include "replLink.h"
 
 int
 rsDataObjRepl250 (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
@@ -697,6 +699,13 @@ char *rescGroupName, dataObjInfo_t *inpDestDataObjInfo, int updateFlag)
     l1DataObjInp->numThreads = dataObjInp->numThreads =
       getNumThreads (rsComm, l1DataObjInp->dataSize, l1DataObjInp->numThreads, 
       &dataObjInp->condInput, destRescName, srcRescName);
+    if (l1DataObjInp->numThreads > 0 && isReplAutoThreads () > 0 &&
+      srcDataObjInfo != NULL) {
+        /* the no. of streams from the RTT and bandwidth of the link */
+        l1DataObjInp->numThreads = dataObjInp->numThreads =
+          getReplNumThreads (rsComm, srcDataObjInfo->rescInfo, 
+          destRescInfo, l1DataObjInp->dataSize, l1DataObjInp->numThreads);
+    }
     if ((l1DataObjInp->numThreads > 0 || 
       l1DataObjInp->dataSize > MAX_SZ_FOR_SINGLE_BUF) &&
       L1desc[destL1descInx].stageFlag == NO_STAGING) {
@@ -779,6 +788,7 @@ dataObjCopy (rsComm_t *rsComm, int l1descInx)
     dataCopyInp_t dataCopyInp;
     dataOprInp_t *dataOprInp;
     int srcRemoteFlag, destRemoteFlag;
+    struct timeval startTime;
 
     bzero (&dataCopyInp, sizeof (dataCopyInp));
     dataOprInp = &dataCopyInp.dataOprInp;
@@ -893,12 +903,21 @@ dataObjCopy (rsComm_t *rsComm, int l1descInx)
 	      dataCopyInp.portalOprOut.numThreads = 1;
 	}
     }
+    (void) gettimeofday (&startTime, (struct timezone *) 0);
     status =  rsDataCopy (rsComm, &dataCopyInp);
 
     if (status >= 0 && portalOprOut != NULL && 
       L1desc[l1descInx].dataObjInp != NULL) {
 	/* update numThreads since it could be chnages by remote server */ 
         L1desc[l1descInx].dataObjInp->numThreads = portalOprOut->numThreads;
+	if (srcRemoteFlag != REMOTE_ZONE_HOST && 
+	  destRemoteFlag != REMOTE_ZONE_HOST && isReplAutoThreads () > 0) {
+	    recordReplXfer (rsComm, 
+	      L1desc[srcL1descInx].dataObjInfo->rescInfo,
+	      L1desc[destL1descInx].dataObjInfo->rescInfo,
+	      L1desc[srcL1descInx].dataSize, portalOprOut->numThreads,
+	      &startTime);
+	}
     }
     if (portalOprOut != NULL) free (portalOprOut);
     clearKeyVal (&dataOprInp->condInput);
@@ -1187,6 +1206,7 @@ dataObjInfo_t *outCacheObjInfo)
     transferStat_t transStat;
     dataObjInp_t dataObjInp;
     char tmpStr[NAME_LEN];
+    int lockFd, slotFd;
 
     if (getRescClass (compObjInfo->rescInfo) != COMPOUND_CL) return 0;
 
@@ -1200,6 +1220,18 @@ dataObjInfo_t *outCacheObjInfo)
     }
     if (outCacheObjInfo != NULL)
         memset (outCacheObjInfo, 0, sizeof (dataObjInfo_t));
+
+    /* only one agent stages a given object. The others wait for it and
+     * use its cache copy */
+    lockFd = lockStageObj (compObjInfo->objPath);
+    if (lockFd >= 0 && getStagedCacheCopy (rsComm, compObjInfo->objPath,
+      cacheResc->rescName, outCacheObjInfo) > 0) {
+        releaseStageLock (lockFd);
+        return 0;
+    }
+    /* bound the concurrent stages from the compound resource */
+    slotFd = getStageSlot (compObjInfo->rescName);
+
     memset (&dataObjInp, 0, sizeof (dataObjInp_t));
     memset (&transStat, 0, sizeof (transStat));
 
@@ -1211,6 +1243,8 @@ dataObjInfo_t *outCacheObjInfo)
     status = _rsDataObjRepl (rsComm, &dataObjInp, &transStat,
       outCacheObjInfo);
 
+    releaseStageLock (slotFd);
+    releaseStageLock (lockFd);
     clearKeyVal (&dataObjInp.condInput);
     return status;
 }
@@ -11,6 +11,9 @@
 #include "rcGlobalExtern.h"
 #include "subStructFileRead.h"  /* XXXXX can be taken out when structFile api done */
 #include "reGlobalsExtern.h"
+#include "dataObjLseek.h"
+#include "dataObjRead.h"
+#include "fileDriver.h"
 
 int
 applyRuleForPostProcForWrite(rsComm_t *rsComm, bytesBuf_t *dataObjWriteInpBBuf, char *objPath)
@@ -173,6 +176,29 @@ void *buf, int len)
     return (bytesWritten);
 }
 
+/* _l3Pwrite - write len bytes at offset of the l3 file. See _l3Pread.
+ */
+int
+_l3Pwrite (rsComm_t *rsComm, int rescTypeInx, int l3descInx,
+void *buf, int len, rodsLong_t offset)
+{
+    rodsLong_t lStatus;
+    int bytesWritten;
+
+    if (l3HasPio (rescTypeInx, l3descInx) > 0) {
+        bytesWritten = filePwrite (FileDesc[l3descInx].fileType, rsComm,
+          FileDesc[l3descInx].fd, buf, len, offset);
+        return (bytesWritten);
+    }
+
+    lStatus = _l3Lseek (rsComm, rescTypeInx, l3descInx, offset, SEEK_SET);
+    if (lStatus < 0) {
+        return ((int) lStatus);
+    }
+    bytesWritten = _l3Write (rsComm, rescTypeInx, l3descInx, buf, len);
+    return (bytesWritten);
+}
+
 #ifdef COMPAT_201
 int
 rsDataObjWrite201 (rsComm_t *rsComm, dataObjWriteInp_t *dataObjWriteInp,
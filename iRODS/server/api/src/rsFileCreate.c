@@ -10,6 +10,7 @@
 #include "miscServerFunct.h"
 #include "dataObjOpr.h"
 #include "physPath.h"
+#include "rescLoad.h"
 
 int
 rsFileCreate (rsComm_t *rsComm, fileCreateInp_t *fileCreateInp)
@@ -43,6 +44,9 @@ rsFileCreate (rsComm_t *rsComm, fileCreateInp_t *fileCreateInp)
     fileInx = allocAndFillFileDesc (rodsServerHost, fileCreateInp->fileName,
       fileCreateInp->fileType, fd, 
       fileCreateInp->mode);
+    if (remoteFlag == LOCAL_HOST) {
+	rescLoadFileDescStart (fileInx, fileCreateInp->dataSize);
+    }
 
     return (fileInx);
 }
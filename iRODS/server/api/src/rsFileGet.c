@@ -5,6 +5,7 @@
 
 #include "fileGet.h"
 #include "miscServerFunct.h"
+#include "rescLoad.h"
 
 /* rsFileGet - Get the content of a small file into a single buffer
  * in fileGetOutBBuf->buf.
@@ -21,7 +22,9 @@ bytesBuf_t *fileGetOutBBuf)
 
     remoteFlag = resolveHost (&fileGetInp->addr, &rodsServerHost);
     if (remoteFlag == LOCAL_HOST) {
+        rescLoadXferStart (fileGetInp->dataSize);
         status = _rsFileGet (rsComm, fileGetInp, fileGetOutBBuf);
+        rescLoadXferEnd (fileGetInp->dataSize);
     } else if (remoteFlag == REMOTE_HOST) {
         status = remoteFileGet (rsComm, fileGetInp, fileGetOutBBuf, 
           rodsServerHost);
@@ -0,0 +1,78 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* This is script-generated code (for the most part).  */
+/* See fileGetLoad.h for a description of this API call.*/
+
+#include "fileGetLoad.h"
+#include "miscServerFunct.h"
+#include "rescLoad.h"
+
+int
+rsFileGetLoad (rsComm_t *rsComm, fileGetLoadInp_t *fileGetLoadInp,
+fileGetLoadOut_t **fileGetLoadOut)
+{
+    rodsServerHost_t *rodsServerHost;
+    int remoteFlag;
+    int status;
+
+    *fileGetLoadOut = NULL;
+
+    remoteFlag = resolveHost (&fileGetLoadInp->addr, &rodsServerHost);
+    if (remoteFlag == LOCAL_HOST) {
+        status = _rsFileGetLoad (rsComm, fileGetLoadInp, fileGetLoadOut);
+    } else if (remoteFlag == REMOTE_HOST) {
+        status = remoteFileGetLoad (rsComm, fileGetLoadInp, fileGetLoadOut,
+          rodsServerHost);
+    } else {
+        if (remoteFlag < 0) {
+            return (remoteFlag);
+        } else {
+            rodsLog (LOG_NOTICE,
+              "rsFileGetLoad: resolveHost returned unrecognized value %d",
+               remoteFlag);
+            return (SYS_UNRECOGNIZED_REMOTE_FLAG);
+        }
+    }
+
+    return (status);
+}
+
+int
+remoteFileGetLoad (rsComm_t *rsComm, fileGetLoadInp_t *fileGetLoadInp,
+fileGetLoadOut_t **fileGetLoadOut, rodsServerHost_t *rodsServerHost)
+{
+    int status;
+
+    if (rodsServerHost == NULL) {
+        rodsLog (LOG_NOTICE,
+          "remoteFileGetLoad: Invalid rodsServerHost");
+        return SYS_INVALID_SERVER_HOST;
+    }
+
+    if ((status = svrToSvrConnect (rsComm, rodsServerHost)) < 0) {
+        return status;
+    }
+
+    status = rcFileGetLoad (rodsServerHost->conn, fileGetLoadInp,
+      fileGetLoadOut);
+
+    /* an older server does not know the API. Not worth a notice */
+    if (status < 0 && status != SYS_UNMATCHED_API_NUM) {
+        rodsLog (LOG_NOTICE,
+         "remoteFileGetLoad: rcFileGetLoad failed for %s, status = %d",
+          fileGetLoadInp->fileName, status);
+    }
+
+    return status;
+}
+
+int
+_rsFileGetLoad (rsComm_t *rsComm, fileGetLoadInp_t *fileGetLoadInp,
+fileGetLoadOut_t **fileGetLoadOut)
+{
+    *fileGetLoadOut = (fileGetLoadOut_t*)malloc (sizeof (fileGetLoadOut_t));
+    getLocalRescLoad (rsComm, fileGetLoadInp->fileType,
+      fileGetLoadInp->fileName, *fileGetLoadOut);
+
+    return (0);
+}
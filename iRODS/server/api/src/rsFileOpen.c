@@ -8,6 +8,7 @@
 #include "fileOpen.h"
 #include "fileOpr.h"
 #include "miscServerFunct.h"
+#include "rescLoad.h"
 
 int
 rsFileOpen (rsComm_t *rsComm, fileOpenInp_t *fileOpenInp)
@@ -63,6 +64,9 @@ rodsServerHost_t *rodsServerHost)
 
     fileInx = allocAndFillFileDesc (rodsServerHost, fileOpenInp->fileName,
       fileOpenInp->fileType, fd, fileOpenInp->mode);
+    if (remoteFlag == LOCAL_HOST) {
+	rescLoadFileDescStart (fileInx, fileOpenInp->dataSize);
+    }
 
     return (fileInx);
 }
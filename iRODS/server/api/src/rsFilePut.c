@@ -7,6 +7,7 @@
 #include "miscServerFunct.h"
 #include "fileCreate.h"
 #include "dataObjOpr.h"
+#include "rescLoad.h"
 
 /* rsFilePut - Put the content of a small file from a single buffer
  * in filePutInpBBuf->buf.
@@ -23,8 +24,10 @@ bytesBuf_t *filePutInpBBuf)
 
     remoteFlag = resolveHost (&filePutInp->addr, &rodsServerHost);
     if (remoteFlag == LOCAL_HOST) {
+        rescLoadXferStart (filePutInpBBuf->len);
         status = _rsFilePut (rsComm, filePutInp, filePutInpBBuf,
 	  rodsServerHost); 
+        rescLoadXferEnd (filePutInpBBuf->len);
     } else if (remoteFlag == REMOTE_HOST) {
         status = remoteFilePut (rsComm, filePutInp, filePutInpBBuf, 
 	  rodsServerHost);
@@ -7,6 +7,7 @@
 #include "specColl.h"
 #include "reGlobalsExtern.h"
 #include "icatHighLevelRoutines.h"
+#include "dataObjOpr.h"
 
 int
 rsModAccessControl (rsComm_t *rsComm, modAccessControlInp_t *modAccessControlInp )
@@ -23,6 +24,8 @@ rsModAccessControl (rsComm_t *rsComm, modAccessControlInp_t *modAccessControlInp
 	modAccessControlInp->path = strdup (newPath);
     }
 
+    /* cached access checks of this path and (recursive) below may change */
+    invalidateDataObjInfoCache (NULL);
     status = getAndConnRcatHost(rsComm, MASTER_RCAT, 
       modAccessControlInp->path, &rodsServerHost);
     if (status < 0) {
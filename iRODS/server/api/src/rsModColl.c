@@ -5,6 +5,7 @@
 
 #include "modColl.h"
 #include "icatHighLevelRoutines.h"
+#include "specColl.h"
 
 int
 rsModColl (rsComm_t *rsComm, collInp_t *modCollInp)
@@ -26,6 +27,12 @@ rsModColl (rsComm_t *rsComm, collInp_t *modCollInp)
     } else {
         status = rcModColl (rodsServerHost->conn, modCollInp);
     }
+    if (status >= 0 && getValByKey (&modCollInp->condInput, 
+      COLLECTION_TYPE_KW) != NULL) {
+        /* a new special collection. The cached paths without one are
+         * no longer reliable */
+        clearNoSpecCollCache ();
+    }
 
     return (status);
 }
@@ -20,6 +20,7 @@ rsModDataObjMeta (rsComm_t *rsComm, modDataObjMeta_t *modDataObjMetaInp)
     regParam = modDataObjMetaInp->regParam;
     dataObjInfo = modDataObjMetaInp->dataObjInfo;
 
+    invalidateDataObjInfoCache (dataObjInfo->objPath);
     status = getAndConnRcatHost (rsComm, MASTER_RCAT, dataObjInfo->objPath,
       &rodsServerHost);
     if (status < 0) {
@@ -75,9 +75,9 @@ ncCloseColl (rsComm_t *rsComm, int l1descInx)
         rodsLogError (LOG_ERROR, status,
          "ncCloseColl: closeAggrFiles error");
     }
+    freeAggrCache (&L1desc[l1descInx].openedAggInfo);
     freeAggInfo (&L1desc[l1descInx].openedAggInfo.ncAggInfo);
     freeNcInqOut (&L1desc[l1descInx].openedAggInfo.ncInqOut0);
-    freeNcInqOut (&L1desc[l1descInx].openedAggInfo.ncInqOut);
 
     bzero (&dataObjCloseInp, sizeof (dataObjCloseInp));
     dataObjCloseInp.l1descInx = l1descInx;
@@ -145,20 +145,24 @@ ncCloseDataObj (rsComm_t *rsComm, int l1descInx)
 int
 closeAggrFiles (rsComm_t *rsComm, int l1descInx)
 {
-    int status;
+    int status, i;
     openedAggInfo_t *openedAggInfo;
     int savedStatus = 0;
 
     openedAggInfo = &L1desc[l1descInx].openedAggInfo;
-    if (openedAggInfo->aggElemetInx > 0 && openedAggInfo->objNcid >= 0) {
-        status = ncCloseDataObj (rsComm, openedAggInfo->objNcid);
+    for (i = 1; openedAggInfo->eleNcid != NULL && 
+      i < openedAggInfo->ncAggInfo->numFiles; i++) {
+        if (openedAggInfo->eleNcid[i] < 0) continue;
+        status = ncCloseDataObj (rsComm, openedAggInfo->eleNcid[i]);
         if (status < 0) {
             rodsLogError (LOG_ERROR, status,
               "closeAggrFiles: rcNcClose error for objNcid %d", 
-              openedAggInfo->objNcid);
+              openedAggInfo->eleNcid[i]);
             savedStatus = status;
         }
+        openedAggInfo->eleNcid[i] = -1;
     }
+    openedAggInfo->numOpenedEle = 0;
     if (openedAggInfo->objNcid0 >= 0) {
         status = ncCloseDataObj (rsComm,  openedAggInfo->objNcid0);
         if (status < 0) {
@@ -168,8 +172,34 @@ closeAggrFiles (rsComm_t *rsComm, int l1descInx)
             savedStatus = status;
         }
     }
-    openedAggInfo->aggElemetInx = openedAggInfo->objNcid = 
-      openedAggInfo->objNcid0 = -1;
+    openedAggInfo->objNcid0 = -1;
     return savedStatus;
 }
 
+/* freeAggrCache - free the element cache of an openedAggInfo. The elements
+ * must have been closed with closeAggrFiles */
+int
+freeAggrCache (openedAggInfo_t *openedAggInfo)
+{
+    int i;
+
+    if (openedAggInfo->eleInqOut != NULL) {
+        for (i = 0; i < openedAggInfo->ncAggInfo->numFiles; i++) {
+            if (openedAggInfo->eleInqOut[i] != NULL)
+                freeNcInqOut (&openedAggInfo->eleInqOut[i]);
+        }
+        free (openedAggInfo->eleInqOut);
+        openedAggInfo->eleInqOut = NULL;
+    }
+    if (openedAggInfo->eleNcid != NULL) {
+        free (openedAggInfo->eleNcid);
+        openedAggInfo->eleNcid = NULL;
+    }
+    if (openedAggInfo->eleLastUse != NULL) {
+        free (openedAggInfo->eleLastUse);
+        openedAggInfo->eleLastUse = NULL;
+    }
+    openedAggInfo->numOpenedEle = 0;
+    return 0;
+}
+
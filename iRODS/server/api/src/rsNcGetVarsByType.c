@@ -12,6 +12,9 @@
 #include "physPath.h"
 #include "specColl.h"
 #include "getRemoteZoneResc.h"
+#ifdef PARA_OPR
+#include <pthread.h>
+#endif
 
 int
 rsNcGetVarsByType (rsComm_t *rsComm, ncGetVarInp_t *ncGetVarInp,
@@ -92,6 +95,205 @@ ncGetVarOut_t **ncGetVarOut)
     return status;
 }
 
+/* the read of an aggregate is split in slices, one per element. Slices
+ * served by the same connection (or all the local ones since the netcdf
+ * lib is not thread safe) form a group which is read by one thread */
+typedef struct NcAggSlice {
+    ncGetVarInp_t ncGetVarInp;
+    void *conn;		/* rcComm_t of the server of the element. NULL -
+			 * local */
+    int group;		/* index of the first slice with the same conn */
+    int len;		/* no. of values */
+    char *bufPos;	/* where the values go in the output buf */
+} ncAggSlice_t;
+
+typedef struct NcAggRead {
+    rsComm_t *rsComm;
+    ncAggSlice_t *slice;
+    int numSlice;
+    int nextGroup;
+    int dataTypeSize;
+    int status;
+    char dataType_PI[NAME_LEN];
+#ifdef PARA_OPR
+    pthread_mutex_t lock;
+#endif
+} ncAggRead_t;
+
+int
+getNcAggNumThreads ()
+{
+    char *tmpStr;
+    int numThreads;
+
+    if ((tmpStr = getenv (NC_AGG_NUM_THREADS_ENV)) == NULL)
+        return DEF_NC_AGG_NUM_THREADS;
+    numThreads = atoi (tmpStr);
+    if (numThreads < 1) {
+        numThreads = 1;
+    } else if (numThreads > MAX_NC_AGG_NUM_THREADS) {
+        numThreads = MAX_NC_AGG_NUM_THREADS;
+    }
+    return numThreads;
+}
+
+static void
+lockAggRead (ncAggRead_t *ncAggRead, int threadFlag)
+{
+#ifdef PARA_OPR
+    if (threadFlag > 0) pthread_mutex_lock (&ncAggRead->lock);
+#endif
+}
+
+static void
+unlockAggRead (ncAggRead_t *ncAggRead, int threadFlag)
+{
+#ifdef PARA_OPR
+    if (threadFlag > 0) pthread_mutex_unlock (&ncAggRead->lock);
+#endif
+}
+
+/* readAggSliceGroup - read the slices of a group into their place in the 
+ * output buf. Each value is freed as soon as it has been copied */
+
+static int
+readAggSliceGroup (ncAggRead_t *ncAggRead, int group, int threadFlag)
+{
+    int k, status;
+    ncAggSlice_t *slice;
+    ncGetVarOut_t *myNcGetVarOut;
+
+    for (k = group; k < ncAggRead->numSlice; k++) {
+        slice = &ncAggRead->slice[k];
+        if (slice->group != group) continue;
+        if (ncAggRead->status < 0) return ncAggRead->status;
+        myNcGetVarOut = NULL;
+        status = rsNcGetVarsByTypeForObj (ncAggRead->rsComm, 
+          &slice->ncGetVarInp, &myNcGetVarOut);
+        if (status < 0) {
+            rodsLogError (LOG_ERROR, status,
+              "readAggSliceGroup: rsNcGetVarsByTypeForObj of ncid %d err",
+              slice->ncGetVarInp.ncid);
+        } else if (myNcGetVarOut != NULL && 
+          myNcGetVarOut->dataArray->len > 0) {
+            if (myNcGetVarOut->dataArray->len > slice->len) {
+                rodsLog (LOG_ERROR,
+                  "readAggSliceGroup: len %d > slice len %d",
+                  myNcGetVarOut->dataArray->len, slice->len);
+                status = NETCDF_VARS_DATA_TOO_BIG;
+            } else {
+                memcpy (slice->bufPos, myNcGetVarOut->dataArray->buf,
+                  myNcGetVarOut->dataArray->len * ncAggRead->dataTypeSize);
+                lockAggRead (ncAggRead, threadFlag);
+                rstrcpy (ncAggRead->dataType_PI, myNcGetVarOut->dataType_PI, 
+                  NAME_LEN);
+                unlockAggRead (ncAggRead, threadFlag);
+            }
+        }
+        if (myNcGetVarOut != NULL) freeNcGetVarOut (&myNcGetVarOut);
+        if (status < 0) {
+            lockAggRead (ncAggRead, threadFlag);
+            ncAggRead->status = status;
+            unlockAggRead (ncAggRead, threadFlag);
+            return status;
+        }
+    }
+    return 0;
+}
+
+/* nextAggSliceGroup - return the next group not taken yet. -1 if none */
+
+static int
+nextAggSliceGroup (ncAggRead_t *ncAggRead, int threadFlag)
+{
+    int group = -1;
+
+    lockAggRead (ncAggRead, threadFlag);
+    while (ncAggRead->nextGroup < ncAggRead->numSlice) {
+        if (ncAggRead->slice[ncAggRead->nextGroup].group == 
+          ncAggRead->nextGroup) {
+            group = ncAggRead->nextGroup;
+            ncAggRead->nextGroup++;
+            break;
+        }
+        ncAggRead->nextGroup++;
+    }
+    unlockAggRead (ncAggRead, threadFlag);
+    return group;
+}
+
+#ifdef PARA_OPR
+static void *
+aggReadWorker (void *arg)
+{
+    ncAggRead_t *ncAggRead = (ncAggRead_t *) arg;
+    int group;
+
+    while ((group = nextAggSliceGroup (ncAggRead, 1)) >= 0) {
+        readAggSliceGroup (ncAggRead, group, 1);
+    }
+    return NULL;
+}
+#endif
+
+/* readAggSlices - read the slices planned by rsNcGetVarsByTypeForColl.
+ * The groups are read in parallel if there are more than one */
+
+static int
+readAggSlices (ncAggRead_t *ncAggRead)
+{
+    int k, numGroups = 0;
+    int numThreads;
+    int group;
+
+    for (k = 0; k < ncAggRead->numSlice; k++) {
+        if (ncAggRead->slice[k].group == k) numGroups++;
+    }
+    numThreads = getNcAggNumThreads ();
+    if (numThreads > numGroups) numThreads = numGroups;
+    ncAggRead->nextGroup = 0;
+#ifdef PARA_OPR
+    if (numThreads > 1) {
+        pthread_t tid[MAX_NC_AGG_NUM_THREADS];
+        int numStarted = 0;
+
+        pthread_mutex_init (&ncAggRead->lock, NULL);
+        for (k = 0; k < numThreads - 1; k++) {
+            if (pthread_create (&tid[numStarted], NULL, aggReadWorker,
+              (void *) ncAggRead) == 0) numStarted++;
+        }
+        /* this thread helps out. It also covers a failed pthread_create */
+        aggReadWorker ((void *) ncAggRead);
+        for (k = 0; k < numStarted; k++) {
+            pthread_join (tid[k], NULL);
+        }
+        pthread_mutex_destroy (&ncAggRead->lock);
+        return ncAggRead->status;
+    }
+#endif
+    while ((group = nextAggSliceGroup (ncAggRead, 0)) >= 0) {
+        if (readAggSliceGroup (ncAggRead, group, 0) < 0) break;
+    }
+    return ncAggRead->status;
+}
+
+static void
+clearAggSlices (ncAggRead_t *ncAggRead)
+{
+    int k;
+
+    for (k = 0; k < ncAggRead->numSlice; k++) {
+        free (ncAggRead->slice[k].ncGetVarInp.start);
+    }
+    ncAggRead->numSlice = 0;
+}
+
+/* rsNcGetVarsByTypeForColl - subset an opened aggregate. The elements in
+ * range are opened (or taken from the element cache of the openedAggInfo)
+ * and a slice of the request is planned for each. The slices are read
+ * in batches of at most ncAggOpenMax elements, so that an element opened
+ * for a batch is never closed by the LRU before it has been read */
+
 int
 rsNcGetVarsByTypeForColl (rsComm_t *rsComm, ncGetVarInp_t *ncGetVarInp,
 ncGetVarOut_t **ncGetVarOut)
@@ -99,40 +301,28 @@ ncGetVarOut_t **ncGetVarOut)
     int i, j, status;
     int l1descInx;
     openedAggInfo_t *openedAggInfo;
-    ncInqInp_t ncInqInp;
-    ncGetVarInp_t myNcGetVarInp;
+    ncInqOut_t *ncInqOut0 = NULL, *ncInqOut;
     rodsLong_t timeStart0, timeEnd0, curPos; 
     rodsLong_t eleStart, eleEnd; 
     int timeInxInVar0; 
-    rodsLong_t start[NC_MAX_DIMS], stride[NC_MAX_DIMS], count[NC_MAX_DIMS];
-    char *buf, *bufPos;
-    int len, eleLen, curLen;
-    ncGetVarOut_t *myNcGetVarOut = NULL;
-    char dataType_PI[NAME_LEN];
+    char *buf;
+    int len, curLen;
     int dataTypeSize;
+    int batchMax, ncid, remoteFlag;
+    char *varName0 = NULL;
+    ncAggSlice_t *slice;
+    ncAggRead_t ncAggRead;
+    rodsServerHost_t *rodsServerHost;
 
     *ncGetVarOut = NULL;
-    *dataType_PI = '\0';
     l1descInx = ncGetVarInp->ncid;
     openedAggInfo = &L1desc[l1descInx].openedAggInfo;
     if (openedAggInfo->objNcid0 == -1) {
         return NETCDF_AGG_ELE_FILE_NOT_OPENED;
     }
-    if (openedAggInfo->ncInqOut0 == NULL) {
-        bzero (&ncInqInp, sizeof (ncInqInp));
-        ncInqInp.ncid = openedAggInfo->objNcid0;
-        ncInqInp.paramType = NC_ALL_TYPE;
-        ncInqInp.flags = NC_ALL_FLAG;
-        status = rsNcInqDataObj (rsComm, &ncInqInp, &openedAggInfo->ncInqOut0);
-        if (status < 0) {
-            rodsLogError (LOG_ERROR, status,
-              "rsNcGetVarsByTypeForColl: rsNcInqDataObj for %s error",
-              openedAggInfo->ncAggInfo->ncObjectName);
-            return status;
-        }
-    }
-    timeInxInVar0 = getTimeInxInVar (openedAggInfo->ncInqOut0, 
-      ncGetVarInp->varid);
+    status = inqAggrFile (rsComm, l1descInx, 0, &ncInqOut0);
+    if (status < 0) return status;
+    timeInxInVar0 = getTimeInxInVar (ncInqOut0, ncGetVarInp->varid);
 
     if (timeInxInVar0 < 0) {
         /* no time dim */
@@ -146,140 +336,158 @@ ncGetVarOut_t **ncGetVarOut)
         timeStart0 = curPos = ncGetVarInp->start[timeInxInVar0];
         timeEnd0 = timeStart0 + ncGetVarInp->count[timeInxInVar0] - 1;
     }
-    eleStart = 0;
-    myNcGetVarInp = *ncGetVarInp;
-    bzero (start, sizeof (char) * NC_MAX_DIMS);
-    bzero (count, sizeof (char) * NC_MAX_DIMS);
-    bzero (stride, sizeof (char) * NC_MAX_DIMS);
-    myNcGetVarInp.start = start;
-    myNcGetVarInp.count = count;
-    myNcGetVarInp.stride = stride;
-    for (i = 0; i < ncGetVarInp->ndim; i++) {
-         myNcGetVarInp.start[i] = ncGetVarInp->start[i];
-         myNcGetVarInp.stride[i] = ncGetVarInp->stride[i];
-         myNcGetVarInp.count[i] = ncGetVarInp->count[i];
-    }
+    /* varid can be different than ele 0. Map it by name */
+    for (j = 0; j < ncInqOut0->nvars; j++) {
+        if (ncInqOut0->var[j].id == ncGetVarInp->varid) {
+            varName0 = ncInqOut0->var[j].name;
+            break;
+        }
+    } 
+    if (varName0 == NULL) return NETCDF_DEF_VAR_ERR;
+
     len = getSizeForGetVars (ncGetVarInp);
     if (len <= 0) return len;
     dataTypeSize = getDataTypeSize (ncGetVarInp->dataType);
     if (dataTypeSize < 0) return dataTypeSize;
-    buf = bufPos = (char *) calloc (len, dataTypeSize);
+    buf = (char *) calloc (len, dataTypeSize);
+    batchMax = getNcAggOpenMax ();
+
+    bzero (&ncAggRead, sizeof (ncAggRead));
+    ncAggRead.rsComm = rsComm;
+    ncAggRead.dataTypeSize = dataTypeSize;
+    ncAggRead.slice = (ncAggSlice_t *) calloc (batchMax, 
+      sizeof (ncAggSlice_t));
+    eleStart = 0;
     curLen = 0;
     for (i = 0; i < openedAggInfo->ncAggInfo->numFiles; i++) {
         eleEnd = eleStart + 
           openedAggInfo->ncAggInfo->ncAggElement[i].arraylen - 1;
         if (curPos >= eleStart && curPos <= eleEnd) {
             /* in range */
-            if (i != 0 && i != openedAggInfo->aggElemetInx) {
-                status = openAggrFile (rsComm, l1descInx, i);
-                if (status < 0) {
-                    free (buf);
-                    return status;
-                }
-                bzero (&ncInqInp, sizeof (ncInqInp));
-                ncInqInp.ncid = openedAggInfo->objNcid;
-                ncInqInp.paramType = NC_ALL_TYPE;
-                ncInqInp.flags = NC_ALL_FLAG;
-                status = rsNcInqDataObj (rsComm, &ncInqInp, 
-                  &openedAggInfo->ncInqOut);
-                if (status < 0) {
-                    rodsLogError (LOG_ERROR, status,
-                      "rsNcGetVarsByTypeForColl: rsNcInqDataObj error for %s",
-                      openedAggInfo->ncAggInfo->ncObjectName);
-                    free (buf);
-                    return status;
-                }
+            slice = &ncAggRead.slice[ncAggRead.numSlice];
+            slice->ncGetVarInp = *ncGetVarInp;
+            bzero (&slice->ncGetVarInp.condInput, sizeof (keyValPair_t));
+            slice->ncGetVarInp.start = (rodsLong_t *) 
+              calloc (3 * ncGetVarInp->ndim + 1, sizeof (rodsLong_t));
+            slice->ncGetVarInp.count = slice->ncGetVarInp.start + 
+              ncGetVarInp->ndim;
+            slice->ncGetVarInp.stride = slice->ncGetVarInp.count + 
+              ncGetVarInp->ndim;
+            ncAggRead.numSlice++;
+            for (j = 0; j < ncGetVarInp->ndim; j++) {
+                slice->ncGetVarInp.start[j] = ncGetVarInp->start[j];
+                slice->ncGetVarInp.stride[j] = ncGetVarInp->stride[j];
+                slice->ncGetVarInp.count[j] = ncGetVarInp->count[j];
             }
             if (i != 0) {
-                char *varName0 = NULL;
-                myNcGetVarInp.ncid =  openedAggInfo->objNcid;
-                /* varid can be different than ele 0 */
-                for (j = 0; j < openedAggInfo->ncInqOut0->nvars; j++) {
-                    if (openedAggInfo->ncInqOut0->var[j].id == 
-                      ncGetVarInp->varid) {
-                        varName0 = openedAggInfo->ncInqOut0->var[j].name;
-                        break;
-                    }
-                } 
-                if (varName0 == NULL) {
-                    free (buf);
-                    return NETCDF_DEF_VAR_ERR;
-                }
-                myNcGetVarInp.varid = -1;
-                for (j = 0; j < openedAggInfo->ncInqOut0->nvars; j++) {
-                    if (strcmp (varName0, 
-                      openedAggInfo->ncInqOut0->var[j].name) == 0) {
-                        myNcGetVarInp.varid = 
-                          openedAggInfo->ncInqOut0->var[j].id;
+                status = openAggrFile (rsComm, l1descInx, i);
+                if (status < 0) break;
+                status = inqAggrFile (rsComm, l1descInx, i, &ncInqOut);
+                if (status < 0) break;
+                slice->ncGetVarInp.ncid = ncid = openedAggInfo->eleNcid[i];
+                slice->ncGetVarInp.varid = -1;
+                for (j = 0; j < ncInqOut->nvars; j++) {
+                    if (strcmp (varName0, ncInqOut->var[j].name) == 0) {
+                        slice->ncGetVarInp.varid = ncInqOut->var[j].id;
                         break;
                     }
                 }
-                if (myNcGetVarInp.varid == -1) {
-                    free (buf);
-                    return NETCDF_DEF_VAR_ERR;
+                if (slice->ncGetVarInp.varid == -1) {
+                    status = NETCDF_DEF_VAR_ERR;
+                    break;
                 }
             } else {
-                myNcGetVarInp.ncid =  openedAggInfo->objNcid0;
+                slice->ncGetVarInp.ncid = ncid = openedAggInfo->objNcid0;
             }
             /* adjust the start, count */ 
             if (timeInxInVar0 >= 0) {
-                myNcGetVarInp.start[timeInxInVar0] = curPos - eleStart;
+                slice->ncGetVarInp.start[timeInxInVar0] = curPos - eleStart;
                 if (timeEnd0 >= eleEnd) {
-                    myNcGetVarInp.count[timeInxInVar0] = eleEnd - curPos + 1;
+                    slice->ncGetVarInp.count[timeInxInVar0] = 
+                      eleEnd - curPos + 1;
                 } else {
-                    myNcGetVarInp.count[timeInxInVar0] = timeEnd0 - curPos + 1;
+                    slice->ncGetVarInp.count[timeInxInVar0] = 
+                      timeEnd0 - curPos + 1;
                 }
                 /* adjust curPos. need to take stride into account */
-                curPos += myNcGetVarInp.count[timeInxInVar0];
-                if (myNcGetVarInp.stride[timeInxInVar0] > 0) { 
-                    int mystride = myNcGetVarInp.stride[timeInxInVar0];
+                curPos += slice->ncGetVarInp.count[timeInxInVar0];
+                if (slice->ncGetVarInp.stride[timeInxInVar0] > 0) { 
+                    int mystride = slice->ncGetVarInp.stride[timeInxInVar0];
                     int remaine = curPos % mystride;
                     if (remaine > 0) {
                         curPos = (curPos / mystride) * (mystride + 1);
                     }
                 }
             }
-            eleLen = getSizeForGetVars (&myNcGetVarInp);
-            status = rsNcGetVarsByTypeForObj (rsComm, &myNcGetVarInp,
-             &myNcGetVarOut);
-            if (status < 0) {
-                rodsLogError (LOG_ERROR, status,
-                "rsNcGetVarsByTypeForColl: rsNcGetVarsByTypeForObj %s err",
-                  openedAggInfo->ncAggInfo->ncObjectName);
-                free (buf);
-                return status;
+            slice->len = getSizeForGetVars (&slice->ncGetVarInp);
+            if (slice->len < 0) {
+                status = slice->len;
+                break;
+            }
+            if (curLen + slice->len > len) {
+                rodsLog (LOG_ERROR,
+                  "rsNcGetVarsByTypeForColl: curLen %d > total len %d",
+                  curLen + slice->len, len);
+                status = NETCDF_VARS_DATA_TOO_BIG;
+                break;
             }
-            if (myNcGetVarOut->dataArray->len > 0) {
-                curLen += myNcGetVarOut->dataArray->len;
-                if (curLen > len) {
-                    rodsLog (LOG_ERROR,
-                      "rsNcGetVarsByTypeForColl: curLen %d > total len %d",
-                      curLen, len);
-                    free (buf);
-                    return NETCDF_VARS_DATA_TOO_BIG;
+            slice->bufPos = buf + (rodsLong_t) curLen * dataTypeSize;
+            curLen += slice->len;
+            /* the connection is made here so that the threads only
+             * use it */
+            if (L1desc[ncid].remoteZoneHost != NULL) {
+                slice->conn = L1desc[ncid].remoteZoneHost->conn;
+            } else {
+                remoteFlag = resoAndConnHostByDataObjInfo (rsComm,
+                  L1desc[ncid].dataObjInfo, &rodsServerHost);
+                if (remoteFlag < 0) {
+                    status = remoteFlag;
+                    break;
+                } else if (remoteFlag == LOCAL_HOST) {
+                    slice->conn = NULL;
+                } else {
+                    slice->conn = rodsServerHost->conn;
+                }
+            }
+            slice->group = ncAggRead.numSlice - 1;
+            for (j = 0; j < ncAggRead.numSlice - 1; j++) {
+                if (ncAggRead.slice[j].conn == slice->conn) {
+                    slice->group = j;
+                    break;
                 }
-                memcpy (bufPos, myNcGetVarOut->dataArray->buf,
-                 myNcGetVarOut->dataArray->len * dataTypeSize);
-                bufPos += myNcGetVarOut->dataArray->len * dataTypeSize;
-                rstrcpy (dataType_PI, myNcGetVarOut->dataType_PI, NAME_LEN);
-                freeNcGetVarOut (&myNcGetVarOut);
+            }
+            if (ncAggRead.numSlice >= batchMax) {
+                status = readAggSlices (&ncAggRead);
+                clearAggSlices (&ncAggRead);
+                if (status < 0) break;
             }
         }
         if (curPos > timeEnd0) break;
         eleStart = eleEnd + 1;
     }
-    if (status >= 0) {
-        if (strlen (dataType_PI) == 0) return status;
-        *ncGetVarOut = (ncGetVarOut_t *) calloc (1, sizeof (ncGetVarOut_t));
-        (*ncGetVarOut)->dataArray = (dataArray_t *) 
-          calloc (1, sizeof (dataArray_t));
-        rstrcpy ((*ncGetVarOut)->dataType_PI, dataType_PI, NAME_LEN);
-        (*ncGetVarOut)->dataArray->len = len;
-        (*ncGetVarOut)->dataArray->type = ncGetVarInp->dataType;
-        (*ncGetVarOut)->dataArray->buf = buf;
-    } else {
+    if (status >= 0 && ncAggRead.numSlice > 0) 
+        status = readAggSlices (&ncAggRead);
+    clearAggSlices (&ncAggRead);
+    free (ncAggRead.slice);
+
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "rsNcGetVarsByTypeForColl: subsetting of %s error",
+          openedAggInfo->ncAggInfo->ncObjectName);
         free (buf);
+        return status;
+    }
+    if (strlen (ncAggRead.dataType_PI) == 0) {
+        free (buf);
+        return status;
     }
+    *ncGetVarOut = (ncGetVarOut_t *) calloc (1, sizeof (ncGetVarOut_t));
+    (*ncGetVarOut)->dataArray = (dataArray_t *) 
+      calloc (1, sizeof (dataArray_t));
+    rstrcpy ((*ncGetVarOut)->dataType_PI, ncAggRead.dataType_PI, NAME_LEN);
+    (*ncGetVarOut)->dataArray->len = len;
+    (*ncGetVarOut)->dataArray->type = ncGetVarInp->dataType;
+    (*ncGetVarOut)->dataArray->buf = buf;
     return status;
 }
 /* _rsNcGetVarsByType has been moved to the client because clients need it */
@@ -187,7 +187,6 @@ rsNcOpenColl (rsComm_t *rsComm, ncOpenInp_t *ncOpenInp, int **ncid)
     if (l1descInx < 0) return l1descInx;
     bzero (&L1desc[l1descInx].openedAggInfo, sizeof (openedAggInfo_t));
     L1desc[l1descInx].openedAggInfo.ncAggInfo = ncAggInfo;
-    L1desc[l1descInx].openedAggInfo.objNcid = -1;	/* not opened */
     L1desc[l1descInx].openedAggInfo.objNcid0 = -1;	/* not opened */
     status = openAggrFile (rsComm, l1descInx, 0);
     if (status < 0) return status;
@@ -205,33 +204,67 @@ openAggrFile (rsComm_t *rsComm, int l1descInx, int aggElemetInx)
     ncCloseInp_t ncCloseInp;
     openedAggInfo_t *openedAggInfo;
     int *ncid = NULL;
+    int i, numFiles, lruInx;
 
     openedAggInfo = &L1desc[l1descInx].openedAggInfo;
-    if (aggElemetInx > 0 && aggElemetInx == openedAggInfo->aggElemetInx) 
-        return 0;
+    numFiles = openedAggInfo->ncAggInfo->numFiles;
+    if (aggElemetInx < 0 || aggElemetInx >= numFiles) {
+        rodsLog (LOG_ERROR,
+          "openAggrFile: aggElemetInx %d out of range for %s",
+          aggElemetInx, openedAggInfo->ncAggInfo->ncObjectName);
+        return SYS_INTERNAL_NULL_INPUT_ERR;
+    }
+    if (aggElemetInx == 0) {
+        if (openedAggInfo->objNcid0 >= 0) return 0;
+    } else {
+        if (openedAggInfo->eleNcid == NULL) {
+            openedAggInfo->eleNcid = (int *) malloc (numFiles * sizeof (int));
+            openedAggInfo->eleLastUse = (int *) 
+              calloc (numFiles, sizeof (int));
+            openedAggInfo->eleInqOut = (ncInqOut_t **) 
+              calloc (numFiles, sizeof (ncInqOut_t *));
+            for (i = 0; i < numFiles; i++) openedAggInfo->eleNcid[i] = -1;
+            openedAggInfo->numOpenedEle = 0;
+        }
+        openedAggInfo->useCnt++;
+        if (openedAggInfo->eleNcid[aggElemetInx] >= 0) {
+            openedAggInfo->eleLastUse[aggElemetInx] = openedAggInfo->useCnt;
+            return 0;
+        }
+        if (openedAggInfo->numOpenedEle >= getNcAggOpenMax ()) {
+            /* close the least recently used element */
+            lruInx = -1;
+            for (i = 1; i < numFiles; i++) {
+                if (openedAggInfo->eleNcid[i] < 0) continue;
+                if (lruInx < 0 || openedAggInfo->eleLastUse[i] < 
+                  openedAggInfo->eleLastUse[lruInx]) lruInx = i;
+            }
+            if (lruInx > 0) {
+                bzero (&ncCloseInp, sizeof (ncCloseInp));
+                ncCloseInp.ncid = openedAggInfo->eleNcid[lruInx];
+                status1 = rsNcClose (rsComm, &ncCloseInp);
+                if (status1 < 0) {
+                    rodsLogError (LOG_ERROR, status1,
+                      "openAggrFile: rcNcClose error for %s", 
+                      openedAggInfo->ncAggInfo->ncAggElement[lruInx].objPath);
+                }
+                openedAggInfo->eleNcid[lruInx] = -1;
+                openedAggInfo->numOpenedEle--;
+            }
+        }
+    }
     bzero (&ncOpenInp, sizeof (ncOpenInp));
     rstrcpy (ncOpenInp.objPath,
       openedAggInfo->ncAggInfo->ncAggElement[aggElemetInx].objPath,
       MAX_NAME_LEN);
     status = rsNcOpenDataObj (rsComm, &ncOpenInp, &ncid);
     if (status >= 0) {
-        if (aggElemetInx > 0 && openedAggInfo->aggElemetInx > 0) {
-            bzero (&ncCloseInp, sizeof (ncCloseInp));
-            ncCloseInp.ncid = openedAggInfo->objNcid;
-            status1 = rsNcClose (rsComm, &ncCloseInp);
-            if (status1 < 0) {
-                rodsLogError (LOG_ERROR, status1,
-                  "openAndInqAggrFile: rcNcClose error for %s", 
-                openedAggInfo->ncAggInfo->ncObjectName);
-            }
-            if (openedAggInfo->ncInqOut != NULL) 
-                freeNcInqOut (&openedAggInfo->ncInqOut);
-        }
         if (aggElemetInx == 0) {
             openedAggInfo->objNcid0 = *ncid;
         } else {
-            openedAggInfo->objNcid = *ncid;
-            openedAggInfo->aggElemetInx = aggElemetInx;
+            openedAggInfo->eleNcid[aggElemetInx] = *ncid;
+            openedAggInfo->eleLastUse[aggElemetInx] = openedAggInfo->useCnt;
+            openedAggInfo->numOpenedEle++;
         }
         free (ncid);
     } else {
@@ -243,3 +276,59 @@ openAggrFile (rsComm_t *rsComm, int l1descInx, int aggElemetInx)
     return status;
 }
 
+/* inqAggrFile - return in ncInqOut the ncInqOut of the element aggElemetInx
+ * of an opened aggregate. The element must have been opened with
+ * openAggrFile. The ncInqOut is cached in the openedAggInfo and must not
+ * be freed by the caller.
+ */
+int
+inqAggrFile (rsComm_t *rsComm, int l1descInx, int aggElemetInx,
+ncInqOut_t **ncInqOut)
+{
+    int status;
+    ncInqInp_t ncInqInp;
+    openedAggInfo_t *openedAggInfo;
+    ncInqOut_t **cachedInqOut;
+
+    *ncInqOut = NULL;
+    openedAggInfo = &L1desc[l1descInx].openedAggInfo;
+    if (aggElemetInx == 0) {
+        cachedInqOut = &openedAggInfo->ncInqOut0;
+        bzero (&ncInqInp, sizeof (ncInqInp));
+        ncInqInp.ncid = openedAggInfo->objNcid0;
+    } else if (openedAggInfo->eleInqOut != NULL) {
+        cachedInqOut = &openedAggInfo->eleInqOut[aggElemetInx];
+        bzero (&ncInqInp, sizeof (ncInqInp));
+        ncInqInp.ncid = openedAggInfo->eleNcid[aggElemetInx];
+    } else {
+        return NETCDF_AGG_ELE_FILE_NOT_OPENED;
+    }
+    if (*cachedInqOut == NULL) {
+        if (ncInqInp.ncid < 0) return NETCDF_AGG_ELE_FILE_NOT_OPENED;
+        ncInqInp.paramType = NC_ALL_TYPE;
+        ncInqInp.flags = NC_ALL_FLAG;
+        status = rsNcInqDataObj (rsComm, &ncInqInp, cachedInqOut);
+        if (status < 0) {
+            rodsLogError (LOG_ERROR, status,
+              "inqAggrFile: rsNcInqDataObj error for %s",
+              openedAggInfo->ncAggInfo->ncAggElement[aggElemetInx].objPath);
+            return status;
+        }
+    }
+    *ncInqOut = *cachedInqOut;
+    return 0;
+}
+
+int
+getNcAggOpenMax ()
+{
+    char *tmpStr;
+    int openMax;
+
+    if ((tmpStr = getenv (NC_AGG_OPEN_MAX_ENV)) == NULL) 
+        return DEF_NC_AGG_OPEN_MAX;
+    openMax = atoi (tmpStr);
+    if (openMax < 1) openMax = 1;
+    return openMax;
+}
+
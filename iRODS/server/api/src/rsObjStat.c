@@ -14,6 +14,7 @@
 #include "rcGlobalExtern.h"
 #include "rsGlobalExtern.h"
 #include "dataObjClose.h"
+#include "dataObjOpr.h"
 
 int
 rsObjStat (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
@@ -125,24 +126,18 @@ rodsObjStat_t **rodsObjStatOut)
     return (status);
 }
 
+/* dataObjStat - stat objPath as a data object. The replicas are looked
+ * up with getDataObjInfo so that the stat of an object which has already
+ * been looked up in this request does not query the catalog again. */
 int
 dataObjStat (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
 rodsObjStat_t **rodsObjStatOut)
 {
-    genQueryInp_t genQueryInp;
-    genQueryOut_t *genQueryOut = NULL;
+    dataObjInp_t myDataObjInp;
+    dataObjInfo_t *dataObjInfoHead = NULL;
+    dataObjInfo_t *tmpDataObjInfo;
     int status;
     char myColl[MAX_NAME_LEN], myData[MAX_NAME_LEN];
-    char condStr[MAX_NAME_LEN];
-    sqlResult_t *dataSize;
-    sqlResult_t *dataMode;
-    sqlResult_t *replStatus;
-    sqlResult_t *dataId;
-    sqlResult_t *chksum;
-    sqlResult_t *ownerName;
-    sqlResult_t *ownerZone;
-    sqlResult_t *createTime;
-    sqlResult_t *modifyTime;
 
     /* see if objPath is a dataObj */
 
@@ -154,123 +149,40 @@ rodsObjStat_t **rodsObjStatOut)
         return (OBJ_PATH_DOES_NOT_EXIST);
     }
 
-    memset (&genQueryInp, 0, sizeof (genQueryInp));
+    /* only the path matters for the stat */
+    memset (&myDataObjInp, 0, sizeof (myDataObjInp));
+    rstrcpy (myDataObjInp.objPath, dataObjInp->objPath, MAX_NAME_LEN);
 
-    snprintf (condStr, MAX_NAME_LEN, "='%s'", myColl);
-    addInxVal (&genQueryInp.sqlCondInp, COL_COLL_NAME, condStr);
-    snprintf (condStr, MAX_NAME_LEN, "='%s'", myData);
-    addInxVal (&genQueryInp.sqlCondInp, COL_DATA_NAME, condStr);
+    status = getDataObjInfo (rsComm, &myDataObjInp, &dataObjInfoHead, NULL, 1);
+    if (status < 0) return (status);
 
-    addInxIval (&genQueryInp.selectInp, COL_D_DATA_ID, 1);
-    addInxIval (&genQueryInp.selectInp, COL_DATA_SIZE, 1);
-    addInxIval (&genQueryInp.selectInp, COL_DATA_MODE, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_REPL_STATUS, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_DATA_CHECKSUM, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_OWNER_NAME, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_OWNER_ZONE, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_CREATE_TIME, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_MODIFY_TIME, 1);
-
-    genQueryInp.maxRows = MAX_SQL_ROWS;
-
-    status =  rsGenQuery (rsComm, &genQueryInp, &genQueryOut);
-
-    clearGenQueryInp (&genQueryInp);
-
-    if (status >= 0) {
-        if ((dataSize = getSqlResultByInx (genQueryOut, COL_DATA_SIZE))
-          == NULL) {
-            rodsLog (LOG_ERROR,
-              "_rsObjStat: getSqlResultByInx for COL_DATA_SIZE failed");
-            return (UNMATCHED_KEY_OR_INDEX);
-        } else if ((dataMode = getSqlResultByInx (genQueryOut,
-          COL_DATA_MODE)) == NULL) {
-            rodsLog (LOG_ERROR,
-              "_rsObjStat: getSqlResultByInx for COL_DATA_MODE failed");
-            return (UNMATCHED_KEY_OR_INDEX);
-        } else if ((replStatus = getSqlResultByInx (genQueryOut,
-          COL_D_REPL_STATUS)) == NULL) {
-            rodsLog (LOG_ERROR,
-              "_rsObjStat: getSqlResultByInx for COL_D_REPL_STATUS failed");
-            return (UNMATCHED_KEY_OR_INDEX);
-        } else if ((dataId = getSqlResultByInx (genQueryOut,
-          COL_D_DATA_ID)) == NULL) {
-            rodsLog (LOG_ERROR,
-              "_rsObjStat: getSqlResultByInx for COL_D_DATA_ID failed");
-            return (UNMATCHED_KEY_OR_INDEX);
-        } else if ((chksum = getSqlResultByInx (genQueryOut,
-          COL_D_DATA_CHECKSUM)) == NULL) {
-            rodsLog (LOG_ERROR,
-             "_rsObjStat:getSqlResultByInx for COL_D_DATA_CHECKSUM failed");
-            return (UNMATCHED_KEY_OR_INDEX);
-        } else if ((ownerName = getSqlResultByInx (genQueryOut,
-          COL_D_OWNER_NAME)) == NULL) {
-            rodsLog (LOG_ERROR,
-             "_rsObjStat:getSqlResultByInx for COL_D_OWNER_NAME failed");
-            return (UNMATCHED_KEY_OR_INDEX);
-        } else if ((ownerZone = getSqlResultByInx (genQueryOut,
-          COL_D_OWNER_ZONE)) == NULL) {
-            rodsLog (LOG_ERROR,
-             "_rsObjStat:getSqlResultByInx for COL_D_OWNER_ZONE failed");
-            return (UNMATCHED_KEY_OR_INDEX);
-        } else if ((createTime = getSqlResultByInx (genQueryOut,
-          COL_D_CREATE_TIME)) == NULL) {
-            rodsLog (LOG_ERROR,
-             "_rsObjStat:getSqlResultByInx for COL_D_CREATE_TIME failed");
-            return (UNMATCHED_KEY_OR_INDEX);
-        } else if ((modifyTime = getSqlResultByInx (genQueryOut,
-          COL_D_MODIFY_TIME)) == NULL) {
-            rodsLog (LOG_ERROR,
-             "_rsObjStat:getSqlResultByInx for COL_D_MODIFY_TIME failed");
-            return (UNMATCHED_KEY_OR_INDEX);
-        } else {
-            int i;
-
-            *rodsObjStatOut = (rodsObjStat_t *) malloc (sizeof (rodsObjStat_t));
-            memset (*rodsObjStatOut, 0, sizeof (rodsObjStat_t));
-            (*rodsObjStatOut)->objType = DATA_OBJ_T; status = (int)DATA_OBJ_T;
-            /* XXXXXX . dont have numCopies anymore. Replaced by dataMode 
-	     * (*rodsObjStatOut)->numCopies = genQueryOut->rowCnt; */
-
-            for (i = 0;i < genQueryOut->rowCnt; i++) {
-                if (atoi (&replStatus->value[replStatus->len * i]) > 0) {
-                    rstrcpy ((*rodsObjStatOut)->dataId, 
-		      &dataId->value[dataId->len * i], NAME_LEN);
-                    (*rodsObjStatOut)->objSize =
-                      strtoll (&dataSize->value[dataSize->len * i], 0, 0);
-                    (*rodsObjStatOut)->dataMode =
-                      atoi (&dataMode->value[dataMode->len * i]);
-                    rstrcpy ((*rodsObjStatOut)->chksum,
-                      &chksum->value[chksum->len * i], CHKSUM_LEN);
-		    rstrcpy ((*rodsObjStatOut)->ownerName,
-                      &ownerName->value[ownerName->len * i], NAME_LEN);
-                    rstrcpy ((*rodsObjStatOut)->ownerZone,
-                      &ownerZone->value[ownerZone->len * i], NAME_LEN);
-                    rstrcpy ((*rodsObjStatOut)->createTime,
-                      &createTime->value[createTime->len * i], TIME_LEN);
-                    rstrcpy ((*rodsObjStatOut)->modifyTime,
-                      &modifyTime->value[modifyTime->len * i], TIME_LEN);
-                    break;
-                }
-            }
-
-            if (strlen ((*rodsObjStatOut)->dataId) == 0) {
-                /* just use the first one */
-                rstrcpy ((*rodsObjStatOut)->dataId, dataId->value, NAME_LEN);
-                (*rodsObjStatOut)->objSize = strtoll (dataSize->value, 0, 0);
-                rstrcpy ((*rodsObjStatOut)->chksum, chksum->value, CHKSUM_LEN);
-                rstrcpy ((*rodsObjStatOut)->ownerName, ownerName->value, 
-		  NAME_LEN);
-                rstrcpy ((*rodsObjStatOut)->ownerZone, ownerZone->value, 
-		  NAME_LEN);
-                rstrcpy ((*rodsObjStatOut)->createTime, createTime->value, 
-		  NAME_LEN);
-                rstrcpy ((*rodsObjStatOut)->modifyTime, modifyTime->value, 
-		  NAME_LEN);
-            }
-        }
-        freeGenQueryOut (&genQueryOut);
+    /* use the first good copy, or just the first one */
+    for (tmpDataObjInfo = dataObjInfoHead; tmpDataObjInfo != NULL; 
+      tmpDataObjInfo = tmpDataObjInfo->next) {
+        if (tmpDataObjInfo->replStatus > 0) break;
     }
+    if (tmpDataObjInfo == NULL) tmpDataObjInfo = dataObjInfoHead;
+
+    *rodsObjStatOut = (rodsObjStat_t *) malloc (sizeof (rodsObjStat_t));
+    memset (*rodsObjStatOut, 0, sizeof (rodsObjStat_t));
+    (*rodsObjStatOut)->objType = DATA_OBJ_T; status = (int)DATA_OBJ_T;
+    /* XXXXXX . dont have numCopies anymore. Replaced by dataMode 
+     * (*rodsObjStatOut)->numCopies = genQueryOut->rowCnt; */
+    snprintf ((*rodsObjStatOut)->dataId, NAME_LEN, "%lld", 
+      tmpDataObjInfo->dataId);
+    (*rodsObjStatOut)->objSize = tmpDataObjInfo->dataSize;
+    (*rodsObjStatOut)->dataMode = atoi (tmpDataObjInfo->dataMode);
+    rstrcpy ((*rodsObjStatOut)->chksum, tmpDataObjInfo->chksum, CHKSUM_LEN);
+    rstrcpy ((*rodsObjStatOut)->ownerName, tmpDataObjInfo->dataOwnerName, 
+      NAME_LEN);
+    rstrcpy ((*rodsObjStatOut)->ownerZone, tmpDataObjInfo->dataOwnerZone, 
+      NAME_LEN);
+    rstrcpy ((*rodsObjStatOut)->createTime, tmpDataObjInfo->dataCreate, 
+      TIME_LEN);
+    rstrcpy ((*rodsObjStatOut)->modifyTime, tmpDataObjInfo->dataModify, 
+      TIME_LEN);
+
+    freeAllDataObjInfo (dataObjInfoHead);
 
     return (status);
 }
@@ -21,6 +21,7 @@
 #include "regReplica.h"
 #include "unbunAndRegPhyBunfile.h"
 #include "fileChksum.h"
+#include "structFileDriver.h"
 
 static rodsLong_t OneGig = (1024*1024*1024);
 
@@ -330,12 +331,14 @@ char *collection, bunReplCacheHeader_t *bunReplCacheHeader, int chksumFlag)
         return 0;
     }
 
+    /* the tar driver checksums the sub files while writing them */
     status = phyBundle (rsComm, L1desc[l1descInx].dataObjInfo, phyBunDir,
-      collection, CREATE_TAR_OPR);
+      collection, CREATE_TAR_OPR | (chksumFlag != 0 ? CHKSUM_SUB_FILES_OPR : 0));
     if (status < 0) {
         rodsLog (LOG_ERROR,
           "bundlleAndRegSubFiles: rsStructFileSync of %s error. stat = %d",
           L1desc[l1descInx].dataObjInfo->objPath, status);
+        clearStructFileMemberChksum ();
         rmLinkedFilesInUnixDir (phyBunDir);
         rmdir (phyBunDir);
         rsDataObjClose (rsComm, &dataObjCloseInp);
@@ -394,7 +397,8 @@ char *collection, bunReplCacheHeader_t *bunReplCacheHeader, int chksumFlag)
 	/* rm the hard link here */
 	snprintf (subPhyPath, MAX_NAME_LEN, "%s/%lld", phyBunDir, 
 	  tmpBunReplCache->dataId);
-	if (chksumFlag != 0) {
+	if (chksumFlag != 0 && getStructFileMemberChksum (subPhyPath,
+	  tmpBunReplCache->chksumStr) < 0) {
 	    status = fileChksum (UNIX_FILE_TYPE, rsComm, subPhyPath, 
 	      tmpBunReplCache->chksumStr, 
 #ifdef SHA256_FILE_HASH
@@ -443,6 +447,7 @@ char *collection, bunReplCacheHeader_t *bunReplCacheHeader, int chksumFlag)
     free (regReplicaInp.srcDataObjInfo);
     free (regReplicaInp.destDataObjInfo);
     bzero (bunReplCacheHeader, sizeof (bunReplCacheHeader_t)); 
+    clearStructFileMemberChksum ();
     rmdir (phyBunDir);
 
     if (status >= 0 && savedStatus < 0) {
@@ -453,7 +458,8 @@ char *collection, bunReplCacheHeader_t *bunReplCacheHeader, int chksumFlag)
 }
 
 /* phyBundle
- * Valid oprType are CREATE_TAR_OPR and ADD_TO_TAR_OPR
+ * Valid oprType are CREATE_TAR_OPR and ADD_TO_TAR_OPR, optionally
+ * with CHKSUM_SUB_FILES_OPR
  */
 int
 phyBundle (rsComm_t *rsComm, dataObjInfo_t *dataObjInfo, char *phyBunDir,
@@ -5,6 +5,7 @@
 
 #include "regColl.h"
 #include "icatHighLevelRoutines.h"
+#include "specColl.h"
 #ifdef FILESYSTEM_META
 #include "collection.h"
 #endif
@@ -50,6 +51,12 @@ rsRegColl (rsComm_t *rsComm, collInp_t *regCollInp)
     } else {
         status = rcRegColl (rodsServerHost->conn, regCollInp);
     }
+    if (status >= 0 && getValByKey (&regCollInp->condInput, 
+      COLLECTION_TYPE_KW) != NULL) {
+        /* a new special collection. The cached paths without one are
+         * no longer reliable */
+        clearNoSpecCollCache ();
+    }
 
     return (status);
 }
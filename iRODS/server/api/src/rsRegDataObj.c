@@ -6,6 +6,7 @@
 #include "regDataObj.h"
 #include "icatHighLevelRoutines.h"
 #include "miscServerFunct.h"
+#include "dataObjOpr.h"
 
 /* rsRegDataObj - This call is strictly an API handler and should not be 
  * called directly in the server. For server calls, use svrRegDataObj
@@ -19,6 +20,7 @@ dataObjInfo_t **outDataObjInfo)
 
     *outDataObjInfo = NULL;
 
+    invalidateDataObjInfoCache (dataObjInfo->objPath);
     status = getAndConnRcatHost (rsComm, MASTER_RCAT, dataObjInfo->objPath,
       &rodsServerHost);
     if (status < 0) {
@@ -69,6 +71,7 @@ svrRegDataObj (rsComm_t *rsComm, dataObjInfo_t *dataObjInfo)
 	return (SYS_REG_OBJ_IN_SPEC_COLL);
     }
 
+    invalidateDataObjInfoCache (dataObjInfo->objPath);
     status = getAndConnRcatHost (rsComm, MASTER_RCAT, dataObjInfo->objPath,
       &rodsServerHost);
     if (status < 0) {
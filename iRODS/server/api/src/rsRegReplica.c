@@ -7,6 +7,7 @@
 #include "objMetaOpr.h"
 #include "icatHighLevelRoutines.h"
 #include "miscServerFunct.h"
+#include "dataObjOpr.h"
 
 int
 rsRegReplica (rsComm_t *rsComm, regReplica_t *regReplicaInp)
@@ -19,6 +20,8 @@ rsRegReplica (rsComm_t *rsComm, regReplica_t *regReplicaInp)
     srcDataObjInfo = regReplicaInp->srcDataObjInfo;
     destDataObjInfo = regReplicaInp->destDataObjInfo;
 
+    invalidateDataObjInfoCache (srcDataObjInfo->objPath);
+    invalidateDataObjInfoCache (destDataObjInfo->objPath);
     status = getAndConnRcatHost (rsComm, MASTER_RCAT, srcDataObjInfo->objPath,
       &rodsServerHost);
     if (status < 0) {
@@ -13,6 +13,10 @@
 #include "closeCollection.h"
 #include "dataObjUnlink.h"
 #include "rsApiHandler.h"
+#include "dataObjOpr.h"
+#include "resource.h"
+#include "collection.h"
+#include "vaultReaper.h"
 
 int
 rsRmColl (rsComm_t *rsComm, collInp_t *rmCollInp,
@@ -26,6 +30,7 @@ collOprStat_t **collOprStat)
 
     resolveLinkedPath (rsComm, rmCollInp->collName, &specCollCache,
       &rmCollInp->condInput);
+    invalidateDataObjInfoCache (NULL);
     status = getAndConnRcatHost (rsComm, MASTER_RCAT,
      rmCollInp->collName, &rodsServerHost);
 
@@ -130,6 +135,7 @@ collOprStat_t **collOprStat)
     int status;
     ruleExecInfo_t rei;
     int trashPolicy;
+    int normalCollFlag = 0;
     dataObjInfo_t *dataObjInfo = NULL;
 #if 0
     dataObjInp_t dataObjInp;
@@ -153,6 +159,7 @@ collOprStat_t **collOprStat)
     }
     if (status != COLL_OBJ_T || dataObjInfo->specColl == NULL) {
 	/* a normal coll */
+	normalCollFlag = 1;
 	if (rmCollInp->oprType != UNREG_OPR &&
 	  getValByKey (&rmCollInp->condInput, FORCE_FLAG_KW) == NULL &&
 	  getValByKey (&rmCollInp->condInput, IRODS_RMTRASH_KW) == NULL &&
@@ -176,6 +183,14 @@ collOprStat_t **collOprStat)
 	    }
 	}
     }
+    if (normalCollFlag > 0) {
+	/* try to remove the whole tree in the catalog at once */
+	status = _rsRmCollTree (rsComm, rmCollInp, collOprStat);
+	if (status != SYS_NOT_SUPPORTED) {
+	    if (dataObjInfo != NULL) freeDataObjInfo (dataObjInfo);
+	    return (status);
+	}
+    }
     /* got here. will recursively phy delete the collection */
     status = _rsPhyRmColl (rsComm, rmCollInp, dataObjInfo, collOprStat);
 
@@ -350,6 +365,157 @@ dataObjInfo_t *dataObjInfo, collOprStat_t **collOprStat)
     return (savedStatus);
 }
 
+/* _rsRmCollTree - remove a normal collection and everything below it with
+ * one set based catalog delete (chlDelCollTree) if the rmCollTree env is
+ * set. The vault files of the removed replicas are queued to the vault
+ * reaper, which unlinks them after the commit. The per object and per
+ * sub collection rules are not run for the content. Returns
+ * SYS_NOT_SUPPORTED if the caller has to remove the collection object by
+ * object, e.g., it holds mounted collections, the ICAT is remote or the
+ * irodsReServer runs on another host.
+ */
+
+int
+_rsRmCollTree (rsComm_t *rsComm, collInp_t *rmCollInp,
+collOprStat_t **collOprStat)
+{
+#ifdef RODS_CAT
+    int status, i;
+    rodsServerHost_t *rodsServerHost = NULL;
+    genQueryInp_t genQueryInp;
+    genQueryOut_t *genQueryOut = NULL;
+    collInfo_t collInfo;
+    reapQue_t reapQue;
+    rescInfo_t *rescInfo;
+    int continueInx;
+    int adminFlag = 0;
+    int collLen;
+    int objCnt = 0;
+    char *collName = rmCollInp->collName;
+
+    if (isRmCollTree () == 0 || rmCollInp->oprType == UNREG_OPR ||
+      getValByKey (&rmCollInp->condInput, AGE_KW) != NULL ||
+      getValByKey (&rmCollInp->condInput, EMPTY_BUNDLE_ONLY_KW) != NULL ||
+      isHomeColl (collName) || isTrashHome (collName) > 0 ||
+      isOrphanPath (collName) != NOT_ORPHAN_PATH ||
+      isBundlePath (collName) == True) {
+	return SYS_NOT_SUPPORTED;
+    }
+    if (getValByKey (&rmCollInp->condInput, IRODS_ADMIN_RMTRASH_KW) != NULL) {
+	/* _rsPhyRmColl does the checks and returns the error */
+	if (isTrashPath (collName) == False ||
+	  rsComm->clientUser.authInfo.authFlag != LOCAL_PRIV_USER_AUTH)
+	    return SYS_NOT_SUPPORTED;
+	adminFlag = 1;
+    } else if (getValByKey (&rmCollInp->condInput, IRODS_RMTRASH_KW) != NULL &&
+      isTrashPath (collName) == False) {
+	return SYS_NOT_SUPPORTED;
+    }
+
+    status = getAndConnRcatHost (rsComm, MASTER_RCAT, collName,
+      &rodsServerHost);
+    if (status < 0) return status;
+    if (rodsServerHost->localFlag != LOCAL_HOST) return SYS_NOT_SUPPORTED;
+
+    /* queue the vault files of all the replicas in the tree */
+    memset (&reapQue, 0, sizeof (reapQue));
+    collLen = strlen (collName);
+    status = rsQueryDataObjInCollReCur (rsComm, collName, &genQueryInp,
+      &genQueryOut, NULL, 0);
+    while (status >= 0) {
+	sqlResult_t *subCollRes, *rescNameRes, *filePathRes;
+	char *tmpSubColl, *tmpRescName, *tmpFilePath;
+
+	if ((subCollRes = getSqlResultByInx (genQueryOut, COL_COLL_NAME))
+	  == NULL || (rescNameRes = getSqlResultByInx (genQueryOut,
+	  COL_D_RESC_NAME)) == NULL || (filePathRes = getSqlResultByInx (
+	  genQueryOut, COL_D_DATA_PATH)) == NULL) {
+            rodsLog (LOG_ERROR,
+              "_rsRmCollTree: getSqlResultByInx failed for %s", collName);
+	    status = UNMATCHED_KEY_OR_INDEX;
+	    break;
+	}
+	for (i = 0; i < genQueryOut->rowCnt; i++) {
+	    tmpSubColl = &subCollRes->value[subCollRes->len * i];
+	    tmpRescName = &rescNameRes->value[rescNameRes->len * i];
+	    tmpFilePath = &filePathRes->value[filePathRes->len * i];
+
+	    /* the query condition is a like. '_' and '%' match anything */
+	    if (strncmp (tmpSubColl, collName, collLen) != 0 ||
+	      (tmpSubColl[collLen] != '\0' && tmpSubColl[collLen] != '/'))
+		continue;
+	    objCnt++;
+	    status = resolveResc (tmpRescName, &rescInfo);
+	    if (status < 0) break;
+	    /* what l3Unlink would unlink */
+	    if (getRescClass (rescInfo) == BUNDLE_CL ||
+	      RescTypeDef[rescInfo->rescTypeInx].rescCat != FILE_CAT)
+		continue;
+	    status = addToReapQue (&reapQue, tmpRescName, tmpFilePath);
+	    if (status < 0) break;
+	}
+	if (status < 0) break;
+
+        continueInx = genQueryOut->continueInx;
+        freeGenQueryOut (&genQueryOut);
+        if (continueInx > 0) {
+            genQueryInp.continueInx = continueInx;
+            status = rsGenQuery (rsComm, &genQueryInp, &genQueryOut);
+        } else {
+            break;
+        }
+    }
+    if (genQueryOut != NULL) {
+	if (genQueryOut->continueInx > 0) {
+	    /* close the query */
+	    genQueryInp.continueInx = genQueryOut->continueInx;
+	    genQueryInp.maxRows = 0;
+	    freeGenQueryOut (&genQueryOut);
+	    rsGenQuery (rsComm, &genQueryInp, &genQueryOut);
+	}
+	freeGenQueryOut (&genQueryOut);
+    }
+    clearGenQueryInp (&genQueryInp);
+    if (status < 0 && status != CAT_NO_ROWS_FOUND) {
+	rodsLogError (LOG_NOTICE, status,
+	  "_rsRmCollTree: queueing the files of %s failed, removing per object",
+	  collName);
+	abortReapQue (&reapQue);
+	return SYS_NOT_SUPPORTED;
+    }
+
+    memset (&collInfo, 0, sizeof (collInfo));
+    rstrcpy (collInfo.collName, collName, MAX_NAME_LEN);
+    status = chlDelCollTree (rsComm, &collInfo, adminFlag);
+    if (status >= 0) {
+	status = chlCommit (rsComm);
+    }
+    if (status < 0) {
+	abortReapQue (&reapQue);
+	if (status != SYS_NOT_SUPPORTED) {
+	    rodsLogError (LOG_ERROR, status,
+	      "_rsRmCollTree: chlDelCollTree of %s failed", collName);
+	    chlRollback (rsComm);
+	}
+	return status;
+    }
+    commitReapQue (rsComm, &reapQue);
+
+    if (collOprStat != NULL) {
+	if (*collOprStat == NULL) {
+	    *collOprStat = (collOprStat_t*)malloc (sizeof (collOprStat_t));
+	    memset (*collOprStat, 0, sizeof (collOprStat_t));
+	}
+	(*collOprStat)->filesCnt += objCnt;
+	(*collOprStat)->totalFileCnt += objCnt;
+	rstrcpy ((*collOprStat)->lastObjPath, collName, MAX_NAME_LEN);
+    }
+    return (0);
+#else
+    return SYS_NOT_SUPPORTED;
+#endif
+}
+
 int 
 svrUnregColl (rsComm_t *rsComm, collInp_t *rmCollInp)
 {
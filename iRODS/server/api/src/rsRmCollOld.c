@@ -18,6 +18,7 @@
 #include "subStructFileRmdir.h"
 #include "genQuery.h"
 #include "dataObjUnlink.h"
+#include "vaultReaper.h"
 
 int
 rsRmCollOld (rsComm_t *rsComm, collInp_t *rmCollInp)
@@ -422,6 +423,12 @@ rsMvCollToTrash (rsComm_t *rsComm, collInp_t *rmCollInp)
     rstrcpy (dataObjRenameInp.destDataObjInp.objPath, trashPath, MAX_NAME_LEN);
     rstrcpy (dataObjRenameInp.srcDataObjInp.objPath, rmCollInp->collName,
       MAX_NAME_LEN);
+    if (isRmCollTree () > 0) {
+	/* only the catalog is moved. The files are reaped from where they
+	 * are when the trash is emptied */
+	addKeyVal (&dataObjRenameInp.srcDataObjInp.condInput,
+	  NO_PHY_PATH_SYNC_KW, "");
+    }
 
     status = rsDataObjRename (rsComm, &dataObjRenameInp);
 
@@ -438,6 +445,8 @@ rsMvCollToTrash (rsComm_t *rsComm, collInp_t *rmCollInp)
 #endif
     }
 
+    clearKeyVal (&dataObjRenameInp.srcDataObjInp.condInput);
+
     if (status < 0) {
         rodsLog (LOG_ERROR,
           "mvCollToTrash: rcDataObjRename error for %s, status = %d",
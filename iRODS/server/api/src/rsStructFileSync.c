@@ -4,6 +4,7 @@
 #include "structFileSync.h" 
 #include "miscServerFunct.h"
 #include "dataObjOpr.h"
+#include "syncMountedColl.h"
 
 int
 rsStructFileSync (rsComm_t *rsComm, structFileOprInp_t *structFileOprInp)
@@ -12,6 +13,12 @@ rsStructFileSync (rsComm_t *rsComm, structFileOprInp_t *structFileOprInp)
     int remoteFlag;
     int status;
 
+    if (RsApiTable[rsComm->apiInx].apiNumber == STRUCT_FILE_SYNC_AN) {
+	/* the sub file checksums are only kept for a caller on this agent.
+	 * A remote caller never reads them */
+	structFileOprInp->oprType &= ~CHKSUM_SUB_FILES_OPR;
+    }
+
     remoteFlag = resolveHost (&structFileOprInp->addr, &rodsServerHost);
 
     if (remoteFlag == LOCAL_HOST) {
@@ -6,6 +6,7 @@
 #include "unregDataObj.h"
 #include "icatHighLevelRoutines.h"
 #include "miscServerFunct.h"
+#include "dataObjOpr.h"
 
 int
 rsUnregDataObj (rsComm_t *rsComm, unregDataObj_t *unregDataObjInp)
@@ -18,6 +19,7 @@ rsUnregDataObj (rsComm_t *rsComm, unregDataObj_t *unregDataObjInp)
     condInput = unregDataObjInp->condInput;
     dataObjInfo = unregDataObjInp->dataObjInfo;
 
+    invalidateDataObjInfoCache (dataObjInfo->objPath);
     status = getAndConnRcatHost (rsComm, MASTER_RCAT, dataObjInfo->objPath,
       &rodsServerHost);
     if (status < 0) {
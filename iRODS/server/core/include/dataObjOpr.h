@@ -28,10 +28,27 @@
 #define TRIM_MATCHED_OBJ_INFO		0x4
 #define TRIM_UNMATCHED_OBJ_INFO		0x8
 
+/* the request scoped getDataObjInfo cache */
+#define DATA_OBJ_INFO_CACHE_SIZE	"dataObjInfoCacheSize"
+#define DEF_DATA_OBJ_INFO_CACHE_SIZE	16
+#define MAX_DATA_OBJ_INFO_CACHE_SIZE	256
+#define DATA_OBJ_INFO_CACHE_AGE		5	/* max age of an entry in sec */
+#define MAX_DATA_OBJ_INFO_BATCH		32	/* paths in a batch query */
+#define MAX_DATA_OBJ_INFO_COND_LEN	4096	/* len of the in (...) cond */
+
 int
 getDataObjInfo (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
 dataObjInfo_t **dataObjInfoHead, char *accessPerm, int ignoreCondInput);
 int
+getDataObjInfoBatch (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
+char *accessPerm, int ignoreCondInput, int numPath, char **objPathArray);
+int
+beginDataObjInfoCache (int apiNumber);
+int
+endDataObjInfoCache ();
+int
+invalidateDataObjInfoCache (char *objPath);
+int
 updateDataObjReplStatus (rsComm_t *rsComm, int l1descInx, int replStatus);
 int
 dataObjExist (rsComm_t *rsComm, dataObjInp_t *dataObjInp);
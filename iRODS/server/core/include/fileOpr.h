@@ -32,6 +32,8 @@ typedef struct {
     int fd;		/* the file descriptor from driver */
     int writtenFlag;	/* indicated whether the file has been written to */
     void *driverDep;	/* driver dependent stuff */
+    int loadFlag;	/* counted in the server load until freed */
+    rodsLong_t loadBytes;
 } fileDesc_t;
 
 int
@@ -45,6 +45,8 @@ typedef struct PortalTransferInp {
     rodsLong_t bytesWritten;
     int flags;
     int status;
+    int sharedFd;	/* destFd/srcFd is the l3 fd of thread 0. Use
+			 * _l3Pread/_l3Pwrite and do not close it */
     dataOprInp_t *dataOprInp;
 } portalTransferInp_t;
 
@@ -25,6 +25,19 @@
 #define LOCK_FILE_DIR	"lockFileDir"
 #define LOCK_FILE_TRAILER	"LOCK_FILE"	/* added to end of lock file */ 
 
+/* env variables read by the ICAT enabled agents. They can be set in
+ * server.env */
+#define LAZY_COLL_PHY_PATH_ENV	"lazyCollPhyPath" /* 1 - a collection rename
+						   * only updates the catalog.
+						   * The vault files are moved
+						   * by the irodsReServer */
+#define COLL_PHY_PATH_BATCH_ENV	"collPhyPathBatch" /* replicas moved between
+						    * the pauses */
+#define COLL_PHY_PATH_SLEEP_ENV	"collPhyPathSleep" /* pause in sec */
+#define DEF_COLL_PHY_PATH_BATCH	1000
+#define DEF_COLL_PHY_PATH_SLEEP	1
+#define COLL_PHY_PATH_DELAY	"<PLUSET>10s</PLUSET>"
+
 #ifdef  __cplusplus
 extern "C" {
 #endif
@@ -80,6 +93,13 @@ dataObjInfo_t *dataObjInfo, char *acLCollection);
 int
 syncCollPhyPath (rsComm_t *rsComm, char *collection);
 int
+_syncCollPhyPath (rsComm_t *rsComm, char *collection, int batchSize,
+int sleepSec, int *outCnt);
+int
+isLazyCollPhyPath ();
+int
+queSyncCollPhyPath (rsComm_t *rsComm, char *collection);
+int
 isInVault (dataObjInfo_t *dataObjInfo);
 int
 initStructFileOprInp (rsComm_t *rsComm, structFileOprInp_t *structFileOprInp,
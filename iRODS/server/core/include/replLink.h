@@ -0,0 +1,65 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* replLink.h - header file for replLink.c, the no. of parallel streams
+ * of a replication between resource servers from the measured RTT and
+ * bandwidth of the link.
+ */
+
+#ifndef REPL_LINK_H
+#define REPL_LINK_H
+
+#include <sys/time.h>
+#include "rods.h"
+#include "objInfo.h"
+#include "initServer.h"
+
+/* env variables read by the agents. They can be set in server.env */
+#define REPL_AUTO_THREADS_ENV	"replAutoThreads"   /* 1 - the no. of
+						     * streams of a
+						     * replication comes
+						     * from the link */
+#define REPL_LINK_BW_ENV	"replLinkBandwidth" /* capacity of the links
+						     * between the servers
+						     * in Mbit/s. Measured
+						     * if not set */
+
+#define REPL_LINK_DIR		"replLinkDir"	/* in the state dir */
+#define REPL_LINK_RTT_AGE	3600		/* the RTT is measured again
+						 * after this many sec */
+#define REPL_LINK_RTT_PROBES	3
+/* transfers smaller than this are not used to measure the bandwidth */
+#define REPL_LINK_MIN_SAMPLE_SZ	(32*1024*1024)
+/* a stream doing this percentage of window/RTT is window bound */
+#define REPL_LINK_WINDOW_BOUND	80
+
+typedef struct ReplLink {
+    char hostName[NAME_LEN];
+    int rttUsec;		/* min round trip time of an API call */
+    time_t rttTime;		/* when rttUsec was measured */
+    rodsLong_t bandwidth;	/* estimated link capacity in Bytes/s.
+				 * 0 - unknown */
+    struct ReplLink *next;
+} replLink_t;
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+int
+isReplAutoThreads ();
+rodsLong_t
+getReplLinkBandwidth ();
+int
+getReplNumThreads (rsComm_t *rsComm, rescInfo_t *srcRescInfo,
+rescInfo_t *destRescInfo, rodsLong_t dataSize, int numThreads);
+int
+recordReplXfer (rsComm_t *rsComm, rescInfo_t *srcRescInfo,
+rescInfo_t *destRescInfo, rodsLong_t dataSize, int numThreads,
+struct timeval *startTime);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif	/* REPL_LINK_H */
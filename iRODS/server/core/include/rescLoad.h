@@ -0,0 +1,92 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* rescLoad.h - header file for rescLoad.c, the live load of a resource
+ * server kept in memory shared by its agents and the load based sorting
+ * of a resource group.
+ */
+
+#ifndef RESC_LOAD_H
+#define RESC_LOAD_H
+
+#include "rods.h"
+#include "objInfo.h"
+#include "fileGetLoad.h"
+
+#define RESC_LOAD_FILE		"rescLoadFile"	/* in the state dir */
+#define RESC_LOAD_MAGIC		0x4c6f6164
+#define RESC_LOAD_NUM_SLOTS	512	/* max agents counted at one time */
+#define RESC_LOAD_NUM_DISKS	16	/* max vault disks of a server */
+#define RESC_LOAD_DISK_SAMPLE_MS 1000	/* min interval of the disk busy
+					 * samples */
+#define RESC_LOAD_CACHE_TIME	2	/* an agent asks a server for its load
+					 * at most once in this many sec */
+#define DISK_STATS_FILE		"/proc/diskstats"
+
+/* the weight of a resource in the "byLiveLoad" scheme is
+ * RESC_LOAD_WEIGHT_SCALE * (100 - diskBusy/2) / 100 / cost where
+ * cost = 1 + activeXfers + queueDepth + outstandingBytes/RESC_LOAD_BYTE_UNIT.
+ * A resource with less than RESC_LOAD_LOW_FREE_SPACE free gets a weight
+ * of 1 */
+#define RESC_LOAD_WEIGHT_SCALE	100000
+#define RESC_LOAD_BYTE_UNIT	(64*1024*1024)
+#define RESC_LOAD_LOW_FREE_SPACE ((rodsLong_t) 1024*1024*1024)
+
+/* the counters of an agent. Only the agent with pid writes them */
+typedef struct RescLoadSlot {
+    int pid;			/* 0 - free */
+    int activeXfers;
+    rodsLong_t outstandingBytes;
+} rescLoadSlot_t;
+
+typedef struct RescLoadDisk {
+    uint dev;			/* device no. of the vault's disk. 0 - free */
+    int lock;
+    uint ioTicks;		/* ms spent doing I/O at sampleMs */
+    int busy;			/* % busy over the last sample interval */
+    rodsLong_t sampleMs;
+} rescLoadDisk_t;
+
+/* the layout of RESC_LOAD_FILE, mapped by all the agents of a server */
+typedef struct RescLoadSeg {
+    int magic;
+    int numSlots;
+    int numDisks;
+    int pad;
+    rescLoadSlot_t slot[RESC_LOAD_NUM_SLOTS];
+    rescLoadDisk_t disk[RESC_LOAD_NUM_DISKS];
+} rescLoadSeg_t;
+
+/* the load of a resource as last seen by this agent */
+typedef struct RescLoad {
+    char rescName[NAME_LEN];
+    time_t queryTime;
+    int status;			/* of the last query. < 0 - load unknown */
+    fileGetLoadOut_t load;
+    struct RescLoad *next;
+} rescLoad_t;
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+void
+rescLoadXferStart (rodsLong_t dataSize);
+void
+rescLoadXferEnd (rodsLong_t dataSize);
+void
+rescLoadFileDescStart (int fileInx, rodsLong_t dataSize);
+int
+getLocalRescLoad (rsComm_t *rsComm, int fileType, char *vaultPath,
+fileGetLoadOut_t *outLoad);
+int
+getRescLoad (rsComm_t *rsComm, rescInfo_t *rescInfo,
+fileGetLoadOut_t **outLoad);
+int
+getRescLoadWeight (fileGetLoadOut_t *load);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif	/* RESC_LOAD_H */
@@ -74,6 +74,10 @@ sortRescByLocation (rescGrpInfo_t **rescGrpInfo);
 int
 sortRescByLoad (rsComm_t *rsComm, rescGrpInfo_t **rescGrpInfo);
 int
+sortRescByLiveLoad (rsComm_t *rsComm, rescGrpInfo_t **rescGrpInfo);
+int
+sortRescByLeastBytes (rsComm_t *rsComm, rescGrpInfo_t **rescGrpInfo);
+int
 initRescGrp (rsComm_t *rsComm);
 int
 getRescGrpOfResc (rsComm_t *rsComm, rescInfo_t * rescInfo,
@@ -45,6 +45,9 @@ chkApiPermission (rsComm_t *rsComm, int apiInx);
 int
 handlePortalOpr (rsComm_t *rsComm);
 int
+packWireOutStruct (rsComm_t *rsComm, int apiInx, void *myOutStruct,
+bytesBuf_t **outStructBBuf);
+int
 sendApiReply (rsComm_t *rsComm, int apiInx, int retVal,
 void *myOutStruct, bytesBuf_t *myOutBsBBuf);
 int
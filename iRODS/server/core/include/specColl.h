@@ -18,6 +18,22 @@
 #include "rsGlobalExtern.h"
 #include "reIn2p3SysRule.h"
 
+#define SPEC_COLL_HASH_SIZE	1024
+/* max no. of parent collections cached as having no special collection */
+#define MAX_NO_SPEC_COLL_CACHE	10000
+
+/* the hash of the special collection caches, keyed by collection */
+typedef struct SpecCollHashEntry {
+    char *key;
+    void *value;
+    struct SpecCollHashEntry *next;
+} specCollHashEntry_t;
+
+typedef struct SpecCollHash {
+    int len;			/* no. of entries */
+    specCollHashEntry_t *bucket[SPEC_COLL_HASH_SIZE];
+} specCollHash_t;
+
 #ifdef  __cplusplus
 extern "C" {
 #endif
@@ -30,9 +46,17 @@ int
 queueSpecCollCache (rsComm_t *rsComm, genQueryOut_t *genQueryOut, char *objPath);
 int
 queueSpecCollCacheWithObjStat (rodsObjStat_t *rodsObjStatOut);
+int
+hashSpecCollCache (specCollCache_t *specCollCache);
 specCollCache_t *
 matchSpecCollCache (char *objPath);
 int
+isNoSpecCollPath (char *objPath);
+int
+cacheNoSpecColl (rsComm_t *rsComm, char *objPath);
+int
+clearNoSpecCollCache ();
+int
 getSpecCollCache (rsComm_t *rsComm, char *objPath, int inCachOnly,
 specCollCache_t **specCollCache);
 int
@@ -0,0 +1,60 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* stageQue.h - header file for stageQue.c, the coordination of the staging
+ * of compound resource copies to the cache resource.
+ */
+
+#ifndef STAGE_QUE_H
+#define STAGE_QUE_H
+
+#include "rods.h"
+#include "objInfo.h"
+#include "dataObjInpOut.h"
+
+/* env variables read by the agents. They can be set in server.env */
+#define STAGE_SLOTS_PER_RESC	"stageSlotsPerResc" /* parallel stages per
+						     * compound resource */
+#define STAGE_PREFETCH		"stagePrefetch"	/* 1 - always prefetch the
+						 * siblings on stage */
+
+#define DEF_STAGE_SLOTS_PER_RESC	4
+#define MAX_STAGE_SLOTS_PER_RESC	64
+#define STAGE_LOCK_PREFIX	"stage"
+#define STAGE_SLOT_PREFIX	"stageSlot"
+#define STAGE_LOCK_NAME_LEN	64	/* max chars of the name kept in the
+					 * lock file name */
+#define STAGE_LOCK_POOL_SIZE	256	/* no. of object stage lock files */
+#define STAGE_PREFETCH_DELAY	"<PLUSET>1s</PLUSET>"
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+int
+lockStageObj (char *objPath);
+int
+getStageSlot (char *rescName);
+void
+releaseStageLock (int lockFd);
+int
+getStagedCacheCopy (rsComm_t *rsComm, char *objPath, char *cacheRescName,
+dataObjInfo_t *outCacheObjInfo);
+int
+stageObjToCache (rsComm_t *rsComm, char *objPath);
+int
+stageCollToCache (rsComm_t *rsComm, collInp_t *collInp, int shardInx,
+int numShards, int *outStagedCnt);
+int
+queStageCollToCache (rsComm_t *rsComm, char *collPath, int collFlags,
+int shardInx, int numShards);
+int
+queStagePrefetch (rsComm_t *rsComm, char *objPath, keyValPair_t *condInput);
+int
+parseStageShard (char *shardStr, int *shardInx, int *numShards);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif	/* STAGE_QUE_H */
@@ -0,0 +1,69 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* vaultReaper.h - header file for vaultReaper.c, the queue of vault files
+ * left by a set based collection delete and their asynchronous unlink.
+ */
+
+#ifndef VAULT_REAPER_H
+#define VAULT_REAPER_H
+
+#include "rods.h"
+#include "objInfo.h"
+
+/* env variables read by the agents. They can be set in server.env */
+#define RM_COLL_TREE_ENV	"rmCollTree"	/* 1 - irm -rf removes the
+						 * whole tree in the catalog
+						 * at once */
+#define REAP_NUM_THREADS_ENV	"reapNumThreads" /* unlink threads per
+						  * resource */
+
+#define DEF_REAP_NUM_THREADS	4
+#define MAX_REAP_NUM_THREADS	32
+#define REAP_FILE_DIR		"reapFileDir"	/* in the state dir */
+#define REAP_TMP_TRAILER	".tmp"		/* queue file being written */
+#define REAP_WORK_TRAILER	".work"		/* queue file being reaped */
+#define REAP_QUE_DELAY		"<PLUSET>1s</PLUSET>"
+#define REAP_RETRY_DELAY	"<PLUSET>10m</PLUSET>"	/* for the paths which
+							 * failed */
+
+/* the queue files of one collection delete, one per resource. They are
+ * written to a tmp name and only handed to the reaper once the catalog
+ * delete has been committed */
+typedef struct ReapQueFile {
+    char rescName[NAME_LEN];
+    char quePath[MAX_NAME_LEN];
+    FILE *fp;
+    int fileCnt;
+    struct ReapQueFile *next;
+} reapQueFile_t;
+
+typedef struct ReapQue {
+    int fileCnt;
+    reapQueFile_t *queHead;
+} reapQue_t;
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+int
+isRmCollTree ();
+int
+getReapNumThreads ();
+int
+addToReapQue (reapQue_t *reapQue, char *rescName, char *filePath);
+int
+commitReapQue (rsComm_t *rsComm, reapQue_t *reapQue);
+void
+abortReapQue (reapQue_t *reapQue);
+int
+queReapVault (rsComm_t *rsComm, char *rescName, char *queDelay);
+int
+reapVault (rsComm_t *rsComm, char *rescName, int numThreads, int *outCnt);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif	/* VAULT_REAPER_H */
@@ -151,257 +151,222 @@ getDataObjFileMeta (rsComm_t *rsComm, char *data_id, keyValPair_t *condInput)
 }
 #endif /* FILESYSTEM_META */
     
-int
-getDataObjInfo (rsComm_t *rsComm, dataObjInp_t *dataObjInp, 
-dataObjInfo_t **dataObjInfoHead,char *accessPerm, int ignoreCondInput)
+/* setDataObjInfoQuery - add the columns of a dataObjInfo_t and the
+ * access check to genQueryInp */
+static void
+setDataObjInfoQuery (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
+genQueryInp_t *genQueryInp, char *accessPerm)
 {
-    genQueryInp_t genQueryInp;
-    genQueryOut_t *genQueryOut = NULL;
-    int i, status;
-    dataObjInfo_t *dataObjInfo;
-    char condStr[MAX_NAME_LEN]; 
-    char *tmpStr;
-    sqlResult_t *dataId, *collId, *replNum, *version, *dataType, *dataSize,
-      *rescGroupName, *rescName, *filePath, *dataOwnerName, *dataOwnerZone,
-      *replStatus, *statusString, *chksum, *dataExpiry, *dataMapId, 
-      *dataComments, *dataCreate, *dataModify, *dataMode, *dataName, *collName;
-    char *tmpDataId, *tmpCollId, *tmpReplNum, *tmpVersion, *tmpDataType, 
-      *tmpDataSize, *tmpRescGroupName, *tmpRescName, *tmpFilePath, 
-      *tmpDataOwnerName, *tmpDataOwnerZone, *tmpReplStatus, *tmpStatusString, 
-      *tmpChksum, *tmpDataExpiry, *tmpDataMapId, *tmpDataComments, 
-      *tmpDataCreate, *tmpDataModify, *tmpDataMode, *tmpDataName, *tmpCollName;
     char accStr[LONG_NAME_LEN];
-    int qcondCnt;
-    int writeFlag;
-
-    *dataObjInfoHead = NULL;
-
-    qcondCnt = initDataObjInfoQuery (dataObjInp, &genQueryInp, 
-      ignoreCondInput);
-
-    if (qcondCnt < 0) {
-	return (qcondCnt);
-    }
-
-    /* need to do RESC_NAME_KW here because not all query need this */
-
-    if (ignoreCondInput == 0 && (tmpStr =
-      getValByKey (&dataObjInp->condInput, RESC_NAME_KW)) != NULL) {
-        snprintf (condStr, NAME_LEN, "='%s'", tmpStr);
-        addInxVal (&genQueryInp.sqlCondInp, COL_D_RESC_NAME, condStr);
-	qcondCnt++;
-    }
+    char *tmpStr;
 
-    addInxIval (&genQueryInp.selectInp, COL_D_DATA_ID, 1);
-    addInxIval (&genQueryInp.selectInp, COL_DATA_NAME, 1);
-    addInxIval (&genQueryInp.selectInp, COL_COLL_NAME, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_COLL_ID, 1);
-    addInxIval (&genQueryInp.selectInp, COL_DATA_REPL_NUM, 1);
-    addInxIval (&genQueryInp.selectInp, COL_DATA_VERSION, 1);
-    addInxIval (&genQueryInp.selectInp, COL_DATA_TYPE_NAME, 1);
-    addInxIval (&genQueryInp.selectInp, COL_DATA_SIZE, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_RESC_GROUP_NAME, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_RESC_NAME, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_DATA_PATH, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_OWNER_NAME, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_OWNER_ZONE, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_REPL_STATUS, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_DATA_STATUS, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_DATA_CHECKSUM, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_EXPIRY, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_MAP_ID, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_COMMENTS, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_CREATE_TIME, 1);
-    addInxIval (&genQueryInp.selectInp, COL_D_MODIFY_TIME, 1);
-    addInxIval (&genQueryInp.selectInp, COL_DATA_MODE, 1);
+    addInxIval (&genQueryInp->selectInp, COL_D_DATA_ID, 1);
+    addInxIval (&genQueryInp->selectInp, COL_DATA_NAME, 1);
+    addInxIval (&genQueryInp->selectInp, COL_COLL_NAME, 1);
+    addInxIval (&genQueryInp->selectInp, COL_D_COLL_ID, 1);
+    addInxIval (&genQueryInp->selectInp, COL_DATA_REPL_NUM, 1);
+    addInxIval (&genQueryInp->selectInp, COL_DATA_VERSION, 1);
+    addInxIval (&genQueryInp->selectInp, COL_DATA_TYPE_NAME, 1);
+    addInxIval (&genQueryInp->selectInp, COL_DATA_SIZE, 1);
+    addInxIval (&genQueryInp->selectInp, COL_D_RESC_GROUP_NAME, 1);
+    addInxIval (&genQueryInp->selectInp, COL_D_RESC_NAME, 1);
+    addInxIval (&genQueryInp->selectInp, COL_D_DATA_PATH, 1);
+    addInxIval (&genQueryInp->selectInp, COL_D_OWNER_NAME, 1);
+    addInxIval (&genQueryInp->selectInp, COL_D_OWNER_ZONE, 1);
+    addInxIval (&genQueryInp->selectInp, COL_D_REPL_STATUS, 1);
+    addInxIval (&genQueryInp->selectInp, COL_D_DATA_STATUS, 1);
+    addInxIval (&genQueryInp->selectInp, COL_D_DATA_CHECKSUM, 1);
+    addInxIval (&genQueryInp->selectInp, COL_D_EXPIRY, 1);
+    addInxIval (&genQueryInp->selectInp, COL_D_MAP_ID, 1);
+    addInxIval (&genQueryInp->selectInp, COL_D_COMMENTS, 1);
+    addInxIval (&genQueryInp->selectInp, COL_D_CREATE_TIME, 1);
+    addInxIval (&genQueryInp->selectInp, COL_D_MODIFY_TIME, 1);
+    addInxIval (&genQueryInp->selectInp, COL_DATA_MODE, 1);
 
     if (accessPerm != NULL) {
         snprintf (accStr, LONG_NAME_LEN, "%s", rsComm->clientUser.userName);
-        addKeyVal (&genQueryInp.condInput, USER_NAME_CLIENT_KW, accStr);
+        addKeyVal (&genQueryInp->condInput, USER_NAME_CLIENT_KW, accStr);
 
         snprintf (accStr, LONG_NAME_LEN, "%s", rsComm->clientUser.rodsZone);
-        addKeyVal (&genQueryInp.condInput, RODS_ZONE_CLIENT_KW, accStr);
+        addKeyVal (&genQueryInp->condInput, RODS_ZONE_CLIENT_KW, accStr);
 
         snprintf (accStr, LONG_NAME_LEN, "%s", accessPerm);
-        addKeyVal (&genQueryInp.condInput, ACCESS_PERMISSION_KW, accStr);
+        addKeyVal (&genQueryInp->condInput, ACCESS_PERMISSION_KW, accStr);
     }
     if ((tmpStr= getValByKey(&dataObjInp->condInput, TICKET_KW)) != NULL) {
-          addKeyVal (&genQueryInp.condInput, TICKET_KW, tmpStr);
-    }
-    genQueryInp.maxRows = MAX_SQL_ROWS;
-
-    status =  rsGenQuery (rsComm, &genQueryInp, &genQueryOut);
-
-    clearGenQueryInp (&genQueryInp);
-
-    if (status < 0) {
-        if (status !=CAT_NO_ROWS_FOUND) {
-            rodsLog (LOG_NOTICE,
-              "getDataObjInfo: rsGenQuery error, status = %d",
-              status);
-        }
-        return (status);
+          addKeyVal (&genQueryInp->condInput, TICKET_KW, tmpStr);
     }
+}
 
-    if (genQueryOut == NULL) {
-        rodsLog (LOG_NOTICE,
-          "getDataObjInfo: NULL genQueryOut");
-        return (SYS_INTERNAL_NULL_INPUT_ERR);
-    }
+/* genQueryOutToDataObjInfo - queue a dataObjInfo_t for each row of the
+ * getDataObjInfo query in dataObjInfoHead */
+static int
+genQueryOutToDataObjInfo (rsComm_t *rsComm, genQueryOut_t *genQueryOut,
+int writeFlag, dataObjInfo_t **dataObjInfoHead)
+{
+    int i, status;
+    dataObjInfo_t *dataObjInfo;
+    sqlResult_t *dataId, *collId, *replNum, *version, *dataType, *dataSize,
+      *rescGroupName, *rescName, *filePath, *dataOwnerName, *dataOwnerZone,
+      *replStatus, *statusString, *chksum, *dataExpiry, *dataMapId, 
+      *dataComments, *dataCreate, *dataModify, *dataMode, *dataName, *collName;
+    char *tmpDataId, *tmpCollId, *tmpReplNum, *tmpVersion, *tmpDataType, 
+      *tmpDataSize, *tmpRescGroupName, *tmpRescName, *tmpFilePath, 
+      *tmpDataOwnerName, *tmpDataOwnerZone, *tmpReplStatus, *tmpStatusString, 
+      *tmpChksum, *tmpDataExpiry, *tmpDataMapId, *tmpDataComments, 
+      *tmpDataCreate, *tmpDataModify, *tmpDataMode, *tmpDataName, *tmpCollName;
 
     if ((dataOwnerName =
       getSqlResultByInx (genQueryOut, COL_D_OWNER_NAME)) == NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_D_OWNER_NAME failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_D_OWNER_NAME failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((dataName =
       getSqlResultByInx (genQueryOut, COL_DATA_NAME)) == NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_DATA_NAME failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_DATA_NAME failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((collName =
       getSqlResultByInx (genQueryOut, COL_COLL_NAME)) == NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_COLL_NAME failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_COLL_NAME failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((dataId = getSqlResultByInx (genQueryOut, COL_D_DATA_ID)) == NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_D_DATA_ID failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_D_DATA_ID failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((collId = getSqlResultByInx (genQueryOut, COL_D_COLL_ID)) == NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_D_COLL_ID failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_D_COLL_ID failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((replNum = getSqlResultByInx (genQueryOut, COL_DATA_REPL_NUM)) == 
      NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_DATA_REPL_NUM failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_DATA_REPL_NUM failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((version = getSqlResultByInx (genQueryOut, COL_DATA_VERSION)) == 
       NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_DATA_VERSION failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_DATA_VERSION failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((dataType = getSqlResultByInx (genQueryOut, COL_DATA_TYPE_NAME)) == 
       NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_DATA_TYPE_NAME failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_DATA_TYPE_NAME failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((dataSize = getSqlResultByInx (genQueryOut, COL_DATA_SIZE)) == NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_DATA_SIZE failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_DATA_SIZE failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((rescGroupName = 
       getSqlResultByInx ( genQueryOut, COL_D_RESC_GROUP_NAME)) == NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo:getSqlResultByInx for COL_D_RESC_GROUP_NAME failed");
+          "genQueryOutToDataObjInfo:getSqlResultByInx for COL_D_RESC_GROUP_NAME failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((rescName = getSqlResultByInx (genQueryOut, COL_D_RESC_NAME)) == 
       NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_D_RESC_NAME failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_D_RESC_NAME failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((filePath = getSqlResultByInx (genQueryOut, COL_D_DATA_PATH)) == 
       NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_D_DATA_PATH failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_D_DATA_PATH failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((dataOwnerZone = 
       getSqlResultByInx (genQueryOut, COL_D_OWNER_ZONE)) == NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_D_OWNER_ZONE failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_D_OWNER_ZONE failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((replStatus = 
       getSqlResultByInx (genQueryOut, COL_D_REPL_STATUS)) == NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_D_REPL_STATUS failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_D_REPL_STATUS failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((statusString = 
       getSqlResultByInx (genQueryOut, COL_D_DATA_STATUS)) == NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_D_DATA_STATUS failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_D_DATA_STATUS failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((chksum = 
       getSqlResultByInx (genQueryOut, COL_D_DATA_CHECKSUM)) == NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_D_DATA_CHECKSUM failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_D_DATA_CHECKSUM failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((dataExpiry = 
       getSqlResultByInx (genQueryOut, COL_D_EXPIRY)) == NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_D_EXPIRY failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_D_EXPIRY failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((dataMapId =
       getSqlResultByInx (genQueryOut, COL_D_MAP_ID)) == NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_D_MAP_ID failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_D_MAP_ID failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((dataComments = 
       getSqlResultByInx (genQueryOut, COL_D_COMMENTS)) == NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_D_COMMENTS failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_D_COMMENTS failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((dataCreate = 
       getSqlResultByInx (genQueryOut, COL_D_CREATE_TIME)) == NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_D_CREATE_TIME failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_D_CREATE_TIME failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((dataModify =
       getSqlResultByInx (genQueryOut, COL_D_MODIFY_TIME)) == NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_D_MODIFY_TIME failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_D_MODIFY_TIME failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
     if ((dataMode =
       getSqlResultByInx (genQueryOut, COL_DATA_MODE)) == NULL) {
         rodsLog (LOG_NOTICE,
-          "getDataObjInfo: getSqlResultByInx for COL_DATA_MODE failed");
+          "genQueryOutToDataObjInfo: getSqlResultByInx for COL_DATA_MODE failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
 
-    writeFlag = getWriteFlag (dataObjInp->openFlags);
-
    for (i = 0;i < genQueryOut->rowCnt; i++) {
         dataObjInfo = (dataObjInfo_t *) malloc (sizeof (dataObjInfo_t));
         memset (dataObjInfo, 0, sizeof (dataObjInfo_t));
@@ -435,7 +400,7 @@ dataObjInfo_t **dataObjInfoHead,char *accessPerm, int ignoreCondInput)
         status = resolveResc (tmpRescName, &dataObjInfo->rescInfo);
 	if (status < 0) {
 	    rodsLog (LOG_DEBUG,
-              "getDataObjInfo: resolveResc error for %s, status = %d",
+              "genQueryOutToDataObjInfo: resolveResc error for %s, status = %d",
 	      tmpRescName, status);
 #if 0	/* this could happen for remote zone resource */
 	    return (status);
@@ -468,12 +433,501 @@ dataObjInfo_t **dataObjInfoHead,char *accessPerm, int ignoreCondInput)
 
 	queDataObjInfo (dataObjInfoHead, dataObjInfo, 1, 0);
     }
-    
+    return (0);
+}
+
+static int
+_getDataObjInfo (rsComm_t *rsComm, dataObjInp_t *dataObjInp, 
+dataObjInfo_t **dataObjInfoHead,char *accessPerm, int ignoreCondInput)
+{
+    genQueryInp_t genQueryInp;
+    genQueryOut_t *genQueryOut = NULL;
+    int status;
+    char condStr[MAX_NAME_LEN]; 
+    char *tmpStr;
+    int qcondCnt;
+
+    *dataObjInfoHead = NULL;
+
+    qcondCnt = initDataObjInfoQuery (dataObjInp, &genQueryInp, 
+      ignoreCondInput);
+
+    if (qcondCnt < 0) {
+	return (qcondCnt);
+    }
+
+    /* need to do RESC_NAME_KW here because not all query need this */
+
+    if (ignoreCondInput == 0 && (tmpStr =
+      getValByKey (&dataObjInp->condInput, RESC_NAME_KW)) != NULL) {
+        snprintf (condStr, NAME_LEN, "='%s'", tmpStr);
+        addInxVal (&genQueryInp.sqlCondInp, COL_D_RESC_NAME, condStr);
+	qcondCnt++;
+    }
+
+    setDataObjInfoQuery (rsComm, dataObjInp, &genQueryInp, accessPerm);
+    genQueryInp.maxRows = MAX_SQL_ROWS;
+
+    status =  rsGenQuery (rsComm, &genQueryInp, &genQueryOut);
+
+    clearGenQueryInp (&genQueryInp);
+
+    if (status < 0) {
+        if (status !=CAT_NO_ROWS_FOUND) {
+            rodsLog (LOG_NOTICE,
+              "getDataObjInfo: rsGenQuery error, status = %d",
+              status);
+        }
+        return (status);
+    }
+
+    if (genQueryOut == NULL) {
+        rodsLog (LOG_NOTICE,
+          "getDataObjInfo: NULL genQueryOut");
+        return (SYS_INTERNAL_NULL_INPUT_ERR);
+    }
+
+    status = genQueryOutToDataObjInfo (rsComm, genQueryOut,
+      getWriteFlag (dataObjInp->openFlags), dataObjInfoHead);
     freeGenQueryOut (&genQueryOut);
+    if (status < 0) {
+        freeAllDataObjInfo (*dataObjInfoHead);
+        *dataObjInfoHead = NULL;
+        return (status);
+    }
 
     return (qcondCnt);
 }
 
+/* The getDataObjInfo cache. The results of getDataObjInfo are kept for
+ * the duration of a data object API request (between
+ * beginDataObjInfoCache and endDataObjInfoCache) so that rules and
+ * micro-services which look up the same object several times in a request
+ * only query the catalog once. Only the APIs in DataObjInfoCacheApi are
+ * cached. Requests which run arbitrary rules, such as rsExecMyRule, may
+ * change the catalog in ways the cache does not see. Entries are dropped
+ * when the agent changes the catalog entry of the object and after
+ * DATA_OBJ_INFO_CACHE_AGE sec, which also bounds how long another agent's
+ * change goes unseen. The size is set with the dataObjInfoCacheSize env
+ * variable, 0 disables the cache. */
+
+typedef struct dataObjInfoCacheEnt {
+    char key[MAX_NAME_LEN + LONG_NAME_LEN];
+    char objPath[MAX_NAME_LEN];
+    int status;
+    time_t cacheTime;
+    dataObjInfo_t *dataObjInfoHead;
+} dataObjInfoCacheEnt_t;
+
+static int DataObjInfoCacheApi[] = {
+    DATA_OBJ_CREATE_AN, DATA_OBJ_OPEN_AN, DATA_OBJ_CLOSE_AN,
+    DATA_OBJ_PUT_AN, DATA_OBJ_GET_AN, DATA_OBJ_REPL_AN, DATA_OBJ_COPY_AN,
+    DATA_OBJ_PHYMV_AN, DATA_OBJ_TRIM_AN, DATA_OBJ_CHKSUM_AN,
+    DATA_OBJ_UNLINK_AN, DATA_OBJ_TRUNCATE_AN, DATA_OBJ_DELTA_AN,
+    DATA_OBJ_OPEN_AND_STAT_AN, DATA_OBJ_CREATE_AND_STAT_AN, OBJ_STAT_AN,
+    GET_HOST_FOR_PUT_AN, GET_HOST_FOR_GET_AN,
+    COLL_REPL_AN,	/* the batch lookup of the objects it replicates */
+    -1
+};
+
+static dataObjInfoCacheEnt_t *dataObjInfoCache = NULL;
+static int dataObjInfoCacheSize = -1;
+static int dataObjInfoCacheInx = 0;
+static int dataObjInfoCacheDepth = 0;
+static int dataObjInfoCacheHits = 0;
+static int dataObjInfoCacheMisses = 0;
+
+static int
+getDataObjInfoCacheSize ()
+{
+    char *tmpStr;
+
+    if (dataObjInfoCacheSize < 0) {
+        if ((tmpStr = getenv (DATA_OBJ_INFO_CACHE_SIZE)) != NULL) {
+            dataObjInfoCacheSize = atoi (tmpStr);
+        } else {
+            dataObjInfoCacheSize = DEF_DATA_OBJ_INFO_CACHE_SIZE;
+        }
+        if (dataObjInfoCacheSize < 0) {
+            dataObjInfoCacheSize = 0;
+        } else if (dataObjInfoCacheSize > MAX_DATA_OBJ_INFO_CACHE_SIZE) {
+            dataObjInfoCacheSize = MAX_DATA_OBJ_INFO_CACHE_SIZE;
+        }
+    }
+    return (dataObjInfoCacheSize);
+}
+
+static void
+clearDataObjInfoCacheEnt (dataObjInfoCacheEnt_t *cacheEnt)
+{
+    dataObjInfo_t *tmpDataObjInfo;
+
+    for (tmpDataObjInfo = cacheEnt->dataObjInfoHead; tmpDataObjInfo != NULL;
+      tmpDataObjInfo = tmpDataObjInfo->next) {
+        clearKeyVal (&tmpDataObjInfo->condInput);
+    }
+    freeAllDataObjInfo (cacheEnt->dataObjInfoHead);
+    memset (cacheEnt, 0, sizeof (dataObjInfoCacheEnt_t));
+}
+
+/* dupDataObjInfoList - make a copy of the dataObjInfo list for the caller
+ * of getDataObjInfo, which is free to modify and free it */
+static dataObjInfo_t *
+dupDataObjInfoList (dataObjInfo_t *srcDataObjInfoHead, int writeFlag)
+{
+    dataObjInfo_t *srcDataObjInfo, *dataObjInfo;
+    dataObjInfo_t *dataObjInfoHead = NULL;
+
+    for (srcDataObjInfo = srcDataObjInfoHead; srcDataObjInfo != NULL;
+      srcDataObjInfo = srcDataObjInfo->next) {
+        dataObjInfo = (dataObjInfo_t *) malloc (sizeof (dataObjInfo_t));
+        *dataObjInfo = *srcDataObjInfo;
+        memset (&dataObjInfo->condInput, 0, sizeof (keyValPair_t));
+        if (srcDataObjInfo->condInput.len > 0) {
+            replKeyVal (&srcDataObjInfo->condInput, &dataObjInfo->condInput);
+        }
+        dataObjInfo->specColl = NULL;
+        dataObjInfo->next = NULL;
+        dataObjInfo->writeFlag = writeFlag;
+        queDataObjInfo (&dataObjInfoHead, dataObjInfo, 1, 0);
+    }
+    return (dataObjInfoHead);
+}
+
+/* getDataObjInfoCacheKey - make the cache key of a getDataObjInfo call.
+ * Returns 0 if the call can be cached and -1 otherwise. */
+static int
+getDataObjInfoCacheKey (rsComm_t *rsComm, char *objPath, 
+keyValPair_t *condInput, char *accessPerm, int ignoreCondInput, char *key)
+{
+    char *dataId, *replNum = NULL, *rescName = NULL;
+    int len;
+
+    if (condInput != NULL) {
+        if (getValByKey (condInput, TICKET_KW) != NULL) return (-1);
+        dataId = getValByKey (condInput, QUERY_BY_DATA_ID_KW);
+        if (ignoreCondInput == 0) {
+            replNum = getValByKey (condInput, REPL_NUM_KW);
+            rescName = getValByKey (condInput, RESC_NAME_KW);
+        }
+    } else {
+        dataId = NULL;
+    }
+    
+    len = snprintf (key, MAX_NAME_LEN + LONG_NAME_LEN, 
+      "%s%s|%s|%s#%s|%s|%s", 
+      dataId != NULL ? "id:" : "", dataId != NULL ? dataId : objPath,
+      accessPerm != NULL ? accessPerm : "",
+      accessPerm != NULL ? rsComm->clientUser.userName : "",
+      accessPerm != NULL ? rsComm->clientUser.rodsZone : "",
+      replNum != NULL ? replNum : "", rescName != NULL ? rescName : "");
+    if (len >= MAX_NAME_LEN + LONG_NAME_LEN) return (-1);
+    return (0);
+}
+
+static dataObjInfoCacheEnt_t *
+matchDataObjInfoCache (char *key)
+{
+    int i;
+
+    for (i = 0; i < dataObjInfoCacheSize; i++) {
+        if (dataObjInfoCache[i].key[0] != '\0' &&
+          strcmp (dataObjInfoCache[i].key, key) == 0) {
+            if (time (0) - dataObjInfoCache[i].cacheTime >
+              DATA_OBJ_INFO_CACHE_AGE) {
+                clearDataObjInfoCacheEnt (&dataObjInfoCache[i]);
+                return (NULL);
+            }
+            return (&dataObjInfoCache[i]);
+        }
+    }
+    return (NULL);
+}
+
+static void
+putDataObjInfoCache (char *key, char *objPath, int status,
+dataObjInfo_t *dataObjInfoHead)
+{
+    dataObjInfoCacheEnt_t *cacheEnt;
+
+    if ((cacheEnt = matchDataObjInfoCache (key)) == NULL) {
+        cacheEnt = &dataObjInfoCache[dataObjInfoCacheInx];
+        dataObjInfoCacheInx = (dataObjInfoCacheInx + 1) % dataObjInfoCacheSize;
+    }
+    clearDataObjInfoCacheEnt (cacheEnt);
+    rstrcpy (cacheEnt->key, key, MAX_NAME_LEN + LONG_NAME_LEN);
+    rstrcpy (cacheEnt->objPath, objPath, MAX_NAME_LEN);
+    cacheEnt->status = status;
+    cacheEnt->cacheTime = time (0);
+    cacheEnt->dataObjInfoHead = dataObjInfoHead;
+}
+
+/* beginDataObjInfoCache - start caching getDataObjInfo results if
+ * apiNumber is one of DataObjInfoCacheApi. Returns 1 if it did, and
+ * endDataObjInfoCache must then be called at the end of the request.
+ * Calls may be nested, the cache is emptied by the outermost 
+ * endDataObjInfoCache. */
+int
+beginDataObjInfoCache (int apiNumber)
+{
+    int i;
+
+    if (getDataObjInfoCacheSize () <= 0) return (0);
+
+    for (i = 0; DataObjInfoCacheApi[i] >= 0; i++) {
+        if (DataObjInfoCacheApi[i] == apiNumber) break;
+    }
+    if (DataObjInfoCacheApi[i] < 0) return (0);
+
+    if (dataObjInfoCache == NULL) {
+        dataObjInfoCache = (dataObjInfoCacheEnt_t *) calloc (
+          dataObjInfoCacheSize, sizeof (dataObjInfoCacheEnt_t));
+        if (dataObjInfoCache == NULL) return (SYS_MALLOC_ERR);
+    }
+    dataObjInfoCacheDepth++;
+    return (1);
+}
+
+int
+endDataObjInfoCache ()
+{
+    if (dataObjInfoCacheDepth <= 0) return (0);
+
+    dataObjInfoCacheDepth--;
+    if (dataObjInfoCacheDepth > 0) return (0);
+
+    invalidateDataObjInfoCache (NULL);
+    if (dataObjInfoCacheHits > 0) {
+        rodsLog (LOG_DEBUG,
+          "endDataObjInfoCache: %d hits, %d misses",
+          dataObjInfoCacheHits, dataObjInfoCacheMisses);
+    }
+    dataObjInfoCacheHits = dataObjInfoCacheMisses = 0;
+    return (0);
+}
+
+/* invalidateDataObjInfoCache - drop the cached entries of objPath, or all
+ * entries if objPath is NULL. Must be called whenever the catalog entry
+ * of a data object is changed. */
+int
+invalidateDataObjInfoCache (char *objPath)
+{
+    int i;
+
+    if (dataObjInfoCache == NULL) return (0);
+
+    for (i = 0; i < dataObjInfoCacheSize; i++) {
+        if (dataObjInfoCache[i].key[0] == '\0') continue;
+        if (objPath == NULL || 
+          strcmp (dataObjInfoCache[i].objPath, objPath) == 0) {
+            clearDataObjInfoCacheEnt (&dataObjInfoCache[i]);
+        }
+    }
+    return (0);
+}
+
+/* getDataObjInfo - get the dataObjInfo of all the copies of
+ * dataObjInp->objPath which match the conditions. The returned
+ * dataObjInfoHead belongs to the caller. Returns the number of
+ * conditions from condInput used in the query.
+ */
+int
+getDataObjInfo (rsComm_t *rsComm, dataObjInp_t *dataObjInp, 
+dataObjInfo_t **dataObjInfoHead,char *accessPerm, int ignoreCondInput)
+{
+    char key[MAX_NAME_LEN + LONG_NAME_LEN];
+    dataObjInfoCacheEnt_t *cacheEnt;
+    dataObjInfo_t *myDataObjInfoHead = NULL;
+    int status;
+
+    if (dataObjInfoCacheDepth <= 0 || 
+      getDataObjInfoCacheKey (rsComm, dataObjInp->objPath, 
+      &dataObjInp->condInput, accessPerm, ignoreCondInput, key) < 0) {
+        return (_getDataObjInfo (rsComm, dataObjInp, dataObjInfoHead,
+          accessPerm, ignoreCondInput));
+    }
+
+    if ((cacheEnt = matchDataObjInfoCache (key)) != NULL) {
+        dataObjInfoCacheHits++;
+        *dataObjInfoHead = dupDataObjInfoList (cacheEnt->dataObjInfoHead,
+          getWriteFlag (dataObjInp->openFlags));
+        return (cacheEnt->status);
+    }
+    dataObjInfoCacheMisses++;
+
+    status = _getDataObjInfo (rsComm, dataObjInp, &myDataObjInfoHead,
+      accessPerm, ignoreCondInput);
+
+    if (status >= 0) {
+        putDataObjInfoCache (key, myDataObjInfoHead->objPath, status,
+          myDataObjInfoHead);
+        *dataObjInfoHead = dupDataObjInfoList (myDataObjInfoHead,
+          getWriteFlag (dataObjInp->openFlags));
+    } else {
+        if (status == CAT_NO_ROWS_FOUND && 
+          getValByKey (&dataObjInp->condInput, QUERY_BY_DATA_ID_KW) == NULL) {
+            putDataObjInfoCache (key, dataObjInp->objPath, status, NULL);
+        }
+        *dataObjInfoHead = NULL;
+    }
+    return (status);
+}
+
+/* getDataObjInfoBatch - get the dataObjInfo of the objects in objPathArray
+ * into the getDataObjInfo cache with as few queries as possible, so that
+ * the following getDataObjInfo calls for these objects, with the same
+ * accessPerm and ignoreCondInput, do not query the catalog. condInput
+ * of dataObjInp is used the same way as in getDataObjInfo. Paths in a
+ * different zone than objPathArray[0] are left out.
+ * Returns the number of paths cached.
+ */
+int
+getDataObjInfoBatch (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
+char *accessPerm, int ignoreCondInput, int numPath, char **objPathArray)
+{
+    genQueryInp_t genQueryInp;
+    genQueryOut_t *genQueryOut = NULL;
+    dataObjInfo_t *dataObjInfoHead = NULL;
+    dataObjInfo_t *tmpDataObjInfo, *nextDataObjInfo;
+    dataObjInfo_t *batchInfoHead[MAX_DATA_OBJ_INFO_BATCH];
+    char *batchPath[MAX_DATA_OBJ_INFO_BATCH];
+    char collCond[MAX_DATA_OBJ_INFO_COND_LEN];
+    char dataCond[MAX_DATA_OBJ_INFO_COND_LEN];
+    char myColl[MAX_NAME_LEN], myData[MAX_NAME_LEN];
+    char zoneName[NAME_LEN], myZone[NAME_LEN];
+    char key[MAX_NAME_LEN + LONG_NAME_LEN];
+    char condStr[MAX_NAME_LEN + 4];	/* room for the quotes */
+    char *tmpStr;
+    int collLen, dataLen;
+    int numBatch = 0;
+    int maxBatch;
+    int qcondCnt = 0;
+    int status, i;
+
+    if (dataObjInfoCacheDepth <= 0 || numPath <= 0) return (0);
+    if (getValByKey (&dataObjInp->condInput, TICKET_KW) != NULL ||
+      getValByKey (&dataObjInp->condInput, QUERY_BY_DATA_ID_KW) != NULL)
+        return (0);
+
+    maxBatch = MAX_DATA_OBJ_INFO_BATCH;
+    if (maxBatch > dataObjInfoCacheSize) maxBatch = dataObjInfoCacheSize;
+
+    getZoneNameFromHint (objPathArray[0], zoneName, NAME_LEN);
+    rstrcpy (collCond, "in (", MAX_DATA_OBJ_INFO_COND_LEN);
+    rstrcpy (dataCond, "in (", MAX_DATA_OBJ_INFO_COND_LEN);
+    collLen = dataLen = strlen (collCond);
+
+    for (i = 0; i < numPath && numBatch < maxBatch; i++) {
+        if (strchr (objPathArray[i], '\'') != NULL) continue;
+        getZoneNameFromHint (objPathArray[i], myZone, NAME_LEN);
+        if (strcmp (myZone, zoneName) != 0) continue;
+        if (getDataObjInfoCacheKey (rsComm, objPathArray[i], 
+          &dataObjInp->condInput, accessPerm, ignoreCondInput, key) < 0 ||
+          matchDataObjInfoCache (key) != NULL) continue;
+        if (splitPathByKey (objPathArray[i], myColl, myData, '/') < 0)
+            continue;
+        if (collLen + (int) strlen (myColl) + 4 >= 
+          MAX_DATA_OBJ_INFO_COND_LEN ||
+          dataLen + (int) strlen (myData) + 4 >= MAX_DATA_OBJ_INFO_COND_LEN)
+            break;
+        /* the same coll is often repeated */
+        snprintf (condStr, sizeof (condStr), "'%s'", myColl);
+        if (strstr (collCond, condStr) == NULL) {
+            collLen += snprintf (&collCond[collLen], 
+              MAX_DATA_OBJ_INFO_COND_LEN - collLen, "%s%s", 
+              collLen > 4 ? "," : "", condStr);
+        }
+        snprintf (condStr, sizeof (condStr), "'%s'", myData);
+        if (strstr (dataCond, condStr) == NULL) {
+            dataLen += snprintf (&dataCond[dataLen], 
+              MAX_DATA_OBJ_INFO_COND_LEN - dataLen, "%s%s", 
+              dataLen > 4 ? "," : "", condStr);
+        }
+        batchPath[numBatch] = objPathArray[i];
+        batchInfoHead[numBatch] = NULL;
+        numBatch++;
+    }
+
+    if (numBatch <= 1) {
+        /* nothing to gain. Let getDataObjInfo do it */
+        return (0);
+    }
+    rstrcat (collCond, ")", MAX_DATA_OBJ_INFO_COND_LEN);
+    rstrcat (dataCond, ")", MAX_DATA_OBJ_INFO_COND_LEN);
+
+    memset (&genQueryInp, 0, sizeof (genQueryInp));
+    addInxVal (&genQueryInp.sqlCondInp, COL_COLL_NAME, collCond);
+    addInxVal (&genQueryInp.sqlCondInp, COL_DATA_NAME, dataCond);
+    if (ignoreCondInput == 0) {
+        if ((tmpStr = getValByKey (&dataObjInp->condInput, REPL_NUM_KW)) 
+          != NULL) {
+            snprintf (condStr, NAME_LEN, "='%s'", tmpStr);
+            addInxVal (&genQueryInp.sqlCondInp, COL_DATA_REPL_NUM, condStr);
+            qcondCnt++;
+        }
+        if ((tmpStr = getValByKey (&dataObjInp->condInput, RESC_NAME_KW)) 
+          != NULL) {
+            snprintf (condStr, NAME_LEN, "='%s'", tmpStr);
+            addInxVal (&genQueryInp.sqlCondInp, COL_D_RESC_NAME, condStr);
+            qcondCnt++;
+        }
+    }
+    setDataObjInfoQuery (rsComm, dataObjInp, &genQueryInp, accessPerm);
+    genQueryInp.maxRows = MAX_SQL_ROWS;
+
+    status = rsGenQuery (rsComm, &genQueryInp, &genQueryOut);
+    while (status >= 0 && genQueryOut != NULL) {
+        status = genQueryOutToDataObjInfo (rsComm, genQueryOut,
+          getWriteFlag (dataObjInp->openFlags), &dataObjInfoHead);
+        if (status < 0 || genQueryOut->continueInx <= 0) break;
+        genQueryInp.continueInx = genQueryOut->continueInx;
+        freeGenQueryOut (&genQueryOut);
+        status = rsGenQuery (rsComm, &genQueryInp, &genQueryOut);
+    }
+    if (genQueryOut != NULL && genQueryOut->continueInx > 0) {
+        /* close the statement */
+        genQueryInp.continueInx = genQueryOut->continueInx;
+        genQueryInp.maxRows = 0;
+        freeGenQueryOut (&genQueryOut);
+        rsGenQuery (rsComm, &genQueryInp, &genQueryOut);
+    }
+    freeGenQueryOut (&genQueryOut);
+    clearGenQueryInp (&genQueryInp);
+
+    if (status < 0 && status != CAT_NO_ROWS_FOUND) {
+        rodsLog (LOG_NOTICE,
+          "getDataObjInfoBatch: rsGenQuery error, status = %d", status);
+        freeAllDataObjInfo (dataObjInfoHead);
+        return (status);
+    }
+
+    /* the query gives the cross product of the colls and the data names.
+     * Sort the rows out by objPath and drop the ones not asked for */
+    for (tmpDataObjInfo = dataObjInfoHead; tmpDataObjInfo != NULL;
+      tmpDataObjInfo = nextDataObjInfo) {
+        nextDataObjInfo = tmpDataObjInfo->next;
+        tmpDataObjInfo->next = NULL;
+        for (i = 0; i < numBatch; i++) {
+            if (strcmp (tmpDataObjInfo->objPath, batchPath[i]) == 0) break;
+        }
+        if (i < numBatch) {
+            queDataObjInfo (&batchInfoHead[i], tmpDataObjInfo, 1, 0);
+        } else {
+            clearKeyVal (&tmpDataObjInfo->condInput);
+            freeDataObjInfo (tmpDataObjInfo);
+        }
+    }
+
+    for (i = 0; i < numBatch; i++) {
+        getDataObjInfoCacheKey (rsComm, batchPath[i], &dataObjInp->condInput,
+          accessPerm, ignoreCondInput, key);
+        putDataObjInfoCache (key, batchPath[i], 
+          batchInfoHead[i] != NULL ? qcondCnt : CAT_NO_ROWS_FOUND,
+          batchInfoHead[i]);
+    }
+    return (numBatch);
+}
+
 int
 sortObjInfo (dataObjInfo_t **dataObjInfoHead, 
 dataObjInfo_t **currentArchInfo, dataObjInfo_t **currentCacheInfo, 
@@ -991,7 +1445,7 @@ initDataObjInfoQuery (dataObjInp_t *dataObjInp, genQueryInp_t *genQueryInp,
 int ignoreCondInput)
 {
     char myColl[MAX_NAME_LEN], myData[MAX_NAME_LEN];
-    char condStr[MAX_NAME_LEN];
+    char condStr[MAX_NAME_LEN + 4];	/* room for the quotes */
     char *tmpStr;
     int status;
     int qcondCnt = 0;
@@ -1010,12 +1464,12 @@ int ignoreCondInput)
               dataObjInp->objPath, status);
             return (status);
         }
-        snprintf (condStr, MAX_NAME_LEN, "='%s'", myColl);
+        snprintf (condStr, sizeof (condStr), "='%s'", myColl);
         addInxVal (&genQueryInp->sqlCondInp, COL_COLL_NAME, condStr);
-        snprintf (condStr, MAX_NAME_LEN, "='%s'", myData);
+        snprintf (condStr, sizeof (condStr), "='%s'", myData);
         addInxVal (&genQueryInp->sqlCondInp, COL_DATA_NAME, condStr);
     } else {
-        snprintf (condStr, MAX_NAME_LEN, "='%s'", tmpStr);
+        snprintf (condStr, sizeof (condStr), "='%s'", tmpStr);
         addInxVal (&genQueryInp->sqlCondInp, COL_D_DATA_ID, condStr);
     }
 
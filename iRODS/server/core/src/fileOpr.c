@@ -9,6 +9,7 @@
 #include "rsGlobalExtern.h"
 #include "rcGlobalExtern.h"
 #include "collection.h"
+#include "rescLoad.h"
 
 int
 initFileDesc ()
@@ -68,6 +69,10 @@ freeFileDesc (int fileInx)
 	free (FileDesc[fileInx].fileName);
     }
 
+    if (FileDesc[fileInx].loadFlag) {
+	rescLoadXferEnd (FileDesc[fileInx].loadBytes);
+    }
+
     /* don't free driverDep (dirPtr is not malloced */
 
     memset (&FileDesc[fileInx], 0, sizeof (fileDesc_t));
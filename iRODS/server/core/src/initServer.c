@@ -1928,6 +1928,9 @@ initRsCommWithStartupPack (rsComm_t *rsComm, startupPack_t *startupPack)
 #endif
         
     }
+    /* strip the wire options requested by the client off the option */
+    rsComm->wireOpt = parseWireOpt (rsComm->option);
+
     if (rsComm->sock != 0) { /* added by RAJA Nov 16 2010 to remove error 
                               * messages from xmsLog */
         setLocalAddr (rsComm->sock, &rsComm->localAddr);
@@ -19,6 +19,8 @@
 #include "dataObjRead.h"
 #include "rcPortalOpr.h"
 #include "initServer.h"
+#include "fileOpr.h"
+#include "unixFileAio.h"
 #ifdef PARA_OPR
 #ifdef USE_BOOST
 #include <boost/thread/thread.hpp>
@@ -439,6 +441,17 @@ svrPortalPutGet (rsComm_t *rsComm)
 #ifdef PARA_OPR
 	rodsLong_t mySize = 0;
 	rodsLong_t myOffset = 0;
+	int sharedFd;
+
+	/* with positional I/O, all the threads use the fd of thread 0 */
+	if (oprType == PUT_OPR) {
+	    sharedFd = l3HasPio (dataOprInp->destRescTypeInx,
+	      dataOprInp->destL3descInx);
+	} else {
+	    sharedFd = l3HasPio (dataOprInp->srcRescTypeInx,
+	      dataOprInp->srcL3descInx);
+	}
+	myInput[0].sharedFd = sharedFd;
 
         for (i = 1; i < numThreads; i++) {
 	    int l3descInx;
@@ -463,11 +476,17 @@ svrPortalPutGet (rsComm_t *rsComm)
 
 	    if (oprType == PUT_OPR) {
 	        /* open the file */ 
-	        l3descInx = l3OpenByHost (rsComm, dataOprInp->destRescTypeInx, 
-	         dataOprInp->destL3descInx, O_WRONLY); 
+		if (sharedFd > 0) {
+		    l3descInx = dataOprInp->destL3descInx;
+		} else {
+	            l3descInx = l3OpenByHost (rsComm, 
+		     dataOprInp->destRescTypeInx, 
+	             dataOprInp->destL3descInx, O_WRONLY); 
+		}
     	        fillPortalTransferInp (&myInput[i], rsComm,
 		 portalFd, l3descInx, 0, dataOprInp->destRescTypeInx,
 	          i, mySize, myOffset, flags);
+		myInput[i].sharedFd = sharedFd;
 		#ifdef USE_BOOST
 		tid[i] = new boost::thread( partialDataPut, &myInput[i] );
 		#else
@@ -476,11 +495,17 @@ svrPortalPutGet (rsComm_t *rsComm)
     		#endif             
 
 	    } else {	/* a get */
-                l3descInx = l3OpenByHost (rsComm, dataOprInp->srcRescTypeInx,
-                 dataOprInp->srcL3descInx, O_RDONLY);
+		if (sharedFd > 0) {
+		    l3descInx = dataOprInp->srcL3descInx;
+		} else {
+                    l3descInx = l3OpenByHost (rsComm, 
+		     dataOprInp->srcRescTypeInx,
+                     dataOprInp->srcL3descInx, O_RDONLY);
+		}
                 fillPortalTransferInp (&myInput[i], rsComm,
 		 l3descInx, portalFd, dataOprInp->srcRescTypeInx, 0,
                   i, mySize, myOffset, flags);
+		myInput[i].sharedFd = sharedFd;
 		#ifdef USE_BOOST
 		tid[i] = new boost::thread( partialDataGet, &myInput[i] );
 		#else
@@ -553,14 +578,66 @@ int threadNum, rodsLong_t size, rodsLong_t offset, int flags)
 }
 
 
+/* getTransferAioFd - the unix fd of l3descInx if it is a local unix
+ * file, else SYS_NOT_SUPPORTED.
+ */
+static int
+getTransferAioFd (int rescTypeInx, int l3descInx)
+{
+    rodsServerHost_t *rodsServerHost;
+
+    if (rescTypeInx < 0 || RescTypeDef[rescTypeInx].rescCat != FILE_CAT)
+        return SYS_NOT_SUPPORTED;
+    if (getServerHostByFileInx (l3descInx, &rodsServerHost) != LOCAL_HOST)
+        return SYS_NOT_SUPPORTED;
+    if (FileDesc[l3descInx].fileType != UNIX_FILE_TYPE)
+        return SYS_NOT_SUPPORTED;
+    return FileDesc[l3descInx].fd;
+}
+
+/* initTransferAio - set up the asynchronous I/O of a transfer thread
+ * for l3descInx. Only local unix files bigger than one buffer qualify
+ * (size < 0 - unknown size). Returns the unix fd, or a negative value
+ * for the synchronous path.
+ */
+static int
+initTransferAio (unixAio_t *aio, int rescTypeInx, int l3descInx,
+rodsLong_t size)
+{
+    int status;
+
+    if ((size >= 0 && size <= TRANS_BUF_SZ) || getUnixAioDepth () <= 0)
+        return SYS_NOT_SUPPORTED;
+    if ((status = getTransferAioFd (rescTypeInx, l3descInx)) < 0)
+        return status;
+
+    if ((status = unixAioInit (aio)) < 0)
+        return status;
+    return FileDesc[l3descInx].fd;
+}
+
+static int
+endTransferAio (unixAio_t *aio, int directFd)
+{
+    int status;
+
+    status = unixAioEnd (aio);
+    if (directFd >= 0) close (directFd);
+    return status;
+}
+
 void
 partialDataPut (portalTransferInp_t *myInput)
 {
     int destL3descInx, srcFd, destRescTypeInx;
-    char *buf;
+    char *buf = NULL;
+    char *dataBuf;
     int bytesWritten;
     rodsLong_t bytesToGet;
     rodsLong_t myOffset = 0;
+    unixAio_t aio;
+    int aioFd, directFd = -1;
+    int chunkSize = TRANS_BUF_SZ;
 
 #ifdef PARA_TIMING
     time_t startTime, afterSeek, afterTransfer,
@@ -578,7 +655,10 @@ partialDataPut (portalTransferInp_t *myInput)
     srcFd = myInput->srcFd;
     destRescTypeInx = myInput->destRescTypeInx;
 
-    if (myInput->offset != 0) {
+    if (myInput->sharedFd > 0) {
+	/* positional writes. The file offset is not used */
+	myOffset = myInput->offset;
+    } else if (myInput->offset != 0) {
         myOffset = _l3Lseek (myInput->rsComm, destRescTypeInx, 
 	  destL3descInx, myInput->offset, SEEK_SET);
         if (myOffset < 0) {
@@ -586,13 +666,27 @@ partialDataPut (portalTransferInp_t *myInput)
             rodsLog (LOG_NOTICE,
 	      "_partialDataPut: _objSeek error, status = %d ",
               myInput->status);
-	    if (myInput->threadNum > 0)
+	    if (myInput->threadNum > 0 && myInput->sharedFd == 0)
                 _l3Close (myInput->rsComm, destRescTypeInx, destL3descInx);
             CLOSE_SOCK (srcFd);
             return;
         }
     }
-    buf = (char*)malloc (TRANS_BUF_SZ);
+
+    /* write behind. Receive the next buffers while the previous ones
+     * are written */
+    aioFd = initTransferAio (&aio, destRescTypeInx, destL3descInx,
+      myInput->size);
+    if (aioFd >= 0) {
+	chunkSize = aio.bufSize;
+	if (getUnixAioDirectSize () > 0 &&
+	  myInput->size >= getUnixAioDirectSize ()) {
+	    directFd = unixAioOpenDirect (FileDesc[destL3descInx].fileName,
+	      O_WRONLY);
+	}
+    } else {
+        buf = (char*)malloc (TRANS_BUF_SZ);
+    }
 
 #ifdef PARA_TIMING
     afterSeek=time(0);
@@ -623,7 +717,9 @@ partialDataPut (portalTransferInp_t *myInput)
 	    rodsLog (LOG_NOTICE, 
 	      "partialDataPut: sendTranHeader error. status = %d", 
 	      myInput->status);
-	    if (myInput->threadNum > 0)
+	    if (aioFd >= 0)
+		endTransferAio (&aio, directFd);
+	    if (myInput->threadNum > 0 && myInput->sharedFd == 0)
                 _l3Close (myInput->rsComm, destRescTypeInx, destL3descInx);
             CLOSE_SOCK (srcFd);
 	    free (buf);
@@ -633,19 +729,44 @@ partialDataPut (portalTransferInp_t *myInput)
 	while (toread0 > 0) {
 	    int toread1;
 
-	    if (toread0 > TRANS_BUF_SZ) {
-		toread1 = TRANS_BUF_SZ;
+	    if (toread0 > chunkSize) {
+		toread1 = chunkSize;
 	    } else {
 		toread1 = toread0;
 	    }
-            bytesRead = myRead (srcFd, buf, toread1, SOCK_TYPE, NULL, NULL);
+	    if (aioFd >= 0) {
+		/* an O_DIRECT stream writes up to the next aligned offset
+		 * first */
+		if (directFd >= 0 && myOffset % UNIX_AIO_ALIGN != 0 &&
+		  toread1 > UNIX_AIO_ALIGN - myOffset % UNIX_AIO_ALIGN) {
+		    toread1 = UNIX_AIO_ALIGN - myOffset % UNIX_AIO_ALIGN;
+		}
+		if ((dataBuf = unixAioNextBuf (&aio, &myInput->status)) ==
+		  NULL) {
+		    break;
+		}
+	    } else {
+		dataBuf = buf;
+	    }
+            bytesRead = myRead (srcFd, dataBuf, toread1, SOCK_TYPE, NULL, 
+	      NULL);
 
 #ifdef PARA_TIMING
             tafterRead=time(0);
 #endif
             if (bytesRead == toread1) {
-                if ((bytesWritten = _l3Write (myInput->rsComm, destRescTypeInx,
-		  destL3descInx, buf, bytesRead)) != bytesRead) {
+		if (aioFd >= 0) {
+		    bytesWritten = unixAioWriteNext (&aio, unixAioFd (aioFd,
+		      directFd, bytesRead, myOffset), bytesRead, myOffset);
+		    if (bytesWritten >= 0) bytesWritten = bytesRead;
+		} else if (myInput->sharedFd > 0) {
+		    bytesWritten = _l3Pwrite (myInput->rsComm,
+		      destRescTypeInx, destL3descInx, buf, bytesRead, myOffset);
+		} else {
+		    bytesWritten = _l3Write (myInput->rsComm, destRescTypeInx,
+		      destL3descInx, buf, bytesRead);
+		}
+                if (bytesWritten != bytesRead) {
 		    rodsLog (LOG_NOTICE,
                      "_partialDataPut:Bytes written %d don't match read %d",
                       bytesWritten, bytesRead);
@@ -681,13 +802,18 @@ partialDataPut (portalTransferInp_t *myInput)
 	if (myInput->status < 0)
             break;
     }           /* while loop bytesToGet */
+    if (aioFd >= 0) {
+	int status = endTransferAio (&aio, directFd);
+	if (status < 0 && myInput->status >= 0)
+	    myInput->status = status;
+    }
 #ifdef PARA_TIMING
     afterTransfer=time(0);
 #endif
     free (buf);
     applyRuleForSvrPortal(srcFd, PUT_OPR, 1, myOffset - myInput->offset, myInput->rsComm);
     sendTranHeader (srcFd, DONE_OPR, 0, 0, 0);
-    if (myInput->threadNum > 0)
+    if (myInput->threadNum > 0 && myInput->sharedFd == 0)
         _l3Close (myInput->rsComm, destRescTypeInx, destL3descInx);
 
     mySockClose (srcFd);
@@ -705,10 +831,14 @@ void
 partialDataGet (portalTransferInp_t *myInput)
 {
     int srcL3descInx, destFd, srcRescTypeInx;
-    char *buf;
+    char *buf = NULL;
+    char *dataBuf;
     int bytesWritten;
     rodsLong_t bytesToGet;
     rodsLong_t myOffset = 0;
+    unixAio_t aio;
+    int aioFd, aioSlot;
+    int chunkSize = TRANS_BUF_SZ;
 
 #ifdef PARA_TIMING
     time_t startTime, afterSeek, afterTransfer,
@@ -726,7 +856,10 @@ partialDataGet (portalTransferInp_t *myInput)
     destFd = myInput->destFd;
     srcRescTypeInx = myInput->srcRescTypeInx;
 
-    if (myInput->offset != 0) {
+    if (myInput->sharedFd > 0) {
+        /* positional reads. The file offset is not used */
+        myOffset = myInput->offset;
+    } else if (myInput->offset != 0) {
         myOffset = _l3Lseek (myInput->rsComm, srcRescTypeInx,
           srcL3descInx, myInput->offset, SEEK_SET);
         if (myOffset < 0) {
@@ -734,13 +867,29 @@ partialDataGet (portalTransferInp_t *myInput)
             rodsLog (LOG_NOTICE,
               "_partialDataGet: _objSeek error, status = %d ",
               myInput->status);
-            if (myInput->threadNum > 0)
+            if (myInput->threadNum > 0 && myInput->sharedFd == 0)
                 _l3Close (myInput->rsComm, srcRescTypeInx, srcL3descInx);
             CLOSE_SOCK (destFd);
             return;
         }
     }
-    buf = (char*)malloc (TRANS_BUF_SZ);
+
+    /* read ahead. Read the next buffers while the previous ones are
+     * sent */
+    aioFd = initTransferAio (&aio, srcRescTypeInx, srcL3descInx,
+      myInput->size);
+    if (aioFd >= 0) {
+        chunkSize = aio.bufSize;
+        if (unixAioReadAhead (&aio, aioFd, myInput->offset, myInput->size,
+          0) < 0) {
+            endTransferAio (&aio, -1);
+            aioFd = -1;
+            chunkSize = TRANS_BUF_SZ;
+        }
+    }
+    if (aioFd < 0) {
+        buf = (char*)malloc (TRANS_BUF_SZ);
+    }
 
 #ifdef PARA_TIMING
     afterSeek=time(0);
@@ -771,7 +920,9 @@ partialDataGet (portalTransferInp_t *myInput)
             rodsLog (LOG_NOTICE,
               "partialDataGet: sendTranHeader error. status = %d",
               myInput->status);
-            if (myInput->threadNum > 0)
+            if (aioFd >= 0)
+                endTransferAio (&aio, -1);
+            if (myInput->threadNum > 0 && myInput->sharedFd == 0)
                 _l3Close (myInput->rsComm, srcRescTypeInx, srcL3descInx);
             CLOSE_SOCK (destFd);
             free (buf);
@@ -781,19 +932,28 @@ partialDataGet (portalTransferInp_t *myInput)
         while (toread0 > 0) {
             int toread1;
 
-            if (toread0 > TRANS_BUF_SZ) {
-                toread1 = TRANS_BUF_SZ;
+            if (toread0 > chunkSize) {
+                toread1 = chunkSize;
             } else {
                 toread1 = toread0;
             }
-	    bytesRead = _l3Read (myInput->rsComm, srcRescTypeInx,
-             srcL3descInx, buf, toread1);
+            if (aioFd >= 0) {
+                dataBuf = unixAioReadNext (&aio, &aioSlot, &bytesRead);
+            } else if (myInput->sharedFd > 0) {
+                dataBuf = buf;
+                bytesRead = _l3Pread (myInput->rsComm, srcRescTypeInx,
+                 srcL3descInx, buf, toread1, myOffset);
+            } else {
+                dataBuf = buf;
+	        bytesRead = _l3Read (myInput->rsComm, srcRescTypeInx,
+                 srcL3descInx, buf, toread1);
+            }
 
 #ifdef PARA_TIMING
             tafterRead=time(0);
 #endif
             if (bytesRead == toread1) {
-                if ((bytesWritten = myWrite (destFd, buf, bytesRead,
+                if ((bytesWritten = myWrite (destFd, dataBuf, bytesRead,
 		  SOCK_TYPE, NULL))
                   != bytesRead) {
                     rodsLog (LOG_NOTICE,
@@ -810,6 +970,10 @@ partialDataGet (portalTransferInp_t *myInput)
                 bytesToGet -= bytesWritten;
                 toread0 -= bytesWritten;
                 myOffset += bytesWritten;
+                if (aioFd >= 0 &&
+                  (myInput->status = unixAioRefill (&aio, aioSlot)) < 0) {
+                    break;
+                }
             } else if (bytesRead < 0) {
                 myInput->status = bytesRead;
                 break;
@@ -831,13 +995,17 @@ partialDataGet (portalTransferInp_t *myInput)
         if (myInput->status < 0)
             break;
     }           /* while loop bytesToGet */
+    if (aioFd >= 0) {
+        /* reads ahead of an error are dropped */
+        endTransferAio (&aio, -1);
+    }
 #ifdef PARA_TIMING
     afterTransfer=time(0);
 #endif
     free (buf);
     applyRuleForSvrPortal(destFd, GET_OPR, 1, myOffset - myInput->offset, myInput->rsComm);
     sendTranHeader (destFd, DONE_OPR, 0, 0, 0);
-    if (myInput->threadNum > 0)
+    if (myInput->threadNum > 0 && myInput->sharedFd == 0)
         _l3Close (myInput->rsComm, srcRescTypeInx, srcL3descInx);
     CLOSE_SOCK (destFd);
 #ifdef PARA_TIMING
@@ -855,10 +1023,14 @@ remToLocPartialCopy (portalTransferInp_t *myInput)
 {
     transferHeader_t myHeader;
     int destL3descInx, srcFd, destRescTypeInx;
-    void *buf;
+    void *buf = NULL;
+    void *dataBuf;
     rodsLong_t curOffset = 0;
     rodsLong_t myOffset = 0;
     int toRead, bytesRead, bytesWritten;
+    unixAio_t aio;
+    int aioFd;
+    int chunkSize = TRANS_BUF_SZ;
 
 #ifdef PARA_DEBUG
     printf ("remToLocPartialCopy: thread %d at start\n", myInput->threadNum);
@@ -875,7 +1047,13 @@ remToLocPartialCopy (portalTransferInp_t *myInput)
     destRescTypeInx = myInput->destRescTypeInx;
     myInput->bytesWritten = 0;
 
-    buf = malloc (TRANS_BUF_SZ);
+    /* write behind */
+    aioFd = initTransferAio (&aio, destRescTypeInx, destL3descInx, -1);
+    if (aioFd >= 0) {
+        chunkSize = aio.bufSize;
+    } else {
+        buf = malloc (TRANS_BUF_SZ);
+    }
 
     while (myInput->status >= 0) {
         rodsLong_t toGet;
@@ -897,7 +1075,9 @@ remToLocPartialCopy (portalTransferInp_t *myInput)
         if (myHeader.oprType == DONE_OPR) {
             break;
         }
-        if (myHeader.offset != curOffset) {
+        if (myInput->sharedFd > 0) {
+            curOffset = myHeader.offset;
+        } else if (myHeader.offset != curOffset) {
             curOffset = myHeader.offset;
             myOffset = _l3Lseek (myInput->rsComm, destRescTypeInx,
               destL3descInx, myHeader.offset, SEEK_SET);
@@ -913,13 +1093,21 @@ remToLocPartialCopy (portalTransferInp_t *myInput)
         toGet = myHeader.length;
         while (toGet > 0) {
 
-            if (toGet > TRANS_BUF_SZ) {
-                toRead = TRANS_BUF_SZ;
+            if (toGet > chunkSize) {
+                toRead = chunkSize;
             } else {
                 toRead = toGet;
             }
 
-            bytesRead = myRead (srcFd, buf, toRead,
+            if (aioFd >= 0) {
+                if ((dataBuf = unixAioNextBuf (&aio, &myInput->status)) ==
+                  NULL) {
+                    break;
+                }
+            } else {
+                dataBuf = buf;
+            }
+            bytesRead = myRead (srcFd, dataBuf, toRead,
 		  SOCK_TYPE, NULL, NULL);
             if (bytesRead != toRead) {
 		if (bytesRead < 0) {
@@ -935,8 +1123,18 @@ remToLocPartialCopy (portalTransferInp_t *myInput)
                 break;
             }
 
-	    bytesWritten = _l3Write (myInput->rsComm, destRescTypeInx,
-              destL3descInx, buf, bytesRead);
+            if (aioFd >= 0) {
+                bytesWritten = unixAioWriteNext (&aio, aioFd, bytesRead,
+                  curOffset + myHeader.length - toGet);
+                if (bytesWritten >= 0) bytesWritten = bytesRead;
+            } else if (myInput->sharedFd > 0) {
+                bytesWritten = _l3Pwrite (myInput->rsComm, destRescTypeInx,
+                  destL3descInx, buf, bytesRead,
+                  curOffset + myHeader.length - toGet);
+            } else {
+	        bytesWritten = _l3Write (myInput->rsComm, destRescTypeInx,
+                  destL3descInx, buf, bytesRead);
+            }
 
             if (bytesWritten != bytesRead) {
                 rodsLog (LOG_NOTICE,
@@ -957,8 +1155,13 @@ remToLocPartialCopy (portalTransferInp_t *myInput)
         myInput->bytesWritten += myHeader.length;
     }
 
+    if (aioFd >= 0) {
+        int status = endTransferAio (&aio, -1);
+        if (status < 0 && myInput->status >= 0)
+            myInput->status = status;
+    }
     free (buf);
-    if (myInput->threadNum > 0)
+    if (myInput->threadNum > 0 && myInput->sharedFd == 0)
         _l3Close (myInput->rsComm, destRescTypeInx, destL3descInx);
     CLOSE_SOCK (srcFd);
 }
@@ -1130,6 +1333,16 @@ remLocCopy (rsComm_t *rsComm, dataCopyInp_t *dataCopyInp)
     } else {
 #ifdef PARA_OPR
         rodsLong_t totalWritten = 0;
+        int sharedFd;
+
+        if (oprType == COPY_TO_LOCAL_OPR) {
+            sharedFd = l3HasPio (dataOprInp->destRescTypeInx,
+              dataOprInp->destL3descInx);
+        } else {
+            sharedFd = l3HasPio (dataOprInp->srcRescTypeInx,
+              dataOprInp->srcL3descInx);
+        }
+        myInput[0].sharedFd = sharedFd;
 
         for (i = 1; i < numThreads; i++) {
             sock = connectToRhostPortal (myPortList->hostAddr,
@@ -1138,8 +1351,12 @@ remLocCopy (rsComm_t *rsComm, dataCopyInp_t *dataCopyInp)
                 return (sock);
             }
 	    if (oprType == COPY_TO_LOCAL_OPR) {
-                myFd = l3OpenByHost (rsComm, dataOprInp->destRescTypeInx,
-                 dataOprInp->destL3descInx, O_WRONLY);
+                if (sharedFd > 0) {
+                    myFd = dataOprInp->destL3descInx;
+                } else {
+                    myFd = l3OpenByHost (rsComm, dataOprInp->destRescTypeInx,
+                     dataOprInp->destL3descInx, O_WRONLY);
+                }
                 if (myFd < 0) {    /* error */
                     retVal = myFd;
                     rodsLog (LOG_NOTICE,
@@ -1152,6 +1369,7 @@ remLocCopy (rsComm_t *rsComm, dataCopyInp_t *dataCopyInp)
                 fillPortalTransferInp (&myInput[i], rsComm,
                  sock, myFd, 0, dataOprInp->destRescTypeInx,
                  i, 0, 0, 0);
+                myInput[i].sharedFd = sharedFd;
 
                 #ifdef USE_BOOST
                 tid[i] = new boost::thread( remToLocPartialCopy, &myInput[i] );
@@ -1160,8 +1378,12 @@ remLocCopy (rsComm_t *rsComm, dataCopyInp_t *dataCopyInp)
                  (void *(*)(void *)) remToLocPartialCopy, (void *) &myInput[i]);
                 #endif
 	    } else {
-                myFd = l3OpenByHost (rsComm, dataOprInp->srcRescTypeInx,
-                 dataOprInp->srcL3descInx, O_RDONLY);
+                if (sharedFd > 0) {
+                    myFd = dataOprInp->srcL3descInx;
+                } else {
+                    myFd = l3OpenByHost (rsComm, dataOprInp->srcRescTypeInx,
+                     dataOprInp->srcL3descInx, O_RDONLY);
+                }
                 if (myFd < 0) {    /* error */
                     retVal = myFd;
                     rodsLog (LOG_NOTICE,
@@ -1174,6 +1396,7 @@ remLocCopy (rsComm_t *rsComm, dataCopyInp_t *dataCopyInp)
                 fillPortalTransferInp (&myInput[i], rsComm,
                  myFd, sock, dataOprInp->destRescTypeInx, 0,
                  i, 0, 0, 0);
+                myInput[i].sharedFd = sharedFd;
 
                 #ifdef USE_BOOST
                 tid[i] = new boost::thread( locToRemPartialCopy, &myInput[i] );
@@ -1301,6 +1524,14 @@ sameHostCopy (rsComm_t *rsComm, dataCopyInp_t *dataCopyInp)
         rodsLong_t totalWritten = 0;
         rodsLong_t mySize = 0;
         rodsLong_t myOffset = 0;
+        int sharedFd;
+
+        /* share both fds only if both do positional I/O */
+        sharedFd = l3HasPio (dataOprInp->srcRescTypeInx,
+          dataOprInp->srcL3descInx) > 0 &&
+          l3HasPio (dataOprInp->destRescTypeInx,
+          dataOprInp->destL3descInx) > 0;
+        myInput[0].sharedFd = sharedFd;
 
         for (i = 1; i < numThreads; i++) {
             myOffset += size0;
@@ -1310,6 +1541,21 @@ sameHostCopy (rsComm_t *rsComm, dataCopyInp_t *dataCopyInp)
                 mySize = size1;
             }
 
+            if (sharedFd > 0) {
+                fillPortalTransferInp (&myInput[i], rsComm,
+                 dataOprInp->srcL3descInx, dataOprInp->destL3descInx,
+                 dataOprInp->srcRescTypeInx, dataOprInp->destRescTypeInx,
+                  i, mySize, myOffset, 0);
+                myInput[i].sharedFd = sharedFd;
+                #ifdef USE_BOOST
+                tid[i] = new boost::thread( sameHostPartialCopy, &myInput[i] );
+                #else
+                pthread_create (&tid[i], pthread_attr_default,
+                 (void *(*)(void *)) sameHostPartialCopy, (void *) &myInput[i]);
+                #endif
+                continue;
+            }
+
             out_fd = l3OpenByHost (rsComm, dataOprInp->destRescTypeInx,
              dataOprInp->destL3descInx, O_WRONLY);
             if (out_fd < 0) {    /* error */
@@ -1383,14 +1629,81 @@ sameHostCopy (rsComm_t *rsComm, dataCopyInp_t *dataCopyInp)
     }
 }
 
+/* aioSameHostPartialCopy - the sameHostPartialCopy loop with read ahead
+ * of srcFd and write behind to destFd. Each buffer is written as soon
+ * as its read is done, and read again once its write is done.
+ */
+static void
+aioSameHostPartialCopy (portalTransferInp_t *myInput, unixAio_t *aio,
+int srcFd, int destFd, int directFd)
+{
+    rodsLong_t myOffset = myInput->offset;
+    rodsLong_t toCopy = myInput->size;
+    int slot, prevSlot = -1;
+    int toRead, bytesRead, status;
+
+    status = unixAioReadAhead (aio, srcFd, myOffset, toCopy,
+      directFd >= 0 ? 1 : 0);
+    if (status < 0) {
+        myInput->status = status;
+        return;
+    }
+
+    while (toCopy > 0) {
+        unixAioReadNext (aio, &slot, &bytesRead);
+        toRead = aio->len[slot];
+        if (bytesRead <= 0) {
+            if (bytesRead < 0) {
+                myInput->status = bytesRead;
+                rodsLogError (LOG_ERROR, bytesRead,
+              "aioSameHostPartialCopy: copy error for %d", bytesRead);
+            } else if ((myInput->flags & NO_CHK_COPY_LEN_FLAG) == 0) {
+                myInput->status = SYS_COPY_LEN_ERR;
+                rodsLog (LOG_ERROR,
+                  "aioSameHostPartialCopy: toCopy %lld, bytesRead %d",
+                  toCopy, bytesRead);
+            }
+            break;
+        }
+
+        status = unixAioWrite (aio, slot, unixAioFd (destFd, directFd,
+          bytesRead, myOffset), bytesRead, myOffset);
+        if (status >= 0 && prevSlot >= 0) {
+            status = unixAioRefill (aio, prevSlot);
+        }
+        if (status < 0) {
+            myInput->status = status;
+            break;
+        }
+        prevSlot = slot;
+
+        toCopy -= bytesRead;
+        myOffset += bytesRead;
+        myInput->bytesWritten += bytesRead;
+
+        if (bytesRead < toRead) {
+            /* the source is shorter. The reads ahead are past its end */
+            if ((myInput->flags & NO_CHK_COPY_LEN_FLAG) == 0) {
+                myInput->status = SYS_COPY_LEN_ERR;
+                rodsLog (LOG_ERROR,
+                  "aioSameHostPartialCopy: toCopy %lld, bytesRead %d",
+                  toCopy, bytesRead);
+            }
+            break;
+        }
+    }
+}
+
 void
 sameHostPartialCopy (portalTransferInp_t *myInput)
 {
     int destL3descInx, srcL3descInx, destRescTypeInx, srcRescTypeInx;
-    void *buf;
+    void *buf = NULL;
     rodsLong_t myOffset = 0;
     rodsLong_t toCopy;
     int bytesRead, bytesWritten;
+    unixAio_t aio;
+    int srcAioFd = -1, destAioFd, directFd = -1;
 
 #ifdef PARA_DEBUG
     printf ("onsameHostPartialCopy: thread %d at start\n", 
@@ -1409,7 +1722,10 @@ sameHostPartialCopy (portalTransferInp_t *myInput)
     srcRescTypeInx = myInput->srcRescTypeInx;
     myInput->bytesWritten = 0;
 
-    if (myInput->offset != 0) {
+    if (myInput->sharedFd > 0) {
+        /* positional reads and writes. The file offsets are not used */
+        myOffset = myInput->offset;
+    } else if (myInput->offset != 0) {
         myOffset = _l3Lseek (myInput->rsComm, destRescTypeInx,
           destL3descInx, myInput->offset, SEEK_SET);
         if (myOffset < 0) {
@@ -1417,7 +1733,7 @@ sameHostPartialCopy (portalTransferInp_t *myInput)
             rodsLog (LOG_NOTICE,
               "sameHostPartialCopy: _objSeek error, status = %d ",
               myInput->status);
-            if (myInput->threadNum > 0) {
+            if (myInput->threadNum > 0 && myInput->sharedFd == 0) {
                 _l3Close (myInput->rsComm, destRescTypeInx, destL3descInx);
                 _l3Close (myInput->rsComm, srcRescTypeInx, srcL3descInx);
             }
@@ -1430,7 +1746,7 @@ sameHostPartialCopy (portalTransferInp_t *myInput)
             rodsLog (LOG_NOTICE,
               "sameHostPartialCopy: _objSeek error, status = %d ",
               myInput->status);
-            if (myInput->threadNum > 0) {
+            if (myInput->threadNum > 0 && myInput->sharedFd == 0) {
                 _l3Close (myInput->rsComm, destRescTypeInx, destL3descInx);
                 _l3Close (myInput->rsComm, srcRescTypeInx, srcL3descInx);
 	    }
@@ -1438,10 +1754,30 @@ sameHostPartialCopy (portalTransferInp_t *myInput)
         }
     }
 
-    buf = malloc (TRANS_BUF_SZ);
-
     toCopy = myInput->size;
 
+    if ((destAioFd = getTransferAioFd (destRescTypeInx, destL3descInx)) >= 0) {
+        srcAioFd = initTransferAio (&aio, srcRescTypeInx, srcL3descInx,
+          myInput->size);
+    }
+    if (srcAioFd >= 0) {
+        int status;
+
+        if (getUnixAioDirectSize () > 0 &&
+          myInput->size >= getUnixAioDirectSize ()) {
+            directFd = unixAioOpenDirect (FileDesc[destL3descInx].fileName,
+              O_WRONLY);
+        }
+        aioSameHostPartialCopy (myInput, &aio, srcAioFd, destAioFd,
+          directFd);
+        status = endTransferAio (&aio, directFd);
+        if (status < 0 && myInput->status >= 0)
+            myInput->status = status;
+        toCopy = 0;
+    } else {
+        buf = malloc (TRANS_BUF_SZ);
+    }
+
     while (toCopy > 0) {
         int toRead;
 
@@ -1451,8 +1787,13 @@ sameHostPartialCopy (portalTransferInp_t *myInput)
 	    toRead = toCopy;
 	}
 
-        bytesRead = _l3Read (myInput->rsComm, srcRescTypeInx,
-         srcL3descInx, buf, toRead);
+        if (myInput->sharedFd > 0) {
+            bytesRead = _l3Pread (myInput->rsComm, srcRescTypeInx,
+             srcL3descInx, buf, toRead, myOffset);
+        } else {
+            bytesRead = _l3Read (myInput->rsComm, srcRescTypeInx,
+             srcL3descInx, buf, toRead);
+        }
 
         if (bytesRead <= 0) {
             if (bytesRead < 0) {
@@ -1468,8 +1809,13 @@ sameHostPartialCopy (portalTransferInp_t *myInput)
             break;
         }
 
-	bytesWritten = _l3Write (myInput->rsComm, destRescTypeInx,
-          destL3descInx, buf, bytesRead);
+        if (myInput->sharedFd > 0) {
+            bytesWritten = _l3Pwrite (myInput->rsComm, destRescTypeInx,
+              destL3descInx, buf, bytesRead, myOffset);
+        } else {
+	    bytesWritten = _l3Write (myInput->rsComm, destRescTypeInx,
+              destL3descInx, buf, bytesRead);
+        }
 
         if (bytesWritten != bytesRead) {
             rodsLog (LOG_NOTICE,
@@ -1485,11 +1831,12 @@ sameHostPartialCopy (portalTransferInp_t *myInput)
         }
 
         toCopy -= bytesWritten;
+        myOffset += bytesWritten;
         myInput->bytesWritten += bytesWritten;
     }
 
     free (buf);
-    if (myInput->threadNum > 0) {
+    if (myInput->threadNum > 0 && myInput->sharedFd == 0) {
         _l3Close (myInput->rsComm, destRescTypeInx, destL3descInx);
         _l3Close (myInput->rsComm, srcRescTypeInx, srcL3descInx);
     }
@@ -1544,7 +1891,9 @@ locToRemPartialCopy (portalTransferInp_t *myInput)
 	  myHeader.offset, myHeader.length);
 #endif
 
-        if (myHeader.offset != curOffset) {
+        if (myInput->sharedFd > 0) {
+            curOffset = myHeader.offset;
+        } else if (myHeader.offset != curOffset) {
             curOffset = myHeader.offset;
             myOffset = _l3Lseek (myInput->rsComm, srcRescTypeInx,
               srcL3descInx, myHeader.offset, SEEK_SET);
@@ -1566,8 +1915,14 @@ locToRemPartialCopy (portalTransferInp_t *myInput)
                 toRead = toGet;
             }
 
-	    bytesRead = _l3Read (myInput->rsComm, srcRescTypeInx,
-              srcL3descInx, buf, toRead);
+            if (myInput->sharedFd > 0) {
+                bytesRead = _l3Pread (myInput->rsComm, srcRescTypeInx,
+                  srcL3descInx, buf, toRead,
+                  curOffset + myHeader.length - toGet);
+            } else {
+	        bytesRead = _l3Read (myInput->rsComm, srcRescTypeInx,
+                  srcL3descInx, buf, toRead);
+            }
 
             if (bytesRead != toRead) {
                 if (bytesRead < 0) {
@@ -1607,7 +1962,7 @@ locToRemPartialCopy (portalTransferInp_t *myInput)
     }
 
     free (buf);
-    if (myInput->threadNum > 0)
+    if (myInput->threadNum > 0 && myInput->sharedFd == 0)
         _l3Close (myInput->rsComm, srcRescTypeInx, srcL3descInx);
     CLOSE_SOCK (destFd);
 }
@@ -23,6 +23,7 @@
 #include "reSysDataObjOpr.h"
 #include "genQuery.h"
 #include "rodsClient.h"
+#include "reFuncDefs.h"
 
 int
 getFileMode (dataObjInp_t *dataObjInp)
@@ -907,12 +908,29 @@ dataObjInfo_t *dataObjInfo, char *acLCollection)
 
 int
 syncCollPhyPath (rsComm_t *rsComm, char *collection)
+{
+    return _syncCollPhyPath (rsComm, collection, 0, 0, NULL);
+}
+
+/* _syncCollPhyPath - syncCollPhyPath done in batches of batchSize
+ * replicas with a pause of sleepSec seconds between the batches so that
+ * the relocation of a large collection does not hog the vault and the
+ * catalog. batchSize <= 0 means no pause. The number of replicas checked
+ * is returned in outCnt.
+ */
+
+int
+_syncCollPhyPath (rsComm_t *rsComm, char *collection, int batchSize,
+int sleepSec, int *outCnt)
 {
     int status, i;
     int savedStatus = 0;
     genQueryOut_t *genQueryOut = NULL;
     genQueryInp_t genQueryInp;
     int continueInx;
+    int cnt = 0;
+
+    if (outCnt != NULL) *outCnt = 0;
 
     status = rsQueryDataObjInCollReCur (rsComm, collection, 
       &genQueryInp, &genQueryOut, NULL, 0);
@@ -996,7 +1014,13 @@ syncCollPhyPath (rsComm_t *rsComm, char *collection)
                   dataObjInfo.filePath, status);
 		savedStatus = status;
             }
-
+	    cnt++;
+	    if (batchSize > 0 && sleepSec > 0 && cnt % batchSize == 0) {
+		rodsLog (LOG_DEBUG,
+		  "_syncCollPhyPath: %d replicas of %s synced, pausing",
+		  cnt, collection);
+		rodsSleep (sleepSec, 0);
+	    }
 	}
 
         continueInx = genQueryOut->continueInx;
@@ -1013,9 +1037,93 @@ syncCollPhyPath (rsComm_t *rsComm, char *collection)
     }
     clearGenQueryInp (&genQueryInp);
 
+    if (outCnt != NULL) *outCnt = cnt;
+
     return (savedStatus);
 }
 
+/* isLazyCollPhyPath - return 1 if the LAZY_COLL_PHY_PATH_ENV env is set,
+ * i.e., a collection rename only updates the catalog and the vault
+ * files are relocated later by queSyncCollPhyPath.
+ */
+
+int
+isLazyCollPhyPath ()
+{
+    char *tmpStr;
+
+    if ((tmpStr = getenv (LAZY_COLL_PHY_PATH_ENV)) != NULL &&
+      atoi (tmpStr) > 0) {
+	return 1;
+    } else {
+	return 0;
+    }
+}
+
+/* escapeRuleStr - escape inStr for a quoted string in the rule text so
+ * that quotes, backslashes and '*' or '$' variable names in a path are
+ * taken literally */
+
+static int
+escapeRuleStr (char *inStr, char *outStr, int outLen)
+{
+    int len = 0;
+
+    while (*inStr != '\0') {
+	if (strchr ("\"\\*$", *inStr) != NULL) {
+	    if (len >= outLen - 1) return USER_STRLEN_TOOLONG;
+	    outStr[len++] = '\\';
+	}
+	if (len >= outLen - 1) return USER_STRLEN_TOOLONG;
+	outStr[len++] = *inStr++;
+    }
+    outStr[len] = '\0';
+    return 0;
+}
+
+/* queSyncCollPhyPath - queue a delayed msiSyncCollPhyPath rule to the
+ * irodsReServer to relocate the vault files of the renamed collection.
+ * The batch size and the pause between the batches are taken from the
+ * COLL_PHY_PATH_BATCH_ENV and COLL_PHY_PATH_SLEEP_ENV env.
+ */
+
+int
+queSyncCollPhyPath (rsComm_t *rsComm, char *collection)
+{
+    int status;
+    int batchSize = DEF_COLL_PHY_PATH_BATCH;
+    int sleepSec = DEF_COLL_PHY_PATH_SLEEP;
+    char *tmpStr;
+    ruleExecInfo_t rei;
+    char collStr[2 * MAX_NAME_LEN];
+    char actionCall[MAX_ACTION_SIZE];
+
+    if ((tmpStr = getenv (COLL_PHY_PATH_BATCH_ENV)) != NULL)
+	batchSize = atoi (tmpStr);
+    if ((tmpStr = getenv (COLL_PHY_PATH_SLEEP_ENV)) != NULL)
+	sleepSec = atoi (tmpStr);
+
+    status = escapeRuleStr (collection, collStr, sizeof (collStr));
+    if (status >= 0 && snprintf (actionCall, MAX_ACTION_SIZE,
+      "msiSyncCollPhyPath(\"%s\",\"%d\",\"%d\",*Status);",
+      collStr, batchSize, sleepSec) >= MAX_ACTION_SIZE) {
+	status = USER_STRLEN_TOOLONG;
+    }
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "queSyncCollPhyPath: rule for %s too long", collection);
+	return status;
+    }
+
+    initReiWithDataObjInp (&rei, rsComm, NULL);
+    status = _delayExec (actionCall, "", COLL_PHY_PATH_DELAY, &rei);
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "queSyncCollPhyPath: _delayExec of %s failed", actionCall);
+    }
+    return status;
+}
+
 int
 isInVault (dataObjInfo_t *dataObjInfo)
 {
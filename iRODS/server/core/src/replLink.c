@@ -0,0 +1,276 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* replLink.c - the no. of parallel streams of a replication between
+ * resource servers.
+ *
+ * A stream of a parallel transfer cannot move more than window/RTT
+ * Bytes/s, so a link of bandwidth B needs B*RTT/window streams to be
+ * filled. The RTT to the other server is measured with a few
+ * rcGetMiscSvrInfo round trips. The bandwidth is either given with
+ * replLinkBandwidth or estimated from the replications already done:
+ * a transfer whose streams each ran at the window/RTT limit was limited
+ * by the no. of streams and the estimate is doubled, otherwise it is the
+ * measured rate. The link stats are kept in stateDir/replLinkDir/hostName
+ * so that the next agent starts from them.
+ */
+
+#include "replLink.h"
+#include "getMiscSvrInfo.h"
+#include "miscServerFunct.h"
+#include "rsGlobalExtern.h"
+#include "sockComm.h"
+
+static replLink_t *ReplLinkHead = NULL;
+
+int
+isReplAutoThreads ()
+{
+    char *tmpStr;
+
+    if ((tmpStr = getenv (REPL_AUTO_THREADS_ENV)) != NULL &&
+      atoi (tmpStr) > 0) {
+        return 1;
+    } else {
+        return 0;
+    }
+}
+
+/* getReplLinkBandwidth - the configured link capacity in Bytes/s. 0 if
+ * not set */
+
+rodsLong_t
+getReplLinkBandwidth ()
+{
+    char *tmpStr;
+    rodsLong_t bandwidth;
+
+    if ((tmpStr = getenv (REPL_LINK_BW_ENV)) == NULL) return 0;
+    bandwidth = strtoll (tmpStr, 0, 0);
+    if (bandwidth <= 0) return 0;
+    return bandwidth * 1000 * 1000 / 8;
+}
+
+/* getReplLinkHost - the server on the other end of the replication link.
+ * This is the src or dest server which is not the local host. For a
+ * copy between two remote servers, the link to the dest server is used.
+ * Returns NULL if both are on the same host */
+
+static rodsServerHost_t *
+getReplLinkHost (rescInfo_t *srcRescInfo, rescInfo_t *destRescInfo)
+{
+    rodsServerHost_t *srcHost = NULL, *destHost = NULL;
+
+    if (srcRescInfo == NULL || destRescInfo == NULL) return NULL;
+    if (resolveHostByRescInfo (srcRescInfo, &srcHost) < 0 ||
+      resolveHostByRescInfo (destRescInfo, &destHost) < 0) return NULL;
+    if (srcHost == destHost) return NULL;
+    if (destHost->localFlag == LOCAL_HOST) {
+        return srcHost;
+    } else {
+        return destHost;
+    }
+}
+
+static void
+getReplLinkPath (char *hostName, char *outPath)
+{
+    snprintf (outPath, MAX_NAME_LEN, "%-s/%-s/%-s", getStateDir(),
+      REPL_LINK_DIR, hostName);
+}
+
+static int
+saveReplLink (replLink_t *replLink)
+{
+    char linkPath[MAX_NAME_LEN], tmpPath[MAX_NAME_LEN + 16];
+    FILE *fp;
+    int status;
+
+    snprintf (tmpPath, MAX_NAME_LEN, "%-s/%-s", getStateDir(),
+      REPL_LINK_DIR);
+    if (mkdir (tmpPath, 0700) < 0 && errno != EEXIST) {
+        status = UNIX_FILE_MKDIR_ERR - errno;
+        rodsLogError (LOG_NOTICE, status,
+          "saveReplLink: mkdir %s failed", tmpPath);
+        return status;
+    }
+    getReplLinkPath (replLink->hostName, linkPath);
+    snprintf (tmpPath, sizeof (tmpPath), "%-s.%d", linkPath, getpid ());
+    if ((fp = fopen (tmpPath, "w")) == NULL) {
+        status = FILE_OPEN_ERR - errno;
+        rodsLogError (LOG_NOTICE, status,
+          "saveReplLink: fopen %s failed", tmpPath);
+        return status;
+    }
+    fprintf (fp, "%d %u %lld\n", replLink->rttUsec,
+      (uint) replLink->rttTime, replLink->bandwidth);
+    fclose (fp);
+    if (rename (tmpPath, linkPath) < 0) {
+        status = UNIX_FILE_RENAME_ERR - errno;
+        unlink (tmpPath);
+        return status;
+    }
+    return 0;
+}
+
+static int
+measureReplLinkRtt (rsComm_t *rsComm, rodsServerHost_t *rodsServerHost,
+replLink_t *replLink)
+{
+    struct timeval startTime, endTime;
+    miscSvrInfo_t *outSvrInfo;
+    int i, status, rttUsec;
+    int minRttUsec = -1;
+
+    if ((status = svrToSvrConnect (rsComm, rodsServerHost)) < 0)
+        return status;
+    for (i = 0; i < REPL_LINK_RTT_PROBES; i++) {
+        outSvrInfo = NULL;
+        (void) gettimeofday (&startTime, (struct timezone *) 0);
+        status = rcGetMiscSvrInfo (rodsServerHost->conn, &outSvrInfo);
+        (void) gettimeofday (&endTime, (struct timezone *) 0);
+        if (outSvrInfo != NULL) free (outSvrInfo);
+        if (status < 0) return status;
+        rttUsec = (endTime.tv_sec - startTime.tv_sec) * 1000000 +
+          (endTime.tv_usec - startTime.tv_usec);
+        if (minRttUsec < 0 || rttUsec < minRttUsec) minRttUsec = rttUsec;
+    }
+    replLink->rttUsec = minRttUsec > 0 ? minRttUsec : 1;
+    replLink->rttTime = time (0);
+    return 0;
+}
+
+/* getReplLink - the link stats of rodsServerHost. Read from the state dir
+ * on first use. The RTT is measured if unknown or too old */
+
+static replLink_t *
+getReplLink (rsComm_t *rsComm, rodsServerHost_t *rodsServerHost)
+{
+    replLink_t *replLink;
+    char linkPath[MAX_NAME_LEN];
+    char *hostName;
+    FILE *fp;
+    uint rttTime;
+
+    hostName = rodsServerHost->hostName->name;
+    for (replLink = ReplLinkHead; replLink != NULL;
+      replLink = replLink->next) {
+        if (strcmp (replLink->hostName, hostName) == 0) break;
+    }
+    if (replLink == NULL) {
+        replLink = (replLink_t *) calloc (1, sizeof (replLink_t));
+        rstrcpy (replLink->hostName, hostName, NAME_LEN);
+        getReplLinkPath (hostName, linkPath);
+        if ((fp = fopen (linkPath, "r")) != NULL) {
+            if (fscanf (fp, "%d %u %lld", &replLink->rttUsec, &rttTime,
+              &replLink->bandwidth) == 3) {
+                replLink->rttTime = rttTime;
+            } else {
+                replLink->rttUsec = 0;
+                replLink->bandwidth = 0;
+            }
+            fclose (fp);
+        }
+        replLink->next = ReplLinkHead;
+        ReplLinkHead = replLink;
+    }
+    if (replLink->rttUsec <= 0 ||
+      time (0) - replLink->rttTime > REPL_LINK_RTT_AGE) {
+        if (measureReplLinkRtt (rsComm, rodsServerHost, replLink) >= 0) {
+            saveReplLink (replLink);
+        } else {
+            return NULL;
+        }
+    }
+    return replLink;
+}
+
+/* getReplNumThreads - the no. of streams to replicate dataSize Bytes
+ * between the servers of srcRescInfo and destRescInfo. numThreads, as
+ * given by getNumThreads, is returned if the link is not known yet */
+
+int
+getReplNumThreads (rsComm_t *rsComm, rescInfo_t *srcRescInfo,
+rescInfo_t *destRescInfo, rodsLong_t dataSize, int numThreads)
+{
+    rodsServerHost_t *rodsServerHost;
+    replLink_t *replLink;
+    rodsLong_t bandwidth, windowSize, myNumThreads, maxNumThreads;
+
+    if (numThreads <= 0 || dataSize <= MIN_SZ_FOR_PARA_TRAN)
+        return numThreads;
+    if ((rodsServerHost = getReplLinkHost (srcRescInfo, destRescInfo)) ==
+      NULL) return numThreads;
+    if ((replLink = getReplLink (rsComm, rodsServerHost)) == NULL)
+        return numThreads;
+
+    if ((bandwidth = getReplLinkBandwidth ()) <= 0)
+        bandwidth = replLink->bandwidth;
+    if (bandwidth <= 0) return numThreads;
+
+    if (rsComm->windowSize > 0) {
+        windowSize = rsComm->windowSize;
+    } else {
+        windowSize = SOCK_WINDOW_SIZE;
+    }
+    /* the Bytes in flight needed to fill the link */
+    myNumThreads = (bandwidth * replLink->rttUsec / 1000000 +
+      windowSize - 1) / windowSize;
+    /* at least MIN_SZ_FOR_PARA_TRAN per stream */
+    maxNumThreads = dataSize / MIN_SZ_FOR_PARA_TRAN;
+    if (maxNumThreads > MAX_NUM_CONFIG_TRAN_THR)
+        maxNumThreads = MAX_NUM_CONFIG_TRAN_THR;
+    if (myNumThreads > maxNumThreads) myNumThreads = maxNumThreads;
+    if (myNumThreads < 1) myNumThreads = 1;
+
+    rodsLog (LOG_DEBUG,
+      "getReplNumThreads: %s rtt %d usec bandwidth %lld B/s, %d -> %d",
+      replLink->hostName, replLink->rttUsec, bandwidth, numThreads,
+      (int) myNumThreads);
+    return (int) myNumThreads;
+}
+
+/* recordReplXfer - update the bandwidth estimate of the link with a
+ * replication of dataSize Bytes using numThreads streams which started
+ * at startTime */
+
+int
+recordReplXfer (rsComm_t *rsComm, rescInfo_t *srcRescInfo,
+rescInfo_t *destRescInfo, rodsLong_t dataSize, int numThreads,
+struct timeval *startTime)
+{
+    rodsServerHost_t *rodsServerHost;
+    replLink_t *replLink;
+    struct timeval endTime;
+    rodsLong_t elapsedUsec, rate, estimate, windowSize;
+
+    if (dataSize < REPL_LINK_MIN_SAMPLE_SZ) return 0;
+    if (numThreads < 1) numThreads = 1;
+    (void) gettimeofday (&endTime, (struct timezone *) 0);
+    elapsedUsec = (rodsLong_t) (endTime.tv_sec - startTime->tv_sec) *
+      1000000 + (endTime.tv_usec - startTime->tv_usec);
+    if (elapsedUsec <= 0) return 0;
+    if ((rodsServerHost = getReplLinkHost (srcRescInfo, destRescInfo)) ==
+      NULL) return 0;
+    if ((replLink = getReplLink (rsComm, rodsServerHost)) == NULL) return 0;
+
+    rate = dataSize * 1000000 / elapsedUsec;
+    if (rsComm->windowSize > 0) {
+        windowSize = rsComm->windowSize;
+    } else {
+        windowSize = SOCK_WINDOW_SIZE;
+    }
+    /* each stream at window/RTT. More streams would have gone faster */
+    if (rate / numThreads * 100 >=
+      windowSize * 1000000 / replLink->rttUsec * REPL_LINK_WINDOW_BOUND) {
+        estimate = rate * 2;
+    } else {
+        estimate = rate;
+    }
+    if (replLink->bandwidth > 0) {
+        replLink->bandwidth = (replLink->bandwidth + estimate) / 2;
+    } else {
+        replLink->bandwidth = estimate;
+    }
+    return saveReplLink (replLink);
+}
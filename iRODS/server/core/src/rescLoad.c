@@ -0,0 +1,360 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* rescLoad.c - the live load of a resource server.
+ *
+ * The agents of a server map stateDir/rescLoadFile and each one counts
+ * the files it has open in the vaults and their size in its own slot of
+ * the file. A slot is claimed by writing the pid of the agent into it and
+ * the slot of an agent which is gone is taken over by the next one. The
+ * load of a resource is the sum over the live agents plus the in flight
+ * I/Os and the busy time of the vault's disk from /proc/diskstats and the
+ * free space of the vault. It is read through rsFileGetLoad, so no
+ * catalog access is involved and the numbers are current, unlike the
+ * load digest of irodsServerMonPerf.
+ */
+
+#ifndef windows_platform
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <signal.h>
+#endif
+#if defined(linux_platform)
+#include <sys/sysmacros.h>
+#endif
+#include "rescLoad.h"
+#include "fileOpr.h"
+#include "rsGlobalExtern.h"
+#include "rcGlobalExtern.h"
+
+static rescLoadSeg_t *RescLoadSeg = NULL;
+static int RescLoadSegStatus = 0;	/* < 0 - can't be mapped */
+static rescLoadSlot_t *MyRescLoadSlot = NULL;
+static int MyRescLoadSlotPid = 0;	/* -pid - no free slot */
+static rescLoad_t *RescLoadHead = NULL;
+
+static rescLoadSeg_t *
+getRescLoadSeg ()
+{
+#ifndef windows_platform
+    char loadPath[MAX_NAME_LEN];
+    struct stat statbuf;
+    void *segPtr;
+    int fd;
+
+    if (RescLoadSeg != NULL || RescLoadSegStatus < 0) return RescLoadSeg;
+
+    snprintf (loadPath, MAX_NAME_LEN, "%-s/%-s", getStateDir(),
+      RESC_LOAD_FILE);
+    if ((fd = open (loadPath, O_RDWR | O_CREAT, 0600)) < 0) {
+        RescLoadSegStatus = FILE_OPEN_ERR - errno;
+        rodsLogError (LOG_NOTICE, RescLoadSegStatus,
+          "getRescLoadSeg: open %s failed", loadPath);
+        return NULL;
+    }
+    /* extended with zeros. All the agents agree on the size */
+    if (fstat (fd, &statbuf) < 0 ||
+      (statbuf.st_size < (off_t) sizeof (rescLoadSeg_t) &&
+      ftruncate (fd, sizeof (rescLoadSeg_t)) < 0)) {
+        RescLoadSegStatus = UNIX_FILE_TRUNCATE_ERR - errno;
+        rodsLogError (LOG_NOTICE, RescLoadSegStatus,
+          "getRescLoadSeg: sizing %s failed", loadPath);
+        close (fd);
+        return NULL;
+    }
+    segPtr = mmap (NULL, sizeof (rescLoadSeg_t), PROT_READ | PROT_WRITE,
+      MAP_SHARED, fd, 0);
+    close (fd);
+    if (segPtr == MAP_FAILED) {
+        RescLoadSegStatus = SYS_MALLOC_ERR - errno;
+        rodsLogError (LOG_NOTICE, RescLoadSegStatus,
+          "getRescLoadSeg: mmap %s failed", loadPath);
+        return NULL;
+    }
+    RescLoadSeg = (rescLoadSeg_t *) segPtr;
+    if (__sync_bool_compare_and_swap (&RescLoadSeg->magic, 0,
+      RESC_LOAD_MAGIC)) {
+        RescLoadSeg->numSlots = RESC_LOAD_NUM_SLOTS;
+        RescLoadSeg->numDisks = RESC_LOAD_NUM_DISKS;
+    } else if (RescLoadSeg->magic != RESC_LOAD_MAGIC ||
+      (RescLoadSeg->numSlots != 0 &&
+      RescLoadSeg->numSlots != RESC_LOAD_NUM_SLOTS)) {
+        /* left by a server of another layout. Remove it to reset */
+        rodsLog (LOG_NOTICE,
+          "getRescLoadSeg: %s has an unknown layout", loadPath);
+        munmap (segPtr, sizeof (rescLoadSeg_t));
+        RescLoadSeg = NULL;
+        RescLoadSegStatus = SYS_CONFIG_FILE_ERR;
+        return NULL;
+    }
+    RescLoadSegStatus = 1;
+    return RescLoadSeg;
+#else
+    return NULL;
+#endif
+}
+
+static int
+isLiveAgent (int pid)
+{
+#ifndef windows_platform
+    if (pid <= 0) return 0;
+    if (kill (pid, 0) == 0 || errno != ESRCH) return 1;
+#endif
+    return 0;
+}
+
+/* getMyRescLoadSlot - the slot of this agent. A free slot or the slot of
+ * an agent which has exited is claimed on first use */
+
+static rescLoadSlot_t *
+getMyRescLoadSlot ()
+{
+    rescLoadSeg_t *seg;
+    rescLoadSlot_t *slot;
+    int i, pid, slotPid;
+
+    pid = getpid ();
+    if (MyRescLoadSlotPid == pid) return MyRescLoadSlot;
+    if (MyRescLoadSlotPid == -pid) return NULL;
+    if ((seg = getRescLoadSeg ()) == NULL) return NULL;
+
+    for (i = 0; i < RESC_LOAD_NUM_SLOTS; i++) {
+        slot = &seg->slot[i];
+        slotPid = slot->pid;
+        if (slotPid == pid ||
+          (slotPid == 0 && __sync_bool_compare_and_swap (&slot->pid, 0, pid)) ||
+          (slotPid != 0 && !isLiveAgent (slotPid) &&
+          __sync_bool_compare_and_swap (&slot->pid, slotPid, pid))) {
+            slot->activeXfers = 0;
+            slot->outstandingBytes = 0;
+            MyRescLoadSlot = slot;
+            MyRescLoadSlotPid = pid;
+            return slot;
+        }
+    }
+    rodsLog (LOG_NOTICE,
+      "getMyRescLoadSlot: all %d slots are in use. Load not counted",
+      RESC_LOAD_NUM_SLOTS);
+    MyRescLoadSlotPid = -pid;
+    return NULL;
+}
+
+void
+rescLoadXferStart (rodsLong_t dataSize)
+{
+    rescLoadSlot_t *slot;
+
+    if ((slot = getMyRescLoadSlot ()) == NULL) return;
+    if (dataSize < 0) dataSize = 0;
+    __sync_fetch_and_add (&slot->activeXfers, 1);
+    __sync_fetch_and_add (&slot->outstandingBytes, dataSize);
+}
+
+void
+rescLoadXferEnd (rodsLong_t dataSize)
+{
+    rescLoadSlot_t *slot;
+
+    if ((slot = getMyRescLoadSlot ()) == NULL) return;
+    if (dataSize < 0) dataSize = 0;
+    __sync_fetch_and_sub (&slot->activeXfers, 1);
+    __sync_fetch_and_sub (&slot->outstandingBytes, dataSize);
+}
+
+/* rescLoadFileDescStart - count the file opened in the local vault with
+ * fileInx until freeFileDesc */
+
+void
+rescLoadFileDescStart (int fileInx, rodsLong_t dataSize)
+{
+    if (fileInx < 3 || fileInx >= NUM_FILE_DESC) return;
+    if (dataSize < 0) dataSize = 0;
+    FileDesc[fileInx].loadFlag = 1;
+    FileDesc[fileInx].loadBytes = dataSize;
+    rescLoadXferStart (dataSize);
+}
+
+/* sampleVaultDisk - the no. of I/Os in flight and the busy percentage of
+ * the disk of vaultPath. The busy time is sampled at most once every
+ * RESC_LOAD_DISK_SAMPLE_MS by any agent. -1 if not known */
+
+static void
+sampleVaultDisk (rescLoadSeg_t *seg, char *vaultPath, int *queueDepth,
+int *diskBusy)
+{
+#if defined(linux_platform)
+    struct stat statbuf;
+    struct timeval tv;
+    rescLoadDisk_t *disk = NULL;
+    char buf[MAX_NAME_LEN], devName[NAME_LEN];
+    uint devMajor, devMinor, inFlight, ioTicks, dev;
+    rodsLong_t nowMs, elapsedMs;
+    FILE *fp;
+    int i, found = 0;
+
+    *queueDepth = *diskBusy = -1;
+    if (stat (vaultPath, &statbuf) < 0) return;
+    if ((fp = fopen (DISK_STATS_FILE, "r")) == NULL) return;
+    while (fgets (buf, MAX_NAME_LEN, fp) != NULL) {
+        if (sscanf (buf, "%u %u %63s %*u %*u %*u %*u %*u %*u %*u %*u %u %u",
+          &devMajor, &devMinor, devName, &inFlight, &ioTicks) != 5)
+            continue;
+        if (devMajor == major (statbuf.st_dev) &&
+          devMinor == minor (statbuf.st_dev)) {
+            found = 1;
+            break;
+        }
+    }
+    fclose (fp);
+    /* not on a local disk */
+    if (found == 0) return;
+    *queueDepth = inFlight;
+
+    dev = (uint) statbuf.st_dev;
+    if (dev == 0 || seg == NULL) return;
+    for (i = 0; i < RESC_LOAD_NUM_DISKS; i++) {
+        if (seg->disk[i].dev == dev ||
+          (seg->disk[i].dev == 0 &&
+          __sync_bool_compare_and_swap (&seg->disk[i].dev, 0, dev))) {
+            disk = &seg->disk[i];
+            break;
+        }
+    }
+    if (disk == NULL) return;
+
+    (void) gettimeofday (&tv, (struct timezone *) 0);
+    nowMs = (rodsLong_t) tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    elapsedMs = nowMs - disk->sampleMs;
+    if (elapsedMs >= RESC_LOAD_DISK_SAMPLE_MS &&
+      __sync_bool_compare_and_swap (&disk->lock, 0, 1)) {
+        if (disk->sampleMs > 0) {
+            disk->busy = (int) ((rodsLong_t) (ioTicks - disk->ioTicks) *
+              100 / elapsedMs);
+            if (disk->busy > 100) disk->busy = 100;
+        } else {
+            disk->busy = -1;
+        }
+        disk->ioTicks = ioTicks;
+        disk->sampleMs = nowMs;
+        disk->lock = 0;
+    }
+    *diskBusy = disk->busy;
+#else
+    *queueDepth = *diskBusy = -1;
+#endif
+}
+
+/* getLocalRescLoad - the load of the local server for the resource with
+ * vault vaultPath */
+
+int
+getLocalRescLoad (rsComm_t *rsComm, int fileType, char *vaultPath,
+fileGetLoadOut_t *outLoad)
+{
+    rescLoadSeg_t *seg;
+    rescLoadSlot_t *slot;
+    int i, slotPid;
+
+    memset (outLoad, 0, sizeof (fileGetLoadOut_t));
+    outLoad->sampleTime = time (0);
+    if ((seg = getRescLoadSeg ()) == NULL) {
+        outLoad->activeXfers = -1;
+        outLoad->outstandingBytes = -1;
+    } else {
+        for (i = 0; i < RESC_LOAD_NUM_SLOTS; i++) {
+            slot = &seg->slot[i];
+            if ((slotPid = slot->pid) == 0 || !isLiveAgent (slotPid))
+                continue;
+            if (slot->activeXfers > 0)
+                outLoad->activeXfers += slot->activeXfers;
+            if (slot->outstandingBytes > 0)
+                outLoad->outstandingBytes += slot->outstandingBytes;
+        }
+    }
+    sampleVaultDisk (seg, vaultPath, &outLoad->queueDepth,
+      &outLoad->diskBusy);
+    outLoad->freeSpace = fileGetFsFreeSpace ((fileDriverType_t) fileType,
+      rsComm, vaultPath, 0);
+    if (outLoad->freeSpace < 0) outLoad->freeSpace = -1;
+    return 0;
+}
+
+/* getRescLoad - the load of the server of rescInfo. The load is asked for
+ * at most once every RESC_LOAD_CACHE_TIME sec. *outLoad points to the
+ * cache and must not be freed */
+
+int
+getRescLoad (rsComm_t *rsComm, rescInfo_t *rescInfo,
+fileGetLoadOut_t **outLoad)
+{
+    rescLoad_t *rescLoad;
+    fileGetLoadInp_t fileGetLoadInp;
+    fileGetLoadOut_t *fileGetLoadOut = NULL;
+    int rescTypeInx;
+
+    *outLoad = NULL;
+    for (rescLoad = RescLoadHead; rescLoad != NULL;
+      rescLoad = rescLoad->next) {
+        if (strcmp (rescLoad->rescName, rescInfo->rescName) == 0) break;
+    }
+    if (rescLoad == NULL) {
+        rescLoad = (rescLoad_t *) calloc (1, sizeof (rescLoad_t));
+        rstrcpy (rescLoad->rescName, rescInfo->rescName, NAME_LEN);
+        rescLoad->next = RescLoadHead;
+        RescLoadHead = rescLoad;
+    } else if (time (0) - rescLoad->queryTime < RESC_LOAD_CACHE_TIME) {
+        if (rescLoad->status < 0) return rescLoad->status;
+        *outLoad = &rescLoad->load;
+        return 0;
+    }
+
+    rescLoad->queryTime = time (0);
+    rescTypeInx = rescInfo->rescTypeInx;
+    if (RescTypeDef[rescTypeInx].rescCat != FILE_CAT) {
+        rescLoad->status = SYS_INVALID_RESC_TYPE;
+        return rescLoad->status;
+    }
+    memset (&fileGetLoadInp, 0, sizeof (fileGetLoadInp));
+    fileGetLoadInp.fileType =
+      (fileDriverType_t) RescTypeDef[rescTypeInx].driverType;
+    rstrcpy (fileGetLoadInp.addr.hostAddr, rescInfo->rescLoc, NAME_LEN);
+    rstrcpy (fileGetLoadInp.fileName, rescInfo->rescVaultPath, MAX_NAME_LEN);
+    rescLoad->status = rsFileGetLoad (rsComm, &fileGetLoadInp,
+      &fileGetLoadOut);
+    if (fileGetLoadOut != NULL) {
+        if (rescLoad->status >= 0) rescLoad->load = *fileGetLoadOut;
+        free (fileGetLoadOut);
+    }
+    if (rescLoad->status < 0) return rescLoad->status;
+    *outLoad = &rescLoad->load;
+    return 0;
+}
+
+/* getRescLoadWeight - the weight of a resource with load in the "byLiveLoad" scheme.
+ * The more work the server has queued, the lower the weight. -1 if the
+ * load is not known */
+
+int
+getRescLoadWeight (fileGetLoadOut_t *load)
+{
+    rodsLong_t cost, weight;
+    int diskBusy;
+
+    if (load == NULL) return -1;
+    if (load->freeSpace >= 0 && load->freeSpace < RESC_LOAD_LOW_FREE_SPACE)
+        return 1;
+
+    cost = 1;
+    if (load->activeXfers > 0) cost += load->activeXfers;
+    if (load->queueDepth > 0) cost += load->queueDepth;
+    if (load->outstandingBytes > 0)
+        cost += load->outstandingBytes / RESC_LOAD_BYTE_UNIT;
+    diskBusy = load->diskBusy;
+    if (diskBusy < 0) diskBusy = 0;
+    if (diskBusy > 100) diskBusy = 100;
+
+    weight = RESC_LOAD_WEIGHT_SCALE * (100 - diskBusy / 2) / 100 / cost;
+    if (weight < 1) weight = 1;
+    return (int) weight;
+}
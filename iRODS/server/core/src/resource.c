@@ -5,6 +5,7 @@
 #include "resource.h"
 #include "genQuery.h"
 #include "rodsClient.h"
+#include "rescLoad.h"
 
 /* getRescInfo - Given the rescName or rescgrpName in condInput keyvalue
  * pair or defaultResc, return the rescGrpInfo containing the info on
@@ -283,8 +284,8 @@ getNumResc (rescGrpInfo_t *rescGrpInfo)
 
 /* sortResc - Sort the resources given in the rescGrpInfo link list
  * according to the sorting scheme given in sortScheme. sortScheme
- * can be "random", "byRescClass" or "byLoad". The sorted rsources
- * is also given in rescGrpInfo.
+ * can be "random", "byRescClass", "byLoad", "byLiveLoad" or
+ * "byLeastBytes". The sorted rsources is also given in rescGrpInfo.
  */
 
 int
@@ -317,6 +318,10 @@ char *sortScheme)
         sortRescByType (rescGrpInfo);
         } else if (strcmp (sortScheme, "byLoad") == 0) {
         sortRescByLoad (rsComm, rescGrpInfo);
+    } else if (strcmp (sortScheme, "byLiveLoad") == 0) {
+        sortRescByLiveLoad (rsComm, rescGrpInfo);
+    } else if (strcmp (sortScheme, "byLeastBytes") == 0) {
+        sortRescByLeastBytes (rsComm, rescGrpInfo);
     } else {
             rodsLog (LOG_ERROR,
               "sortResc: unknown sortScheme %s", sortScheme);
@@ -500,6 +505,141 @@ sortRescByLoad (rsComm_t *rsComm, rescGrpInfo_t **rescGrpInfo)
     return 0;
 }
 
+/* sortRescByLiveLoad - sort the resource in the rescGrpInfo link list
+ * in a weighted random order. The weight of a resource comes from the
+ * live load of its server (getRescLoadWeight) so that a busy server
+ * still gets a share of the new files, only a smaller one. A resource
+ * of unknown load gets the average weight.
+ */
+
+int
+sortRescByLiveLoad (rsComm_t *rsComm, rescGrpInfo_t **rescGrpInfo)
+{
+    rescGrpInfo_t *tmpRescGrpInfo;
+    rescInfo_t **rescInfoArray, *tmpRescInfo;
+    fileGetLoadOut_t *load;
+    int *weightArray;
+    int numResc, numKnown, i, j, tmpWeight;
+    rodsLong_t totalWeight, ranNum;
+
+    numResc = getRescCnt (*rescGrpInfo);
+    if (numResc <= 1) return 0;
+
+    rescInfoArray = (rescInfo_t **) malloc (numResc * sizeof (rescInfo_t *));
+    weightArray = (int *) malloc (numResc * sizeof (int));
+    numKnown = 0;
+    totalWeight = 0;
+    tmpRescGrpInfo = *rescGrpInfo;
+    for (i = 0; i < numResc; i++) {
+        rescInfoArray[i] = tmpRescGrpInfo->rescInfo;
+        if (getRescLoad (rsComm, rescInfoArray[i], &load) >= 0) {
+            weightArray[i] = getRescLoadWeight (load);
+            numKnown++;
+            totalWeight += weightArray[i];
+        } else {
+            weightArray[i] = -1;
+        }
+        tmpRescGrpInfo = tmpRescGrpInfo->next;
+    }
+    if (numKnown == 0) {
+        /* no live load. Keep the order */
+        free (rescInfoArray);
+        free (weightArray);
+        return 0;
+    }
+    for (i = 0; i < numResc; i++) {
+        if (weightArray[i] < 0) {
+            weightArray[i] = totalWeight / numKnown;
+            if (weightArray[i] < 1) weightArray[i] = 1;
+        }
+    }
+
+    /* draw without replacement */
+    for (i = 0; i < numResc - 1; i++) {
+        totalWeight = 0;
+        for (j = i; j < numResc; j++) totalWeight += weightArray[j];
+        ranNum = (random () >> 2) % totalWeight;
+        for (j = i; j < numResc - 1; j++) {
+            if (ranNum < weightArray[j]) break;
+            ranNum -= weightArray[j];
+        }
+        tmpRescInfo = rescInfoArray[i];
+        rescInfoArray[i] = rescInfoArray[j];
+        rescInfoArray[j] = tmpRescInfo;
+        tmpWeight = weightArray[i];
+        weightArray[i] = weightArray[j];
+        weightArray[j] = tmpWeight;
+    }
+
+    tmpRescGrpInfo = *rescGrpInfo;
+    for (i = 0; i < numResc; i++) {
+        tmpRescGrpInfo->rescInfo = rescInfoArray[i];
+        tmpRescGrpInfo = tmpRescGrpInfo->next;
+    }
+    free (rescInfoArray);
+    free (weightArray);
+    return 0;
+}
+
+/* sortRescByLeastBytes - sort the resource in the rescGrpInfo link list
+ * by the Bytes being transferred by their servers, the least first. Ties
+ * go to the server with fewer transfers. Resources of unknown load are
+ * put at the end in their original order.
+ */
+
+int
+sortRescByLeastBytes (rsComm_t *rsComm, rescGrpInfo_t **rescGrpInfo)
+{
+    rescGrpInfo_t *tmpRescGrpInfo;
+    rescInfo_t **rescInfoArray;
+    fileGetLoadOut_t **loadArray, *load;
+    int numResc, i, j;
+
+    numResc = getRescCnt (*rescGrpInfo);
+    if (numResc <= 1) return 0;
+
+    rescInfoArray = (rescInfo_t **) malloc (numResc * sizeof (rescInfo_t *));
+    loadArray = (fileGetLoadOut_t **) 
+      malloc (numResc * sizeof (fileGetLoadOut_t *));
+    tmpRescGrpInfo = *rescGrpInfo;
+    for (i = 0; i < numResc; i++) {
+        rescInfoArray[i] = tmpRescGrpInfo->rescInfo;
+        if (getRescLoad (rsComm, rescInfoArray[i], &load) < 0 ||
+          load->outstandingBytes < 0) {
+            load = NULL;
+        }
+        loadArray[i] = load;
+        tmpRescGrpInfo = tmpRescGrpInfo->next;
+    }
+
+    /* insertion sort. Keeps the order of equals */
+    for (i = 1; i < numResc; i++) {
+        rescInfo_t *tmpRescInfo = rescInfoArray[i];
+        load = loadArray[i];
+        for (j = i; j > 0; j--) {
+            fileGetLoadOut_t *prevLoad = loadArray[j - 1];
+            if (load == NULL) break;
+            if (prevLoad != NULL &&
+              (prevLoad->outstandingBytes < load->outstandingBytes ||
+              (prevLoad->outstandingBytes == load->outstandingBytes &&
+              prevLoad->activeXfers <= load->activeXfers))) break;
+            rescInfoArray[j] = rescInfoArray[j - 1];
+            loadArray[j] = prevLoad;
+        }
+        rescInfoArray[j] = tmpRescInfo;
+        loadArray[j] = load;
+    }
+
+    tmpRescGrpInfo = *rescGrpInfo;
+    for (i = 0; i < numResc; i++) {
+        tmpRescGrpInfo->rescInfo = rescInfoArray[i];
+        tmpRescGrpInfo = tmpRescGrpInfo->next;
+    }
+    free (rescInfoArray);
+    free (loadArray);
+    return 0;
+}
+
 /* sortRescByLocation - float LOCAL_HOST resources to the top */
 int
 sortRescByLocation (rescGrpInfo_t **rescGrpInfo)
@@ -208,6 +208,7 @@ agentMain (rsComm_t *rsComm)
 	    }
 	}
     }
+    logSockCommStat ("agentMain");
     return (status);
 }
 
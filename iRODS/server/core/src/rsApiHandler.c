@@ -12,6 +12,7 @@
 #include "regReplica.h"
 #include "unregDataObj.h"
 #include "modAVUMetadata.h"
+#include "dataObjOpr.h"
 
 #ifdef USE_BOOST
 #include <boost/thread.hpp>
@@ -44,6 +45,7 @@ bytesBuf_t *bsBBuf)
     bytesBuf_t myOutBsBBuf;
     int retVal = 0;
     int numArg = 0;
+    int cacheFlag;
     void *myArgv[4];
     
     memset (&myOutBsBBuf, 0, sizeof (bytesBuf_t));
@@ -144,6 +146,8 @@ bytesBuf_t *bsBBuf)
         numArg++;
     };
 
+    /* getDataObjInfo results are reused within this request */
+    cacheFlag = beginDataObjInfoCache (RsApiTable[apiInx].apiNumber);
     if (numArg == 0) {
 	 retVal = (*myHandler) (rsComm);
     } else if (numArg == 1) {
@@ -156,6 +160,7 @@ bytesBuf_t *bsBBuf)
          retVal = (*myHandler) (rsComm, myArgv[0], myArgv[1], myArgv[2],
 	  myArgv[3]);
     }
+    if (cacheFlag > 0) endDataObjInfoCache ();
 
     if (myInStruct != NULL) {
         /* XXXXX this is a hack to reduce mem leak. Need a more generalized
@@ -254,6 +259,42 @@ void *myOutStruct, bytesBuf_t *myOutBsBBuf)
     return (retval);
 }
 
+/* packWireOutStruct - pack the outStruct of the reply to a client which
+ * asked for wire options (rsComm->wireOpt), i.e. compress it if it is
+ * large enough. Returns 1 if outStructBBuf is wire encoded (a
+ * RODS_API_CREPLY_T reply) and 0 if it is just the plain packed struct.
+ */
+
+int
+packWireOutStruct (rsComm_t *rsComm, int apiInx, void *myOutStruct,
+bytesBuf_t **outStructBBuf)
+{
+    bytesBuf_t *packedBBuf = NULL;
+    bytesBuf_t wireBBuf;
+    int status;
+
+    status = packStruct ((char *) myOutStruct, &packedBBuf,
+      RsApiTable[apiInx].outPackInstruct, RodsPackTable, FREE_POINTER, 
+      rsComm->irodsProt);
+    if (status < 0) return status;
+
+    if (packedBBuf->len < WIRE_COMPRESS_MIN_LEN) {
+	*outStructBBuf = packedBBuf;
+	return 0;
+    }
+    if (encodeWireMsg (packedBBuf, rsComm->wireOpt, &wireBBuf) <= 0) {
+	/* did not compress. Just send the plain one */
+	free (wireBBuf.buf);
+	*outStructBBuf = packedBBuf;
+	return 0;
+    }
+    freeBBuf (packedBBuf);
+    *outStructBBuf = (bytesBuf_t *) malloc (sizeof (bytesBuf_t));
+    **outStructBBuf = wireBBuf;
+
+    return 1;
+}
+
 int
 sendApiReply (rsComm_t *rsComm, int apiInx, int retVal, 
 void *myOutStruct, bytesBuf_t *myOutBsBBuf)
@@ -263,6 +304,7 @@ void *myOutStruct, bytesBuf_t *myOutBsBBuf)
     bytesBuf_t *myOutStructBBuf;
     bytesBuf_t *rErrorBBuf = NULL;
     bytesBuf_t *myRErrorBBuf;
+    char *replyType = RODS_API_REPLY_T;
 
 //#ifndef windows_platform
     svrChkReconnAtSendStart (rsComm);
@@ -275,9 +317,15 @@ void *myOutStruct, bytesBuf_t *myOutBsBBuf)
 
     if (RsApiTable[apiInx].outPackInstruct != NULL && myOutStruct != NULL) {
 
-        status = packStruct ((char *) myOutStruct, &outStructBBuf,
-          RsApiTable[apiInx].outPackInstruct, RodsPackTable, FREE_POINTER, 
-	  rsComm->irodsProt);
+	if (rsComm->wireOpt != 0) {
+	    status = packWireOutStruct (rsComm, apiInx, myOutStruct,
+	      &outStructBBuf);
+	    if (status > 0) replyType = RODS_API_CREPLY_T;
+	} else {
+            status = packStruct ((char *) myOutStruct, &outStructBBuf,
+              RsApiTable[apiInx].outPackInstruct, RodsPackTable, FREE_POINTER, 
+	      rsComm->irodsProt);
+	}
 
        if (status < 0) {
             rodsLog (LOG_NOTICE,
@@ -333,11 +381,11 @@ void *myOutStruct, bytesBuf_t *myOutBsBBuf)
 
 #ifdef USE_SSL
     if (rsComm->ssl_on) 
-        status = sslSendRodsMsg (rsComm->sock, RODS_API_REPLY_T, myOutStructBBuf,
+        status = sslSendRodsMsg (rsComm->sock, replyType, myOutStructBBuf,
                               myOutBsBBuf, myRErrorBBuf, retVal, rsComm->irodsProt, rsComm->ssl);
     else
 #endif
-        status = sendRodsMsg (rsComm->sock, RODS_API_REPLY_T, myOutStructBBuf,
+        status = sendRodsMsg (rsComm->sock, replyType, myOutStructBBuf,
                               myOutBsBBuf, myRErrorBBuf, retVal, rsComm->irodsProt);
 	
     if (status < 0) {
@@ -622,8 +670,9 @@ readAndProcClientMsg (rsComm_t *rsComm, int flags)
                               &bsBBuf, &errorBBuf, rsComm->irodsProt, NULL, rsComm->ssl);
     else
 #endif
-        status = readMsgBody (rsComm->sock, &myHeader, &inputStructBBuf,
-                              &bsBBuf, &errorBBuf, rsComm->irodsProt, NULL);
+        status = readMsgBodyToPool (rsComm->sock, &myHeader, &inputStructBBuf,
+                              &bsBBuf, &errorBBuf, rsComm->irodsProt, NULL,
+                              RECV_POOL_MSG | RECV_POOL_BS);
     if (status < 0) {
         rodsLog (LOG_NOTICE,
           "agentMain: readMsgBody error. status = %d", status);
@@ -647,9 +696,9 @@ readAndProcClientMsg (rsComm_t *rsComm, int flags)
 	snprintf (tmpStr, NAME_LEN, "handle API %d", myHeader.intInfo);
         printSysTiming ("irodsAgent", tmpStr, 0);
 #endif
-        clearBBuf (&inputStructBBuf);
-        clearBBuf (&bsBBuf);
-        clearBBuf (&errorBBuf);
+        clearRecvBBuf (&inputStructBBuf);
+        clearRecvBBuf (&bsBBuf);
+        clearRecvBBuf (&errorBBuf);
 	if ((flags & RET_API_STATUS) != 0) {
 	    return (status);
 	} else {
@@ -11,6 +11,87 @@
 
 static int HaveFailedSpecCollPath = 0;
 static char FailedSpecCollPath[MAX_NAME_LEN];
+/* the specCollCache_t of SpecCollCacheHead hashed by collection */
+static specCollHash_t *SpecCollHashTable = NULL;
+/* parent collections with no special collection at or above them. The
+ * value is the list of the special children of the parent as "/c1/c2/",
+ * "/" if none */
+static specCollHash_t *NoSpecCollHashTable = NULL;
+
+/* a small string keyed hash for the caches above. The hashtable of the
+ * rule engine is not linked into every server config */
+
+static int
+specCollHashInx (char *key)
+{
+    unsigned int hash = 5381;
+
+    while (*key != '\0') {
+        hash = hash * 33 + (unsigned char) *key++;
+    }
+    return (int) (hash % SPEC_COLL_HASH_SIZE);
+}
+
+static void *
+lookupSpecCollHash (specCollHash_t *hashTable, char *key)
+{
+    specCollHashEntry_t *entry;
+
+    entry = hashTable->bucket[specCollHashInx (key)];
+    while (entry != NULL) {
+        if (strcmp (entry->key, key) == 0) return entry->value;
+        entry = entry->next;
+    }
+    return NULL;
+}
+
+/* putSpecCollHash - add key or replace the value of key. The old value is
+ * not freed */
+
+static int
+putSpecCollHash (specCollHash_t *hashTable, char *key, void *value)
+{
+    specCollHashEntry_t *entry;
+    int inx;
+
+    inx = specCollHashInx (key);
+    for (entry = hashTable->bucket[inx]; entry != NULL; entry = entry->next) {
+        if (strcmp (entry->key, key) == 0) {
+            entry->value = value;
+            return 0;
+        }
+    }
+    entry = (specCollHashEntry_t *) malloc (sizeof (specCollHashEntry_t));
+    if (entry == NULL) return SYS_MALLOC_ERR;
+    entry->key = strdup (key);
+    entry->value = value;
+    entry->next = hashTable->bucket[inx];
+    hashTable->bucket[inx] = entry;
+    hashTable->len++;
+    return 0;
+}
+
+/* freeSpecCollHash - free hashTable. The values are freed too if
+ * freeValueFlag is set */
+
+static void
+freeSpecCollHash (specCollHash_t *hashTable, int freeValueFlag)
+{
+    specCollHashEntry_t *entry, *nextEntry;
+    int i;
+
+    for (i = 0; i < SPEC_COLL_HASH_SIZE; i++) {
+        entry = hashTable->bucket[i];
+        while (entry != NULL) {
+            nextEntry = entry->next;
+            free (entry->key);
+            if (freeValueFlag > 0 && entry->value != NULL) free (entry->value);
+            free (entry);
+            entry = nextEntry;
+        }
+    }
+    free (hashTable);
+}
 
 /* querySpecColl - The query can produce multiple answer and only one
  * is correct. e.g., objPath = /x/yabc can produce answers:
@@ -181,6 +262,7 @@ queueSpecCollCache (rsComm_t *rsComm, genQueryOut_t *genQueryOut, char *objPath)
             rstrcpy (tmpSpecCollCache->modifyTime, tmpModifyTime, NAME_LEN);
             tmpSpecCollCache->next = SpecCollCacheHead;
             SpecCollCacheHead = tmpSpecCollCache;
+            hashSpecCollCache (tmpSpecCollCache);
             return 0;
         }
     }
@@ -208,29 +290,151 @@ queueSpecCollCacheWithObjStat (rodsObjStat_t *rodsObjStatOut)
 
     tmpSpecCollCache->next = SpecCollCacheHead;
     SpecCollCacheHead = tmpSpecCollCache;
+    hashSpecCollCache (tmpSpecCollCache);
 
     return 0;
 
 }
 
+/* hashSpecCollCache - add a specCollCache queued at SpecCollCacheHead to
+ * SpecCollHashTable. A collection queued again replaces the older one */
+
+int
+hashSpecCollCache (specCollCache_t *specCollCache)
+{
+    if (SpecCollHashTable == NULL) {
+        SpecCollHashTable = (specCollHash_t *) 
+          calloc (1, sizeof (specCollHash_t));
+        if (SpecCollHashTable == NULL) return SYS_MALLOC_ERR;
+    }
+    return putSpecCollHash (SpecCollHashTable,
+      specCollCache->specColl.collection, specCollCache);
+}
+
+/* matchSpecCollCache - return the cached specColl objPath is in. The
+ * parent paths of objPath are looked up from the deepest one */
+
 specCollCache_t *
 matchSpecCollCache (char *objPath)
 {
-    specCollCache_t *tmpSpecCollCache = SpecCollCacheHead;
+    specCollCache_t *tmpSpecCollCache;
+    char myPath[MAX_NAME_LEN];
+    char *tmpPtr;
+
+    if (SpecCollHashTable == NULL) return NULL;
+    rstrcpy (myPath, objPath, MAX_NAME_LEN);
+    while (*myPath != '\0') {
+        if ((tmpSpecCollCache = (specCollCache_t *) 
+          lookupSpecCollHash (SpecCollHashTable, myPath)) != NULL) {
+            return (tmpSpecCollCache);
+        }
+        if ((tmpPtr = strrchr (myPath, '/')) == NULL) break;
+        *tmpPtr = '\0';
+    }
+    return (NULL);
+}
 
-    while (tmpSpecCollCache != NULL) {
-        int len = strlen (tmpSpecCollCache->specColl.collection);
-        if (strncmp (tmpSpecCollCache->specColl.collection, objPath, len)
-          == 0) {
-            char *tmpPtr = objPath + len;
+/* isNoSpecCollPath - returns 1 if the parent collection of objPath is
+ * known to have no special collection at or above it and objPath is
+ * not one of its special children. Otherwise 0 */
 
-            if (*tmpPtr == '\0' || *tmpPtr == '/') {
-                return (tmpSpecCollCache);
-            }
+int
+isNoSpecCollPath (char *objPath)
+{
+    char parentColl[MAX_NAME_LEN], childName[MAX_NAME_LEN];
+    char myChild[MAX_NAME_LEN + 2];
+    char *specChildren;
+
+    if (NoSpecCollHashTable == NULL) return 0;
+    if (splitPathByKey (objPath, parentColl, childName, '/') < 0) return 0;
+    specChildren = (char *) lookupSpecCollHash (NoSpecCollHashTable,
+      parentColl);
+    if (specChildren == NULL) return 0;
+    snprintf (myChild, MAX_NAME_LEN + 2, "/%s/", childName);
+    if (strstr (specChildren, myChild) != NULL) return 0;
+    return 1;
+}
+
+/* cacheNoSpecColl - objPath has no special collection at or above it.
+ * Remember it for its parent collection together with the special children
+ * of the parent, so that the siblings of objPath do not need a
+ * querySpecColl */
+
+int
+cacheNoSpecColl (rsComm_t *rsComm, char *objPath)
+{
+    genQueryInp_t genQueryInp;
+    genQueryOut_t *genQueryOut = NULL;
+    sqlResult_t *collection;
+    char parentColl[MAX_NAME_LEN], childName[MAX_NAME_LEN];
+    char condStr[MAX_NAME_LEN + 8];	/* room for "= '<parentColl>'" */
+    char *specChildren, *tmpPtr;
+    int status, i, len;
+
+    if (splitPathByKey (objPath, parentColl, childName, '/') < 0) return 0;
+    if (NoSpecCollHashTable == NULL) {
+        NoSpecCollHashTable = (specCollHash_t *) 
+          calloc (1, sizeof (specCollHash_t));
+        if (NoSpecCollHashTable == NULL) return SYS_MALLOC_ERR;
+    } else if (NoSpecCollHashTable->len >= MAX_NO_SPEC_COLL_CACHE) {
+        return 0;
+    } else if (lookupSpecCollHash (NoSpecCollHashTable, parentColl) != 
+      NULL) {
+        return 0;
+    }
+
+    memset (&genQueryInp, 0, sizeof (genQueryInp));
+    snprintf (condStr, sizeof (condStr), "= '%s'", parentColl);
+    addInxVal (&genQueryInp.sqlCondInp, COL_COLL_PARENT_NAME, condStr);
+    rstrcpy (condStr, "like '_%'", MAX_NAME_LEN);
+    addInxVal (&genQueryInp.sqlCondInp, COL_COLL_TYPE, condStr);
+    addInxIval (&genQueryInp.selectInp, COL_COLL_NAME, 1);
+    genQueryInp.maxRows = MAX_SQL_ROWS;
+
+    status = rsGenQuery (rsComm, &genQueryInp, &genQueryOut);
+    clearGenQueryInp (&genQueryInp);
+    if (status == CAT_NO_ROWS_FOUND) {
+        specChildren = strdup ("/");
+    } else if (status < 0) {
+        return status;
+    } else if (genQueryOut->continueInx > 0 || (collection = 
+      getSqlResultByInx (genQueryOut, COL_COLL_NAME)) == NULL) {
+        /* too many special children to be worth it */
+        freeGenQueryOut (&genQueryOut);
+        return 0;
+    } else {
+        specChildren = (char *) malloc (genQueryOut->rowCnt * 
+          (collection->len + 1) + 2);
+        tmpPtr = specChildren;
+        *tmpPtr++ = '/';
+        for (i = 0; i < genQueryOut->rowCnt; i++) {
+            if (splitPathByKey (&collection->value[collection->len * i], 
+              condStr, childName, '/') < 0) continue;
+            len = strlen (childName);
+            memcpy (tmpPtr, childName, len);
+            tmpPtr += len;
+            *tmpPtr++ = '/';
         }
-        tmpSpecCollCache = tmpSpecCollCache->next;
+        *tmpPtr = '\0';
+        freeGenQueryOut (&genQueryOut);
     }
-    return (NULL);
+    status = putSpecCollHash (NoSpecCollHashTable, parentColl, specChildren);
+    if (status < 0) free (specChildren);
+    return status;
+}
+
+/* clearNoSpecCollCache - forget the cached paths with no special
+ * collection. Called when a collection type is set by this agent */
+
+int
+clearNoSpecCollCache ()
+{
+    if (NoSpecCollHashTable != NULL) {
+        freeSpecCollHash (NoSpecCollHashTable, 1);
+        NoSpecCollHashTable = NULL;
+    }
+    HaveFailedSpecCollPath = 0;
+    return 0;
 }
 
 /* getSpecCollCache - check if the path is in a special collection.
@@ -249,14 +453,18 @@ int inCachOnly, specCollCache_t **specCollCache)
         return (0);
     } else if (inCachOnly > 0) {
         return (SYS_SPEC_COLL_NOT_IN_CACHE);
+    } else if (isNoSpecCollPath (objPath) > 0) {
+        return (CAT_NO_ROWS_FOUND);
     }
 
     status = querySpecColl (rsComm, objPath, &genQueryOut);
+    if (status == CAT_NO_ROWS_FOUND) cacheNoSpecColl (rsComm, objPath);
     if (status < 0) return (status);
 
     status = queueSpecCollCache (rsComm, genQueryOut, objPath);
     freeGenQueryOut (&genQueryOut);
 
+    if (status == CAT_NO_ROWS_FOUND) cacheNoSpecColl (rsComm, objPath);
     if (status < 0) return (status);
     *specCollCache = SpecCollCacheHead;  /* queued at top */
 
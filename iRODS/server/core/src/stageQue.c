@@ -0,0 +1,396 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* stageQue.c - coordinate the staging of compound resource copies to the
+ * cache resource.
+ *
+ * Agents staging the same object are serialized through a lock file in
+ * the lockFileDir so that only the first one does the recall. The others
+ * find the good cache copy once they get the lock. The object is hashed
+ * to one of a fixed pool of STAGE_LOCK_POOL_SIZE lock files so that the
+ * lockFileDir does not grow with the number of objects staged.
+ * The number of concurrent stages from each compound resource is bounded
+ * by a set of stageSlotsPerResc slot lock files. Prefetch of the siblings
+ * and the staging of whole collections are queued to the irodsReServer
+ * as delayed msiStageCollToCache rules, optionally split into shards so
+ * that several reServer processes stage in parallel.
+ */
+
+#include "stageQue.h"
+#include "dataObjOpr.h"
+#include "dataObjRepl.h"
+#include "physPath.h"
+#include "resource.h"
+#include "openCollection.h"
+#include "readCollection.h"
+#include "closeCollection.h"
+#include "rsGlobalExtern.h"
+#include "reGlobalsExtern.h"
+#include "reFuncDefs.h"
+
+static int StageSlotCnt = 0;
+static char LastPrefetchColl[MAX_NAME_LEN];
+
+static unsigned int
+hashStageName (char *name)
+{
+    unsigned int hash = 5381;
+    int c;
+
+    while ((c = *name++) != '\0')
+        hash = hash * 33 + (unsigned char) c;
+
+    return hash;
+}
+
+/* getStageLockPath - the lock file path for name. Only the last
+ * component of name is kept in the file name. The hash of the full name
+ * makes it unique. Only used for the stage slots, which are bounded by
+ * the number of compound resources.
+ */
+
+static int
+getStageLockPath (char *prefix, char *name, char *outLockPath)
+{
+    char tmpName[STAGE_LOCK_NAME_LEN];
+    char *namePtr;
+
+    if (name == NULL || outLockPath == NULL) return USER__NULL_INPUT_ERR;
+
+    namePtr = strrchr (name, '/');
+    if (namePtr == NULL) {
+        namePtr = name;
+    } else {
+        namePtr++;
+    }
+    rstrcpy (tmpName, namePtr, STAGE_LOCK_NAME_LEN);
+    snprintf (outLockPath, MAX_NAME_LEN, "%-s/%-s/%-s.%-s.%x.%-s",
+      getStateDir(), LOCK_FILE_DIR, prefix, tmpName, hashStageName (name),
+      LOCK_FILE_TRAILER);
+
+    return 0;
+}
+
+static int
+stageLockFile (char *lockPath, int cmd)
+{
+    int status;
+    int lockFd;
+    struct flock myflock;
+
+    lockFd = open (lockPath, O_RDWR | O_CREAT, 0644);
+    if (lockFd < 0) {
+        status = FILE_OPEN_ERR - errno;
+        rodsLogError (LOG_NOTICE, status,
+          "stageLockFile: open error for %s", lockPath);
+        return status;
+    }
+    bzero (&myflock, sizeof (myflock));
+    myflock.l_type = F_WRLCK;
+    myflock.l_whence = SEEK_SET;
+    if (fcntl (lockFd, cmd, &myflock) < 0) {
+        /* not necessary an error for F_SETLK */
+        status = SYS_FS_LOCK_ERR - errno;
+        close (lockFd);
+        return status;
+    }
+    return lockFd;
+}
+
+static int
+getStageSlotCnt ()
+{
+    char *tmpStr;
+
+    if (StageSlotCnt > 0) return StageSlotCnt;
+
+    StageSlotCnt = DEF_STAGE_SLOTS_PER_RESC;
+    if ((tmpStr = getenv (STAGE_SLOTS_PER_RESC)) != NULL) {
+        int slotCnt = atoi (tmpStr);
+        if (slotCnt > 0 && slotCnt <= MAX_STAGE_SLOTS_PER_RESC)
+            StageSlotCnt = slotCnt;
+    }
+    return StageSlotCnt;
+}
+
+/* lockStageObj - Acquire the stage lock of objPath, waiting for the
+ * agent currently staging it. Returns the lock fd which should be
+ * released with releaseStageLock.
+ */
+
+int
+lockStageObj (char *objPath)
+{
+    int status;
+    char lockPath[MAX_NAME_LEN];
+
+    if (objPath == NULL) return USER__NULL_INPUT_ERR;
+
+    /* a hash collision only serializes two unrelated stages */
+    snprintf (lockPath, MAX_NAME_LEN, "%-s/%-s/%-s.%u.%-s",
+      getStateDir(), LOCK_FILE_DIR, STAGE_LOCK_PREFIX,
+      hashStageName (objPath) % STAGE_LOCK_POOL_SIZE, LOCK_FILE_TRAILER);
+
+    status = stageLockFile (lockPath, F_SETLKW);
+    if (status < 0) {
+        rodsLogError (LOG_NOTICE, status,
+          "lockStageObj: lock error for %s", objPath);
+    }
+    return status;
+}
+
+/* getStageSlot - Acquire one of the stage slots of the compound resource
+ * rescName. Try all slots without waiting first, starting from a pid
+ * dependent slot to spread the agents. If all are busy, wait on the
+ * starting slot.
+ */
+
+int
+getStageSlot (char *rescName)
+{
+    int i, status;
+    int slotCnt, startSlot;
+    char slotName[NAME_LEN];
+    char lockPath[MAX_NAME_LEN];
+
+    slotCnt = getStageSlotCnt ();
+    startSlot = getpid () % slotCnt;
+
+    for (i = 0; i < slotCnt; i++) {
+        snprintf (slotName, NAME_LEN, "%s.%d", rescName,
+          (startSlot + i) % slotCnt);
+        getStageLockPath (STAGE_SLOT_PREFIX, slotName, lockPath);
+        status = stageLockFile (lockPath, F_SETLK);
+        if (status >= 0) return status;
+    }
+
+    snprintf (slotName, NAME_LEN, "%s.%d", rescName, startSlot);
+    getStageLockPath (STAGE_SLOT_PREFIX, slotName, lockPath);
+    status = stageLockFile (lockPath, F_SETLKW);
+    if (status < 0) {
+        rodsLogError (LOG_NOTICE, status,
+          "getStageSlot: lock error for %s", rescName);
+    }
+    return status;
+}
+
+void
+releaseStageLock (int lockFd)
+{
+    /* closing the fd drops the fcntl lock */
+    if (lockFd >= 0) close (lockFd);
+}
+
+/* getStagedCacheCopy - Check whether objPath has a good copy in the
+ * cache resource cacheRescName. Returns 1 if it does and 0 if not.
+ * If outCacheObjInfo is not NULL, the cache copy is returned in it.
+ */
+
+int
+getStagedCacheCopy (rsComm_t *rsComm, char *objPath, char *cacheRescName,
+dataObjInfo_t *outCacheObjInfo)
+{
+    int status;
+    dataObjInp_t dataObjInp;
+    dataObjInfo_t *dataObjInfoHead = NULL;
+    dataObjInfo_t *tmpDataObjInfo, *prevDataObjInfo = NULL;
+
+    memset (&dataObjInp, 0, sizeof (dataObjInp));
+    rstrcpy (dataObjInp.objPath, objPath, MAX_NAME_LEN);
+    status = getDataObjInfo (rsComm, &dataObjInp, &dataObjInfoHead, NULL, 1);
+    if (status < 0) return 0;
+
+    tmpDataObjInfo = dataObjInfoHead;
+    while (tmpDataObjInfo != NULL) {
+        if (tmpDataObjInfo->replStatus > 0 &&
+          strcmp (tmpDataObjInfo->rescName, cacheRescName) == 0) break;
+        prevDataObjInfo = tmpDataObjInfo;
+        tmpDataObjInfo = tmpDataObjInfo->next;
+    }
+    if (tmpDataObjInfo == NULL) {
+        freeAllDataObjInfo (dataObjInfoHead);
+        return 0;
+    }
+
+    if (outCacheObjInfo != NULL) {
+        /* unlink it from the queue so that it can be handed out whole */
+        if (prevDataObjInfo == NULL) {
+            dataObjInfoHead = tmpDataObjInfo->next;
+        } else {
+            prevDataObjInfo->next = tmpDataObjInfo->next;
+        }
+        *outCacheObjInfo = *tmpDataObjInfo;
+        outCacheObjInfo->next = NULL;
+        free (tmpDataObjInfo);
+    }
+    freeAllDataObjInfo (dataObjInfoHead);
+    return 1;
+}
+
+/* stageObjToCache - stage objPath to the cache resource if its best copy
+ * is on a compound resource. Returns 1 if it was staged by this or a
+ * concurrent agent, 0 if nothing needed to be done.
+ */
+
+int
+stageObjToCache (rsComm_t *rsComm, char *objPath)
+{
+    int status;
+    dataObjInp_t dataObjInp;
+    dataObjInfo_t *dataObjInfoHead = NULL;
+
+    memset (&dataObjInp, 0, sizeof (dataObjInp));
+    rstrcpy (dataObjInp.objPath, objPath, MAX_NAME_LEN);
+    status = getDataObjInfoIncSpecColl (rsComm, &dataObjInp, &dataObjInfoHead);
+    if (status < 0) return status;
+
+    /* a good cache copy is sorted ahead of the compound copy */
+    status = sortObjInfoForOpen (rsComm, &dataObjInfoHead,
+      &dataObjInp.condInput, 0);
+    if (status >= 0) {
+        if (dataObjInfoHead->specColl == NULL &&
+          getRescClass (dataObjInfoHead->rescInfo) == COMPOUND_CL) {
+            status = stageDataFromCompToCache (rsComm, dataObjInfoHead, NULL);
+            if (status == SYS_COPY_ALREADY_IN_RESC) {
+                status = 0;
+            } else if (status >= 0) {
+                status = 1;
+            }
+        } else {
+            status = 0;
+        }
+    }
+    freeAllDataObjInfo (dataObjInfoHead);
+    return status;
+}
+
+/* stageCollToCache - stage the data objects of collInp->collName which
+ * only have a good copy on a compound resource. collInp->flags gives
+ * the rsOpenCollection flags (RECUR_QUERY_FG for the whole tree).
+ * If numShards > 1, only the objects whose path hashes to shardInx are
+ * staged. Failures are logged and the staging continues.
+ */
+
+int
+stageCollToCache (rsComm_t *rsComm, collInp_t *collInp, int shardInx,
+int numShards, int *outStagedCnt)
+{
+    int status;
+    int handleInx;
+    int savedStatus = 0;
+    int stagedCnt = 0;
+    collEnt_t *collEnt;
+    char objPath[MAX_NAME_LEN];
+
+    if (outStagedCnt != NULL) *outStagedCnt = 0;
+
+    handleInx = rsOpenCollection (rsComm, collInp);
+    if (handleInx < 0) {
+        rodsLog (LOG_ERROR,
+          "stageCollToCache: rsOpenCollection of %s error. status = %d",
+          collInp->collName, handleInx);
+        return (handleInx);
+    }
+
+    if (CollHandle[handleInx].rodsObjStat->specColl != NULL) {
+        /* mounted collections are not on compound resources */
+        rsCloseCollection (rsComm, &handleInx);
+        return (0);
+    }
+
+    while ((status = rsReadCollection (rsComm, &handleInx, &collEnt)) >= 0) {
+        if (collEnt->objType == DATA_OBJ_T) {
+            snprintf (objPath, MAX_NAME_LEN, "%s/%s",
+              collEnt->collName, collEnt->dataName);
+            if (numShards <= 1 ||
+              (int) (hashStageName (objPath) % numShards) == shardInx) {
+                status = stageObjToCache (rsComm, objPath);
+                if (status < 0) {
+                    rodsLogError (LOG_ERROR, status,
+                      "stageCollToCache: stageObjToCache failed for %s",
+                      objPath);
+                    savedStatus = status;
+                } else {
+                    stagedCnt += status;
+                }
+            }
+        }
+        free (collEnt);     /* just free collEnt but not content */
+    }
+    rsCloseCollection (rsComm, &handleInx);
+
+    if (outStagedCnt != NULL) *outStagedCnt = stagedCnt;
+    return (savedStatus);
+}
+
+/* queStageCollToCache - queue a delayed msiStageCollToCache rule to
+ * the irodsReServer for the shard shardInx of numShards of collPath.
+ */
+
+int
+queStageCollToCache (rsComm_t *rsComm, char *collPath, int collFlags,
+int shardInx, int numShards)
+{
+    int status;
+    ruleExecInfo_t rei;
+    char actionCall[MAX_ACTION_SIZE];
+
+    if (numShards > 1) {
+        snprintf (actionCall, MAX_ACTION_SIZE,
+          "msiStageCollToCache(\"%s\",\"%s=%d++++%s=%d/%d\",*Status);",
+          collPath, COLL_FLAGS_KW, collFlags, STAGE_SHARD_KW, shardInx,
+          numShards);
+    } else {
+        snprintf (actionCall, MAX_ACTION_SIZE,
+          "msiStageCollToCache(\"%s\",\"%s=%d\",*Status);",
+          collPath, COLL_FLAGS_KW, collFlags);
+    }
+
+    initReiWithDataObjInp (&rei, rsComm, NULL);
+    status = _delayExec (actionCall, "", STAGE_PREFETCH_DELAY, &rei);
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "queStageCollToCache: _delayExec of %s failed", actionCall);
+    }
+    return status;
+}
+
+/* queStagePrefetch - queue the staging of the siblings of objPath which
+ * has just been staged, if STAGE_PREFETCH_KW is in condInput or the
+ * stagePrefetch env is set. A collection is queued only once in a row
+ * per agent.
+ */
+
+int
+queStagePrefetch (rsComm_t *rsComm, char *objPath, keyValPair_t *condInput)
+{
+    int status;
+    char *tmpStr;
+    char collPath[MAX_NAME_LEN], dataName[MAX_NAME_LEN];
+
+    if (getValByKey (condInput, STAGE_PREFETCH_KW) == NULL &&
+      ((tmpStr = getenv (STAGE_PREFETCH)) == NULL || atoi (tmpStr) <= 0))
+        return 0;
+
+    if ((status = splitPathByKey (objPath, collPath, dataName, '/')) < 0)
+        return status;
+
+    if (strcmp (collPath, LastPrefetchColl) == 0) return 0;
+    rstrcpy (LastPrefetchColl, collPath, MAX_NAME_LEN);
+
+    return queStageCollToCache (rsComm, collPath, 0, 0, 0);
+}
+
+int
+parseStageShard (char *shardStr, int *shardInx, int *numShards)
+{
+    if (shardStr == NULL ||
+      sscanf (shardStr, "%d/%d", shardInx, numShards) != 2 ||
+      *numShards <= 0 || *shardInx < 0 || *shardInx >= *numShards) {
+        rodsLog (LOG_ERROR,
+          "parseStageShard: bad %s input %s, should be index/count",
+          STAGE_SHARD_KW, shardStr == NULL ? "NULL" : shardStr);
+        return USER_INPUT_FORMAT_ERR;
+    }
+    return 0;
+}
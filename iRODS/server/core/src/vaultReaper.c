@@ -0,0 +1,520 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* vaultReaper.c - unlink the vault files of a collection removed from the
+ * catalog with chlDelCollTree.
+ *
+ * The agent doing the delete writes the physical paths of the removed
+ * replicas into one queue file per resource under
+ * stateDir/reapFileDir/rescName. The files are written to a tmp name and
+ * renamed only after the catalog delete was committed, so that a failed
+ * delete never reaps live files. A delayed msiReapVault rule is then
+ * queued per resource. The irodsReServer runs the rules of different
+ * resources in parallel and, for a local vault, unlinks with
+ * reapNumThreads threads. A reaper claims a queue file by renaming it to
+ * a .work.pid name. The work file of a dead reaper is picked up again.
+ * Since the default vault path comes from the logical path, a new object
+ * put before the reaper runs may be registered at a queued path. Each
+ * path is therefore checked with chkOrphanFile first and only unlinked
+ * if no replica of the resource is registered there. Paths which could
+ * not be checked or unlinked are queued again and a reaper is queued to
+ * retry them after REAP_RETRY_DELAY.
+ */
+
+#include <dirent.h>
+#include <signal.h>
+#include "vaultReaper.h"
+#include "fileUnlink.h"
+#include "fileDriver.h"
+#include "initServer.h"
+#include "resource.h"
+#include "rsGlobalExtern.h"
+#include "reGlobalsExtern.h"
+#include "reFuncDefs.h"
+#include "dataObjOpr.h"
+#ifdef PARA_OPR
+#include <pthread.h>
+#endif
+
+static int ReapQueSeq = 0;
+
+typedef struct ReapWork {
+    rsComm_t *rsComm;
+    rescInfo_t *rescInfo;
+    FILE *fp;
+    reapQue_t *failedQue;
+    int reapedCnt;
+#ifdef PARA_OPR
+    pthread_mutex_t lock;
+#endif
+} reapWork_t;
+
+/* isRmCollTree - whether rmCollTree is set. The queue files are only
+ * seen by a reaper on the same host, so it is not used if the
+ * irodsReServer runs on another host */
+
+int
+isRmCollTree ()
+{
+    char *tmpStr;
+    rodsServerHost_t *reServerHost = NULL;
+
+    if ((tmpStr = getenv (RM_COLL_TREE_ENV)) == NULL || atoi (tmpStr) <= 0)
+        return 0;
+
+    if (getReHost (&reServerHost) < 0 || reServerHost == NULL ||
+      reServerHost->localFlag != LOCAL_HOST) {
+        return 0;
+    } else {
+        return 1;
+    }
+}
+
+int
+getReapNumThreads ()
+{
+    char *tmpStr;
+    int numThreads = DEF_REAP_NUM_THREADS;
+
+    if ((tmpStr = getenv (REAP_NUM_THREADS_ENV)) != NULL) {
+        numThreads = atoi (tmpStr);
+    }
+    if (numThreads > MAX_REAP_NUM_THREADS) numThreads = MAX_REAP_NUM_THREADS;
+    if (numThreads < 1) numThreads = 1;
+
+    return numThreads;
+}
+
+/* getReapDir - the queue dir of rescName. Made if mkFlag is set */
+
+static int
+getReapDir (char *rescName, char *outDir, int mkFlag)
+{
+    int status;
+
+    snprintf (outDir, MAX_NAME_LEN, "%-s/%-s", getStateDir(), REAP_FILE_DIR);
+    if (mkFlag > 0 && mkdir (outDir, 0700) < 0 && errno != EEXIST) {
+        status = UNIX_FILE_MKDIR_ERR - errno;
+        rodsLogError (LOG_ERROR, status, "getReapDir: mkdir %s failed", outDir);
+        return status;
+    }
+    snprintf (outDir, MAX_NAME_LEN, "%-s/%-s/%-s", getStateDir(),
+      REAP_FILE_DIR, rescName);
+    if (mkFlag > 0 && mkdir (outDir, 0700) < 0 && errno != EEXIST) {
+        status = UNIX_FILE_MKDIR_ERR - errno;
+        rodsLogError (LOG_ERROR, status, "getReapDir: mkdir %s failed", outDir);
+        return status;
+    }
+    return 0;
+}
+
+/* addToReapQue - queue filePath of rescName. The queue file of the
+ * resource is opened on first use */
+
+int
+addToReapQue (reapQue_t *reapQue, char *rescName, char *filePath)
+{
+    reapQueFile_t *queFile;
+    char reapDir[MAX_NAME_LEN];
+    char tmpPath[MAX_NAME_LEN + sizeof (REAP_TMP_TRAILER)];
+    int status;
+
+    if (reapQue == NULL || rescName == NULL || filePath == NULL)
+        return USER__NULL_INPUT_ERR;
+
+    /* one path per line */
+    if (strchr (filePath, '\n') != NULL) return SYS_INVALID_FILE_PATH;
+
+    queFile = reapQue->queHead;
+    while (queFile != NULL) {
+        if (strcmp (queFile->rescName, rescName) == 0) break;
+        queFile = queFile->next;
+    }
+
+    if (queFile == NULL) {
+        status = getReapDir (rescName, reapDir, 1);
+        if (status < 0) return status;
+        queFile = (reapQueFile_t *) malloc (sizeof (reapQueFile_t));
+        memset (queFile, 0, sizeof (reapQueFile_t));
+        rstrcpy (queFile->rescName, rescName, NAME_LEN);
+        if (snprintf (queFile->quePath, MAX_NAME_LEN, "%-s/%d.%u.%d",
+          reapDir, getpid (), (unsigned int) time (NULL), ReapQueSeq++) >=
+          MAX_NAME_LEN) {
+            rodsLog (LOG_ERROR,
+              "addToReapQue: queue file path in %s too long", reapDir);
+            free (queFile);
+            return USER_STRLEN_TOOLONG;
+        }
+        snprintf (tmpPath, sizeof (tmpPath), "%-s%-s", queFile->quePath,
+          REAP_TMP_TRAILER);
+        if ((queFile->fp = fopen (tmpPath, "w")) == NULL) {
+            status = FILE_OPEN_ERR - errno;
+            rodsLogError (LOG_ERROR, status,
+              "addToReapQue: fopen %s failed", tmpPath);
+            free (queFile);
+            return status;
+        }
+        queFile->next = reapQue->queHead;
+        reapQue->queHead = queFile;
+    }
+
+    if (fprintf (queFile->fp, "%s\n", filePath) < 0) {
+        status = UNIX_FILE_WRITE_ERR - errno;
+        rodsLogError (LOG_ERROR, status,
+          "addToReapQue: write to %s failed", queFile->quePath);
+        return status;
+    }
+    queFile->fileCnt++;
+    reapQue->fileCnt++;
+
+    return 0;
+}
+
+/* publishReapQue - close the queue files and rename them to their final
+ * name. If queDelay is not NULL, queue the reaper of each resource to
+ * run after queDelay */
+
+static int
+publishReapQue (rsComm_t *rsComm, reapQue_t *reapQue, char *queDelay)
+{
+    reapQueFile_t *queFile, *nextFile;
+    char tmpPath[MAX_NAME_LEN + sizeof (REAP_TMP_TRAILER)];
+    int status;
+    int savedStatus = 0;
+
+    queFile = reapQue->queHead;
+    while (queFile != NULL) {
+        nextFile = queFile->next;
+        snprintf (tmpPath, sizeof (tmpPath), "%-s%-s", queFile->quePath,
+          REAP_TMP_TRAILER);
+        if (fclose (queFile->fp) != 0) {
+            status = UNIX_FILE_WRITE_ERR - errno;
+            rodsLogError (LOG_ERROR, status,
+              "publishReapQue: close of %s failed", tmpPath);
+            savedStatus = status;
+        } else if (rename (tmpPath, queFile->quePath) < 0) {
+            status = UNIX_FILE_RENAME_ERR - errno;
+            rodsLogError (LOG_ERROR, status,
+              "publishReapQue: rename of %s failed", tmpPath);
+            savedStatus = status;
+        } else if (queDelay != NULL) {
+            status = queReapVault (rsComm, queFile->rescName, queDelay);
+            if (status < 0) savedStatus = status;
+        }
+        free (queFile);
+        queFile = nextFile;
+    }
+    reapQue->queHead = NULL;
+    reapQue->fileCnt = 0;
+
+    return savedStatus;
+}
+
+/* commitReapQue - hand the queued files to the reaper. Called after the
+ * catalog delete has been committed */
+
+int
+commitReapQue (rsComm_t *rsComm, reapQue_t *reapQue)
+{
+    return publishReapQue (rsComm, reapQue, REAP_QUE_DELAY);
+}
+
+/* abortReapQue - drop the queued files. Called when the catalog delete
+ * failed */
+
+void
+abortReapQue (reapQue_t *reapQue)
+{
+    reapQueFile_t *queFile, *nextFile;
+    char tmpPath[MAX_NAME_LEN + sizeof (REAP_TMP_TRAILER)];
+
+    queFile = reapQue->queHead;
+    while (queFile != NULL) {
+        nextFile = queFile->next;
+        snprintf (tmpPath, sizeof (tmpPath), "%-s%-s", queFile->quePath,
+          REAP_TMP_TRAILER);
+        fclose (queFile->fp);
+        unlink (tmpPath);
+        free (queFile);
+        queFile = nextFile;
+    }
+    reapQue->queHead = NULL;
+    reapQue->fileCnt = 0;
+}
+
+/* queReapVault - queue a msiReapVault rule for rescName to the
+ * irodsReServer to run after queDelay */
+
+int
+queReapVault (rsComm_t *rsComm, char *rescName, char *queDelay)
+{
+    int status;
+    ruleExecInfo_t rei;
+    char actionCall[MAX_ACTION_SIZE];
+
+    snprintf (actionCall, MAX_ACTION_SIZE,
+      "msiReapVault(\"%s\",\"%d\",*Status);", rescName, getReapNumThreads ());
+
+    initReiWithDataObjInp (&rei, rsComm, NULL);
+    status = _delayExec (actionCall, "", queDelay, &rei);
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "queReapVault: _delayExec of %s failed", actionCall);
+    }
+    return status;
+}
+
+/* getReapLine - the next path of the work file. Returns 0 at the end */
+
+static int
+getReapLine (reapWork_t *reapWork, char *filePath)
+{
+    int len;
+
+    if (fgets (filePath, MAX_NAME_LEN, reapWork->fp) == NULL) return 0;
+    len = strlen (filePath);
+    if (len > 0 && filePath[len - 1] == '\n') filePath[len - 1] = '\0';
+    return 1;
+}
+
+/* chkReapPath - whether filePath can still be unlinked. Returns 1 if no
+ * replica of the resource is registered at filePath, 0 if one is and
+ * a negative value if the catalog could not be asked. The catalog is
+ * asked by one thread at a time */
+
+static int
+chkReapPath (reapWork_t *reapWork, char *filePath)
+{
+    int status;
+
+    status = chkOrphanFile (reapWork->rsComm, filePath,
+      reapWork->rescInfo->rescName, NULL);
+    if (status == 0) {
+        rodsLog (LOG_NOTICE,
+          "chkReapPath: %s is registered again, not unlinked", filePath);
+    } else if (status < 0) {
+        rodsLogError (LOG_NOTICE, status,
+          "chkReapPath: catalog check of %s failed, queued again", filePath);
+    }
+    return status;
+}
+
+/* reapOneFile - unlink filePath. A file already gone is not an error */
+
+static int
+reapOneFile (reapWork_t *reapWork, char *filePath, int localFlag)
+{
+    rescInfo_t *rescInfo = reapWork->rescInfo;
+    fileDriverType_t fileType =
+      (fileDriverType_t) RescTypeDef[rescInfo->rescTypeInx].driverType;
+    fileUnlinkInp_t fileUnlinkInp;
+    int status;
+
+    if (localFlag > 0) {
+        status = fileUnlink (fileType, reapWork->rsComm, filePath);
+    } else {
+        memset (&fileUnlinkInp, 0, sizeof (fileUnlinkInp));
+        fileUnlinkInp.fileType = fileType;
+        rstrcpy (fileUnlinkInp.fileName, filePath, MAX_NAME_LEN);
+        rstrcpy (fileUnlinkInp.addr.hostAddr, rescInfo->rescLoc, NAME_LEN);
+        status = rsFileUnlink (reapWork->rsComm, &fileUnlinkInp);
+    }
+    if (status < 0 && getErrno (status) == ENOENT) status = 0;
+    if (status < 0) {
+        rodsLogError (LOG_NOTICE, status,
+          "reapOneFile: unlink of %s failed, queued again", filePath);
+    }
+    return status;
+}
+
+#ifdef PARA_OPR
+static void *
+reapWorker (void *arg)
+{
+    reapWork_t *reapWork = (reapWork_t *) arg;
+    char filePath[MAX_NAME_LEN];
+    int more, status;
+
+    while (1) {
+        pthread_mutex_lock (&reapWork->lock);
+        more = getReapLine (reapWork, filePath);
+        if (more > 0 && (status = chkReapPath (reapWork, filePath)) <= 0) {
+            if (status < 0) addToReapQue (reapWork->failedQue,
+              reapWork->rescInfo->rescName, filePath);
+            pthread_mutex_unlock (&reapWork->lock);
+            continue;
+        }
+        pthread_mutex_unlock (&reapWork->lock);
+        if (more == 0) break;
+
+        if (reapOneFile (reapWork, filePath, 1) < 0) {
+            pthread_mutex_lock (&reapWork->lock);
+            addToReapQue (reapWork->failedQue, reapWork->rescInfo->rescName,
+              filePath);
+            pthread_mutex_unlock (&reapWork->lock);
+        } else {
+            pthread_mutex_lock (&reapWork->lock);
+            reapWork->reapedCnt++;
+            pthread_mutex_unlock (&reapWork->lock);
+        }
+    }
+    return NULL;
+}
+#endif
+
+/* reapWorkFile - unlink the paths in workPath. The threads are only used
+ * for a local vault. Remote unlinks share the one server connection */
+
+static int
+reapWorkFile (rsComm_t *rsComm, rescInfo_t *rescInfo, char *workPath,
+int numThreads, reapQue_t *failedQue)
+{
+    reapWork_t reapWork;
+    rodsServerHost_t *rodsServerHost = NULL;
+    char filePath[MAX_NAME_LEN];
+    int localFlag = 0;
+    int status;
+    int i;
+
+    memset (&reapWork, 0, sizeof (reapWork));
+    reapWork.rsComm = rsComm;
+    reapWork.rescInfo = rescInfo;
+    reapWork.failedQue = failedQue;
+    if ((reapWork.fp = fopen (workPath, "r")) == NULL) {
+        status = FILE_OPEN_ERR - errno;
+        rodsLogError (LOG_ERROR, status,
+          "reapWorkFile: fopen %s failed", workPath);
+        return status;
+    }
+
+    status = resolveHostByRescInfo (rescInfo, &rodsServerHost);
+    if (status >= 0 && rodsServerHost->localFlag == LOCAL_HOST)
+        localFlag = 1;
+
+#ifdef PARA_OPR
+    if (localFlag > 0 && numThreads > 1) {
+        pthread_t tid[MAX_REAP_NUM_THREADS];
+        int numStarted = 0;
+
+        pthread_mutex_init (&reapWork.lock, NULL);
+        for (i = 0; i < numThreads - 1; i++) {
+            if (pthread_create (&tid[numStarted], NULL, reapWorker,
+              (void *) &reapWork) == 0) numStarted++;
+        }
+        /* this thread helps out. It also covers a failed pthread_create */
+        reapWorker ((void *) &reapWork);
+        for (i = 0; i < numStarted; i++) {
+            pthread_join (tid[i], NULL);
+        }
+        pthread_mutex_destroy (&reapWork.lock);
+        fclose (reapWork.fp);
+        return reapWork.reapedCnt;
+    }
+#endif
+    while (getReapLine (&reapWork, filePath) > 0) {
+        if ((status = chkReapPath (&reapWork, filePath)) <= 0) {
+            if (status < 0) addToReapQue (failedQue, rescInfo->rescName,
+              filePath);
+            continue;
+        }
+        if (reapOneFile (&reapWork, filePath, localFlag) < 0) {
+            addToReapQue (failedQue, rescInfo->rescName, filePath);
+        } else {
+            reapWork.reapedCnt++;
+        }
+    }
+    fclose (reapWork.fp);
+    return reapWork.reapedCnt;
+}
+
+/* claimReapFile - rename the queue file name in reapDir to a work file of
+ * this process. A work file is only taken over if its reaper is gone.
+ * Returns 0 if claimed */
+
+static int
+claimReapFile (char *reapDir, char *name, char *outWorkPath)
+{
+    char quePath[MAX_NAME_LEN];
+    char *workPtr;
+    int len;
+    int pid;
+
+    len = strlen (name);
+    if (len >= (int) strlen (REAP_TMP_TRAILER) && strcmp (name + len -
+      strlen (REAP_TMP_TRAILER), REAP_TMP_TRAILER) == 0) {
+        /* still being written or was never committed */
+        return -1;
+    }
+    snprintf (quePath, MAX_NAME_LEN, "%-s/%-s", reapDir, name);
+    if ((workPtr = strstr (name, REAP_WORK_TRAILER)) != NULL) {
+        pid = atoi (workPtr + strlen (REAP_WORK_TRAILER) + 1);
+        if (pid <= 0 || kill (pid, 0) == 0 || errno != ESRCH) return -1;
+        len = workPtr - name;
+    }
+    snprintf (outWorkPath, MAX_NAME_LEN, "%-s/%-.*s%-s.%d", reapDir, len,
+      name, REAP_WORK_TRAILER, getpid ());
+    if (rename (quePath, outWorkPath) < 0) {
+        /* another reaper got it */
+        return -1;
+    }
+    return 0;
+}
+
+/* reapVault - unlink the queued files of rescName. The number of files
+ * unlinked is returned in outCnt */
+
+int
+reapVault (rsComm_t *rsComm, char *rescName, int numThreads, int *outCnt)
+{
+    rescInfo_t *rescInfo = NULL;
+    reapQue_t failedQue;
+    char reapDir[MAX_NAME_LEN];
+    char workPath[MAX_NAME_LEN];
+    DIR *dirPtr;
+    struct dirent *myDirent;
+    int status;
+    int savedStatus = 0;
+
+    if (outCnt != NULL) *outCnt = 0;
+
+    status = resolveResc (rescName, &rescInfo);
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "reapVault: resolveResc error for %s", rescName);
+        return status;
+    }
+    if (rescInfo->rescStatus == INT_RESC_STATUS_DOWN) return SYS_RESC_IS_DOWN;
+
+    getReapDir (rescName, reapDir, 0);
+    if ((dirPtr = opendir (reapDir)) == NULL) {
+        /* nothing was ever queued */
+        return 0;
+    }
+
+    memset (&failedQue, 0, sizeof (failedQue));
+    while ((myDirent = readdir (dirPtr)) != NULL) {
+        if (strcmp (myDirent->d_name, ".") == 0 ||
+          strcmp (myDirent->d_name, "..") == 0) continue;
+        if (claimReapFile (reapDir, myDirent->d_name, workPath) < 0)
+            continue;
+        status = reapWorkFile (rsComm, rescInfo, workPath, numThreads,
+          &failedQue);
+        if (status < 0) {
+            savedStatus = status;
+            continue;
+        }
+        if (outCnt != NULL) *outCnt += status;
+        unlink (workPath);
+    }
+    closedir (dirPtr);
+
+    if (failedQue.fileCnt > 0) {
+        rodsLog (LOG_NOTICE,
+          "reapVault: %d files of %s could not be unlinked, retried in %s",
+          failedQue.fileCnt, rescName, REAP_RETRY_DELAY);
+    }
+    status = publishReapQue (rsComm, &failedQue, REAP_RETRY_DELAY);
+    if (status < 0) savedStatus = status;
+
+    return savedStatus;
+}
@@ -74,6 +74,15 @@ directAccessFileRead (rsComm_t *rsComm, int fd, void *buf, int len);
 int
 directAccessFileWrite (rsComm_t *rsComm, int fd, void *buf, int len);
 int
+directAccessFilePread (rsComm_t *rsComm, int fd, void *buf, int len,
+rodsLong_t offset);
+int
+directAccessFilePwrite (rsComm_t *rsComm, int fd, void *buf, int len,
+rodsLong_t offset);
+int
+directAccessFilePreadv (rsComm_t *rsComm, int fd, struct iovec *iov,
+int iovcnt, rodsLong_t offset);
+int
 directAccessFileClose (rsComm_t *rsComm, int fd);
 int
 directAccessFileUnlink (rsComm_t *rsComm, char *filename);
@@ -11,6 +11,7 @@
 
 #ifndef windows_platform
 #include <dirent.h>
+#include <sys/uio.h>
 #endif
 
 #include "rods.h"
@@ -42,6 +43,13 @@ typedef struct {
     int         	(*fileTruncate)( rsComm_t*, char*, rodsLong_t ); /* JMC */
     int			(*fileStageToCache)( rsComm_t*, fileDriverType_t, int, int, char*, char*, rodsLong_t, keyValPair_t* ); /* JMC */
     int			(*fileSyncToArch)( rsComm_t*, fileDriverType_t, int, int, char*, char*, rodsLong_t, keyValPair_t*); /* JMC */
+    /* Optional positional I/O. They neither use nor move the file offset
+     * of fd, so several threads can share one fd. A NULL entry means
+     * filePread/filePwrite/filePreadv fall back to fileLseek + fileRead
+     * or fileWrite. */
+    int			(*filePread)( rsComm_t*, int, void*, int, rodsLong_t );
+    int			(*filePwrite)( rsComm_t*, int, void*, int, rodsLong_t );
+    int			(*filePreadv)( rsComm_t*, int, struct iovec*, int, rodsLong_t );
 } fileDriver_t;
 
 
@@ -111,4 +119,15 @@ fileSyncToArch (fileDriverType_t myType, rsComm_t *rsComm,
 fileDriverType_t cacheFileType, int mode, int flag,
 char *filename, char *cacheFilename, rodsLong_t dataSize,
 keyValPair_t *condInput);
+int
+filePread (fileDriverType_t myType, rsComm_t *rsComm, int fd, void *buf,
+int len, rodsLong_t offset);
+int
+filePwrite (fileDriverType_t myType, rsComm_t *rsComm, int fd, void *buf,
+int len, rodsLong_t offset);
+int
+filePreadv (fileDriverType_t myType, rsComm_t *rsComm, int fd,
+struct iovec *iov, int iovcnt, rodsLong_t offset);
+int
+fileHasPio (fileDriverType_t myType);
 #endif	/* FILE_DRIVER_H */
@@ -155,7 +155,7 @@ fileDriver_t FileDriverTable[] = {
       unixFileFsync, unixFileMkdir, unixFileChmod, unixFileRmdir, unixFileOpendir,
       unixFileClosedir, unixFileReaddir, unixFileStage, unixFileRename,
       unixFileGetFsFreeSpace, unixFileTruncate, unixStageToCache, 
-      unixSyncToArch},
+      unixSyncToArch, unixFilePread, unixFilePwrite, unixFilePreadv},
     #ifdef HPSS
         {HPSS_FILE_TYPE, noSupportFsFileCreate, noSupportFsFileOpen, noSupportFsFileRead, 
          noSupportFsFileWrite, noSupportFsFileClose, hpssFileUnlink, hpssFileStat, 
@@ -230,7 +230,8 @@ fileDriver_t FileDriverTable[] = {
      directAccessFileClosedir, directAccessFileReaddir, directAccessFileStage, 
      directAccessFileRename, directAccessFileGetFsFreeSpace, 
      directAccessFileTruncate, noSupportFsFileStageToCache, 
-     noSupportFsFileSyncToArch},
+     noSupportFsFileSyncToArch, directAccessFilePread, 
+     directAccessFilePwrite, directAccessFilePreadv},
 #else
     {DIRECT_ACCESS_FILE_TYPE, NO_FILE_DRIVER_FUNCTIONS},
 #endif
@@ -269,7 +270,7 @@ fileDriver_t FileDriverTable[] = {
       hdfsFileFsync, hdfsFileMkdir, hdfsFileChmod, hdfsFileRmdir, hdfsFileOpendir,
       hdfsFileClosedir, hdfsFileReaddir, hdfsFileStage, hdfsFileRename,
       hdfsFileGetFsFreeSpace, hdfsFileTruncate, hdfsStageToCache, 
-      hdfsSyncToArch},
+      hdfsSyncToArch, hdfsFilePread, NULL, NULL},
 #else
     {HDFS_FILE_TYPE, NO_FILE_DRIVER_FUNCTIONS},
 #endif
@@ -64,6 +64,9 @@ hdfsFileOpen (rsComm_t *rsComm, char *fileName, int flags, int mode, keyValPair_
 int
 hdfsFileRead (rsComm_t *rsComm, int fd, void *buf, int len);
 int
+hdfsFilePread (rsComm_t *rsComm, int fd, void *buf, int len,
+rodsLong_t offset);
+int
 hdfsFileWrite (rsComm_t *rsComm, int fd, void *buf, int len);
 int
 hdfsFileClose (rsComm_t *rsComm, int fd);
@@ -47,6 +47,7 @@
 #include <sys/mount.h>
 #endif
 #include <sys/stat.h>
+#include <pthread.h>
 
 #include "rods.h"
 #include "rcConnect.h"
@@ -55,6 +56,26 @@
 
 #define S3_AUTH_FILE "s3Auth"
 
+/* env variables for the S3 driver in addition to S3_ACCESS_KEY_ID and
+ * S3_SECRET_ACCESS_KEY */
+#define S3_DEFAULT_HOSTNAME	"S3_DEFAULT_HOSTNAME"  /* e.g. minio host:port */
+#define S3_PROTOCOL		"S3_PROTOCOL"	   /* http or https (default) */
+#define S3_MPU_CHUNK		"S3_MPU_CHUNK"	   /* part size in MB */
+#define S3_MPU_THREADS		"S3_MPU_THREADS"   /* parts in flight */
+
+#define S3_DEF_MPU_CHUNK	(64 * 1024 * 1024)
+#define S3_MIN_MPU_CHUNK	(5 * 1024 * 1024)  /* S3 min part size */
+#define S3_DEF_MPU_THREADS	10
+#define S3_MAX_MPU_THREADS	32
+#define S3_MAX_MPU_PARTS	10000		   /* S3 max parts */
+#define S3_PART_RETRY_CNT	3
+#define S3_ETAG_LEN		256
+#ifdef S3_MULTIPART
+/* S3_MULTIPART needs libs3 2.0 or later, whose request calls all take a
+ * timeout in ms. 0 - no timeout */
+#define S3_REQ_TIMEOUT_MS	0
+#endif
+
 typedef struct S3Auth {
   char accessKeyId[MAX_NAME_LEN];
   char secretAccessKey[MAX_NAME_LEN];
@@ -79,6 +100,41 @@ typedef struct callback_data
     int status;
 } callback_data_t;
 
+typedef struct s3PartInfo
+{
+    int partNum;		/* 1 based */
+    rodsLong_t offset;
+    rodsLong_t length;
+    char eTag[S3_ETAG_LEN];
+} s3PartInfo_t;
+
+/* s3MpuManager_t - the shared state of a parallel ranged get, multipart
+ * upload or multipart copy. Worker threads pick up parts by nextPart */
+typedef struct s3MpuManager
+{
+    char bucket[MAX_NAME_LEN];
+    char key[MAX_NAME_LEN];
+    char srcBucket[MAX_NAME_LEN];	/* copy only */
+    char srcKey[MAX_NAME_LEN];		/* copy only */
+    char uploadId[MAX_NAME_LEN];
+    int fd;			/* local file. accessed with pread/pwrite */
+    int numParts;
+    int nextPart;
+    int status;
+    s3PartInfo_t *parts;
+    pthread_mutex_t lock;
+} s3MpuManager_t;
+
+typedef struct s3PartCallbackData
+{
+    callback_data_t data;	/* must be first for the common callbacks */
+    s3MpuManager_t *manager;
+    s3PartInfo_t *part;
+    rodsLong_t offset;		/* current offset in the local file */
+    char *xmlBuf;		/* CompleteMultipartUpload request body */
+    int xmlLen;
+} s3PartCallbackData_t;
+
 int
 s3FileUnlink (rsComm_t *rsComm, char *filename);
 int
@@ -134,4 +190,40 @@ S3Status
 getObjectDataCallback(int bufferSize, const char *buffer, void *callbackData);
 int
 copyS3Obj (char *srcObj, char *destObj);
+void
+initS3BucketContext (S3BucketContext *bucketContext, const char *bucket);
+int
+initS3MpuManager (s3MpuManager_t *manager, char *bucket, char *key,
+rodsLong_t size);
+void
+clearS3MpuManager (s3MpuManager_t *manager);
+S3Status
+getObjectRangeCallback (int bufferSize, const char *buffer,
+void *callbackData);
+int
+getFileFromS3Parallel (char *fileName, char *bucket, char *key,
+rodsLong_t fileSize);
+#ifdef S3_MULTIPART
+S3Status
+s3PartPropertiesCallback (const S3ResponseProperties *properties,
+void *callbackData);
+int
+putObjectRangeCallback (int bufferSize, char *buffer, void *callbackData);
+S3Status
+mpuInitialCallback (const char *uploadId, void *callbackData);
+int
+mpuCommitDataCallback (int bufferSize, char *buffer, void *callbackData);
+S3Status
+mpuCommitRespCallback (const char *location, const char *eTag,
+void *callbackData);
+void
+mpuAbortCompleteCallback (S3Status status, const S3ErrorDetails *error,
+void *callbackData);
+int
+putFileIntoS3Mpu (char *fileName, char *bucket, char *key,
+rodsLong_t fileSize);
+int
+copyS3ObjMpu (char *srcBucket, char *srcKey, char *destBucket,
+char *destKey, rodsLong_t size);
+#endif
 #endif	/* S3_FILE_DRIVER_H */
@@ -49,6 +49,15 @@ typedef struct structFileDesc {
 
 #define NUM_STRUCT_FILE_DESC 16
 
+/* checksum of a sub file computed while bundling */
+typedef struct StructFileChksum {
+    char filePath[MAX_NAME_LEN];	/* local path of the sub file */
+    char chksumStr[CHKSUM_LEN];
+    struct StructFileChksum *next;
+} structFileChksum_t;
+
+#define STRUCT_FILE_CHKSUM_TABLE_SZ	1024	/* must be a power of 2 */
+
 int
 subStructFileIndexLookup (structFileType_t myType);
 int
@@ -97,5 +106,11 @@ int
 allocStructFileDesc ();
 int
 freeStructFileDesc (int structFileInx);
+int
+addStructFileMemberChksum (char *filePath, char *chksumStr);
+int
+getStructFileMemberChksum (char *filePath, char *outChksumStr);
+int
+clearStructFileMemberChksum ();
 
 #endif	/* STRUCT_FILE_DRIVER_H */
@@ -0,0 +1,132 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* tarStream.h - header file for tarStream.c, the streaming engine of the
+ * tar structFile driver. It reads sub files directly out of the tar file
+ * through a member index and writes bundles in a single pass without
+ * going through the tar executable.
+ */
+
+#ifndef TAR_STREAM_H
+#define TAR_STREAM_H
+
+#include "rods.h"
+#include "objInfo.h"
+#include "structFileDriver.h"
+#include "tarSubStructFileDriver.h"
+
+#define TAR_BLOCK_SIZE		512
+#define TAR_NAME_LEN		100	/* size of the name field in the header */
+#define TAR_STREAM_BUF_SIZE	(1024 * 1024)	/* bundle write buffer */
+#define TAR_MAX_EXT_HDR_SIZE	(64 * 1024)	/* max pax extended header */
+#define TAR_GNU_LONGNAME	"././@LongLink"
+#define TAR_GNU_MAGIC		"ustar  "	/* magic and version of GNU tar */
+#define TAR_USTAR_MAGIC		"ustar"
+
+/* the typeflag of the tar header */
+#define TAR_REG_TYPE		'0'
+#define TAR_AREG_TYPE		'\0'	/* old style regular file */
+#define TAR_LNK_TYPE		'1'
+#define TAR_SYM_TYPE		'2'
+#define TAR_DIR_TYPE		'5'
+#define TAR_CONT_TYPE		'7'
+#define TAR_GNU_LONGNAME_TYPE	'L'
+#define TAR_GNU_LONGLINK_TYPE	'K'
+#define TAR_PAX_HDR_TYPE	'x'
+#define TAR_PAX_GLOBAL_TYPE	'g'
+
+/* definition for flags of tarIndex_t */
+#define TAR_INDEX_UNSAFE	0x1	/* has links or ".." paths. Must be
+					 * staged so that it gets checked */
+
+typedef struct tarHeader {
+    char name[TAR_NAME_LEN];
+    char mode[8];
+    char uid[8];
+    char gid[8];
+    char size[12];
+    char mtime[12];
+    char chksum[8];
+    char typeflag;
+    char linkname[TAR_NAME_LEN];
+    char magic[6];
+    char version[2];
+    char uname[32];
+    char gname[32];
+    char devmajor[8];
+    char devminor[8];
+    char prefix[155];
+    char pad[12];
+} tarHeader_t;
+
+typedef struct tarMember {
+    char *name;			/* path in the tar file without "./" */
+    rodsLong_t dataOffset;	/* offset of the content in the tar file */
+    rodsLong_t size;
+    unsigned int mode;
+    unsigned int mtime;
+    int objType;		/* DATA_OBJ_T or COLL_OBJ_T */
+} tarMember_t;
+
+typedef struct tarIndex {
+    char phyPath[MAX_NAME_LEN];	/* the indexed tar file */
+    rodsLong_t tarSize;		/* size and mtime of the tar file when it */
+    unsigned int tarMtime;	/* was indexed. A change invalidates it */
+    rodsLong_t endOffset;	/* offset of the end of archive blocks */
+    int flags;
+    int numMembers;
+    int allocCnt;
+    tarMember_t *members;	/* sorted by name */
+} tarIndex_t;
+
+typedef struct tarWriter {
+    rsComm_t *rsComm;
+    int l3descInx;		/* the opened tar file */
+    char *buf;
+    int bufLen;			/* bytes in buf not written yet */
+    rodsLong_t offset;		/* offset in the tar file */
+} tarWriter_t;
+
+#define TAR_INDEX_ALLOC_CNT	256
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+int
+isTarStreamDataType (char *dataType);
+int
+getTarIndex (int structFileInx, tarIndex_t **outTarIndex);
+int
+freeTarIndex (int structFileInx);
+tarMember_t *
+matchTarMember (tarIndex_t *tarIndex, char *name);
+int
+getTarMemberName (specColl_t *specColl, char *subFilePath, char *outName);
+int
+chkTarStreamRead (rsComm_t *rsComm, specColl_t *specColl,
+int *outStructFileInx);
+int
+tarStreamSubFileOpen (rsComm_t *rsComm, int structFileInx,
+subFile_t *subFile);
+int
+tarStreamSubFileRead (rsComm_t *rsComm, int subInx, void *buf, int len);
+rodsLong_t
+tarStreamSubFileLseek (rsComm_t *rsComm, int subInx, rodsLong_t offset,
+int whence);
+int
+tarStreamSubFileFstat (rsComm_t *rsComm, int subInx,
+rodsStat_t **subStructFileStatOut);
+int
+tarStreamSubFileClose (rsComm_t *rsComm, int subInx);
+int
+tarStreamSubFileStat (rsComm_t *rsComm, int structFileInx,
+subFile_t *subFile, rodsStat_t **subStructFileStatOut);
+int
+bundleCacheDirWithStream (int structFileInx, int oprType);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif	/* TAR_STREAM_H */
@@ -15,9 +15,16 @@
 typedef struct tarSubFileDesc {
     int inuseFlag;
     int structFileInx;
-    int fd;                         /* the fd of the opened cached subFile */
+    int fd;                         /* the fd of the opened cached subFile
+                                     * or of the tar file if streamFlag */
     char cacheFilePath[MAX_NAME_LEN];   /* the phy path name of the cached
                                          * subFile */
+    int streamFlag;                 /* read directly from the tar file */
+    rodsLong_t dataOffset;          /* offset of the content in the tar */
+    rodsLong_t dataSize;
+    rodsLong_t curOffset;           /* current offset in the sub file */
+    unsigned int mode;
+    unsigned int mtime;
 } tarSubFileDesc_t;
 
 #define NUM_TAR_SUB_FILE_DESC 20
@@ -59,6 +66,8 @@ tarSubStructFileTruncate (rsComm_t *rsComm, subFile_t *subFile);
 int
 rsTarStructFileOpen (rsComm_t *rsComm, specColl_t *specColl);
 int
+openTarStructFileDesc (rsComm_t *rsComm, specColl_t *specColl);
+int
 stageTarStructFile (int structFileInx);
 int
 mkTarCacheDir (int structFileInx);
@@ -0,0 +1,92 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* unixFileAio.h - header file for unixFileAio.c, the asynchronous
+ * (io_uring) reads and writes of the unix file driver used by the
+ * parallel transfer threads.
+ */
+
+#ifndef UNIX_FILE_AIO_H
+#define UNIX_FILE_AIO_H
+
+#include "rods.h"
+
+/* number of reads/writes a transfer thread keeps in flight (default
+ * DEF_UNIX_AIO_DEPTH). 0 - disable */
+#define UNIX_AIO_DEPTH_ENV	"unixAioDepth"
+#define DEF_UNIX_AIO_DEPTH	4
+#define MAX_UNIX_AIO_DEPTH	16
+/* a transfer stream of at least this many bytes is written with O_DIRECT
+ * (default 0 - never) */
+#define UNIX_AIO_DIRECT_ENV	"unixAioDirectSize"
+/* alignment of the buffers, offsets and lengths for O_DIRECT */
+#define UNIX_AIO_ALIGN		4096
+#define MIN_UNIX_AIO_BUF_SZ	(256*1024)
+
+#define UNIX_AIO_READ		1
+#define UNIX_AIO_WRITE		2
+
+typedef struct UnixAio {
+    int ringFd;
+    int depth;
+    int bufSize;		/* power of 2. Divides TRANS_SZ */
+    int cur;			/* the next slot of the write behind or
+				 * read ahead loop */
+    int aheadFd;		/* read ahead of aheadFd from aheadOffset
+				 * to aheadEnd */
+    rodsLong_t aheadOffset;
+    rodsLong_t aheadEnd;
+    char *buf[MAX_UNIX_AIO_DEPTH];
+    int opr[MAX_UNIX_AIO_DEPTH];	/* op in flight or 0 */
+    int len[MAX_UNIX_AIO_DEPTH];
+    int result[MAX_UNIX_AIO_DEPTH];
+    void *iov;			/* struct iovec [depth] */
+    /* the mmapped io_uring */
+    void *sqPtr;
+    void *cqPtr;
+    void *sqes;
+    size_t sqSz;
+    size_t cqSz;
+    size_t sqesSz;
+    unsigned *sqTail;
+    unsigned *sqMask;
+    unsigned *sqArray;
+    unsigned *cqHead;
+    unsigned *cqTail;
+    unsigned *cqMask;
+    void *cqes;
+} unixAio_t;
+
+int
+getUnixAioDepth ();
+rodsLong_t
+getUnixAioDirectSize ();
+int
+unixAioInit (unixAio_t *aio);
+int
+unixAioRead (unixAio_t *aio, int slot, int fd, int len, rodsLong_t offset);
+int
+unixAioWrite (unixAio_t *aio, int slot, int fd, int len, rodsLong_t offset);
+int
+unixAioWait (unixAio_t *aio, int slot);
+int
+unixAioWaitAll (unixAio_t *aio);
+char *
+unixAioNextBuf (unixAio_t *aio, int *status);
+int
+unixAioWriteNext (unixAio_t *aio, int fd, int len, rodsLong_t offset);
+int
+unixAioReadAhead (unixAio_t *aio, int fd, rodsLong_t offset, rodsLong_t size,
+int alignFlag);
+char *
+unixAioReadNext (unixAio_t *aio, int *slot, int *bytesRead);
+int
+unixAioRefill (unixAio_t *aio, int slot);
+int
+unixAioEnd (unixAio_t *aio);
+int
+unixAioOpenDirect (char *fileName, int flags);
+int
+unixAioFd (int fd, int directFd, int len, rodsLong_t offset);
+
+#endif	/* UNIX_FILE_AIO_H */
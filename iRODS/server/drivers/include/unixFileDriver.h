@@ -32,6 +32,9 @@
 #include <unistd.h>  
 #endif
 #include <dirent.h>
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
    
 #if defined(solaris_platform)
 #include <sys/statvfs.h>
@@ -111,6 +114,15 @@ keyValPair_t *condInput);
 int
 unixFileCopy (int mode, char *srcFileName, char *destFileName);
 int
+unixFilePread (rsComm_t *rsComm, int fd, void *buf, int len, 
+rodsLong_t offset);
+int
+unixFilePwrite (rsComm_t *rsComm, int fd, void *buf, int len, 
+rodsLong_t offset);
+int
+unixFilePreadv (rsComm_t *rsComm, int fd, struct iovec *iov, int iovcnt, 
+rodsLong_t offset);
+int
 nbFileRead (rsComm_t *rsComm, int fd, void *buf, int len);
 int
 nbFileWrite (rsComm_t *rsComm, int fd, void *buf, int len);
@@ -773,6 +773,27 @@ directAccessFileWrite (rsComm_t *rsComm, int fd, void *buf, int len)
     return unixFileWrite(rsComm, fd, buf, len);
 }
 
+int
+directAccessFilePread (rsComm_t *rsComm, int fd, void *buf, int len,
+rodsLong_t offset)
+{
+    return unixFilePread(rsComm, fd, buf, len, offset);
+}
+
+int
+directAccessFilePwrite (rsComm_t *rsComm, int fd, void *buf, int len,
+rodsLong_t offset)
+{
+    return unixFilePwrite(rsComm, fd, buf, len, offset);
+}
+
+int
+directAccessFilePreadv (rsComm_t *rsComm, int fd, struct iovec *iov,
+int iovcnt, rodsLong_t offset)
+{
+    return unixFilePreadv(rsComm, fd, iov, iovcnt, offset);
+}
+
 int
 directAccessFileFstat (rsComm_t *rsComm, int fd, struct stat *statbuf)
 {
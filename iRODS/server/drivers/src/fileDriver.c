@@ -362,3 +362,130 @@ keyValPair_t *condInput)
     return (status);
 }
 
+
+/* filePread, filePwrite and filePreadv - read/write at an explicit offset.
+ * Drivers without a positional entry fall back to fileLseek plus
+ * fileRead/fileWrite, which moves the file offset of fd. Use fileHasPio
+ * before sharing one fd between threads.
+ */
+
+int
+filePread (fileDriverType_t myType, rsComm_t *rsComm, int fd, void *buf,
+int len, rodsLong_t offset)
+{
+    int fileInx;
+    rodsLong_t lStatus;
+    int status;
+
+    if ((fileInx = fileIndexLookup (myType)) < 0) {
+        return (fileInx);
+    }
+
+    if (FileDriverTable[fileInx].filePread != NULL) {
+        status = FileDriverTable[fileInx].filePread (rsComm, fd, buf, len,
+          offset);
+        return (status);
+    }
+
+    lStatus = FileDriverTable[fileInx].fileLseek (rsComm, fd, offset,
+      SEEK_SET);
+    if (lStatus < 0) {
+        return ((int) lStatus);
+    }
+    status = FileDriverTable[fileInx].fileRead (rsComm, fd, buf, len);
+    return (status);
+}
+
+int
+filePwrite (fileDriverType_t myType, rsComm_t *rsComm, int fd, void *buf,
+int len, rodsLong_t offset)
+{
+    int fileInx;
+    rodsLong_t lStatus;
+    int status;
+
+    if ((fileInx = fileIndexLookup (myType)) < 0) {
+        return (fileInx);
+    }
+
+    if (FileDriverTable[fileInx].filePwrite != NULL) {
+        status = FileDriverTable[fileInx].filePwrite (rsComm, fd, buf, len,
+          offset);
+        return (status);
+    }
+
+    lStatus = FileDriverTable[fileInx].fileLseek (rsComm, fd, offset,
+      SEEK_SET);
+    if (lStatus < 0) {
+        return ((int) lStatus);
+    }
+    status = FileDriverTable[fileInx].fileWrite (rsComm, fd, buf, len);
+    return (status);
+}
+
+int
+filePreadv (fileDriverType_t myType, rsComm_t *rsComm, int fd,
+struct iovec *iov, int iovcnt, rodsLong_t offset)
+{
+    int fileInx;
+    rodsLong_t lStatus;
+    int status;
+    int i;
+    int total = 0;
+
+    if ((fileInx = fileIndexLookup (myType)) < 0) {
+        return (fileInx);
+    }
+
+    if (FileDriverTable[fileInx].filePreadv != NULL) {
+        status = FileDriverTable[fileInx].filePreadv (rsComm, fd, iov,
+          iovcnt, offset);
+        return (status);
+    }
+
+    /* no vectored read. Do one read per segment and stop at a short one */
+    for (i = 0; i < iovcnt; i++) {
+        if (FileDriverTable[fileInx].filePread != NULL) {
+            status = FileDriverTable[fileInx].filePread (rsComm, fd,
+              iov[i].iov_base, iov[i].iov_len, offset + total);
+        } else {
+            if (i == 0) {
+                lStatus = FileDriverTable[fileInx].fileLseek (rsComm, fd,
+                  offset, SEEK_SET);
+                if (lStatus < 0) {
+                    return ((int) lStatus);
+                }
+            }
+            status = FileDriverTable[fileInx].fileRead (rsComm, fd,
+              iov[i].iov_base, iov[i].iov_len);
+        }
+        if (status < 0) {
+            if (total > 0) break;
+            return (status);
+        }
+        total += status;
+        if (status < (int) iov[i].iov_len) break;
+    }
+    return (total);
+}
+
+/* fileHasPio - return 1 if the driver of myType does its own positional
+ * read and write, i.e. one fd can be shared by several threads.
+ */
+
+int
+fileHasPio (fileDriverType_t myType)
+{
+    int fileInx;
+
+    if ((fileInx = fileIndexLookup (myType)) < 0) {
+        return (0);
+    }
+
+    if (FileDriverTable[fileInx].filePread != NULL &&
+      FileDriverTable[fileInx].filePwrite != NULL) {
+        return (1);
+    } else {
+        return (0);
+    }
+}
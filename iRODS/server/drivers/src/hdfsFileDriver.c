@@ -210,6 +210,28 @@ hdfsFileRead (rsComm_t *rsComm, int fd, void *buf, int len)
 
 }
 
+/* hdfsFilePread - positional read. HDFS files are append only, so there
+ * is no hdfsFilePwrite and filePreadv does one hdfsPread per segment. */
+int
+hdfsFilePread (rsComm_t *rsComm, int fd, void *buf, int len,
+rodsLong_t offset)
+{
+    rodsLog (LOG_DEBUG,"hdfsFilePread() fd = %d len = %d offset = %lld",
+      fd, len, offset);
+    hdfsFS fs = getFS();
+  int idx = fd - 1024;
+  hdfsFile readFile = hdfsFDpersistence[idx].hf;
+  tSize numReadBytes = hdfsPread(fs, readFile, (tOffset) offset,
+    (void *)buf, len);
+  if (numReadBytes < 0) {
+      int status = HDFS_FILE_READ_ERR - errno;
+      rodsLog (LOG_NOTICE, "hdfsFilePread: read error fd = %d, status = %d",
+       fd, status);
+      return (status);
+  }
+  return numReadBytes;
+}
+
 int
 hdfsnbFileRead (rsComm_t *rsComm, int fd, void *buf, int len)
 {
@@ -9,6 +9,9 @@
 #include "rsGlobalExtern.h"
 
 static int S3Initialized = 0;
+static S3Protocol MyS3Protocol = S3ProtocolHTTPS;
+static rodsLong_t S3MpuChunkSize = S3_DEF_MPU_CHUNK;
+static int S3MpuThreads = S3_DEF_MPU_THREADS;
 s3Auth_t S3Auth;
 
 
@@ -28,20 +31,18 @@ s3FileUnlink (rsComm_t *rsComm, char *s3ObjName)
 
     if ((status = myS3Init ()) != S3StatusOK) return (status);
 
-      /* {myBucket,  1, 0, S3Auth.accessKeyId, S3Auth.secretAccessKey}; */
-      /* XXXXX using S3UriStyleVirtualHost causes operation containing
-       * the sub-string "S3" to fail. use S3UriStylePath instead */
-      /* this initialization failed for 3-2.0 because of the hostName
-       * element
-      S3BucketContext bucketContext =
-      {myBucket,  S3ProtocolHTTPS, S3UriStylePath, S3Auth.accessKeyId,
-        S3Auth.secretAccessKey}; */
+    initS3BucketContext (&bucketContext, myBucket);
 
     S3ResponseHandler responseHandler = {
         0, &responseCompleteCallback
     };
 
+#ifdef S3_MULTIPART
+    S3_delete_object(&bucketContext, key, 0, S3_REQ_TIMEOUT_MS,
+      &responseHandler, &data);
+#else
     S3_delete_object(&bucketContext, key, 0, &responseHandler, &data);
+#endif
 
     if (data.status != S3StatusOK) {
         status = myS3Error (data.status, S3_FILE_UNLINK_ERR);
@@ -309,6 +310,13 @@ putFileIntoS3 (char *fileName, char *s3ObjName, rodsLong_t fileSize)
 
     if ((status = parseS3Path (s3ObjName, myBucket, key)) < 0) return status;
 
+#ifdef S3_MULTIPART
+    if ((status = myS3Init ()) != S3StatusOK) return (status);
+    if (fileSize > S3MpuChunkSize) {
+        return putFileIntoS3Mpu (fileName, myBucket, key, fileSize);
+    }
+#endif
+
     data.fd = fopen (fileName, "r");
     if (data.fd == NULL) {
         status = UNIX_FILE_OPEN_ERR - errno;
@@ -322,28 +330,20 @@ putFileIntoS3 (char *fileName, char *s3ObjName, rodsLong_t fileSize)
 
     if ((status = myS3Init ()) != S3StatusOK) return (status);
 
-      /* {myBucket,  1, 0, S3Auth.accessKeyId, S3Auth.secretAccessKey}; */
-      /* XXXXX using S3UriStyleVirtualHost causes operation containing
-       * the sub-string "S3" to fail. use S3UriStylePath instead */
-      /* this initialization failed for 3-2.0 because of the hostName
-       * element
-      S3BucketContext bucketContext =
-      {myBucket,  S3ProtocolHTTPS, S3UriStylePath, S3Auth.accessKeyId, 
-	S3Auth.secretAccessKey}; */
-    bzero (&bucketContext, sizeof (bucketContext));
-    bucketContext.bucketName = myBucket;
-    bucketContext.protocol = S3ProtocolHTTPS;
-    bucketContext.uriStyle = S3UriStylePath;
-    bucketContext.accessKeyId = S3Auth.accessKeyId;
-    bucketContext.secretAccessKey = S3Auth.secretAccessKey;
+    initS3BucketContext (&bucketContext, myBucket);
 
     S3PutObjectHandler putObjectHandler = {
       { &responsePropertiesCallback, &responseCompleteCallback },
       &putObjectDataCallback
     };
 
+#ifdef S3_MULTIPART
+    S3_put_object(&bucketContext, key, fileSize, NULL, 0, S3_REQ_TIMEOUT_MS,
+                &putObjectHandler, &data);
+#else
     S3_put_object(&bucketContext, key, fileSize, NULL, 0,
                 &putObjectHandler, &data);
+#endif
     if (data.status != S3StatusOK) {
         status = myS3Error (data.status, S3_PUT_ERROR);
     }
@@ -366,11 +366,29 @@ myS3Init (void)
 #ifdef libs3_3_1_4
     if ((status = S3_initialize ("s3", S3_INIT_ALL)) != S3StatusOK) {
 #else
-    if ((status = S3_initialize ("s3", S3_INIT_ALL, NULL)) != S3StatusOK) {
+    if ((status = S3_initialize ("s3", S3_INIT_ALL, 
+      getenv (S3_DEFAULT_HOSTNAME))) != S3StatusOK) {
 #endif
         status = myS3Error (status, S3_INIT_ERROR);
     }
 
+    /* http and a S3_DEFAULT_HOSTNAME of host:port allow the use of a
+     * local S3 compatible server such as minio */
+    if ((tmpPtr = getenv (S3_PROTOCOL)) != NULL && 
+      strcasecmp (tmpPtr, "http") == 0) {
+        MyS3Protocol = S3ProtocolHTTP;
+    }
+    if ((tmpPtr = getenv (S3_MPU_CHUNK)) != NULL && atoi (tmpPtr) > 0) {
+        S3MpuChunkSize = (rodsLong_t) atoi (tmpPtr) * 1024 * 1024;
+        if (S3MpuChunkSize < S3_MIN_MPU_CHUNK) 
+            S3MpuChunkSize = S3_MIN_MPU_CHUNK;
+    }
+    if ((tmpPtr = getenv (S3_MPU_THREADS)) != NULL && atoi (tmpPtr) > 0) {
+        S3MpuThreads = atoi (tmpPtr);
+        if (S3MpuThreads > S3_MAX_MPU_THREADS) 
+            S3MpuThreads = S3_MAX_MPU_THREADS;
+    }
+
     bzero (&S3Auth, sizeof (S3Auth));
 
     if ((tmpPtr = getenv("S3_ACCESS_KEY_ID")) != NULL) {
@@ -482,20 +500,7 @@ const char *delimiter, int maxkeys, int allDetails, s3Stat_t *s3Stat)
 
     if ((status = myS3Init ()) != S3StatusOK) return (status);
 
-      /* {myBucket,  1, 0, S3Auth.accessKeyId, S3Auth.secretAccessKey}; */
-      /* XXXXX using S3UriStyleVirtualHost causes operation containing
-       * the sub-string "S3" to fail. use S3UriStylePath instead */
-      /* this initialization failed for 3-2.0 because of the hostName
-       * element
-      S3BucketContext bucketContext =
-      {bucketName,  S3ProtocolHTTPS, S3UriStylePath, S3Auth.accessKeyId,
-        S3Auth.secretAccessKey}; */
-    bzero (&bucketContext, sizeof (bucketContext));
-    bucketContext.bucketName = bucketName;
-    bucketContext.protocol = S3ProtocolHTTPS;
-    bucketContext.uriStyle = S3UriStylePath;
-    bucketContext.accessKeyId = S3Auth.accessKeyId;
-    bucketContext.secretAccessKey = S3Auth.secretAccessKey;
+    initS3BucketContext (&bucketContext, bucketName);
 
     S3ListBucketHandler listBucketHandler = {
         { &responsePropertiesCallback, &responseCompleteCallback },
@@ -511,8 +516,13 @@ const char *delimiter, int maxkeys, int allDetails, s3Stat_t *s3Stat)
     data.keyCount = 0;
     data.allDetails = allDetails;
 
+#ifdef S3_MULTIPART
+    S3_list_bucket(&bucketContext, prefix, marker,
+      delimiter, maxkeys, 0, S3_REQ_TIMEOUT_MS, &listBucketHandler, &data);
+#else
     S3_list_bucket(&bucketContext, prefix, marker,
       delimiter, maxkeys, 0, &listBucketHandler, &data);
+#endif
 
     if (data.keyCount > 0) {
 	*s3Stat = data.s3Stat;
@@ -566,6 +576,11 @@ getFileFromS3 (char *fileName, char *s3ObjName, rodsLong_t fileSize)
 
     if ((status = parseS3Path (s3ObjName, myBucket, key)) < 0) return status;
 
+    if ((status = myS3Init ()) != S3StatusOK) return (status);
+    if (S3MpuThreads > 1 && fileSize > S3MpuChunkSize) {
+        return getFileFromS3Parallel (fileName, myBucket, key, fileSize);
+    }
+
     data.fd = fopen (fileName, "w+");
     if (data.fd == NULL) {
         status = UNIX_FILE_OPEN_ERR - errno;
@@ -579,28 +594,20 @@ getFileFromS3 (char *fileName, char *s3ObjName, rodsLong_t fileSize)
 
     if ((status = myS3Init ()) != S3StatusOK) return (status);
 
-      /* {myBucket,  1, 0, S3Auth.accessKeyId, S3Auth.secretAccessKey}; */
-      /* XXXXX using S3UriStyleVirtualHost causes operation containing
-       * the sub-string "S3" to fail. use S3UriStylePath instead */
-      /* this initialization failed for 3-2.0 because of the hostName
-       * element
-      S3BucketContext bucketContext =
-      {myBucket,  S3ProtocolHTTPS, S3UriStylePath, S3Auth.accessKeyId,
-        S3Auth.secretAccessKey}; */
-    bzero (&bucketContext, sizeof (bucketContext));
-    bucketContext.bucketName = myBucket;
-    bucketContext.protocol = S3ProtocolHTTPS;
-    bucketContext.uriStyle = S3UriStylePath;
-    bucketContext.accessKeyId = S3Auth.accessKeyId;
-    bucketContext.secretAccessKey = S3Auth.secretAccessKey;
+    initS3BucketContext (&bucketContext, myBucket);
 
     S3GetObjectHandler getObjectHandler = {
       { &responsePropertiesCallback, &responseCompleteCallback },
       &getObjectDataCallback
     };
 
+#ifdef S3_MULTIPART
+    S3_get_object (&bucketContext, key, NULL, 0, fileSize, 0,
+                S3_REQ_TIMEOUT_MS, &getObjectHandler, &data);
+#else
     S3_get_object (&bucketContext, key, NULL, 0, fileSize, 0,
                 &getObjectHandler, &data);
+#endif
     if (data.status != S3StatusOK) {
         status = myS3Error (data.status, S3_GET_ERROR);
     }
@@ -636,6 +643,9 @@ copyS3Obj (char *srcObj, char *destObj)
     int64_t lastModified;
     char eTag[256];
     S3BucketContext bucketContext;
+#ifdef S3_MULTIPART
+    s3Stat_t s3Stat;
+#endif
 
 
 
@@ -647,20 +657,17 @@ copyS3Obj (char *srcObj, char *destObj)
 
     if ((status = myS3Init ()) != S3StatusOK) return (status);
 
-      /* {myBucket,  1, 0, S3Auth.accessKeyId, S3Auth.secretAccessKey}; */
-      /* XXXXX using S3UriStyleVirtualHost causes operation containing
-       * the sub-string "S3" to fail. use S3UriStylePath instead */
-      /* this initialization failed for 3-2.0 because of the hostName 
-       * element 
-      S3BucketContext bucketContext =
-      {srcBucket,  S3ProtocolHTTPS, S3UriStylePath, S3Auth.accessKeyId,
-        S3Auth.secretAccessKey}; */
-    bzero (&bucketContext, sizeof (bucketContext));
-    bucketContext.bucketName = srcBucket;
-    bucketContext.protocol = S3ProtocolHTTPS;
-    bucketContext.uriStyle = S3UriStylePath;
-    bucketContext.accessKeyId = S3Auth.accessKeyId;
-    bucketContext.secretAccessKey = S3Auth.secretAccessKey;
+#ifdef S3_MULTIPART
+    /* a single copy is limited to 5 GB. Copy large objects in parallel
+     * ranges with a multipart upload */
+    if (list_bucket (srcBucket, srcKey, NULL, NULL, 1, 0, &s3Stat) >= 0 &&
+      s3Stat.size > S3MpuChunkSize) {
+        return copyS3ObjMpu (srcBucket, srcKey, destBucket, destKey,
+          s3Stat.size);
+    }
+#endif
+
+    initS3BucketContext (&bucketContext, srcBucket);
    
 
     S3ResponseHandler responseHandler = {
@@ -668,9 +675,15 @@ copyS3Obj (char *srcObj, char *destObj)
         &responseCompleteCallback
     };
 
+#ifdef S3_MULTIPART
+    S3_copy_object(&bucketContext, srcKey, destBucket,
+                       destKey, NULL, &lastModified, sizeof(eTag), eTag, 0,
+                       S3_REQ_TIMEOUT_MS, &responseHandler, &data);
+#else
     S3_copy_object(&bucketContext, srcKey, destBucket,
                        destKey, NULL, &lastModified, sizeof(eTag), eTag, 0,
                        &responseHandler, &data);
+#endif
     if (data.status != S3StatusOK) {
         status = myS3Error (data.status, S3_FILE_COPY_ERR);
     }
@@ -679,3 +692,500 @@ copyS3Obj (char *srcObj, char *destObj)
     return (status);
 }
 
+
+/* initS3BucketContext - S3UriStylePath is used because 
+ * S3UriStyleVirtualHost causes operations containing the sub-string "S3"
+ * to fail. A static initializer is not used because of the hostName
+ * element added in 3-2.0.
+ */
+void
+initS3BucketContext (S3BucketContext *bucketContext, const char *bucket)
+{
+    bzero (bucketContext, sizeof (S3BucketContext));
+    bucketContext->bucketName = bucket;
+    bucketContext->protocol = MyS3Protocol;
+    bucketContext->uriStyle = S3UriStylePath;
+    bucketContext->accessKeyId = S3Auth.accessKeyId;
+    bucketContext->secretAccessKey = S3Auth.secretAccessKey;
+}
+
+/* initS3MpuManager - split the size bytes into S3MpuChunkSize parts.
+ * The chunk size is increased if needed to stay within the S3 limit
+ * of S3_MAX_MPU_PARTS parts.
+ */
+int
+initS3MpuManager (s3MpuManager_t *manager, char *bucket, char *key,
+rodsLong_t size)
+{
+    rodsLong_t chunkSize = S3MpuChunkSize;
+    rodsLong_t offset = 0;
+    int i;
+
+    bzero (manager, sizeof (s3MpuManager_t));
+    rstrcpy (manager->bucket, bucket, MAX_NAME_LEN);
+    rstrcpy (manager->key, key, MAX_NAME_LEN);
+    manager->fd = -1;
+    manager->status = 0;
+
+    if (size / chunkSize >= S3_MAX_MPU_PARTS)
+        chunkSize = size / (S3_MAX_MPU_PARTS - 1);
+    manager->numParts = (int) ((size + chunkSize - 1) / chunkSize);
+    manager->parts = (s3PartInfo_t *) 
+      calloc (manager->numParts, sizeof (s3PartInfo_t));
+    if (manager->parts == NULL) return SYS_MALLOC_ERR;
+
+    for (i = 0; i < manager->numParts; i++) {
+        manager->parts[i].partNum = i + 1;
+        manager->parts[i].offset = offset;
+        if (size - offset > chunkSize) {
+            manager->parts[i].length = chunkSize;
+        } else {
+            manager->parts[i].length = size - offset;
+        }
+        offset += manager->parts[i].length;
+    }
+    pthread_mutex_init (&manager->lock, NULL);
+    return 0;
+}
+
+void
+clearS3MpuManager (s3MpuManager_t *manager)
+{
+    if (manager->parts != NULL) {
+        free (manager->parts);
+        manager->parts = NULL;
+    }
+    pthread_mutex_destroy (&manager->lock);
+}
+
+/* nextS3Part - hand out the next part to a worker thread. Returns NULL
+ * when all parts have been taken or a part has failed.
+ */
+static s3PartInfo_t *
+nextS3Part (s3MpuManager_t *manager)
+{
+    s3PartInfo_t *part = NULL;
+
+    pthread_mutex_lock (&manager->lock);
+    if (manager->status >= 0 && manager->nextPart < manager->numParts) {
+        part = &manager->parts[manager->nextPart];
+        manager->nextPart++;
+    }
+    pthread_mutex_unlock (&manager->lock);
+    return part;
+}
+
+static void
+setS3MpuStatus (s3MpuManager_t *manager, int status)
+{
+    pthread_mutex_lock (&manager->lock);
+    if (manager->status >= 0) manager->status = status;
+    pthread_mutex_unlock (&manager->lock);
+}
+
+/* runS3MpuWorkers - run numThreads copies of worker over the parts of
+ * manager and return the manager status.
+ */
+static int
+runS3MpuWorkers (s3MpuManager_t *manager, void *(*worker)(void *))
+{
+    pthread_t tid[S3_MAX_MPU_THREADS];
+    int numThreads = S3MpuThreads;
+    int i;
+
+    if (numThreads > manager->numParts) numThreads = manager->numParts;
+    if (numThreads <= 1) {
+        (*worker) (manager);
+        return manager->status;
+    }
+    for (i = 0; i < numThreads; i++) {
+        if (pthread_create (&tid[i], NULL, worker, (void *) manager) != 0) {
+            rodsLog (LOG_ERROR,
+              "runS3MpuWorkers: pthread_create failed for thread %d", i);
+            setS3MpuStatus (manager, SYS_PARA_OPR_NO_SUPPORT);
+            break;
+        }
+    }
+    numThreads = i;
+    for (i = 0; i < numThreads; i++) {
+        pthread_join (tid[i], NULL);
+    }
+    return manager->status;
+}
+
+S3Status
+getObjectRangeCallback (int bufferSize, const char *buffer,
+void *callbackData)
+{
+    s3PartCallbackData_t *partData = (s3PartCallbackData_t *) callbackData;
+    int nbytes;
+
+    while (bufferSize > 0) {
+        nbytes = pwrite (partData->manager->fd, buffer, bufferSize,
+          partData->offset);
+        if (nbytes <= 0) {
+            if (nbytes < 0 && errno == EINTR) continue;
+            return S3StatusAbortedByCallback;
+        }
+        buffer += nbytes;
+        bufferSize -= nbytes;
+        partData->offset += nbytes;
+    }
+    return S3StatusOK;
+}
+
+static void *
+getS3PartWorker (void *arg)
+{
+    s3MpuManager_t *manager = (s3MpuManager_t *) arg;
+    S3BucketContext bucketContext;
+    s3PartCallbackData_t partData;
+    s3PartInfo_t *part;
+    int retry;
+
+    initS3BucketContext (&bucketContext, manager->bucket);
+    S3GetObjectHandler getObjectHandler = {
+      { &responsePropertiesCallback, &responseCompleteCallback },
+      &getObjectRangeCallback
+    };
+
+    while ((part = nextS3Part (manager)) != NULL) {
+        for (retry = 0; retry < S3_PART_RETRY_CNT; retry++) {
+            bzero (&partData, sizeof (partData));
+            partData.manager = manager;
+            partData.part = part;
+            partData.offset = part->offset;
+#ifdef S3_MULTIPART
+            S3_get_object (&bucketContext, manager->key, NULL, part->offset,
+              part->length, NULL, S3_REQ_TIMEOUT_MS, &getObjectHandler,
+              &partData);
+#else
+            S3_get_object (&bucketContext, manager->key, NULL, part->offset,
+              part->length, NULL, &getObjectHandler, &partData);
+#endif
+            if (partData.data.status == S3StatusOK ||
+              !S3_status_is_retryable ((S3Status) partData.data.status))
+                break;
+        }
+        if (partData.data.status != S3StatusOK) {
+            setS3MpuStatus (manager,
+              myS3Error (partData.data.status, S3_GET_ERROR));
+        } else if (partData.offset != part->offset + part->length) {
+            rodsLog (LOG_ERROR,
+              "getS3PartWorker: %s part %d got %lld bytes, expect %lld",
+              manager->key, part->partNum, partData.offset - part->offset,
+              part->length);
+            setS3MpuStatus (manager, SYS_COPY_LEN_ERR);
+        }
+    }
+    return NULL;
+}
+
+/* getFileFromS3Parallel - stage a large object to fileName with 
+ * concurrent ranged GETs, each thread writing its ranges with pwrite.
+ */
+int
+getFileFromS3Parallel (char *fileName, char *bucket, char *key,
+rodsLong_t fileSize)
+{
+    s3MpuManager_t manager;
+    int status;
+
+    if ((status = initS3MpuManager (&manager, bucket, key, fileSize)) < 0)
+        return status;
+
+    manager.fd = open (fileName, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (manager.fd < 0) {
+        status = UNIX_FILE_OPEN_ERR - errno;
+        rodsLog (LOG_ERROR,
+         "getFileFromS3Parallel: open error for fileName %s, status = %d",
+         fileName, status);
+        clearS3MpuManager (&manager);
+        return status;
+    }
+
+    status = runS3MpuWorkers (&manager, getS3PartWorker);
+
+    if (close (manager.fd) < 0 && status >= 0) {
+        status = UNIX_FILE_CLOSE_ERR - errno;
+    }
+    clearS3MpuManager (&manager);
+    return (status);
+}
+
+#ifdef S3_MULTIPART
+S3Status
+s3PartPropertiesCallback (const S3ResponseProperties *properties,
+void *callbackData)
+{
+    s3PartCallbackData_t *partData = (s3PartCallbackData_t *) callbackData;
+
+    if (properties->eTag != NULL) {
+        rstrcpy (partData->part->eTag, (char *) properties->eTag, 
+          S3_ETAG_LEN);
+    }
+    return S3StatusOK;
+}
+
+int
+putObjectRangeCallback (int bufferSize, char *buffer, void *callbackData)
+{
+    s3PartCallbackData_t *partData = (s3PartCallbackData_t *) callbackData;
+    rodsLong_t remaining;
+    int nbytes;
+
+    remaining = partData->part->offset + partData->part->length - 
+      partData->offset;
+    if (remaining <= 0) return 0;
+    if (remaining < bufferSize) bufferSize = (int) remaining;
+
+    do {
+        nbytes = pread (partData->manager->fd, buffer, bufferSize,
+          partData->offset);
+    } while (nbytes < 0 && errno == EINTR);
+    if (nbytes < 0) return -1;	/* aborts the request */
+
+    partData->offset += nbytes;
+    return nbytes;
+}
+
+S3Status
+mpuInitialCallback (const char *uploadId, void *callbackData)
+{
+    s3PartCallbackData_t *partData = (s3PartCallbackData_t *) callbackData;
+
+    rstrcpy (partData->manager->uploadId, (char *) uploadId, MAX_NAME_LEN);
+    return S3StatusOK;
+}
+
+/* mpuCommitDataCallback - stream the CompleteMultipartUpload xml, which
+ * is kept in partData->xmlBuf, as the request body */
+int
+mpuCommitDataCallback (int bufferSize, char *buffer, void *callbackData)
+{
+    s3PartCallbackData_t *partData = (s3PartCallbackData_t *) callbackData;
+    int remaining = partData->xmlLen - (int) partData->offset;
+
+    if (remaining <= 0) return 0;
+    if (remaining < bufferSize) bufferSize = remaining;
+    memcpy (buffer, partData->xmlBuf + partData->offset, bufferSize);
+    partData->offset += bufferSize;
+    return bufferSize;
+}
+
+S3Status
+mpuCommitRespCallback (const char *location, const char *eTag,
+void *callbackData)
+{
+    return S3StatusOK;
+}
+
+void
+mpuAbortCompleteCallback (S3Status status, const S3ErrorDetails *error,
+void *callbackData)
+{
+    if (status != S3StatusOK) {
+        rodsLog (LOG_NOTICE,
+          "mpuAbortCompleteCallback: abort failed, status = %s",
+          S3_get_status_name (status));
+    }
+}
+
+static void *
+putS3PartWorker (void *arg)
+{
+    s3MpuManager_t *manager = (s3MpuManager_t *) arg;
+    S3BucketContext bucketContext;
+    s3PartCallbackData_t partData;
+    s3PartInfo_t *part;
+    int retry;
+
+    initS3BucketContext (&bucketContext, manager->bucket);
+    S3PutObjectHandler putObjectHandler = {
+      { &s3PartPropertiesCallback, &responseCompleteCallback },
+      &putObjectRangeCallback
+    };
+
+    while ((part = nextS3Part (manager)) != NULL) {
+        for (retry = 0; retry < S3_PART_RETRY_CNT; retry++) {
+            bzero (&partData, sizeof (partData));
+            partData.manager = manager;
+            partData.part = part;
+            partData.offset = part->offset;
+            S3_upload_part (&bucketContext, manager->key, NULL,
+              &putObjectHandler, part->partNum, manager->uploadId,
+              (int) part->length, NULL, S3_REQ_TIMEOUT_MS, &partData);
+            if (partData.data.status == S3StatusOK ||
+              !S3_status_is_retryable ((S3Status) partData.data.status))
+                break;
+        }
+        if (partData.data.status != S3StatusOK) {
+            setS3MpuStatus (manager,
+              myS3Error (partData.data.status, S3_PUT_ERROR));
+        }
+    }
+    return NULL;
+}
+
+static void *
+copyS3PartWorker (void *arg)
+{
+    s3MpuManager_t *manager = (s3MpuManager_t *) arg;
+    S3BucketContext bucketContext;
+    s3PartCallbackData_t partData;
+    s3PartInfo_t *part;
+    int64_t lastModified;
+    int retry;
+
+    initS3BucketContext (&bucketContext, manager->srcBucket);
+    S3ResponseHandler responseHandler = {
+        &responsePropertiesCallback,
+        &responseCompleteCallback
+    };
+
+    while ((part = nextS3Part (manager)) != NULL) {
+        for (retry = 0; retry < S3_PART_RETRY_CNT; retry++) {
+            bzero (&partData, sizeof (partData));
+            partData.manager = manager;
+            partData.part = part;
+            S3_copy_object_range (&bucketContext, manager->srcKey, 
+              manager->bucket, manager->key, part->partNum, 
+              manager->uploadId, part->offset, part->length, NULL, 
+              &lastModified, S3_ETAG_LEN, part->eTag, NULL,
+              S3_REQ_TIMEOUT_MS, &responseHandler, &partData);
+            if (partData.data.status == S3StatusOK ||
+              !S3_status_is_retryable ((S3Status) partData.data.status))
+                break;
+        }
+        if (partData.data.status != S3StatusOK) {
+            setS3MpuStatus (manager,
+              myS3Error (partData.data.status, S3_FILE_COPY_ERR));
+        }
+    }
+    return NULL;
+}
+
+/* runS3Mpu - initiate a multipart upload of manager->key, run the 
+ * part workers and complete the upload. The upload is aborted if any
+ * part fails.
+ */
+static int
+runS3Mpu (s3MpuManager_t *manager, void *(*worker)(void *), 
+int irodsErrorCode)
+{
+    S3BucketContext bucketContext;
+    s3PartCallbackData_t partData;
+    int status, i, len, xmlSize;
+
+    initS3BucketContext (&bucketContext, manager->bucket);
+
+    S3MultipartInitialHandler mpuInitialHandler = {
+      { &responsePropertiesCallback, &responseCompleteCallback },
+      &mpuInitialCallback
+    };
+    bzero (&partData, sizeof (partData));
+    partData.manager = manager;
+    S3_initiate_multipart (&bucketContext, manager->key, NULL,
+      &mpuInitialHandler, NULL, S3_REQ_TIMEOUT_MS, &partData);
+    if (partData.data.status != S3StatusOK) {
+        return myS3Error (partData.data.status, irodsErrorCode);
+    }
+
+    status = runS3MpuWorkers (manager, worker);
+
+    if (status >= 0) {
+        xmlSize = (manager->numParts + 1) * (S3_ETAG_LEN + 64);
+        partData.xmlBuf = (char *) malloc (xmlSize);
+        if (partData.xmlBuf == NULL) {
+            status = SYS_MALLOC_ERR;
+        }
+    }
+    if (status >= 0) {
+        len = snprintf (partData.xmlBuf, xmlSize, 
+          "<CompleteMultipartUpload>");
+        for (i = 0; i < manager->numParts; i++) {
+            len += snprintf (partData.xmlBuf + len, xmlSize - len,
+              "<Part><PartNumber>%d</PartNumber><ETag>%s</ETag></Part>",
+              manager->parts[i].partNum, manager->parts[i].eTag);
+        }
+        len += snprintf (partData.xmlBuf + len, xmlSize - len,
+          "</CompleteMultipartUpload>");
+        partData.xmlLen = len;
+        partData.offset = 0;
+        partData.data.status = 0;
+
+        S3MultipartCommitHandler commitHandler = {
+          { &responsePropertiesCallback, &responseCompleteCallback },
+          &mpuCommitDataCallback,
+          &mpuCommitRespCallback
+        };
+        S3_complete_multipart_upload (&bucketContext, manager->key,
+          &commitHandler, manager->uploadId, len, NULL, S3_REQ_TIMEOUT_MS,
+          &partData);
+        if (partData.data.status != S3StatusOK) {
+            status = myS3Error (partData.data.status, irodsErrorCode);
+        }
+        free (partData.xmlBuf);
+    }
+
+    if (status < 0) {
+        S3AbortMultipartUploadHandler abortHandler = {
+          { &responsePropertiesCallback, &mpuAbortCompleteCallback }
+        };
+        S3_abort_multipart_upload (&bucketContext, manager->key,
+          manager->uploadId, S3_REQ_TIMEOUT_MS, &abortHandler);
+    }
+    return (status);
+}
+
+/* putFileIntoS3Mpu - sync a large file to S3 with a multipart upload,
+ * S3MpuThreads parts at a time.
+ */
+int
+putFileIntoS3Mpu (char *fileName, char *bucket, char *key,
+rodsLong_t fileSize)
+{
+    s3MpuManager_t manager;
+    int status;
+
+    if ((status = initS3MpuManager (&manager, bucket, key, fileSize)) < 0)
+        return status;
+
+    manager.fd = open (fileName, O_RDONLY, 0);
+    if (manager.fd < 0) {
+        status = UNIX_FILE_OPEN_ERR - errno;
+        rodsLog (LOG_ERROR,
+         "putFileIntoS3Mpu: open error for fileName %s, status = %d",
+         fileName, status);
+        clearS3MpuManager (&manager);
+        return status;
+    }
+
+    status = runS3Mpu (&manager, putS3PartWorker, S3_PUT_ERROR);
+
+    close (manager.fd);
+    clearS3MpuManager (&manager);
+    return (status);
+}
+
+/* copyS3ObjMpu - server side copy of a large object with parallel
+ * UploadPartCopy requests.
+ */
+int
+copyS3ObjMpu (char *srcBucket, char *srcKey, char *destBucket,
+char *destKey, rodsLong_t size)
+{
+    s3MpuManager_t manager;
+    int status;
+
+    if ((status = initS3MpuManager (&manager, destBucket, destKey, size)) 
+      < 0) return status;
+    rstrcpy (manager.srcBucket, srcBucket, MAX_NAME_LEN);
+    rstrcpy (manager.srcKey, srcKey, MAX_NAME_LEN);
+
+    status = runS3Mpu (&manager, copyS3PartWorker, S3_FILE_COPY_ERR);
+
+    clearS3MpuManager (&manager);
+    return (status);
+}
+#endif	/* S3_MULTIPART */
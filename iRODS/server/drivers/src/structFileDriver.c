@@ -363,3 +363,70 @@ freeStructFileDesc (int structFileInx)
     return (0);
 }
 
+
+/* The checksums of the sub files computed by the driver while bundling,
+ * keyed by the local path of the sub file. They are consumed by the
+ * caller of the bundling so that the sub files need not be read again.
+ */
+
+static structFileChksum_t *StructFileChksumTable[STRUCT_FILE_CHKSUM_TABLE_SZ];
+
+static unsigned int
+hashStructFilePath (char *filePath)
+{
+    unsigned int hash = 5381;
+
+    while (*filePath != '\0') {
+        hash = hash * 33 + (unsigned char) *filePath;
+        filePath++;
+    }
+    return hash & (STRUCT_FILE_CHKSUM_TABLE_SZ - 1);
+}
+
+int
+addStructFileMemberChksum (char *filePath, char *chksumStr)
+{
+    structFileChksum_t *tmpChksum;
+    unsigned int inx = hashStructFilePath (filePath);
+
+    tmpChksum = (structFileChksum_t *) malloc (sizeof (structFileChksum_t));
+    rstrcpy (tmpChksum->filePath, filePath, MAX_NAME_LEN);
+    rstrcpy (tmpChksum->chksumStr, chksumStr, CHKSUM_LEN);
+    tmpChksum->next = StructFileChksumTable[inx];
+    StructFileChksumTable[inx] = tmpChksum;
+    return 0;
+}
+
+int
+getStructFileMemberChksum (char *filePath, char *outChksumStr)
+{
+    structFileChksum_t *tmpChksum;
+
+    tmpChksum = StructFileChksumTable[hashStructFilePath (filePath)];
+    while (tmpChksum != NULL) {
+        if (strcmp (tmpChksum->filePath, filePath) == 0) {
+            rstrcpy (outChksumStr, tmpChksum->chksumStr, CHKSUM_LEN);
+            return 0;
+        }
+        tmpChksum = tmpChksum->next;
+    }
+    return UNMATCHED_KEY_OR_INDEX;
+}
+
+int
+clearStructFileMemberChksum ()
+{
+    structFileChksum_t *tmpChksum, *nextChksum;
+    int i;
+
+    for (i = 0; i < STRUCT_FILE_CHKSUM_TABLE_SZ; i++) {
+        tmpChksum = StructFileChksumTable[i];
+        while (tmpChksum != NULL) {
+            nextChksum = tmpChksum->next;
+            free (tmpChksum);
+            tmpChksum = nextChksum;
+        }
+        StructFileChksumTable[i] = NULL;
+    }
+    return 0;
+}
@@ -0,0 +1,1059 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* tarStream.c - the streaming engine of the tar structFile driver.
+ *
+ * On the first read only open or stat of a sub file of an uncompressed
+ * tar file which has not been staged to a cacheDir, the tar headers are
+ * scanned once and the members are indexed by offset. The sub file is
+ * then read directly out of the tar file. The index is kept per
+ * StructFileDesc and rebuilt when the size or mtime of the tar file
+ * changes.
+ *
+ * bundleCacheDirWithStream writes the content of the cacheDir into the
+ * tar file in one pass (GNU tar format), optionally checksumming each
+ * member on the way. With ADD_TO_TAR_OPR, the new members are written
+ * in place over the end of archive blocks of the existing tar file.
+ */
+
+#ifndef windows_platform
+#include <sys/types.h>
+#include <dirent.h>
+#endif
+#include <stddef.h>
+#include "tarStream.h"
+#include "rsGlobalExtern.h"
+#include "rcGlobalExtern.h"
+#include "apiHeaderAll.h"
+#include "physPath.h"
+#include "md5Checksum.h"
+#ifdef SHA256_FILE_HASH
+#include "sha.h"
+#endif
+
+static tarIndex_t TarIndex[NUM_STRUCT_FILE_DESC];
+
+static int
+openTarFile (int structFileInx, int flags)
+{
+    fileOpenInp_t fileOpenInp;
+    rescInfo_t *rescInfo = StructFileDesc[structFileInx].rescInfo;
+    specColl_t *specColl = StructFileDesc[structFileInx].specColl;
+    int l3descInx;
+
+    memset (&fileOpenInp, 0, sizeof (fileOpenInp));
+    fileOpenInp.fileType = (fileDriverType_t)
+      RescTypeDef[rescInfo->rescTypeInx].driverType;
+    rstrcpy (fileOpenInp.addr.hostAddr, rescInfo->rescLoc, NAME_LEN);
+    rstrcpy (fileOpenInp.fileName, specColl->phyPath, MAX_NAME_LEN);
+    fileOpenInp.mode = getDefFileMode ();
+    fileOpenInp.flags = flags;
+    l3descInx = rsFileOpen (StructFileDesc[structFileInx].rsComm,
+      &fileOpenInp);
+    if (l3descInx < 0) {
+        rodsLog (LOG_NOTICE,
+          "openTarFile: rsFileOpen of %s in Resc %s error, status = %d",
+          fileOpenInp.fileName, rescInfo->rescName, l3descInx);
+    }
+    return l3descInx;
+}
+
+static int
+closeTarFile (rsComm_t *rsComm, int l3descInx)
+{
+    fileCloseInp_t fileCloseInp;
+
+    memset (&fileCloseInp, 0, sizeof (fileCloseInp));
+    fileCloseInp.fileInx = l3descInx;
+    return rsFileClose (rsComm, &fileCloseInp);
+}
+
+static int
+statTarFile (int structFileInx, rodsStat_t **fileStatOut)
+{
+    fileStatInp_t fileStatInp;
+    rescInfo_t *rescInfo = StructFileDesc[structFileInx].rescInfo;
+
+    memset (&fileStatInp, 0, sizeof (fileStatInp));
+    fileStatInp.fileType = (fileDriverType_t)
+      RescTypeDef[rescInfo->rescTypeInx].driverType;
+    rstrcpy (fileStatInp.addr.hostAddr, rescInfo->rescLoc, NAME_LEN);
+    rstrcpy (fileStatInp.fileName,
+      StructFileDesc[structFileInx].specColl->phyPath, MAX_NAME_LEN);
+    return rsFileStat (StructFileDesc[structFileInx].rsComm, &fileStatInp,
+      fileStatOut);
+}
+
+/* readTarBytes - read len bytes at offset of the opened tar file.
+ * Returns the number of bytes read.
+ */
+
+static int
+readTarBytes (rsComm_t *rsComm, int l3descInx, rodsLong_t offset,
+char *buf, int len)
+{
+    fileLseekInp_t fileLseekInp;
+    fileLseekOut_t *fileLseekOut = NULL;
+    fileReadInp_t fileReadInp;
+    bytesBuf_t readOutBBuf;
+    int status;
+    int bytesRead = 0;
+
+    memset (&fileLseekInp, 0, sizeof (fileLseekInp));
+    fileLseekInp.fileInx = l3descInx;
+    fileLseekInp.offset = offset;
+    fileLseekInp.whence = SEEK_SET;
+    status = rsFileLseek (rsComm, &fileLseekInp, &fileLseekOut);
+    if (fileLseekOut != NULL) free (fileLseekOut);
+    if (status < 0) return status;
+
+    while (bytesRead < len) {
+        memset (&fileReadInp, 0, sizeof (fileReadInp));
+        memset (&readOutBBuf, 0, sizeof (readOutBBuf));
+        fileReadInp.fileInx = l3descInx;
+        fileReadInp.len = len - bytesRead;
+        readOutBBuf.buf = buf + bytesRead;
+        status = rsFileRead (rsComm, &fileReadInp, &readOutBBuf);
+        if (status < 0) return status;
+        if (status == 0) break;
+        bytesRead += status;
+    }
+    return bytesRead;
+}
+
+/* getTarNum - convert a numeric field of the tar header. Fields which do
+ * not fit in octal are in the GNU base-256 format */
+
+static rodsLong_t
+getTarNum (char *field, int fieldLen)
+{
+    rodsLong_t value = 0;
+    int i;
+
+    if ((field[0] & 0x80) != 0) {
+        value = field[0] & 0x3f;
+        for (i = 1; i < fieldLen; i++) {
+            value = (value << 8) | (unsigned char) field[i];
+        }
+        return value;
+    }
+
+    for (i = 0; i < fieldLen && (field[i] == ' ' || field[i] == '\0'); i++);
+    for (; i < fieldLen && field[i] >= '0' && field[i] <= '7'; i++) {
+        value = (value << 3) | (field[i] - '0');
+    }
+    return value;
+}
+
+static void
+setTarNum (char *field, int fieldLen, rodsLong_t value)
+{
+    int i;
+
+    if (value >= 0 && value < ((rodsLong_t) 1 << (3 * (fieldLen - 1)))) {
+        /* fieldLen - 1 octal digits and a NULL */
+        snprintf (field, fieldLen, "%0*llo", fieldLen - 1, value);
+        return;
+    }
+    for (i = fieldLen - 1; i > 0; i--) {
+        field[i] = (char) (value & 0xff);
+        value >>= 8;
+    }
+    field[0] = (char) 0x80;
+}
+
+static int
+isZeroTarBlock (char *block)
+{
+    int i;
+
+    for (i = 0; i < TAR_BLOCK_SIZE; i++) {
+        if (block[i] != '\0') return 0;
+    }
+    return 1;
+}
+
+static unsigned int
+sumTarHeader (tarHeader_t *tarHeader)
+{
+    unsigned char *ptr = (unsigned char *) tarHeader;
+    unsigned int sum = 0;
+    int i;
+
+    for (i = 0; i < TAR_BLOCK_SIZE; i++) {
+        if (i >= (int) offsetof (tarHeader_t, chksum) &&
+          i < (int) (offsetof (tarHeader_t, chksum) + sizeof (tarHeader->chksum))) {
+            sum += ' ';
+        } else {
+            sum += ptr[i];
+        }
+    }
+    return sum;
+}
+
+/* normTarMemberName - take out the leading "./" and "/" and the trailing
+ * "/". Returns 1 if the name contains a ".." component.
+ */
+
+static int
+normTarMemberName (char *inName, char *outName)
+{
+    char *inPtr = inName;
+    int len;
+
+    while (1) {
+        if (inPtr[0] == '.' && inPtr[1] == '/') {
+            inPtr += 2;
+        } else if (inPtr[0] == '/') {
+            inPtr++;
+        } else {
+            break;
+        }
+    }
+    rstrcpy (outName, inPtr, MAX_NAME_LEN);
+    len = strlen (outName);
+    while (len > 0 && outName[len - 1] == '/') {
+        outName[--len] = '\0';
+    }
+    if (strcmp (outName, ".") == 0) *outName = '\0';
+
+    if (strcmp (outName, "..") == 0 || strncmp (outName, "../", 3) == 0 ||
+      strstr (outName, "/../") != NULL ||
+      (len >= 3 && strcmp (outName + len - 3, "/..") == 0)) {
+        return 1;
+    }
+    return 0;
+}
+
+/* getPaxPath - get the path record from the pax extended header data.
+ * Records are "len keyword=value\n" */
+
+static void
+getPaxPath (char *paxData, int paxLen, char *outPath)
+{
+    char *recPtr = paxData;
+    char *endPtr = paxData + paxLen;
+    char *kwPtr;
+    int recLen;
+
+    while (recPtr < endPtr) {
+        recLen = atoi (recPtr);
+        if (recLen <= 0 || recPtr + recLen > endPtr) break;
+        kwPtr = strchr (recPtr, ' ');
+        if (kwPtr != NULL && kwPtr < recPtr + recLen &&
+          strncmp (kwPtr + 1, "path=", 5) == 0) {
+            int valLen = recLen - (kwPtr + 6 - recPtr) - 1;
+            if (valLen > 0 && valLen < MAX_NAME_LEN) {
+                strncpy (outPath, kwPtr + 6, valLen);
+                outPath[valLen] = '\0';
+            }
+        }
+        recPtr += recLen;
+    }
+}
+
+static void
+addTarMember (tarIndex_t *tarIndex, char *name, rodsLong_t dataOffset,
+rodsLong_t size, unsigned int mode, unsigned int mtime, int objType)
+{
+    tarMember_t *tarMember;
+
+    if (tarIndex->numMembers >= tarIndex->allocCnt) {
+        tarIndex->allocCnt += TAR_INDEX_ALLOC_CNT;
+        tarIndex->members = (tarMember_t *) realloc (tarIndex->members,
+          tarIndex->allocCnt * sizeof (tarMember_t));
+    }
+    tarMember = &tarIndex->members[tarIndex->numMembers];
+    tarMember->name = strdup (name);
+    tarMember->dataOffset = dataOffset;
+    tarMember->size = size;
+    tarMember->mode = mode;
+    tarMember->mtime = mtime;
+    tarMember->objType = objType;
+    tarIndex->numMembers++;
+}
+
+static int
+cmpTarMemberName (const void *a, const void *b)
+{
+    return strcmp (((tarMember_t *) a)->name, ((tarMember_t *) b)->name);
+}
+
+/* cmpTarMember - members of the same name (e.g. appended by tar -r) are
+ * kept in archive order so the last one can be found like an extract */
+
+static int
+cmpTarMember (const void *a, const void *b)
+{
+    int status = cmpTarMemberName (a, b);
+
+    if (status != 0) return status;
+    if (((tarMember_t *) a)->dataOffset < ((tarMember_t *) b)->dataOffset)
+        return -1;
+    if (((tarMember_t *) a)->dataOffset > ((tarMember_t *) b)->dataOffset)
+        return 1;
+    return 0;
+}
+
+/* indexTarFile - scan the headers of the opened tar file l3descInx
+ * and fill in tarIndex */
+
+static int
+indexTarFile (rsComm_t *rsComm, int l3descInx, tarIndex_t *tarIndex)
+{
+    tarHeader_t tarHeader;
+    rodsLong_t offset = 0;
+    rodsLong_t size, nextOffset;
+    char *extData = NULL;
+    char longName[MAX_NAME_LEN];
+    char rawName[MAX_NAME_LEN];
+    char memberName[MAX_NAME_LEN];
+    int status = 0;
+    int len;
+
+    *longName = '\0';
+    while (1) {
+        len = readTarBytes (rsComm, l3descInx, offset, (char *) &tarHeader,
+          TAR_BLOCK_SIZE);
+        if (len < 0) {
+            status = len;
+            break;
+        }
+        if (len == 0 || isZeroTarBlock ((char *) &tarHeader)) {
+            /* no end of archive blocks is tolerated */
+            tarIndex->endOffset = offset;
+            break;
+        }
+        if (len < TAR_BLOCK_SIZE ||
+          getTarNum (tarHeader.chksum, sizeof (tarHeader.chksum)) !=
+          sumTarHeader (&tarHeader)) {
+            /* not a tar file, or a compressed one */
+            status = SYS_TAR_STRUCT_FILE_EXTRACT_ERR;
+            break;
+        }
+
+        size = getTarNum (tarHeader.size, sizeof (tarHeader.size));
+        nextOffset = offset + TAR_BLOCK_SIZE +
+          (size + TAR_BLOCK_SIZE - 1) / TAR_BLOCK_SIZE * TAR_BLOCK_SIZE;
+
+        if (tarHeader.typeflag == TAR_GNU_LONGNAME_TYPE ||
+          tarHeader.typeflag == TAR_PAX_HDR_TYPE) {
+            if (size <= 0 || size > TAR_MAX_EXT_HDR_SIZE) {
+                status = SYS_TAR_STRUCT_FILE_EXTRACT_ERR;
+                break;
+            }
+            extData = (char *) realloc (extData, size + 1);
+            len = readTarBytes (rsComm, l3descInx, offset + TAR_BLOCK_SIZE,
+              extData, (int) size);
+            if (len != size) {
+                status = SYS_TAR_STRUCT_FILE_EXTRACT_ERR;
+                break;
+            }
+            extData[size] = '\0';
+            if (tarHeader.typeflag == TAR_GNU_LONGNAME_TYPE) {
+                rstrcpy (longName, extData, MAX_NAME_LEN);
+            } else {
+                getPaxPath (extData, (int) size, longName);
+            }
+            offset = nextOffset;
+            continue;
+        }
+
+        if (*longName != '\0') {
+            rstrcpy (rawName, longName, MAX_NAME_LEN);
+            *longName = '\0';
+        } else if (strncmp (tarHeader.magic, TAR_USTAR_MAGIC "", 6) == 0 &&
+          tarHeader.prefix[0] != '\0') {
+            /* POSIX ustar. GNU tar uses the prefix field for other things */
+            snprintf (rawName, MAX_NAME_LEN, "%.155s/%.100s",
+              tarHeader.prefix, tarHeader.name);
+        } else {
+            snprintf (rawName, MAX_NAME_LEN, "%.100s", tarHeader.name);
+        }
+        if (normTarMemberName (rawName, memberName) > 0) {
+            tarIndex->flags |= TAR_INDEX_UNSAFE;
+        }
+
+        switch (tarHeader.typeflag) {
+          case TAR_REG_TYPE:
+          case TAR_AREG_TYPE:
+          case TAR_CONT_TYPE:
+            addTarMember (tarIndex, memberName, offset + TAR_BLOCK_SIZE, size,
+              (unsigned int) getTarNum (tarHeader.mode,
+              sizeof (tarHeader.mode)) & 07777,
+              (unsigned int) getTarNum (tarHeader.mtime,
+              sizeof (tarHeader.mtime)), DATA_OBJ_T);
+            break;
+          case TAR_DIR_TYPE:
+            if (*memberName != '\0') {
+                addTarMember (tarIndex, memberName, 0, 0,
+                  (unsigned int) getTarNum (tarHeader.mode,
+                  sizeof (tarHeader.mode)) & 07777,
+                  (unsigned int) getTarNum (tarHeader.mtime,
+                  sizeof (tarHeader.mtime)), COLL_OBJ_T);
+            }
+            size = 0;
+            break;
+          case TAR_LNK_TYPE:
+          case TAR_SYM_TYPE:
+            /* same check as hasSymlinkInDir done after an extract */
+            tarIndex->flags |= TAR_INDEX_UNSAFE;
+            break;
+          default:
+            /* devices, fifos, global pax headers, ... */
+            break;
+        }
+        offset = nextOffset;
+    }
+    if (extData != NULL) free (extData);
+
+    if (status >= 0 && tarIndex->numMembers > 1) {
+        qsort (tarIndex->members, tarIndex->numMembers, sizeof (tarMember_t),
+          cmpTarMember);
+    }
+    return status;
+}
+
+int
+freeTarIndex (int structFileInx)
+{
+    tarIndex_t *tarIndex;
+    int i;
+
+    if (structFileInx < 0 || structFileInx >= NUM_STRUCT_FILE_DESC)
+        return (SYS_FILE_DESC_OUT_OF_RANGE);
+
+    tarIndex = &TarIndex[structFileInx];
+    for (i = 0; i < tarIndex->numMembers; i++) {
+        free (tarIndex->members[i].name);
+    }
+    if (tarIndex->members != NULL) free (tarIndex->members);
+    memset (tarIndex, 0, sizeof (tarIndex_t));
+    return 0;
+}
+
+int
+isTarStreamDataType (char *dataType)
+{
+    if (dataType == NULL) return 1;
+    if (strstr (dataType, GZIP_TAR_DT_STR) != NULL ||
+      strstr (dataType, BZIP2_TAR_DT_STR) != NULL ||
+      strstr (dataType, ZIP_DT_STR) != NULL) return 0;
+    return 1;
+}
+
+/* getTarIndex - get the member index of the tar file of structFileInx,
+ * building it if it does not exist or is out of date.
+ */
+
+int
+getTarIndex (int structFileInx, tarIndex_t **outTarIndex)
+{
+    tarIndex_t *tarIndex;
+    specColl_t *specColl = StructFileDesc[structFileInx].specColl;
+    rodsStat_t *fileStatOut = NULL;
+    int l3descInx;
+    int status;
+
+    if (!isTarStreamDataType (StructFileDesc[structFileInx].dataType))
+        return SYS_ZIP_FORMAT_NOT_SUPPORTED;
+
+    status = statTarFile (structFileInx, &fileStatOut);
+    if (status < 0 || fileStatOut == NULL) return status;
+
+    tarIndex = &TarIndex[structFileInx];
+    if (strcmp (tarIndex->phyPath, specColl->phyPath) == 0 &&
+      tarIndex->tarSize == fileStatOut->st_size &&
+      tarIndex->tarMtime == fileStatOut->st_mtim) {
+        free (fileStatOut);
+        *outTarIndex = tarIndex;
+        return 0;
+    }
+
+    freeTarIndex (structFileInx);
+    rstrcpy (tarIndex->phyPath, specColl->phyPath, MAX_NAME_LEN);
+    tarIndex->tarSize = fileStatOut->st_size;
+    tarIndex->tarMtime = fileStatOut->st_mtim;
+    free (fileStatOut);
+
+    if ((l3descInx = openTarFile (structFileInx, O_RDONLY)) < 0) {
+        freeTarIndex (structFileInx);
+        return l3descInx;
+    }
+    status = indexTarFile (StructFileDesc[structFileInx].rsComm, l3descInx,
+      tarIndex);
+    closeTarFile (StructFileDesc[structFileInx].rsComm, l3descInx);
+    if (status < 0) {
+        rodsLog (LOG_DEBUG,
+          "getTarIndex: indexTarFile of %s error, status = %d",
+          specColl->phyPath, status);
+        freeTarIndex (structFileInx);
+        return status;
+    }
+    *outTarIndex = tarIndex;
+    return 0;
+}
+
+tarMember_t *
+matchTarMember (tarIndex_t *tarIndex, char *name)
+{
+    tarMember_t myMember;
+    tarMember_t *tarMember, *lastMember;
+
+    if (tarIndex->numMembers <= 0) return NULL;
+    myMember.name = name;
+    tarMember = (tarMember_t *) bsearch (&myMember, tarIndex->members,
+      tarIndex->numMembers, sizeof (tarMember_t), cmpTarMemberName);
+    if (tarMember == NULL) return NULL;
+
+    /* the last copy in the archive is the one an extract leaves behind */
+    lastMember = &tarIndex->members[tarIndex->numMembers - 1];
+    while (tarMember < lastMember &&
+      strcmp (tarMember[1].name, name) == 0) {
+        tarMember++;
+    }
+    return tarMember;
+}
+
+/* isTarMemberDir - a directory may only be implied by the path of the
+ * members under it */
+
+static int
+isTarMemberDir (tarIndex_t *tarIndex, char *name)
+{
+    int len = strlen (name);
+    int i;
+
+    if (len == 0) return 1;	/* the top */
+    for (i = 0; i < tarIndex->numMembers; i++) {
+        if (strncmp (tarIndex->members[i].name, name, len) == 0 &&
+          tarIndex->members[i].name[len] == '/') return 1;
+    }
+    return 0;
+}
+
+/* getTarMemberName - the name of the member in the tar file for
+ * subFilePath which is the logical path under specColl->collection */
+
+int
+getTarMemberName (specColl_t *specColl, char *subFilePath, char *outName)
+{
+    int len;
+
+    len = strlen (specColl->collection);
+    if (strncmp (specColl->collection, subFilePath, len) != 0 ||
+      (subFilePath[len] != '/' && subFilePath[len] != '\0')) {
+        rodsLog (LOG_NOTICE,
+         "getTarMemberName: collection %s subFilePath %s mismatch",
+          specColl->collection, subFilePath);
+        return (SYS_STRUCT_FILE_PATH_ERR);
+    }
+    normTarMemberName (subFilePath + len, outName);
+    return 0;
+}
+
+/* chkTarStreamRead - check whether sub files of specColl can be read
+ * directly from the tar file. That is the case when it has not been
+ * staged to a cacheDir (which would hold the current content) and it
+ * is a plain tar file without links. Returns 1 if so with the
+ * structFileInx in outStructFileInx.
+ */
+
+int
+chkTarStreamRead (rsComm_t *rsComm, specColl_t *specColl,
+int *outStructFileInx)
+{
+    int structFileInx;
+    tarIndex_t *tarIndex;
+
+    structFileInx = openTarStructFileDesc (rsComm, specColl);
+    if (structFileInx < 0) return 0;
+
+    if (strlen (StructFileDesc[structFileInx].specColl->cacheDir) > 0)
+        return 0;
+
+    if (getTarIndex (structFileInx, &tarIndex) < 0 ||
+      (tarIndex->flags & TAR_INDEX_UNSAFE) != 0) return 0;
+
+    *outStructFileInx = structFileInx;
+    return 1;
+}
+
+int
+tarStreamSubFileOpen (rsComm_t *rsComm, int structFileInx,
+subFile_t *subFile)
+{
+    tarIndex_t *tarIndex;
+    tarMember_t *tarMember;
+    char memberName[MAX_NAME_LEN];
+    int subInx;
+    int status;
+
+    if ((status = getTarIndex (structFileInx, &tarIndex)) < 0)
+        return status;
+    status = getTarMemberName (StructFileDesc[structFileInx].specColl,
+      subFile->subFilePath, memberName);
+    if (status < 0) return status;
+
+    tarMember = matchTarMember (tarIndex, memberName);
+    if (tarMember == NULL) return UNIX_FILE_OPEN_ERR - ENOENT;
+    if (tarMember->objType != DATA_OBJ_T) return UNIX_FILE_OPEN_ERR - EISDIR;
+
+    subInx = allocTarSubFileDesc ();
+    if (subInx < 0) return subInx;
+
+    status = openTarFile (structFileInx, O_RDONLY);
+    if (status < 0) {
+        freeTarSubFileDesc (subInx);
+        return status;
+    }
+    TarSubFileDesc[subInx].structFileInx = structFileInx;
+    TarSubFileDesc[subInx].fd = status;
+    TarSubFileDesc[subInx].streamFlag = 1;
+    TarSubFileDesc[subInx].dataOffset = tarMember->dataOffset;
+    TarSubFileDesc[subInx].dataSize = tarMember->size;
+    TarSubFileDesc[subInx].curOffset = 0;
+    TarSubFileDesc[subInx].mode = tarMember->mode;
+    TarSubFileDesc[subInx].mtime = tarMember->mtime;
+    StructFileDesc[structFileInx].openCnt++;
+
+    return subInx;
+}
+
+int
+tarStreamSubFileRead (rsComm_t *rsComm, int subInx, void *buf, int len)
+{
+    tarSubFileDesc_t *subDesc = &TarSubFileDesc[subInx];
+    rodsLong_t remaining;
+    int status;
+
+    remaining = subDesc->dataSize - subDesc->curOffset;
+    if (remaining <= 0) return 0;
+    if (len > remaining) len = (int) remaining;
+
+    status = readTarBytes (rsComm, subDesc->fd,
+      subDesc->dataOffset + subDesc->curOffset, (char *) buf, len);
+    if (status > 0) subDesc->curOffset += status;
+
+    return status;
+}
+
+rodsLong_t
+tarStreamSubFileLseek (rsComm_t *rsComm, int subInx, rodsLong_t offset,
+int whence)
+{
+    tarSubFileDesc_t *subDesc = &TarSubFileDesc[subInx];
+    rodsLong_t newOffset;
+
+    if (whence == SEEK_SET) {
+        newOffset = offset;
+    } else if (whence == SEEK_CUR) {
+        newOffset = subDesc->curOffset + offset;
+    } else if (whence == SEEK_END) {
+        newOffset = subDesc->dataSize + offset;
+    } else {
+        return UNIX_FILE_LSEEK_ERR - EINVAL;
+    }
+    if (newOffset < 0) return UNIX_FILE_LSEEK_ERR - EINVAL;
+
+    subDesc->curOffset = newOffset;
+    return newOffset;
+}
+
+static void
+fillTarMemberStat (rodsStat_t *myStat, int objType, rodsLong_t size,
+unsigned int mode, unsigned int mtime)
+{
+    memset (myStat, 0, sizeof (rodsStat_t));
+    myStat->st_size = size;
+    if (objType == COLL_OBJ_T) {
+        myStat->st_mode = S_IFDIR | (mode != 0 ? mode : getDefDirMode ());
+    } else {
+        myStat->st_mode = S_IFREG | mode;
+    }
+    myStat->st_nlink = 1;
+    myStat->st_atim = myStat->st_mtim = myStat->st_ctim = mtime;
+    myStat->st_blksize = TAR_BLOCK_SIZE;
+    myStat->st_blocks = (unsigned int) ((size + TAR_BLOCK_SIZE - 1) /
+      TAR_BLOCK_SIZE);
+}
+
+int
+tarStreamSubFileFstat (rsComm_t *rsComm, int subInx,
+rodsStat_t **subStructFileStatOut)
+{
+    tarSubFileDesc_t *subDesc = &TarSubFileDesc[subInx];
+
+    *subStructFileStatOut = (rodsStat_t *) malloc (sizeof (rodsStat_t));
+    fillTarMemberStat (*subStructFileStatOut, DATA_OBJ_T, subDesc->dataSize,
+      subDesc->mode, subDesc->mtime);
+    return 0;
+}
+
+int
+tarStreamSubFileClose (rsComm_t *rsComm, int subInx)
+{
+    return closeTarFile (rsComm, TarSubFileDesc[subInx].fd);
+}
+
+int
+tarStreamSubFileStat (rsComm_t *rsComm, int structFileInx,
+subFile_t *subFile, rodsStat_t **subStructFileStatOut)
+{
+    tarIndex_t *tarIndex;
+    tarMember_t *tarMember;
+    char memberName[MAX_NAME_LEN];
+    int status;
+
+    if ((status = getTarIndex (structFileInx, &tarIndex)) < 0)
+        return status;
+    status = getTarMemberName (StructFileDesc[structFileInx].specColl,
+      subFile->subFilePath, memberName);
+    if (status < 0) return status;
+
+    tarMember = matchTarMember (tarIndex, memberName);
+    if (tarMember != NULL) {
+        *subStructFileStatOut = (rodsStat_t *) malloc (sizeof (rodsStat_t));
+        fillTarMemberStat (*subStructFileStatOut, tarMember->objType,
+          tarMember->size, tarMember->mode, tarMember->mtime);
+    } else if (isTarMemberDir (tarIndex, memberName)) {
+        *subStructFileStatOut = (rodsStat_t *) malloc (sizeof (rodsStat_t));
+        fillTarMemberStat (*subStructFileStatOut, COLL_OBJ_T, 0, 0,
+          (unsigned int) tarIndex->tarMtime);
+    } else {
+        return UNIX_FILE_STAT_ERR - ENOENT;
+    }
+    return 0;
+}
+
+/* the bundle writer */
+
+static int
+flushTarWriter (tarWriter_t *tarWriter)
+{
+    fileWriteInp_t fileWriteInp;
+    bytesBuf_t writeInpBBuf;
+    int status;
+
+    if (tarWriter->bufLen <= 0) return 0;
+
+    memset (&fileWriteInp, 0, sizeof (fileWriteInp));
+    memset (&writeInpBBuf, 0, sizeof (writeInpBBuf));
+    fileWriteInp.fileInx = tarWriter->l3descInx;
+    fileWriteInp.len = writeInpBBuf.len = tarWriter->bufLen;
+    writeInpBBuf.buf = tarWriter->buf;
+    status = rsFileWrite (tarWriter->rsComm, &fileWriteInp, &writeInpBBuf);
+    if (status != tarWriter->bufLen) {
+        rodsLog (LOG_ERROR,
+          "flushTarWriter: rsFileWrite of %d bytes error, status = %d",
+          tarWriter->bufLen, status);
+        return status < 0 ? status : SYS_COPY_LEN_ERR;
+    }
+    tarWriter->bufLen = 0;
+    return 0;
+}
+
+static int
+writeTarBytes (tarWriter_t *tarWriter, char *data, int len)
+{
+    int status;
+    int cnt;
+
+    while (len > 0) {
+        if (tarWriter->bufLen >= TAR_STREAM_BUF_SIZE) {
+            if ((status = flushTarWriter (tarWriter)) < 0) return status;
+        }
+        cnt = TAR_STREAM_BUF_SIZE - tarWriter->bufLen;
+        if (cnt > len) cnt = len;
+        if (data != NULL) {
+            memcpy (tarWriter->buf + tarWriter->bufLen, data, cnt);
+            data += cnt;
+        } else {
+            memset (tarWriter->buf + tarWriter->bufLen, 0, cnt);
+        }
+        tarWriter->bufLen += cnt;
+        tarWriter->offset += cnt;
+        len -= cnt;
+    }
+    return 0;
+}
+
+static int
+padTarBlock (tarWriter_t *tarWriter)
+{
+    int rem = (int) (tarWriter->offset % TAR_BLOCK_SIZE);
+
+    if (rem == 0) return 0;
+    return writeTarBytes (tarWriter, NULL, TAR_BLOCK_SIZE - rem);
+}
+
+static int
+writeTarHeaderBlock (tarWriter_t *tarWriter, char *name, char typeflag,
+rodsLong_t size, unsigned int mode, unsigned int mtime)
+{
+    tarHeader_t tarHeader;
+
+    memset (&tarHeader, 0, sizeof (tarHeader));
+    strncpy (tarHeader.name, name, TAR_NAME_LEN);
+    setTarNum (tarHeader.mode, sizeof (tarHeader.mode), mode & 07777);
+    setTarNum (tarHeader.uid, sizeof (tarHeader.uid), 0);
+    setTarNum (tarHeader.gid, sizeof (tarHeader.gid), 0);
+    setTarNum (tarHeader.size, sizeof (tarHeader.size), size);
+    setTarNum (tarHeader.mtime, sizeof (tarHeader.mtime), mtime);
+    tarHeader.typeflag = typeflag;
+    /* magic and version together */
+    memcpy (tarHeader.magic, TAR_GNU_MAGIC, sizeof (TAR_GNU_MAGIC));
+    snprintf (tarHeader.chksum, sizeof (tarHeader.chksum) - 1, "%06o",
+      sumTarHeader (&tarHeader));
+    tarHeader.chksum[7] = ' ';
+
+    return writeTarBytes (tarWriter, (char *) &tarHeader, TAR_BLOCK_SIZE);
+}
+
+static int
+writeTarHeader (tarWriter_t *tarWriter, char *name, char typeflag,
+rodsLong_t size, unsigned int mode, unsigned int mtime)
+{
+    int status;
+    int len = strlen (name);
+
+    if (len >= TAR_NAME_LEN) {
+        /* GNU long name member ahead of the real one */
+        status = writeTarHeaderBlock (tarWriter, TAR_GNU_LONGNAME,
+          TAR_GNU_LONGNAME_TYPE, len + 1, 0, 0);
+        if (status < 0) return status;
+        if ((status = writeTarBytes (tarWriter, name, len + 1)) < 0)
+            return status;
+        if ((status = padTarBlock (tarWriter)) < 0) return status;
+    }
+    return writeTarHeaderBlock (tarWriter, name, typeflag, size, mode, mtime);
+}
+
+/* writeFileToTar - write the local file filePath as member name.
+ * The content is checksummed on the way if chksumFlag is on and the
+ * result is saved with addStructFileMemberChksum.
+ */
+
+static int
+writeFileToTar (tarWriter_t *tarWriter, char *filePath, char *name,
+struct stat *statbuf, int chksumFlag)
+{
+    int status;
+    int fd;
+    int cnt;
+    rodsLong_t bytesWritten = 0;
+    MD5_CTX context;
+    unsigned char digest[16];
+#ifdef SHA256_FILE_HASH
+    unsigned char sha256_hash[SHA256_DIGEST_LENGTH+10];
+    SHA256_CTX sha256;
+#endif
+    char chksumStr[CHKSUM_LEN];
+
+    status = writeTarHeader (tarWriter, name, TAR_REG_TYPE,
+      statbuf->st_size, statbuf->st_mode, statbuf->st_mtime);
+    if (status < 0) return status;
+
+    if ((fd = open (filePath, O_RDONLY, 0)) < 0) {
+        status = UNIX_FILE_OPEN_ERR - errno;
+        rodsLog (LOG_ERROR,
+          "writeFileToTar: open error for %s, status = %d", filePath, status);
+        return status;
+    }
+    if (chksumFlag != 0) {
+#ifdef SHA256_FILE_HASH
+        SHA256_Init (&sha256);
+#else
+        MD5Init (&context);
+#endif
+    }
+
+    while (bytesWritten < statbuf->st_size) {
+        if (tarWriter->bufLen >= TAR_STREAM_BUF_SIZE) {
+            if ((status = flushTarWriter (tarWriter)) < 0) break;
+        }
+        cnt = TAR_STREAM_BUF_SIZE - tarWriter->bufLen;
+        if (cnt > statbuf->st_size - bytesWritten)
+            cnt = (int) (statbuf->st_size - bytesWritten);
+        /* read straight into the write buffer */
+        cnt = read (fd, tarWriter->buf + tarWriter->bufLen, cnt);
+        if (cnt <= 0) {
+            /* the file was truncated under us */
+            status = cnt < 0 ? UNIX_FILE_READ_ERR - errno : SYS_COPY_LEN_ERR;
+            rodsLog (LOG_ERROR,
+              "writeFileToTar: read error for %s, status = %d",
+              filePath, status);
+            break;
+        }
+        if (chksumFlag != 0) {
+#ifdef SHA256_FILE_HASH
+            SHA256_Update (&sha256, tarWriter->buf + tarWriter->bufLen, cnt);
+#else
+            MD5Update (&context,
+              (unsigned char *) tarWriter->buf + tarWriter->bufLen, cnt);
+#endif
+        }
+        tarWriter->bufLen += cnt;
+        tarWriter->offset += cnt;
+        bytesWritten += cnt;
+    }
+    close (fd);
+    if (status < 0) return status;
+
+    if (chksumFlag != 0) {
+#ifdef SHA256_FILE_HASH
+        SHA256_Final (sha256_hash, &sha256);
+        sha256ToStr (sha256_hash, chksumStr);
+#else
+        MD5Final (digest, &context);
+        md5ToStr (digest, chksumStr);
+#endif
+        addStructFileMemberChksum (filePath, chksumStr);
+    }
+
+    return padTarBlock (tarWriter);
+}
+
+/* writeDirToTar - write the content of the local dirPath recursively.
+ * relPath is the member name of dirPath. Symlinks are followed as
+ * with tar -h.
+ */
+
+static int
+writeDirToTar (tarWriter_t *tarWriter, char *dirPath, char *relPath,
+int chksumFlag)
+{
+    DIR *dirPtr;
+    struct dirent *myDirent;
+    struct stat statbuf;
+    char childPath[MAX_NAME_LEN];
+    char childName[MAX_NAME_LEN];
+    int status = 0;
+
+    if ((dirPtr = opendir (dirPath)) == NULL) {
+        status = UNIX_FILE_OPENDIR_ERR - errno;
+        rodsLog (LOG_ERROR,
+          "writeDirToTar: opendir error for %s, status = %d", dirPath, status);
+        return status;
+    }
+    while ((myDirent = readdir (dirPtr)) != NULL) {
+        if (strcmp (myDirent->d_name, ".") == 0 ||
+          strcmp (myDirent->d_name, "..") == 0) continue;
+
+        if (snprintf (childPath, MAX_NAME_LEN, "%s/%s", dirPath,
+          myDirent->d_name) >= MAX_NAME_LEN || (*relPath != '\0' &&
+          snprintf (childName, MAX_NAME_LEN, "%s/%s", relPath,
+          myDirent->d_name) >= MAX_NAME_LEN)) {
+            status = USER_STRLEN_TOOLONG;
+            rodsLog (LOG_ERROR,
+              "writeDirToTar: path of %s in %s too long, status = %d",
+              myDirent->d_name, dirPath, status);
+            break;
+        }
+        if (*relPath == '\0') {
+            rstrcpy (childName, myDirent->d_name, MAX_NAME_LEN);
+        }
+        if (stat (childPath, &statbuf) != 0) {
+            status = UNIX_FILE_STAT_ERR - errno;
+            rodsLog (LOG_ERROR,
+              "writeDirToTar: stat error for %s, status = %d",
+              childPath, status);
+            break;
+        }
+        if ((statbuf.st_mode & S_IFDIR) != 0) {
+            char dirName[MAX_NAME_LEN + 1];
+            snprintf (dirName, sizeof (dirName), "%s/", childName);
+            status = writeTarHeader (tarWriter, dirName, TAR_DIR_TYPE, 0,
+              statbuf.st_mode, statbuf.st_mtime);
+            if (status < 0) break;
+            status = writeDirToTar (tarWriter, childPath, childName,
+              chksumFlag);
+        } else if ((statbuf.st_mode & S_IFREG) != 0) {
+            status = writeFileToTar (tarWriter, childPath, childName,
+              &statbuf, chksumFlag);
+        } else {
+            rodsLog (LOG_NOTICE,
+              "writeDirToTar: %s is not a file nor a dir, skipped",
+              childPath);
+        }
+        if (status < 0) break;
+    }
+    closedir (dirPtr);
+    return status;
+}
+
+/* bundleCacheDirWithStream - write the content of the cacheDir to the
+ * tar file. With ADD_TO_TAR_OPR, the members are appended in place
+ * at the end of the existing archive. With CHKSUM_SUB_FILES_OPR, the
+ * checksums of the sub files are computed during the same pass.
+ */
+
+int
+bundleCacheDirWithStream (int structFileInx, int oprType)
+{
+    specColl_t *specColl = StructFileDesc[structFileInx].specColl;
+    rsComm_t *rsComm = StructFileDesc[structFileInx].rsComm;
+    tarWriter_t tarWriter;
+    tarIndex_t *tarIndex;
+    fileLseekInp_t fileLseekInp;
+    fileLseekOut_t *fileLseekOut = NULL;
+    rodsLong_t startOffset = 0;
+    int status, status1;
+
+    if (specColl == NULL || specColl->cacheDirty <= 0 ||
+      strlen (specColl->cacheDir) == 0) return 0;
+
+    memset (&tarWriter, 0, sizeof (tarWriter));
+    tarWriter.rsComm = rsComm;
+
+    if ((oprType & ADD_TO_TAR_OPR) != 0) {
+        status = getTarIndex (structFileInx, &tarIndex);
+        if (status < 0) {
+            rodsLog (LOG_ERROR,
+              "bundleCacheDirWithStream: getTarIndex of %s error, status = %d",
+              specColl->phyPath, status);
+            return status;
+        }
+        startOffset = tarIndex->endOffset;
+        tarWriter.l3descInx = openTarFile (structFileInx, O_RDWR);
+    } else {
+        tarWriter.l3descInx = openTarFile (structFileInx,
+          O_WRONLY | O_CREAT | O_TRUNC);
+    }
+    /* the content is about to change */
+    freeTarIndex (structFileInx);
+    if (tarWriter.l3descInx < 0) return SYS_TAR_OPEN_ERR;
+
+    if (startOffset > 0) {
+        memset (&fileLseekInp, 0, sizeof (fileLseekInp));
+        fileLseekInp.fileInx = tarWriter.l3descInx;
+        fileLseekInp.offset = startOffset;
+        fileLseekInp.whence = SEEK_SET;
+        status = rsFileLseek (rsComm, &fileLseekInp, &fileLseekOut);
+        if (fileLseekOut != NULL) free (fileLseekOut);
+        if (status < 0) {
+            closeTarFile (rsComm, tarWriter.l3descInx);
+            return status;
+        }
+        tarWriter.offset = startOffset;
+    }
+
+    tarWriter.buf = (char *) malloc (TAR_STREAM_BUF_SIZE);
+    status = writeDirToTar (&tarWriter, specColl->cacheDir, "",
+      oprType & CHKSUM_SUB_FILES_OPR);
+    if (status >= 0) {
+        /* the end of archive blocks */
+        status = writeTarBytes (&tarWriter, NULL, 2 * TAR_BLOCK_SIZE);
+    }
+    if (status >= 0) status = flushTarWriter (&tarWriter);
+    free (tarWriter.buf);
+
+    status1 = closeTarFile (rsComm, tarWriter.l3descInx);
+    if (status >= 0 && status1 < 0) status = status1;
+    if (status < 0) {
+        rodsLog (LOG_ERROR,
+          "bundleCacheDirWithStream: bundling %s into %s error, status = %d",
+          specColl->cacheDir, specColl->phyPath, status);
+    }
+    return status;
+}
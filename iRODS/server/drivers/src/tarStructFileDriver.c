@@ -28,6 +28,7 @@
 #include "resource.h"
 #include "miscServerFunct.h"
 #include "physPath.h"
+#include "tarStream.h"
 
 int
 rmTmpDirAll (char *myDir);
@@ -110,6 +111,11 @@ tarSubStructFileOpen (rsComm_t *rsComm, subFile_t *subFile)
     fileOpenInp_t fileOpenInp;
 
     specColl = subFile->specColl;
+    if ((subFile->flags & O_ACCMODE) == O_RDONLY &&
+      chkTarStreamRead (rsComm, specColl, &structFileInx) > 0) {
+	/* read it directly out of the tar file */
+	return tarStreamSubFileOpen (rsComm, structFileInx, subFile);
+    }
     structFileInx = rsTarStructFileOpen (rsComm, specColl);
 
     if (structFileInx < 0) {
@@ -168,6 +174,9 @@ tarSubStructFileRead (rsComm_t *rsComm, int subInx, void *buf, int len)
         return (SYS_STRUCT_FILE_DESC_ERR);
     }
 
+    if (TarSubFileDesc[subInx].streamFlag > 0)
+	return tarStreamSubFileRead (rsComm, subInx, buf, len);
+
     memset (&fileReadInp, 0, sizeof (fileReadInp));
     memset (&fileReadOutBBuf, 0, sizeof (fileReadOutBBuf));
     fileReadInp.fileInx = TarSubFileDesc[subInx].fd;
@@ -229,8 +238,12 @@ tarSubStructFileClose (rsComm_t *rsComm, int subInx)
         return (SYS_STRUCT_FILE_DESC_ERR);
     }
 
-    fileCloseInp.fileInx = TarSubFileDesc[subInx].fd;
-    status = rsFileClose (rsComm, &fileCloseInp);
+    if (TarSubFileDesc[subInx].streamFlag > 0) {
+	status = tarStreamSubFileClose (rsComm, subInx);
+    } else {
+        fileCloseInp.fileInx = TarSubFileDesc[subInx].fd;
+        status = rsFileClose (rsComm, &fileCloseInp);
+    }
 
     structFileInx = TarSubFileDesc[subInx].structFileInx;
     StructFileDesc[structFileInx].openCnt++;
@@ -299,6 +312,10 @@ rodsStat_t **subStructFileStatOut)
     fileStatInp_t fileStatInp;
 
     specColl = subFile->specColl;
+    if (chkTarStreamRead (rsComm, specColl, &structFileInx) > 0) {
+	return tarStreamSubFileStat (rsComm, structFileInx, subFile,
+	  subStructFileStatOut);
+    }
     structFileInx = rsTarStructFileOpen (rsComm, specColl);
 
     if (structFileInx < 0) {
@@ -341,6 +358,9 @@ rodsStat_t **subStructFileStatOut)
         return (SYS_STRUCT_FILE_DESC_ERR);
     }
 
+    if (TarSubFileDesc[subInx].streamFlag > 0)
+	return tarStreamSubFileFstat (rsComm, subInx, subStructFileStatOut);
+
     memset (&fileFstatInp, 0, sizeof (fileFstatInp));
     fileFstatInp.fileInx = TarSubFileDesc[subInx].fd;
     status = rsFileFstat (rsComm, &fileFstatInp, subStructFileStatOut);
@@ -363,6 +383,9 @@ int whence)
         return (SYS_STRUCT_FILE_DESC_ERR);
     }
 
+    if (TarSubFileDesc[subInx].streamFlag > 0)
+	return tarStreamSubFileLseek (rsComm, subInx, offset, whence);
+
     memset (&fileLseekInp, 0, sizeof (fileLseekInp));
     fileLseekInp.fileInx = TarSubFileDesc[subInx].fd;
     fileLseekInp.offset = offset;
@@ -725,6 +748,7 @@ tarStructFileSync (rsComm_t *rsComm, structFileOprInp_t *structFileOprInp)
     specColl = StructFileDesc[structFileInx].specColl;
     if ((structFileOprInp->oprType & DELETE_STRUCT_FILE) != 0) {
 	/* remove cache and the struct file */
+	freeTarIndex (structFileInx);
 	freeStructFileDesc (structFileInx);
 	return (status);
     }
@@ -839,6 +863,35 @@ tarStructFileExtract (rsComm_t *rsComm, structFileOprInp_t *structFileOprInp)
 
 int
 rsTarStructFileOpen (rsComm_t *rsComm, specColl_t *specColl)
+{
+    int structFileInx;
+    int matchFlag;
+    int status;
+
+    /* an opened desc is shared with its other users. don't free it */
+    matchFlag = specColl != NULL && matchStructFileDesc (specColl) > 0;
+
+    structFileInx = openTarStructFileDesc (rsComm, specColl);
+    if (structFileInx < 0) return structFileInx;
+
+    /* XXXXX need to deal with remote open here */
+
+    /* the desc may have been opened for streaming without a cacheDir */
+    status = stageTarStructFile (structFileInx);
+
+    if (status < 0) {
+	if (matchFlag == 0) freeStructFileDesc (structFileInx);
+	return status;
+    }
+
+    return (structFileInx);
+}
+
+/* openTarStructFileDesc - match or set up the StructFileDesc of specColl
+ * without staging the tar file to the cacheDir */
+
+int
+openTarStructFileDesc (rsComm_t *rsComm, specColl_t *specColl)
 {
     int structFileInx;
     int status;
@@ -846,7 +899,7 @@ rsTarStructFileOpen (rsComm_t *rsComm, specColl_t *specColl)
 
     if (specColl == NULL) {
         rodsLog (LOG_NOTICE,
-         "rsTarStructFileOpen: NULL specColl input");
+         "openTarStructFileDesc: NULL specColl input");
         return (SYS_INTERNAL_NULL_INPUT_ERR);
     }
 
@@ -859,6 +912,7 @@ rsTarStructFileOpen (rsComm_t *rsComm, specColl_t *specColl)
     if ((structFileInx = allocStructFileDesc ()) < 0) {
         return (structFileInx);
     }
+    freeTarIndex (structFileInx);
 
     /* Have to do this because specColl could come from a remote host */
     if ((status = getSpecCollCache (rsComm, specColl->collection, 0,
@@ -884,21 +938,12 @@ rsTarStructFileOpen (rsComm_t *rsComm, specColl_t *specColl)
 
     if (status < 0) {
         rodsLog (LOG_NOTICE,
-          "rsTarStructFileOpen: resolveResc error for %s, status = %d",
+          "openTarStructFileDesc: resolveResc error for %s, status = %d",
           specColl->resource, status);
 	freeStructFileDesc (structFileInx);
         return (status);
     }
 
-    /* XXXXX need to deal with remote open here */
-
-    status = stageTarStructFile (structFileInx);
-
-    if (status < 0) {
-	freeStructFileDesc (structFileInx);
-	return status;
-    }
-
     return (structFileInx);
 }
 
@@ -1392,6 +1437,9 @@ syncCacheDirToTarfile (int structFileInx, int oprType)
 #else
 	return SYS_ZIP_FORMAT_NOT_SUPPORTED;
 #endif
+    } else if (isTarStreamDataType (StructFileDesc[structFileInx].dataType)) {
+	/* plain tar. one pass, no tar process */
+        status = bundleCacheDirWithStream (structFileInx, oprType);
     } else {
 #ifdef TAR_EXEC_PATH
         status = bundleCacheDirWithExec (structFileInx, oprType);
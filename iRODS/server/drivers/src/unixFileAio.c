@@ -0,0 +1,507 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* unixFileAio.c - asynchronous reads and writes of unix vault files with
+ * io_uring. A transfer thread owns one unixAio_t, i.e. one ring and
+ * depth aligned buffers (slots). Each slot has at most one read or write
+ * in flight, so the thread can receive the next buffer from the network
+ * while the previous ones are still written to disk (write behind), or
+ * send a buffer while the next ones are read (read ahead).
+ *
+ * The ring is driven with the raw syscalls so no liburing is needed.
+ * Without UNIX_IO_URING (see config.mk), or when the kernel refuses the
+ * ring, unixAioInit fails and the caller uses the synchronous
+ * _l3Read/_l3Write path.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE		/* O_DIRECT */
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#ifdef UNIX_IO_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#include "unixFileAio.h"
+#include "rodsLog.h"
+#include "rodsErrorTable.h"
+
+static int UnixAioDepth = -1;
+static rodsLong_t UnixAioDirectSize = -1;
+
+int
+getUnixAioDepth ()
+{
+    char *tmpStr;
+    int depth;
+
+    if (UnixAioDepth >= 0) return UnixAioDepth;
+
+    if ((tmpStr = getenv (UNIX_AIO_DEPTH_ENV)) != NULL) {
+        depth = atoi (tmpStr);
+    } else {
+        depth = DEF_UNIX_AIO_DEPTH;
+    }
+    if (depth < 0) {
+        depth = 0;
+    } else if (depth == 1) {
+        /* nothing would overlap */
+        depth = 0;
+    } else if (depth > MAX_UNIX_AIO_DEPTH) {
+        depth = MAX_UNIX_AIO_DEPTH;
+    }
+    UnixAioDepth = depth;
+    return UnixAioDepth;
+}
+
+rodsLong_t
+getUnixAioDirectSize ()
+{
+    char *tmpStr;
+    rodsLong_t directSize = 0;
+
+    if (UnixAioDirectSize >= 0) return UnixAioDirectSize;
+
+    if ((tmpStr = getenv (UNIX_AIO_DIRECT_ENV)) != NULL) {
+        directSize = strtoll (tmpStr, 0, 0);
+        if (directSize < 0) directSize = 0;
+    }
+    UnixAioDirectSize = directSize;
+    return UnixAioDirectSize;
+}
+
+#ifdef UNIX_IO_URING
+
+static int UnixAioNoRingLogged = 0;
+
+static int
+unixAioEnter (unixAio_t *aio, unsigned int toSubmit, unsigned int minComplete)
+{
+    int status;
+    unsigned int flags = 0;
+
+    if (minComplete > 0) flags |= IORING_ENTER_GETEVENTS;
+    while (1) {
+        status = syscall (__NR_io_uring_enter, aio->ringFd, toSubmit,
+          minComplete, flags, NULL, 0);
+        if (status >= 0 || errno != EINTR) break;
+    }
+    if (status < 0) {
+        status = UNIX_FILE_AIO_ERR - errno;
+        rodsLog (LOG_ERROR, "unixAioEnter: io_uring_enter error, status = %d",
+          status);
+    }
+    return status;
+}
+
+static int
+unixAioSetupRing (unixAio_t *aio)
+{
+    struct io_uring_params params;
+    char *sqPtr, *cqPtr;
+
+    memset (&params, 0, sizeof (params));
+    aio->ringFd = syscall (__NR_io_uring_setup, aio->depth, &params);
+    if (aio->ringFd < 0) {
+        return SYS_NOT_SUPPORTED - errno;
+    }
+
+    aio->sqSz = params.sq_off.array + params.sq_entries * sizeof (unsigned);
+    aio->cqSz = params.cq_off.cqes +
+      params.cq_entries * sizeof (struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (aio->cqSz > aio->sqSz) aio->sqSz = aio->cqSz;
+        aio->cqSz = 0;
+    }
+    aio->sqPtr = mmap (0, aio->sqSz, PROT_READ|PROT_WRITE,
+      MAP_SHARED|MAP_POPULATE, aio->ringFd, IORING_OFF_SQ_RING);
+    if (aio->sqPtr == MAP_FAILED) {
+        aio->sqPtr = NULL;
+        return SYS_NOT_SUPPORTED - errno;
+    }
+    if (aio->cqSz == 0) {
+        aio->cqPtr = aio->sqPtr;
+    } else {
+        aio->cqPtr = mmap (0, aio->cqSz, PROT_READ|PROT_WRITE,
+          MAP_SHARED|MAP_POPULATE, aio->ringFd, IORING_OFF_CQ_RING);
+        if (aio->cqPtr == MAP_FAILED) {
+            aio->cqPtr = NULL;
+            return SYS_NOT_SUPPORTED - errno;
+        }
+    }
+    aio->sqesSz = params.sq_entries * sizeof (struct io_uring_sqe);
+    aio->sqes = mmap (0, aio->sqesSz, PROT_READ|PROT_WRITE,
+      MAP_SHARED|MAP_POPULATE, aio->ringFd, IORING_OFF_SQES);
+    if (aio->sqes == MAP_FAILED) {
+        aio->sqes = NULL;
+        return SYS_NOT_SUPPORTED - errno;
+    }
+
+    sqPtr = (char *) aio->sqPtr;
+    cqPtr = (char *) aio->cqPtr;
+    aio->sqTail = (unsigned *) (sqPtr + params.sq_off.tail);
+    aio->sqMask = (unsigned *) (sqPtr + params.sq_off.ring_mask);
+    aio->sqArray = (unsigned *) (sqPtr + params.sq_off.array);
+    aio->cqHead = (unsigned *) (cqPtr + params.cq_off.head);
+    aio->cqTail = (unsigned *) (cqPtr + params.cq_off.tail);
+    aio->cqMask = (unsigned *) (cqPtr + params.cq_off.ring_mask);
+    aio->cqes = cqPtr + params.cq_off.cqes;
+
+    return 0;
+}
+
+static int
+unixAioSubmit (unixAio_t *aio, int slot, int opr, int fd, int len,
+rodsLong_t offset)
+{
+    struct io_uring_sqe *sqe;
+    struct iovec *iov;
+    unsigned int tail, index;
+    int status;
+
+    if (slot < 0 || slot >= aio->depth) return SYS_INVALID_INPUT_PARAM;
+    if (aio->opr[slot] != 0) {
+        /* the buffer is still in use */
+        status = unixAioWait (aio, slot);
+        if (status < 0) return status;
+    }
+    if (len > aio->bufSize) return SYS_INVALID_INPUT_PARAM;
+
+    iov = (struct iovec *) aio->iov + slot;
+    iov->iov_base = aio->buf[slot];
+    iov->iov_len = len;
+
+    tail = *aio->sqTail;
+    index = tail & *aio->sqMask;
+    sqe = (struct io_uring_sqe *) aio->sqes + index;
+    memset (sqe, 0, sizeof (struct io_uring_sqe));
+    if (opr == UNIX_AIO_READ) {
+        sqe->opcode = IORING_OP_READV;
+    } else {
+        sqe->opcode = IORING_OP_WRITEV;
+    }
+    sqe->fd = fd;
+    sqe->off = offset;
+    sqe->addr = (unsigned long) iov;
+    sqe->len = 1;
+    sqe->user_data = slot;
+    aio->sqArray[index] = index;
+    __atomic_store_n (aio->sqTail, tail + 1, __ATOMIC_RELEASE);
+
+    aio->opr[slot] = opr;
+    aio->len[slot] = len;
+    aio->result[slot] = 0;
+
+    status = unixAioEnter (aio, 1, 0);
+    if (status < 0) {
+        aio->opr[slot] = 0;
+        return status;
+    }
+    return 0;
+}
+
+/* unixAioReap - wait for one completion and record its result */
+static int
+unixAioReap (unixAio_t *aio)
+{
+    struct io_uring_cqe *cqe;
+    unsigned int head;
+    int slot, res;
+    int status;
+
+    head = *aio->cqHead;
+    while (head == __atomic_load_n (aio->cqTail, __ATOMIC_ACQUIRE)) {
+        status = unixAioEnter (aio, 0, 1);
+        if (status < 0) return status;
+    }
+    cqe = (struct io_uring_cqe *) aio->cqes + (head & *aio->cqMask);
+    slot = (int) cqe->user_data;
+    res = cqe->res;
+    __atomic_store_n (aio->cqHead, head + 1, __ATOMIC_RELEASE);
+
+    if (slot < 0 || slot >= aio->depth || aio->opr[slot] == 0) {
+        rodsLog (LOG_ERROR, "unixAioReap: unexpected completion %d", slot);
+        return UNIX_FILE_AIO_ERR;
+    }
+    if (res < 0) {
+        if (aio->opr[slot] == UNIX_AIO_READ) {
+            res = UNIX_FILE_READ_ERR + res;
+        } else {
+            res = UNIX_FILE_WRITE_ERR + res;
+        }
+        rodsLog (LOG_NOTICE, "unixAioReap: %s error, status = %d",
+          aio->opr[slot] == UNIX_AIO_READ ? "read" : "write", res);
+    } else if (aio->opr[slot] == UNIX_AIO_WRITE && res != aio->len[slot]) {
+        rodsLog (LOG_NOTICE,
+          "unixAioReap: %d bytes written instead of %d",
+          res, aio->len[slot]);
+        res = SYS_COPY_LEN_ERR;
+    }
+    aio->result[slot] = res;
+    aio->opr[slot] = 0;
+    return 0;
+}
+
+#endif	/* UNIX_IO_URING */
+
+/* unixAioInit - set up the ring and the buffers of aio. Returns
+ * SYS_NOT_SUPPORTED (- errno) if the asynchronous path cannot be used.
+ */
+int
+unixAioInit (unixAio_t *aio)
+{
+#ifdef UNIX_IO_URING
+    int i, status;
+    int bufSize;
+
+    memset (aio, 0, sizeof (unixAio_t));
+    aio->ringFd = -1;
+    aio->depth = getUnixAioDepth ();
+    if (aio->depth <= 0) return SYS_NOT_SUPPORTED;
+
+    /* the memory of the synchronous path, split in depth buffers */
+    bufSize = MIN_UNIX_AIO_BUF_SZ;
+    while (bufSize * 2 * aio->depth <= TRANS_BUF_SZ) bufSize *= 2;
+    aio->bufSize = bufSize;
+
+    status = unixAioSetupRing (aio);
+    if (status < 0) {
+        if (UnixAioNoRingLogged == 0) {
+            UnixAioNoRingLogged = 1;
+            rodsLog (LOG_NOTICE,
+              "unixAioInit: io_uring not available, status = %d", status);
+        }
+        unixAioEnd (aio);
+        return status;
+    }
+
+    aio->iov = calloc (aio->depth, sizeof (struct iovec));
+    for (i = 0; i < aio->depth; i++) {
+        if (posix_memalign ((void **) &aio->buf[i], UNIX_AIO_ALIGN,
+          aio->bufSize) != 0) {
+            aio->buf[i] = NULL;
+            unixAioEnd (aio);
+            return SYS_MALLOC_ERR;
+        }
+    }
+    return 0;
+#else
+    memset (aio, 0, sizeof (unixAio_t));
+    aio->ringFd = -1;
+    return SYS_NOT_SUPPORTED;
+#endif
+}
+
+int
+unixAioRead (unixAio_t *aio, int slot, int fd, int len, rodsLong_t offset)
+{
+#ifdef UNIX_IO_URING
+    return unixAioSubmit (aio, slot, UNIX_AIO_READ, fd, len, offset);
+#else
+    return SYS_NOT_SUPPORTED;
+#endif
+}
+
+int
+unixAioWrite (unixAio_t *aio, int slot, int fd, int len, rodsLong_t offset)
+{
+#ifdef UNIX_IO_URING
+    return unixAioSubmit (aio, slot, UNIX_AIO_WRITE, fd, len, offset);
+#else
+    return SYS_NOT_SUPPORTED;
+#endif
+}
+
+/* unixAioWait - wait for the op of slot. Returns the bytes read or
+ * written, or an error.
+ */
+int
+unixAioWait (unixAio_t *aio, int slot)
+{
+#ifdef UNIX_IO_URING
+    int status;
+
+    if (slot < 0 || slot >= aio->depth) return SYS_INVALID_INPUT_PARAM;
+    while (aio->opr[slot] != 0) {
+        status = unixAioReap (aio);
+        if (status < 0) return status;
+    }
+    return aio->result[slot];
+#else
+    return SYS_NOT_SUPPORTED;
+#endif
+}
+
+/* unixAioWaitAll - wait for all the ops in flight. Returns the first
+ * error of a slot, else 0.
+ */
+int
+unixAioWaitAll (unixAio_t *aio)
+{
+    int i, status;
+    int savedStatus = 0;
+
+    for (i = 0; i < aio->depth; i++) {
+        status = unixAioWait (aio, i);
+        if (status < 0 && savedStatus == 0) savedStatus = status;
+    }
+    return savedStatus;
+}
+
+/* unixAioNextBuf and unixAioWriteNext - the write behind loop. Get the
+ * buffer of the next slot (waiting for the write it had), fill it and
+ * queue its write. A failed earlier write is returned in status.
+ */
+char *
+unixAioNextBuf (unixAio_t *aio, int *status)
+{
+    *status = unixAioWait (aio, aio->cur);
+    if (*status < 0) return NULL;
+    *status = 0;
+    return aio->buf[aio->cur];
+}
+
+int
+unixAioWriteNext (unixAio_t *aio, int fd, int len, rodsLong_t offset)
+{
+    int status;
+
+    status = unixAioWrite (aio, aio->cur, fd, len, offset);
+    aio->cur = (aio->cur + 1) % aio->depth;
+    return status;
+}
+
+/* unixAioReadAhead, unixAioReadNext and unixAioRefill - the read ahead
+ * loop. unixAioReadAhead queues reads of size bytes of fd from offset
+ * in all the slots. unixAioReadNext waits for the oldest read and
+ * returns its buffer, and unixAioRefill queues the next read in that
+ * slot once the buffer is no longer needed. With alignFlag, the first
+ * read stops at an UNIX_AIO_ALIGN boundary so all the other reads are
+ * aligned (for O_DIRECT writes of the buffers).
+ */
+int
+unixAioReadAhead (unixAio_t *aio, int fd, rodsLong_t offset, rodsLong_t size,
+int alignFlag)
+{
+    int i, len, status;
+
+    aio->aheadFd = fd;
+    aio->aheadOffset = offset;
+    aio->aheadEnd = offset + size;
+    aio->cur = 0;
+
+    for (i = 0; i < aio->depth; i++) {
+        if (aio->aheadOffset >= aio->aheadEnd) break;
+        len = aio->bufSize;
+        if (i == 0 && alignFlag > 0 && offset % UNIX_AIO_ALIGN != 0)
+            len = UNIX_AIO_ALIGN - offset % UNIX_AIO_ALIGN;
+        if (len > aio->aheadEnd - aio->aheadOffset)
+            len = aio->aheadEnd - aio->aheadOffset;
+        status = unixAioRead (aio, i, fd, len, aio->aheadOffset);
+        if (status < 0) return status;
+        aio->aheadOffset += len;
+    }
+    return 0;
+}
+
+char *
+unixAioReadNext (unixAio_t *aio, int *slot, int *bytesRead)
+{
+    *slot = aio->cur;
+    *bytesRead = unixAioWait (aio, aio->cur);
+    aio->cur = (aio->cur + 1) % aio->depth;
+    if (*bytesRead < 0) return NULL;
+    return aio->buf[*slot];
+}
+
+int
+unixAioRefill (unixAio_t *aio, int slot)
+{
+    int len, status;
+
+    if (aio->aheadOffset >= aio->aheadEnd) return 0;
+    len = aio->bufSize;
+    if (len > aio->aheadEnd - aio->aheadOffset)
+        len = aio->aheadEnd - aio->aheadOffset;
+    status = unixAioRead (aio, slot, aio->aheadFd, len, aio->aheadOffset);
+    if (status < 0) return status;
+    aio->aheadOffset += len;
+    return 0;
+}
+
+/* unixAioEnd - wait for the ops in flight and free aio. Returns the
+ * status of unixAioWaitAll.
+ */
+int
+unixAioEnd (unixAio_t *aio)
+{
+    int status = 0;
+#ifdef UNIX_IO_URING
+    int i;
+
+    if (aio->sqes != NULL) status = unixAioWaitAll (aio);
+    for (i = 0; i < aio->depth; i++) {
+        if (aio->buf[i] != NULL) {
+            free (aio->buf[i]);
+            aio->buf[i] = NULL;
+        }
+    }
+    if (aio->iov != NULL) {
+        free (aio->iov);
+        aio->iov = NULL;
+    }
+    if (aio->sqes != NULL) munmap (aio->sqes, aio->sqesSz);
+    if (aio->cqPtr != NULL && aio->cqPtr != aio->sqPtr)
+        munmap (aio->cqPtr, aio->cqSz);
+    if (aio->sqPtr != NULL) munmap (aio->sqPtr, aio->sqSz);
+    aio->sqes = aio->cqPtr = aio->sqPtr = NULL;
+    if (aio->ringFd >= 0) {
+        close (aio->ringFd);
+        aio->ringFd = -1;
+    }
+#endif
+    return status;
+}
+
+/* unixAioOpenDirect - open fileName again with O_DIRECT for the aligned
+ * writes of a large stream. Returns -1 if the file system refuses it.
+ */
+int
+unixAioOpenDirect (char *fileName, int flags)
+{
+#if defined(UNIX_IO_URING) && defined(O_DIRECT)
+    int fd;
+
+    fd = open (fileName, flags | O_DIRECT, 0);
+    if (fd < 0) {
+        rodsLog (LOG_DEBUG,
+          "unixAioOpenDirect: O_DIRECT open of %s failed, errno = %d",
+          fileName, errno);
+        return -1;
+    }
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+/* unixAioFd - the fd for a write of len bytes at offset: directFd if
+ * it is open and the write is aligned, else fd */
+int
+unixAioFd (int fd, int directFd, int len, rodsLong_t offset)
+{
+    if (directFd >= 0 && len % UNIX_AIO_ALIGN == 0 &&
+      offset % UNIX_AIO_ALIGN == 0) {
+        return directFd;
+    }
+    return fd;
+}
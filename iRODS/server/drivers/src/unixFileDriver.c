@@ -220,6 +220,81 @@ nbFileWrite (rsComm_t *rsComm, int fd, void *buf, int len)
     return (len);
 }
 
+/* unixFilePread, unixFilePwrite and unixFilePreadv - positional I/O.
+ * The file offset of fd is not used or changed, so the parallel transfer
+ * threads can share one fd.
+ */
+
+int
+unixFilePread (rsComm_t *rsComm, int fd, void *buf, int len, 
+rodsLong_t offset)
+{
+    int status;
+
+    status = pread (fd, buf, len, (off_t) offset);
+
+    if (status < 0) {
+        status = UNIX_FILE_READ_ERR - errno;
+        rodsLog (LOG_NOTICE, 
+          "unixFilePread: pread error fd = %d, offset = %lld, status = %d",
+         fd, offset, status);
+    }
+    return (status);
+}
+
+int
+unixFilePwrite (rsComm_t *rsComm, int fd, void *buf, int len, 
+rodsLong_t offset)
+{
+    int status;
+
+    if (len == 0) {
+        status = 0;
+    } else {
+        status = pwrite (fd, buf, len, (off_t) offset);
+    }
+
+    if (status < 0) {
+        status = UNIX_FILE_WRITE_ERR - errno;
+        rodsLog (LOG_NOTICE, 
+          "unixFilePwrite: pwrite error fd = %d, offset = %lld, status = %d",
+         fd, offset, status);
+    }
+    return (status);
+}
+
+int
+unixFilePreadv (rsComm_t *rsComm, int fd, struct iovec *iov, int iovcnt, 
+rodsLong_t offset)
+{
+    int status;
+#if defined(linux_platform)
+    status = preadv (fd, iov, iovcnt, (off_t) offset);
+#else
+    int i, nbytes;
+
+    status = 0;
+    for (i = 0; i < iovcnt; i++) {
+        nbytes = pread (fd, iov[i].iov_base, iov[i].iov_len, 
+          (off_t) (offset + status));
+        if (nbytes < 0) {
+            if (status == 0) status = nbytes;
+            break;
+        }
+        status += nbytes;
+        if (nbytes < (int) iov[i].iov_len) break;
+    }
+#endif
+
+    if (status < 0) {
+        status = UNIX_FILE_READ_ERR - errno;
+        rodsLog (LOG_NOTICE, 
+          "unixFilePreadv: preadv error fd = %d, offset = %lld, status = %d",
+         fd, offset, status);
+    }
+    return (status);
+}
+
 int
 unixFileClose (rsComm_t *rsComm, int fd)
 {
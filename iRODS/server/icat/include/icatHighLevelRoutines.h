@@ -53,6 +53,7 @@ int chlGeneralUpdate(generalUpdateInp_t generalUpdateInp);
 
 int chlDelCollByAdmin(rsComm_t *rsComm, collInfo_t *collInfo);
 int chlDelColl(rsComm_t *rsComm, collInfo_t *collInfo);
+int chlDelCollTree(rsComm_t *rsComm, collInfo_t *collInfo, int adminFlag);
 int chlCheckAuth(rsComm_t *rsComm, char *challenge, char *response,
     char *username, int *userPrivLevel, int *clientPrivLevel);
 int chlMakeTempPw(rsComm_t *rsComm, char *pwValueToHash, char *otherUser);
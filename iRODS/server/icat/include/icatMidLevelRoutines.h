@@ -12,6 +12,20 @@
 #include "rodsType.h"
 #include "icatStructs.h"
 
+/* The access check cache of cmlCheckDir, cmlCheckDirAndGetInheritFlag
+   and cmlCheckDataObjOnly. Granted accesses are remembered for
+   ACCESS_CACHE_TTL seconds (env variable, 0 disables it). Changes of
+   permissions, groups and names in this agent invalidate it. */
+#define ACCESS_CACHE_TTL	"accessCacheTTL"
+#define DEF_ACCESS_CACHE_TTL	5
+#define ACCESS_CACHE_SIZE	256	/* number of entries. Power of 2 */
+
+/* The number of R_ObjectID values cmlGetNextSeqValFromBlock reserves
+   with one query (env variable, 1 disables the block) */
+#define SEQ_ID_BLOCK_SIZE	"seqIdBlockSize"
+#define DEF_SEQ_ID_BLOCK_SIZE	20
+#define MAX_SEQ_ID_BLOCK_SIZE	1000
+
 int cmlOpen(icatSessionStruct *icss);
 
 int cmlClose( icatSessionStruct *icss);
@@ -160,6 +174,8 @@ rodsLong_t cmlGetCurrentSeqVal(icatSessionStruct *icss);
 
 int cmlGetNextSeqStr(char *seqStr, int maxSeqStrLen, icatSessionStruct *icss);
 
+rodsLong_t cmlGetNextSeqValFromBlock(icatSessionStruct *icss);
+
 rodsLong_t cmlCheckDir( char *dirName, char *userName, char *userZone, 
 			char *accessLevel, icatSessionStruct *icss);
 
@@ -200,6 +216,8 @@ int cmlGetGroupMemberCount(char *groupName, icatSessionStruct *icss);
 
 int cmlDebug(int mode);
 
+void cmlInvalidateAccessCache();
+
 int cmlAudit1(int actionId, char *clientUser, char *zone, char *targetUser, 
 	      char *comment, icatSessionStruct *icss);
 
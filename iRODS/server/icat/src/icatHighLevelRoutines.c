@@ -646,9 +646,9 @@ int chlRegDataObj(rsComm_t *rsComm, dataObjInfo_t *dataObjInfo) {
    }
 
    if (logSQL!=0) rodsLog(LOG_SQL, "chlRegDataObj SQL 1 ");
-   seqNum = cmlGetNextSeqVal(&icss);
+   seqNum = cmlGetNextSeqValFromBlock(&icss);
    if (seqNum < 0) {
-      rodsLog(LOG_NOTICE, "chlRegDataObj cmlGetNextSeqVal failure %d",
+      rodsLog(LOG_NOTICE, "chlRegDataObj cmlGetNextSeqValFromBlock failure %d",
 	      seqNum);
       _rollback("chlRegDataObj");
       return(seqNum);
@@ -1077,6 +1077,8 @@ int chlUnregDataObj (rsComm_t *rsComm, dataObjInfo_t *dataObjInfo,
    dataObjNumber[0]='\0';
    if (logSQL!=0) rodsLog(LOG_SQL, "chlUnregDataObj");
 
+   cmlInvalidateAccessCache();
+
    if (!icss.status) {
       return(CATALOG_NOT_CONNECTED);
    }
@@ -1266,9 +1268,9 @@ int chlRegRuleExec(rsComm_t *rsComm,
    }
 
    if (logSQL!=0) rodsLog(LOG_SQL, "chlRegRuleExec SQL 1 ");
-   seqNum = cmlGetNextSeqVal(&icss);
+   seqNum = cmlGetNextSeqValFromBlock(&icss);
    if (seqNum < 0) {
-      rodsLog(LOG_NOTICE, "chlRegRuleExec cmlGetNextSeqVal failure %d",
+      rodsLog(LOG_NOTICE, "chlRegRuleExec cmlGetNextSeqValFromBlock failure %d",
 	      seqNum);
       _rollback("chlRegRuleExec");
       return(seqNum);
@@ -1853,6 +1855,8 @@ int chlDelUserRE(rsComm_t *rsComm, userInfo_t *userInfo) {
 
    if (logSQL!=0) rodsLog(LOG_SQL, "chlDelUserRE");
 
+   cmlInvalidateAccessCache();
+
    if (rsComm->clientUser.authInfo.authFlag < LOCAL_PRIV_USER_AUTH) {
       return(CAT_INSUFFICIENT_PRIVILEGE_LEVEL);
    }
@@ -2183,9 +2187,7 @@ int chlRegColl(rsComm_t *rsComm, collInfo_t *collInfo) {
    char logicalParentDirName[MAX_NAME_LEN];
    rodsLong_t iVal;
    char collIdNum[MAX_NAME_LEN];
-   char nextStr[MAX_NAME_LEN];
-   char currStr[MAX_NAME_LEN];
-   char currStr2[MAX_SQL_SIZE];
+   char newCollIdNum[MAX_NAME_LEN];
    rodsLong_t status;
    char tSQL[MAX_SQL_SIZE];
    int inheritFlag;
@@ -2237,8 +2239,15 @@ int chlRegColl(rsComm_t *rsComm, collInfo_t *collInfo) {
    }
 
 
-   /* String to get next sequence item for objects */
-   cllNextValueString("R_ObjectID", nextStr, MAX_NAME_LEN);
+   /* The id of the new collection, from the agent-local block */
+   status = cmlGetNextSeqValFromBlock(&icss);
+   if (status < 0) {
+      rodsLog(LOG_NOTICE, "chlRegColl cmlGetNextSeqValFromBlock failure %d",
+	      status);
+      _rollback("chlRegColl");
+      return(status);
+   }
+   snprintf(newCollIdNum, MAX_NAME_LEN, "%lld", status);
 
    getNowStr(myTime);
 
@@ -2269,7 +2278,7 @@ int chlRegColl(rsComm_t *rsComm, collInfo_t *collInfo) {
    if (logSQL!=0) rodsLog(LOG_SQL, "chlRegColl SQL 3");
    snprintf(tSQL, MAX_SQL_SIZE, 
 	    "insert into R_COLL_MAIN (coll_id, parent_coll_name, coll_name, coll_owner_name, coll_owner_zone, coll_type, coll_info1, coll_info2, create_ts, modify_ts) values (%s, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
-	    nextStr);
+	    newCollIdNum);
    status =  cmlExecuteNoAnswerSql(tSQL,
 				   &icss);
    if (status != 0) {
@@ -2279,10 +2288,6 @@ int chlRegColl(rsComm_t *rsComm, collInfo_t *collInfo) {
       return(status);
    }
 
-   /* String to get current sequence item for objects */
-   cllCurrentValueString("R_ObjectID", currStr, MAX_NAME_LEN);
-   snprintf(currStr2, MAX_SQL_SIZE, " %s ", currStr);
-
    if (inheritFlag) {
       /* If inherit is set (sticky bit), then add access rows for this
          collection that match those of the parent collection */
@@ -2293,41 +2298,19 @@ int chlRegColl(rsComm_t *rsComm, collInfo_t *collInfo) {
       if (logSQL!=0) rodsLog(LOG_SQL, "chlRegColl SQL 4");
       snprintf(tSQL, MAX_SQL_SIZE, 
 	       "insert into R_OBJT_ACCESS (object_id, user_id, access_type_id, create_ts, modify_ts) (select %s, user_id, access_type_id, ?, ? from R_OBJT_ACCESS where object_id = ?)",
-	       currStr2);
+	       newCollIdNum);
       status =  cmlExecuteNoAnswerSql(tSQL, &icss);
 
       if (status == 0) {
 	 if (logSQL!=0) rodsLog(LOG_SQL, "chlRegColl SQL 5");
-#if ORA_ICAT
-	 char newCollectionID[MAX_NAME_LEN];
-	 /* 
-	    For Oracle, we can't use currStr2 string in a where clause so
-	    do another query to get the new collection id.
-	 */
-	 status = cmlGetCurrentSeqVal(&icss);
-
-	 if (status > 0) {
-	    /* And then use it in the where clause for the update */
-	    snprintf(newCollectionID, MAX_SQL_SIZE, "%lld", status);
-	    cllBindVars[cllBindVarCount++]="1";
-	    cllBindVars[cllBindVarCount++]=myTime;
-	    cllBindVars[cllBindVarCount++]=newCollectionID;
-	    status =  cmlExecuteNoAnswerSql(
-		      "update R_COLL_MAIN set coll_inheritance=?, modify_ts=? where coll_id=?",
-		      &icss);
-	 }
-#else
-	 /*
-	   For Postgres we can, use the currStr2 to get the current id
-	   and save a SQL interaction.
-	 */
+	 /* The new collection id is known, so the update can use it
+	    directly on all databases */
 	 cllBindVars[cllBindVarCount++]="1";
 	 cllBindVars[cllBindVarCount++]=myTime;
-	 snprintf(tSQL, MAX_SQL_SIZE, 
-		 "update R_COLL_MAIN set coll_inheritance=?, modify_ts=? where coll_id=%s",
-		  currStr2);
-	 status =  cmlExecuteNoAnswerSql(tSQL, &icss);
-#endif
+	 cllBindVars[cllBindVarCount++]=newCollIdNum;
+	 status =  cmlExecuteNoAnswerSql(
+		   "update R_COLL_MAIN set coll_inheritance=?, modify_ts=? where coll_id=?",
+		   &icss);
       }
    }
    else {
@@ -2338,7 +2321,7 @@ int chlRegColl(rsComm_t *rsComm, collInfo_t *collInfo) {
       cllBindVars[cllBindVarCount++]=myTime;
       snprintf(tSQL, MAX_SQL_SIZE, 
 	    "insert into R_OBJT_ACCESS values (%s, (select user_id from R_USER_MAIN where user_name=? and zone_name=?), (select token_id from R_TOKN_MAIN where token_namespace = 'access_type' and token_name = ?), ?, ?)",
-	    currStr2);
+	    newCollIdNum);
       if (logSQL!=0) rodsLog(LOG_SQL, "chlRegColl SQL 6");
       status =  cmlExecuteNoAnswerSql(tSQL, &icss);
    }
@@ -2366,7 +2349,7 @@ int chlRegColl(rsComm_t *rsComm, collInfo_t *collInfo) {
        cllBindVars[cllBindVarCount++]=myTime;
        snprintf(tSQL, MAX_SQL_SIZE,
                 "insert into R_OBJT_FILESYSTEM_META (object_id, file_uid, file_gid, file_owner, file_group, file_mode, file_ctime, file_mtime, file_source_path, create_ts, modify_ts) values (%s, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
-                currStr2);
+                newCollIdNum);
        if (logSQL) rodsLog(LOG_SQL, "chlRegColl xSQL 1");
        status = cmlExecuteNoAnswerSql(tSQL, &icss);
        if (status != 0) {
@@ -2381,7 +2364,7 @@ int chlRegColl(rsComm_t *rsComm, collInfo_t *collInfo) {
 
    /* Audit */
    status = cmlAudit4(AU_REGISTER_COLL,  
-		      currStr2,
+		      newCollIdNum,
 		      "",
 		      rsComm->clientUser.userName,
 		      rsComm->clientUser.rodsZone,
@@ -2780,6 +2763,8 @@ int chlRenameLocalZone(rsComm_t *rsComm, char *oldZoneName, char *newZoneName) {
 
    if (logSQL!=0) rodsLog(LOG_SQL, "chlRenameLocalZone");
 
+   cmlInvalidateAccessCache();
+
    if (!icss.status) {
       return(CATALOG_NOT_CONNECTED);
    }
@@ -3206,6 +3191,8 @@ int chlDelCollByAdmin(rsComm_t *rsComm, collInfo_t *collInfo) {
 
    if (logSQL!=0) rodsLog(LOG_SQL, "chlDelCollByAdmin");
 
+   cmlInvalidateAccessCache();
+
    if (!icss.status) {
       return(CATALOG_NOT_CONNECTED);
    }
@@ -3326,6 +3313,8 @@ int chlDelColl(rsComm_t *rsComm, collInfo_t *collInfo) {
 
    if (logSQL!=0) rodsLog(LOG_SQL, "chlDelColl");
 
+   cmlInvalidateAccessCache();
+
    status = _delColl(rsComm, collInfo);
    if (status != 0) return(status);
 
@@ -3475,6 +3464,266 @@ static int _delColl(rsComm_t *rsComm, collInfo_t *collInfo) {
    return(status);
 }
 
+/* Delete a Collection and everything below it with set based SQL.
+   The caller is responsible for the vault files of the deleted replicas
+   (it must get the list before calling this) and for the commit.
+   The permission is checked once over the whole subtree: the user needs
+   DELETE or better on every collection and data object below collName,
+   unless adminFlag is set (rmtrash by admin) in which case a privileged
+   user is needed.  Subtrees with mounted or linked collections are not
+   handled here (SYS_NOT_SUPPORTED); the caller falls back to the per
+   object removal for those.
+*/
+int chlDelCollTree(rsComm_t *rsComm, collInfo_t *collInfo, int adminFlag) {
+   rodsLong_t iVal;
+   char logicalEndName[MAX_NAME_LEN];
+   char logicalParentDirName[MAX_NAME_LEN];
+   char collIdNum[MAX_NAME_LEN];
+   char collNameSlash[MAX_NAME_LEN];
+   char collNameSlashLen[20];
+   char *collName;
+   int status;
+
+   if (logSQL!=0) rodsLog(LOG_SQL, "chlDelCollTree");
+
+   cmlInvalidateAccessCache();
+
+   if (!icss.status) {
+      return(CATALOG_NOT_CONNECTED);
+   }
+
+   if (collInfo==0) {
+      return(CAT_INVALID_ARGUMENT);
+   }
+   collName = collInfo->collName;
+
+   status = splitPathByKey(collName, 
+			   logicalParentDirName, logicalEndName, '/');
+   if (strlen(logicalParentDirName)==0 || strlen(logicalEndName)==0) {
+      return(CAT_INVALID_ARGUMENT);  /* never the root */
+   }
+
+   if (adminFlag) {
+      if (rsComm->clientUser.authInfo.authFlag < LOCAL_PRIV_USER_AUTH) {
+	 return(CAT_INSUFFICIENT_PRIVILEGE_LEVEL);
+      }
+      if (rsComm->proxyUser.authInfo.authFlag < LOCAL_PRIV_USER_AUTH) {
+	 return(CAT_INSUFFICIENT_PRIVILEGE_LEVEL);
+      }
+      if (logSQL!=0) rodsLog(LOG_SQL, "chlDelCollTree SQL 1 ");
+      status = cmlGetIntegerValueFromSql(
+               "select coll_id from R_COLL_MAIN where coll_name=?",
+	       &iVal, collName, 0, 0, 0, 0, &icss);
+      if (status != 0) {
+	 if (status == CAT_NO_ROWS_FOUND) return(CAT_UNKNOWN_COLLECTION);
+	 return(status);
+      }
+   }
+   else {
+      /* Check that the parent collection exists and user has write
+	 permission */
+      if (logSQL!=0) rodsLog(LOG_SQL, "chlDelCollTree SQL 2 ");
+      iVal = cmlCheckDir(logicalParentDirName, 
+			 rsComm->clientUser.userName, 
+			 rsComm->clientUser.rodsZone, 
+			 ACCESS_MODIFY_OBJECT, 
+			 &icss);
+      if (iVal < 0) return(iVal);
+
+      /* Check that the collection exists and user has DELETE or better
+	 permission */
+      if (logSQL!=0) rodsLog(LOG_SQL, "chlDelCollTree SQL 3 ");
+      iVal = cmlCheckDir(collName, 
+			 rsComm->clientUser.userName, 
+			 rsComm->clientUser.rodsZone, 
+			 ACCESS_DELETE_OBJECT, 
+			 &icss);
+      if (iVal < 0) return(iVal);
+   }
+   snprintf(collIdNum, MAX_NAME_LEN, "%lld", iVal);
+
+   /* The subtree is the collection itself plus the collections whose name
+      starts with collName/ (substr, like chlRenameObject, so that '_' and
+      '%' in the name are not taken as patterns) */
+   snprintf(collNameSlash, MAX_NAME_LEN, "%s/", collName);
+   snprintf(collNameSlashLen, sizeof(collNameSlashLen), "%d",
+	    (int)strlen(collNameSlash));
+
+   /* no special collections in the subtree */
+   cllBindVars[cllBindVarCount++]=collName;
+   cllBindVars[cllBindVarCount++]=collNameSlashLen;
+   cllBindVars[cllBindVarCount++]=collNameSlash;
+   if (logSQL!=0) rodsLog(LOG_SQL, "chlDelCollTree SQL 4 ");
+   status = cmlGetIntegerValueFromSqlV3(
+            "select count(coll_id) from R_COLL_MAIN where (coll_name = ? or substr(coll_name,1,?) = ?) and length(coll_type) > 0",
+	    &iVal, &icss);
+   if (status != 0) return(status);
+   if (iVal > 0) return(SYS_NOT_SUPPORTED);
+
+   if (!adminFlag) {
+      /* one check for all the collections of the subtree */
+      cllBindVars[cllBindVarCount++]=collName;
+      cllBindVars[cllBindVarCount++]=collNameSlashLen;
+      cllBindVars[cllBindVarCount++]=collNameSlash;
+      cllBindVars[cllBindVarCount++]=rsComm->clientUser.userName;
+      cllBindVars[cllBindVarCount++]=rsComm->clientUser.rodsZone;
+      cllBindVars[cllBindVarCount++]=ACCESS_DELETE_OBJECT;
+      if (logSQL!=0) rodsLog(LOG_SQL, "chlDelCollTree SQL 5 ");
+      status = cmlGetIntegerValueFromSqlV3(
+               "select count(CM.coll_id) from R_COLL_MAIN CM where (CM.coll_name = ? or substr(CM.coll_name,1,?) = ?) and not exists (select OA.object_id from R_OBJT_ACCESS OA, R_USER_GROUP UG, R_USER_MAIN UM, R_TOKN_MAIN TM where UM.user_name=? and UM.zone_name=? and UM.user_type_name!='rodsgroup' and UM.user_id = UG.user_id and OA.object_id = CM.coll_id and UG.group_user_id = OA.user_id and OA.access_type_id >= TM.token_id and  TM.token_namespace ='access_type' and TM.token_name = ?)",
+	       &iVal, &icss);
+      if (status != 0) return(status);
+      if (iVal > 0) return(CAT_NO_ACCESS_PERMISSION);
+
+      /* and one for all the data objects */
+      cllBindVars[cllBindVarCount++]=collName;
+      cllBindVars[cllBindVarCount++]=collNameSlashLen;
+      cllBindVars[cllBindVarCount++]=collNameSlash;
+      cllBindVars[cllBindVarCount++]=rsComm->clientUser.userName;
+      cllBindVars[cllBindVarCount++]=rsComm->clientUser.rodsZone;
+      cllBindVars[cllBindVarCount++]=ACCESS_DELETE_OBJECT;
+      if (logSQL!=0) rodsLog(LOG_SQL, "chlDelCollTree SQL 6 ");
+      status = cmlGetIntegerValueFromSqlV3(
+               "select count(DM.data_id) from R_DATA_MAIN DM, R_COLL_MAIN CM where DM.coll_id = CM.coll_id and (CM.coll_name = ? or substr(CM.coll_name,1,?) = ?) and not exists (select OA.object_id from R_OBJT_ACCESS OA, R_USER_GROUP UG, R_USER_MAIN UM, R_TOKN_MAIN TM where UM.user_name=? and UM.zone_name=? and UM.user_type_name!='rodsgroup' and UM.user_id = UG.user_id and OA.object_id = DM.data_id and UG.group_user_id = OA.user_id and OA.access_type_id >= TM.token_id and  TM.token_namespace ='access_type' and TM.token_name = ?)",
+	       &iVal, &icss);
+      if (status != 0) return(status);
+      if (iVal > 0) return(CAT_NO_ACCESS_PERMISSION);
+   }
+
+   /* remove the access rows and AVU links of the data objects and then
+      of the collections */
+   cllBindVars[cllBindVarCount++]=collName;
+   cllBindVars[cllBindVarCount++]=collNameSlashLen;
+   cllBindVars[cllBindVarCount++]=collNameSlash;
+   if (logSQL!=0) rodsLog(LOG_SQL, "chlDelCollTree SQL 7 ");
+   status =  cmlExecuteNoAnswerSql(
+		   "delete from R_OBJT_ACCESS where object_id in (select data_id from R_DATA_MAIN where coll_id in (select coll_id from R_COLL_MAIN where coll_name = ? or substr(coll_name,1,?) = ?))",
+		   &icss);
+   if (status != 0 && status != CAT_SUCCESS_BUT_WITH_NO_INFO) {
+      rodsLog(LOG_NOTICE,
+	      "chlDelCollTree delete data access failure %d",
+	      status);
+      _rollback("chlDelCollTree");
+      return(status);
+   }
+
+   cllBindVars[cllBindVarCount++]=collName;
+   cllBindVars[cllBindVarCount++]=collNameSlashLen;
+   cllBindVars[cllBindVarCount++]=collNameSlash;
+   if (logSQL!=0) rodsLog(LOG_SQL, "chlDelCollTree SQL 8 ");
+   status =  cmlExecuteNoAnswerSql(
+		   "delete from R_OBJT_METAMAP where object_id in (select data_id from R_DATA_MAIN where coll_id in (select coll_id from R_COLL_MAIN where coll_name = ? or substr(coll_name,1,?) = ?))",
+		   &icss);
+   if (status != 0 && status != CAT_SUCCESS_BUT_WITH_NO_INFO) {
+      rodsLog(LOG_NOTICE,
+	      "chlDelCollTree delete data metamap failure %d",
+	      status);
+      _rollback("chlDelCollTree");
+      return(status);
+   }
+
+   cllBindVars[cllBindVarCount++]=collName;
+   cllBindVars[cllBindVarCount++]=collNameSlashLen;
+   cllBindVars[cllBindVarCount++]=collNameSlash;
+   if (logSQL!=0) rodsLog(LOG_SQL, "chlDelCollTree SQL 9 ");
+   status =  cmlExecuteNoAnswerSql(
+		   "delete from R_OBJT_ACCESS where object_id in (select coll_id from R_COLL_MAIN where coll_name = ? or substr(coll_name,1,?) = ?)",
+		   &icss);
+   if (status != 0 && status != CAT_SUCCESS_BUT_WITH_NO_INFO) {
+      rodsLog(LOG_NOTICE,
+	      "chlDelCollTree delete coll access failure %d",
+	      status);
+      _rollback("chlDelCollTree");
+      return(status);
+   }
+
+   cllBindVars[cllBindVarCount++]=collName;
+   cllBindVars[cllBindVarCount++]=collNameSlashLen;
+   cllBindVars[cllBindVarCount++]=collNameSlash;
+   if (logSQL!=0) rodsLog(LOG_SQL, "chlDelCollTree SQL 10 ");
+   status =  cmlExecuteNoAnswerSql(
+		   "delete from R_OBJT_METAMAP where object_id in (select coll_id from R_COLL_MAIN where coll_name = ? or substr(coll_name,1,?) = ?)",
+		   &icss);
+   if (status != 0 && status != CAT_SUCCESS_BUT_WITH_NO_INFO) {
+      rodsLog(LOG_NOTICE,
+	      "chlDelCollTree delete coll metamap failure %d",
+	      status);
+      _rollback("chlDelCollTree");
+      return(status);
+   }
+#ifdef METADATA_CLEANUP
+   removeAVUs();
+#endif
+
+#ifdef FILESYSTEM_META
+   /* remove any filesystem metadata entries */
+   cllBindVars[cllBindVarCount++]=collName;
+   cllBindVars[cllBindVarCount++]=collNameSlashLen;
+   cllBindVars[cllBindVarCount++]=collNameSlash;
+   cllBindVars[cllBindVarCount++]=collName;
+   cllBindVars[cllBindVarCount++]=collNameSlashLen;
+   cllBindVars[cllBindVarCount++]=collNameSlash;
+   if (logSQL) rodsLog(LOG_SQL, "chlDelCollTree xSQL 1");
+   status =  cmlExecuteNoAnswerSql(
+		   "delete from R_OBJT_FILESYSTEM_META where object_id in (select coll_id from R_COLL_MAIN where coll_name = ? or substr(coll_name,1,?) = ?) or object_id in (select data_id from R_DATA_MAIN where coll_id in (select coll_id from R_COLL_MAIN where coll_name = ? or substr(coll_name,1,?) = ?))",
+		   &icss);
+   if (status) {  
+       /* error might indicate that this wasn't set
+          which isn't a problem. Fall through. */
+      rodsLog(LOG_NOTICE,
+	      "chlDelCollTree delete filesystem meta failure %d",
+	      status);
+   }
+#endif
+
+   /* Audit (one record for the whole tree) */
+   status = cmlAudit3(adminFlag ? AU_DELETE_COLL_BY_ADMIN : AU_DELETE_COLL,
+		      collIdNum,
+		      rsComm->clientUser.userName,
+		      rsComm->clientUser.rodsZone,
+		      collName,
+		      &icss);
+   if (status != 0) {
+      rodsLog(LOG_NOTICE,
+	      "chlDelCollTree cmlAudit3 failure %d",
+	      status);
+      _rollback("chlDelCollTree");
+      return(status);
+   }
+
+   cllBindVars[cllBindVarCount++]=collName;
+   cllBindVars[cllBindVarCount++]=collNameSlashLen;
+   cllBindVars[cllBindVarCount++]=collNameSlash;
+   if (logSQL!=0) rodsLog(LOG_SQL, "chlDelCollTree SQL 11 ");
+   status =  cmlExecuteNoAnswerSql(
+		   "delete from R_DATA_MAIN where coll_id in (select coll_id from R_COLL_MAIN where coll_name = ? or substr(coll_name,1,?) = ?)",
+		   &icss);
+   if (status != 0 && status != CAT_SUCCESS_BUT_WITH_NO_INFO) {
+      rodsLog(LOG_NOTICE,
+	      "chlDelCollTree delete data failure %d",
+	      status);
+      _rollback("chlDelCollTree");
+      return(status);
+   }
+
+   cllBindVars[cllBindVarCount++]=collName;
+   cllBindVars[cllBindVarCount++]=collNameSlashLen;
+   cllBindVars[cllBindVarCount++]=collNameSlash;
+   if (logSQL!=0) rodsLog(LOG_SQL, "chlDelCollTree SQL 12 ");
+   status =  cmlExecuteNoAnswerSql(
+		   "delete from R_COLL_MAIN where coll_name = ? or substr(coll_name,1,?) = ?",
+		   &icss);
+   if (status != 0) {
+      rodsLog(LOG_NOTICE,
+	      "chlDelCollTree delete coll failure %d",
+	      status);
+      _rollback("chlDelCollTree");
+      return(status);
+   }
+
+   return(0);
+}
+
 /* Check an authentication response.
  
    Input is the challange, response, and username; the response is checked
@@ -4417,6 +4666,8 @@ int chlModUser(rsComm_t *rsComm, char *userName, char *option,
 
    if (logSQL!=0) rodsLog(LOG_SQL, "chlModUser");
 
+   cmlInvalidateAccessCache();
+
    if (userName == NULL || option == NULL || newValue==NULL) {
       return (CAT_INVALID_ARGUMENT);
    }
@@ -4703,6 +4954,8 @@ int chlModGroup(rsComm_t *rsComm, char *groupName, char *option,
 
    if (logSQL!=0) rodsLog(LOG_SQL, "chlModGroup");
 
+   cmlInvalidateAccessCache();
+
    if (groupName == NULL || option == NULL || userName==NULL) {
       return (CAT_INVALID_ARGUMENT);
    }
@@ -6079,9 +6332,9 @@ findOrInsertAVU(char *attribute, char *value, char *units) {
 	return iVal;
    }
    if (logSQL!=0) rodsLog(LOG_SQL, "findOrInsertAVU SQL 1");
-   status = cmlGetNextSeqVal(&icss);
+   status = cmlGetNextSeqValFromBlock(&icss);
    if (status < 0) {
-      rodsLog(LOG_NOTICE, "findOrInsertAVU cmlGetNextSeqVal failure %d",
+      rodsLog(LOG_NOTICE, "findOrInsertAVU cmlGetNextSeqValFromBlock failure %d",
 	      status);
       return(status);
    }
@@ -7477,6 +7730,8 @@ int chlModAccessControl(rsComm_t *rsComm, int recursiveFlag,
 
    if (logSQL!=0) rodsLog(LOG_SQL, "chlModAccessControl");
 
+   cmlInvalidateAccessCache();
+
    if (strncmp(accessLevel, MOD_RESC_PREFIX, strlen(MOD_RESC_PREFIX))==0) {
       return(chlModAccessControlResc(rsComm, recursiveFlag,
 			accessLevel, userName, zone, pathName));
@@ -8012,6 +8267,8 @@ int chlRenameObject(rsComm_t *rsComm, rodsLong_t objId,
 
    if (logSQL!=0) rodsLog(LOG_SQL, "chlRenameObject");
 
+   cmlInvalidateAccessCache();
+
    if (strstr(newName, "/")) {
       return(CAT_INVALID_ARGUMENT);
    }
@@ -8307,6 +8564,8 @@ int chlMoveObject(rsComm_t *rsComm, rodsLong_t objId,
 
    if (logSQL!=0) rodsLog(LOG_SQL, "chlMoveObject");
 
+   cmlInvalidateAccessCache();
+
    /* check that the target collection exists and user has write
       permission, and get the names while at it */
    cVal[0]=parentTargetCollName;
@@ -34,6 +34,108 @@ int checkObjIdByTicket(char *dataId, char *accessLevel,
 			   char *userName, char *userZone,
 			   icatSessionStruct *icss);
 
+/*
+ The access check cache. Only granted accesses are cached, so errors
+ (no permission, unknown object) always go to the database. Entries
+ live for accessCacheTTL seconds, which bounds how long a change made
+ by another agent can go unnoticed here. Changes made in this agent
+ call cmlInvalidateAccessCache, which also suspends the cache until the
+ transaction ends, so that the checks done while making a change do not
+ cache the old state.
+ */
+typedef struct {
+   char *key;
+   rodsLong_t id;
+   int inheritFlag;
+   time_t expire;
+} accessCacheEntry_t;
+
+static accessCacheEntry_t accessCache[ACCESS_CACHE_SIZE];
+static int accessCacheTTL=-1;	/* -1 until read from the env */
+static int accessCacheSuspended=0;
+static int accessCacheHits=0;
+static int accessCacheMisses=0;
+static int accessCacheFlushes=0;
+
+/* the agent-local block of object ids, see cmlGetNextSeqValFromBlock */
+static rodsLong_t seqIdBlock[MAX_SEQ_ID_BLOCK_SIZE];
+static int seqIdBlockSize=-1;	/* -1 until read from the env */
+static int seqIdBlockInx=0;
+static int seqIdBlockLen=0;
+
+static void
+flushAccessCache() {
+   int i;
+   for (i=0; i<ACCESS_CACHE_SIZE; i++) {
+      if (accessCache[i].key != NULL) free(accessCache[i].key);
+   }
+   memset(accessCache, 0, sizeof(accessCache));
+}
+
+void
+cmlInvalidateAccessCache() {
+   flushAccessCache();
+   accessCacheSuspended=1;
+   accessCacheFlushes++;
+}
+
+static int
+accessCacheEnabled() {
+   char *cp;
+   if (accessCacheTTL < 0) {
+      accessCacheTTL = DEF_ACCESS_CACHE_TTL;
+      if ((cp = getenv(ACCESS_CACHE_TTL)) != NULL) {
+	 accessCacheTTL = atoi(cp);
+	 if (accessCacheTTL < 0) accessCacheTTL = 0;
+      }
+   }
+   return(accessCacheTTL > 0 && accessCacheSuspended==0);
+}
+
+static int
+accessCacheSlot(char *key) {
+   unsigned int hash=2166136261U;	/* FNV-1a */
+   for (; *key!='\0'; key++) {
+      hash = (hash ^ (unsigned char)*key) * 16777619U;
+   }
+   return(hash & (ACCESS_CACHE_SIZE-1));
+}
+
+/*
+ Look up an access check; the key identifies the object, the user and
+ the access level.  Returns 1 and fills in id and inheritFlag if found.
+ */
+static int
+lookupAccessCache(char *key, rodsLong_t *id, int *inheritFlag) {
+   accessCacheEntry_t *entry;
+
+   if (*key=='\0' || !accessCacheEnabled()) return(0);
+   entry = &accessCache[accessCacheSlot(key)];
+   if (entry->key != NULL && strcmp(entry->key, key)==0) {
+      if (entry->expire > time(NULL)) {
+	 *id = entry->id;
+	 if (inheritFlag != NULL) *inheritFlag = entry->inheritFlag;
+	 accessCacheHits++;
+	 return(1);
+      }
+   }
+   accessCacheMisses++;
+   return(0);
+}
+
+static void
+addAccessCache(char *key, rodsLong_t id, int inheritFlag) {
+   accessCacheEntry_t *entry;
+
+   if (*key=='\0' || !accessCacheEnabled()) return;
+   entry = &accessCache[accessCacheSlot(key)];
+   if (entry->key != NULL) free(entry->key);
+   entry->key = strdup(key);
+   entry->id = id;
+   entry->inheritFlag = inheritFlag;
+   entry->expire = time(NULL) + accessCacheTTL;
+}
+
 int cmlDebug(int mode) {
    logSQL_CML = mode;
    if (mode > 1) {
@@ -91,6 +193,15 @@ int cmlClose( icatSessionStruct *icss) {
 
    stat2 = cllCloseEnv(icss);
 
+   if (accessCacheHits+accessCacheMisses > 0) {
+      rodsLog(LOG_DEBUG,
+	      "cmlClose: access cache %d hits, %d misses, %d invalidations",
+	      accessCacheHits, accessCacheMisses, accessCacheFlushes);
+   }
+   flushAccessCache();
+   seqIdBlockInx=0;
+   seqIdBlockLen=0;
+
    pending=0;
    if (status) {
       return(CAT_DISCONNECT_ERR);
@@ -107,6 +218,12 @@ int cmlExecuteNoAnswerSql( char *sql,
 {
   int i;
   
+  if (strcmp(sql, "commit")==0 || strcmp(sql, "rollback")==0) {
+     /* the end of a transaction; a rollback may undo what was cached
+	and a commit ends the changes that suspended the cache */
+     if (accessCacheSuspended || sql[0]=='r') flushAccessCache();
+     accessCacheSuspended=0;
+  }
   i = cllExecSqlNoResult(icss, sql);
   if (i) { 
      if (i <= CAT_ENV_ERR) return(i); /* already an iRODS error code */
@@ -698,6 +815,87 @@ cmlGetNextSeqStr(char *seqStr, int maxSeqStrLen, icatSessionStruct *icss) {
    return(status);
 }
 
+/*
+ The agent-local block of object ids. cmlGetNextSeqValFromBlock reserves
+ seqIdBlockSize values of R_ObjectID in one query and hands them out
+ one by one. Sequence values are not given back on a rollback, so the
+ reserved ids stay valid across transactions; the ones not used when
+ the agent exits are simply skipped. Values from the block are not
+ seen by currval, so callers must not use cmlGetCurrentSeqVal after it.
+ */
+static int
+getSeqIdBlockSize() {
+   char *cp;
+   if (seqIdBlockSize < 0) {
+      seqIdBlockSize = DEF_SEQ_ID_BLOCK_SIZE;
+      if ((cp = getenv(SEQ_ID_BLOCK_SIZE)) != NULL) {
+	 seqIdBlockSize = atoi(cp);
+      }
+      if (seqIdBlockSize < 1) seqIdBlockSize = 1;
+      if (seqIdBlockSize > MAX_SEQ_ID_BLOCK_SIZE) {
+	 seqIdBlockSize = MAX_SEQ_ID_BLOCK_SIZE;
+      }
+#ifdef MY_ICAT
+      /* the MySQL sequence is emulated by a function; no block query */
+      seqIdBlockSize = 1;
+#endif
+   }
+   return(seqIdBlockSize);
+}
+
+static int
+fillSeqIdBlock(icatSessionStruct *icss) {
+   char nextStr[STR_LEN];
+   char sql[STR_LEN];
+   int status, stmtNum;
+
+   if (logSQL_CML!=0) rodsLog(LOG_SQL, "fillSeqIdBlock SQL 1 ");
+
+   nextStr[0]='\0';
+   cllNextValueString("R_ObjectID", nextStr, STR_LEN);
+
+#ifdef ORA_ICAT
+   snprintf(sql, STR_LEN, "select %s from DUAL connect by level <= %d",
+	    nextStr, seqIdBlockSize);
+#else
+   snprintf(sql, STR_LEN, "select %s from generate_series(1,%d)",
+	    nextStr, seqIdBlockSize);
+#endif
+
+   seqIdBlockInx=0;
+   seqIdBlockLen=0;
+   status = cmlGetFirstRowFromSql(sql, &stmtNum, 0, icss);
+   while (status == 0) {
+      if (seqIdBlockLen < MAX_SEQ_ID_BLOCK_SIZE) {
+	 seqIdBlock[seqIdBlockLen++] =
+	    strtoll(icss->stmtPtr[stmtNum]->resultValue[0], 0, 0);
+      }
+      status = cmlGetNextRowFromStatement(stmtNum, icss);
+   }
+   if (status != CAT_NO_ROWS_FOUND) {
+      rodsLog(LOG_NOTICE,
+	      "fillSeqIdBlock cmlGetFirstRowFromSql failure %d", status);
+      seqIdBlockLen=0;
+      return(status);
+   }
+   if (seqIdBlockLen == 0) return(CAT_NO_ROWS_FOUND);
+   return(0);
+}
+
+rodsLong_t
+cmlGetNextSeqValFromBlock(icatSessionStruct *icss) {
+   int status;
+
+   if (getSeqIdBlockSize() <= 1) {
+      return(cmlGetNextSeqVal(icss));
+   }
+   if (seqIdBlockInx >= seqIdBlockLen) {
+      status = fillSeqIdBlock(icss);
+      if (status < 0) return(status);
+   }
+   return(seqIdBlock[seqIdBlockInx++]);
+}
+
 /* modifed for various tests */
 int cmlTest( icatSessionStruct *icss) {
   int i, cValSize;
@@ -785,6 +983,13 @@ cmlCheckDir( char *dirName, char *userName, char *userZone, char *accessLevel,
 {
    int status;
    rodsLong_t iVal;
+   char cacheKey[MAX_NAME_LEN+LONG_NAME_LEN];
+
+   if (snprintf(cacheKey, sizeof cacheKey, "C%s\n%s#%s\n%s", dirName,
+		userName, userZone, accessLevel) >= (int)sizeof cacheKey) {
+      cacheKey[0]='\0';	/* too long to be cached */
+   }
+   if (lookupAccessCache(cacheKey, &iVal, NULL)) return(iVal);
 
    if (logSQL_CML!=0) rodsLog(LOG_SQL, "cmlCheckDir SQL 1 ");
 
@@ -806,6 +1011,7 @@ cmlCheckDir( char *dirName, char *userName, char *userZone, char *accessLevel,
       return (CAT_NO_ACCESS_PERMISSION);
    }
 
+   addAccessCache(cacheKey, iVal, 0);
    return(iVal);
 
 }
@@ -830,6 +1036,8 @@ cmlCheckDirAndGetInheritFlag( char *dirName, char *userName, char *userZone,
    char cValStr1[MAX_INTEGER_SIZE+10];
    char cValStr2[MAX_INTEGER_SIZE+10];
 
+   char cacheKey[MAX_NAME_LEN+LONG_NAME_LEN];
+
    cVal[0]=cValStr1;
    cVal[1]=cValStr2;
    cValSize[0] = MAX_INTEGER_SIZE;
@@ -837,6 +1045,16 @@ cmlCheckDirAndGetInheritFlag( char *dirName, char *userName, char *userZone,
 
    *inheritFlag = 0;
 
+   /* Ticket access is not cached */
+   cacheKey[0]='\0';
+   if (ticketStr == NULL || *ticketStr=='\0') {
+      if (snprintf(cacheKey, sizeof cacheKey, "I%s\n%s#%s\n%s", dirName,
+		   userName, userZone, accessLevel) >= (int)sizeof cacheKey) {
+	 cacheKey[0]='\0';	/* too long to be cached */
+      }
+      if (lookupAccessCache(cacheKey, &iVal, inheritFlag)) return(iVal);
+   }
+
    if (ticketStr != NULL && *ticketStr!='\0') {
       if (logSQL_CML!=0) rodsLog(LOG_SQL, "cmlCheckDirAndGetInheritFlag SQL 1 ");
       status = cmlGetOneRowFromSqlBV ("select coll_id, coll_inheritance from R_COLL_MAIN CM, R_TICKET_MAIN TM where CM.coll_name=? and TM.ticket_string=? and TM.ticket_type = 'write' and TM.object_id = CM.coll_id", cVal, cValSize, 2, dirName, ticketStr, 0, 0, 0, icss);
@@ -879,6 +1097,7 @@ cmlCheckDirAndGetInheritFlag( char *dirName, char *userName, char *userZone,
       if (status != 0) return (status);
    }
 
+   addAccessCache(cacheKey, iVal, *inheritFlag);
    return(iVal);
 
 }
@@ -950,6 +1169,14 @@ cmlCheckDataObjOnly( char *dirName, char *dataName,
 {
    int status;
    rodsLong_t iVal; 
+   char cacheKey[MAX_NAME_LEN*2+LONG_NAME_LEN];
+
+   if (snprintf(cacheKey, sizeof cacheKey, "D%s/%s\n%s#%s\n%s", dirName,
+		dataName, userName, userZone, accessLevel) >=
+       (int)sizeof cacheKey) {
+      cacheKey[0]='\0';	/* too long to be cached */
+   }
+   if (lookupAccessCache(cacheKey, &iVal, NULL)) return(iVal);
 
    if (logSQL_CML!=0) rodsLog(LOG_SQL, "cmlCheckDataObjOnly SQL 1 ");
 
@@ -972,6 +1199,7 @@ cmlCheckDataObjOnly( char *dirName, char *dataName,
       return (CAT_NO_ACCESS_PERMISSION);
    }
 
+   addAccessCache(cacheKey, iVal, 0);
    return(iVal);
 
 }
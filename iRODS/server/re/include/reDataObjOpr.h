@@ -79,6 +79,15 @@ int
 msiCollRepl (msParam_t *collection, msParam_t *targetResc, msParam_t *status, 
   ruleExecInfo_t *rei);
 int
+msiStageCollToCache (msParam_t *collection, msParam_t *msKeyValStr,
+  msParam_t *status, ruleExecInfo_t *rei);
+int
+msiSyncCollPhyPath (msParam_t *collection, msParam_t *batchSize,
+  msParam_t *sleepTime, msParam_t *status, ruleExecInfo_t *rei);
+int
+msiReapVault (msParam_t *rescName, msParam_t *numThreads,
+  msParam_t *status, ruleExecInfo_t *rei);
+int
 msiPhyPathReg (msParam_t *inpParam1, msParam_t *inpParam2,
 msParam_t *inpParam3, msParam_t *inpParam4, msParam_t *outParam,
 ruleExecInfo_t *rei);
@@ -10,6 +10,9 @@
 #include "apiHeaderAll.h"
 #include "rsApiHandler.h"
 #include "collection.h"
+#include "stageQue.h"
+#include "physPath.h"
+#include "vaultReaper.h"
 
 /**
  * \fn msiDataObjCreate (msParam_t *inpParam1, msParam_t *msKeyValStr, 
@@ -3221,6 +3224,314 @@ ruleExecInfo_t *rei)
     return (rei->status);
 }
 
+/**
+ * \fn msiStageCollToCache (msParam_t *collection, msParam_t *msKeyValStr,
+ * msParam_t *status, ruleExecInfo_t *rei)
+ *
+ * \brief  This microservice stages the data objects of a collection which
+ *  only have a good copy on a compound resource to the cache resource.
+ *
+ * \module core
+ *
+ * \since 3.3
+ *
+ * \note  Concurrent stages of the same object by other agents are
+ *  merged and the number of parallel stages per compound resource is
+ *  bounded by the stageSlotsPerResc server env. With numThreads > 1, the
+ *  collection is split into shards which are queued as delayed rules so
+ *  that the irodsReServer processes stage them in parallel.
+ *
+ * \usage See clients/icommands/test/rules3.0/
+ *
+ * \param[in] collection - A CollInp_MS_T or a STR_MS_T with the irods path
+ *      of the collection to stage.
+ * \param[in] msKeyValStr - Optional - a STR_MS_T. This is the special
+ *      msKeyValStr format of keyWd1=value1++++keyWd2=value2...
+ *      Valid keyWds are:
+ *        \li "collFlags" - the collection query flags. The default is
+ *              RECUR_QUERY_FG (4) to stage the whole tree. 0 stages only
+ *              the objects directly in the collection.
+ *        \li "numThreads" - the number of shards to queue to the
+ *              irodsReServer.
+ *        \li "stageShard" - index/count. Stage only one shard. Used
+ *              by the queued shards.
+ * \param[out] status - a INT_MS_T containing the number of objects staged.
+ * \param[in,out] rei - The RuleExecInfo structure that is automatically
+ *    handled by the rule engine. The user does not include rei as a
+ *    parameter in the rule invocation.
+ *
+ * \DolVarDependence none
+ * \DolVarModified none
+ * \iCatAttrDependence none
+ * \iCatAttrModified none
+ * \sideeffect Adds cache copies of the staged objects.
+ *
+ * \return integer
+ * \retval 0 on success
+ * \pre none
+ * \post none
+ * \sa msiCollRepl
+**/
+int
+msiStageCollToCache (msParam_t *collection, msParam_t *msKeyValStr,
+msParam_t *status, ruleExecInfo_t *rei)
+{
+    collInp_t collInpCache, *collInp;
+    char *outBadKeyWd;
+    char *tmpStr;
+    int validKwFlags;
+    int numThreads = 0;
+    int shardInx = 0;
+    int numShards = 0;
+    int stagedCnt = 0;
+    int i;
+    rsComm_t *rsComm;
+
+    RE_TEST_MACRO ("    Calling msiStageCollToCache")
+
+    if (rei == NULL || rei->rsComm == NULL) {
+        rodsLog (LOG_ERROR, "msiStageCollToCache: inp rei or rsComm is NULL.");
+        return (SYS_INTERNAL_NULL_INPUT_ERR);
+    }
+
+    rsComm = rei->rsComm;
+
+    rei->status =
+      parseMspForCollInp (collection, &collInpCache, &collInp, 0);
+
+    if (rei->status < 0) {
+        rodsLog (LOG_ERROR,
+          "msiStageCollToCache: input collection error. status = %d",
+          rei->status);
+        return (rei->status);
+    }
+
+    collInp->flags = RECUR_QUERY_FG;
+    if (msKeyValStr != NULL && msKeyValStr->inOutStruct != NULL &&
+      strlen ((char *) msKeyValStr->inOutStruct) > 0 &&
+      strcmp ((char *) msKeyValStr->inOutStruct, "null") != 0) {
+        validKwFlags = COLL_NAME_FLAG | COLL_FLAGS_FLAG | NUM_THREADS_FLAG |
+          STAGE_SHARD_FLAG;
+        rei->status = parseMsKeyValStrForCollInp (msKeyValStr, collInp,
+          NULL, validKwFlags, &outBadKeyWd);
+
+        if (rei->status < 0) {
+            if (outBadKeyWd != NULL) {
+                rodsLogAndErrorMsg (LOG_ERROR, &rsComm->rError, rei->status,
+                  "msiStageCollToCache: input keyWd - %s error. status = %d",
+                  outBadKeyWd, rei->status);
+                free (outBadKeyWd);
+            } else {
+                rodsLogAndErrorMsg (LOG_ERROR, &rsComm->rError, rei->status,
+                  "msiStageCollToCache: input msKeyValStr error. status = %d",
+                  rei->status);
+            }
+            return (rei->status);
+        }
+    }
+
+    if ((tmpStr = getValByKey (&collInp->condInput, STAGE_SHARD_KW)) != NULL) {
+        rei->status = parseStageShard (tmpStr, &shardInx, &numShards);
+        if (rei->status < 0) return (rei->status);
+    } else if ((tmpStr = getValByKey (&collInp->condInput, NUM_THREADS_KW))
+      != NULL) {
+        numThreads = atoi (tmpStr);
+        if (numThreads > MAX_STAGE_SLOTS_PER_RESC)
+            numThreads = MAX_STAGE_SLOTS_PER_RESC;
+    }
+
+    if (numThreads > 1) {
+        /* fan the shards out to the irodsReServer */
+        for (i = 0; i < numThreads; i++) {
+            rei->status = queStageCollToCache (rsComm, collInp->collName,
+              collInp->flags, i, numThreads);
+            if (rei->status < 0) break;
+        }
+    } else {
+        rei->status = stageCollToCache (rsComm, collInp, shardInx, numShards,
+          &stagedCnt);
+    }
+
+    if (rei->status >= 0) {
+        fillIntInMsParam (status, stagedCnt);
+    } else {
+        fillIntInMsParam (status, rei->status);
+    }
+
+    return (rei->status);
+}
+
+/**
+ * \fn msiSyncCollPhyPath (msParam_t *collection, msParam_t *batchSize,
+ * msParam_t *sleepTime, msParam_t *status, ruleExecInfo_t *rei)
+ *
+ * \brief  This microservice moves the vault files of the data objects
+ *  of a collection to the paths matching their logical paths.
+ *
+ * \module core
+ *
+ * \since 3.3
+ *
+ * \note  With the lazyCollPhyPath server env set, a collection rename
+ *  only updates the catalog and queues this microservice to the
+ *  irodsReServer. Until it has run, the files of the renamed collection
+ *  stay at their old physical paths, which remain registered in the
+ *  catalog. Only vault paths with the default graft path scheme are moved.
+ *
+ * \usage See clients/icommands/test/rules3.0/
+ *
+ * \param[in] collection - A STR_MS_T with the irods path of the collection.
+ * \param[in] batchSize - Optional - A STR_MS_T or INT_MS_T. The number of
+ *      replicas moved between two pauses. 0 - no pause.
+ * \param[in] sleepTime - Optional - A STR_MS_T or INT_MS_T. The pause
+ *      in seconds.
+ * \param[out] status - a INT_MS_T containing the number of replicas
+ *      checked.
+ * \param[in,out] rei - The RuleExecInfo structure that is automatically
+ *    handled by the rule engine. The user does not include rei as a
+ *    parameter in the rule invocation.
+ *
+ * \DolVarDependence none
+ * \DolVarModified none
+ * \iCatAttrDependence none
+ * \iCatAttrModified none
+ * \sideeffect Renames vault files and updates their data_path.
+ *
+ * \return integer
+ * \retval 0 on success
+ * \pre none
+ * \post none
+ * \sa msiDataObjRename
+**/
+int
+msiSyncCollPhyPath (msParam_t *collection, msParam_t *batchSize,
+msParam_t *sleepTime, msParam_t *status, ruleExecInfo_t *rei)
+{
+    char *collPath;
+    int myBatchSize = 0;
+    int mySleepTime = 0;
+    int syncedCnt = 0;
+
+    RE_TEST_MACRO ("    Calling msiSyncCollPhyPath")
+
+    if (rei == NULL || rei->rsComm == NULL) {
+        rodsLog (LOG_ERROR, "msiSyncCollPhyPath: inp rei or rsComm is NULL.");
+        return (SYS_INTERNAL_NULL_INPUT_ERR);
+    }
+
+    if ((collPath = parseMspForStr (collection)) == NULL) {
+        rodsLog (LOG_ERROR, "msiSyncCollPhyPath: input collection is NULL");
+        return (USER__NULL_INPUT_ERR);
+    }
+
+    if (batchSize != NULL && batchSize->inOutStruct != NULL) {
+        myBatchSize = parseMspForPosInt (batchSize);
+        if (myBatchSize < 0) myBatchSize = 0;
+    }
+    if (sleepTime != NULL && sleepTime->inOutStruct != NULL) {
+        mySleepTime = parseMspForPosInt (sleepTime);
+        if (mySleepTime < 0) mySleepTime = 0;
+    }
+
+    rei->status = _syncCollPhyPath (rei->rsComm, collPath, myBatchSize,
+      mySleepTime, &syncedCnt);
+
+    if (rei->status >= 0) {
+        fillIntInMsParam (status, syncedCnt);
+    } else {
+        rodsLogError (LOG_ERROR, rei->status,
+          "msiSyncCollPhyPath: _syncCollPhyPath of %s error.", collPath);
+        fillIntInMsParam (status, rei->status);
+    }
+
+    return (rei->status);
+}
+
+/**
+ * \fn msiReapVault (msParam_t *rescName, msParam_t *numThreads,
+ * msParam_t *status, ruleExecInfo_t *rei)
+ *
+ * \brief  This microservice unlinks the vault files of a resource queued
+ *  by the set based removal of collections.
+ *
+ * \module core
+ *
+ * \since 3.3
+ *
+ * \note  With the rmCollTree server env set, irm -rf and irmtrash remove
+ *  a collection tree from the catalog with one set of SQL statements. The
+ *  physical paths of the removed replicas are queued per resource and
+ *  this microservice is queued to the irodsReServer for each resource.
+ *  A path at which a replica of the resource is registered again, e.g.
+ *  by a put of the same logical path, is not unlinked. Files which
+ *  cannot be checked or unlinked are queued again and retried by a
+ *  reaper run 10 minutes later.
+ *
+ * \usage See clients/icommands/test/rules3.0/
+ *
+ * \param[in] rescName - A STR_MS_T with the resource name.
+ * \param[in] numThreads - Optional - A STR_MS_T or INT_MS_T. The number
+ *      of unlink threads for a local vault. The default is the
+ *      reapNumThreads server env.
+ * \param[out] status - a INT_MS_T containing the number of files unlinked.
+ * \param[in,out] rei - The RuleExecInfo structure that is automatically
+ *    handled by the rule engine. The user does not include rei as a
+ *    parameter in the rule invocation.
+ *
+ * \DolVarDependence none
+ * \DolVarModified none
+ * \iCatAttrDependence none
+ * \iCatAttrModified none
+ * \sideeffect Unlinks vault files.
+ *
+ * \return integer
+ * \retval 0 on success
+ * \pre none
+ * \post none
+ * \sa msiRmColl
+**/
+int
+msiReapVault (msParam_t *rescName, msParam_t *numThreads,
+msParam_t *status, ruleExecInfo_t *rei)
+{
+    char *myRescName;
+    int myNumThreads;
+    int reapedCnt = 0;
+
+    RE_TEST_MACRO ("    Calling msiReapVault")
+
+    if (rei == NULL || rei->rsComm == NULL) {
+        rodsLog (LOG_ERROR, "msiReapVault: inp rei or rsComm is NULL.");
+        return (SYS_INTERNAL_NULL_INPUT_ERR);
+    }
+
+    if ((myRescName = parseMspForStr (rescName)) == NULL) {
+        rodsLog (LOG_ERROR, "msiReapVault: input rescName is NULL");
+        return (USER__NULL_INPUT_ERR);
+    }
+
+    myNumThreads = getReapNumThreads ();
+    if (numThreads != NULL && numThreads->inOutStruct != NULL) {
+        int i = parseMspForPosInt (numThreads);
+        if (i > 0) myNumThreads = i;
+        if (myNumThreads > MAX_REAP_NUM_THREADS)
+            myNumThreads = MAX_REAP_NUM_THREADS;
+    }
+
+    rei->status = reapVault (rei->rsComm, myRescName, myNumThreads,
+      &reapedCnt);
+
+    if (rei->status >= 0) {
+        fillIntInMsParam (status, reapedCnt);
+    } else {
+        rodsLogError (LOG_ERROR, rei->status,
+          "msiReapVault: reapVault of %s error.", myRescName);
+        fillIntInMsParam (status, rei->status);
+    }
+
+    return (rei->status);
+}
+
 /**
  * \fn msiDataObjPutWithOptions (msParam_t *inpParam1, msParam_t *inpParam2,
  * msParam_t *inpParam3,msParam_t *inpOverwriteParam,
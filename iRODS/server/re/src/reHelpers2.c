@@ -1043,8 +1043,10 @@ carryOverMsParam(msParamArray_t *sourceMsParamArray,msParamArray_t *targetMsPara
   int i;
     msParam_t *mP, *mPt;
     char *a, *b;
+    strIndex_t targetIndex;
     if (sourceMsParamArray == NULL)
       return(0);
+    memset (&targetIndex, 0, sizeof (targetIndex));
     /****
     for (i = 0; i < sourceMsParamArray->len ; i++) {
       mPt = sourceMsParamArray->msParam[i];
@@ -1068,7 +1070,8 @@ carryOverMsParam(msParamArray_t *sourceMsParamArray,msParamArray_t *targetMsPara
     ****/
     for (i = 0; i < sourceMsParamArray->len ; i++) {
       mPt = sourceMsParamArray->msParam[i];
-      if ((mP = getMsParamByLabel (targetMsParamArray, mPt->label)) != NULL) {
+      if ((mP = getMsParamByLabelIndexed (&targetIndex, targetMsParamArray,
+	mPt->label)) != NULL) {
 	a = mP->label;
         b = mP->type;
 	mP->label = NULL;
@@ -1133,6 +1136,7 @@ carryOverMsParam(msParamArray_t *sourceMsParamArray,msParamArray_t *targetMsPara
     }
     ***/
 
+  clearStrIndex (&targetIndex);
   return(0);
 }
 
@@ -100,6 +100,10 @@ ruleExecInfo_t *rei)
  * \param[in] xsortScheme - The sorting scheme. Valid schemes are "default", "random" and
  *    "byRescType". The "byRescType" scheme will put the cache class of resource on the top
  *    of the list. The scheme "random" and "byRescType" can be applied in sequence.
+ *    The "byLiveLoad" scheme orders the resources randomly, weighted by the current
+ *    load of their servers (open files, Bytes in transfer, disk queue and busy time,
+ *    free space). The "byLeastBytes" scheme puts the resource whose server has the
+ *    fewest Bytes in transfer on top. Neither uses the catalog.
  * \param[in,out] rei - The RuleExecInfo structure that is automatically
  *    handled by the rule engine. The user does not include rei as a
  *    parameter in the rule invocation.